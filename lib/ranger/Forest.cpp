@@ -136,6 +136,14 @@ void Forest::initCpp(std::string dependent_variable_name, MemoryMode memory_mode
 }
 // #nocov end
 
+void Forest::loadForPrediction(const std::string& forest_filename) {
+  // The data only holds the forest's variable ordering
+  data = std::make_unique<DataDouble>();
+  prediction_mode = true;
+  num_threads = 1;
+  loadFromFile(forest_filename);
+}
+
 void Forest::initR(std::unique_ptr<Data> input_data, uint mtry, uint num_trees, std::ostream* verbose_out, uint seed,
     uint num_threads, ImportanceMode importance_mode, uint min_node_size,
     std::vector<std::vector<double>>& split_select_weights, const std::vector<std::string>& always_split_variable_names,
@@ -70,6 +70,9 @@ public:
       double alpha, double minprop, bool holdout, PredictionType prediction_type, uint num_random_splits,
       bool order_snps, uint max_depth);
 
+  // Load a saved forest without any input data, so its trees can be read
+  void loadForPrediction(const std::string& forest_filename);
+
   // Grow or predict
   void run(bool verbose, bool compute_oob_error);
 
@@ -42,6 +42,10 @@ public:
     return class_values;
   }
 
+  const TreeProbability& getTree(size_t tree_idx) const {
+    return dynamic_cast<const TreeProbability&>(*trees[tree_idx]);
+  }
+
   void setClassWeights(std::vector<double>& class_weights) {
     this->class_weights = class_weights;
   }
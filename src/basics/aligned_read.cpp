@@ -5,6 +5,8 @@
 
 #include <ostream>
 #include <limits>
+#include <mutex>
+#include <unordered_set>
 
 #include <boost/functional/hash.hpp>
 
@@ -54,7 +56,8 @@ const std::string& AlignedRead::name() const noexcept
 
 const std::string& AlignedRead::read_group() const noexcept
 {
-    return read_group_;
+    static const std::string no_read_group {};
+    return read_group_ ? *read_group_ : no_read_group;
 }
 
 const GenomicRegion& AlignedRead::mapped_region() const noexcept
@@ -206,6 +209,19 @@ bool AlignedRead::is_marked_last_template_segment() const noexcept
 
 // private methods
 
+AlignedRead::ReadGroupPtr AlignedRead::intern(const std::string& read_group)
+{
+    if (read_group.empty()) return nullptr;
+    // Reads are usually made in runs from the same read group
+    thread_local ReadGroupPtr last_read_group {nullptr};
+    if (last_read_group && *last_read_group == read_group) return last_read_group;
+    static std::mutex mutex {};
+    static std::unordered_set<std::string> read_groups {}; // never shrinks so pointers stay valid
+    std::lock_guard<std::mutex> lock {mutex};
+    last_read_group = &*read_groups.insert(read_group).first;
+    return last_read_group;
+}
+
 AlignedRead::FlagBits AlignedRead::compress(const Flags& flags) const noexcept
 {
     FlagBits result {};
@@ -224,7 +240,7 @@ AlignedRead::FlagBits AlignedRead::compress(const Flags& flags) const noexcept
 
 AlignedRead::Flags AlignedRead::decompress(const FlagBits& flags) const noexcept
 {
-    return {flags[0], flags[1], flags[2], flags[3], flags[4], flags[5], flags[6], flags[7], flags[8], flags[9]};
+    return {flags[1], flags[0], flags[2], flags[3], flags[4], flags[5], flags[6], flags[7], flags[8], flags[9]};
 }
 
 AlignedRead::Segment::FlagBits AlignedRead::Segment::compress(const Flags& flags)
@@ -565,7 +581,6 @@ auto calculate_dynamic_bytes(const std::vector<AlignedRead::SupplementaryAlignme
 auto calculate_dynamic_bytes(const AlignedRead& read) noexcept
 {
     return read.name().size() * sizeof(char)
-           + read.read_group().size() * sizeof(char)
            + sequence_size(read) * sizeof(char)
            + sequence_size(read) * sizeof(AlignedRead::BaseQuality)
            + read.cigar().size() * sizeof(CigarOperation)
@@ -145,19 +145,23 @@ public:
 private:
     static constexpr std::size_t numFlags_ = 10;
     using FlagBits = std::bitset<numFlags_>;
+    // Reads share a handful of read groups, so each distinct read group is stored once
+    using ReadGroupPtr = const std::string*;
     
     // should be ordered by sizeof
     GenomicRegion region_;
     std::string name_;
     NucleotideSequence sequence_, barcode_sequence_;
+    boost::optional<Segment> next_segment_;
     BaseQualityVector base_qualities_;
     CigarString cigar_;
-    std::string read_group_;
-    boost::optional<Segment> next_segment_;
     std::vector<SupplementaryAlignment> supplementary_alignments_;
+    ReadGroupPtr read_group_ = nullptr;
     FlagBits flags_;
     MappingQuality mapping_quality_;
     
+    static ReadGroupPtr intern(const std::string& read_group);
+    
     FlagBits compress(const Flags& flags) const noexcept;
     Flags decompress(const FlagBits& flags) const noexcept;
 };
@@ -217,11 +221,11 @@ AlignedRead::AlignedRead(String_&& name, GenomicRegion_&& reference_region, Seq1
 , name_ {std::forward<String_>(name)}
 , sequence_ {std::forward<Seq1>(sequence)}
 , barcode_sequence_ {std::forward<Seq2>(barcode)}
+, next_segment_ {}
 , base_qualities_ {std::forward<Qualities_>(qualities)}
 , cigar_ {std::forward<CigarString_>(cigar)}
-, read_group_ {std::forward<String2_>(read_group)}
-, next_segment_ {}
 , supplementary_alignments_ {}
+, read_group_ {intern(std::forward<String2_>(read_group))}
 , flags_ {compress(flags)}
 , mapping_quality_ {mapping_quality}
 {}
@@ -237,14 +241,14 @@ AlignedRead::AlignedRead(String1_&& name, GenomicRegion_&& reference_region, Seq
 , name_ {std::forward<String1_>(name)}
 , sequence_ {std::forward<Seq1>(sequence)}
 , barcode_sequence_ {std::forward<Seq2>(barcode)}
-, base_qualities_ {std::forward<Qualities_>(qualities)}
-, cigar_ {std::forward<CigarString_>(cigar)}
-, read_group_ {std::forward<String2_>(read_group)}
 , next_segment_ {
     Segment {std::forward<String3_>(next_segment_contig_name), next_segment_begin,
     inferred_template_length, next_segment_flags}
   }
+, base_qualities_ {std::forward<Qualities_>(qualities)}
+, cigar_ {std::forward<CigarString_>(cigar)}
 , supplementary_alignments_ {}
+, read_group_ {intern(std::forward<String2_>(read_group))}
 , flags_ {compress(flags)}
 , mapping_quality_ {mapping_quality}
 {}
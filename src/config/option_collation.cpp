@@ -42,6 +42,7 @@
 #include "io/pedigree/pedigree_reader.hpp"
 #include "io/variant/vcf_reader.hpp"
 #include "io/variant/vcf_writer.hpp"
+#include "io/reference/two_bit_reference.hpp"
 #include "exceptions/user_error.hpp"
 #include "exceptions/program_error.hpp"
 #include "exceptions/system_error.hpp"
@@ -245,6 +246,13 @@ boost::optional<unsigned> get_num_threads(const OptionMap& options)
     return boost::none;
 }
 
+unsigned get_num_decompression_threads(const OptionMap& options)
+{
+    if (!options.at("threaded-decompression").as<bool>()) return 0;
+    const auto num_threads = get_num_threads(options);
+    return num_threads ? *num_threads : std::thread::hardware_concurrency();
+}
+
 ExecutionPolicy get_thread_execution_policy(const OptionMap& options)
 {
     if (is_set("threads", options)) {
@@ -258,6 +266,48 @@ ExecutionPolicy get_thread_execution_policy(const OptionMap& options)
     }
 }
 
+class UnsupportedPairHMMInstructionSet : public UserError
+{
+    std::string do_where() const override
+    {
+        return "get_pair_hmm_instruction_set";
+    }
+    
+    std::string do_why() const override
+    {
+        std::ostringstream ss {};
+        ss << "The pair HMM instruction set you requested (" << isa_ << ") is not supported by this CPU";
+        return ss.str();
+    }
+    
+    std::string do_help() const override
+    {
+        std::ostringstream ss {};
+        ss << "Remove the pair-hmm-isa option or request " << hmm::simd::fastest_supported_instruction_set() << " or lower";
+        return ss.str();
+    }
+    
+    hmm::simd::InstructionSet isa_;
+public:
+    UnsupportedPairHMMInstructionSet(hmm::simd::InstructionSet isa) : isa_ {isa} {}
+};
+
+hmm::simd::InstructionSet get_pair_hmm_instruction_set(const OptionMap& options)
+{
+    using hmm::simd::InstructionSet;
+    if (!is_set("pair-hmm-isa", options)) return hmm::simd::fastest_supported_instruction_set();
+    InstructionSet result {};
+    switch (options.at("pair-hmm-isa").as<PairHMMInstructionSet>()) {
+        case PairHMMInstructionSet::sse2: result = InstructionSet::sse2; break;
+        case PairHMMInstructionSet::avx2: result = InstructionSet::avx2; break;
+        case PairHMMInstructionSet::avx512: result = InstructionSet::avx512; break;
+    }
+    if (!hmm::simd::is_supported(result)) {
+        throw UnsupportedPairHMMInstructionSet {result};
+    }
+    return result;
+}
+
 MemoryFootprint get_target_read_buffer_size(const OptionMap& options)
 {
     return options.at("target-read-buffer-footprint").as<MemoryFootprint>();
@@ -295,6 +345,20 @@ ReferenceGenome make_reference(const OptionMap& options)
 {
     const fs::path input_path {options.at("reference").as<fs::path>()};
     auto resolved_path = resolve_path(input_path, options);
+    if (options.at("two-bit-reference").as<bool>() && !io::is_two_bit_reference(resolved_path)) {
+        auto two_bit_path = io::get_two_bit_reference_path(resolved_path);
+        if (!fs::exists(two_bit_path) || fs::last_write_time(two_bit_path) < fs::last_write_time(resolved_path)) {
+            logging::InfoLogger info_log {};
+            stream(info_log) << "Building 2-bit reference " << two_bit_path;
+            try {
+                io::build_two_bit_reference(resolved_path, two_bit_path);
+            } catch (MissingFileError& e) {
+                e.set_location_specified("the command line option --reference");
+                throw;
+            }
+        }
+        resolved_path = std::move(two_bit_path);
+    }
     auto ref_cache_size = options.at("max-reference-cache-footprint").as<MemoryFootprint>();
     static constexpr MemoryFootprint min_non_zero_reference_cache_size {1'000}; // 1Kb
     if (ref_cache_size.bytes() > 0 && ref_cache_size < min_non_zero_reference_cache_size) {
@@ -1234,7 +1298,8 @@ auto make_variant_generator_builder(const OptionMap& options, const boost::optio
         if (is_set("assembler-mask-base-quality", options)) {
             reassembler_options.mask_threshold = as_unsigned("assembler-mask-base-quality", options);
         }
-        reassembler_options.execution_policy = get_thread_execution_policy(options);
+        // Bins are forked onto the calling task's workers, so can't oversubscribe a fixed thread count
+        reassembler_options.execution_policy = is_threading_allowed(options) ? ExecutionPolicy::par : ExecutionPolicy::seq;
         reassembler_options.num_fallbacks = as_unsigned("num-fallback-kmers", options);
         reassembler_options.fallback_interval_size = as_unsigned("fallback-kmer-gap", options);
         reassembler_options.bin_size = as_unsigned("max-region-to-assemble", options);
@@ -1937,6 +2002,19 @@ auto get_target_working_memory(const OptionMap& options)
     return result;
 }
 
+auto get_likelihood_cache_footprint(const OptionMap& options)
+{
+    auto result = options.at("max-likelihood-cache-footprint").as<MemoryFootprint>();
+    auto num_threads = get_num_threads(options);
+    if (!num_threads) {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    if (*num_threads > 1) {
+        result = MemoryFootprint {result.bytes() / *num_threads};
+    }
+    return result;
+}
+
 bool is_experimental_caller(const std::string& caller) noexcept
 {
     return caller == "population" || caller == "polyclone" || caller == "cell";
@@ -2128,6 +2206,7 @@ CallerFactory make_caller_factory(const ReferenceGenome& reference, ReadPipe& re
     }
     const auto target_working_memory = get_target_working_memory(options);
     if (target_working_memory) vc_builder.set_target_memory_footprint(*target_working_memory);
+    vc_builder.set_likelihood_cache_footprint(get_likelihood_cache_footprint(options));
     vc_builder.set_execution_policy(get_thread_execution_policy(options));
     auto bad_region_detector = make_bad_region_detector(options, read_profile);
     if (bad_region_detector) {
@@ -2283,6 +2362,11 @@ bool keep_unfiltered_calls(const OptionMap& options) noexcept
     return options.at("keep-unfiltered-calls").as<bool>();
 }
 
+bool filter_during_calling(const OptionMap& options) noexcept
+{
+    return options.at("filter-during-calling").as<bool>();
+}
+
 ReadPipe make_default_filter_read_pipe(ReadManager& read_manager, std::vector<SampleName> samples)
 {
     using std::make_unique;
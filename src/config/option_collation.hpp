@@ -16,6 +16,7 @@
 #include "basics/ploidy_map.hpp"
 #include "core/callers/caller_factory.hpp"
 #include "core/csr/filters/variant_call_filter_factory.hpp"
+#include "core/models/pairhmm/simd_pair_hmm_kernel.hpp"
 #include "io/reference/reference_genome.hpp"
 #include "io/read/read_manager.hpp"
 #include "io/variant/vcf_writer.hpp"
@@ -36,6 +37,9 @@ boost::optional<fs::path> get_debug_log_file_name(const OptionMap& options);
 boost::optional<fs::path> get_trace_log_file_name(const OptionMap& options);
 
 boost::optional<unsigned> get_num_threads(const OptionMap& options);
+unsigned get_num_decompression_threads(const OptionMap& options);
+
+hmm::simd::InstructionSet get_pair_hmm_instruction_set(const OptionMap& options);
 
 MemoryFootprint get_target_read_buffer_size(const OptionMap& options);
 
@@ -79,6 +83,8 @@ bool use_calling_read_pipe_for_call_filtering(const OptionMap& options) noexcept
 
 bool keep_unfiltered_calls(const OptionMap& options) noexcept;
 
+bool filter_during_calling(const OptionMap& options) noexcept;
+
 ReadPipe make_call_filter_read_pipe(ReadManager& read_manager, const ReferenceGenome& reference, std::vector<SampleName> samples, const OptionMap& options);
 
 boost::optional<fs::path> get_output_path(const OptionMap& options);
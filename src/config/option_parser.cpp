@@ -76,6 +76,10 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<int>()->implicit_value(0),
      "Maximum number of threads to be used. If no argument is provided unlimited threads are assumed")
     
+    ("two-bit-reference",
+     po::bool_switch()->default_value(false),
+     "Read the reference from a memory mapped 2-bit copy (FASTA path + .o2b), which is made if it does not already exist")
+    
     ("max-reference-cache-footprint,X",
      po::value<MemoryFootprint>()->default_value(*parse_footprint("500MB"), "500MB"),
      "Maximum memory footprint for cached reference sequence")
@@ -88,9 +92,21 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<int>()->default_value(250),
      "Limits the number of read files that are open simultaneously")
     
+    ("threaded-decompression",
+     po::bool_switch()->default_value(false),
+     "Decompress and decode BAM, CRAM, and VCF files using a thread pool shared by all files, with size given by --threads")
+    
+    ("pair-hmm-isa",
+     po::value<PairHMMInstructionSet>(),
+     "Instruction set used by the pair HMM [SSE2, AVX2, AVX512]. By default the fastest one the CPU supports is used")
+    
      ("target-working-memory",
      po::value<MemoryFootprint>(),
      "Target working memory footprint for analysis, not including read or reference buffers")
+    
+    ("max-likelihood-cache-footprint",
+     po::value<MemoryFootprint>()->default_value(*parse_footprint("500MB"), "500MB"),
+     "Maximum memory footprint of read likelihoods kept between active regions for reuse, shared between threads. Zero disables the cache")
      
      ("temp-directory-prefix",
      po::value<fs::path>()->default_value("octopus-temp"),
@@ -730,6 +746,11 @@ OptionMap parse_options(const int argc, const char** argv)
     ("keep-unfiltered-calls",
      po::bool_switch()->default_value(false),
      "Keep a copy of unfiltered calls")
+    
+    ("filter-during-calling",
+     po::bool_switch()->default_value(false),
+     "Apply single-pass call filters to calls as they are made, rather than in a second pass over the calls."
+     " Filtered calls may differ slightly from the second pass")
      
     ("annotations",
      po::value<std::vector<std::string>>()->multitoken()->implicit_value(std::vector<std::string> {"active"}, "active")->composing(),
@@ -1578,6 +1599,36 @@ std::ostream& operator<<(std::ostream& out, const ModelPosteriorPolicy& policy)
     return out;
 }
 
+std::istream& operator>>(std::istream& in, PairHMMInstructionSet& result)
+{
+    std::string token;
+    in >> token;
+    if (token == "SSE2")
+        result = PairHMMInstructionSet::sse2;
+    else if (token == "AVX2")
+        result = PairHMMInstructionSet::avx2;
+    else if (token == "AVX512")
+        result = PairHMMInstructionSet::avx512;
+    else throw po::validation_error {po::validation_error::kind_t::invalid_option_value, token, "pair-hmm-isa"};
+    return in;
+}
+
+std::ostream& operator<<(std::ostream& out, const PairHMMInstructionSet& isa)
+{
+    switch (isa) {
+        case PairHMMInstructionSet::sse2:
+            out << "SSE2";
+            break;
+        case PairHMMInstructionSet::avx2:
+            out << "AVX2";
+            break;
+        case PairHMMInstructionSet::avx512:
+            out << "AVX512";
+            break;
+    }
+    return out;
+}
+
 std::istream& operator>>(std::istream& in, SampleDropoutConcentrationPair& result)
 {
     std::string token;
@@ -1722,6 +1773,8 @@ std::ostream& operator<<(std::ostream& os, const OptionMap& options)
             write_vector<SampleDropoutConcentrationPair>(options, label, os, bullet);
         } else if (is_type<ModelPosteriorPolicy>(value)) {
             os << options[label].as<ModelPosteriorPolicy>();
+        } else if (is_type<PairHMMInstructionSet>(value)) {
+            os << options[label].as<PairHMMInstructionSet>();
         } else {
             os << "UnknownType(" << ((boost::any)value.value()).type().name() << ")";
         }
@@ -42,6 +42,7 @@ enum class CandidateVariantDiscoveryProtocol { illumina, pacbio };
 enum class RealignedBAMType { full, mini };
 enum class ReadDeduplicationDetectionPolicy { relaxed, aggressive };
 enum class ModelPosteriorPolicy { all, off, special };
+enum class PairHMMInstructionSet { sse2, avx2, avx512 };
 
 struct SampleDropoutConcentrationPair
 {
@@ -75,6 +76,8 @@ std::istream& operator>>(std::istream& in, ReadDeduplicationDetectionPolicy& typ
 std::ostream& operator<<(std::ostream& os, const ReadDeduplicationDetectionPolicy& type);
 std::istream& operator>>(std::istream& in, ModelPosteriorPolicy& policy);
 std::ostream& operator<<(std::ostream& os, const ModelPosteriorPolicy& policy);
+std::istream& operator>>(std::istream& in, PairHMMInstructionSet& isa);
+std::ostream& operator<<(std::ostream& os, const PairHMMInstructionSet& isa);
 std::istream& operator>>(std::istream& in, SampleDropoutConcentrationPair& concentration);
 std::ostream& operator<<(std::ostream& os, const SampleDropoutConcentrationPair& concentration);
 
@@ -145,11 +145,37 @@ auto convert_to_vcf(std::deque<CallWrapper>&& calls, const VcfRecordFactory& fac
 } // namespace
 
 std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMeter& progress_meter) const
+{
+    ReadMap reads {};
+    return call(call_region, progress_meter, reads);
+}
+
+std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMeter& progress_meter, ReadMap& reads,
+                                   std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
 {
     ReadPipe::Report reads_report {};
-    ReadMap reads;
+    return call(call_region, progress_meter, reads, reads_report, false, likelihoods);
+}
+
+Caller::CallingReads Caller::fetch_reads(const GenomicRegion& call_region) const
+{
+    CallingReads result {call_region, {}, {}};
+    result.reads = read_pipe_.get().fetch_reads(get_read_region(call_region), result.report);
+    return result;
+}
+
+std::deque<VcfRecord> Caller::call(CallingReads& reads, ProgressMeter& progress_meter,
+                                   std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
+{
+    return call(reads.call_region, progress_meter, reads.reads, reads.report, true, likelihoods);
+}
+
+std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMeter& progress_meter,
+                                   ReadMap& reads, ReadPipe::Report& reads_report, const bool have_reads,
+                                   std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
+{
     if (candidate_generator_.requires_reads()) {
-        reads = read_pipe_.get().fetch_reads(expand(call_region, 100), reads_report);
+        if (!have_reads) reads = read_pipe_.get().fetch_reads(get_read_region(call_region), reads_report);
         add_reads(reads, candidate_generator_);
         if (!refcalls_requested() && all_empty(reads)) {
             if (debug_log_) stream(*debug_log_) << "Stopping early as no reads found in call region " << call_region;
@@ -164,9 +190,9 @@ std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMet
         progress_meter.log_completed(call_region);
         return {};
     }
-    if (!candidate_generator_.requires_reads()) {
+    if (!candidate_generator_.requires_reads() && !have_reads) {
         // as we didn't fetch them earlier
-        reads = read_pipe_.get().fetch_reads(call_region, reads_report);
+        reads = read_pipe_.get().fetch_reads(get_read_region(call_region), reads_report);
     }
     candidate_generator_ = {};
     std::vector<GenomicRegion> likely_difficult_regions {};
@@ -188,7 +214,9 @@ std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMet
     const auto read_templates = make_read_templates(reads);
     auto haplotype_generator = make_haplotype_generator(candidates, reads, read_templates);
     for (auto& region : likely_difficult_regions) haplotype_generator.add_lagging_exclusion_zone(region);
-    auto calls = call_variants(call_region, candidates, reads, read_templates, haplotype_generator, progress_meter);
+    // Likelihoods computed from read templates are not for the reads themselves, so cannot be saved
+    if (read_templates) likelihoods = nullptr;
+    auto calls = call_variants(call_region, candidates, reads, read_templates, haplotype_generator, progress_meter, likelihoods);
     candidates.clear();
     candidates.shrink_to_fit();
     progress_meter.log_completed(call_region);
@@ -214,6 +242,11 @@ auto assign_and_realign(const std::vector<AlignedRead>& reads, const Genotype<Ha
 
 // private methods
 
+GenomicRegion Caller::get_read_region(const GenomicRegion& call_region) const
+{
+    return candidate_generator_.requires_reads() ? expand(call_region, 100) : call_region;
+}
+
 namespace debug {
 
 template <typename S>
@@ -400,9 +433,12 @@ Caller::call_variants(const GenomicRegion& call_region,
                       const ReadMap& reads,
                       const boost::optional<TemplateMap>& read_templates,
                       HaplotypeGenerator& haplotype_generator,
-                      ProgressMeter& progress_meter) const
+                      ProgressMeter& progress_meter,
+                      std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
 {
     auto haplotype_likelihoods = make_haplotype_likelihood_cache();
+    // Likelihoods are kept between active regions as many read-haplotype pairs are evaluated again
+    auto persistent_likelihoods = make_persistent_likelihood_cache();
     std::deque<CallWrapper> result {};
     if (candidates.empty()) {
         if (refcalls_requested()) {
@@ -457,7 +493,8 @@ Caller::call_variants(const GenomicRegion& call_region,
             continue;
         }
         if (debug_log_) stream(*debug_log_) << "There are " << count_reads(active_reads) << " active reads in " << active_region;
-        if (!compute_haplotype_likelihoods(haplotype_likelihoods, active_region, haplotypes, candidates, active_reads)) {
+        if (!compute_haplotype_likelihoods(haplotype_likelihoods, active_region, haplotypes, candidates, active_reads,
+                                           persistent_likelihoods.get_ptr())) {
             haplotype_generator.clear_progress();
             haplotype_likelihoods.clear();
             continue;
@@ -508,12 +545,18 @@ Caller::call_variants(const GenomicRegion& call_region,
             if (have_callable_region(active_region, next_active_region, backtrack_region, call_region)) {
                 call_variants(active_region, call_region, next_active_region, backtrack_region,
                               candidates, haplotypes, haplotype_likelihoods, reads, *caller_latents,
-                              result, prev_called_region, completed_region);
+                              result, prev_called_region, completed_region, likelihoods);
             }
         }
         haplotype_likelihoods.clear();
         progress_meter.log_completed(completed_region);
     }
+    if (debug_log_ && persistent_likelihoods) {
+        stream(*debug_log_) << "Haplotype likelihood cache for " << call_region << ": "
+                            << persistent_likelihoods->num_hits() << " hits, "
+                            << persistent_likelihoods->num_misses() << " misses, "
+                            << persistent_likelihoods->num_evictions() << " evictions";
+    }
     return result;
 }
 
@@ -852,7 +895,8 @@ void Caller::call_variants(const GenomicRegion& active_region,
                            const Latents& latents,
                            std::deque<CallWrapper>& result,
                            boost::optional<GenomicRegion>& prev_called_region,
-                           GenomicRegion& completed_region) const
+                           GenomicRegion& completed_region,
+                           std::vector<SavedHaplotypeLikelihoods>* saved_likelihoods) const
 {
     const auto passed_region = get_passed_region(active_region, next_active_region, backtrack_region);
     const auto uncalled_region = get_uncalled_region(active_region, passed_region, completed_region);
@@ -865,6 +909,16 @@ void Caller::call_variants(const GenomicRegion& active_region,
         if (!calls.empty()) {
             set_model_posteriors(calls, latents, haplotypes, haplotype_likelihoods);
             set_phasing(calls, latents, haplotypes, call_region);
+            if (saved_likelihoods) {
+                // The reference is kept for assigning reads to homozygous non-reference genotypes
+                auto saved_haplotypes = get_called_haplotypes(latents);
+                const auto reference_itr = find_reference(haplotypes);
+                if (reference_itr != std::cend(haplotypes)) saved_haplotypes.push_back(*reference_itr);
+                std::sort(std::begin(saved_haplotypes), std::end(saved_haplotypes));
+                saved_haplotypes.erase(std::unique(std::begin(saved_haplotypes), std::end(saved_haplotypes)), std::end(saved_haplotypes));
+                saved_likelihoods->push_back(save_likelihoods(haplotype_likelihoods, {std::cbegin(saved_haplotypes), std::cend(saved_haplotypes)},
+                                                              reads, active_region));
+            }
         }
     }
     if (refcalls_requested()) {
@@ -1068,6 +1122,15 @@ HaplotypeLikelihoodArray Caller::make_haplotype_likelihood_cache() const
     return HaplotypeLikelihoodArray {likelihood_model_, parameters_.max_haplotypes, samples_};
 }
 
+boost::optional<HaplotypeLikelihoodCache> Caller::make_persistent_likelihood_cache() const
+{
+    if (parameters_.max_likelihood_cache_footprint && parameters_.max_likelihood_cache_footprint->bytes() > 0) {
+        return HaplotypeLikelihoodCache {*parameters_.max_likelihood_cache_footprint};
+    } else {
+        return boost::none;
+    }
+}
+
 VcfRecordFactory Caller::make_record_factory(const ReadMap& reads) const
 {
     return VcfRecordFactory {reference_, reads, samples_, parameters_.call_sites_only};
@@ -1115,7 +1178,8 @@ bool Caller::compute_haplotype_likelihoods(HaplotypeLikelihoodArray& haplotype_l
                                            const GenomicRegion& active_region,
                                            const HaplotypeBlock& haplotypes,
                                            const MappableFlatSet<Variant>& candidates,
-                                           const boost::variant<ReadMap, TemplateMap>& active_reads) const
+                                           const boost::variant<ReadMap, TemplateMap>& active_reads,
+                                           HaplotypeLikelihoodCache* persistent_likelihoods) const
 {
     assert(haplotype_likelihoods.is_empty());
     boost::optional<HaplotypeLikelihoodArray::FlankState> flank_state {};
@@ -1132,7 +1196,7 @@ bool Caller::compute_haplotype_likelihoods(HaplotypeLikelihoodArray& haplotype_l
     }
     try {
         boost::apply_visitor([&] (const auto& reads) { 
-            haplotype_likelihoods.populate(reads, haplotypes, std::move(flank_state)); }, active_reads);
+            haplotype_likelihoods.populate(reads, haplotypes, std::move(flank_state), persistent_likelihoods); }, active_reads);
     } catch(const HaplotypeLikelihoodModel::ShortHaplotypeError& e) {
         if (debug_log_) {
             stream(*debug_log_) << "Skipping " << active_region << " as a haplotype was too short by "
@@ -69,12 +69,21 @@ public:
         ModelPosteriorPolicy model_posterior_policy;
         bool protect_reference_haplotype;
         boost::optional<MemoryFootprint> target_max_memory;
+        boost::optional<MemoryFootprint> max_likelihood_cache_footprint;
         ExecutionPolicy execution_policy;
         ReadLinkageType read_linkage;
     };
     
     using ReadMap = octopus::ReadMap;
     
+    // The reads call uses for a call region, which may be fetched ahead of calling
+    struct CallingReads
+    {
+        GenomicRegion call_region;
+        ReadMap reads;
+        ReadPipe::Report report;
+    };
+    
     Caller() = delete;
     
     Caller(Components&& components, Parameters parameters);
@@ -94,6 +103,15 @@ public:
     unsigned max_callable_ploidy() const;
     
     std::deque<VcfRecord> call(const GenomicRegion& call_region, ProgressMeter& progress_meter) const;
+    // Also returns the reads used for calling so they can be reused (e.g. for call filtering). If likelihoods
+    // is given, the likelihoods of the called haplotypes in each active region are saved to it.
+    std::deque<VcfRecord> call(const GenomicRegion& call_region, ProgressMeter& progress_meter, ReadMap& reads,
+                               std::vector<SavedHaplotypeLikelihoods>* likelihoods = nullptr) const;
+    
+    CallingReads fetch_reads(const GenomicRegion& call_region) const;
+    // Calls with reads from fetch_reads rather than fetching them, which gives the same calls
+    std::deque<VcfRecord> call(CallingReads& reads, ProgressMeter& progress_meter,
+                               std::vector<SavedHaplotypeLikelihoods>* likelihoods = nullptr) const;
     
     std::vector<VcfRecord> regenotype(const std::vector<Variant>& variants, ProgressMeter& progress_meter) const;
     
@@ -171,6 +189,10 @@ private:
     
     // helper methods
     
+    GenomicRegion get_read_region(const GenomicRegion& call_region) const;
+    std::deque<VcfRecord> call(const GenomicRegion& call_region, ProgressMeter& progress_meter,
+                               ReadMap& reads, ReadPipe::Report& reads_report, bool have_reads,
+                               std::vector<SavedHaplotypeLikelihoods>* likelihoods) const;
     boost::optional<TemplateMap> make_read_templates(const ReadMap& reads) const;
     std::deque<CallWrapper>
     call_variants(const GenomicRegion& call_region,
@@ -178,7 +200,8 @@ private:
                   const ReadMap& reads,
                   const boost::optional<TemplateMap>& read_templates,
                   HaplotypeGenerator& haplotype_generator,
-                  ProgressMeter& progress_meter) const;
+                  ProgressMeter& progress_meter,
+                  std::vector<SavedHaplotypeLikelihoods>* likelihoods) const;
     bool refcalls_requested() const noexcept;
     MappableFlatSet<Variant> generate_candidate_variants(const GenomicRegion& region) const;
     HaplotypeGenerator 
@@ -186,13 +209,15 @@ private:
                              const ReadMap& reads,
                              const boost::optional<TemplateMap>& read_templates) const;
     HaplotypeLikelihoodArray make_haplotype_likelihood_cache() const;
+    boost::optional<HaplotypeLikelihoodCache> make_persistent_likelihood_cache() const;
     VcfRecordFactory make_record_factory(const ReadMap& reads) const;
     std::vector<Haplotype>
     filter(HaplotypeBlock& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods,
            const std::deque<Haplotype>& protected_haplotypes) const;
     bool compute_haplotype_likelihoods(HaplotypeLikelihoodArray& haplotype_likelihoods, const GenomicRegion& active_region,
                                        const HaplotypeBlock& haplotypes, const MappableFlatSet<Variant>& candidates,
-                                       const boost::variant<ReadMap, TemplateMap>& active_reads) const;
+                                       const boost::variant<ReadMap, TemplateMap>& active_reads,
+                                       HaplotypeLikelihoodCache* persistent_likelihoods = nullptr) const;
     std::vector<std::reference_wrapper<const Haplotype>>
     get_removable_haplotypes(const HaplotypeBlock& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods,
                              const Latents::HaplotypeProbabilityMap& haplotype_posteriors,
@@ -230,7 +255,8 @@ private:
                        const MappableFlatSet<Variant>& candidates, const HaplotypeBlock& haplotypes,
                        const HaplotypeLikelihoodArray& haplotype_likelihoods, const ReadMap& reads,
                        const Latents& latents, std::deque<CallWrapper>& result,
-                       boost::optional<GenomicRegion>& prev_called_region, GenomicRegion& completed_region) const;
+                       boost::optional<GenomicRegion>& prev_called_region, GenomicRegion& completed_region,
+                       std::vector<SavedHaplotypeLikelihoods>* saved_likelihoods) const;
     GenotypeCallMap get_genotype_calls(const Latents& latents) const;
     std::deque<Haplotype> get_called_haplotypes(const Latents& latents) const;
     void set_model_posteriors(std::vector<CallWrapper>& calls, const Latents& latents,
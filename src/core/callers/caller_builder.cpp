@@ -123,6 +123,12 @@ CallerBuilder& CallerBuilder::set_target_memory_footprint(MemoryFootprint memory
     return *this;
 }
 
+CallerBuilder& CallerBuilder::set_likelihood_cache_footprint(MemoryFootprint memory) noexcept
+{
+    params_.general.max_likelihood_cache_footprint = memory;
+    return *this;
+}
+
 CallerBuilder& CallerBuilder::set_execution_policy(ExecutionPolicy policy) noexcept
 {
     params_.general.execution_policy = policy;
@@ -376,8 +382,7 @@ std::unique_ptr<Caller> CallerBuilder::build(const ContigName& contig) const
     if (factory_.count(caller_) == 0) {
         throw std::runtime_error {"CallerBuilder: unknown caller " + caller_};
     }
-    requested_contig_ = contig;
-    return factory_.at(caller_)();
+    return factory_.at(caller_)(contig);
 }
 
 // private methods
@@ -443,11 +448,11 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
 {
     const auto& samples = components_.read_pipe.get().samples();
     return CallerFactoryMap {
-        {"individual", [this, &samples] () {
+        {"individual", [this, &samples] (const ContigName& contig) {
             return std::make_unique<IndividualCaller>(make_components(),
                                                       params_.general,
                                                       IndividualCaller::Parameters {
-                                                          params_.ploidies.of(samples.front(), *requested_contig_),
+                                                          params_.ploidies.of(samples.front(), contig),
                                                           make_individual_prior_model(params_.snp_heterozygosity, params_.indel_heterozygosity),
                                                           params_.min_variant_posterior,
                                                           params_.min_refcall_posterior,
@@ -455,20 +460,20 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                           params_.max_genotypes
                                                       });
         }},
-        {"population", [this, &samples] () {
+        {"population", [this, &samples] (const ContigName& contig) {
             return std::make_unique<PopulationCaller>(make_components(),
                                                       params_.general,
                                                       PopulationCaller::Parameters {
                                                           params_.min_variant_posterior,
                                                           params_.min_refcall_posterior,
-                                                          get_ploidies(samples, *requested_contig_, params_.ploidies),
+                                                          get_ploidies(samples, contig, params_.ploidies),
                                                           make_population_prior_model(params_.snp_heterozygosity, params_.indel_heterozygosity),
                                                           params_.max_joint_genotypes,
                                                           params_.use_independent_genotype_priors,
                                                           params_.deduplicate_haplotypes_with_caller_model
                                                       });
         }},
-        {"cancer", [this, &samples] () {
+        {"cancer", [this, &samples] (const ContigName& contig) {
             boost::optional<SampleName> normal {};
             if (!params_.normal_samples.empty()) {
                 normal = params_.normal_samples.front();
@@ -477,7 +482,7 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                 params_.min_variant_posterior,
                 params_.min_somatic_posterior,
                 params_.min_refcall_posterior,
-                params_.ploidies.of(samples.front(), *requested_contig_),
+                params_.ploidies.of(samples.front(), contig),
                 std::move(normal),
                 make_cancer_prior_model(params_.snp_heterozygosity, params_.indel_heterozygosity),
                 {params_.somatic_snv_prior, params_.somatic_indel_prior},
@@ -493,14 +498,14 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
             cancer_params.concentrations.somatic.tumour_germline = params_.tumour_germline_concentration;
             return std::make_unique<CancerCaller>(make_components(), params_.general, std::move(cancer_params));
         }},
-        {"trio", [this] () {
+        {"trio", [this] (const ContigName& contig) {
             return std::make_unique<TrioCaller>(make_components(),
                                                 params_.general,
                                                 TrioCaller::Parameters {
                                                     *params_.trio,
-                                                    params_.ploidies.of(params_.trio->mother(), *requested_contig_),
-                                                    params_.ploidies.of(params_.trio->father(), *requested_contig_),
-                                                    params_.ploidies.of(params_.trio->child(), *requested_contig_),
+                                                    params_.ploidies.of(params_.trio->mother(), contig),
+                                                    params_.ploidies.of(params_.trio->father(), contig),
+                                                    params_.ploidies.of(params_.trio->child(), contig),
                                                     make_trio_prior_model(params_.snp_heterozygosity, params_.indel_heterozygosity),
                                                     {*params_.snv_denovo_prior, *params_.indel_denovo_prior},
                                                     params_.min_variant_posterior,
@@ -510,7 +515,7 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                     params_.deduplicate_haplotypes_with_caller_model
                                                 });
         }},
-        {"polyclone", [this] () {
+        {"polyclone", [this] (const ContigName& contig) {
             return std::make_unique<PolycloneCaller>(make_components(),
                                                      params_.general,
                                                      PolycloneCaller::Parameters {
@@ -525,11 +530,11 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                          params_.clone_concentration
                                                      });
         }},
-        {"cell", [this, &samples] () {
+        {"cell", [this, &samples] (const ContigName& contig) {
             return std::make_unique<CellCaller>(make_components(),
                                                 params_.general,
                                                 CellCaller::Parameters {
-                                                    params_.ploidies.of(samples.front(), *requested_contig_),
+                                                    params_.ploidies.of(samples.front(), contig),
                                                     make_individual_prior_model(params_.snp_heterozygosity, params_.indel_heterozygosity),
                                                     params_.min_variant_posterior,
                                                     params_.min_refcall_posterior,
@@ -53,6 +53,7 @@ public:
     CallerBuilder& set_sites_only() noexcept;
     CallerBuilder& set_reference_haplotype_protection(bool b) noexcept;
     CallerBuilder& set_target_memory_footprint(MemoryFootprint memory) noexcept;
+    CallerBuilder& set_likelihood_cache_footprint(MemoryFootprint memory) noexcept;
     CallerBuilder& set_execution_policy(ExecutionPolicy policy) noexcept;
     CallerBuilder& set_read_linkage(ReadLinkageType linkage) noexcept;
     CallerBuilder& set_bad_region_detector(BadRegionDetector detector) noexcept;
@@ -167,15 +168,13 @@ private:
         boost::optional<Pedigree> pedigree;
     };
     
-    using CallerFactoryMap = std::unordered_map<std::string, std::function<std::unique_ptr<Caller>()>>;
+    using CallerFactoryMap = std::unordered_map<std::string, std::function<std::unique_ptr<Caller>(const ContigName&)>>;
     
     std::string caller_;
     Components components_;
     Parameters params_;
     CallerFactoryMap factory_;
     
-    mutable boost::optional<ContigName> requested_contig_;
-    
     Caller::Components make_components() const;
     CallerFactoryMap generate_factory() const;
 };
@@ -24,9 +24,11 @@
 #include "core/types/allele.hpp"
 #include "core/types/variant.hpp"
 #include "core/types/genotype.hpp"
+#include "core/types/allele_incidence_matrix.hpp"
 #include "core/models/genotype/uniform_genotype_prior_model.hpp"
 #include "core/models/genotype/coalescent_genotype_prior_model.hpp"
 #include "core/models/genotype/constant_mixture_genotype_likelihood_model.hpp"
+#include "core/models/genotype/top_genotype_enumeration.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/sequence_utils.hpp"
 #include "utils/merge_transform.hpp"
@@ -140,7 +142,7 @@ CancerCaller::infer_latents(const HaplotypeBlock& haplotypes,
     // Store any intermediate results in Latents for reuse, so the order of model evaluation matters!
     auto result = std::make_unique<Latents>(haplotypes, samples_, parameters_);
     set_model_priors(*result);
-    generate_germline_genotypes(*result, haplotypes);
+    generate_germline_genotypes(*result, haplotypes, haplotype_likelihoods);
     if (debug_log_) stream(*debug_log_) << "There are " << result->germline_genotypes_.size() << " candidate germline genotypes";
     evaluate_germline_model(*result, haplotype_likelihoods);
     evaluate_cnv_model(*result, haplotype_likelihoods);
@@ -288,9 +290,18 @@ auto pool_likelihood(const std::vector<SampleName>& samples,
     return result;
 }
 
-void CancerCaller::generate_germline_genotypes(Latents& latents, const HaplotypeBlock& haplotypes) const
+void CancerCaller::generate_germline_genotypes(Latents& latents, const HaplotypeBlock& haplotypes,
+                                               const HaplotypeLikelihoodArray& haplotype_likelihoods) const
 {
-    if (haplotypes.size() < 4) {
+    const auto num_possible_genotypes = haplotypes.size() >= parameters_.ploidy ? num_genotypes_noexcept(haplotypes.size(), parameters_.ploidy) : boost::none;
+    if (parameters_.max_genotypes && haplotypes.size() >= parameters_.ploidy
+        && !(num_possible_genotypes && *num_possible_genotypes <= *parameters_.max_genotypes)) {
+        const auto pooled_likelihoods = pool_likelihood(samples_, haplotypes, haplotype_likelihoods);
+        model::TopGenotypeEnumerationParameters enumeration_params {*parameters_.max_genotypes};
+        auto germline_genotype_indices = model::enumerate_top_genotypes(haplotypes, parameters_.ploidy, pooled_likelihoods, enumeration_params);
+        latents.germline_genotypes_ = make_genotypes(haplotypes, germline_genotype_indices);
+        latents.germline_genotype_indices_ = std::move(germline_genotype_indices);
+    } else if (haplotypes.size() < 4) {
         latents.germline_genotypes_ = generate_all_genotypes(haplotypes, parameters_.ploidy);
     } else {
         std::vector<GenotypeIndex> germline_genotype_indices {};
@@ -996,23 +1007,24 @@ auto find_map_genotype(const L& posteriors)
 
 // germline variant posterior calculations
 
-template <typename M>
-Phred<double> marginalise(const Allele& allele, const M& genotype_posteriors)
-{
-    auto p = std::accumulate(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors),
-                             0.0, [&allele] (const auto curr, const auto& p) {
-                                 return curr + (contains(p.first, allele) ? 0.0 : p.second);
-                             });
-    return probability_false_to_phred(p);
-}
-
 template <typename M>
 VariantPosteriorVector compute_candidate_posteriors(const std::vector<Variant>& candidates, const M& genotype_posteriors)
 {
+    std::vector<Allele> alleles {};
+    alleles.reserve(candidates.size());
+    std::transform(std::cbegin(candidates), std::cend(candidates), std::back_inserter(alleles),
+                   [] (const Variant& candidate) { return candidate.alt_allele(); });
+    const AlleleIncidenceMatrix contained_alleles {alleles, genotype_posteriors,
+                                                   [] (const auto& p) -> const Genotype<Haplotype>& { return p.first; }};
+    std::vector<double> posteriors {};
+    posteriors.reserve(genotype_posteriors.size());
+    for (const auto& p : genotype_posteriors) posteriors.push_back(p.second);
     VariantPosteriorVector result {};
     result.reserve(candidates.size());
-    for (const auto& candidate : candidates) {
-        result.emplace_back(candidate, marginalise(candidate.alt_allele(), genotype_posteriors));
+    for (std::size_t i {0}; i < candidates.size(); ++i) {
+        double p {0};
+        contained_alleles.for_each_excluding(i, [&] (const std::size_t genotype) { p += posteriors[genotype]; });
+        result.emplace_back(candidates[i], probability_false_to_phred(p));
     }
     return result;
 }
@@ -142,7 +142,8 @@ private:
     using GermlineGenotypeProbabilityMap = std::unordered_map<GermlineGenotypeReference, double>;
     using ProbabilityVector              = std::vector<double>;
     
-    void generate_germline_genotypes(Latents& latents, const HaplotypeBlock& haplotypes) const;
+    void generate_germline_genotypes(Latents& latents, const HaplotypeBlock& haplotypes,
+                                     const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void generate_cancer_genotypes(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void generate_cancer_genotypes_with_clean_normal(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void generate_cancer_genotypes_with_contaminated_normal(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
@@ -203,7 +204,7 @@ private:
     std::vector<Genotype<Haplotype>> germline_genotypes_;
     unsigned somatic_ploidy_ = 1;
     std::vector<CancerGenotype<Haplotype>> cancer_genotypes_;
-    boost::optional<std::vector<std::vector<unsigned>>> germline_genotype_indices_ = boost::none;
+    boost::optional<std::vector<GenotypeIndex>> germline_genotype_indices_ = boost::none;
     boost::optional<std::vector<CancerGenotypeIndex>> cancer_genotype_indices_ = boost::none;
     CancerCaller::ModelPriors model_priors_;
     std::unique_ptr<GenotypePriorModel> germline_prior_model_ = nullptr;
@@ -5,7 +5,6 @@
 
 #include <typeinfo>
 #include <unordered_map>
-#include <deque>
 #include <algorithm>
 #include <numeric>
 #include <iterator>
@@ -21,6 +20,7 @@
 #include "core/types/allele.hpp"
 #include "core/types/variant.hpp"
 #include "core/types/phylogeny.hpp"
+#include "core/types/allele_incidence_matrix.hpp"
 #include "core/types/calls/cell_variant_call.hpp"
 #include "core/types/calls/reference_call.hpp"
 #include "core/models/genotype/uniform_genotype_prior_model.hpp"
@@ -541,27 +541,24 @@ using GenotypeCalls = std::vector<std::vector<GenotypeCall>>;
 
 // allele posterior calculations
 
-using AlleleBools           = std::deque<bool>; // using std::deque because std::vector<bool> is evil
-using GenotypePropertyBools = std::vector<AlleleBools>;
-
-auto marginalise(const GenotypeProbabilityMap& genotype_posteriors,
-                 const AlleleBools& contained_alleles)
+auto marginalise(const std::vector<double>& genotype_posteriors,
+                 const AlleleIncidenceMatrix& contained_alleles, const std::size_t allele)
 {
-    auto p = std::inner_product(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors),
-                                std::cbegin(contained_alleles), 0.0, std::plus<> {},
-                                [] (const auto& p, const bool is_contained) {
-                                    return is_contained ? 0.0 : p.second;
-                                });
+    double p {0};
+    contained_alleles.for_each_excluding(allele, [&] (const std::size_t genotype) { p += genotype_posteriors[genotype]; });
     return probability_false_to_phred(p);
 }
 
 auto compute_sample_allele_posteriors(const GenotypeProbabilityMap& genotype_posteriors,
-                                      const GenotypePropertyBools& contained_alleles)
+                                      const AlleleIncidenceMatrix& contained_alleles)
 {
+    thread_local std::vector<double> posteriors {};
+    posteriors.clear();
+    for (const auto& p : genotype_posteriors) posteriors.push_back(p.second);
     std::vector<Phred<double>> result {};
-    result.reserve(contained_alleles.size());
-    for (const auto& allele : contained_alleles) {
-        result.emplace_back(marginalise(genotype_posteriors, allele));
+    result.reserve(contained_alleles.num_alleles());
+    for (std::size_t allele {0}; allele < contained_alleles.num_alleles(); ++allele) {
+        result.emplace_back(marginalise(posteriors, contained_alleles, allele));
     }
     return result;
 }
@@ -569,21 +566,12 @@ auto compute_sample_allele_posteriors(const GenotypeProbabilityMap& genotype_pos
 auto get_contained_alleles(const PopulationGenotypeProbabilityMap& genotype_posteriors,
                            const std::vector<Allele>& alleles)
 {
-    const auto num_genotypes = genotype_posteriors.size2();
-    GenotypePropertyBools result {};
-    if (num_genotypes == 0 || genotype_posteriors.empty1() || alleles.empty()) {
-        return result;
-    }
-    result.reserve(alleles.size());
-    const auto& test_sample   = genotype_posteriors.begin()->first;
-    const auto genotype_begin = genotype_posteriors.begin(test_sample);
-    const auto genotype_end   = genotype_posteriors.end(test_sample);
-    for (const auto& allele : alleles) {
-        result.emplace_back(num_genotypes);
-        std::transform(genotype_begin, genotype_end, std::begin(result.back()),
-                       [&] (const auto& p) { return contains(p.first, allele); });
+    if (genotype_posteriors.size2() == 0 || genotype_posteriors.empty1() || alleles.empty()) {
+        return AlleleIncidenceMatrix {};
     }
-    return result;
+    const auto& test_sample = genotype_posteriors.begin()->first;
+    return AlleleIncidenceMatrix {alleles, genotype_posteriors[test_sample],
+                                  [] (const auto& p) -> const Genotype<Haplotype>& { return p.first; }};
 }
 
 using AllelePosteriorMatrix = std::vector<std::vector<Phred<double>>>;
@@ -19,15 +19,16 @@
 #include "containers/probability_matrix.hpp"
 #include "core/types/allele.hpp"
 #include "core/types/variant.hpp"
+#include "core/types/allele_incidence_matrix.hpp"
 #include "core/types/calls/germline_variant_call.hpp"
 #include "core/types/calls/reference_call.hpp"
 #include "core/models/genotype/uniform_genotype_prior_model.hpp"
 #include "core/models/genotype/coalescent_genotype_prior_model.hpp"
+#include "core/models/genotype/top_genotype_enumeration.hpp"
 #include "utils/maths.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/append.hpp"
-#include "utils/select_top_k.hpp"
 #include "logging/logging.hpp"
 
 namespace octopus {
@@ -75,19 +76,52 @@ std::size_t IndividualCaller::do_remove_duplicates(HaplotypeBlock& haplotypes) c
 
 // IndividualCaller::Latents public methods
 
+namespace {
+
+// Genotypes with smaller log posteriors have zero posterior probability, and any quality they could
+// contribute to is well above the maximum reported QUAL and GQ, so they are not materialised.
+constexpr double min_retained_genotype_log_posterior {-25'000};
+
+} // namespace
+
 IndividualCaller::Latents::Latents(const SampleName& sample,
                                    const HaplotypeBlock& haplotypes,
-                                   std::vector<Genotype<Haplotype>>&& genotypes,
+                                   const std::vector<GenotypeIndex>& genotypes,
                                    ModelInferences&& inferences)
 : genotype_posteriors_ {}
 , haplotype_posteriors_ {}
+, dropped_haplotypes_ {}
 , model_log_evidence_ {inferences.log_evidence}
 {
-    GenotypeProbabilityMap genotype_log_posteriors {std::cbegin(genotypes), std::cend(genotypes)};
-    insert_sample(sample, inferences.posteriors.genotype_log_probabilities, genotype_log_posteriors);
+    const auto& log_posteriors = inferences.posteriors.genotype_log_probabilities;
+    const auto& posteriors = inferences.posteriors.genotype_probabilities;
+    std::vector<GenotypeIndex> retained_genotypes {};
+    std::vector<double> retained_log_posteriors {}, retained_posteriors {};
+    std::vector<bool> is_candidate_haplotype(haplotypes.size(), false), is_retained_haplotype(haplotypes.size(), false);
+    for (std::size_t i {0}; i < genotypes.size(); ++i) {
+        const bool retain {log_posteriors[i] >= min_retained_genotype_log_posterior};
+        for (const auto haplotype_idx : genotypes[i]) {
+            is_candidate_haplotype[haplotype_idx] = true;
+            if (retain) is_retained_haplotype[haplotype_idx] = true;
+        }
+        if (retain) {
+            retained_genotypes.push_back(genotypes[i]);
+            retained_log_posteriors.push_back(log_posteriors[i]);
+            retained_posteriors.push_back(posteriors[i]);
+        }
+    }
+    assert(!retained_genotypes.empty());
+    for (std::size_t i {0}; i < haplotypes.size(); ++i) {
+        if (is_candidate_haplotype[i] && !is_retained_haplotype[i]) {
+            dropped_haplotypes_.push_back(haplotypes[i]);
+        }
+    }
+    auto called_genotypes = make_genotypes(haplotypes, retained_genotypes);
+    GenotypeProbabilityMap genotype_log_posteriors {std::cbegin(called_genotypes), std::cend(called_genotypes)};
+    insert_sample(sample, retained_log_posteriors, genotype_log_posteriors);
     genotype_log_posteriors_  = std::make_shared<GenotypeProbabilityMap>(std::move(genotype_log_posteriors));
-    GenotypeProbabilityMap genotype_posteriors {std::make_move_iterator(std::begin(genotypes)), std::make_move_iterator(std::end(genotypes))};
-    insert_sample(sample, inferences.posteriors.genotype_probabilities, genotype_posteriors);
+    GenotypeProbabilityMap genotype_posteriors {std::make_move_iterator(std::begin(called_genotypes)), std::make_move_iterator(std::end(called_genotypes))};
+    insert_sample(sample, retained_posteriors, genotype_posteriors);
     genotype_posteriors_  = std::make_shared<GenotypeProbabilityMap>(std::move(genotype_posteriors));
     haplotype_posteriors_ = std::make_shared<HaplotypeProbabilityMap>(calculate_haplotype_posteriors(haplotypes));
 }
@@ -127,15 +161,15 @@ std::unique_ptr<IndividualCaller::Caller::Latents>
 IndividualCaller::infer_latents(const HaplotypeBlock& haplotypes,
                                 const HaplotypeLikelihoodArray& haplotype_likelihoods) const
 {
-    auto indexed_genotypes = propose_genotypes(haplotypes, haplotype_likelihoods);
-    if (debug_log_) stream(*debug_log_) << "There are " << indexed_genotypes.genotypes.size() << " candidate genotypes";
+    const auto genotypes = propose_genotypes(haplotypes, haplotype_likelihoods);
+    if (debug_log_) stream(*debug_log_) << "There are " << genotypes.size() << " candidate genotypes";
     auto prior_model = make_prior_model(haplotypes);
     prior_model->prime(haplotypes);
     model::IndividualModel model {*prior_model, debug_log_, trace_log_};
     model.prime(haplotypes);
     haplotype_likelihoods.prime(sample());
-    auto inferences = model.evaluate(indexed_genotypes.genotypes, indexed_genotypes.indices, haplotype_likelihoods);
-    return std::make_unique<Latents>(sample(), haplotypes, std::move(indexed_genotypes.genotypes), std::move(inferences));
+    auto inferences = model.evaluate(genotypes, haplotype_likelihoods);
+    return std::make_unique<Latents>(sample(), haplotypes, genotypes, std::move(inferences));
 }
 
 boost::optional<double>
@@ -162,9 +196,11 @@ IndividualCaller::calculate_model_posterior(const HaplotypeBlock& haplotypes,
                                             const HaplotypeLikelihoodArray& haplotype_likelihoods,
                                             const Latents& latents) const
 {
-    const auto genotypes = generate_all_genotypes(haplotypes, parameters_.ploidy + 1);
+    const auto genotypes = generate_all_genotype_indices(static_cast<unsigned>(haplotypes.size()), parameters_.ploidy + 1);
     const auto prior_model = make_prior_model(haplotypes);
-    const model::IndividualModel model {*prior_model, debug_log_};
+    prior_model->prime(haplotypes);
+    model::IndividualModel model {*prior_model, debug_log_};
+    model.prime(haplotypes);
     haplotype_likelihoods.prime(sample());
     const auto inferences = model.evaluate(genotypes, haplotype_likelihoods);
     return octopus::calculate_model_posterior(latents.model_log_evidence_, inferences.log_evidence);
@@ -215,6 +251,15 @@ using GenotypeCalls = std::vector<GenotypeCall>;
 
 // allele posterior calculations
 
+Phred<> marginalise_excluded(const std::vector<double>& excluded_genotype_log_posteriors)
+{
+    if (!excluded_genotype_log_posteriors.empty()) {
+        return log_probability_false_to_phred(std::min(maths::log_sum_exp(excluded_genotype_log_posteriors), 0.0));
+    } else {
+        return Phred<> {std::numeric_limits<double>::infinity()};
+    }
+}
+
 template <typename GenotypeOrAllele>
 auto marginalise_contained(const GenotypeOrAllele& element, const GenotypeProbabilityMap& genotype_log_posteriors)
 {
@@ -225,20 +270,28 @@ auto marginalise_contained(const GenotypeOrAllele& element, const GenotypeProbab
             buffer.push_back(p.second);
         }
     }
-    if (!buffer.empty()) {
-        return log_probability_false_to_phred(std::min(maths::log_sum_exp(buffer), 0.0));
-    } else {
-        return Phred<> {std::numeric_limits<double>::infinity()};
-    }
+    return marginalise_excluded(buffer);
 }
 
 auto compute_candidate_posteriors(const std::vector<Variant>& candidates,
                                   const GenotypeProbabilityMap& genotype_log_posteriors)
 {
+    std::vector<Allele> alleles {};
+    alleles.reserve(candidates.size());
+    std::transform(std::cbegin(candidates), std::cend(candidates), std::back_inserter(alleles),
+                   [] (const Variant& candidate) { return candidate.alt_allele(); });
+    const AlleleIncidenceMatrix contained_alleles {alleles, genotype_log_posteriors,
+                                                   [] (const auto& p) -> const Genotype<Haplotype>& { return p.first; }};
+    std::vector<double> log_posteriors {};
+    log_posteriors.reserve(genotype_log_posteriors.size());
+    for (const auto& p : genotype_log_posteriors) log_posteriors.push_back(p.second);
+    thread_local std::vector<double> buffer {};
     VariantPosteriorVector result {};
     result.reserve(candidates.size());
-    for (const auto& candidate : candidates) {
-        result.emplace_back(candidate, marginalise_contained(candidate.alt_allele(), genotype_log_posteriors));
+    for (std::size_t i {0}; i < candidates.size(); ++i) {
+        buffer.clear();
+        contained_alleles.for_each_excluding(i, [&] (const std::size_t genotype) { buffer.push_back(log_posteriors[genotype]); });
+        result.emplace_back(candidates[i], marginalise_excluded(buffer));
     }
     return result;
 }
@@ -401,7 +454,8 @@ const GenomicRegion& mapped_region(const GenotypeProbabilityMap& genotype_poster
     return mapped_region(std::cbegin(genotype_posteriors)->first);
 }
 
-bool has_variation(const Allele& allele, const GenotypeProbabilityMap& genotype_posteriors)
+bool has_variation(const Allele& allele, const GenotypeProbabilityMap& genotype_posteriors,
+                   const std::vector<Haplotype>& dropped_haplotypes)
 {
     if (!genotype_posteriors.empty() && !contains(mapped_region(genotype_posteriors), allele)) {
         return false;
@@ -409,6 +463,10 @@ bool has_variation(const Allele& allele, const GenotypeProbabilityMap& genotype_
     return std::any_of(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors),
                        [&allele] (const auto& p) {
                            return !is_homozygous(p.first, allele);
+                       })
+        || std::any_of(std::cbegin(dropped_haplotypes), std::cend(dropped_haplotypes),
+                       [&allele] (const auto& haplotype) {
+                           return copy<Allele>(haplotype, mapped_region(allele)) != allele;
                        });
 }
 
@@ -425,10 +483,11 @@ using ReadPileupRange = ContainedRange<ReadPileups::const_iterator>;
 
 auto compute_homozygous_posterior(const Allele& allele,
                                   const GenotypeProbabilityMap& genotype_posteriors,
+                                  const std::vector<Haplotype>& dropped_haplotypes,
                                   const ReadPileupRange& pileups)
 {
     assert(!empty(pileups));
-    if (has_variation(allele, genotype_posteriors)) {
+    if (has_variation(allele, genotype_posteriors, dropped_haplotypes)) {
         return marginalise_homozygous(allele, genotype_posteriors);
     } else {
         std::vector<AlignedRead::BaseQuality> reference_qualities {}, non_reference_qualities {};
@@ -464,6 +523,7 @@ auto compute_homozygous_posterior(const Allele& allele,
 
 auto call_reference(const std::vector<Allele>& reference_alleles,
                     const GenotypeProbabilityMap& genotype_posteriors,
+                    const std::vector<Haplotype>& dropped_haplotypes,
                     const ReadPileups& pileups,
                     const Phred<double> min_call_posterior)
 {
@@ -473,7 +533,7 @@ auto call_reference(const std::vector<Allele>& reference_alleles,
     auto active_pileup_itr = std::cbegin(pileups);
     for (const auto& allele : reference_alleles) {
         const auto active_pileups = contained_range(active_pileup_itr, std::cend(pileups), contig_region(allele));
-        const auto posterior = compute_homozygous_posterior(allele, genotype_posteriors, active_pileups);
+        const auto posterior = compute_homozygous_posterior(allele, genotype_posteriors, dropped_haplotypes, active_pileups);
         if (posterior >= min_call_posterior) {
             result.push_back({allele, posterior});
         }
@@ -511,8 +571,8 @@ IndividualCaller::call_reference(const std::vector<Allele>& alleles,
                                  const ReadPileupMap& pileups) const
 {
     const auto& genotype_posteriors = (*latents.genotype_posteriors_)[sample()];
-    auto calls = octopus::call_reference(alleles, genotype_posteriors, pileups.at(sample()),
-                                         parameters_.min_refcall_posterior);
+    auto calls = octopus::call_reference(alleles, genotype_posteriors, latents.dropped_haplotypes_,
+                                         pileups.at(sample()), parameters_.min_refcall_posterior);
     return transform_calls(std::move(calls), sample(), parameters_.ploidy);
 }
 
@@ -533,97 +593,13 @@ std::unique_ptr<GenotypePriorModel> IndividualCaller::make_prior_model(const Hap
     }
 }
 
-namespace {
-template <typename T>
-void erase_complement_indices(std::vector<T>& values, const std::vector<std::size_t>& indices)
-{
-    std::vector<bool> keep(values.size(), true);
-    for (auto idx : indices) keep[idx] = false;
-    if (!indices.empty()) {
-        std::size_t idx {0};
-        const auto is_not_index = [&] (const auto& v) { return keep[idx++]; };
-        values.erase(std::remove_if(std::begin(values), std::end(values), is_not_index), std::end(values));
-    } else {
-        values.clear();
-    }
-}
-
-void
-select_top_k(std::vector<Genotype<Haplotype>>& genotypes, std::vector<GenotypeIndex>& genotype_indices,
-             const model::IndividualModel::Latents::ProbabilityVector& genotype_posteriors,
-             const std::size_t k)
-{
-    const auto best_indices = select_top_k_indices(genotype_posteriors, k, false);
-    erase_complement_indices(genotypes, best_indices);
-    erase_complement_indices(genotype_indices, best_indices);
-}
-
-template <typename T1, typename T2>
-auto zip(std::vector<T1>&& lhs, std::vector<T2>&& rhs)
-{
-    assert(lhs.size() == rhs.size());
-    std::vector<std::pair<T1, T2>> result {};
-    result.reserve(lhs.size());
-    std::transform(std::make_move_iterator(std::begin(lhs)), std::make_move_iterator(std::end(lhs)),
-                   std::make_move_iterator(std::begin(rhs)), std::back_inserter(result),
-                   [] (T1&& a, T2&& b) noexcept { return std::make_pair(std::move(a), std::move(b)); });
-    return result;
-}
-
-template <typename T1, typename T2>
-auto unzip(std::vector<std::pair<T1, T2>>&& zipped)
-{
-    std::vector<T1> lhs {}; std::vector<T2> rhs {};
-    lhs.reserve(zipped.size()); rhs.reserve(zipped.size());
-    for (auto& p : zipped) {
-        lhs.push_back(std::move(p.first));
-        rhs.push_back(std::move(p.second));
-    }
-    return std::make_pair(std::move(lhs), std::move(rhs));
-}
-
-template <typename ForwardIterator,
-          typename BinaryPredicate1,
-          typename BinaryPredicate2>
-ForwardIterator
-stable_unique(const ForwardIterator first, const ForwardIterator last,
-              const BinaryPredicate1 less, const BinaryPredicate2 equal)
-{
-    const auto n = static_cast<std::size_t>(std::distance(first, last));
-    using ValueTp = typename std::iterator_traits<ForwardIterator>::value_type;
-    std::vector<std::pair<ValueTp, std::size_t>> indexed_values(n);
-    std::size_t idx {0};
-    std::transform(std::make_move_iterator(first), std::make_move_iterator(last), std::begin(indexed_values),
-                   [&] (auto&& value) { return std::make_pair(std::move(value), idx++); });
-    const auto value_less = [&less] (const auto& lhs, const auto& rhs) { return less(lhs.first, rhs.first); };
-    std::sort(std::begin(indexed_values), std::end(indexed_values), value_less);
-    const auto value_equal = [&equal] (const auto& lhs, const auto& rhs) { return equal(lhs.first, rhs.first); };
-    indexed_values.erase(std::unique(std::begin(indexed_values), std::end(indexed_values), value_equal), std::end(indexed_values));
-    const static auto index_less = [] (const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; };
-    std::sort(std::begin(indexed_values), std::end(indexed_values), index_less);
-    return std::transform(std::make_move_iterator(std::begin(indexed_values)),
-                          std::make_move_iterator(std::end(indexed_values)),
-                          first, [] (auto&& p) { return std::move(p.first); });
-}
-
-void erase_duplicates(std::vector<Genotype<Haplotype>>& genotypes, std::vector<GenotypeIndex>& genotype_indices)
-{
-    auto zipped = zip(std::move(genotypes), std::move(genotype_indices));
-    const static auto zipped_less = [] (const auto& lhs, const auto& rhs) { return GenotypeLess{}(lhs.first, rhs.first); };
-    const static auto zipped_equal = [] (const auto& lhs, const auto& rhs) { return lhs.first ==rhs.first; };
-    zipped.erase(stable_unique(std::begin(zipped), std::end(zipped), zipped_less, zipped_equal), std::end(zipped));
-    std::tie(genotypes, genotype_indices) = unzip(std::move(zipped));
-}
-
-} // namespace
-
-IndividualCaller::GenotypeVectorPair
+std::vector<GenotypeIndex>
 IndividualCaller::propose_genotypes(const HaplotypeBlock& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods) const
 {
     const auto num_possible_genotypes = num_genotypes_noexcept(haplotypes.size(), parameters_.ploidy);
-    GenotypeVectorPair result {};
+    std::vector<GenotypeIndex> result {};
     if (!parameters_.max_genotypes || (num_possible_genotypes && *num_possible_genotypes <= *parameters_.max_genotypes)) {
-        result.genotypes = generate_all_genotypes(haplotypes, parameters_.ploidy, result.indices);
+        generate_all_genotype_indices(static_cast<unsigned>(haplotypes.size()), parameters_.ploidy, result);
     } else {
         if (debug_log_) {
             if (num_possible_genotypes) {
@@ -632,30 +608,10 @@ IndividualCaller::propose_genotypes(const HaplotypeBlock& haplotypes, const Hapl
                 *debug_log_ << "Applying genotype reduction as the number of possible genotypes calculation overflowed";
             }
         }
-        auto ploidy = parameters_.ploidy - 1;
-        for (; ploidy > 1; --ploidy) {
-            const auto num_ploidy_genotypes = num_genotypes_noexcept(haplotypes.size(), ploidy);
-            if (num_ploidy_genotypes && *num_ploidy_genotypes <= *parameters_.max_genotypes) break;
-        }
-        if (debug_log_) stream(*debug_log_) << "Starting genotype reduction with ploidy " << ploidy;
-        result.genotypes = generate_all_genotypes(haplotypes, ploidy, result.indices);
-        auto prior_model = make_prior_model(haplotypes);
-        prior_model->prime(haplotypes);
-        model::IndividualModel model {*prior_model};
-        model.prime(haplotypes);
         haplotype_likelihoods.prime(sample());
-        for (; ploidy < parameters_.ploidy; ++ploidy) {
-            if (debug_log_) stream(*debug_log_) << "Finding good genotypes with ploidy " << ploidy << " from " << result.genotypes.size();
-            const auto ploidy_inferences = model.evaluate(result.genotypes, result.indices, haplotype_likelihoods);
-            const std::size_t max_seeds {2 * std::max(*parameters_.max_genotypes / haplotypes.size(), std::size_t {1})};
-            select_top_k(result.genotypes, result.indices, ploidy_inferences.posteriors.genotype_log_probabilities, max_seeds);
-            std::tie(result.genotypes, result.indices) = extend_genotypes(result.genotypes, result.indices, haplotypes);
-            erase_duplicates(result.genotypes, result.indices);
-            if (result.genotypes.size() > *parameters_.max_genotypes) {
-                result.genotypes.resize(*parameters_.max_genotypes);
-                result.indices.resize(*parameters_.max_genotypes);
-            }
-        }
+        model::TopGenotypeEnumerationParameters enumeration_params {*parameters_.max_genotypes};
+        result = model::enumerate_top_genotypes(haplotypes, parameters_.ploidy, haplotype_likelihoods, enumeration_params);
+        if (debug_log_) stream(*debug_log_) << "Enumerated " << result.size() << " most likely genotypes";
     }
     return result;
 }
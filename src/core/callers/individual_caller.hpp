@@ -57,12 +57,6 @@ public:
 private:
     class Latents;
     
-    struct GenotypeVectorPair
-    {
-        std::vector<Genotype<Haplotype>> genotypes;
-        std::vector<GenotypeIndex> indices;
-    };
-    
     Parameters parameters_;
     
     std::string do_name() const override;
@@ -102,7 +96,7 @@ private:
     const SampleName& sample() const noexcept;
     
     std::unique_ptr<GenotypePriorModel> make_prior_model(const HaplotypeBlock& haplotypes) const;
-    GenotypeVectorPair propose_genotypes(const HaplotypeBlock& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
+    std::vector<GenotypeIndex> propose_genotypes(const HaplotypeBlock& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
 };
 
 class IndividualCaller::Latents : public Caller::Latents
@@ -118,7 +112,7 @@ public:
     Latents() = delete;
     
     Latents(const SampleName& sample, const HaplotypeBlock& haplotypes,
-            std::vector<Genotype<Haplotype>>&& genotypes, ModelInferences&& latents);
+            const std::vector<GenotypeIndex>& genotypes, ModelInferences&& latents);
     
     std::shared_ptr<HaplotypeProbabilityMap> haplotype_posteriors() const noexcept override;
     std::shared_ptr<GenotypeProbabilityMap> genotype_posteriors() const noexcept override;
@@ -126,6 +120,7 @@ public:
 private:
     std::shared_ptr<GenotypeProbabilityMap> genotype_log_posteriors_, genotype_posteriors_;
     std::shared_ptr<HaplotypeProbabilityMap> haplotype_posteriors_;
+    std::vector<Haplotype> dropped_haplotypes_; // only in genotypes with negligible posterior
     double model_log_evidence_;
     
     HaplotypeProbabilityMap calculate_haplotype_posteriors(const HaplotypeBlock& haplotypes);
@@ -18,10 +18,12 @@
 #include "containers/probability_matrix.hpp"
 #include "core/types/allele.hpp"
 #include "core/types/variant.hpp"
+#include "core/types/allele_incidence_matrix.hpp"
 #include "core/types/calls/germline_variant_call.hpp"
 #include "core/types/calls/reference_call.hpp"
 #include "core/models/genotype/uniform_genotype_prior_model.hpp"
 #include "core/models/genotype/coalescent_genotype_prior_model.hpp"
+#include "core/models/genotype/top_genotype_enumeration.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/concat.hpp"
@@ -243,6 +245,15 @@ using GenotypeCalls = std::vector<GenotypeCall>;
 
 // allele posterior calculations
 
+Phred<> marginalise_excluded(const std::vector<double>& excluded_genotype_log_posteriors)
+{
+    if (!excluded_genotype_log_posteriors.empty()) {
+        return log_probability_false_to_phred(std::min(maths::log_sum_exp(excluded_genotype_log_posteriors), 0.0));
+    } else {
+        return Phred<> {std::numeric_limits<double>::infinity()};
+    }
+}
+
 template <typename GenotypeOrAllele>
 auto marginalise_contained(const GenotypeOrAllele& element, const GenotypeProbabilityMap& genotype_log_posteriors)
 {
@@ -253,20 +264,28 @@ auto marginalise_contained(const GenotypeOrAllele& element, const GenotypeProbab
             buffer.push_back(p.second);
         }
     }
-    if (!buffer.empty()) {
-        return log_probability_false_to_phred(std::min(maths::log_sum_exp(buffer), 0.0));
-    } else {
-        return Phred<> {std::numeric_limits<double>::infinity()};
-    }
+    return marginalise_excluded(buffer);
 }
 
 auto compute_candidate_posteriors(const std::vector<Variant>& candidates,
                                   const GenotypeProbabilityMap& genotype_log_posteriors)
 {
+    std::vector<Allele> alleles {};
+    alleles.reserve(candidates.size());
+    std::transform(std::cbegin(candidates), std::cend(candidates), std::back_inserter(alleles),
+                   [] (const Variant& candidate) { return candidate.alt_allele(); });
+    const AlleleIncidenceMatrix contained_alleles {alleles, genotype_log_posteriors,
+                                                   [] (const auto& p) -> const Genotype<Haplotype>& { return p.first; }};
+    std::vector<double> log_posteriors {};
+    log_posteriors.reserve(genotype_log_posteriors.size());
+    for (const auto& p : genotype_log_posteriors) log_posteriors.push_back(p.second);
+    thread_local std::vector<double> buffer {};
     VariantPosteriorVector result {};
     result.reserve(candidates.size());
-    for (const auto& candidate : candidates) {
-        result.emplace_back(candidate, marginalise_contained(candidate.alt_allele(), genotype_log_posteriors));
+    for (std::size_t i {0}; i < candidates.size(); ++i) {
+        buffer.clear();
+        contained_alleles.for_each_excluding(i, [&] (const std::size_t genotype) { buffer.push_back(log_posteriors[genotype]); });
+        result.emplace_back(candidates[i], marginalise_excluded(buffer));
     }
     return result;
 }
@@ -587,16 +606,10 @@ PolycloneCaller::fit_sublone_model(const MappableBlock<Haplotype>& haplotypes,
             curr_genotypes.indices.clear();
             curr_genotypes.raw = generate_all_max_zygosity_genotypes(haplotypes, clonality, curr_genotypes.indices);
         } else {
-            const static auto not_included = [] (const auto& genotype, const auto& haplotype) -> bool {
-                return !genotype.contains(haplotype); };
-            if (prev_genotypes.raw.size() * (haplotypes.size() / 2) > *parameters_.max_genotypes) {
-                auto probable_prev_genotypes = prev_genotypes;
-                reduce(probable_prev_genotypes, sublonal_inferences.max_evidence_params.genotype_log_probabilities,
-                       *parameters_.max_genotypes / (haplotypes.size() / 2));
-                std::tie(curr_genotypes.raw, curr_genotypes.indices) = extend_genotypes(probable_prev_genotypes.raw, probable_prev_genotypes.indices, haplotypes, not_included);
-            } else {
-                std::tie(curr_genotypes.raw, curr_genotypes.indices) = extend_genotypes(prev_genotypes.raw, prev_genotypes.indices, haplotypes, not_included);
-            }
+            model::TopGenotypeEnumerationParameters enumeration_params {*parameters_.max_genotypes};
+            enumeration_params.max_zygosity = true;
+            curr_genotypes.indices = model::enumerate_top_genotypes(haplotypes, clonality, haplotype_likelihoods, enumeration_params);
+            curr_genotypes.raw = make_genotypes(haplotypes, curr_genotypes.indices);
         }
         if (parameters_.max_genotypes) reduce(curr_genotypes, haplotypes, genotype_prior_model, haplotype_likelihoods, *parameters_.max_genotypes);
         if (debug_log_) stream(*debug_log_) << "Generated " << curr_genotypes.raw.size() << " genotypes with clonality " << clonality;
@@ -19,6 +19,7 @@
 #include "core/types/variant.hpp"
 #include "core/types/haplotype.hpp"
 #include "core/types/genotype.hpp"
+#include "core/types/allele_incidence_matrix.hpp"
 #include "utils/maths.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
@@ -159,8 +160,42 @@ auto calculate_haplotype_posteriors(const MappableBlock<Haplotype>& haplotypes,
     return result;
 }
 
+// Only genotypes with a non-zero posterior in some sample are materialised, as the others cannot
+// contribute to any call. The posteriors of the removed genotypes are erased.
+MappableBlock<Genotype<Haplotype>>
+make_supported_genotypes(const MappableBlock<Haplotype>& haplotypes,
+                         const std::vector<GenotypeIndex>& genotypes,
+                         GenotypeMarginalPosteriorMatrix& genotype_posteriors)
+{
+    std::vector<bool> is_supported(genotypes.size(), false);
+    for (const auto& sample_posteriors : genotype_posteriors) {
+        for (std::size_t i {0}; i < genotypes.size(); ++i) {
+            if (sample_posteriors[i] > 0.0) is_supported[i] = true;
+        }
+    }
+    std::vector<GenotypeIndex> supported_genotypes {};
+    for (std::size_t i {0}; i < genotypes.size(); ++i) {
+        if (is_supported[i]) supported_genotypes.push_back(genotypes[i]);
+    }
+    for (auto& sample_posteriors : genotype_posteriors) {
+        std::size_t num_supported {0};
+        for (std::size_t i {0}; i < genotypes.size(); ++i) {
+            if (is_supported[i]) sample_posteriors[num_supported++] = sample_posteriors[i];
+        }
+        sample_posteriors.resize(num_supported);
+    }
+    return {make_genotypes(haplotypes, supported_genotypes), mapped_region(haplotypes)};
+}
+
 } // namespace
 
+PopulationCaller::Latents::Latents(const std::vector<SampleName>& samples,
+                                   const HaplotypeBlock& haplotypes,
+                                   const std::vector<GenotypeIndex>& genotypes,
+                                   IndependenceModelInferences&& inferences)
+: Latents {samples, haplotypes, make_supported_genotypes(haplotypes, genotypes, inferences.posteriors.genotype_probabilities), std::move(inferences)}
+{}
+
 PopulationCaller::Latents::Latents(const std::vector<SampleName>& samples,
                                    const HaplotypeBlock& haplotypes,
                                    MappableBlock<Genotype<Haplotype>>&& genotypes,
@@ -186,6 +221,13 @@ PopulationCaller::Latents::Latents(const std::vector<SampleName>& samples,
 
 }
 
+PopulationCaller::Latents::Latents(const std::vector<SampleName>& samples,
+                                   const HaplotypeBlock& haplotypes,
+                                   const std::vector<GenotypeIndex>& genotypes,
+                                   ModelInferences&& inferences)
+: Latents {samples, haplotypes, make_supported_genotypes(haplotypes, genotypes, inferences.posteriors.marginal_genotype_probabilities), std::move(inferences)}
+{}
+
 PopulationCaller::Latents::Latents(const std::vector<SampleName>& samples,
                                    const HaplotypeBlock& haplotypes,
                                    MappableBlock<Genotype<Haplotype>>&& genotypes,
@@ -321,24 +363,24 @@ using GenotypeCalls = std::vector<std::vector<GenotypeCall>>;
 using AlleleBools           = std::deque<bool>; // using std::deque because std::vector<bool> is evil
 using GenotypePropertyBools = std::vector<AlleleBools>;
 
-auto marginalise(const GenotypeProbabilityMap& genotype_posteriors,
-                 const AlleleBools& contained_alleles)
+auto marginalise(const std::vector<double>& genotype_posteriors,
+                 const AlleleIncidenceMatrix& contained_alleles, const std::size_t allele)
 {
-    auto p = std::inner_product(std::cbegin(genotype_posteriors), std::cend(genotype_posteriors),
-                                std::cbegin(contained_alleles), 0.0, std::plus<> {},
-                                [] (const auto& p, const bool is_contained) {
-                                    return is_contained ? 0.0 : p.second;
-                                });
+    double p {0};
+    contained_alleles.for_each_excluding(allele, [&] (const std::size_t genotype) { p += genotype_posteriors[genotype]; });
     return probability_false_to_phred(p);
 }
 
 auto compute_sample_allele_posteriors(const GenotypeProbabilityMap& genotype_posteriors,
-                                      const GenotypePropertyBools& contained_alleles)
+                                      const AlleleIncidenceMatrix& contained_alleles)
 {
+    thread_local std::vector<double> posteriors {};
+    posteriors.clear();
+    for (const auto& p : genotype_posteriors) posteriors.push_back(p.second);
     std::vector<Phred<double>> result {};
-    result.reserve(contained_alleles.size());
-    for (const auto& allele : contained_alleles) {
-        result.emplace_back(marginalise(genotype_posteriors, allele));
+    result.reserve(contained_alleles.num_alleles());
+    for (std::size_t allele {0}; allele < contained_alleles.num_alleles(); ++allele) {
+        result.emplace_back(marginalise(posteriors, contained_alleles, allele));
     }
     return result;
 }
@@ -346,21 +388,12 @@ auto compute_sample_allele_posteriors(const GenotypeProbabilityMap& genotype_pos
 auto get_contained_alleles(const PopulationGenotypeProbabilityMap& genotype_posteriors,
                            const std::vector<Allele>& alleles)
 {
-    const auto num_genotypes = genotype_posteriors.size2();
-    GenotypePropertyBools result {};
-    if (num_genotypes == 0 || genotype_posteriors.empty1() || alleles.empty()) {
-        return result;
-    }
-    result.reserve(alleles.size());
-    const auto& test_sample   = genotype_posteriors.begin()->first;
-    const auto genotype_begin = genotype_posteriors.begin(test_sample);
-    const auto genotype_end   = genotype_posteriors.end(test_sample);
-    for (const auto& allele : alleles) {
-        result.emplace_back(num_genotypes);
-        std::transform(genotype_begin, genotype_end, std::begin(result.back()),
-                       [&] (const auto& p) { return contains(p.first, allele); });
+    if (genotype_posteriors.size2() == 0 || genotype_posteriors.empty1() || alleles.empty()) {
+        return AlleleIncidenceMatrix {};
     }
-    return result;
+    const auto& test_sample = genotype_posteriors.begin()->first;
+    return AlleleIncidenceMatrix {alleles, genotype_posteriors[test_sample],
+                                  [] (const auto& p) -> const Genotype<Haplotype>& { return p.first; }};
 }
 
 auto compute_posteriors(const std::vector<SampleName>& samples,
@@ -761,11 +794,10 @@ PopulationCaller::infer_latents_with_joint_model(const HaplotypeBlock& haplotype
     const model::PopulationModel model {*prior_model, {parameters_.max_joint_genotypes}, debug_log_};
     if (parameters_.ploidies.size() == 1) {
         prior_model->prime(haplotypes);
-        std::vector<GenotypeIndex> genotype_indices;
-        auto genotypes = generate_all_genotypes(haplotypes, parameters_.ploidies.front(), genotype_indices);
+        const auto genotypes = generate_all_genotype_indices(static_cast<unsigned>(haplotypes.size()), parameters_.ploidies.front());
         if (debug_log_) stream(*debug_log_) << "There are " << genotypes.size() << " candidate genotypes";
-        auto inferences = model.evaluate(samples_, genotypes, genotype_indices, haplotypes, haplotype_likelihoods);
-        return std::make_unique<Latents>(samples_, haplotypes, std::move(genotypes), std::move(inferences));
+        auto inferences = model.evaluate(samples_, genotypes, haplotypes, haplotype_likelihoods);
+        return std::make_unique<Latents>(samples_, haplotypes, genotypes, std::move(inferences));
     } else {
         auto unique_genotypes = generate_unique_genotypes(haplotypes, parameters_.ploidies);
         model::PopulationModel::GenotypeVector genotypes {};
@@ -780,12 +812,14 @@ PopulationCaller::infer_latents_with_independence_model(const HaplotypeBlock& ha
                                                         const HaplotypeLikelihoodArray& haplotype_likelihoods) const
 {
     const auto prior_model = make_independent_prior_model(haplotypes);
-    const model::IndependentPopulationModel model {*prior_model, debug_log_};
+    model::IndependentPopulationModel model {*prior_model, debug_log_};
     if (parameters_.ploidies.size() == 1) {
-        auto genotypes = generate_all_genotypes(haplotypes, parameters_.ploidies.front());
+        prior_model->prime(haplotypes);
+        model.prime(haplotypes);
+        const auto genotypes = generate_all_genotype_indices(static_cast<unsigned>(haplotypes.size()), parameters_.ploidies.front());
         if (debug_log_) stream(*debug_log_) << "There are " << genotypes.size() << " candidate genotypes";
         auto inferences = model.evaluate(samples_, genotypes, haplotype_likelihoods);
-        return std::make_unique<Latents>(samples_, haplotypes, std::move(genotypes), std::move(inferences));
+        return std::make_unique<Latents>(samples_, haplotypes, genotypes, std::move(inferences));
     } else {
         auto unique_genotypes = generate_unique_genotypes(haplotypes, parameters_.ploidies);
         model::IndependentPopulationModel::GenotypeVector genotypes {};
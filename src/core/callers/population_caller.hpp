@@ -109,6 +109,11 @@ public:
             MappableBlock<Genotype<Haplotype>>&& genotypes,
             IndependenceModelInferences&&);
     
+    Latents(const std::vector<SampleName>& samples,
+            const HaplotypeBlock&,
+            const std::vector<GenotypeIndex>& genotypes,
+            IndependenceModelInferences&&);
+    
     Latents(const std::vector<SampleName>& samples,
             const HaplotypeBlock&,
             std::map<unsigned, MappableBlock<Genotype<Haplotype>>>&& genotypes,
@@ -119,6 +124,11 @@ public:
             MappableBlock<Genotype<Haplotype>>&& genotypes,
             ModelInferences&&);
     
+    Latents(const std::vector<SampleName>& samples,
+            const HaplotypeBlock&,
+            const std::vector<GenotypeIndex>& genotypes,
+            ModelInferences&&);
+    
     Latents(const std::vector<SampleName>& samples,
             const HaplotypeBlock&,
             std::map<unsigned, MappableBlock<Genotype<Haplotype>>>&& genotypes,
@@ -409,7 +409,7 @@ TrioCaller::infer_latents(const HaplotypeBlock& haplotypes,
         TrioModel::Options {parameters_.max_joint_genotypes},
         debug_log_
     };
-    std::vector<std::vector<unsigned>> genotype_indices {};
+    std::vector<GenotypeIndex> genotype_indices {};
     auto maternal_genotypes = generate_all_genotypes(haplotypes, parameters_.maternal_ploidy, genotype_indices);
     if (parameters_.maternal_ploidy == parameters_.paternal_ploidy) {
         germline_prior_model->prime(haplotypes);
@@ -463,7 +463,7 @@ TrioCaller::calculate_model_posterior(const HaplotypeBlock& haplotypes,
 {
     const auto max_ploidy = std::max({parameters_.maternal_ploidy, parameters_.paternal_ploidy, parameters_.child_ploidy});
     if (max_ploidy + 1 <= model::TrioModel::max_ploidy()) {
-        std::vector<std::vector<unsigned>> genotype_indices {};
+        std::vector<GenotypeIndex> genotype_indices {};
         const auto genotypes = generate_all_genotypes(haplotypes, max_ploidy + 1, genotype_indices);
         const auto germline_prior_model = make_prior_model(haplotypes);
         DeNovoModel denovo_model {parameters_.denovo_model_params};
@@ -192,11 +192,35 @@ IndelProfiler::ProfileConfig GenomeCallingComponents::profiler_config() const
     return components_.profiler_config;
 }
 
+boost::optional<const FusedCallFilter&> GenomeCallingComponents::fused_call_filter() const noexcept
+{
+    if (components_.fused_call_filter) {
+        return *components_.fused_call_filter;
+    } else {
+        return boost::none;
+    }
+}
+
+void GenomeCallingComponents::set_fused_call_filter(FusedCallFilter filter)
+{
+    components_.fused_call_filter = std::move(filter);
+}
+
 bool GenomeCallingComponents::sites_only() const noexcept
 {
     return components_.sites_only;
 }
 
+bool GenomeCallingComponents::keep_unfiltered_calls() const noexcept
+{
+    return components_.keep_unfiltered_calls;
+}
+
+bool GenomeCallingComponents::filter_during_calling() const noexcept
+{
+    return components_.filter_during_calling;
+}
+
 const PloidyMap& GenomeCallingComponents::ploidies() const noexcept
 {
     return components_.ploidies;
@@ -585,6 +609,8 @@ GenomeCallingComponents::Components::Components(ReferenceGenome&& reference, Rea
 , progress_meter {regions}
 , pedigree {options::get_pedigree(options, samples)}
 , sites_only {options::call_sites_only(options)}
+, keep_unfiltered_calls {options::keep_unfiltered_calls(options)}
+, filter_during_calling {options::filter_during_calling(options)}
 , filter_request {}
 , bamout {options::bamout_request(options)}
 , bamout_config {}
@@ -787,6 +813,7 @@ ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName
 , read_buffer_size {genome_components.read_buffer_size()}
 , output {genome_components.output()}
 , progress_meter {genome_components.progress_meter()}
+, call_filter {genome_components.fused_call_filter()}
 {}
 
 ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName& contig, VcfWriter& output,
@@ -799,6 +826,7 @@ ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName
 , read_buffer_size {genome_components.read_buffer_size()}
 , output {output}
 , progress_meter {genome_components.progress_meter()}
+, call_filter {genome_components.fused_call_filter()}
 {}
 
 } // namespace octopus
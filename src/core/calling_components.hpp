@@ -32,6 +32,14 @@
 
 namespace octopus {
 
+// A call filter that is applied to calls as they are made, rather than in a separate pass over the calls
+struct FusedCallFilter
+{
+    std::unique_ptr<const VariantCallFilter> filter;
+    VcfHeader output_header;
+    boost::optional<const ReadPipe&> read_pipe; // if the filter does not use the calling reads
+};
+
 class GenomeCallingComponents
 {
 public:
@@ -72,6 +80,8 @@ public:
     const ReadPipe& filter_read_pipe() const noexcept;
     ProgressMeter& progress_meter() noexcept;
     bool sites_only() const noexcept;
+    bool keep_unfiltered_calls() const noexcept;
+    bool filter_during_calling() const noexcept;
     const PloidyMap& ploidies() const noexcept;
     boost::optional<Pedigree> pedigree() const;
     boost::optional<Path> filter_request() const;
@@ -80,6 +90,8 @@ public:
     boost::optional<const ReadSetProfile&> reads_profile() const noexcept;
     boost::optional<Path> data_profile() const;
     IndelProfiler::ProfileConfig profiler_config() const;
+    boost::optional<const FusedCallFilter&> fused_call_filter() const noexcept;
+    void set_fused_call_filter(FusedCallFilter filter);
     
 private:
     struct Components
@@ -115,6 +127,8 @@ private:
         ProgressMeter progress_meter;
         boost::optional<Pedigree> pedigree;
         bool sites_only;
+        bool keep_unfiltered_calls;
+        bool filter_during_calling;
         boost::optional<Path> filter_request;
         boost::optional<Path> bamout;
         BAMRealigner::Config bamout_config;
@@ -125,6 +139,7 @@ private:
         // exception handling easier.
         boost::optional<Path> temp_directory;
         std::unique_ptr<VariantCallFilterFactory> call_filter_factory;
+        boost::optional<FusedCallFilter> fused_call_filter;
         
         void setup_progress_meter(const options::OptionMap& options);
         void set_read_buffer_size(const options::OptionMap& options);
@@ -153,6 +168,7 @@ struct ContigCallingComponents
     std::size_t read_buffer_size;
     std::reference_wrapper<VcfWriter> output;
     std::reference_wrapper<ProgressMeter> progress_meter;
+    boost::optional<const FusedCallFilter&> call_filter;
     
     ContigCallingComponents() = delete;
     
@@ -125,6 +125,15 @@ FacetFactory::FacetBlock FacetFactory::make(const std::vector<std::string>& name
     return make(names, block_data);
 }
 
+FacetFactory::FacetBlock FacetFactory::make(const std::vector<std::string>& names, const CallBlock& block, const ReadMap& reads,
+                                            const std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
+{
+    if (names.empty()) return {};
+    check_requirements(names);
+    const auto block_data = make_block_data(names, block, reads, likelihoods);
+    return make(names, block_data);
+}
+
 namespace {
 
 template <typename Facet>
@@ -261,7 +270,10 @@ void FacetFactory::setup_facet_makers()
     facet_makers_[name<ReadAssignments>()] = [this] (const BlockData& block) -> FacetWrapper
     {
         assert(block.reads && block.genotypes);
-        if (likelihood_model_) {
+        if (block.likelihoods) {
+            const auto model = likelihood_model_ ? *likelihood_model_ : HaplotypeLikelihoodModel {};
+            return {std::make_unique<ReadAssignments>(*reference_, *block.genotypes, *block.reads, *block.likelihoods, model)};
+        } else if (likelihood_model_) {
             return {std::make_unique<ReadAssignments>(*reference_, *block.genotypes, *block.reads, *likelihood_model_)};
         } else {
             return {std::make_unique<ReadAssignments>(*reference_, *block.genotypes, *block.reads)};
@@ -359,5 +371,25 @@ FacetFactory::BlockData FacetFactory::make_block_data(const std::vector<std::str
     return result;
 }
 
+FacetFactory::BlockData
+FacetFactory::make_block_data(const std::vector<std::string>& names, const CallBlock& block, const ReadMap& reads,
+                              const std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
+{
+    BlockData result {};
+    result.calls = std::addressof(block);
+    result.likelihoods = likelihoods;
+    assert(!names.empty());
+    if (!block.empty()) {
+        result.region = encompassing_region(block);
+        if (requires_reads(names)) {
+            result.reads = copy_overlapped(reads, *result.region);
+        }
+        if (requires_genotypes(names)) {
+            result.genotypes = extract_genotypes(block, samples_, *reference_);
+        }
+    }
+    return result;
+}
+
 } // namespace csr
 } // namespace octopus
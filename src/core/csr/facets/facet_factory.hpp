@@ -15,6 +15,7 @@
 #include "basics/pedigree.hpp"
 #include "basics/ploidy_map.hpp"
 #include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
 #include "io/variant/vcf_header.hpp"
 #include "io/variant/vcf_record.hpp"
 #include "io/reference/reference_genome.hpp"
@@ -55,6 +56,10 @@ public:
     
     FacetWrapper make(const std::string& name, const CallBlock& block) const;
     FacetBlock make(const std::vector<std::string>& names, const CallBlock& block) const;
+    // Uses the given reads rather than fetching them from the read pipe, and the given likelihoods, computed
+    // from the same reads, where they can be used to assign reads
+    FacetBlock make(const std::vector<std::string>& names, const CallBlock& block, const ReadMap& reads,
+                    const std::vector<SavedHaplotypeLikelihoods>* likelihoods = nullptr) const;
     std::vector<FacetBlock> make(const std::vector<std::string>& names, const std::vector<CallBlock>& blocks, ThreadPool& workers) const;
 
 private:
@@ -64,6 +69,7 @@ private:
         boost::optional<GenomicRegion> region;
         boost::optional<ReadMap> reads;
         boost::optional<GenotypeMap> genotypes;
+        const std::vector<SavedHaplotypeLikelihoods>* likelihoods;
     };
     
     VcfHeader input_header_;
@@ -82,6 +88,8 @@ private:
     FacetWrapper make(const std::string& name, const BlockData& block) const;
     FacetBlock make(const std::vector<std::string>& names, const BlockData& block) const;
     BlockData make_block_data(const std::vector<std::string>& names, const CallBlock& block) const;
+    BlockData make_block_data(const std::vector<std::string>& names, const CallBlock& block, const ReadMap& reads,
+                              const std::vector<SavedHaplotypeLikelihoods>* likelihoods) const;
 };
 
 } // namespace csr
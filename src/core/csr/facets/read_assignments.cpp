@@ -18,6 +18,38 @@ auto copy_overlapped_to_vector(const ReadContainer& reads, const Mappable& mappa
     return std::vector<AlignedRead> {std::cbegin(overlapped), std::cend(overlapped)};
 }
 
+boost::optional<HaplotypeLikelihoodMap>
+find_likelihoods(const Genotype<Haplotype>& genotype, const std::vector<AlignedRead>& reads, const SampleName& sample,
+                 const std::vector<SavedHaplotypeLikelihoods>& likelihoods)
+{
+    for (const auto& saved : likelihoods) {
+        if (contains(saved.region, genotype)) {
+            HaplotypeLikelihoodMap result {};
+            for (const auto& haplotype : genotype) {
+                if (result.count(haplotype) == 1) continue;
+                auto haplotype_likelihoods = find_likelihoods(saved, sample, haplotype, reads);
+                if (!haplotype_likelihoods) break;
+                result.emplace(haplotype, std::move(*haplotype_likelihoods));
+            }
+            if (result.size() == genotype.copy_unique_ref().size()) return result;
+        }
+    }
+    return boost::none;
+}
+
+HaplotypeSupportMap
+compute_haplotype_support(const Genotype<Haplotype>& genotype, const std::vector<AlignedRead>& reads,
+                          AmbiguousReadList& ambiguous, const SampleName& sample,
+                          const std::vector<SavedHaplotypeLikelihoods>* saved_likelihoods,
+                          const HaplotypeLikelihoodModel& model)
+{
+    if (saved_likelihoods) {
+        const auto likelihoods = find_likelihoods(genotype, reads, sample, *saved_likelihoods);
+        if (likelihoods) return compute_haplotype_support(genotype, reads, *likelihoods, ambiguous);
+    }
+    return compute_haplotype_support(genotype, reads, ambiguous, model);
+}
+
 } // namespace
 
 ReadAssignments::ReadAssignments(const ReferenceGenome& reference,
@@ -29,6 +61,20 @@ ReadAssignments::ReadAssignments(const ReferenceGenome& reference,
                                  const GenotypeMap& genotypes,
                                  const ReadMap& reads,
                                  HaplotypeLikelihoodModel model)
+: ReadAssignments {reference, genotypes, reads, nullptr, std::move(model)} {}
+
+ReadAssignments::ReadAssignments(const ReferenceGenome& reference,
+                                 const GenotypeMap& genotypes,
+                                 const ReadMap& reads,
+                                 const std::vector<SavedHaplotypeLikelihoods>& likelihoods,
+                                 HaplotypeLikelihoodModel model)
+: ReadAssignments {reference, genotypes, reads, std::addressof(likelihoods), std::move(model)} {}
+
+ReadAssignments::ReadAssignments(const ReferenceGenome& reference,
+                                 const GenotypeMap& genotypes,
+                                 const ReadMap& reads,
+                                 const std::vector<SavedHaplotypeLikelihoods>* saved_likelihoods,
+                                 HaplotypeLikelihoodModel model)
 : result_ {}
 , likelihood_model_ {std::move(model)}
 {
@@ -48,7 +94,8 @@ ReadAssignments::ReadAssignments(const ReferenceGenome& reference,
             if (!local_reads.empty()) {
                 HaplotypeSupportMap genotype_support {};
                 if (!genotype.is_homozygous()) {
-                    genotype_support = compute_haplotype_support(genotype, local_reads, result_.ambiguous[sample], likelihood_model_);
+                    genotype_support = compute_haplotype_support(genotype, local_reads, result_.ambiguous[sample], sample,
+                                                                 saved_likelihoods, likelihood_model_);
                 } else {
                     if (is_reference(genotype[0])) {
                         genotype_support[genotype[0]] = std::move(local_reads);
@@ -57,7 +104,8 @@ ReadAssignments::ReadAssignments(const ReferenceGenome& reference,
                         Haplotype ref {mapped_region(genotype), reference};
                         result_.support[sample][ref] = {};
                         augmented_genotype.emplace(std::move(ref));
-                        genotype_support = compute_haplotype_support(augmented_genotype, local_reads, result_.ambiguous[sample], likelihood_model_);
+                        genotype_support = compute_haplotype_support(augmented_genotype, local_reads, result_.ambiguous[sample], sample,
+                                                                     saved_likelihoods, likelihood_model_);
                     }
                 }
                 for (auto& s : genotype_support) {
@@ -15,6 +15,7 @@
 #include "core/types/haplotype.hpp"
 #include "core/types/genotype.hpp"
 #include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
 #include "core/tools/read_assigner.hpp"
 #include "io/reference/reference_genome.hpp"
 
@@ -34,6 +35,12 @@ public:
                     const GenotypeMap& genotypes,
                     const ReadMap& reads,
                     HaplotypeLikelihoodModel model);
+    // Reads are assigned with the saved likelihoods where they include the genotype haplotypes and reads
+    ReadAssignments(const ReferenceGenome& reference,
+                    const GenotypeMap& genotypes,
+                    const ReadMap& reads,
+                    const std::vector<SavedHaplotypeLikelihoods>& likelihoods,
+                    HaplotypeLikelihoodModel model);
     
 private:
     static const std::string name_;
@@ -41,6 +48,12 @@ private:
     SupportMaps result_;
     HaplotypeLikelihoodModel likelihood_model_;
     
+    ReadAssignments(const ReferenceGenome& reference,
+                    const GenotypeMap& genotypes,
+                    const ReadMap& reads,
+                    const std::vector<SavedHaplotypeLikelihoods>* saved_likelihoods,
+                    HaplotypeLikelihoodModel model);
+    
     const std::string& do_name() const noexcept override { return name_; }
     Facet::ResultType do_get() const override;
 };
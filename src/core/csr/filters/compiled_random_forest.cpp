@@ -0,0 +1,117 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "compiled_random_forest.hpp"
+
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <cassert>
+
+#include "ranger/ForestProbability.h"
+
+namespace octopus { namespace csr {
+
+CompiledRandomForest::CompiledRandomForest(const ranger::ForestProbability& forest, const std::size_t class_idx)
+: num_features_ {forest.getNumIndependentVariables()}
+{
+    const auto& ordered_variables = forest.getIsOrderedVariable();
+    trees_.reserve(forest.getNumTrees());
+    for (std::size_t tree_idx {0}; tree_idx < forest.getNumTrees(); ++tree_idx) {
+        const auto& tree = forest.getTree(tree_idx);
+        const auto& child_node_ids = tree.getChildNodeIDs();
+        const auto& split_var_ids = tree.getSplitVarIDs();
+        const auto& split_values = tree.getSplitValues();
+        const auto& terminal_class_counts = tree.getTerminalClassCounts();
+        const auto root = static_cast<std::uint32_t>(nodes_.size());
+        std::uint32_t depth {0};
+        // Nodes are numbered in the order they are queued, so siblings are adjacent
+        std::deque<std::pair<std::size_t, std::uint32_t>> queue {{0, 0}}; // ranger node ID, depth
+        nodes_.emplace_back();
+        for (auto node_idx = root; !queue.empty(); ++node_idx) {
+            const auto ranger_node_id = queue.front().first;
+            const auto node_depth = queue.front().second;
+            queue.pop_front();
+            if (child_node_ids[0][ranger_node_id] == 0 && child_node_ids[1][ranger_node_id] == 0) {
+                nodes_[node_idx] = {terminal_class_counts[ranger_node_id][class_idx], {node_idx, node_idx}, 0, true};
+                depth = std::max(depth, node_depth);
+            } else {
+                const auto left = static_cast<std::uint32_t>(nodes_.size());
+                const auto feature = split_var_ids[ranger_node_id];
+                assert(feature < num_features_);
+                nodes_[node_idx] = {split_values[ranger_node_id], {left, left + 1},
+                                    static_cast<std::uint32_t>(feature), ordered_variables[feature]};
+                nodes_.resize(nodes_.size() + 2);
+                queue.emplace_back(child_node_ids[0][ranger_node_id], node_depth + 1);
+                queue.emplace_back(child_node_ids[1][ranger_node_id], node_depth + 1);
+            }
+        }
+        trees_.push_back({root, depth});
+    }
+    nodes_.shrink_to_fit();
+}
+
+std::size_t CompiledRandomForest::num_features() const noexcept
+{
+    return num_features_;
+}
+
+std::size_t CompiledRandomForest::num_trees() const noexcept
+{
+    return trees_.size();
+}
+
+namespace {
+
+// Number of records stepped down a tree together
+constexpr std::size_t groupSize {16};
+
+} // namespace
+
+void CompiledRandomForest::predict(const double* features, const std::size_t num_records, double* result) const
+{
+    std::fill_n(result, num_records, 0.0);
+    std::array<std::uint32_t, groupSize> group_nodes;
+    for (const auto& tree : trees_) {
+        for (std::size_t first_record {0}; first_record < num_records; first_record += groupSize) {
+            const auto group_size = std::min(groupSize, num_records - first_record);
+            const auto group_features = features + first_record * num_features_;
+            std::fill_n(std::begin(group_nodes), group_size, tree.root);
+            for (std::uint32_t step {0}; step < tree.depth; ++step) {
+                for (std::size_t i {0}; i < group_size; ++i) {
+                    const auto& node = nodes_[group_nodes[i]];
+                    group_nodes[i] = node.children[goes_right(node, group_features[i * num_features_ + node.feature])];
+                }
+            }
+            for (std::size_t i {0}; i < group_size; ++i) {
+                result[first_record + i] += nodes_[group_nodes[i]].value;
+            }
+        }
+    }
+    const auto num_trees = static_cast<double>(trees_.size());
+    std::for_each(result, result + num_records, [num_trees] (double& probability) { probability /= num_trees; });
+}
+
+std::vector<double> CompiledRandomForest::predict(const std::vector<double>& features) const
+{
+    assert(num_features_ > 0 && features.size() % num_features_ == 0);
+    std::vector<double> result(features.size() / num_features_);
+    predict(features.data(), result.size(), result.data());
+    return result;
+}
+
+// private methods
+
+bool CompiledRandomForest::goes_right(const Node& node, const double value) noexcept
+{
+    if (node.ordered) return !(value <= node.value);
+    // Unordered splits are bitsets of the factor levels that go right, as in ranger
+    const auto factor = static_cast<std::size_t>(std::floor(value) - 1);
+    const auto split = static_cast<std::size_t>(std::floor(node.value));
+    return (split >> factor) & 1;
+}
+
+} // namespace csr
+} // namespace octopus
@@ -0,0 +1,69 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef compiled_random_forest_hpp
+#define compiled_random_forest_hpp
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ranger { class ForestProbability; }
+
+namespace octopus { namespace csr {
+
+/*
+    A read-only copy of a trained ranger probability forest, specialised for predicting the probability of
+    one class. Each tree is flattened breadth-first into one contiguous array of nodes, and each leaf has itself
+    as both children and holds the class probability. A block of records is then pushed down each tree in turn
+    for a fixed number of steps (the tree depth) with no data-dependent branching, so each tree stays in cache
+    for the whole block and the records in a block can be stepped independently.
+
+    Predictions are identical to ranger's, as the leaf probabilities are summed in the same order.
+*/
+class CompiledRandomForest
+{
+public:
+    CompiledRandomForest() = default;
+
+    CompiledRandomForest(const ranger::ForestProbability& forest, std::size_t class_idx);
+
+    CompiledRandomForest(const CompiledRandomForest&)            = default;
+    CompiledRandomForest& operator=(const CompiledRandomForest&) = default;
+    CompiledRandomForest(CompiledRandomForest&&)                 = default;
+    CompiledRandomForest& operator=(CompiledRandomForest&&)      = default;
+
+    ~CompiledRandomForest() = default;
+
+    std::size_t num_features() const noexcept;
+    std::size_t num_trees() const noexcept;
+
+    // features are record major, with num_features() values per record
+    void predict(const double* features, std::size_t num_records, double* result) const;
+    std::vector<double> predict(const std::vector<double>& features) const;
+
+private:
+    struct Node
+    {
+        double value; // split value, or class probability for leaves
+        std::array<std::uint32_t, 2> children; // left, right
+        std::uint32_t feature;
+        bool ordered;
+    };
+    struct Tree
+    {
+        std::uint32_t root, depth;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<Tree> trees_;
+    std::size_t num_features_ = 0;
+
+    static bool goes_right(const Node& node, double value) noexcept;
+};
+
+} // namespace csr
+} // namespace octopus
+
+#endif
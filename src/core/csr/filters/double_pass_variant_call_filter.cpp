@@ -33,14 +33,10 @@ void DoublePassVariantCallFilter::filter(const VcfReader& source, VcfWriter& des
 {
     assert(dest.is_header_written());
     const auto samples = source.fetch_header().samples();
-    const auto annotated_source_path = make_registration_pass(source, dest_header);
+    make_registration_pass(source);
     prepare_for_classification(info_log_);
-    if (annotated_source_path) {
-        const VcfReader annotated_source {*annotated_source_path};
-        make_filter_pass(annotated_source, samples, dest);
-    } else {
-        make_filter_pass(source, samples, dest);
-    }
+    make_filter_pass(source, samples, dest, dest_header);
+    measure_store_ = boost::none;
 }
 
 const DoublePassVariantCallFilter::Path& DoublePassVariantCallFilter::temp_directory() const noexcept
@@ -48,89 +44,86 @@ const DoublePassVariantCallFilter::Path& DoublePassVariantCallFilter::temp_direc
     return temp_directory_;
 }
 
+const MeasureStore& DoublePassVariantCallFilter::measure_store() const noexcept
+{
+    assert(measure_store_);
+    return *measure_store_;
+}
+
 void DoublePassVariantCallFilter::log_registration_pass(Log& log) const
 {
     log << "CSR: Starting registration pass";
 }
 
-boost::optional<DoublePassVariantCallFilter::Path>
-DoublePassVariantCallFilter::make_registration_pass(const VcfReader& source, const VcfHeader& filtered_header) const
+void DoublePassVariantCallFilter::make_registration_pass(const VcfReader& source) const
 {
     if (info_log_) log_registration_pass(*info_log_);
     const auto samples = source.fetch_header().samples();
     prepare_for_registration(samples);
     if (progress_) progress_->start();
-    auto annotated_vcf = get_temp_measure_annotated_vcf(source, filtered_header);
+    make_measure_store(source);
     std::size_t record_idx {0};
     if (can_measure_multiple_blocks()) {
         for (auto p = source.iterate(); p.first != p.second;) {
             const auto blocks = read_next_blocks(p.first, p.second, samples);
-            record(blocks, record_idx, filtered_header, samples, annotated_vcf);
+            record(blocks, record_idx, samples);
             for (const auto& block : blocks) record_idx += block.size();
         }
     } else if (can_measure_single_call()) {
         auto p = source.iterate();
         std::for_each(std::move(p.first), std::move(p.second),
-                      [&] (const VcfRecord& call) { record(call, record_idx++, filtered_header, samples, annotated_vcf); });
+                      [&] (const VcfRecord& call) { record(call, record_idx++, samples); });
     } else {
         for (auto p = source.iterate(); p.first != p.second;) {
             const auto block = read_next_block(p.first, p.second, samples);
-            record(block, record_idx, filtered_header, samples, annotated_vcf);
+            record(block, record_idx, samples);
             record_idx += block.size();
         }
     }
+    if (measure_store_) measure_store_->finalise();
     if (progress_) progress_->stop();
-    if (annotated_vcf) {
-        return annotated_vcf->path();
-    } else {
-        return boost::none;
-    }
 }
 
-void DoublePassVariantCallFilter::record(const VcfRecord& call, const std::size_t record_idx, const VcfHeader& dest_header,
-                                         const SampleList& samples, OptionalVcfWriter& annotated_vcf) const
+void DoublePassVariantCallFilter::record(const VcfRecord& call, const std::size_t record_idx, const SampleList& samples) const
 {
-    record(call, measure(call), record_idx, dest_header, samples, annotated_vcf);
+    record(call, measure(call), record_idx, samples);
 }
 
-void DoublePassVariantCallFilter::record(const CallBlock& block, const std::size_t record_idx, const VcfHeader& dest_header,
-                                         const SampleList& samples, OptionalVcfWriter& annotated_vcf) const
+void DoublePassVariantCallFilter::record(const CallBlock& block, const std::size_t record_idx, const SampleList& samples) const
 {
-    record(block, measure(block), record_idx, dest_header, samples, annotated_vcf);
+    record(block, measure(block), record_idx, samples);
 }
 
-void DoublePassVariantCallFilter::record(const std::vector<CallBlock>& blocks, std::size_t record_idx, const VcfHeader& dest_header,
-                                         const SampleList& samples, OptionalVcfWriter& annotated_vcf) const
+void DoublePassVariantCallFilter::record(const std::vector<CallBlock>& blocks, std::size_t record_idx, const SampleList& samples) const
 {
     const auto measures = measure(blocks);
     assert(measures.size() == blocks.size());
     for (auto tup : boost::combine(blocks, measures)) {
         const auto& block = tup.get<0>();
-        record(block, tup.get<1>(), record_idx, dest_header, samples, annotated_vcf);
+        record(block, tup.get<1>(), record_idx, samples);
         record_idx += block.size();
     }
 }
 
 void DoublePassVariantCallFilter::record(const VcfRecord& call, const MeasureVector& measures, const std::size_t record_idx,
-                                         const VcfHeader& dest_header, const SampleList& samples, OptionalVcfWriter& annotated_vcf) const
+                                         const SampleList& samples) const
 {
     for (std::size_t sample_idx {0}; sample_idx < samples.size(); ++sample_idx) {
         this->record(record_idx, sample_idx, get_sample_values(measures, measures_, sample_idx));
     }
-    if (annotated_vcf) {
-        VcfRecord::Builder annotation_builder {call};
-        annotate(annotation_builder, measures, dest_header);
-        *annotated_vcf << annotation_builder.build_once();
+    if (measure_store_) {
+        assert(measure_store_->size() == record_idx);
+        measure_store_->push_back(measures);
     }
     log_progress(mapped_region(call));
 }
 
 void DoublePassVariantCallFilter::record(const CallBlock& block, const MeasureBlock& measures, std::size_t record_idx,
-                                         const VcfHeader& dest_header, const SampleList& samples, OptionalVcfWriter& annotated_vcf) const
+                                         const SampleList& samples) const
 {
     assert(measures.size() == block.size());
     for (auto tup : boost::combine(block, measures)) {
-        record(tup.get<0>(), tup.get<1>(), record_idx++, dest_header, samples, annotated_vcf);
+        record(tup.get<0>(), tup.get<1>(), record_idx++, samples);
     }
 }
 
@@ -139,7 +132,8 @@ void DoublePassVariantCallFilter::log_filter_pass_start(Log& log) const
     log << "CSR: Starting filtering pass";
 }
 
-void DoublePassVariantCallFilter::make_filter_pass(const VcfReader& source, const SampleList& samples, VcfWriter& dest) const
+void DoublePassVariantCallFilter::make_filter_pass(const VcfReader& source, const SampleList& samples,
+                                                   VcfWriter& dest, const VcfHeader& dest_header) const
 {
     if (info_log_) log_filter_pass_start(*info_log_);
     if (progress_) {
@@ -149,7 +143,16 @@ void DoublePassVariantCallFilter::make_filter_pass(const VcfReader& source, cons
     }
     auto p = source.iterate();
     std::size_t idx {0};
-    std::for_each(std::move(p.first), std::move(p.second), [&] (const VcfRecord& call) { filter(call, idx++, samples, dest); });
+    if (measure_annotations_requested()) {
+        auto measures = measure_store().reader();
+        std::for_each(std::move(p.first), std::move(p.second), [&] (const VcfRecord& call) {
+            filter(call, idx++, measures.read(), samples, dest, dest_header);
+        });
+    } else {
+        std::for_each(std::move(p.first), std::move(p.second), [&] (const VcfRecord& call) {
+            filter(call, idx++, {}, samples, dest, dest_header);
+        });
+    }
     if (progress_) progress_->stop();
 }
 
@@ -163,12 +166,18 @@ DoublePassVariantCallFilter::classify(std::size_t call_idx, const SampleList& sa
     return result;
 }
 
-void DoublePassVariantCallFilter::filter(const VcfRecord& call, const std::size_t call_idx, const SampleList& samples,
-                                         VcfWriter& dest) const
+void DoublePassVariantCallFilter::filter(const VcfRecord& call, const std::size_t call_idx, const MeasureVector& measures,
+                                         const SampleList& samples, VcfWriter& dest, const VcfHeader& dest_header) const
 {
     const auto sample_classifications = classify(call_idx, samples);
     const auto call_classification = merge(sample_classifications);
-    write(call, call_classification, samples, sample_classifications, dest);
+    if (measure_annotations_requested()) {
+        VcfRecord::Builder annotation_builder {call};
+        annotate(annotation_builder, measures, dest_header);
+        write(annotation_builder.build_once(), call_classification, samples, sample_classifications, dest);
+    } else {
+        write(call, call_classification, samples, sample_classifications, dest);
+    }
     log_progress(mapped_region(call));
 }
 
@@ -192,16 +201,13 @@ void DoublePassVariantCallFilter::log_progress(const GenomicRegion& region) cons
     }
 }
 
-boost::optional<VcfWriter>
-DoublePassVariantCallFilter::get_temp_measure_annotated_vcf(const VcfReader& source, const VcfHeader& header) const
+void DoublePassVariantCallFilter::make_measure_store(const VcfReader& source) const
 {
     if (measure_annotations_requested()) {
-        auto path = temp_directory();
-        path /= source.path().filename().stem();
-        path += ".annotated.bcf";
-        return VcfWriter {std::move(path), header};
-    } else {
-        return boost::none;
+        auto prefix = temp_directory();
+        prefix /= source.path().filename().stem();
+        prefix += ".measures";
+        measure_store_.emplace(measures_.size(), std::move(prefix));
     }
 }
 
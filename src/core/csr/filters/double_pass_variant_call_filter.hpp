@@ -13,6 +13,7 @@
 #include "basics/genomic_region.hpp"
 #include "logging/logging.hpp"
 #include "variant_call_filter.hpp"
+#include "measure_store.hpp"
 
 namespace octopus { namespace csr {
 
@@ -43,13 +44,12 @@ protected:
     const Path& temp_directory() const noexcept;
     
 private:
-    using OptionalVcfWriter = boost::optional<VcfWriter>;
-    
     mutable boost::optional<Log> info_log_;
     mutable boost::optional<ProgressMeter&> progress_;
     mutable boost::optional<GenomicRegion::ContigName> current_contig_;
     
     Path temp_directory_;
+    mutable boost::optional<MeasureStore> measure_store_;
     
     virtual void log_registration_pass(Log& log) const;
     virtual void prepare_for_registration(const SampleList& samples) const {};
@@ -60,22 +60,19 @@ private:
     
     void filter(const VcfReader& source, VcfWriter& dest, const VcfHeader& dest_header) const override;
     
-    boost::optional<Path> make_registration_pass(const VcfReader& source, const VcfHeader& filtered_header) const;
-    void record(const VcfRecord& call, std::size_t record_idx, const VcfHeader& dest_header,
-                const SampleList& samples, OptionalVcfWriter& annotated_vcf) const;
-    void record(const CallBlock& block, std::size_t record_idx, const VcfHeader& dest_header,
-                const SampleList& samples, OptionalVcfWriter& annotated_vcfr) const;
-    void record(const std::vector<CallBlock>& blocks, std::size_t record_idx, const VcfHeader& dest_header,
-                const SampleList& samples, OptionalVcfWriter& annotated_vcf) const;
-    void record(const VcfRecord& call, const MeasureVector& measures, std::size_t record_idx, const VcfHeader& dest_header,
-                const SampleList& samples, OptionalVcfWriter& annotated_vcf) const;
-    void record(const CallBlock& block, const MeasureBlock& measures, std::size_t record_idx, const VcfHeader& dest_header,
-                const SampleList& samples, OptionalVcfWriter& annotated_vcf) const;
-    void make_filter_pass(const VcfReader& source, const SampleList& samples, VcfWriter& dest) const;
+    void make_registration_pass(const VcfReader& source) const;
+    void record(const VcfRecord& call, std::size_t record_idx, const SampleList& samples) const;
+    void record(const CallBlock& block, std::size_t record_idx, const SampleList& samples) const;
+    void record(const std::vector<CallBlock>& blocks, std::size_t record_idx, const SampleList& samples) const;
+    void record(const VcfRecord& call, const MeasureVector& measures, std::size_t record_idx, const SampleList& samples) const;
+    void record(const CallBlock& block, const MeasureBlock& measures, std::size_t record_idx, const SampleList& samples) const;
+    void make_filter_pass(const VcfReader& source, const SampleList& samples, VcfWriter& dest, const VcfHeader& dest_header) const;
     std::vector<Classification> classify(std::size_t call_idx, const SampleList& samples) const;
-    void filter(const VcfRecord& call, std::size_t idx, const SampleList& samples, VcfWriter& dest) const;
+    void filter(const VcfRecord& call, std::size_t idx, const MeasureVector& measures, const SampleList& samples,
+                VcfWriter& dest, const VcfHeader& dest_header) const;
     void log_progress(const GenomicRegion& region) const;
-    boost::optional<VcfWriter> get_temp_measure_annotated_vcf(const VcfReader& source, const VcfHeader& header) const;
+    void make_measure_store(const VcfReader& source) const;
+    const MeasureStore& measure_store() const noexcept;
 };
 
 } // namespace csr
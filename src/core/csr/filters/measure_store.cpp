@@ -0,0 +1,311 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "measure_store.hpp"
+
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <cassert>
+
+#include <boost/variant.hpp>
+#include <boost/any.hpp>
+#include <boost/mpl/at.hpp>
+#include <boost/mpl/size.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include "exceptions/program_error.hpp"
+#include "exceptions/system_error.hpp"
+
+namespace octopus { namespace csr {
+
+namespace {
+
+// Values between indexed values are found by skipping from the previous indexed value
+constexpr std::size_t indexStride {64};
+// Values are written to file in chunks of at least this many bytes
+constexpr std::size_t maxBufferBytes {1'048'576};
+
+using ResultTypes = Measure::ResultType::types;
+constexpr int numResultTypes {boost::mpl::size<ResultTypes>::value};
+
+class UnstorableMeasure : public ProgramError
+{
+    std::string do_where() const override { return "MeasureStore::push_back"; }
+    std::string do_why() const override { return "Measures of type boost::any cannot be stored"; }
+};
+
+class MeasureStoreIOError : public SystemError
+{
+    std::string do_where() const override { return "MeasureStore"; }
+    std::string do_why() const override { return "Could not write measures to " + file_.string(); }
+    std::string do_help() const override { return "Check the temporary directory is writable and has free space"; }
+    boost::filesystem::path file_;
+public:
+    MeasureStoreIOError(boost::filesystem::path file) : file_ {std::move(file)} {}
+};
+
+struct MeasureEncoder : public boost::static_visitor<>
+{
+    MeasureEncoder(std::vector<char>& buffer) : buffer_ {buffer} {}
+    template <typename T> void operator()(const T& value)
+    {
+        const auto bytes = reinterpret_cast<const char*>(&value);
+        buffer_.insert(std::end(buffer_), bytes, bytes + sizeof(T));
+    }
+    template <typename T> void operator()(const boost::optional<T>& value)
+    {
+        (*this)(static_cast<bool>(value));
+        if (value) (*this)(*value);
+    }
+    template <typename T> void operator()(const std::vector<T>& values)
+    {
+        (*this)(static_cast<std::uint32_t>(values.size()));
+        for (const T value : values) (*this)(value);
+    }
+    void operator()(const boost::any& value) { throw UnstorableMeasure {}; }
+private:
+    std::vector<char>& buffer_;
+};
+
+template <typename T>
+struct MeasureDecoder
+{
+    static T read(const char*& data) noexcept
+    {
+        T result;
+        std::memcpy(&result, data, sizeof(T));
+        data += sizeof(T);
+        return result;
+    }
+    static void skip(const char*& data) noexcept { data += sizeof(T); }
+};
+
+template <typename T>
+struct MeasureDecoder<boost::optional<T>>
+{
+    static boost::optional<T> read(const char*& data) noexcept
+    {
+        if (MeasureDecoder<bool>::read(data)) {
+            return MeasureDecoder<T>::read(data);
+        } else {
+            return boost::none;
+        }
+    }
+    static void skip(const char*& data) noexcept
+    {
+        if (MeasureDecoder<bool>::read(data)) MeasureDecoder<T>::skip(data);
+    }
+};
+
+template <typename T>
+struct MeasureDecoder<std::vector<T>>
+{
+    static std::vector<T> read(const char*& data)
+    {
+        const auto n = MeasureDecoder<std::uint32_t>::read(data);
+        std::vector<T> result {};
+        result.reserve(n);
+        for (std::uint32_t i {0}; i < n; ++i) result.push_back(MeasureDecoder<T>::read(data));
+        return result;
+    }
+    static void skip(const char*& data) noexcept
+    {
+        const auto n = MeasureDecoder<std::uint32_t>::read(data);
+        for (std::uint32_t i {0}; i < n; ++i) MeasureDecoder<T>::skip(data);
+    }
+};
+
+template <>
+struct MeasureDecoder<boost::any>
+{
+    static boost::any read(const char*& data) { throw UnstorableMeasure {}; }
+    static void skip(const char*& data) { throw UnstorableMeasure {}; }
+};
+
+template <int I>
+Measure::ResultType decode(const int type, const char*& data)
+{
+    using T = typename boost::mpl::at_c<ResultTypes, I>::type;
+    return type == I ? Measure::ResultType {MeasureDecoder<T>::read(data)} : decode<I + 1>(type, data);
+}
+
+template <>
+Measure::ResultType decode<numResultTypes>(const int type, const char*& data)
+{
+    throw UnstorableMeasure {};
+}
+
+template <int I>
+void skip(const int type, const char*& data)
+{
+    using T = typename boost::mpl::at_c<ResultTypes, I>::type;
+    type == I ? MeasureDecoder<T>::skip(data) : skip<I + 1>(type, data);
+}
+
+template <>
+void skip<numResultTypes>(const int type, const char*& data)
+{
+    throw UnstorableMeasure {};
+}
+
+Measure::ResultType decode(const char*& data)
+{
+    const auto type = MeasureDecoder<std::uint8_t>::read(data);
+    return decode<0>(type, data);
+}
+
+void skip(const char*& data)
+{
+    const auto type = MeasureDecoder<std::uint8_t>::read(data);
+    skip<0>(type, data);
+}
+
+} // namespace
+
+MeasureStore::Reader::Reader(const MeasureStore& store)
+: positions_ {}
+{
+    assert(store.finalised_);
+    positions_.reserve(store.columns_.size());
+    for (const auto& column : store.columns_) {
+        positions_.push_back(column.data());
+    }
+}
+
+MeasureStore::ValueVector MeasureStore::Reader::read()
+{
+    ValueVector result {};
+    result.reserve(positions_.size());
+    for (auto& position : positions_) {
+        result.push_back(decode(position));
+    }
+    return result;
+}
+
+MeasureStore::MeasureStore(const std::size_t num_measures)
+: columns_(num_measures)
+{}
+
+MeasureStore::MeasureStore(const std::size_t num_measures, Path prefix)
+: columns_(num_measures)
+{
+    for (std::size_t measure_idx {0}; measure_idx < num_measures; ++measure_idx) {
+        auto& column = columns_[measure_idx];
+        Path file {prefix};
+        file += "." + std::to_string(measure_idx) + ".bin";
+        column.stream.open(file.string(), std::ios::binary | std::ios::trunc);
+        if (!column.stream) throw MeasureStoreIOError {file};
+        column.file = std::move(file);
+    }
+}
+
+MeasureStore::~MeasureStore()
+{
+    for (auto& column : columns_) {
+        if (column.file) {
+            column.mapped.close();
+            column.stream.close();
+            boost::system::error_code ec {};
+            boost::filesystem::remove(*column.file, ec);
+        }
+    }
+}
+
+std::size_t MeasureStore::num_measures() const noexcept
+{
+    return columns_.size();
+}
+
+std::size_t MeasureStore::size() const noexcept
+{
+    return num_records_;
+}
+
+void MeasureStore::push_back(const ValueVector& measures)
+{
+    assert(!finalised_);
+    assert(measures.size() == columns_.size());
+    for (std::size_t measure_idx {0}; measure_idx < measures.size(); ++measure_idx) {
+        auto& column = columns_[measure_idx];
+        const auto& value = measures[measure_idx];
+        const auto buffered_size = column.buffer.size();
+        if (num_records_ % indexStride == 0) {
+            column.index.push_back(column.size);
+        }
+        column.buffer.push_back(static_cast<char>(value.which()));
+        MeasureEncoder encoder {column.buffer};
+        boost::apply_visitor(encoder, value);
+        column.size += column.buffer.size() - buffered_size;
+        if (column.file && column.buffer.size() >= maxBufferBytes) {
+            flush(column);
+        }
+    }
+    ++num_records_;
+}
+
+void MeasureStore::finalise()
+{
+    if (finalised_) return;
+    for (auto& column : columns_) {
+        if (column.file) {
+            flush(column);
+            column.stream.close();
+            if (column.size > 0) {
+                column.mapped.open(column.file->string());
+            }
+        }
+        column.buffer.shrink_to_fit();
+        column.index.shrink_to_fit();
+    }
+    finalised_ = true;
+}
+
+MeasureStore::ValueType MeasureStore::get(const std::size_t record_idx, const std::size_t measure_idx) const
+{
+    assert(finalised_);
+    assert(record_idx < num_records_ && measure_idx < columns_.size());
+    const auto& column = columns_[measure_idx];
+    auto position = column.data() + column.index[record_idx / indexStride];
+    for (auto n = record_idx % indexStride; n > 0; --n) {
+        skip(position);
+    }
+    return decode(position);
+}
+
+MeasureStore::ValueVector MeasureStore::get(const std::size_t record_idx) const
+{
+    ValueVector result {};
+    result.reserve(columns_.size());
+    for (std::size_t measure_idx {0}; measure_idx < columns_.size(); ++measure_idx) {
+        result.push_back(get(record_idx, measure_idx));
+    }
+    return result;
+}
+
+MeasureStore::Reader MeasureStore::reader() const
+{
+    return Reader {*this};
+}
+
+// private methods
+
+const char* MeasureStore::Column::data() const noexcept
+{
+    return mapped.is_open() ? mapped.data() : buffer.data();
+}
+
+void MeasureStore::flush(Column& column)
+{
+    assert(column.file);
+    if (!column.buffer.empty()) {
+        column.stream.write(column.buffer.data(), column.buffer.size());
+        if (!column.stream) throw MeasureStoreIOError {*column.file};
+        column.buffer.clear();
+    }
+}
+
+} // namespace csr
+} // namespace octopus
@@ -0,0 +1,102 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef measure_store_hpp
+#define measure_store_hpp
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+#include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "../measures/measure.hpp"
+
+namespace octopus { namespace csr {
+
+/*
+    Stores the measures of each record in binary columns, one per measure, so values can be written
+    and read back without text serialisation. Each value is stored as its ResultType index followed
+    by its binary representation.
+
+    If given a path prefix, columns are written to files (one per measure) as records are added and
+    memory mapped once the store is finalised, otherwise columns are kept in memory. Records must be
+    added before the store is finalised, and read after.
+*/
+class MeasureStore
+{
+public:
+    using Path        = boost::filesystem::path;
+    using ValueType   = Measure::ResultType;
+    using ValueVector = std::vector<ValueType>;
+
+    // Reads records in order, starting from the first
+    class Reader
+    {
+    public:
+        Reader() = delete;
+
+        Reader(const MeasureStore& store);
+
+        Reader(const Reader&)            = default;
+        Reader& operator=(const Reader&) = default;
+        Reader(Reader&&)                 = default;
+        Reader& operator=(Reader&&)      = default;
+
+        ~Reader() = default;
+
+        ValueVector read();
+
+    private:
+        std::vector<const char*> positions_;
+    };
+
+    MeasureStore() = delete;
+
+    MeasureStore(std::size_t num_measures);
+    MeasureStore(std::size_t num_measures, Path prefix);
+
+    MeasureStore(const MeasureStore&)            = delete;
+    MeasureStore& operator=(const MeasureStore&) = delete;
+    MeasureStore(MeasureStore&&)                 = delete;
+    MeasureStore& operator=(MeasureStore&&)      = delete;
+
+    ~MeasureStore();
+
+    std::size_t num_measures() const noexcept;
+    std::size_t size() const noexcept;
+
+    void push_back(const ValueVector& measures);
+    void finalise();
+
+    ValueType get(std::size_t record_idx, std::size_t measure_idx) const;
+    ValueVector get(std::size_t record_idx) const;
+    Reader reader() const;
+
+private:
+    struct Column
+    {
+        std::vector<char> buffer; // all values, or values not yet written to file
+        std::vector<std::uint64_t> index; // offset of every indexStride'th value
+        std::uint64_t size = 0;
+        boost::optional<Path> file = boost::none;
+        std::ofstream stream = {};
+        boost::iostreams::mapped_file_source mapped = {};
+
+        const char* data() const noexcept;
+    };
+
+    std::vector<Column> columns_;
+    std::size_t num_records_ = 0;
+    bool finalised_ = false;
+
+    void flush(Column& column);
+};
+
+} // namespace csr
+} // namespace octopus
+
+#endif
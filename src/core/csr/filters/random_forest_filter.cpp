@@ -10,7 +10,6 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
-#include <limits>
 
 #include <boost/variant.hpp>
 #include <boost/lexical_cast.hpp>
@@ -111,6 +110,33 @@ auto concat(const std::vector<std::vector<MeasureWrapper>>& measures)
     return result;
 }
 
+class MalformedForestFile : public MalformedFileError
+{
+    std::string do_where() const override { return "RandomForestFilter"; }
+    std::string do_help() const override
+    {
+        return "make sure the forest was trained with the same measures and in the same order as the prediction measures";
+    }
+public:
+    MalformedForestFile(boost::filesystem::path file) : MalformedFileError {std::move(file)} {}
+};
+
+CompiledRandomForest load_forest(const RandomForestFilter::Path& path, const std::size_t num_measures)
+{
+    ranger::ForestProbability forest {};
+    try {
+        forest.loadForPrediction(path.string());
+    } catch (const std::runtime_error& e) {
+        throw MalformedForestFile {path};
+    }
+    if (forest.getNumIndependentVariables() != num_measures || forest.getClassValues().empty()) {
+        throw MalformedForestFile {path};
+    }
+    // Class values are ordered by first appearance in the training data, true positives are labelled 1
+    const std::size_t false_class_idx {forest.getClassValues().front() == 1 ? 1u : 0u};
+    return CompiledRandomForest {forest, false_class_idx};
+}
+
 } // namespace
 
 RandomForestFilter::RandomForestFilter(FacetFactory facet_factory,
@@ -133,14 +159,17 @@ RandomForestFilter::RandomForestFilter(FacetFactory facet_factory,
 , options_ {std::move(options)}
 , threading_ {threading}
 , num_records_ {0}
-, data_buffer_ {}
 {
-    forest_measure_info_.reserve(ranger_forests.size());
+    forest_measure_info_.reserve(forest_measures.size());
     std::size_t index {0};
     for (const auto& measures : forest_measures) {
         forest_measure_info_.push_back({index, measures.size()});
         index += measures.size();
     }
+    forests_.reserve(forest_paths_.size());
+    for (std::size_t forest_idx {0}; forest_idx < forest_paths_.size(); ++forest_idx) {
+        forests_.push_back(load_forest(forest_paths_[forest_idx], forest_measure_info_[forest_idx].number));
+    }
 }
 
 std::string RandomForestFilter::do_name() const
@@ -151,11 +180,6 @@ std::string RandomForestFilter::do_name() const
 const std::string RandomForestFilter::genotype_quality_name_ = "RFGQ";
 const std::string RandomForestFilter::call_quality_name_ = "RFGQ_ALL";
 
-std::unique_ptr<ranger::Forest> RandomForestFilter::make_forest() const
-{
-    return std::make_unique<ranger::ForestProbability>();
-}
-
 boost::optional<std::string> RandomForestFilter::genotype_quality_name() const
 {
     return genotype_quality_name_;
@@ -189,37 +213,10 @@ std::int8_t RandomForestFilter::choose_forest(const MeasureVector& measures) con
     return chooser_(chooser_measures);
 }
 
-template <typename T>
-static void write_line(const std::vector<T>& data, std::ostream& out)
-{
-    std::copy(std::cbegin(data), std::prev(std::cend(data)), std::ostream_iterator<T> {out, " "});
-    out << data.back() << '\n';
-}
-
 void RandomForestFilter::prepare_for_registration(const SampleList& samples) const
 {
-    const auto num_forests = forest_paths_.size();
-    data_.resize(num_forests);
-    for (std::size_t forest_idx {0}; forest_idx < num_forests; ++forest_idx) {
-        const auto& info = forest_measure_info_[forest_idx];
-        std::vector<std::string> data_header {};
-        const auto first_measure = std::next(std::cbegin(measures_), info.start_index);
-        data_header.reserve(info.number + 1);
-        std::transform(first_measure, std::next(first_measure, info.number),
-                       std::back_inserter(data_header), [] (const auto& measure) { return measure.name(); });
-        data_header.push_back("TP");
-        data_[forest_idx].reserve(samples.size());
-        for (const auto& sample : samples) {
-            auto data_path = temp_directory();
-            Path fname {"octopus_ranger_temp_forest_data_" + std::to_string(forest_idx) + "_" + sample + ".dat"};
-            data_path /= fname;
-            data_[forest_idx].emplace_back(data_path.string(), data_path);
-            write_line(data_header, data_[forest_idx].back().handle);
-        }
-    }
-    data_buffer_.resize(num_forests);
-    for (auto& buffer : data_buffer_) buffer.resize(samples.size());
-    choices_.resize(samples.size());
+    pending_records_.assign(forests_.size(), std::vector<PendingRecords>(samples.size()));
+    false_probabilities_.assign(samples.size(), {});
 }
 
 namespace {
@@ -279,137 +276,104 @@ class NanMeasure : public ProgramError
     std::string do_help() const override { return "submit an error report"; }
 };
 
-void check_nan(const std::vector<double>& values)
+template <typename ForwardIt>
+void check_nan(ForwardIt first, ForwardIt last)
 {
-    if (std::any_of(std::cbegin(values), std::cend(values), [] (auto v) { return std::isnan(v); })) {
+    if (std::any_of(first, last, [] (auto v) { return std::isnan(v); })) {
         throw NanMeasure {};
     }
 }
 
-void skip_lines(std::istream& in, int n = 1)
+// Records are predicted in blocks of this size so the measures never need to be held for all records
+constexpr std::size_t maxPendingRecords {10'000};
+// Bounds the number of predicted blocks held at once, so completed blocks are collected as registration proceeds
+constexpr std::size_t maxPendingPredictionsPerWorker {2};
+
+template <typename F>
+auto run(F&& task, ThreadPool& workers)
 {
-    for (; n > 0; --n) in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (workers.empty()) {
+        std::promise<decltype(task())> result {};
+        result.set_value(task());
+        return result.get_future();
+    } else {
+        return workers.push(std::forward<F>(task));
+    }
 }
-    
+
 } // namespace
 
 void RandomForestFilter::record(const std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const
 {
     assert(!measures.empty());
     const auto forest_idx = choose_forest(measures);
-    const auto num_forests = static_cast<std::remove_const_t<decltype(forest_idx)>>(data_buffer_.size());
+    const auto num_forests = static_cast<std::remove_const_t<decltype(forest_idx)>>(forests_.size());
     if (forest_idx >= 0 && forest_idx < num_forests) {
-        auto& buffer = data_buffer_[forest_idx][sample_idx];
+        auto& pending = pending_records_[forest_idx][sample_idx];
         const auto& info = forest_measure_info_[forest_idx];
         const auto first_measure = std::next(std::cbegin(measures), info.start_index);
-        buffer.reserve(info.number);
+        const auto first_value_idx = pending.measures.size();
         std::transform(first_measure, std::next(first_measure, info.number),
-                       std::back_inserter(buffer), cast_to_double);
-        buffer.push_back(0); // dummy TP value
-        check_nan(buffer);
-        write_line(buffer, data_[forest_idx][sample_idx].handle);
-        buffer.clear();
+                       std::back_inserter(pending.measures), cast_to_double);
+        check_nan(std::next(std::cbegin(pending.measures), first_value_idx), std::cend(pending.measures));
+        pending.record_indices.push_back(call_idx);
+        if (pending.record_indices.size() == maxPendingRecords) {
+            predict(forest_idx, sample_idx);
+        }
     } else {
         hard_filtered_record_indices_.push_back(call_idx);
     }
     if (call_idx >= num_records_) ++num_records_;
-    choices_[sample_idx].push_back(forest_idx);
 }
 
-void RandomForestFilter::close_data_files() const
+void RandomForestFilter::predict(const std::size_t forest_idx, const std::size_t sample_idx) const
 {
-    for (auto& forest : data_) {
-        for (auto& sample : forest) {
-            sample.handle.close();
-        }
+    auto& pending = pending_records_[forest_idx][sample_idx];
+    if (pending.record_indices.empty()) return;
+    const auto& forest = forests_[forest_idx];
+    auto task = [&forest, records = std::move(pending)] () mutable -> Predictions {
+        return {std::move(records.record_indices), forest.predict(records.measures)};
+    };
+    pending = PendingRecords {};
+    const auto max_pending_predictions = std::max(maxPendingPredictionsPerWorker * workers_.size(), std::size_t {1});
+    while (pending_predictions_.size() >= max_pending_predictions) {
+        collect_oldest_prediction();
     }
+    pending_predictions_.emplace_back(sample_idx, run(std::move(task), workers_));
 }
 
-namespace {
-
-bool read_header(std::ifstream& prediction_file)
-{
-    skip_lines(prediction_file);
-    std::string order;
-    std::getline(prediction_file, order);
-    skip_lines(prediction_file);
-    return order.front() == '1';
-}
-
-static double get_prob_false(std::string& prediction_line, const bool tp_first)
+void RandomForestFilter::collect_oldest_prediction() const
 {
-    using std::cbegin; using std::cend;
-    if (tp_first) {
-        prediction_line.erase(cbegin(prediction_line), std::next(std::find(cbegin(prediction_line), cend(prediction_line), ' ')));
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
-    } else {
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
+    assert(!pending_predictions_.empty());
+    const auto sample_idx = pending_predictions_.front().first;
+    const auto predictions = pending_predictions_.front().second.get();
+    pending_predictions_.pop_front();
+    assert(predictions.record_indices.size() == predictions.false_probabilities.size());
+    auto& sample_false_probabilities = false_probabilities_[sample_idx];
+    for (std::size_t i {0}; i < predictions.record_indices.size(); ++i) {
+        const auto record_idx = predictions.record_indices[i];
+        if (record_idx >= sample_false_probabilities.size()) {
+            sample_false_probabilities.resize(record_idx + 1);
+        }
+        sample_false_probabilities[record_idx] = predictions.false_probabilities[i];
     }
-    return boost::lexical_cast<double>(prediction_line);
 }
-    
-} // namespace
-
-class MalformedForestFile : public MalformedFileError
-{
-    std::string do_where() const override { return "RandomForestFilter"; }
-    std::string do_help() const override
-    {
-        return "make sure the forest was trained with the same measures and in the same order as the prediction measures";
-    }
-public:
-    MalformedForestFile(boost::filesystem::path file) : MalformedFileError {std::move(file)} {}
-};
 
 void RandomForestFilter::prepare_for_classification(boost::optional<Log>& log) const
 {
-    close_data_files();
-    if (num_records_ == 0) return;
-    const Path ranger_prefix {temp_directory() / "octopus_ranger_temp"};
-    const Path ranger_prediction_fname {ranger_prefix.string() + ".prediction"};
-    data_buffer_.resize(1);
-    auto& predictions = data_buffer_[0];
-    predictions.resize(num_records_);
-    const auto num_samples = choices_.size();
-    for (std::size_t forest_idx {0}; forest_idx < forest_paths_.size(); ++forest_idx) {
-        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
-            auto forest_choice_itr = std::find(std::cbegin(choices_[sample_idx]), std::cend(choices_[sample_idx]), forest_idx);
-            if (forest_choice_itr != std::cend(choices_[sample_idx])) {
-                const auto& file = data_[forest_idx][sample_idx];
-                std::vector<std::string> tmp {}, cat_vars {};
-                const auto ranger_threads = threading_.max_threads ? *threading_.max_threads : 1u;
-                const auto forest = make_forest();
-                try {
-                    forest->initCpp("", ranger::MemoryMode::MEM_DOUBLE, file.path.string(), 0, ranger_prefix.string(),
-                                    1000, nullptr, 12, ranger_threads, forest_paths_[forest_idx].string(), ranger::ImportanceMode::IMP_GINI, 1, "",
-                                    tmp, "", true, cat_vars, false, ranger::SplitRule::LOGRANK, "", false, 1.0,
-                                    ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
-                                    ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS, ranger::DEFAULT_MAXDEPTH);
-                } catch (const std::runtime_error& e) {
-                    throw MalformedForestFile {forest_paths_[forest_idx]};
-                }
-                forest->run(false, false);
-                forest->writePredictionFile();
-                std::ifstream prediction_file {ranger_prediction_fname.string()};
-                const auto tp_first = read_header(prediction_file);
-                std::string line;
-                while (std::getline(prediction_file, line)) {
-                    if (!line.empty()) {
-                        const auto record_idx = std::distance(std::cbegin(choices_[sample_idx]), forest_choice_itr);
-                        predictions[record_idx].push_back(get_prob_false(line, tp_first));
-                        assert(forest_choice_itr != std::cend(choices_[sample_idx]));
-                        forest_choice_itr = std::find(std::next(forest_choice_itr), std::cend(choices_[sample_idx]), forest_idx);
-                    }
-                }
-                boost::filesystem::remove(file.path);
-            }
+    for (std::size_t forest_idx {0}; forest_idx < pending_records_.size(); ++forest_idx) {
+        for (std::size_t sample_idx {0}; sample_idx < pending_records_[forest_idx].size(); ++sample_idx) {
+            predict(forest_idx, sample_idx);
         }
     }
-    boost::filesystem::remove(ranger_prediction_fname);
-    data_.clear();
-    data_.shrink_to_fit();
-    choices_.clear();
-    choices_.shrink_to_fit();
+    pending_records_.clear();
+    pending_records_.shrink_to_fit();
+    while (!pending_predictions_.empty()) {
+        collect_oldest_prediction();
+    }
+    for (auto& sample_false_probabilities : false_probabilities_) {
+        sample_false_probabilities.resize(num_records_);
+    }
     if (!hard_filtered_record_indices_.empty()) {
         hard_filtered_.resize(num_records_, false);
         for (auto idx : hard_filtered_record_indices_) {
@@ -420,18 +384,12 @@ void RandomForestFilter::prepare_for_classification(boost::optional<Log>& log) c
     }
 }
 
-std::size_t RandomForestFilter::get_forest_choice(std::size_t call_idx, std::size_t sample_idx) const
-{
-    return choices_.empty() ? 0 : choices_[sample_idx][call_idx];
-}
-
 VariantCallFilter::Classification RandomForestFilter::classify(const std::size_t call_idx, std::size_t sample_idx) const
 {
     Classification result {};
     if (hard_filtered_.empty() || !hard_filtered_[call_idx]) {
-        const auto& predictions = data_buffer_[0];
-        assert(call_idx < predictions.size() && sample_idx < predictions[call_idx].size());
-        const auto prob_false = predictions[call_idx][sample_idx];
+        assert(sample_idx < false_probabilities_.size() && call_idx < false_probabilities_[sample_idx].size());
+        const auto prob_false = false_probabilities_[sample_idx][call_idx];
         result.quality = probability_false_to_phred(std::max(prob_false, 1e-10));
         if (*result.quality >= min_soft_genotype_quality()) {
             result.category = Classification::Category::unfiltered;
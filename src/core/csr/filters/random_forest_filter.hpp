@@ -5,19 +5,19 @@
 #define random_forest_filter_hpp
 
 #include <vector>
+#include <deque>
 #include <cstddef>
 #include <memory>
-#include <fstream>
+#include <future>
 #include <functional>
-#include <cstddef>
+#include <utility>
 
 #include <boost/optional.hpp>
 #include <boost/filesystem.hpp>
 
-#include "ranger/Forest.h"
-
 #include "basics/phred.hpp"
 #include "double_pass_variant_call_filter.hpp"
+#include "compiled_random_forest.hpp"
 
 namespace octopus { namespace csr {
 
@@ -65,30 +65,34 @@ protected:
     Phred<double> min_soft_call_quality() const noexcept;
 
 private:
-    struct File
-    {
-        std::ofstream handle;
-        Path path;
-        template <typename F, typename P>
-        File(F&& handle, P&& path) : handle {std::forward<F>(handle)}, path {std::forward<P>(path)} {};
-    };
     struct ForestMeasureInfo
     {
         std::size_t start_index, number;
     };
+    // Records waiting to be predicted, with measures stored record major
+    struct PendingRecords
+    {
+        std::vector<double> measures;
+        std::vector<std::size_t> record_indices;
+    };
+    struct Predictions
+    {
+        std::vector<std::size_t> record_indices;
+        std::vector<double> false_probabilities;
+    };
     
     std::vector<Path> forest_paths_;
-    std::vector<std::unique_ptr<ranger::Forest>> forests_;
+    std::vector<CompiledRandomForest> forests_;
     std::function<std::int8_t(std::vector<Measure::ResultType>)> chooser_;
     std::vector<ForestMeasureInfo> forest_measure_info_;
     std::size_t num_chooser_measures_;
     Options options_;
     ConcurrencyPolicy threading_;
     
-    mutable std::vector<std::vector<File>> data_;
     mutable std::size_t num_records_;
-    mutable std::vector<std::vector<std::vector<double>>> data_buffer_;
-    mutable std::vector<std::deque<std::int8_t>> choices_;
+    mutable std::vector<std::vector<PendingRecords>> pending_records_; // forest x sample
+    mutable std::deque<std::pair<std::size_t, std::future<Predictions>>> pending_predictions_; // sample, in submission order
+    mutable std::vector<std::vector<double>> false_probabilities_; // sample x record
     mutable std::deque<std::size_t> hard_filtered_record_indices_;
     mutable std::vector<bool> hard_filtered_;
     
@@ -111,14 +115,13 @@ private:
     virtual bool is_soft_filtered(const ClassificationList& sample_classifications, boost::optional<Phred<double>> joint_quality,
                                   const MeasureVector& measures, std::vector<std::string>& reasons) const override;
     
-    std::unique_ptr<ranger::Forest> make_forest() const;
     boost::optional<std::string> genotype_quality_name() const override;
     std::int8_t choose_forest(const MeasureVector& measures) const;
     void prepare_for_registration(const SampleList& samples) const override;
     void record(std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const override;
-    void close_data_files() const;
+    void predict(std::size_t forest_idx, std::size_t sample_idx) const;
+    void collect_oldest_prediction() const;
     void prepare_for_classification(boost::optional<Log>& log) const override;
-    std::size_t get_forest_choice(std::size_t call_idx, std::size_t sample_idx) const;
     Classification classify(std::size_t call_idx, std::size_t sample_idx) const override;
 };
 
@@ -5,7 +5,6 @@
 #define unsupervised_clustering_filter_hpp
 
 #include <vector>
-#include <deque>
 #include <cstddef>
 
 #include <boost/optional.hpp>
@@ -33,7 +32,7 @@ public:
     virtual ~UnsupervisedClusteringFilter() override = default;
     
 private:
-    mutable std::deque<MeasureVector> data_;
+    mutable std::size_t num_records_ = 0;
     mutable std::vector<Classification> classifications_;
     
     std::string do_name() const override;
@@ -41,9 +40,6 @@ private:
     void record(std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const override;
     void prepare_for_classification(boost::optional<Log>& log) const override;
     Classification classify(std::size_t call_idx, std::size_t sample_idx) const override;
-    
-    bool all_missing(const MeasureVector& measures) const noexcept;
-    void remove_missing_features() const;
 };
 
 } // namespace csr
@@ -30,6 +30,7 @@
 #include "utils/parallel_transform.hpp"
 #include "io/variant/vcf_writer.hpp"
 #include "io/variant/vcf_spec.hpp"
+#include "exceptions/program_error.hpp"
 
 namespace octopus { namespace csr {
 
@@ -65,11 +66,11 @@ VariantCallFilter::VariantCallFilter(FacetFactory facet_factory,
                                      ConcurrencyPolicy threading)
 : measures_ {std::move(measures)}
 , debug_log_ {logging::get_debug_log()}
+, workers_ {get_pool_size(threading)}
 , facet_factory_ {std::move(facet_factory)}
 , facet_names_ {get_all_requirements(measures_)}
 , output_config_ {output_config}
 , duplicate_measures_ {}
-, workers_ {get_pool_size(threading)}
 {
     std::unordered_map<MeasureWrapper, int> measure_counts {};
     measure_counts.reserve(measures_.size());
@@ -113,6 +114,54 @@ void VariantCallFilter::filter(const VcfReader& source, VcfWriter& dest) const
     }
 }
 
+bool VariantCallFilter::can_filter_in_memory() const noexcept
+{
+    return do_can_filter_in_memory();
+}
+
+bool VariantCallFilter::uses_read_assignments() const noexcept
+{
+    return std::find(std::cbegin(facet_names_), std::cend(facet_names_), "ReadAssignments") != std::cend(facet_names_);
+}
+
+VcfHeader VariantCallFilter::make_header(const VcfHeader& source_header) const
+{
+    VcfHeader::Builder builder {source_header};
+    if (output_config_.clear_info) {
+        builder.clear_info();
+    }
+    if (measure_annotations_requested()) {
+        for (const auto& measure : measures_) {
+            if (is_requested_annotation(measure)) {
+                measure.annotate(builder);
+            }
+        }
+    }
+    if (output_config_.emit_sites_only) {
+        builder.clear_format();
+    }
+    annotate(builder);
+    return builder.build_once();
+}
+
+std::deque<VcfRecord>
+VariantCallFilter::filter(const std::deque<VcfRecord>& calls, const ReadMap& reads, const VcfHeader& dest_header,
+                          const std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
+{
+    assert(can_filter_in_memory());
+    const auto samples = dest_header.samples();
+    std::deque<VcfRecord> result {};
+    for (auto first = std::cbegin(calls); first != std::cend(calls);) {
+        const auto block = read_next_block(first, std::cend(calls), samples);
+        const auto measures = measure(block, compute_facets(block, reads, likelihoods));
+        for (auto tup : boost::combine(block, measures)) {
+            auto filtered_call = filter(tup.get<0>(), tup.get<1>(), dest_header, samples);
+            if (filtered_call) result.push_back(std::move(*filtered_call));
+        }
+    }
+    return result;
+}
+
 // protected methods
 
 namespace {
@@ -193,10 +242,8 @@ std::vector<T> copy_each_first(const std::vector<std::pair<T, _>>& items)
     return result;
 }
 
-} // namespace
-
-VariantCallFilter::CallBlock
-VariantCallFilter::read_next_block(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const
+template <typename Iterator>
+std::vector<VcfRecord> read_phased_block(Iterator& first, const Iterator& last, const std::vector<SampleName>& samples)
 {
     std::vector<std::pair<VcfRecord, GenomicRegion>> block {};
     for (; first != last; ++first) {
@@ -210,6 +257,21 @@ VariantCallFilter::read_next_block(VcfIterator& first, const VcfIterator& last,
     return copy_each_first(block);
 }
 
+} // namespace
+
+VariantCallFilter::CallBlock
+VariantCallFilter::read_next_block(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const
+{
+    return read_phased_block(first, last, samples);
+}
+
+VariantCallFilter::CallBlock
+VariantCallFilter::read_next_block(std::deque<VcfRecord>::const_iterator& first, const std::deque<VcfRecord>::const_iterator last,
+                                   const SampleList& samples) const
+{
+    return read_phased_block(first, last, samples);
+}
+
 std::vector<VariantCallFilter::CallBlock>
 VariantCallFilter::read_next_blocks(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const
 {
@@ -293,13 +355,24 @@ void VariantCallFilter::write(const VcfRecord& call, const Classification& class
                               VcfWriter& dest) const
 {
     if (!is_hard_filtered(classification)) {
-        auto filtered_call = construct_template(call);
-        annotate(filtered_call, classification);
-        annotate(filtered_call, samples, sample_classifications);
-        dest << filtered_call.build_once();
+        dest << make_filtered_call(call, classification, samples, sample_classifications);
     }
 }
 
+VcfRecord VariantCallFilter::make_filtered_call(const VcfRecord& call, const Classification& classification,
+                                                const SampleList& samples, const ClassificationList& sample_classifications) const
+{
+    auto result = construct_template(call);
+    annotate(result, classification);
+    annotate(result, samples, sample_classifications);
+    return result.build_once();
+}
+
+bool VariantCallFilter::is_hard_filtered(const Classification& classification) const noexcept
+{
+    return classification.category == Classification::Category::hard_filtered;
+}
+
 bool VariantCallFilter::measure_annotations_requested() const noexcept
 {
     return output_config_.annotate_all_active_measures || !output_config_.annotations.empty();
@@ -321,6 +394,19 @@ void VariantCallFilter::annotate(VcfRecord::Builder& call, const MeasureVector&
 
 // private methods
 
+class InMemoryFilteringNotSupported : public ProgramError
+{
+    std::string do_where() const override { return "VariantCallFilter::filter"; }
+    std::string do_why() const override { return "This filter cannot classify calls independently"; }
+};
+
+boost::optional<VcfRecord>
+VariantCallFilter::filter(const VcfRecord& call, const MeasureVector& measures,
+                          const VcfHeader& dest_header, const SampleList& samples) const
+{
+    throw InMemoryFilteringNotSupported {};
+}
+
 boost::optional<Phred<double>>
 VariantCallFilter::compute_joint_quality(const ClassificationList& sample_classifications, const MeasureVector& measures) const
 {
@@ -386,22 +472,7 @@ std::vector<std::string> VariantCallFilter::compute_reason_union(const Classific
 
 VcfHeader VariantCallFilter::make_header(const VcfReader& source) const
 {
-    VcfHeader::Builder builder {source.fetch_header()};
-    if (output_config_.clear_info) {
-        builder.clear_info();
-    }
-    if (measure_annotations_requested()) {
-        for (const auto& measure : measures_) {
-            if (is_requested_annotation(measure)) {
-                measure.annotate(builder);
-            }
-        }
-    }
-    if (output_config_.emit_sites_only) {
-        builder.clear_format();
-    }
-    annotate(builder);
-    return builder.build_once();
+    return make_header(source.fetch_header());
 }
 
 VcfRecord::Builder VariantCallFilter::construct_template(const VcfRecord& call) const
@@ -422,11 +493,6 @@ bool VariantCallFilter::is_requested_annotation(const MeasureWrapper& measure) c
     return output_config_.annotate_all_active_measures || output_config_.annotations.count(measure.name()) == 1;
 }
 
-bool VariantCallFilter::is_hard_filtered(const Classification& classification) const noexcept
-{
-    return classification.category == Classification::Category::hard_filtered;
-}
-
 void VariantCallFilter::annotate(VcfRecord::Builder& call, const SampleList& samples, const ClassificationList& sample_classifications) const
 {
     assert(samples.size() == sample_classifications.size());
@@ -503,6 +569,12 @@ Measure::FacetMap VariantCallFilter::compute_facets(const CallBlock& block) cons
     return make_map(facet_names_, facet_factory_.make(facet_names_, block));
 }
 
+Measure::FacetMap VariantCallFilter::compute_facets(const CallBlock& block, const ReadMap& reads,
+                                                     const std::vector<SavedHaplotypeLikelihoods>* likelihoods) const
+{
+    return make_map(facet_names_, facet_factory_.make(facet_names_, block, reads, likelihoods));
+}
+
 std::vector<Measure::FacetMap> VariantCallFilter::compute_facets(const std::vector<CallBlock>& blocks) const
 {
     auto facets = facet_factory_.make(facet_names_, blocks, workers_);
@@ -519,33 +591,34 @@ VariantCallFilter::MeasureBlock VariantCallFilter::measure(const CallBlock& bloc
     if (debug_log_ && !block.empty()) {
         stream(*debug_log_) << "Measuring block " << encompassing_region(block) << " containing " << block.size() << " calls";
     }
-    MeasureBlock result(block.size());
-    std::transform(std::cbegin(block), std::cend(block), std::begin(result),
-                   [&] (const VcfRecord& call) { return this->measure(call, facets); });
-    return result;
-}
-
-VariantCallFilter::MeasureVector VariantCallFilter::measure(const VcfRecord& call, const Measure::FacetMap& facets) const
-{
-    MeasureVector result(measures_.size());
+    // Each measure is evaluated over the whole block, then the measure columns are transposed into call rows
+    std::vector<Measure::ResultColumn> columns {};
+    columns.reserve(measures_.size());
     if (duplicate_measures_.empty()) {
-        std::transform(std::cbegin(measures_), std::cend(measures_), std::begin(result),
-                       [&] (const MeasureWrapper& m) { return m(call, facets); });
+        for (const auto& m : measures_) {
+            columns.push_back(m(block, facets));
+        }
     } else {
-        std::unordered_map<MeasureWrapper, Measure::ResultType> result_buffer {};
-        result_buffer.reserve(duplicate_measures_.size());
+        std::unordered_map<MeasureWrapper, Measure::ResultColumn> column_buffer {};
+        column_buffer.reserve(duplicate_measures_.size());
         for (const auto& m : duplicate_measures_) {
-            result_buffer.emplace(m, m(call, facets));
+            column_buffer.emplace(m, m(block, facets));
         }
-        std::transform(std::cbegin(measures_), std::cend(measures_), std::begin(result),
-                       [&] (const MeasureWrapper& m) -> Measure::ResultType {
-                           auto itr = result_buffer.find(m);
-                           if (itr != std::cend(result_buffer)) {
-                               return itr->second;
-                           } else {
-                               return m(call, facets);
-                           }
-                       });
+        for (const auto& m : measures_) {
+            auto itr = column_buffer.find(m);
+            if (itr != std::cend(column_buffer)) {
+                columns.push_back(itr->second);
+            } else {
+                columns.push_back(m(block, facets));
+            }
+        }
+    }
+    MeasureBlock result(block.size());
+    for (auto& call_measures : result) {
+        call_measures.reserve(columns.size());
+    }
+    for (auto& column : columns) {
+        append_to_rows(std::move(column), result);
     }
     return result;
 }
@@ -5,6 +5,7 @@
 #define variant_call_filter_hpp
 
 #include <vector>
+#include <deque>
 #include <string>
 #include <cstddef>
 #include <type_traits>
@@ -69,6 +70,16 @@ public:
     
     void filter(const VcfReader& source, VcfWriter& dest) const;
     
+    // Filters that classify each call from its own measures can filter calls as they are made, with the
+    // reads used to call them, rather than in a second pass over the calls and reads.
+    // If the haplotype likelihoods computed by the caller are given then read assignments are made
+    // from them rather than recomputed.
+    bool can_filter_in_memory() const noexcept;
+    bool uses_read_assignments() const noexcept;
+    VcfHeader make_header(const VcfHeader& source_header) const;
+    std::deque<VcfRecord> filter(const std::deque<VcfRecord>& calls, const ReadMap& reads, const VcfHeader& dest_header,
+                                 const std::vector<SavedHaplotypeLikelihoods>* likelihoods = nullptr) const;
+    
 protected:
     using SampleList    = std::vector<SampleName>;
     using MeasureVector = std::vector<Measure::ResultType>;
@@ -86,6 +97,7 @@ protected:
     
     std::vector<MeasureWrapper> measures_;
     mutable boost::optional<logging::DebugLogger> debug_log_;
+    mutable ThreadPool workers_;
     
     virtual Classification merge(const ClassificationList& sample_classifications, const MeasureVector& measures) const;
     virtual Classification merge(const ClassificationList& sample_classifications) const;
@@ -93,6 +105,8 @@ protected:
     bool can_measure_single_call() const noexcept;
     bool can_measure_multiple_blocks() const noexcept;
     CallBlock read_next_block(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const;
+    CallBlock read_next_block(std::deque<VcfRecord>::const_iterator& first, std::deque<VcfRecord>::const_iterator last,
+                              const SampleList& samples) const;
     std::vector<CallBlock> read_next_blocks(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const;
     MeasureVector measure(const VcfRecord& call) const;
     MeasureBlock measure(const CallBlock& block) const;
@@ -101,6 +115,9 @@ protected:
     void write(const VcfRecord& call, const Classification& classification,
                const SampleList& samples, const ClassificationList& sample_classifications,
                VcfWriter& dest) const;
+    VcfRecord make_filtered_call(const VcfRecord& call, const Classification& classification,
+                                 const SampleList& samples, const ClassificationList& sample_classifications) const;
+    bool is_hard_filtered(const Classification& classification) const noexcept;
     bool measure_annotations_requested() const noexcept;
     void annotate(VcfRecord::Builder& call, const MeasureVector& measures, const VcfHeader& header) const;
     Phred<double> compute_joint_probability(const std::vector<Phred<double>>& qualities) const;
@@ -114,11 +131,12 @@ private:
     OutputOptions output_config_;
     std::vector<MeasureWrapper> duplicate_measures_;
     
-    mutable ThreadPool workers_;
-    
     virtual std::string do_name() const = 0;
     virtual void annotate(VcfHeader::Builder& header) const = 0;
     virtual void filter(const VcfReader& source, VcfWriter& dest, const VcfHeader& dest_header) const = 0;
+    virtual bool do_can_filter_in_memory() const noexcept { return false; }
+    virtual boost::optional<VcfRecord> filter(const VcfRecord& call, const MeasureVector& measures,
+                                              const VcfHeader& dest_header, const SampleList& samples) const;
     virtual boost::optional<std::string> call_quality_name() const { return boost::none; }
     virtual boost::optional<std::string> genotype_quality_name() const { return boost::none; }
     virtual boost::optional<Phred<double>> compute_joint_quality(const ClassificationList& sample_classifications, const MeasureVector& measures) const;
@@ -127,12 +145,12 @@ private:
     
     VcfHeader make_header(const VcfReader& source) const;
     Measure::FacetMap compute_facets(const CallBlock& block) const;
+    Measure::FacetMap compute_facets(const CallBlock& block, const ReadMap& reads,
+                                     const std::vector<SavedHaplotypeLikelihoods>* likelihoods) const;
     std::vector<Measure::FacetMap> compute_facets(const std::vector<CallBlock>& blocks) const;
     MeasureBlock measure(const CallBlock& block, const Measure::FacetMap& facets) const;
-    MeasureVector measure(const VcfRecord& call, const Measure::FacetMap& facets) const;
     VcfRecord::Builder construct_template(const VcfRecord& call) const;
     bool is_requested_annotation(const MeasureWrapper& measure) const noexcept;
-    bool is_hard_filtered(const Classification& classification) const noexcept;
     void annotate(VcfRecord::Builder& call, const SampleList& samples, const ClassificationList& sample_classifications) const;
     void annotate(VcfRecord::Builder& call, const SampleName& sample, Classification status) const;
     void annotate(VcfRecord::Builder& call, Classification status) const;
@@ -3,6 +3,10 @@
 
 #include "depth.hpp"
 
+#include <iterator>
+#include <algorithm>
+#include <cassert>
+
 #include <boost/variant.hpp>
 
 #include "io/variant/vcf_record.hpp"
@@ -53,6 +57,42 @@ Measure::ResultType Depth::do_evaluate(const VcfRecord& call, const FacetMap& fa
     }
 }
 
+Measure::ResultColumn Depth::do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    if (aggregate_) {
+        return evaluate_combined(calls, facets);
+    } else {
+        std::vector<ResultType> result {};
+        result.reserve(calls.size());
+        for (const auto& call : calls) {
+            result.push_back(do_evaluate(call, facets));
+        }
+        return result;
+    }
+}
+
+std::vector<std::size_t> Depth::evaluate_combined(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    assert(aggregate_);
+    std::vector<std::size_t> result(calls.size());
+    if (recalculate_) {
+        const auto& reads = get_value<OverlappingReads>(facets.at("OverlappingReads"));
+        std::transform(std::cbegin(calls), std::cend(calls), std::begin(result),
+                       [&reads] (const VcfRecord& call) { return count_overlapped(reads, call); });
+    } else {
+        std::transform(std::cbegin(calls), std::cend(calls), std::begin(result), [] (const VcfRecord& call) {
+            return std::stoull(call.info_value(vcfspec::info::combinedReadDepth).front());
+        });
+    }
+    return result;
+}
+
+std::size_t Depth::evaluate_combined(const VcfRecord& call, const FacetMap& facets) const
+{
+    assert(aggregate_);
+    return boost::get<std::size_t>(do_evaluate(call, facets));
+}
+
 Measure::ResultCardinality Depth::do_cardinality() const noexcept
 {
     if (aggregate_) {
@@ -21,6 +21,7 @@ class Depth : public Measure
     bool recalculate_ = false, aggregate_ = false;
     std::unique_ptr<Measure> do_clone() const override;
     ResultType do_evaluate(const VcfRecord& call, const FacetMap& facets) const override;
+    ResultColumn do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const override;
     ResultCardinality do_cardinality() const noexcept override;
     const std::string& do_name() const override;
     std::string do_describe() const override;
@@ -29,6 +30,10 @@ class Depth : public Measure
 public:
     Depth();
     Depth(bool recalculate, bool aggregate_samples);
+    
+    // The combined depth of each call, for measures derived from depth. Samples must be aggregated.
+    std::vector<std::size_t> evaluate_combined(const std::vector<VcfRecord>& calls, const FacetMap& facets) const;
+    std::size_t evaluate_combined(const VcfRecord& call, const FacetMap& facets) const;
 };
 
 } // namespace csr
@@ -24,6 +24,16 @@ void Measure::do_set_parameters(std::vector<std::string> params)
     }
 }
 
+Measure::ResultColumn Measure::do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    std::vector<ResultType> result {};
+    result.reserve(calls.size());
+    for (const auto& call : calls) {
+        result.push_back(do_evaluate(call, facets));
+    }
+    return result;
+}
+
 struct MeasureSerialiseVisitor : boost::static_visitor<>
 {
     std::string str;
@@ -154,6 +164,24 @@ bool is_missing(const Measure::ResultType& value) noexcept
     return boost::apply_visitor(IsMissingMeasureVisitor {}, value);
 }
 
+struct ColumnRowAppenderVisitor : public boost::static_visitor<>
+{
+    ColumnRowAppenderVisitor(std::vector<std::vector<Measure::ResultType>>& rows) : rows {rows} {}
+    template <typename T> void operator()(std::vector<T>& column) const
+    {
+        assert(column.size() == rows.size());
+        for (std::size_t i {0}; i < column.size(); ++i) {
+            rows[i].emplace_back(std::move(column[i]));
+        }
+    }
+    std::vector<std::vector<Measure::ResultType>>& rows;
+};
+
+void append_to_rows(Measure::ResultColumn&& column, std::vector<std::vector<Measure::ResultType>>& rows)
+{
+    boost::apply_visitor(ColumnRowAppenderVisitor {rows}, column);
+}
+
 std::vector<std::string> get_all_requirements(const std::vector<MeasureWrapper>& measures)
 {
     std::vector<std::string> result {};
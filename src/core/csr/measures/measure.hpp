@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
 #include <memory>
 #include <utility>
 #include <unordered_map>
@@ -35,6 +36,10 @@ public:
                                       bool,
                                       std::vector<bool>,
                                       boost::any>;
+    // Results for a block of calls. Measures with a single result type can return a typed column.
+    using ResultColumn = boost::variant<std::vector<ResultType>,
+                                        std::vector<boost::optional<double>>,
+                                        std::vector<std::size_t>>;
     enum class ResultCardinality { one, num_alleles, num_samples };
     
     Measure() = default;
@@ -51,6 +56,7 @@ public:
     void set_parameters(std::vector<std::string> params) { do_set_parameters(std::move(params)); }
     std::vector<std::string> parameters() const { return do_parameters(); }
     ResultType evaluate(const VcfRecord& call, const FacetMap& facets) const { return do_evaluate(call, facets); }
+    ResultColumn evaluate(const std::vector<VcfRecord>& calls, const FacetMap& facets) const { return do_evaluate_column(calls, facets); }
     ResultCardinality cardinality() const noexcept { return do_cardinality(); }
     const std::string& name() const { return do_name(); }
     std::string describe() const { return do_describe(); }
@@ -68,6 +74,7 @@ private:
     virtual void do_set_parameters(std::vector<std::string> params);
     virtual std::vector<std::string> do_parameters() const { return {}; }
     virtual ResultType do_evaluate(const VcfRecord& call, const FacetMap& facets) const = 0;
+    virtual ResultColumn do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const;
     virtual ResultCardinality do_cardinality() const noexcept = 0;
     virtual const std::string& do_name() const = 0;
     virtual std::string do_describe() const = 0;
@@ -101,6 +108,7 @@ public:
     std::vector<std::string> parameters() const { return measure_->parameters(); }
     auto operator()(const VcfRecord& call) const { return measure_->evaluate(call, {}); }
     auto operator()(const VcfRecord& call, const Measure::FacetMap& facets) const { return measure_->evaluate(call, facets); }
+    auto operator()(const std::vector<VcfRecord>& calls, const Measure::FacetMap& facets) const { return measure_->evaluate(calls, facets); }
     Measure::ResultCardinality cardinality() const noexcept { return measure_->cardinality(); }
     const std::string& name() const { return measure_->name(); }
     std::string describe() const { return measure_->describe(); }
@@ -163,6 +171,9 @@ std::string long_name(const MeasureWrapper& measure);
 
 bool is_missing(const Measure::ResultType& value) noexcept;
 
+// Moves the i'th value of the column onto the end of the i'th row
+void append_to_rows(Measure::ResultColumn&& column, std::vector<std::vector<Measure::ResultType>>& rows);
+
 std::vector<std::string> get_all_requirements(const std::vector<MeasureWrapper>& measures);
 
 Measure::ResultType get_sample_value(const Measure::ResultType& value, const MeasureWrapper& measure, std::size_t sample_idx);
@@ -33,6 +33,23 @@ Measure::ResultType PosteriorProbabilityByDepth::do_evaluate(const VcfRecord& ca
     return result;
 }
 
+Measure::ResultColumn PosteriorProbabilityByDepth::do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    const PosteriorProbability posterior_probability_measure {};
+    std::vector<boost::optional<double>> result(calls.size());
+    for (std::size_t i {0}; i < calls.size(); ++i) {
+        const auto posterior_probability = boost::get<boost::optional<double>>(posterior_probability_measure.evaluate(calls[i], facets));
+        // Depth is only needed, and so only computed, for calls with a posterior
+        if (posterior_probability) {
+            const auto depth = depth_.evaluate_combined(calls[i], facets);
+            if (depth > 0) {
+                result[i] = *posterior_probability / depth;
+            }
+        }
+    }
+    return result;
+}
+
 Measure::ResultCardinality PosteriorProbabilityByDepth::do_cardinality() const noexcept
 {
     return depth_.cardinality();
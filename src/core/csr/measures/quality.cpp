@@ -23,6 +23,15 @@ Measure::ResultType Quality::do_evaluate(const VcfRecord& call, const FacetMap&
     return result;
 }
 
+Measure::ResultColumn Quality::do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    std::vector<boost::optional<double>> result(calls.size());
+    for (std::size_t i {0}; i < calls.size(); ++i) {
+        if (calls[i].qual()) result[i] = static_cast<double>(*calls[i].qual());
+    }
+    return result;
+}
+
 Measure::ResultCardinality Quality::do_cardinality() const noexcept
 {
     return ResultCardinality::one;
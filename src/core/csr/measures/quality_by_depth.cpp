@@ -3,6 +3,9 @@
 
 #include "quality_by_depth.hpp"
 
+#include <iterator>
+#include <algorithm>
+
 #include <boost/variant.hpp>
 #include <boost/optional.hpp>
 
@@ -29,6 +32,23 @@ Measure::ResultType QualityByDepth::do_evaluate(const VcfRecord& call, const Fac
     return result;
 }
 
+Measure::ResultColumn QualityByDepth::do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    const auto depths = depth_.evaluate_combined(calls, facets);
+    std::vector<double> qualities(calls.size());
+    std::transform(std::cbegin(calls), std::cend(calls), std::begin(qualities),
+                   [] (const VcfRecord& call) { return static_cast<double>(*call.qual()); });
+    // Divide first, without branches, so the loop can be vectorised
+    std::vector<double> ratios(calls.size());
+    std::transform(std::cbegin(qualities), std::cend(qualities), std::cbegin(depths), std::begin(ratios),
+                   [] (double quality, std::size_t depth) { return quality / std::max(depth, std::size_t {1}); });
+    std::vector<boost::optional<double>> result(calls.size());
+    for (std::size_t i {0}; i < calls.size(); ++i) {
+        if (depths[i] > 0) result[i] = ratios[i];
+    }
+    return result;
+}
+
 Measure::ResultCardinality QualityByDepth::do_cardinality() const noexcept
 {
     return depth_.cardinality();
@@ -22,6 +22,7 @@ class QualityByDepth : public Measure
     Depth depth_;
     std::unique_ptr<Measure> do_clone() const override;
     ResultType do_evaluate(const VcfRecord& call, const FacetMap& facets) const override;
+    ResultColumn do_evaluate_column(const std::vector<VcfRecord>& calls, const FacetMap& facets) const override;
     ResultCardinality do_cardinality() const noexcept override;
     const std::string& do_name() const override;
     std::string do_describe() const override;
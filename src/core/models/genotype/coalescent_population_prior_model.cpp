@@ -15,15 +15,13 @@ CoalescentPopulationPriorModel::CoalescentPopulationPriorModel(CoalescentModel s
 , genotype_model_ {std::move(genotype_model)}
 {}
 
-template <typename T>
-auto sum_sizes(const std::vector<std::vector<T>>& values) noexcept
+auto sum_sizes(const std::vector<GenotypeIndex>& values) noexcept
 {
     return std::accumulate(std::cbegin(values), std::cend(values), std::size_t {0},
                            [] (auto curr, const auto& v) noexcept { return curr + v.size(); });
 }
 
-template <typename T>
-auto sum_sizes(const std::vector<std::reference_wrapper<const std::vector<T>>>& values) noexcept
+auto sum_sizes(const std::vector<std::reference_wrapper<const GenotypeIndex>>& values) noexcept
 {
     return std::accumulate(std::cbegin(values), std::cend(values), std::size_t {0},
                            [] (auto curr, const auto& v) noexcept { return curr + v.get().size(); });
@@ -42,7 +42,7 @@ private:
     CoalescentModel segregation_model_;
     HardyWeinbergModel genotype_model_;
     
-    mutable std::vector<unsigned> index_buffer_;
+    mutable GenotypeIndex index_buffer_;
     
     LogProbability do_evaluate(const std::vector<Genotype<Haplotype>>& genotypes) const override
     {
@@ -77,7 +77,7 @@ private:
     LogProbability evaluate_helper(const Range& genotypes) const;
     template <typename Range>
     LogProbability evaluate_segregation_model(const Range& genotypes) const;
-    LogProbability evaluate_segregation_model(const std::vector<std::vector<unsigned>>& indices) const;
+    LogProbability evaluate_segregation_model(const std::vector<GenotypeIndex>& indices) const;
     LogProbability evaluate_segregation_model(const std::vector<GenotypeIndiceVectorReference>& indices) const;
 };
 
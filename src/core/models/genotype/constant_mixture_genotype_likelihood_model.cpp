@@ -6,9 +6,6 @@
 #include <cmath>
 #include <iterator>
 #include <algorithm>
-#include <numeric>
-#include <array>
-#include <limits>
 #include <cassert>
 
 #include "utils/maths.hpp"
@@ -53,230 +50,108 @@ bool ConstantMixtureGenotypeLikelihoodModel::is_primed() const noexcept
 
 // ln p(read | genotype)  = ln sum {haplotype in genotype} p(read | haplotype) - ln ploidy
 // ln p(reads | genotype) = sum {read in reads} ln p(read | genotype)
+//
+// Equal haplotypes are merged into one mixture component of weight count / ploidy, so the number of
+// exp and log evaluations per read depends on the zygosity rather than the ploidy, and homozygous
+// genotypes need none. The batch kernel is specialised for up to four components.
+
+constexpr std::size_t ConstantMixtureGenotypeLikelihoodModel::readBlockSize;
+
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
 ConstantMixtureGenotypeLikelihoodModel::evaluate(const Genotype<Haplotype>& genotype) const
 {
     assert(likelihoods_.is_primed());
-    // These cases are just for optimisation
-    switch (genotype.ploidy()) {
-        case 0:
-            return 0.0;
-        case 1:
-            return evaluate_haploid(genotype);
-        case 2:
-            return evaluate_diploid(genotype);
-        case 3:
-            return evaluate_triploid(genotype);
-        case 4:
-            return evaluate_polyploid(genotype);
-            //return log_likelihood_tetraploid(sample, genotype);
-        default:
-            return evaluate_polyploid(genotype);
-    }
-}
-
-namespace {
-
-template <typename T = double>
-static constexpr auto ln(const unsigned n)
-{
-    constexpr std::array<T, 11> lnLookup {
-    std::numeric_limits<T>::infinity(),
-    0.0,
-    0.693147180559945309417232121458176568075500134360255254120,
-    1.098612288668109691395245236922525704647490557822749451734,
-    1.386294361119890618834464242916353136151000268720510508241,
-    1.609437912434100374600759333226187639525601354268517721912,
-    1.791759469228055000812477358380702272722990692183004705855,
-    1.945910149055313305105352743443179729637084729581861188459,
-    2.079441541679835928251696364374529704226500403080765762362,
-    2.197224577336219382790490473845051409294981115645498903469,
-    2.302585092994045684017991454684364207601101488628772976033
-    };
-    return lnLookup[n];
+    if (genotype.ploidy() == 0) return 0.0;
+    set_mixture(genotype);
+    const auto num_likelihoods = likelihoods_[genotype[0]].size();
+    return maths::sum_log_sum_exp(mixture_likelihoods_.data(), mixture_log_weights_.data(),
+                                  mixture_likelihoods_.size(), num_likelihoods);
 }
 
-} // namespace
-
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
 ConstantMixtureGenotypeLikelihoodModel::evaluate(const GenotypeIndex& genotype) const
 {
     assert(is_primed());
-    switch (genotype.size()) {
-        case 0:
-            return 0.0;
-        case 1:
-            return evaluate_haploid(genotype);
-        case 2:
-            return evaluate_diploid(genotype);
-        default:
-            return evaluate_polyploid(genotype);
-    }
-}
-
-// private methods
-
-ConstantMixtureGenotypeLikelihoodModel::LogProbability
-ConstantMixtureGenotypeLikelihoodModel::evaluate_haploid(const Genotype<Haplotype>& genotype) const
-{
-    const auto& log_likelihoods = likelihoods_[genotype[0]];
-    return std::accumulate(std::cbegin(log_likelihoods), std::cend(log_likelihoods), LogProbability {0});
-}
-
-ConstantMixtureGenotypeLikelihoodModel::LogProbability
-ConstantMixtureGenotypeLikelihoodModel::evaluate_diploid(const Genotype<Haplotype>& genotype) const
-{
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
-    if (genotype.is_homozygous()) {
-        return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
-    }
-    const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-    return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                              std::cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                              [] (const auto a, const auto b) -> LogProbability {
-                                  return maths::log_sum_exp(a, b) - ln<decltype(a)>(2);
-                              });
+    if (genotype.empty()) return 0.0;
+    set_mixture(genotype);
+    const auto num_likelihoods = indexed_likelihoods_.front().get().size();
+    return maths::sum_log_sum_exp(mixture_likelihoods_.data(), mixture_log_weights_.data(),
+                                  mixture_likelihoods_.size(), num_likelihoods);
 }
 
-ConstantMixtureGenotypeLikelihoodModel::LogProbability
-ConstantMixtureGenotypeLikelihoodModel::evaluate_triploid(const Genotype<Haplotype>& genotype) const
+std::vector<ConstantMixtureGenotypeLikelihoodModel::LogProbability>
+ConstantMixtureGenotypeLikelihoodModel::evaluate(const std::vector<GenotypeIndex>& genotypes) const
 {
-    using std::cbegin; using std::cend;
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
-    if (genotype.is_homozygous()) {
-        return std::accumulate(cbegin(log_likelihoods1), cend(log_likelihoods1), LogProbability {0});
-    }
-    if (genotype.zygosity() == 3) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-        return maths::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                                    cbegin(log_likelihoods2), cbegin(log_likelihoods3),
-                                    LogProbability {0}, std::plus<> {},
-                                    [] (const auto a, const auto b, const auto c) -> LogProbability {
-                                        return maths::log_sum_exp(a, b, c) - ln<decltype(a)>(3);
-                                    });
+    assert(is_primed());
+    std::vector<LogProbability> result(genotypes.size(), 0.0);
+    // Flatten the mixture of every genotype, so genotype g has components [offsets[g], offsets[g + 1])
+    std::vector<LikelihoodPointer> likelihoods {};
+    std::vector<LogProbability> log_weights {};
+    std::vector<std::size_t> offsets {0};
+    offsets.reserve(genotypes.size() + 1);
+    for (const auto& genotype : genotypes) {
+        set_mixture(genotype);
+        likelihoods.insert(std::cend(likelihoods), std::cbegin(mixture_likelihoods_), std::cend(mixture_likelihoods_));
+        log_weights.insert(std::cend(log_weights), std::cbegin(mixture_log_weights_), std::cend(mixture_log_weights_));
+        offsets.push_back(likelihoods.size());
     }
-    if (genotype[0] != genotype[1]) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        return std::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                                  cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                                  [] (const auto a, const auto b) -> LogProbability {
-                                      return maths::log_sum_exp(a, ln<decltype(a)>(2) + b) - ln<decltype(a)>(3);
-                                  });
+    const auto num_likelihoods = indexed_likelihoods_.front().get().size();
+    std::vector<LikelihoodPointer> block_likelihoods {};
+    for (std::size_t first_read {0}; first_read < num_likelihoods; first_read += readBlockSize) {
+        const auto num_block_reads = std::min(readBlockSize, num_likelihoods - first_read);
+        for (std::size_t g {0}; g < genotypes.size(); ++g) {
+            const auto num_components = offsets[g + 1] - offsets[g];
+            block_likelihoods.resize(num_components);
+            std::transform(std::next(std::cbegin(likelihoods), offsets[g]), std::next(std::cbegin(likelihoods), offsets[g + 1]),
+                           std::begin(block_likelihoods), [=] (auto component) { return component + first_read; });
+            result[g] += maths::sum_log_sum_exp(block_likelihoods.data(), log_weights.data() + offsets[g],
+                                                num_components, num_block_reads);
+        }
     }
-    const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-    return std::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                              cbegin(log_likelihoods3), LogProbability {0}, std::plus<> {},
-                              [] (const auto a, const auto b) -> LogProbability {
-                                  return maths::log_sum_exp(ln<decltype(a)>(2) + a, b) - ln<decltype(a)>(3);
-                              });
+    return result;
 }
 
-ConstantMixtureGenotypeLikelihoodModel::LogProbability
-ConstantMixtureGenotypeLikelihoodModel::evaluate_tetraploid(const Genotype<Haplotype>& genotype) const
+// private methods
+
+void ConstantMixtureGenotypeLikelihoodModel::add_mixture_component(const HaplotypeLikelihoodArray::LikelihoodVector& likelihoods) const
 {
-    const auto z = genotype.zygosity();
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
-    if (z == 1) {
-        return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
-    }
-    if (z == 4) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-        const auto& log_likelihoods4 = likelihoods_[genotype[3]];
-        return maths::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                                    std::cbegin(log_likelihoods2), std::cbegin(log_likelihoods3),
-                                    std::cbegin(log_likelihoods4), LogProbability {0}, std::plus<> {},
-                                    [] (const auto a, const auto b, const auto c, const auto d) -> LogProbability {
-                                        return maths::log_sum_exp({a, b, c, d}) - ln<decltype(a)>(4);
-                                    });
+    // Genotypes are small, so a linear search beats hashing
+    const auto itr = std::find(std::cbegin(mixture_likelihoods_), std::cend(mixture_likelihoods_), likelihoods.data());
+    if (itr != std::cend(mixture_likelihoods_)) {
+        ++mixture_log_weights_[std::distance(std::cbegin(mixture_likelihoods_), itr)];
+    } else {
+        mixture_likelihoods_.push_back(likelihoods.data());
+        mixture_log_weights_.push_back(1);
     }
-    
-    // TODO
-    
-    return 0;
 }
 
-ConstantMixtureGenotypeLikelihoodModel::LogProbability
-ConstantMixtureGenotypeLikelihoodModel::evaluate_polyploid(const Genotype<Haplotype>& genotype) const
+void ConstantMixtureGenotypeLikelihoodModel::set_mixture_log_weights(const unsigned ploidy) const
 {
-    const auto ploidy = genotype.ploidy();
     const auto ln_ploidy = std::log(ploidy);
-    const auto z = genotype.zygosity();
-    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
-    if (z == 1) {
-        return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
-    }
-    if (z == 2) {
-        const auto unique_haplotypes = genotype.copy_unique_ref();
-        const auto& log_likelihoods2 = likelihoods_[unique_haplotypes.back()];
-        const auto lnpm1 = static_cast<HaplotypeLikelihoodArray::LogProbability>(std::log(ploidy - 1));
-        if (genotype.count(unique_haplotypes.front()) == 1) {
-            return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                                      std::cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                                      [=] (const auto a, const auto b) -> LogProbability {
-                                          return maths::log_sum_exp(a, lnpm1 + b) - ln_ploidy;
-                                      });
-        }
-        return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                                  std::cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                                  [=] (const auto a, const auto b) -> LogProbability {
-                                      return maths::log_sum_exp(lnpm1 + a, b) - ln_ploidy;
-                                  });
-    }
-    likelihood_refs_.reserve(ploidy);
-    likelihood_refs_.push_back(log_likelihoods1);
-    std::transform(std::next(std::cbegin(genotype)), std::cend(genotype), std::back_inserter(likelihood_refs_),
-                   [this] (const auto& haplotype) -> const HaplotypeLikelihoodArray::LikelihoodVector& {
-                       return likelihoods_[haplotype]; });
-    LogProbability result {0};
-    const auto num_likelihoods = likelihood_refs_.front().get().size();
-    buffer_.resize(ploidy);
-    for (std::size_t read_idx {0}; read_idx < num_likelihoods; ++read_idx) {
-        std::transform(std::cbegin(likelihood_refs_), std::cend(likelihood_refs_), std::begin(buffer_),
-                       [read_idx] (const auto& likelihoods) noexcept { return likelihoods.get()[read_idx]; });
-        result += maths::log_sum_exp(buffer_) - ln_ploidy;
-    }
-    likelihood_refs_.clear();
-    return result;
+    for (auto& weight : mixture_log_weights_) weight = std::log(weight) - ln_ploidy;
 }
 
-ConstantMixtureGenotypeLikelihoodModel::LogProbability
-ConstantMixtureGenotypeLikelihoodModel::evaluate_haploid(const GenotypeIndex& genotype) const
+void ConstantMixtureGenotypeLikelihoodModel::set_mixture(const Genotype<Haplotype>& genotype) const
 {
-    const auto& log_likelihoods = indexed_likelihoods_[genotype[0]].get();
-    return std::accumulate(std::cbegin(log_likelihoods), std::cend(log_likelihoods), LogProbability {0});
+    mixture_likelihoods_.clear();
+    mixture_log_weights_.clear();
+    for (const auto& haplotype : genotype) add_mixture_component(likelihoods_[haplotype]);
+    set_mixture_log_weights(genotype.ploidy());
 }
 
-ConstantMixtureGenotypeLikelihoodModel::LogProbability
-ConstantMixtureGenotypeLikelihoodModel::evaluate_diploid(const GenotypeIndex& genotype) const
+void ConstantMixtureGenotypeLikelihoodModel::set_mixture(const GenotypeIndex& genotype) const
 {
-    const auto& log_likelihoods1 = indexed_likelihoods_[genotype[0]].get();
-    if (genotype[0] == genotype[1]) { // if homozygous
-        return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
-    } else {
-        const auto& log_likelihoods2 = indexed_likelihoods_[genotype[1]].get();
-        return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                                  std::cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                                  [] (const auto a, const auto b) -> LogProbability {
-                                      return maths::log_sum_exp(a, b) - ln<decltype(a)>(2);
-                                  });
-    }
+    mixture_likelihoods_.clear();
+    mixture_log_weights_.clear();
+    for (const auto haplotype_idx : genotype) add_mixture_component(indexed_likelihoods_[haplotype_idx].get());
+    set_mixture_log_weights(static_cast<unsigned>(genotype.size()));
 }
 
-ConstantMixtureGenotypeLikelihoodModel::LogProbability 
-ConstantMixtureGenotypeLikelihoodModel::evaluate_polyploid(const GenotypeIndex& genotype) const
+std::vector<ConstantMixtureGenotypeLikelihoodModel::LogProbability>&
+evaluate(const std::vector<GenotypeIndex>& genotypes, const ConstantMixtureGenotypeLikelihoodModel& model,
+         std::vector<ConstantMixtureGenotypeLikelihoodModel::LogProbability>& result)
 {
-    const auto ploidy = static_cast<unsigned>(genotype.size());
-    const auto ln_ploidy = std::log(ploidy);
-    buffer_.resize(ploidy);
-    LogProbability result {0};
-    const auto num_likelihoods = indexed_likelihoods_.front().get().size();
-    for (std::size_t read_idx {0}; read_idx < num_likelihoods; ++read_idx) {
-        std::transform(std::cbegin(genotype), std::cend(genotype), std::begin(buffer_),
-                       [=] (auto haplotype_idx) noexcept { return indexed_likelihoods_[haplotype_idx].get()[read_idx]; });
-        result += maths::log_sum_exp(buffer_) - ln_ploidy;
-    }
+    result = model.evaluate(genotypes);
     return result;
 }
 
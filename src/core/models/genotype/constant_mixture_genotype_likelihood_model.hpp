@@ -5,6 +5,7 @@
 #define constant_mixture_genotype_likelihood_model_hpp
 
 #include <vector>
+#include <cstddef>
 
 #include "core/types/haplotype.hpp"
 #include "core/types/genotype.hpp"
@@ -39,24 +40,32 @@ public:
     LogProbability evaluate(const Genotype<Haplotype>& genotype) const;
     LogProbability evaluate(const GenotypeIndex& genotype) const;
     
+    // Evaluates genotypes together, a block of reads at a time, so the likelihoods of haplotypes
+    // shared by many genotypes are loaded from cache rather than memory
+    std::vector<LogProbability> evaluate(const std::vector<GenotypeIndex>& genotypes) const;
+    
 private:
+    using LikelihoodPointer = const HaplotypeLikelihoodArray::LogProbability*;
+    
+    // Reads per block in batched evaluation
+    static constexpr std::size_t readBlockSize {256};
+    
     const HaplotypeLikelihoodArray& likelihoods_;
     std::vector<HaplotypeLikelihoodArray::LikelihoodVectorRef> indexed_likelihoods_;
-    mutable std::vector<HaplotypeLikelihoodArray::LikelihoodVectorRef> likelihood_refs_;
-    mutable std::vector<HaplotypeLikelihoodArray::LogProbability> buffer_;
+    // The distinct haplotypes of the genotype being evaluated and their log mixture weights
+    mutable std::vector<LikelihoodPointer> mixture_likelihoods_;
+    mutable std::vector<LogProbability> mixture_log_weights_;
     
-    // These are just for optimisation
-    LogProbability evaluate_haploid(const Genotype<Haplotype>& genotype) const;
-    LogProbability evaluate_diploid(const Genotype<Haplotype>& genotype) const;
-    LogProbability evaluate_triploid(const Genotype<Haplotype>& genotype) const;
-    LogProbability evaluate_tetraploid(const Genotype<Haplotype>& genotype) const;
-    LogProbability evaluate_polyploid(const Genotype<Haplotype>& genotype) const;
-    
-    LogProbability evaluate_haploid(const GenotypeIndex& genotype) const;
-    LogProbability evaluate_diploid(const GenotypeIndex& genotype) const;
-    LogProbability evaluate_polyploid(const GenotypeIndex& genotype) const;
+    void add_mixture_component(const HaplotypeLikelihoodArray::LikelihoodVector& likelihoods) const;
+    void set_mixture_log_weights(unsigned ploidy) const;
+    void set_mixture(const Genotype<Haplotype>& genotype) const;
+    void set_mixture(const GenotypeIndex& genotype) const;
 };
 
+std::vector<ConstantMixtureGenotypeLikelihoodModel::LogProbability>&
+evaluate(const std::vector<GenotypeIndex>& genotypes, const ConstantMixtureGenotypeLikelihoodModel& model,
+         std::vector<ConstantMixtureGenotypeLikelihoodModel::LogProbability>& result);
+
 template <typename Container1, typename Container2>
 Container2&
 evaluate(const Container1& genotypes, const ConstantMixtureGenotypeLikelihoodModel& model, Container2& result)
@@ -3,6 +3,8 @@
 
 #include "independent_population_model.hpp"
 
+#include <cassert>
+
 namespace octopus { namespace model {
 
 IndependentPopulationModel::IndependentPopulationModel(const GenotypePriorModel& genotype_prior_model,
@@ -11,6 +13,21 @@ IndependentPopulationModel::IndependentPopulationModel(const GenotypePriorModel&
 : individual_model_ {genotype_prior_model, debug_log, trace_log}
 {}
 
+void IndependentPopulationModel::prime(const MappableBlock<Haplotype>& haplotypes)
+{
+    individual_model_.prime(haplotypes);
+}
+
+void IndependentPopulationModel::unprime() noexcept
+{
+    individual_model_.unprime();
+}
+
+bool IndependentPopulationModel::is_primed() const noexcept
+{
+    return individual_model_.is_primed();
+}
+
 IndependentPopulationModel::InferredLatents
 IndependentPopulationModel::evaluate(const SampleVector& samples,
                                      const GenotypeVector& genotypes,
@@ -27,6 +44,23 @@ IndependentPopulationModel::evaluate(const SampleVector& samples,
     return result;
 }
 
+IndependentPopulationModel::InferredLatents
+IndependentPopulationModel::evaluate(const SampleVector& samples,
+                                     const std::vector<GenotypeIndex>& genotypes,
+                                     const HaplotypeLikelihoodArray& haplotype_likelihoods) const
+{
+    assert(is_primed());
+    InferredLatents result {};
+    result.posteriors.genotype_probabilities.reserve(samples.size());
+    for (const auto& sample : samples) {
+        haplotype_likelihoods.prime(sample);
+        auto sample_results = individual_model_.evaluate(genotypes, haplotype_likelihoods);
+        result.posteriors.genotype_probabilities.push_back(std::move(sample_results.posteriors.genotype_probabilities));
+        result.log_evidence += sample_results.log_evidence;
+    }
+    return result;
+}
+
 IndependentPopulationModel::InferredLatents
 IndependentPopulationModel::evaluate(const SampleVector& samples,
                                      const std::vector<unsigned>& sample_ploidies,
@@ -53,11 +53,20 @@ public:
     
     ~IndependentPopulationModel() = default;
     
+    void prime(const MappableBlock<Haplotype>& haplotypes);
+    void unprime() noexcept;
+    bool is_primed() const noexcept;
+    
     // All samples have same ploidy
     InferredLatents
     evaluate(const SampleVector& samples,
              const GenotypeVector& genotypes,
              const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
+    // All samples have same ploidy. Requires the model to be primed with the haplotypes the indices refer to.
+    InferredLatents
+    evaluate(const SampleVector& samples,
+             const std::vector<GenotypeIndex>& genotypes,
+             const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     
     // Samples have different ploidy
     InferredLatents
@@ -56,12 +56,22 @@ void log_genotype_likelihoods(boost::optional<logging::DebugLogger>& debug_log,
                               boost::optional<logging::TraceLogger>& trace_log,
                               const std::vector<Genotype<Haplotype>>& genotypes,
                               const std::vector<LogProbability>& likelihoods);
+template <typename LogProbability>
+void log_genotype_likelihoods(boost::optional<logging::DebugLogger>& debug_log,
+                              boost::optional<logging::TraceLogger>& trace_log,
+                              const MappableBlock<Haplotype>& haplotypes,
+                              const std::vector<GenotypeIndex>& genotypes,
+                              const std::vector<LogProbability>& likelihoods);
 template <typename S, typename LogProbability>
 void print_genotype_likelihoods(S&& stream, const std::vector<Genotype<Haplotype>>& genotypes,
                                 const std::vector<LogProbability>& likelihoods, std::size_t n = 5);
 template <typename LogProbability>
 void print_genotype_likelihoods(const std::vector<Genotype<Haplotype>>& genotypes,
                                 const std::vector<LogProbability>& likelihoods, std::size_t n = 5);
+template <typename S, typename LogProbability>
+void print_genotype_likelihoods(S&& stream, const MappableBlock<Haplotype>& haplotypes,
+                                const std::vector<GenotypeIndex>& genotypes,
+                                const std::vector<LogProbability>& likelihoods, std::size_t n = 5);
 
 } // namespace debug
 
@@ -102,6 +112,24 @@ IndividualModel::evaluate(const MappableBlock<Genotype<Haplotype>>& genotypes,
     return result;
 }
 
+IndividualModel::InferredLatents
+IndividualModel::evaluate(const std::vector<GenotypeIndex>& genotypes,
+                          const HaplotypeLikelihoodArray& haplotype_likelihoods) const
+{
+    assert(!genotypes.empty());
+    assert(is_primed());
+    ConstantMixtureGenotypeLikelihoodModel likelihood_model {haplotype_likelihoods};
+    likelihood_model.prime(*haplotypes_);
+    InferredLatents result {};
+    result.posteriors.genotype_log_probabilities = octopus::model::evaluate(genotypes, likelihood_model);
+    debug::log_genotype_likelihoods(debug_log_, trace_log_, *haplotypes_, genotypes, result.posteriors.genotype_log_probabilities);
+    octopus::evaluate(genotypes, genotype_prior_model_, result.posteriors.genotype_log_probabilities, false, true);
+    result.log_evidence = maths::normalise_logs(result.posteriors.genotype_log_probabilities);
+    result.posteriors.genotype_probabilities = result.posteriors.genotype_log_probabilities;
+    maths::exp_each(result.posteriors.genotype_probabilities);
+    return result;
+}
+
 namespace debug {
 
 using octopus::debug::print_variant_alleles;
@@ -190,6 +218,47 @@ void print_genotype_likelihoods(const std::vector<Genotype<Haplotype>>& genotype
     print_genotype_likelihoods(std::cout, genotypes, likelihoods, n);
 }
 
+template <typename LogProbability>
+void log_genotype_likelihoods(boost::optional<logging::DebugLogger>& debug_log,
+                              boost::optional<logging::TraceLogger>& trace_log,
+                              const MappableBlock<Haplotype>& haplotypes,
+                              const std::vector<GenotypeIndex>& genotypes,
+                              const std::vector<LogProbability>& likelihoods)
+{
+    if (debug_log) debug::print_genotype_likelihoods(stream(*debug_log), haplotypes, genotypes, likelihoods);
+    if (trace_log) debug::print_genotype_likelihoods(stream(*trace_log), haplotypes, genotypes, likelihoods, genotypes.size());
+}
+
+template <typename S, typename LogProbability>
+void print_genotype_likelihoods(S&& stream, const MappableBlock<Haplotype>& haplotypes,
+                                const std::vector<GenotypeIndex>& genotypes,
+                                const std::vector<LogProbability>& likelihoods, std::size_t n)
+{
+    assert(genotypes.size() == likelihoods.size());
+    const auto m = std::min(n, genotypes.size());
+    if (m == genotypes.size()) {
+        stream << "Printing all genotype likelihoods " << '\n';
+    } else {
+        stream << "Printing top " << m << " genotype likelihoods " << '\n';
+    }
+    std::vector<std::pair<std::size_t, LogProbability>> v {};
+    v.reserve(genotypes.size());
+    for (std::size_t i {0}; i < genotypes.size(); ++i) {
+        v.emplace_back(i, likelihoods[i]);
+    }
+    const auto mth = std::next(std::begin(v), m);
+    std::partial_sort(std::begin(v), mth, std::end(v),
+                      [] (const auto& lhs, const auto& rhs) {
+                          return lhs.second > rhs.second;
+                      });
+    // Only the printed genotypes are materialised
+    std::for_each(std::begin(v), mth,
+                  [&] (const auto& p) {
+                      print_variant_alleles(stream, make_genotype(haplotypes, genotypes[p.first]));
+                      stream << " " << p.second << '\n';
+                  });
+}
+
 } // namespace debug
 } // namesapce model
 } // namespace octopus
@@ -62,6 +62,11 @@ public:
              const std::vector<GenotypeIndex>& genotype_indices,
              const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     
+    // Requires the model to be primed with the haplotypes the indices refer to
+    InferredLatents
+    evaluate(const std::vector<GenotypeIndex>& genotypes,
+             const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
+    
 private:
     const GenotypePriorModel& genotype_prior_model_;
     const MappableBlock<Haplotype>* haplotypes_;
@@ -44,12 +44,14 @@ using LogProbability = double;
 using GenotypeLogLikelihoodVector  = std::vector<LogProbability>;
 using GenotypeLogLikelihoodMatrix  = std::vector<GenotypeLogLikelihoodVector>;
 
+template <typename GenotypeType>
 struct GenotypeLogProbability
 {
-    const Genotype<Haplotype>& genotype;
+    const GenotypeType& genotype;
     double log_probability;
 };
-using GenotypeLogMarginalVector = std::vector<GenotypeLogProbability>;
+template <typename GenotypeType>
+using GenotypeLogMarginalVector = std::vector<GenotypeLogProbability<GenotypeType>>;
 
 using GenotypeMarginalPosteriorVector  = std::vector<double>;
 using GenotypeMarginalPosteriorMatrix  = std::vector<GenotypeMarginalPosteriorVector>; // for each sample
@@ -129,16 +131,6 @@ struct ModelConstants
     , frequency_update_norm {calculate_frequency_update_norm(genotype_log_likilhoods.size(), genotypes.front().ploidy())}
     , genotypes_containing_haplotypes {make_inverse_genotype_table(haplotypes, genotypes)}
     {}
-    ModelConstants(const MappableBlock<Haplotype>& haplotypes,
-                   const PopulationModel::GenotypeVector& genotypes,
-                   const std::vector<GenotypeIndex>& genotype_indices,
-                   const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods)
-    : haplotypes {haplotypes}
-    , genotypes {genotypes}
-    , genotype_log_likilhoods {genotype_log_likilhoods}
-    , frequency_update_norm {calculate_frequency_update_norm(genotype_log_likilhoods.size(), genotypes.front().ploidy())}
-    , genotypes_containing_haplotypes {make_inverse_genotype_table(genotype_indices, haplotypes.size())}
-    {}
     ModelConstants(const MappableBlock<Haplotype>& haplotypes,
                    const PopulationModel::GenotypeVector& genotypes,
                    const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods,
@@ -151,6 +143,25 @@ struct ModelConstants
     {}
 };
 
+struct IndexModelConstants
+{
+    const std::size_t num_haplotypes;
+    const std::vector<GenotypeIndex>& genotypes;
+    const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods;
+    const double frequency_update_norm;
+    const InverseGenotypeTable genotypes_containing_haplotypes;
+    
+    IndexModelConstants(const std::size_t num_haplotypes,
+                        const std::vector<GenotypeIndex>& genotypes,
+                        const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods)
+    : num_haplotypes {num_haplotypes}
+    , genotypes {genotypes}
+    , genotype_log_likilhoods {genotype_log_likilhoods}
+    , frequency_update_norm {calculate_frequency_update_norm(genotype_log_likilhoods.size(), static_cast<unsigned>(genotypes.front().size()))}
+    , genotypes_containing_haplotypes {make_inverse_genotype_table(genotypes, num_haplotypes)}
+    {}
+};
+
 HardyWeinbergModel make_hardy_weinberg_model(const ModelConstants& constants)
 {
     HardyWeinbergModel::HaplotypeFrequencyMap frequencies {constants.haplotypes.size()};
@@ -160,6 +171,12 @@ HardyWeinbergModel make_hardy_weinberg_model(const ModelConstants& constants)
     return HardyWeinbergModel {std::move(frequencies)};
 }
 
+HardyWeinbergModel make_hardy_weinberg_model(const IndexModelConstants& constants)
+{
+    HardyWeinbergModel::HaplotypeFrequencyVector frequencies(constants.num_haplotypes, 1.0 / constants.num_haplotypes);
+    return HardyWeinbergModel {std::move(frequencies)};
+}
+
 GenotypeLogLikelihoodMatrix
 compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
                                  const PopulationModel::GenotypeVector& genotypes,
@@ -182,6 +199,25 @@ compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
     return result;
 }
 
+GenotypeLogLikelihoodMatrix
+compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
+                                 const std::vector<GenotypeIndex>& genotype_indices,
+                                 const MappableBlock<Haplotype>& haplotypes,
+                                 const HaplotypeLikelihoodArray& haplotype_likelihoods)
+{
+    assert(!genotype_indices.empty());
+    ConstantMixtureGenotypeLikelihoodModel likelihood_model {haplotype_likelihoods};
+    GenotypeLogLikelihoodMatrix result {};
+    result.reserve(samples.size());
+    for (const auto& sample : samples) {
+        haplotype_likelihoods.prime(sample);
+        likelihood_model.prime(haplotypes);
+        result.push_back(likelihood_model.evaluate(genotype_indices));
+        likelihood_model.unprime();
+    }
+    return result;
+}
+
 GenotypeLogLikelihoodMatrix
 compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
                                  const PopulationModel::GenotypeVector& genotypes,
@@ -205,11 +241,10 @@ compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
     return result;
 }
 
-GenotypeLogMarginalVector
-init_genotype_log_marginals(const PopulationModel::GenotypeVector& genotypes,
-                            const HardyWeinbergModel& hw_model)
+template <typename Range>
+auto init_genotype_log_marginals(const Range& genotypes, const HardyWeinbergModel& hw_model)
 {
-    GenotypeLogMarginalVector result {};
+    GenotypeLogMarginalVector<typename Range::value_type> result {};
     result.reserve(genotypes.size());
     for (const auto& genotype : genotypes) {
         result.push_back({genotype, hw_model.evaluate(genotype)});
@@ -217,15 +252,17 @@ init_genotype_log_marginals(const PopulationModel::GenotypeVector& genotypes,
     return result;
 }
 
-void update_genotype_log_marginals(GenotypeLogMarginalVector& current_log_marginals,
+template <typename GenotypeType>
+void update_genotype_log_marginals(GenotypeLogMarginalVector<GenotypeType>& current_log_marginals,
                                    const HardyWeinbergModel& hw_model)
 {
     std::for_each(std::begin(current_log_marginals), std::end(current_log_marginals),
                   [&hw_model] (auto& p) { p.log_probability = hw_model.evaluate(p.genotype); });
 }
 
+template <typename GenotypeType>
 GenotypeMarginalPosteriorMatrix
-init_genotype_posteriors(const GenotypeLogMarginalVector& genotype_log_marginals,
+init_genotype_posteriors(const GenotypeLogMarginalVector<GenotypeType>& genotype_log_marginals,
                          const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods)
 {
     GenotypeMarginalPosteriorMatrix result {};
@@ -243,8 +280,9 @@ init_genotype_posteriors(const GenotypeLogMarginalVector& genotype_log_marginals
     return result;
 }
 
+template <typename GenotypeType>
 void update_genotype_posteriors(GenotypeMarginalPosteriorMatrix& current_genotype_posteriors,
-                                const GenotypeLogMarginalVector& genotype_log_marginals,
+                                const GenotypeLogMarginalVector<GenotypeType>& genotype_log_marginals,
                                 const GenotypeLogLikelihoodMatrix& genotype_log_likilhoods)
 {
     auto likelihood_itr = std::cbegin(genotype_log_likilhoods);
@@ -269,50 +307,72 @@ auto collapse_genotype_posteriors(const GenotypeMarginalPosteriorMatrix& genotyp
     return result;
 }
 
-double update_haplotype_frequencies(const MappableBlock<Haplotype>& haplotypes,
-                                    HardyWeinbergModel& hw_model,
+// Returns the absolute change
+double update_haplotype_frequency(double& current_frequency,
+                                  const std::vector<double>& collaped_posteriors,
+                                  const std::vector<std::size_t>& genotypes_containing_haplotype,
+                                  const double frequency_update_norm)
+{
+    double new_frequency {0};
+    for (const auto& genotype_index : genotypes_containing_haplotype) {
+        new_frequency += collaped_posteriors[genotype_index];
+    }
+    new_frequency /= frequency_update_norm;
+    const auto frequency_change = std::abs(current_frequency - new_frequency);
+    current_frequency = new_frequency;
+    return frequency_change;
+}
+
+double update_haplotype_frequencies(HardyWeinbergModel& hw_model,
                                     const GenotypeMarginalPosteriorMatrix& genotype_posteriors,
-                                    const InverseGenotypeTable& genotypes_containing_haplotypes,
-                                    const double frequency_update_norm)
+                                    const ModelConstants& constants)
 {
     const auto collaped_posteriors = collapse_genotype_posteriors(genotype_posteriors);
     double max_frequency_change {0};
     auto& current_haplotype_frequencies = hw_model.frequencies();
-    for (std::size_t i {0}; i < haplotypes.size(); ++i) {
-        auto& current_frequency = current_haplotype_frequencies.at(haplotypes[i]);
-        double new_frequency {0};
-        for (const auto& genotype_index : genotypes_containing_haplotypes[i]) {
-            new_frequency += collaped_posteriors[genotype_index];
-        }
-        new_frequency /= frequency_update_norm;
-        const auto frequency_change = std::abs(current_frequency - new_frequency);
-        if (frequency_change > max_frequency_change) {
-            max_frequency_change = frequency_change;
-        }
-        current_frequency = new_frequency;
+    for (std::size_t i {0}; i < constants.haplotypes.size(); ++i) {
+        auto& current_frequency = current_haplotype_frequencies.at(constants.haplotypes[i]);
+        const auto frequency_change = update_haplotype_frequency(current_frequency, collaped_posteriors,
+                                                                 constants.genotypes_containing_haplotypes[i],
+                                                                 constants.frequency_update_norm);
+        max_frequency_change = std::max(frequency_change, max_frequency_change);
     }
     return max_frequency_change;
 }
 
+double update_haplotype_frequencies(HardyWeinbergModel& hw_model,
+                                    const GenotypeMarginalPosteriorMatrix& genotype_posteriors,
+                                    const IndexModelConstants& constants)
+{
+    const auto collaped_posteriors = collapse_genotype_posteriors(genotype_posteriors);
+    double max_frequency_change {0};
+    auto& current_haplotype_frequencies = hw_model.index_frequencies();
+    for (std::size_t i {0}; i < constants.num_haplotypes; ++i) {
+        const auto frequency_change = update_haplotype_frequency(current_haplotype_frequencies[i], collaped_posteriors,
+                                                                 constants.genotypes_containing_haplotypes[i],
+                                                                 constants.frequency_update_norm);
+        max_frequency_change = std::max(frequency_change, max_frequency_change);
+    }
+    return max_frequency_change;
+}
+
+template <typename Constants, typename GenotypeType>
 double do_em_iteration(GenotypeMarginalPosteriorMatrix& genotype_posteriors,
                        HardyWeinbergModel& hw_model,
-                       GenotypeLogMarginalVector& genotype_log_marginals,
-                       const ModelConstants& constants)
-{
-    const auto max_change = update_haplotype_frequencies(constants.haplotypes,
-                                                         hw_model,
-                                                         genotype_posteriors,
-                                                         constants.genotypes_containing_haplotypes,
-                                                         constants.frequency_update_norm);
+                       GenotypeLogMarginalVector<GenotypeType>& genotype_log_marginals,
+                       const Constants& constants)
+{
+    const auto max_change = update_haplotype_frequencies(hw_model, genotype_posteriors, constants);
     update_genotype_log_marginals(genotype_log_marginals, hw_model);
     update_genotype_posteriors(genotype_posteriors, genotype_log_marginals, constants.genotype_log_likilhoods);
     return max_change;
 }
 
+template <typename Constants, typename GenotypeType>
 void run_em(GenotypeMarginalPosteriorMatrix& genotype_posteriors,
             HardyWeinbergModel& hw_model,
-            GenotypeLogMarginalVector& genotype_log_marginals,
-            const ModelConstants& constants, const EMOptions options,
+            GenotypeLogMarginalVector<GenotypeType>& genotype_log_marginals,
+            const Constants& constants, const EMOptions options,
             boost::optional<logging::TraceLogger> trace_log = boost::none)
 {
     for (unsigned n {1}; n <= options.max_iterations; ++n) {
@@ -321,14 +381,12 @@ void run_em(GenotypeMarginalPosteriorMatrix& genotype_posteriors,
     }
 }
 
-auto compute_approx_genotype_marginal_posteriors(const MappableBlock<Haplotype>& haplotypes,
-                                                 const PopulationModel::GenotypeVector& genotypes,
-                                                 const GenotypeLogLikelihoodMatrix& genotype_likelihoods,
-                                                 const ModelConstants& constants, const EMOptions options)
+template <typename Constants>
+auto compute_approx_genotype_marginal_posteriors(const Constants& constants, const EMOptions options)
 {
     auto hw_model = make_hardy_weinberg_model(constants);
-    auto genotype_log_marginals = init_genotype_log_marginals(genotypes, hw_model);
-    auto result = init_genotype_posteriors(genotype_log_marginals, genotype_likelihoods);
+    auto genotype_log_marginals = init_genotype_log_marginals(constants.genotypes, hw_model);
+    auto result = init_genotype_posteriors(genotype_log_marginals, constants.genotype_log_likilhoods);
     run_em(result, hw_model, genotype_log_marginals, constants, options);
     return result;
 }
@@ -339,17 +397,16 @@ auto compute_approx_genotype_marginal_posteriors(const MappableBlock<Haplotype>&
                                                  const EMOptions options)
 {
     const ModelConstants constants {haplotypes, genotypes, genotype_likelihoods};
-    return compute_approx_genotype_marginal_posteriors(haplotypes, genotypes, genotype_likelihoods, constants, options);
+    return compute_approx_genotype_marginal_posteriors(constants, options);
 }
 
-auto compute_approx_genotype_marginal_posteriors(const MappableBlock<Haplotype>& haplotypes,
-                                                 const PopulationModel::GenotypeVector& genotypes,
-                                                 const std::vector<GenotypeIndex>& genotype_indices,
+auto compute_approx_genotype_marginal_posteriors(const std::size_t num_haplotypes,
+                                                 const std::vector<GenotypeIndex>& genotypes,
                                                  const GenotypeLogLikelihoodMatrix& genotype_likelihoods,
                                                  const EMOptions options)
 {
-    const ModelConstants constants {haplotypes, genotypes, genotype_indices, genotype_likelihoods};
-    return compute_approx_genotype_marginal_posteriors(haplotypes, genotypes, genotype_likelihoods, constants, options);
+    const IndexModelConstants constants {num_haplotypes, genotypes, genotype_likelihoods};
+    return compute_approx_genotype_marginal_posteriors(constants, options);
 }
 
 auto compute_approx_genotype_marginal_posteriors(const PopulationModel::GenotypeVector& genotypes,
@@ -498,6 +555,24 @@ boost::optional<std::size_t> find_hom_ref_idx(const Range& genotypes)
     }
 }
 
+boost::optional<std::size_t> find_hom_ref_idx(const std::vector<GenotypeIndex>& genotypes,
+                                               const MappableBlock<Haplotype>& haplotypes)
+{
+    const auto ref_itr = std::find_if(std::cbegin(haplotypes), std::cend(haplotypes),
+                                      [] (const Haplotype& haplotype) { return is_reference(haplotype); });
+    if (ref_itr == std::cend(haplotypes)) return boost::none;
+    const auto ref_idx = static_cast<std::size_t>(std::distance(std::cbegin(haplotypes), ref_itr));
+    auto itr = std::find_if(std::cbegin(genotypes), std::cend(genotypes),
+                            [ref_idx] (const auto& g) {
+                                return std::all_of(std::cbegin(g), std::cend(g), [ref_idx] (auto idx) { return idx == ref_idx; });
+                            });
+    if (itr != std::cend(genotypes)) {
+        return std::distance(std::cbegin(genotypes), itr);
+    } else {
+        return boost::none;
+    }
+}
+
 template <typename T>
 auto zip_index(const std::vector<T>& v)
 {
@@ -509,12 +584,12 @@ auto zip_index(const std::vector<T>& v)
 }
 
 std::vector<unsigned>
-select_top_k_genotypes(const PopulationModel::GenotypeVector& genotypes,
+select_top_k_genotypes(const std::size_t num_genotypes,
                        const GenotypeMarginalPosteriorMatrix& em_genotype_marginals,
                        const std::size_t k)
 {
-    if (genotypes.size() <= k) {
-        std::vector<unsigned> result(genotypes.size());
+    if (num_genotypes <= k) {
+        std::vector<unsigned> result(num_genotypes);
         std::iota(std::begin(result), std::end(result), 0);
         return result;
     } else {
@@ -525,7 +600,7 @@ select_top_k_genotypes(const PopulationModel::GenotypeVector& genotypes,
             std::nth_element(std::begin(tmp), std::next(std::begin(tmp), k), std::end(tmp), std::greater<> {});
             indexed_marginals.push_back(std::move(tmp));
         }
-        std::vector<unsigned> result {}, top(genotypes.size(), 0u);
+        std::vector<unsigned> result {}, top(num_genotypes, 0u);
         result.reserve(k);
         for (std::size_t j {0}; j <= k; ++j) {
             for (const auto& marginals : indexed_marginals) {
@@ -547,17 +622,18 @@ select_top_k_genotypes(const PopulationModel::GenotypeVector& genotypes,
     }
 }
 
-auto propose_joint_genotypes(const PopulationModel::GenotypeVector& genotypes,
+auto propose_joint_genotypes(const std::size_t num_genotypes,
+                             const boost::optional<std::size_t> hom_ref_idx,
                              const GenotypeMarginalPosteriorMatrix& em_genotype_marginals,
                              const std::size_t max_genotype_combinations)
 {
     const auto num_samples = em_genotype_marginals.size();
-    const auto max_possible_genotype_combinations = compute_num_combinations(genotypes.size(), num_samples);
+    const auto max_possible_genotype_combinations = compute_num_combinations(num_genotypes, num_samples);
     if (max_possible_genotype_combinations && *max_possible_genotype_combinations <= max_genotype_combinations) {
-        return generate_all_genotype_combinations(genotypes.size(), num_samples);
+        return generate_all_genotype_combinations(num_genotypes, num_samples);
     }
     auto result = select_top_k_tuples(em_genotype_marginals, max_genotype_combinations);
-    const auto top_k_genotype_indices = select_top_k_genotypes(genotypes, em_genotype_marginals, num_samples / 2);
+    const auto top_k_genotype_indices = select_top_k_genotypes(num_genotypes, em_genotype_marginals, num_samples / 2);
     for (const auto genotype_idx : top_k_genotype_indices) {
         for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
             if (result.front()[sample_idx] != genotype_idx) {
@@ -569,7 +645,6 @@ auto propose_joint_genotypes(const PopulationModel::GenotypeVector& genotypes,
             }
         }
     }
-    const auto hom_ref_idx = find_hom_ref_idx(genotypes);
     if (hom_ref_idx) {
         std::vector<std::size_t> ref_indices(num_samples, *hom_ref_idx);
         if (std::find(std::cbegin(result), std::cend(result), ref_indices) == std::cend(result)) {
@@ -689,7 +764,8 @@ PopulationModel::evaluate(const SampleVector& samples,
         const auto max_genotype_combinations = options_.max_joint_genotypes ? *options_.max_joint_genotypes : *num_possible_joint_genotypes;
         const EMOptions em_options {options_.max_em_iterations, options_.em_epsilon};
         const auto em_genotype_marginals = compute_approx_genotype_marginal_posteriors(genotypes, genotype_log_likelihoods, em_options);
-        const auto joint_genotypes = propose_joint_genotypes(genotypes, em_genotype_marginals, max_genotype_combinations);
+        const auto hom_ref_idx = find_hom_ref_idx(genotypes);
+        const auto joint_genotypes = propose_joint_genotypes(genotypes.size(), hom_ref_idx, em_genotype_marginals, max_genotype_combinations);
         calculate_posterior_marginals(genotypes, joint_genotypes, genotype_log_likelihoods, prior_model_, result);
     }
     return result;
@@ -697,13 +773,12 @@ PopulationModel::evaluate(const SampleVector& samples,
 
 PopulationModel::InferredLatents
 PopulationModel::evaluate(const SampleVector& samples,
-                          const GenotypeVector& genotypes,
-                          const std::vector<GenotypeIndex>& genotype_indices,
-                          const std::vector<Haplotype>& haplotypes,
+                          const std::vector<GenotypeIndex>& genotypes,
+                          const MappableBlock<Haplotype>& haplotypes,
                           const HaplotypeLikelihoodArray& haplotype_likelihoods) const
 {
     assert(!genotypes.empty());
-    const auto genotype_log_likelihoods = compute_genotype_log_likelihoods(samples, genotypes, haplotype_likelihoods);
+    const auto genotype_log_likelihoods = compute_genotype_log_likelihoods(samples, genotypes, haplotypes, haplotype_likelihoods);
     const auto num_possible_joint_genotypes = compute_num_combinations(genotypes.size(), samples.size());
     InferredLatents result;
     if (!options_.max_joint_genotypes || (num_possible_joint_genotypes && *num_possible_joint_genotypes <= *options_.max_joint_genotypes)) {
@@ -712,10 +787,11 @@ PopulationModel::evaluate(const SampleVector& samples,
     } else {
         const auto max_genotype_combinations = options_.max_joint_genotypes ? *options_.max_joint_genotypes : *num_possible_joint_genotypes;
         const EMOptions em_options {options_.max_em_iterations, options_.em_epsilon};
-        const auto em_genotype_marginals = compute_approx_genotype_marginal_posteriors(haplotypes, genotypes, genotype_indices,
+        const auto em_genotype_marginals = compute_approx_genotype_marginal_posteriors(haplotypes.size(), genotypes,
                                                                                        genotype_log_likelihoods, em_options);
-        const auto joint_genotypes = propose_joint_genotypes(genotypes, em_genotype_marginals, max_genotype_combinations);
-        calculate_posterior_marginals(genotype_indices, joint_genotypes, genotype_log_likelihoods, prior_model_, result);
+        const auto hom_ref_idx = find_hom_ref_idx(genotypes, haplotypes);
+        const auto joint_genotypes = propose_joint_genotypes(genotypes.size(), hom_ref_idx, em_genotype_marginals, max_genotype_combinations);
+        calculate_posterior_marginals(genotypes, joint_genotypes, genotype_log_likelihoods, prior_model_, result);
     }
     return result;
 }
@@ -794,7 +870,8 @@ PopulationModel::evaluate(const SampleVector& samples,
         const auto max_genotype_combinations = options_.max_joint_genotypes ? *options_.max_joint_genotypes : *num_possible_joint_genotypes;
         const EMOptions em_options {options_.max_em_iterations, options_.em_epsilon};
         const auto em_genotype_marginals = compute_approx_genotype_marginal_posteriors(genotypes, genotype_log_likelihoods, sample_ploidies, em_options);
-        const auto joint_genotypes = propose_joint_genotypes(genotypes, em_genotype_marginals, max_genotype_combinations);
+        const auto hom_ref_idx = find_hom_ref_idx(genotypes);
+        const auto joint_genotypes = propose_joint_genotypes(genotypes.size(), hom_ref_idx, em_genotype_marginals, max_genotype_combinations);
         calculate_posterior_marginals(genotypes, joint_genotypes, genotype_log_likelihoods, prior_model_, result);
     }
     return result;
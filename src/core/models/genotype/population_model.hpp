@@ -66,12 +66,11 @@ public:
     evaluate(const SampleVector& samples,
              const GenotypeVector& genotypes,
              const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
-    // All samples have same ploidy
+    // All samples have same ploidy. The prior model must be primed with the haplotypes the indices refer to.
     InferredLatents
     evaluate(const SampleVector& samples,
-             const GenotypeVector& genotypes,
-             const std::vector<GenotypeIndex>& genotype_indices,
-             const std::vector<Haplotype>& haplotypes,
+             const std::vector<GenotypeIndex>& genotypes,
+             const MappableBlock<Haplotype>& haplotypes,
              const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     // Samples have different ploidy
     InferredLatents
@@ -19,7 +19,7 @@ public:
     using LogProbability = double;
     using HaplotypeBlock = MappableBlock<Haplotype>;
     using GenotypeReference = std::reference_wrapper<const Genotype<Haplotype>>;
-    using GenotypeIndiceVectorReference = std::reference_wrapper<const std::vector<unsigned>>;
+    using GenotypeIndiceVectorReference = std::reference_wrapper<const GenotypeIndex>;
     
     PopulationPriorModel() = default;
     
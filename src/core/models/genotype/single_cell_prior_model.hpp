@@ -24,7 +24,7 @@ public:
     using CellPhylogeny = Phylogeny<std::size_t>;
     
     using GenotypeReference = std::reference_wrapper<const Genotype<Haplotype>>;
-    using GenotypeIndiceVectorReference = std::reference_wrapper<const std::vector<unsigned>>;
+    using GenotypeIndiceVectorReference = std::reference_wrapper<const GenotypeIndex>;
     
     struct Parameters
     {
@@ -314,15 +314,10 @@ run_variational_bayes_helper(const std::vector<SampleName>& samples,
                              std::vector<LogProbabilityVector>&& seeds)
 {
     VariationalBayesParameters vb_params {params.epsilon, params.max_iterations};
-    if (params.target_max_memory) {
-        const auto estimated_memory_default = estimate_memory_requirement<K>(samples, haplotype_log_likelihoods, genotypes.size(), vb_params);
-        if (estimated_memory_default > *params.target_max_memory) {
-            vb_params.save_memory = true;
-        }
-    }
     if (params.execution_policy == ExecutionPolicy::par) {
         vb_params.parallel_execution = true;
     }
+    vb_params.target_max_memory = params.target_max_memory;
     const auto vb_prior_alphas = flatten<K, G, GI, GPM>(prior_alphas, samples);
     const auto log_likelihoods = flatten<K>(genotypes, samples, haplotype_log_likelihoods);
     auto vb_results = octopus::model::run_variational_bayes(vb_prior_alphas, genotype_log_priors, log_likelihoods, vb_params, std::move(seeds));
@@ -0,0 +1,229 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "top_genotype_enumeration.hpp"
+
+#include <queue>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <cmath>
+
+#include "utils/maths.hpp"
+
+namespace octopus { namespace model {
+
+namespace {
+
+using LogProbability = double;
+
+struct PartialGenotype
+{
+    LogProbability bound;
+    GenotypeIndex ranks;
+};
+
+struct PartialGenotypeLess
+{
+    bool operator()(const PartialGenotype& lhs, const PartialGenotype& rhs) const noexcept
+    {
+        // Break ties towards the lexicographically smaller ranks so enumeration is deterministic
+        return lhs.bound < rhs.bound || (lhs.bound == rhs.bound && rhs.ranks < lhs.ranks);
+    }
+};
+
+double log_num_genotypes(const std::size_t num_haplotypes, const unsigned ploidy, const bool max_zygosity) noexcept
+{
+    const double n = max_zygosity ? num_haplotypes : num_haplotypes + ploidy - 1;
+    return std::lgamma(n + 1) - std::lgamma(ploidy + 1.0) - std::lgamma(n - ploidy + 1);
+}
+
+// Read likelihoods indexed by haplotype rank, i.e. position in decreasing marginal likelihood order,
+// and scaled by the best haplotype for each read so they can be summed without underflow
+class RankedReadLikelihoods
+{
+public:
+    RankedReadLikelihoods(const MappableBlock<Haplotype>& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods);
+
+    std::size_t num_haplotypes() const noexcept { return order_.size(); }
+    std::size_t num_reads() const noexcept { return num_reads_; }
+    unsigned haplotype(const unsigned rank) const noexcept { return order_[rank]; }
+    LogProbability log_scale() const noexcept { return log_scale_; }
+    // exp(ln p(read | haplotype) - max_h ln p(read | h))
+    const double* scaled(const unsigned rank) const noexcept { return scaled_.data() + rank * num_reads_; }
+    // max of scaled over ranks >= rank, or zero if rank == num_haplotypes
+    const double* suffix_max(const unsigned rank) const noexcept { return suffix_max_.data() + rank * num_reads_; }
+
+private:
+    std::vector<unsigned> order_;
+    std::size_t num_reads_;
+    LogProbability log_scale_;
+    std::vector<double> scaled_, suffix_max_;
+};
+
+RankedReadLikelihoods::RankedReadLikelihoods(const MappableBlock<Haplotype>& haplotypes,
+                                             const HaplotypeLikelihoodArray& haplotype_likelihoods)
+: order_(haplotypes.size())
+, num_reads_ {haplotype_likelihoods[haplotypes.front()].size()}
+, log_scale_ {0}
+, scaled_(haplotypes.size() * num_reads_)
+, suffix_max_((haplotypes.size() + 1) * num_reads_, 0.0)
+{
+    std::vector<std::reference_wrapper<const HaplotypeLikelihoodArray::LikelihoodVector>> likelihoods {};
+    likelihoods.reserve(haplotypes.size());
+    for (const auto& haplotype : haplotypes) {
+        likelihoods.emplace_back(haplotype_likelihoods[haplotype]);
+    }
+    std::vector<LogProbability> marginals(haplotypes.size());
+    std::transform(std::cbegin(likelihoods), std::cend(likelihoods), std::begin(marginals),
+                   [] (const auto& read_likelihoods) {
+                       return std::accumulate(std::cbegin(read_likelihoods.get()), std::cend(read_likelihoods.get()), LogProbability {0});
+                   });
+    std::iota(std::begin(order_), std::end(order_), 0u);
+    std::stable_sort(std::begin(order_), std::end(order_), [&] (auto lhs, auto rhs) { return marginals[lhs] > marginals[rhs]; });
+    std::vector<LogProbability> read_maxs(num_reads_, std::numeric_limits<LogProbability>::lowest());
+    for (const auto& read_likelihoods : likelihoods) {
+        std::transform(std::cbegin(read_likelihoods.get()), std::cend(read_likelihoods.get()), std::cbegin(read_maxs),
+                       std::begin(read_maxs), [] (auto lhs, auto rhs) { return std::max(lhs, rhs); });
+    }
+    log_scale_ = std::accumulate(std::cbegin(read_maxs), std::cend(read_maxs), LogProbability {0});
+    for (std::size_t rank {0}; rank < order_.size(); ++rank) {
+        const auto& read_likelihoods = likelihoods[order_[rank]].get();
+        std::transform(std::cbegin(read_likelihoods), std::cend(read_likelihoods), std::cbegin(read_maxs),
+                       std::next(std::begin(scaled_), rank * num_reads_),
+                       [] (auto likelihood, auto max) { return std::exp(likelihood - max); });
+    }
+    for (auto rank = order_.size(); rank-- > 0;) {
+        for (std::size_t read {0}; read < num_reads_; ++read) {
+            suffix_max_[rank * num_reads_ + read] = std::max(scaled_[rank * num_reads_ + read],
+                                                             suffix_max_[(rank + 1) * num_reads_ + read]);
+        }
+    }
+}
+
+class TopGenotypeEnumerator
+{
+public:
+    TopGenotypeEnumerator(const RankedReadLikelihoods& likelihoods, unsigned ploidy, bool max_zygosity);
+
+    // Pushes every one haplotype extension of genotype onto the frontier
+    void expand(const GenotypeIndex& genotype);
+
+    bool empty() const noexcept { return frontier_.empty(); }
+    const PartialGenotype& top() const noexcept { return frontier_.top(); }
+    PartialGenotype pop();
+
+private:
+    const RankedReadLikelihoods& likelihoods_;
+    unsigned ploidy_;
+    bool max_zygosity_;
+    LogProbability log_norm_;
+    std::vector<double> partial_;
+    std::priority_queue<PartialGenotype, std::vector<PartialGenotype>, PartialGenotypeLess> frontier_;
+
+    LogProbability bound(unsigned rank, unsigned num_remaining) const;
+};
+
+TopGenotypeEnumerator::TopGenotypeEnumerator(const RankedReadLikelihoods& likelihoods, const unsigned ploidy, const bool max_zygosity)
+: likelihoods_ {likelihoods}
+, ploidy_ {ploidy}
+, max_zygosity_ {max_zygosity}
+, log_norm_ {likelihoods.log_scale() - (max_zygosity ? 0.0 : likelihoods.num_reads() * std::log(ploidy))}
+, partial_(likelihoods.num_reads())
+, frontier_ {}
+{}
+
+void TopGenotypeEnumerator::expand(const GenotypeIndex& genotype)
+{
+    std::fill(std::begin(partial_), std::end(partial_), 0.0);
+    for (const auto rank : genotype) {
+        const auto scaled = likelihoods_.scaled(rank);
+        for (std::size_t read {0}; read < partial_.size(); ++read) {
+            partial_[read] = max_zygosity_ ? std::max(partial_[read], scaled[read]) : partial_[read] + scaled[read];
+        }
+    }
+    const auto num_remaining = ploidy_ - static_cast<unsigned>(genotype.size()) - 1;
+    unsigned first_rank {0};
+    if (!genotype.empty()) first_rank = max_zygosity_ ? genotype.back() + 1 : genotype.back();
+    const auto num_haplotypes = static_cast<unsigned>(likelihoods_.num_haplotypes());
+    const auto last_rank = max_zygosity_ ? num_haplotypes - num_remaining : num_haplotypes;
+    for (auto rank = first_rank; rank < last_rank; ++rank) {
+        auto extension = genotype;
+        extension.push_back(rank);
+        frontier_.push({bound(rank, num_remaining), std::move(extension)});
+    }
+}
+
+PartialGenotype TopGenotypeEnumerator::pop()
+{
+    auto result = frontier_.top();
+    frontier_.pop();
+    return result;
+}
+
+// An upper bound on the likelihood of any genotype extending the current partial genotype with rank,
+// followed by num_remaining haplotypes of rank at least rank (or greater for max zygosity). This
+// is exact when num_remaining == 0.
+LogProbability TopGenotypeEnumerator::bound(const unsigned rank, const unsigned num_remaining) const
+{
+    const auto scaled = likelihoods_.scaled(rank);
+    LogProbability result {log_norm_};
+    if (max_zygosity_) {
+        const auto suffix_max = likelihoods_.suffix_max(rank + 1);
+        for (std::size_t read {0}; read < partial_.size(); ++read) {
+            auto best = std::max(partial_[read], scaled[read]);
+            if (num_remaining > 0) best = std::max(best, suffix_max[read]);
+            result += std::log(best);
+        }
+    } else {
+        const auto suffix_max = likelihoods_.suffix_max(rank);
+        for (std::size_t read {0}; read < partial_.size(); ++read) {
+            result += std::log(partial_[read] + scaled[read] + num_remaining * suffix_max[read]);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+std::vector<GenotypeIndex>
+enumerate_top_genotypes(const MappableBlock<Haplotype>& haplotypes, const unsigned ploidy,
+                        const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                        const TopGenotypeEnumerationParameters& params)
+{
+    std::vector<GenotypeIndex> result {};
+    if (ploidy == 0 || haplotypes.empty() || params.max_genotypes == 0) return result;
+    if (params.max_zygosity && haplotypes.size() < ploidy) return result;
+    const RankedReadLikelihoods likelihoods {haplotypes, haplotype_likelihoods};
+    TopGenotypeEnumerator enumerator {likelihoods, ploidy, params.max_zygosity};
+    enumerator.expand(GenotypeIndex {});
+    const auto log_num_genotypes_total = log_num_genotypes(haplotypes.size(), ploidy, params.max_zygosity);
+    const auto log_max_excluded_fraction = std::log(params.max_excluded_likelihood_fraction);
+    LogProbability log_enumerated_mass {std::numeric_limits<LogProbability>::lowest()};
+    while (!enumerator.empty() && result.size() < params.max_genotypes) {
+        if (!result.empty()) {
+            // The frontier bounds every genotype not yet enumerated
+            const auto log_num_remaining = log_num_genotypes_total
+                                         + std::log1p(-std::exp(std::log(result.size()) - log_num_genotypes_total));
+            if (enumerator.top().bound + log_num_remaining < log_enumerated_mass + log_max_excluded_fraction) break;
+        }
+        auto genotype = enumerator.pop();
+        if (genotype.ranks.size() == ploidy) {
+            log_enumerated_mass = result.empty() ? genotype.bound : maths::log_sum_exp(log_enumerated_mass, genotype.bound);
+            result.push_back(std::move(genotype.ranks));
+        } else {
+            enumerator.expand(genotype.ranks);
+        }
+    }
+    for (auto& genotype : result) {
+        std::transform(std::cbegin(genotype), std::cend(genotype), std::begin(genotype),
+                       [&] (auto rank) { return likelihoods.haplotype(rank); });
+        std::sort(std::begin(genotype), std::end(genotype));
+    }
+    return result;
+}
+
+} // namespace model
+} // namespace octopus
@@ -0,0 +1,49 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef top_genotype_enumeration_hpp
+#define top_genotype_enumeration_hpp
+
+#include <vector>
+#include <cstddef>
+
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "containers/mappable_block.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+
+namespace octopus { namespace model {
+
+struct TopGenotypeEnumerationParameters
+{
+    std::size_t max_genotypes;
+    // Stop once the summed likelihood of all genotypes not yet enumerated is provably less than
+    // this fraction of the summed likelihood of those that have been
+    double max_excluded_likelihood_fraction = 1e-10;
+    // Only enumerate genotypes with distinct haplotypes (e.g. for subclone models), ranking them
+    // by the best likelihood any mixture of their haplotypes could attain
+    bool max_zygosity = false;
+};
+
+/*
+ Enumerates the genotypes of the given ploidy in decreasing order of likelihood under the
+ ConstantMixtureGenotypeLikelihoodModel, without generating all of them.
+
+ Genotypes are built best-first by adding haplotypes, ordered by marginal likelihood, to partial
+ genotypes. The likelihood of any completion of a partial genotype is bounded per read by
+ assuming the remaining haplotypes are the best available for that read, so the first complete
+ genotype popped is the most likely one, and so on. This finds the top genotypes of high ploidy
+ or many-haplotype regions where exhaustive generation is infeasible.
+
+ haplotype_likelihoods must be primed with the sample (or a pooled sample) to evaluate. Returned
+ indices are into haplotypes.
+ */
+std::vector<GenotypeIndex>
+enumerate_top_genotypes(const MappableBlock<Haplotype>& haplotypes, unsigned ploidy,
+                        const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                        const TopGenotypeEnumerationParameters& params);
+
+} // namespace model
+} // namespace octopus
+
+#endif
@@ -5,14 +5,15 @@
 
 #include <iterator>
 #include <algorithm>
+#include <functional>
+#include <queue>
+#include <limits>
 #include <cmath>
-#include <random>
 #include <utility>
 #include <cassert>
 #include <string>
 #include <iostream>
-
-#include <boost/iterator/transform_iterator.hpp>
+#include <stdexcept>
 
 #include "utils/maths.hpp"
 #include "constant_mixture_genotype_likelihood_model.hpp"
@@ -53,16 +54,7 @@ void clear(Container& c)
 using GenotypeReference = std::reference_wrapper<const Genotype<Haplotype>>;
 using GenotypeIndiceVector = GenotypeIndex;
 using GenotypeIndiceVectorReference = std::reference_wrapper<const GenotypeIndiceVector>;
-
-bool operator==(const GenotypeReference lhs, const GenotypeReference rhs)
-{
-    return lhs.get() == rhs.get();
-}
-
-bool operator<(const GenotypeReference lhs, const GenotypeReference rhs)
-{
-    return GenotypeLess{}(lhs.get(), rhs.get());
-}
+using JointProbability = TrioModel::Latents::JointProbability;
 
 struct GenotypeRefProbabilityPair
 {
@@ -88,26 +80,10 @@ bool operator>(const GenotypeRefProbabilityPair& lhs, const GenotypeRefProbabili
     return lhs.probability > rhs.probability;
 }
 
-struct GenotypeRefProbabilityPairGenotypeEqual
-{
-    bool operator()(const GenotypeRefProbabilityPair& lhs, const GenotypeRefProbabilityPair& rhs) const
-    {
-        return lhs.genotype == rhs.genotype;
-    }
-};
-
-struct GenotypeRefProbabilityPairGenotypeLess
-{
-    bool operator()(const GenotypeRefProbabilityPair& lhs, const GenotypeRefProbabilityPair& rhs) const
-    {
-        return lhs.genotype < rhs.genotype;
-    }
-};
-
 struct ParentsProbabilityPair
 {
     GenotypeReference maternal, paternal;
-    double probability, maternal_likelihood, paternal_likelihood;
+    double probability;
     const GenotypeIndiceVector* maternal_indices = nullptr, *paternal_indices = nullptr;
 };
 
@@ -140,378 +116,185 @@ auto compute_likelihoods(const std::vector<Genotype<Haplotype>>& genotypes,
     return result;
 }
 
-auto compute_posteriors(const std::vector<GenotypeRefProbabilityPair>& likelihoods,
-                        const PopulationPriorModel& prior_model)
-{
-    std::vector<double> posteriors(likelihoods.size());
-    if (prior_model.is_primed()) {
-        std::transform(std::cbegin(likelihoods), std::cend(likelihoods), std::begin(posteriors),
-                       [&] (const auto& p) {
-                           return p.probability + prior_model.evaluate(std::vector<GenotypeIndiceVectorReference> {*p.indices});
-                       });
-    } else {
-        std::transform(std::cbegin(likelihoods), std::cend(likelihoods), std::begin(posteriors),
-                       [&] (const auto& p) {
-                           return p.probability + prior_model.evaluate(std::vector<GenotypeReference> {p.genotype});
-                       });
-    }
-    maths::normalise_exp(posteriors);
-    std::vector<GenotypeRefProbabilityPair> result {};
-    result.reserve(posteriors.size());
-    std::transform(std::cbegin(likelihoods), std::cend(likelihoods), std::cbegin(posteriors), std::back_inserter(result),
-                   [] (const auto& p, const auto posterior) noexcept {
-                       return GenotypeRefProbabilityPair {p.genotype, posterior};
-                   });
-    return result;
-}
-
-template <typename T>
-bool all_equal(const std::vector<T>& v)
-{
-    return std::adjacent_find(std::cbegin(v), std::cend(v), std::not_equal_to<> {}) == std::cend(v);
-}
-
-struct ProbabilityGetter
-{
-    template <typename T> const auto& operator()(const T& x) const noexcept { return x.probability; }
-};
-
-template <typename Iterator>
-auto compute_lost_posterior_mass(Iterator first, Iterator first_removed, Iterator last)
+double joint_probability(const Genotype<Haplotype>& mother, const Genotype<Haplotype>& father,
+                         const PopulationPriorModel& model)
 {
-    using boost::make_transform_iterator;
-    const auto first_prob = make_transform_iterator(first, ProbabilityGetter {});
-    const auto first_removed_prob = make_transform_iterator(first_removed, ProbabilityGetter {});
-    const auto last_prob = make_transform_iterator(last, ProbabilityGetter {});
-    return maths::log_sum_exp(first_removed_prob, last_prob) - maths::log_sum_exp(first_prob, last_prob);
+    const std::vector<std::reference_wrapper<const Genotype<Haplotype>>> parental_genotypes {mother, father};
+    return model.evaluate(parental_genotypes);
 }
 
-template <typename T>
-auto compute_min_joint(const std::vector<T>& zipped, const double max_log_mass_loss, boost::optional<double>& lost_log_mass)
+double joint_probability(const GenotypeIndiceVector& mother, const GenotypeIndiceVector& father,
+                         const PopulationPriorModel& model)
 {
-    assert(!zipped.empty());
-    using boost::make_transform_iterator;
-    std::vector<double> cum_log_probs(make_transform_iterator(std::cbegin(zipped), ProbabilityGetter {}),
-                                      make_transform_iterator(std::cend(zipped), ProbabilityGetter {}));
-    maths::normalise_logs(cum_log_probs);
-    const static auto log_sum_exp = [] (auto sum, auto x) { return maths::log_sum_exp(sum, x); };
-    std::partial_sum(std::crbegin(cum_log_probs), std::crend(cum_log_probs), std::rbegin(cum_log_probs), log_sum_exp);
-    const auto min_itr = std::upper_bound(std::crbegin(cum_log_probs), std::crend(cum_log_probs), max_log_mass_loss);
-    const auto num_to_keep = static_cast<std::size_t>(std::distance(min_itr, std::crend(cum_log_probs)));
-    assert(num_to_keep <= zipped.size());
-    if (num_to_keep < zipped.size()) {
-        assert(min_itr != std::crbegin(cum_log_probs));
-        lost_log_mass = *std::prev(min_itr);
-    }
-    return std::max(num_to_keep, std::size_t {1});
+    const std::vector<GenotypeIndiceVectorReference> parental_genotypes {mother, father};
+    return model.evaluate(parental_genotypes);
 }
 
-template <typename T>
-typename std::vector<T>::iterator
-reduce(std::vector<T>& zipped, std::size_t max_joint,
-       const double max_log_probability_loss,
-       boost::optional<double>& lost_log_mass)
+double joint_probability(const GenotypeRefProbabilityPair& mother, const GenotypeRefProbabilityPair& father,
+                         const PopulationPriorModel& model)
 {
-    max_joint = std::min(max_joint, zipped.size());
-    if (all_equal(zipped)) {
-        static std::default_random_engine gen {};
-        std::shuffle(std::begin(zipped), std::end(zipped), gen);
-        const auto min_joint = static_cast<std::size_t>(std::floor(zipped.size() * (1 - std::exp(max_log_probability_loss))));
-        lost_log_mass = boost::none;
-        return std::next(std::begin(zipped), std::min(max_joint, min_joint));
+    if (mother.indices && father.indices) {
+        return mother.probability + father.probability + joint_probability(*mother.indices, *father.indices, model);
     } else {
-        auto result = std::next(std::begin(zipped), max_joint);
-        std::partial_sort(std::begin(zipped), result, std::end(zipped), std::greater<> {});
-        if (max_joint < zipped.size()) {
-            lost_log_mass = compute_lost_posterior_mass(std::begin(zipped), result, std::end(zipped));
-        }
-        if (!lost_log_mass || *lost_log_mass < max_log_probability_loss) {
-            auto num_joint = compute_min_joint(zipped, max_log_probability_loss, lost_log_mass);
-            assert(num_joint <= max_joint);
-            result = std::next(std::begin(zipped), num_joint);
-        }
-        assert(result <= std::end(zipped));
-        return result;
+        return mother.probability + father.probability + joint_probability(mother.genotype, father.genotype, model);
     }
 }
 
-unsigned get_sample_reduction_count(const std::size_t n)
+double log_probability(const GenotypeRefProbabilityPair& genotype) noexcept
 {
-    return static_cast<unsigned>(std::sqrt(n));
+    return genotype.probability;
 }
 
-template <typename T>
-struct ReducedVectorMap
+double log_probability(const ParentsProbabilityPair& parents) noexcept
 {
-    using Iterator = typename std::vector<T>::const_iterator;
-    Iterator first, last_to_partially_join, last_to_join, last;
-};
+    return parents.probability;
+}
 
-template <typename T>
-auto make_reduction_map(const std::vector<T>& elements,
-                        const typename std::vector<T>::const_iterator last_to_combine,
-                        const TrioModel::Options& options)
+double log_probability(const JointProbability& trio) noexcept
 {
-    if (std::distance(std::cbegin(elements), last_to_combine) > 1) {
-        return ReducedVectorMap<T> {std::cbegin(elements), std::next(std::cbegin(elements), 1), last_to_combine, std::cend(elements)};
-    } else {
-        return ReducedVectorMap<T> {std::cbegin(elements), last_to_combine, last_to_combine, std::cend(elements)};
-    }
+    return trio.log_probability;
 }
 
+// A vector viewed in decreasing order of log probability
 template <typename T>
-auto reduce(std::vector<T>& zipped, const TrioModel::Options& options)
+class SortedSequence
 {
-    auto last_to_join = std::cend(zipped);
-    if (options.max_joint_genotypes) {
-        last_to_join = reduce(zipped, get_sample_reduction_count(*options.max_joint_genotypes), options.max_individual_log_probability_loss);
+public:
+    using value_type = T;
+    
+    SortedSequence(std::vector<T>& elements) : elements_ {elements}
+    {
+        std::sort(std::begin(elements_), std::end(elements_), std::greater<> {});
     }
-    return make_reduction_map(zipped, last_to_join, options);
-}
-
-struct UniformPriorJointProbabilityHelper
-{
-    std::size_t index;
-    double probability;
+    
+    std::size_t size() const noexcept { return elements_.size(); }
+    bool contains(const std::size_t n) const noexcept { return n < elements_.size(); }
+    const T& operator[](const std::size_t n) const noexcept { return elements_[n]; }
+    
+private:
+    std::vector<T>& elements_;
 };
 
-bool operator==(const UniformPriorJointProbabilityHelper& lhs, const UniformPriorJointProbabilityHelper& rhs) noexcept
-{
-    return lhs.probability == rhs.probability;
-}
-bool operator!=(const UniformPriorJointProbabilityHelper& lhs, const UniformPriorJointProbabilityHelper& rhs) noexcept
-{
-    return lhs.probability != rhs.probability;
-}
-bool operator<(const UniformPriorJointProbabilityHelper& lhs, const UniformPriorJointProbabilityHelper& rhs) noexcept
-{
-    return lhs.probability < rhs.probability;
-}
-bool operator>(const UniformPriorJointProbabilityHelper& lhs, const UniformPriorJointProbabilityHelper& rhs) noexcept
-{
-    return lhs.probability > rhs.probability;
-}
-
-template <typename Iterator, typename UnaryOperation>
-auto index_zip(Iterator first, const Iterator last, UnaryOperation op)
-{
-    using T = typename std::iterator_traits<Iterator>::value_type;
-    using R = std::result_of_t<UnaryOperation(const T&)>;
-    const auto n = static_cast<std::size_t>(std::distance(first, last));
-    std::vector<std::pair<R, std::size_t>> result(n);
-    for (std::size_t idx {0}; idx < n; ++idx) {
-        result[idx] = std::make_pair(op(*first++), idx);
+/*
+ Lazily joins two sequences, each in decreasing order of log probability, into the sequence of pairs in
+ decreasing order of joint log probability. The joiner may only add log probabilities (priors and
+ inheritance probabilities) to the sum of the pair's log probabilities, so the sum bounds the joint.
+ Cells of the (left, right) grid are evaluated best-first by this bound, and an evaluated pair is only
+ enumerated once no unevaluated cell could beat it. A join is itself a sequence, so can be joined again.
+ */
+template <typename Left, typename Right, typename Joiner>
+class BestFirstJoin
+{
+public:
+    using value_type = std::result_of_t<Joiner(const typename Left::value_type&, const typename Right::value_type&)>;
+    
+    BestFirstJoin(Left& left, Right& right, Joiner joiner)
+    : left_ {left}
+    , right_ {right}
+    , joiner_ {std::move(joiner)}
+    , frontier_ {}
+    , evaluated_ {}
+    , enumerated_ {}
+    {
+        push(0, 0);
     }
-    return result;
-}
-
-template <typename Iterator>
-auto order_indices_by_probability(const Iterator first, const Iterator last, std::size_t k)
-{
-    auto zipped = index_zip(first, last, [] (const auto& pair) { return pair.probability; });
-    k = std::min(zipped.size(), k);
-    const auto kth = std::next(std::begin(zipped), k);
-    std::partial_sort(std::begin(zipped), kth, std::end(zipped), std::greater<> {});
-    std::vector<std::size_t> result(k);
-    std::transform(std::begin(zipped), kth, std::begin(result), [] (const auto& p) { return p.second; });
-    return result;
-}
-
-template <typename Iterator>
-auto select_top_k_haplotypes(const Iterator first, Iterator last, const std::size_t k)
-{
-    const auto top_pair_indices = order_indices_by_probability(first, last, k);
-    std::set<Haplotype> result {};
-    for (const auto idx : top_pair_indices) {
-        if (result.size() >= k) break;
-        const auto& genotype = std::next(first, idx)->genotype.get();
-        std::copy(std::cbegin(genotype), std::cend(genotype), std::inserter(result, std::begin(result)));
+    
+    std::size_t size() const noexcept { return left_.size() * right_.size(); }
+    // Evaluates as many pairs as needed to enumerate the nth best
+    bool contains(const std::size_t n)
+    {
+        while (enumerated_.size() <= n && enumerate_next());
+        return n < enumerated_.size();
     }
-    return result;
-}
-
-using ChildReductionMap = ReducedVectorMap<GenotypeRefProbabilityPair>;
-
-auto select_top_k_haplotypes(const ChildReductionMap& child, const std::size_t k)
-{
-    return select_top_k_haplotypes(child.first, child.last_to_join, k);
-}
-
-using ParentsProbabilityPairIterator = std::vector<ParentsProbabilityPair>::iterator;
-
-bool is_represented(const Haplotype& haplotype, const ParentsProbabilityPair& parent)
-{
-    return parent.maternal.get().contains(haplotype) || parent.paternal.get().contains(haplotype);
-}
-
-bool is_represented(const Haplotype& haplotype,
-                    const ParentsProbabilityPairIterator first_parent,
-                    const ParentsProbabilityPairIterator last_parent)
-{
-    return std::any_of(first_parent, last_parent, [&] (const auto& parent) { return is_represented(haplotype, parent); });
-}
-
-auto find_represented(const Haplotype& haplotype,
-                      const ParentsProbabilityPairIterator first_parent,
-                      const ParentsProbabilityPairIterator last_parent)
-{
-    return std::find_if(first_parent, last_parent, [&] (const auto& parent) { return is_represented(haplotype, parent); });
-}
-
-auto reduce(std::vector<ParentsProbabilityPair>& parents, const ChildReductionMap& child,
-            boost::optional<double>& lost_log_mass, const TrioModel::Options& options)
-{
-    if (!options.max_joint_genotypes) return make_reduction_map(parents, std::cend(parents), options);
-    const auto reduction_count = get_sample_reduction_count(*options.max_joint_genotypes);
-    auto last_to_join = reduce(parents, reduction_count, options.max_joint_log_probability_loss, lost_log_mass);
-    if (last_to_join != std::cend(parents)) {
-        std::vector<UniformPriorJointProbabilityHelper> uniform_parents(parents.size());
-        for (std::size_t i {0}; i < parents.size(); ++i) {
-            uniform_parents[i].index = i;
-            uniform_parents[i].probability = parents[i].maternal_likelihood + parents[i].paternal_likelihood;
-        }
-        uniform_parents.erase(reduce(uniform_parents, reduction_count, options.max_joint_log_probability_loss, lost_log_mass), std::cend(uniform_parents));
-        std::deque<std::size_t> new_indices {};
-        const auto num_posterior_joined = static_cast<std::size_t>(std::distance(std::begin(parents), last_to_join));
-        for (const auto& p : uniform_parents) {
-            if (p.index >= num_posterior_joined) {
-                new_indices.push_back(p.index);
-            }
-        }
-        uniform_parents.clear();
-        if (!new_indices.empty()) {
-            std::sort(std::begin(new_indices), std::end(new_indices));
-            auto curr_index = num_posterior_joined;
-            // Can use std::partition as it must do a single left-to-right pass due to ForwardIterator and complexity requirements
-            last_to_join = std::partition(last_to_join, std::end(parents), [&] (const auto& p) {
-                if (!new_indices.empty() && curr_index++ == new_indices.front()) {
-                    new_indices.pop_front();
-                    return true;
-                } else {
-                    return false;
-                }
-            });
-            assert(new_indices.empty());
+    const value_type& operator[](const std::size_t n) const noexcept { return enumerated_[n]; }
+    const std::vector<value_type>& enumerated() const noexcept { return enumerated_; }
+    
+private:
+    struct Cell
+    {
+        double bound;
+        std::size_t left, right;
+    };
+    struct CellLess
+    {
+        bool operator()(const Cell& lhs, const Cell& rhs) const noexcept { return lhs.bound < rhs.bound; }
+    };
+    struct LogProbabilityLess
+    {
+        bool operator()(const value_type& lhs, const value_type& rhs) const noexcept
+        {
+            return log_probability(lhs) < log_probability(rhs);
         }
-        // We want to make sure haplotypes that the child may have are survive to avoid false positive de novo child haplotypes
-        const auto top_child_haplotypes = select_top_k_haplotypes(child, 4);
-        for (const auto& haplotype : top_child_haplotypes) {
-            if (!is_represented(haplotype, std::begin(parents), last_to_join)) {
-                const auto first_represented_parent = find_represented(haplotype, last_to_join, std::end(parents));
-                if (first_represented_parent != std::end(parents)) {
-                    std::iter_swap(first_represented_parent, last_to_join);
-                    ++last_to_join;
-                }
-            }
+    };
+    
+    Left& left_;
+    Right& right_;
+    Joiner joiner_;
+    std::priority_queue<Cell, std::vector<Cell>, CellLess> frontier_;
+    std::priority_queue<value_type, std::vector<value_type>, LogProbabilityLess> evaluated_;
+    std::vector<value_type> enumerated_;
+    
+    void push(const std::size_t left, const std::size_t right)
+    {
+        if (left_.contains(left) && right_.contains(right)) {
+            frontier_.push({log_probability(left_[left]) + log_probability(right_[right]), left, right});
         }
     }
-    return make_reduction_map(parents, last_to_join, options);
-}
-
-bool are_same_ploidy(const std::vector<GenotypeRefProbabilityPair>& maternal,
-                     const std::vector<GenotypeRefProbabilityPair>& paternal)
-{
-    assert(!maternal.empty() && !paternal.empty());
-    return maternal.front().genotype.get().ploidy() == paternal.front().genotype.get().ploidy();
-}
-
-auto reduce(std::vector<GenotypeRefProbabilityPair>& likelihoods,
-            const PopulationPriorModel& prior_model,
-            boost::optional<double>& lost_log_mass,
-            const TrioModel::Options& options)
-{
-    if (!options.max_joint_genotypes) return make_reduction_map(likelihoods, std::cend(likelihoods), options);
-    const auto reduction_count = get_sample_reduction_count(*options.max_joint_genotypes);
-    const auto last_likelihood_join = reduce(likelihoods, reduction_count, options.max_individual_log_probability_loss, lost_log_mass);
-    if (last_likelihood_join == std::end(likelihoods)) {
-        return make_reduction_map(likelihoods, std::cend(likelihoods), options);
-    } else if (lost_log_mass && *lost_log_mass > options.max_individual_log_probability_loss) {
-        return make_reduction_map(likelihoods, last_likelihood_join, options); // overflow
-    } else {
-        auto posteriors = compute_posteriors(likelihoods, prior_model);
-        const auto last_posterior_join = reduce(posteriors, reduction_count, options.max_individual_log_probability_loss, lost_log_mass);
-        assert(last_posterior_join <= std::end(posteriors));
-        if (last_posterior_join != std::end(posteriors)) {
-            std::sort(std::begin(likelihoods), std::end(likelihoods), GenotypeRefProbabilityPairGenotypeLess {});
-            std::sort(std::begin(posteriors), last_posterior_join, GenotypeRefProbabilityPairGenotypeLess {});
-            std::vector<GenotypeRefProbabilityPair> reordered_likelihoods {};
-            reordered_likelihoods.reserve(posteriors.size());
-            std::set_intersection(std::cbegin(likelihoods), std::cend(likelihoods),
-                                  std::begin(posteriors), last_posterior_join,
-                                  std::back_inserter(reordered_likelihoods),
-                                  GenotypeRefProbabilityPairGenotypeLess {});
-            std::set_intersection(std::cbegin(likelihoods), std::cend(likelihoods),
-                                  last_posterior_join, std::end(posteriors),
-                                  std::back_inserter(reordered_likelihoods),
-                                  GenotypeRefProbabilityPairGenotypeLess {});
-            likelihoods = std::move(reordered_likelihoods);
-            auto last_join = std::next(std::cbegin(likelihoods), std::distance(std::begin(posteriors), last_posterior_join));
-            return make_reduction_map(likelihoods, last_join, options);
-        } else {
-            return make_reduction_map(likelihoods, std::cend(likelihoods), options);
+    
+    bool enumerate_next()
+    {
+        while (!frontier_.empty() && (evaluated_.empty() || log_probability(evaluated_.top()) < frontier_.top().bound)) {
+            const auto cell = frontier_.top();
+            frontier_.pop();
+            evaluated_.push(joiner_(left_[cell.left], right_[cell.right]));
+            // Each cell is pushed by exactly one neighbour: (l, 0) by (l - 1, 0) and (l, r) by (l, r - 1)
+            if (cell.right == 0) push(cell.left + 1, 0);
+            push(cell.left, cell.right + 1);
         }
+        if (evaluated_.empty()) return false;
+        enumerated_.push_back(evaluated_.top());
+        evaluated_.pop();
+        return true;
     }
-}
-
-double joint_probability(const Genotype<Haplotype>& mother, const Genotype<Haplotype>& father,
-                         const PopulationPriorModel& model)
-{
-    const std::vector<std::reference_wrapper<const Genotype<Haplotype>>> parental_genotypes {mother, father};
-    return model.evaluate(parental_genotypes);
-}
+};
 
-double joint_probability(const GenotypeIndiceVector& mother, const GenotypeIndiceVector& father,
-                         const PopulationPriorModel& model)
+template <typename Left, typename Right, typename Joiner>
+auto make_best_first_join(Left& left, Right& right, Joiner joiner)
 {
-    const std::vector<GenotypeIndiceVectorReference> parental_genotypes {mother, father};
-    return model.evaluate(parental_genotypes);
+    return BestFirstJoin<Left, Right, Joiner> {left, right, std::move(joiner)};
 }
 
-double joint_probability(const GenotypeRefProbabilityPair& mother, const GenotypeRefProbabilityPair& father,
-                         const PopulationPriorModel& model)
-{
-    if (mother.indices && father.indices) {
-        return mother.probability + father.probability + joint_probability(*mother.indices, *father.indices, model);
-    } else {
-        return mother.probability + father.probability + joint_probability(mother.genotype, father.genotype, model);
-    }
-}
+using GenotypeSequence = SortedSequence<GenotypeRefProbabilityPair>;
 
-template <typename T1, typename T2>
-auto join_size(const ReducedVectorMap<T1>& first, const ReducedVectorMap<T2>& second) noexcept
+auto join(GenotypeSequence& maternal, GenotypeSequence& paternal, const PopulationPriorModel& model)
 {
-    using std::distance;
-    std::size_t result {0};
-    result += distance(first.first, first.last_to_join) * distance(second.first, second.last_to_join);
-    result += distance(first.last_to_join, first.last) * distance(second.first, second.last_to_partially_join);
-    result += distance(second.last_to_join, second.last) * distance(first.first, first.last_to_partially_join);
-    return result;
+    return make_best_first_join(maternal, paternal, [&model] (const auto& m, const auto& p) {
+        return ParentsProbabilityPair {m.genotype, p.genotype, joint_probability(m, p, model), m.indices, p.indices};
+    });
 }
 
-auto join(const ReducedVectorMap<GenotypeRefProbabilityPair>& maternal,
-          const ReducedVectorMap<GenotypeRefProbabilityPair>& paternal,
-          const PopulationPriorModel& model)
+// Takes the best joint genotypes until those not taken provably hold less than the requested fraction of the
+// taken posterior mass, or max_joint_genotypes is reached
+template <typename Join>
+auto take_top(Join& joint, const TrioModel::Options& options, boost::optional<double>& lost_log_mass)
 {
-    std::vector<ParentsProbabilityPair> result {};
-    result.reserve(join_size(maternal, paternal));
-    std::for_each(maternal.first, maternal.last_to_join, [&] (const auto& m) {
-        std::for_each(paternal.first, paternal.last_to_join, [&] (const auto& p) {
-            result.push_back({m.genotype, p.genotype, joint_probability(m, p, model),
-                              m.probability, m.probability, m.indices, p.indices});
-        });
-    });
-    std::for_each(maternal.last_to_join, maternal.last, [&] (const auto& m) {
-        std::for_each(paternal.first, paternal.last_to_partially_join, [&] (const auto& p) {
-            result.push_back({m.genotype, p.genotype, joint_probability(m, p, model),
-                              m.probability, m.probability, m.indices, p.indices});
-        });
-    });
-    std::for_each(paternal.last_to_join, paternal.last, [&] (const auto& p) {
-        std::for_each(maternal.first, maternal.last_to_partially_join, [&] (const auto& m) {
-            result.push_back({m.genotype, p.genotype, joint_probability(m, p, model),
-                              m.probability, m.probability, m.indices, p.indices});
-        });
-    });
+    std::vector<JointProbability> result {};
+    const auto max_joint_genotypes = options.max_joint_genotypes ? std::max(*options.max_joint_genotypes, std::size_t {1}) : joint.size();
+    const auto log_max_excluded_fraction = std::log(options.max_excluded_posterior_fraction);
+    auto log_taken_mass = std::numeric_limits<double>::lowest();
+    while (joint.contains(result.size())) {
+        const auto& next = joint[result.size()];
+        // Every joint genotype not yet taken is at most as probable as next
+        const auto log_num_remaining = std::log(static_cast<double>(joint.size() - result.size()));
+        const auto log_excluded_mass_bound = next.log_probability + log_num_remaining;
+        if (!result.empty() && log_excluded_mass_bound < log_taken_mass + log_max_excluded_fraction) break;
+        if (result.size() == max_joint_genotypes) {
+            lost_log_mass = log_excluded_mass_bound - maths::log_sum_exp(log_taken_mass, log_excluded_mass_bound);
+            break;
+        }
+        log_taken_mass = result.empty() ? next.log_probability : maths::log_sum_exp(log_taken_mass, next.log_probability);
+        result.push_back(next);
+    }
     return result;
 }
 
@@ -707,8 +490,6 @@ template <> struct ProbabilityOfChildGivenParents<1, 1, 1>
     const DeNovoModel& mutation_model;
 };
 
-using JointProbability = TrioModel::Latents::JointProbability;
-
 template <typename F>
 auto joint_probability(const ParentsProbabilityPair& parents,
                        const GenotypeRefProbabilityPair& child,
@@ -723,61 +504,48 @@ auto joint_probability(const ParentsProbabilityPair& parents,
     }
 }
 
-template <typename F>
-auto join(const ReducedVectorMap<ParentsProbabilityPair>& parents,
-          const ReducedVectorMap<GenotypeRefProbabilityPair>& child,
-          F jpdf)
+template <typename Parents, typename F>
+auto join(Parents& parents, GenotypeSequence& child, F jpdf,
+          const TrioModel::Options& options, boost::optional<double>& lost_log_mass)
 {
-    std::vector<JointProbability> result {};
-    result.reserve(join_size(parents, child));
-    std::for_each(parents.first, parents.last_to_join, [&] (const auto& p) {
-        std::for_each(child.first, child.last_to_join, [&] (const auto& c) {
-            result.push_back({p.maternal, p.paternal, c.genotype, joint_probability(p, c, jpdf), 0.0});
-        });
+    auto joint = make_best_first_join(parents, child, [&jpdf] (const ParentsProbabilityPair& p, const GenotypeRefProbabilityPair& c) {
+        return JointProbability {p.maternal, p.paternal, c.genotype, joint_probability(p, c, jpdf), 0.0};
     });
-    std::for_each(parents.last_to_join, parents.last, [&] (const auto& p) {
-        std::for_each(child.first, child.last_to_partially_join, [&] (const auto& c) {
-            result.push_back({p.maternal, p.paternal, c.genotype, joint_probability(p, c, jpdf), 0.0});
-        });
-    });
-    std::for_each(child.last_to_join, child.last, [&] (const auto& c) {
-        std::for_each(parents.first, parents.last_to_partially_join, [&] (const auto& p) {
-            result.push_back({p.maternal, p.paternal, c.genotype, joint_probability(p, c, jpdf), 0.0});
-        });
-    });
-    return result;
+    return take_top(joint, options, lost_log_mass);
 }
 
-auto join(const ReducedVectorMap<ParentsProbabilityPair>& parents,
-          const ReducedVectorMap<GenotypeRefProbabilityPair>& child,
-          const DeNovoModel& mutation_model)
+template <typename Parents>
+auto join(Parents& parents, GenotypeSequence& child, const DeNovoModel& mutation_model,
+          const TrioModel::Options& options, boost::optional<double>& lost_log_mass)
 {
-    const auto maternal_ploidy = parents.first->maternal.get().ploidy();
-    const auto paternal_ploidy = parents.first->paternal.get().ploidy();
-    const auto child_ploidy    = child.first->genotype.get().ploidy();
+    // contains(0) evaluates the first parental pair, which must happen before it is read
+    if (!parents.contains(0) || !child.contains(0)) return std::vector<JointProbability> {};
+    const auto maternal_ploidy = parents[0].maternal.get().ploidy();
+    const auto paternal_ploidy = parents[0].paternal.get().ploidy();
+    const auto child_ploidy    = child[0].genotype.get().ploidy();
     if (child_ploidy == 1) {
         if (paternal_ploidy == 1) {
             if (maternal_ploidy == 0) {
-                return join(parents, child, ProbabilityOfChildGivenParents<1, 0, 1> {mutation_model});
+                return join(parents, child, ProbabilityOfChildGivenParents<1, 0, 1> {mutation_model}, options, lost_log_mass);
             }
             if (maternal_ploidy == 1) {
-                return join(parents, child, ProbabilityOfChildGivenParents<1, 1, 1> {mutation_model});
+                return join(parents, child, ProbabilityOfChildGivenParents<1, 1, 1> {mutation_model}, options, lost_log_mass);
             }
             if (maternal_ploidy == 2) {
-                return join(parents, child, ProbabilityOfChildGivenParents<1, 2, 1> {mutation_model});
+                return join(parents, child, ProbabilityOfChildGivenParents<1, 2, 1> {mutation_model}, options, lost_log_mass);
             }
         }
     } else if (child_ploidy == 2) {
         if (maternal_ploidy == 2) {
             if (paternal_ploidy == 1) {
-                return join(parents, child, ProbabilityOfChildGivenParents<2, 2, 1> {mutation_model});
+                return join(parents, child, ProbabilityOfChildGivenParents<2, 2, 1> {mutation_model}, options, lost_log_mass);
             }
             if (paternal_ploidy == 2) {
-                return join(parents, child, ProbabilityOfChildGivenParents<2, 2, 2> {mutation_model});
+                return join(parents, child, ProbabilityOfChildGivenParents<2, 2, 2> {mutation_model}, options, lost_log_mass);
             }
         }
     } else if (child_ploidy == 3 && maternal_ploidy == 3 && paternal_ploidy == 3) {
-        return join(parents, child, ProbabilityOfChildGivenParents<3, 3, 3> {mutation_model});
+        return join(parents, child, ProbabilityOfChildGivenParents<3, 3, 3> {mutation_model}, options, lost_log_mass);
     }
     throw std::runtime_error {"TrioModel: unimplemented joint probability function"};
 }
@@ -792,6 +560,7 @@ auto extract_probabilities(const std::vector<JointProbability>& joint_likelihood
 
 auto normalise_exp(std::vector<JointProbability>& joint_likelihoods)
 {
+    if (joint_likelihoods.empty()) return -std::numeric_limits<double>::infinity();
     auto log_likelihoods = extract_probabilities(joint_likelihoods);
     const auto norm = maths::normalise_logs(log_likelihoods);
     auto iter = std::cbegin(log_likelihoods);
@@ -847,17 +616,15 @@ TrioModel::evaluate(const GenotypeVector& maternal_genotypes,
         debug::print(stream(*debug_log_), "paternal", paternal_likelihoods);
         debug::print(stream(*debug_log_), "child", child_likelihoods);
     }
+    GenotypeSequence maternal {maternal_likelihoods}, paternal {paternal_likelihoods}, child {child_likelihoods};
+    auto parents = join(maternal, paternal, prior_model_);
     boost::optional<double> lost_log_mass {};
-    const auto reduced_maternal_likelihoods = reduce(maternal_likelihoods, prior_model_, lost_log_mass, options_);
-    const auto reduced_paternal_likelihoods = reduce(paternal_likelihoods, prior_model_, lost_log_mass, options_);
-    const auto reduced_child_likelihoods    = reduce(child_likelihoods, prior_model_, lost_log_mass, options_);
-    auto parental_likelihoods = join(reduced_maternal_likelihoods, reduced_paternal_likelihoods, prior_model_);
-    if (debug_log_) debug::print(stream(*debug_log_), parental_likelihoods);
-    const auto reduced_parental_likelihoods = reduce(parental_likelihoods, reduced_child_likelihoods, lost_log_mass, options_);
-    auto joint_likelihoods = join(reduced_parental_likelihoods, reduced_child_likelihoods, mutation_model_);
-    if (debug_log_) debug::print(stream(*debug_log_), joint_likelihoods);
+    auto joint_likelihoods = join(parents, child, mutation_model_, options_, lost_log_mass);
+    if (debug_log_) {
+        debug::print(stream(*debug_log_), parents.enumerated());
+        debug::print(stream(*debug_log_), joint_likelihoods);
+    }
     const auto evidence = normalise_exp(joint_likelihoods);
-    if (lost_log_mass) *lost_log_mass *= 2 * std::distance(reduced_child_likelihoods.first, reduced_child_likelihoods.last_to_join);
     return {std::move(joint_likelihoods), evidence, lost_log_mass};
 }
 
@@ -890,17 +657,15 @@ TrioModel::evaluate(const GenotypeVector& genotypes,
         debug::print(stream(*debug_log_), "paternal", paternal_likelihoods);
         debug::print(stream(*debug_log_), "child", child_likelihoods);
     }
+    GenotypeSequence maternal {maternal_likelihoods}, paternal {paternal_likelihoods}, child {child_likelihoods};
+    auto parents = join(maternal, paternal, prior_model_);
     boost::optional<double> lost_log_mass {};
-    const auto reduced_maternal_likelihoods = reduce(maternal_likelihoods, prior_model_, lost_log_mass, options_);
-    const auto reduced_paternal_likelihoods = reduce(paternal_likelihoods, prior_model_, lost_log_mass, options_);
-    const auto reduced_child_likelihoods    = reduce(child_likelihoods, prior_model_, lost_log_mass, options_);
-    auto parental_likelihoods = join(reduced_maternal_likelihoods, reduced_paternal_likelihoods, prior_model_);
-    if (debug_log_) debug::print(stream(*debug_log_), parental_likelihoods);
-    const auto reduced_parental_likelihoods = reduce(parental_likelihoods, reduced_child_likelihoods, lost_log_mass, options_);
-    auto joint_likelihoods = join(reduced_parental_likelihoods, reduced_child_likelihoods, mutation_model_);
-    if (debug_log_) debug::print(stream(*debug_log_), joint_likelihoods);
+    auto joint_likelihoods = join(parents, child, mutation_model_, options_, lost_log_mass);
+    if (debug_log_) {
+        debug::print(stream(*debug_log_), parents.enumerated());
+        debug::print(stream(*debug_log_), joint_likelihoods);
+    }
     const auto evidence = normalise_exp(joint_likelihoods);
-    if (lost_log_mass) *lost_log_mass *= 2 * std::distance(reduced_child_likelihoods.first, reduced_child_likelihoods.last_to_join);
     return {std::move(joint_likelihoods), evidence, lost_log_mass};
 }
 
@@ -922,28 +687,13 @@ auto joint_probability(const GenotypeRefProbabilityPair& parent,
            + probability_of_child_given_parent(child.genotype, parent.genotype, mutation_model);
 }
 
-auto join(const ReducedVectorMap<GenotypeRefProbabilityPair>& parent,
-          const ReducedVectorMap<GenotypeRefProbabilityPair>& child,
-          const DeNovoModel& mutation_model)
+auto join(GenotypeSequence& parent, GenotypeSequence& child, const DeNovoModel& mutation_model,
+          const TrioModel::Options& options, boost::optional<double>& lost_log_mass)
 {
-    std::vector<JointProbability> result {};
-    result.reserve(join_size(parent, child));
-    std::for_each(parent.first, parent.last_to_join, [&] (const auto& p) {
-        std::for_each(child.first, child.last_to_join, [&] (const auto& c) {
-            result.push_back({p.genotype, p.genotype, c.genotype, joint_probability(p, c, mutation_model), 0.0});
-        });
-    });
-    std::for_each(parent.last_to_join, parent.last, [&] (const auto& p) {
-        std::for_each(child.first, child.last_to_partially_join, [&] (const auto& c) {
-            result.push_back({p.genotype, p.genotype, c.genotype, joint_probability(p, c, mutation_model), 0.0});
-        });
+    auto joint = make_best_first_join(parent, child, [&mutation_model] (const auto& p, const auto& c) {
+        return JointProbability {p.genotype, p.genotype, c.genotype, joint_probability(p, c, mutation_model), 0.0};
     });
-    std::for_each(child.last_to_join, child.last, [&] (const auto& c) {
-        std::for_each(parent.first, parent.last_to_partially_join, [&] (const auto& p) {
-            result.push_back({p.genotype, p.genotype, c.genotype, joint_probability(p, c, mutation_model), 0.0});
-        });
-    });
-    return result;
+    return take_top(joint, options, lost_log_mass);
 }
 
 TrioModel::InferredLatents
@@ -954,16 +704,14 @@ TrioModel::evaluate_allosome(const GenotypeVector& parent_genotypes,
     assert(!parent_genotypes.empty() && !child_genotypes.empty());
     const ConstantMixtureGenotypeLikelihoodModel likelihood_model {haplotype_likelihoods};
     assert(haplotype_likelihoods.is_primed());
-    auto child_likelihoods = compute_likelihoods(child_genotypes, likelihood_model);
-    if (debug_log_) debug::print(stream(*debug_log_), "child", child_likelihoods);
-    boost::optional<double> lost_log_mass {};
-    const auto reduced_child_likelihoods = reduce(child_likelihoods, prior_model_, lost_log_mass, options_);
     auto parent_likelihoods = compute_likelihoods(parent_genotypes, likelihood_model);
     if (debug_log_) debug::print(stream(*debug_log_), "parent", parent_likelihoods);
-    const auto reduced_parent_likelihoods = reduce(parent_likelihoods, prior_model_, lost_log_mass, options_);
     haplotype_likelihoods.prime(trio_.child());
-    auto joint_likelihoods = join(reduced_parent_likelihoods, reduced_child_likelihoods, mutation_model_);
-    if (lost_log_mass) *lost_log_mass *= 2 * std::distance(reduced_child_likelihoods.first, reduced_child_likelihoods.last_to_join);
+    auto child_likelihoods = compute_likelihoods(child_genotypes, likelihood_model);
+    if (debug_log_) debug::print(stream(*debug_log_), "child", child_likelihoods);
+    GenotypeSequence parent {parent_likelihoods}, child {child_likelihoods};
+    boost::optional<double> lost_log_mass {};
+    auto joint_likelihoods = join(parent, child, mutation_model_, options_, lost_log_mass);
     clear(parent_likelihoods);
     clear(child_likelihoods);
     const auto evidence = normalise_exp(joint_likelihoods);
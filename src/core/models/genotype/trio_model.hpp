@@ -41,13 +41,16 @@ public:
     {
         Latents posteriors;
         double log_evidence;
+        // Set if max_joint_genotypes stopped the enumeration, bounding the posterior mass not enumerated
         boost::optional<double> estimated_lost_log_posterior_mass = boost::none;
     };
     
     struct Options
     {
         boost::optional<std::size_t> max_joint_genotypes = boost::none;
-        double max_individual_log_probability_loss = -1'000, max_joint_log_probability_loss = -10'000;
+        // Stop enumerating joint genotypes once the posterior mass of those not yet enumerated is provably less
+        // than this fraction of the posterior mass of those that have been
+        double max_excluded_posterior_fraction = 1e-10;
     };
     
     TrioModel() = delete;
@@ -33,19 +33,19 @@ private:
     
     LogProbability do_evaluate(const std::vector<Genotype<Haplotype>>& genotypes) const override
     {
-        return 1.0;
+        return 0;
     }
     LogProbability do_evaluate(const std::vector<GenotypeReference>& genotypes) const override
     {
-        return 1.0;
+        return 0;
     }
     LogProbability do_evaluate(const std::vector<GenotypeIndex>& genotypes) const override
     {
-        return 1.0;
+        return 0;
     }
     LogProbability do_evaluate(const std::vector<GenotypeIndiceVectorReference>& indices) const override
     {
-        return 1.0;
+        return 0;
     }
     void do_prime(const HaplotypeBlock& haplotypes) override
     {
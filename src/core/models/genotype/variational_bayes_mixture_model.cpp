@@ -0,0 +1,496 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "variational_bayes_mixture_model.hpp"
+
+#include <unordered_map>
+#include <numeric>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <future>
+#include <exception>
+#include <cmath>
+
+#include <boost/math/special_functions/digamma.hpp>
+
+#include "utils/maths.hpp"
+#include "utils/work_stealing_scheduler.hpp"
+
+namespace octopus { namespace model { namespace detail {
+
+VBSampleLikelihoods::VBSampleLikelihoods(const std::vector<const VBReadLikelihoodArray*>& likelihoods,
+                                         const std::size_t num_components)
+: num_components_ {num_components}
+, num_reads_ {likelihoods.empty() ? 0 : likelihoods.front()->size()}
+, likelihoods_ {}
+, rows_(likelihoods.size())
+, component_rows_(num_components)
+{
+    assert(num_components_ > 0 && likelihoods.size() % num_components_ == 0);
+    std::unordered_map<const LogProbability*, std::size_t> row_indices {};
+    for (std::size_t i {0}; i < likelihoods.size(); ++i) {
+        assert(likelihoods[i]->size() == num_reads_);
+        const auto p = row_indices.emplace(likelihoods[i]->data(), num_rows_);
+        if (p.second) {
+            likelihoods_.insert(std::cend(likelihoods_), std::cbegin(*likelihoods[i]), std::cend(*likelihoods[i]));
+            ++num_rows_;
+        }
+        rows_[i] = p.first->second;
+    }
+    std::vector<bool> is_used(num_rows_);
+    for (std::size_t k {0}; k < num_components_; ++k) {
+        std::fill(std::begin(is_used), std::end(is_used), false);
+        for (std::size_t g {0}; g < num_genotypes(); ++g) is_used[row(g, k)] = true;
+        for (std::size_t r {0}; r < num_rows_; ++r) {
+            if (is_used[r]) component_rows_[k].push_back(r);
+        }
+    }
+}
+
+std::size_t VBSampleLikelihoods::num_genotypes() const noexcept
+{
+    return rows_.size() / num_components_;
+}
+
+std::size_t VBSampleLikelihoods::num_components() const noexcept
+{
+    return num_components_;
+}
+
+std::size_t VBSampleLikelihoods::num_reads() const noexcept
+{
+    return num_reads_;
+}
+
+std::size_t VBSampleLikelihoods::num_rows() const noexcept
+{
+    return num_rows_;
+}
+
+std::size_t VBSampleLikelihoods::row(const std::size_t g, const std::size_t k) const noexcept
+{
+    return rows_[g * num_components_ + k];
+}
+
+const float* VBSampleLikelihoods::likelihoods(const std::size_t row) const noexcept
+{
+    return likelihoods_.data() + row * num_reads_;
+}
+
+const std::vector<std::size_t>& VBSampleLikelihoods::component_rows(const std::size_t k) const noexcept
+{
+    return component_rows_[k];
+}
+
+MemoryFootprint VBSampleLikelihoods::footprint() const noexcept
+{
+    auto result = likelihoods_.capacity() * sizeof(float) + rows_.capacity() * sizeof(std::size_t);
+    for (const auto& rows : component_rows_) result += rows.capacity() * sizeof(std::size_t);
+    return result;
+}
+
+namespace {
+
+// Reads are processed in blocks so the log responsibilities being accumulated stay in cache
+constexpr std::size_t readBlockSize {512};
+
+// A seed is abandoned once, if its remaining improvements keep shrinking geometrically, it would still
+// finish this far below the reference seed. Its evidence weight would then be below exp(-40) ~ 4e-18 of
+// the reference seed's. The projection is a heuristic, so abandoned seeds are never used as modes.
+constexpr double maxLogEvidenceDeficit {40};
+
+struct VBModel
+{
+    const std::vector<float>& prior_alphas;
+    const LogProbabilityVector& genotype_log_priors;
+    const VBLikelihoodMatrix& log_likelihoods;
+
+    std::size_t num_samples() const noexcept { return log_likelihoods.size(); }
+    std::size_t num_genotypes() const noexcept { return genotype_log_priors.size(); }
+    std::size_t num_components() const noexcept { return log_likelihoods.front().num_components(); }
+};
+
+// Scratch space for one seed, so seeds can run concurrently
+struct VBWorkspace
+{
+    std::vector<std::vector<double>> row_weights;   // per sample, num components x num rows
+    std::vector<std::vector<double>> row_marginals; // per sample, num components x num rows
+    std::vector<double> log_responsibilities;       // num components x readBlockSize
+    std::vector<double> digamma_diffs;              // num components
+    LogProbabilityVector genotype_marginals;        // num genotypes
+
+    explicit VBWorkspace(const VBModel& model)
+    : row_weights(model.num_samples())
+    , row_marginals(model.num_samples())
+    , log_responsibilities(model.num_components() * readBlockSize)
+    , digamma_diffs(model.num_components())
+    , genotype_marginals(model.num_genotypes())
+    {
+        for (std::size_t s {0}; s < model.num_samples(); ++s) {
+            const auto num_row_components = model.num_components() * model.log_likelihoods[s].num_rows();
+            row_weights[s].resize(num_row_components);
+            row_marginals[s].resize(num_row_components);
+        }
+    }
+};
+
+MemoryFootprint estimate_seed_footprint(const VBModel& model) noexcept
+{
+    const auto K = model.num_components();
+    std::size_t result {(K * readBlockSize + K + 3 * model.num_genotypes()) * sizeof(double)};
+    for (const auto& sample_likelihoods : model.log_likelihoods) {
+        result += K * sample_likelihoods.num_reads() * sizeof(float);
+        result += 2 * K * sample_likelihoods.num_rows() * sizeof(double);
+    }
+    return result;
+}
+
+MemoryFootprint estimate_shared_footprint(const VBModel& model) noexcept
+{
+    return std::accumulate(std::cbegin(model.log_likelihoods), std::cend(model.log_likelihoods), MemoryFootprint {0},
+                           [] (auto curr, const auto& sample_likelihoods) { return curr + sample_likelihoods.footprint(); });
+}
+
+const float* alphas(const std::vector<float>& alphas, const std::size_t s, const std::size_t K) noexcept
+{
+    return alphas.data() + s * K;
+}
+
+double log_beta(const float* alphas, const std::size_t K) noexcept
+{
+    return maths::log_beta(alphas, alphas + K);
+}
+
+void compute_digamma_diffs(const float* alphas, const std::size_t K, std::vector<double>& result)
+{
+    using boost::math::digamma;
+    const auto a0 = std::accumulate(alphas, alphas + K, 0.0f);
+    const auto digamma_a0 = digamma(a0);
+    for (std::size_t k {0}; k < K; ++k) {
+        result[k] = digamma(alphas[k]) - digamma_a0;
+    }
+}
+
+// Each component's log responsibilities are E[ln pi_k] + sum {g} p(g) ln p(read | haplotype k of g). The
+// genotype posteriors are first summed into weights for the likelihood rows, so each row is added once.
+void update_responsibilities(const VBSampleLikelihoods& likelihoods,
+                             const float* alphas,
+                             const ProbabilityVector& genotype_posteriors,
+                             VBResponsibilityArray& result,
+                             std::vector<double>& row_weights,
+                             VBWorkspace& workspace)
+{
+    const auto K = likelihoods.num_components(), R = likelihoods.num_rows(), N = likelihoods.num_reads();
+    compute_digamma_diffs(alphas, K, workspace.digamma_diffs);
+    std::fill(std::begin(row_weights), std::end(row_weights), 0.0);
+    for (std::size_t g {0}; g < genotype_posteriors.size(); ++g) {
+        if (genotype_posteriors[g] > 0) {
+            for (std::size_t k {0}; k < K; ++k) {
+                row_weights[k * R + likelihoods.row(g, k)] += genotype_posteriors[g];
+            }
+        }
+    }
+    std::vector<const double*> log_responsibilities(K);
+    std::vector<float*> responsibilities(K);
+    for (std::size_t first_read {0}; first_read < N; first_read += readBlockSize) {
+        const auto num_reads = std::min(readBlockSize, N - first_read);
+        for (std::size_t k {0}; k < K; ++k) {
+            const auto block = workspace.log_responsibilities.data() + k * readBlockSize;
+            std::fill_n(block, num_reads, workspace.digamma_diffs[k]);
+            for (const auto row : likelihoods.component_rows(k)) {
+                const auto weight = row_weights[k * R + row];
+                if (weight > 0) maths::add_scaled(weight, likelihoods.likelihoods(row) + first_read, block, num_reads);
+            }
+            log_responsibilities[k] = block;
+            responsibilities[k] = result[k] + first_read;
+        }
+        maths::normalise_exp(log_responsibilities.data(), responsibilities.data(), K, num_reads);
+    }
+}
+
+void update_responsibilities(const VBModel& model,
+                             const std::vector<float>& posterior_alphas,
+                             const ProbabilityVector& genotype_posteriors,
+                             VBResponsibilityMatrix& result,
+                             VBWorkspace& workspace)
+{
+    const auto K = model.num_components();
+    for (std::size_t s {0}; s < model.num_samples(); ++s) {
+        update_responsibilities(model.log_likelihoods[s], alphas(posterior_alphas, s, K), genotype_posteriors,
+                                result[s], workspace.row_weights[s], workspace);
+    }
+}
+
+void update_alphas(const VBModel& model, const VBResponsibilityMatrix& responsibilities, std::vector<float>& result)
+{
+    const auto K = model.num_components();
+    for (std::size_t s {0}; s < model.num_samples(); ++s) {
+        for (std::size_t k {0}; k < K; ++k) {
+            result[s * K + k] = model.prior_alphas[s * K + k] + maths::sum(responsibilities[s][k], responsibilities[s].num_reads());
+        }
+    }
+}
+
+// workspace.genotype_marginals[g] = sum {s, k, n} tau_skn ln p(read n | haplotype k of g), from one
+// inner product per likelihood row and component
+void update_genotype_marginals(const VBModel& model, const VBResponsibilityMatrix& responsibilities, VBWorkspace& workspace)
+{
+    const auto K = model.num_components();
+    auto& result = workspace.genotype_marginals;
+    std::fill(std::begin(result), std::end(result), 0.0);
+    for (std::size_t s {0}; s < model.num_samples(); ++s) {
+        const auto& likelihoods = model.log_likelihoods[s];
+        const auto R = likelihoods.num_rows(), N = likelihoods.num_reads();
+        auto& row_marginals = workspace.row_marginals[s];
+        for (std::size_t k {0}; k < K; ++k) {
+            for (const auto row : likelihoods.component_rows(k)) {
+                row_marginals[k * R + row] = maths::inner_product(responsibilities[s][k], likelihoods.likelihoods(row), N);
+            }
+        }
+        for (std::size_t g {0}; g < result.size(); ++g) {
+            for (std::size_t k {0}; k < K; ++k) {
+                result[g] += row_marginals[k * R + likelihoods.row(g, k)];
+            }
+        }
+    }
+}
+
+void update_genotype_log_posteriors(const VBModel& model, const VBWorkspace& workspace, LogProbabilityVector& result)
+{
+    std::transform(std::cbegin(model.genotype_log_priors), std::cend(model.genotype_log_priors),
+                   std::cbegin(workspace.genotype_marginals), std::begin(result), std::plus<> {});
+    maths::normalise_logs(result);
+}
+
+// The terms of the evidence lower bound that do not involve the genotypes
+double calculate_sample_evidence_terms(const VBModel& model,
+                                       const std::vector<float>& posterior_alphas,
+                                       const VBResponsibilityMatrix& responsibilities)
+{
+    const auto K = model.num_components();
+    double result {0};
+    for (std::size_t s {0}; s < model.num_samples(); ++s) {
+        result += log_beta(alphas(posterior_alphas, s, K), K) - log_beta(alphas(model.prior_alphas, s, K), K);
+        for (std::size_t k {0}; k < K; ++k) {
+            result += maths::entropy(responsibilities[s][k], responsibilities[s].num_reads());
+        }
+    }
+    return result;
+}
+
+double calculate_genotype_evidence_terms(const VBModel& model,
+                                         const ProbabilityVector& genotype_posteriors,
+                                         const LogProbabilityVector& genotype_log_posteriors,
+                                         const VBWorkspace& workspace,
+                                         const double min_posterior = 0)
+{
+    double result {0};
+    for (std::size_t g {0}; g < model.num_genotypes(); ++g) {
+        if (genotype_posteriors[g] >= min_posterior) {
+            const auto w = model.genotype_log_priors[g] - genotype_log_posteriors[g] + workspace.genotype_marginals[g];
+            result += genotype_posteriors[g] * w;
+        }
+    }
+    return result;
+}
+
+// The converged log evidence of the reference seed of a run, which the run's other seeds are compared against.
+// The reference is fixed before the other seeds start, so whether a seed is abandoned depends only on that
+// seed, and not on which other seeds happen to have finished first.
+class LogEvidenceBound
+{
+public:
+    LogEvidenceBound() = default;
+    explicit LogEvidenceBound(const double reference) noexcept : reference_ {reference} {}
+
+    // true if a seed with this evidence, which improved by improvement after prev_improvement, cannot
+    // catch the reference seed. prev_improvement is infinite if unknown.
+    bool is_hopeless(const double log_evidence, const double improvement, const double prev_improvement) const noexcept
+    {
+        if (std::isinf(reference_) || std::isinf(prev_improvement) || improvement >= prev_improvement) return false;
+        const auto ratio = improvement / prev_improvement;
+        return log_evidence + improvement * ratio / (1 - ratio) < reference_ - maxLogEvidenceDeficit;
+    }
+
+private:
+    double reference_ = -std::numeric_limits<double>::infinity();
+};
+
+// Main algorithm - single seed
+
+VBSeedLatents
+run_variational_bayes(const VBModel& model,
+                      LogProbabilityVector genotype_log_posteriors,
+                      const VariationalBayesParameters& params,
+                      const LogEvidenceBound& bound = LogEvidenceBound {})
+{
+    assert(params.max_iterations > 0);
+    VBWorkspace workspace {model};
+    ProbabilityVector genotype_posteriors(genotype_log_posteriors.size());
+    maths::exp_each(genotype_log_posteriors.data(), genotype_posteriors.data(), genotype_posteriors.size());
+    auto posterior_alphas = model.prior_alphas;
+    VBResponsibilityMatrix responsibilities {};
+    responsibilities.reserve(model.num_samples());
+    for (const auto& sample_likelihoods : model.log_likelihoods) {
+        responsibilities.emplace_back(model.num_components(), sample_likelihoods.num_reads());
+    }
+    update_responsibilities(model, posterior_alphas, genotype_posteriors, responsibilities, workspace);
+    auto prev_evidence = std::numeric_limits<double>::lowest();
+    auto prev_improvement = std::numeric_limits<double>::infinity();
+    double sample_evidence_terms {0};
+    bool is_converged {false}, is_abandoned {false};
+    for (unsigned i {0}; i < params.max_iterations; ++i) {
+        update_genotype_marginals(model, responsibilities, workspace);
+        update_genotype_log_posteriors(model, workspace, genotype_log_posteriors);
+        maths::exp_each(genotype_log_posteriors.data(), genotype_posteriors.data(), genotype_posteriors.size());
+        update_alphas(model, responsibilities, posterior_alphas);
+        sample_evidence_terms = calculate_sample_evidence_terms(model, posterior_alphas, responsibilities);
+        const auto curr_evidence = sample_evidence_terms + calculate_genotype_evidence_terms(model, genotype_posteriors, genotype_log_posteriors,
+                                                                                             workspace, 1e-10);
+        if (curr_evidence <= prev_evidence || (curr_evidence - prev_evidence) < params.epsilon) {
+            is_converged = true;
+            break;
+        }
+        // The first improvement is from the lowest evidence, so says nothing about the convergence rate
+        const auto improvement = i > 0 ? curr_evidence - prev_evidence : std::numeric_limits<double>::infinity();
+        if (bound.is_hopeless(curr_evidence, improvement, prev_improvement)) {
+            is_abandoned = true;
+            break;
+        }
+        prev_evidence = curr_evidence;
+        prev_improvement = improvement;
+        // The final responsibilities would not be used
+        if (i + 1 < params.max_iterations) {
+            update_responsibilities(model, posterior_alphas, genotype_posteriors, responsibilities, workspace);
+        }
+    }
+    const auto log_evidence = sample_evidence_terms + calculate_genotype_evidence_terms(model, genotype_posteriors, genotype_log_posteriors, workspace);
+    return VBSeedLatents {
+        std::move(genotype_posteriors), std::move(genotype_log_posteriors),
+        std::move(posterior_alphas), std::move(responsibilities), log_evidence, is_converged, is_abandoned
+    };
+}
+
+bool run_seeds_in_parallel(const VBModel& model, const VariationalBayesParameters& params, const std::size_t num_seeds)
+{
+    if (!params.parallel_execution || num_seeds < 2) return false;
+    if (params.target_max_memory) {
+        const auto footprint = estimate_shared_footprint(model).bytes() + num_seeds * estimate_seed_footprint(model).bytes();
+        if (footprint > params.target_max_memory->bytes()) return false;
+    }
+    return true;
+}
+
+std::size_t max_element_index(const ProbabilityVector& probabilities) noexcept
+{
+    return std::distance(std::cbegin(probabilities), std::max_element(std::cbegin(probabilities), std::cend(probabilities)));
+}
+
+// For each MAP genotype, the seed with the greatest evidence that has it as the MAP genotype.
+// Abandoned seeds are not modes, as they stopped before reaching one.
+auto find_map_modes(const std::vector<VBSeedLatents>& latents)
+{
+    const auto num_genotypes = latents.front().genotype_posteriors.size();
+    std::vector<std::size_t> map_genotypes(num_genotypes, latents.size());
+    for (std::size_t i {0}; i < latents.size(); ++i) {
+        if (latents[i].is_abandoned) continue;
+        const auto map_genotype_idx = max_element_index(latents[i].genotype_posteriors);
+        if (map_genotypes[map_genotype_idx] == latents.size()
+            || latents[i].log_evidence > latents[map_genotypes[map_genotype_idx]].log_evidence) {
+            map_genotypes[map_genotype_idx] = i;
+        }
+    }
+    std::vector<std::size_t> result {};
+    result.reserve(latents.size());
+    for (std::size_t g {0}; g < num_genotypes; ++g) {
+        if (map_genotypes[g] < latents.size()) {
+            result.push_back(map_genotypes[g]);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+// Main algorithm - multiple seed
+
+std::vector<VBSeedLatents>
+run_variational_bayes(const std::vector<float>& prior_alphas,
+                      const LogProbabilityVector& genotype_log_priors,
+                      const VBLikelihoodMatrix& log_likelihoods,
+                      const VariationalBayesParameters& params,
+                      std::vector<LogProbabilityVector> seeds)
+{
+    assert(!seeds.empty());
+    assert(!log_likelihoods.empty());
+    assert(!genotype_log_priors.empty());
+    assert(prior_alphas.size() == log_likelihoods.size() * log_likelihoods.front().num_components());
+    const VBModel model {prior_alphas, genotype_log_priors, log_likelihoods};
+    std::vector<VBSeedLatents> result {};
+    result.reserve(seeds.size());
+    // The first seed is run to completion before the others, and is the reference they may be abandoned against
+    result.push_back(run_variational_bayes(model, std::move(seeds.front()), params));
+    LogEvidenceBound bound {};
+    if (result.front().is_converged) bound = LogEvidenceBound {result.front().log_evidence};
+    const auto first_other_seed = std::next(std::begin(seeds));
+    const auto num_other_seeds = static_cast<std::size_t>(std::distance(first_other_seed, std::end(seeds)));
+    // Seeds are only run concurrently on the calling workers, so threads are never oversubscribed
+    auto scheduler = run_seeds_in_parallel(model, params, num_other_seeds) ? WorkStealingScheduler::current() : nullptr;
+    if (scheduler) {
+        std::vector<std::future<VBSeedLatents>> seed_results {};
+        seed_results.reserve(num_other_seeds);
+        std::for_each(first_other_seed, std::end(seeds), [&] (auto& seed) {
+            seed_results.push_back(scheduler->push([&model, &params, &bound, &seed] () {
+                return run_variational_bayes(model, std::move(seed), params, bound);
+            }));
+        });
+        // Every seed must finish before returning as they reference this frame
+        std::exception_ptr error {};
+        for (auto& seed_result : seed_results) {
+            try {
+                result.push_back(scheduler->wait(seed_result));
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+    } else {
+        std::for_each(first_other_seed, std::end(seeds), [&] (auto& seed) {
+            result.push_back(run_variational_bayes(model, std::move(seed), params, bound));
+        });
+    }
+    return result;
+}
+
+void check_normalisation(ProbabilityVector& probabilities) noexcept
+{
+    const auto mass = std::accumulate(std::cbegin(probabilities), std::cend(probabilities), 0.0);
+    if (mass > 1.0) for (auto& p : probabilities) p /= mass;
+}
+
+ProbabilityVector compute_evidence_weighted_genotype_posteriors(const std::vector<VBSeedLatents>& latents)
+{
+    assert(!latents.empty());
+    const auto modes = find_map_modes(latents);
+    std::vector<double> mode_weights(modes.size());
+    std::transform(std::cbegin(modes), std::cend(modes), std::begin(mode_weights), [&] (auto mode) { return latents[mode].log_evidence; });
+    maths::normalise_exp(mode_weights);
+    const auto num_genotypes = latents.front().genotype_posteriors.size();
+    ProbabilityVector result(num_genotypes);
+    for (std::size_t i {0}; i < modes.size(); ++i) {
+        const auto mode_weight = mode_weights[i];
+        const auto& mode_genotype_posteriors = latents[modes[i]].genotype_posteriors;
+        std::transform(std::cbegin(mode_genotype_posteriors), std::cend(mode_genotype_posteriors),
+                       std::cbegin(result), std::begin(result),
+                       [mode_weight] (auto seed_posterior, auto curr_posterior) {
+                           return curr_posterior + mode_weight * seed_posterior;
+                       });
+    }
+    check_normalisation(result);
+    return result;
+}
+
+} // namespace detail
+} // namespace model
+} // namespace octopus
@@ -7,22 +7,16 @@
 #include <array>
 #include <vector>
 #include <algorithm>
-#include <numeric>
 #include <iterator>
 #include <cstddef>
 #include <utility>
 #include <cassert>
-#include <limits>
-#include <type_traits>
+#include <functional>
 
 #include <boost/optional.hpp>
-#include <boost/math/special_functions/digamma.hpp>
 
 #include "core/models/haplotype_likelihood_array.hpp"
-#include "utils/maths.hpp"
 #include "utils/memory_footprint.hpp"
-#include "utils/parallel_transform.hpp"
-
 
 /**
  *
@@ -39,8 +33,9 @@ struct VariationalBayesParameters
 {
     double epsilon = 0.05;
     unsigned max_iterations = 1000;
-    bool save_memory = false;
     bool parallel_execution = false;
+    // Seeds are only run concurrently if the memory they need together is below this
+    boost::optional<MemoryFootprint> target_max_memory = boost::none;
 };
 
 using ProbabilityVector    = std::vector<double>;
@@ -55,24 +50,25 @@ class VBReadLikelihoodArray
 {
 public:
     using BaseType = HaplotypeLikelihoodArray::LikelihoodVector;
-    
+
     VBReadLikelihoodArray() = default;
-    
+
     explicit VBReadLikelihoodArray(const BaseType&);
-    
+
     VBReadLikelihoodArray(const VBReadLikelihoodArray&)            = default;
     VBReadLikelihoodArray& operator=(const VBReadLikelihoodArray&) = default;
     VBReadLikelihoodArray(VBReadLikelihoodArray&&)                 = default;
     VBReadLikelihoodArray& operator=(VBReadLikelihoodArray&&)      = default;
-    
+
     ~VBReadLikelihoodArray() = default;
-    
+
     void operator=(const BaseType&);
     void operator=(std::reference_wrapper<const BaseType>);
     std::size_t size() const noexcept;
     BaseType::const_iterator begin() const noexcept;
     BaseType::const_iterator end() const noexcept;
     BaseType::value_type operator[](const std::size_t n) const noexcept;
+    const BaseType::value_type* data() const noexcept;
 
 private:
     const BaseType* likelihoods;
@@ -85,562 +81,157 @@ using VBGenotypeVector = std::vector<VBGenotype<K>>; // Per element per genotype
 template <std::size_t K>
 using VBReadLikelihoodMatrix = std::vector<VBGenotypeVector<K>>; // One element per sample
 
-using VBTau = std::vector<VBReadLikelihoodArray::BaseType::value_type>; // One element per read
-template <std::size_t K>
-using VBResponsibilityVector = std::array<VBTau, K>; // One element per haplotype in genotype (i.e. K)
-template <std::size_t K>
-using VBResponsibilityMatrix = std::vector<VBResponsibilityVector<K>>; // One element per sample
-
-template <std::size_t K>
-struct VBLatents
-{
-    ProbabilityVector genotype_posteriors;
-    LogProbabilityVector genotype_log_posteriors;
-    VBAlphaVector<K> alphas;
-    VBResponsibilityMatrix<K> responsibilities;
-};
-
-// Main VB method
-
-namespace detail {
-
-using VBExpandedLikelihood = std::vector<float>; // One element per genotype
-using VBExpandedGenotype = std::vector<VBExpandedLikelihood>; // One element per read
-template <std::size_t K>
-using VBExpandedGenotypeVector = std::array<VBExpandedGenotype, K>; // One element per haplotype in genotype
-template <std::size_t K>
-using VBExpandedLikelihoodMatrix = std::vector<VBExpandedGenotypeVector<K>>; // One element per sample
-
-template <std::size_t K>
-auto invert(const VBGenotypeVector<K>& likelihoods)
-{
-    static_assert(K > 0, "K == 0");
-    const auto num_genotypes = likelihoods.size();
-    assert(num_genotypes > 0);
-    const auto num_reads = likelihoods.front().front().size();
-    VBExpandedGenotypeVector<K> result {};
-    for (std::size_t k {0}; k < K; ++k) {
-        result[k] = VBExpandedGenotype(num_reads, VBExpandedLikelihood(num_genotypes));
-        for (std::size_t n {0}; n < num_reads; ++n) {
-            for (std::size_t g {0}; g < num_genotypes; ++g) {
-                result[k][n][g] = likelihoods[g][k][n];
-            }
-        }
-    }
-    return result;
-}
-
-template <std::size_t K>
-auto invert(const VBReadLikelihoodMatrix<K>& matrix)
-{
-    VBExpandedLikelihoodMatrix<K> result {};
-    result.reserve(matrix.size());
-    std::transform(std::cbegin(matrix), std::cend(matrix), std::back_inserter(result),
-                   [] (const auto& v) { return invert(v); });
-    return result;
-}
-
-inline ProbabilityVector& exp(const LogProbabilityVector& log_probabilities, ProbabilityVector& result) noexcept
-{
-    std::transform(std::cbegin(log_probabilities), std::cend(log_probabilities), std::begin(result),
-                   [] (const auto lp) noexcept { return std::exp(lp); });
-    return result;
-}
-
-inline ProbabilityVector exp(const LogProbabilityVector& log_probabilities)
+// The responsibilities of one sample, stored as one row of reads per mixture component
+class VBResponsibilityArray
 {
-    ProbabilityVector result(log_probabilities.size());
-    return exp(log_probabilities, result);
-}
+public:
+    VBResponsibilityArray() = default;
 
-inline auto sum(const VBAlpha<2>& alpha) noexcept
-{
-    return alpha[0] + alpha[1];
-}
+    VBResponsibilityArray(std::size_t num_components, std::size_t num_reads);
 
-inline auto sum(const VBAlpha<3>& alpha) noexcept
-{
-    return alpha[0] + alpha[1] + alpha[2];
-}
+    VBResponsibilityArray(const VBResponsibilityArray&)            = default;
+    VBResponsibilityArray& operator=(const VBResponsibilityArray&) = default;
+    VBResponsibilityArray(VBResponsibilityArray&&)                 = default;
+    VBResponsibilityArray& operator=(VBResponsibilityArray&&)      = default;
 
-template <std::size_t K>
-auto sum(const VBAlpha<K>& alpha) noexcept
-{
-    using T = typename VBAlpha<K>::value_type;
-    return std::accumulate(std::cbegin(alpha), std::cend(alpha), T {0});
-}
+    ~VBResponsibilityArray() = default;
 
-template <typename T>
-inline auto digamma_diff(const T a, const T b)
-{
-    using boost::math::digamma;
-    return digamma(a) - digamma(b);
-}
+    std::size_t num_components() const noexcept;
+    std::size_t num_reads() const noexcept;
+    const float* operator[](std::size_t k) const noexcept;
+    float* operator[](std::size_t k) noexcept;
 
-template <typename T, std::size_t K>
-auto compute_digamma_diffs(const std::array<T, K>& alphas)
-{
-    std::array<T, K> result;
-    const auto a0 = sum(alphas);
-    for (unsigned k {0}; k < K; ++k) {
-        result[k] = digamma_diff(alphas[k], a0);
-    }
-    return result;
-}
+private:
+    std::size_t num_components_ = 0, num_reads_ = 0;
+    std::vector<float> responsibilities_;
+};
 
-template <std::size_t K>
-auto count_reads(const VBGenotypeVector<K>& likelihoods) noexcept
-{
-    return likelihoods[0][0].size();
-}
+using VBResponsibilityMatrix = std::vector<VBResponsibilityArray>; // One element per sample
 
 template <std::size_t K>
-auto count_reads(const VBExpandedGenotypeVector<K>& likelihoods) noexcept
-{
-    return likelihoods[0].size();
-}
-
-template <typename ProbabilityVector_, std::size_t K>
-auto marginalise(const ProbabilityVector_& distribution, const VBGenotypeVector<K>& likelihoods,
-                 const unsigned k, const std::size_t n) noexcept
-{
-    using T = typename ProbabilityVector_::value_type;
-    return std::inner_product(std::cbegin(distribution), std::cend(distribution),
-                              std::cbegin(likelihoods), T {0}, std::plus<> {},
-                              [k, n] (const auto p, const auto& haplotype_likelihoods) noexcept {
-                                  return p * haplotype_likelihoods[k][n];
-                              });
-}
-
-template <typename T1, typename T2>
-auto inner_product(const T1& lhs, const T2& rhs) noexcept
-{
-    assert(std::distance(std::cbegin(lhs), std::cend(lhs)) == std::distance(std::cbegin(rhs), std::cend(rhs)));
-    using T = typename T1::value_type;
-    return std::inner_product(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs), T {0});
-}
-
-template <typename ProbabilityVector_, std::size_t K>
-auto marginalise(const ProbabilityVector_& distribution, const VBExpandedGenotypeVector<K>& likelihoods,
-                 const unsigned k, const std::size_t n) noexcept
-{
-    return inner_product(distribution, likelihoods[k][n]);
-}
-
-template <std::size_t K, typename T, typename ProbabilityVector_, typename VBLikelihoodGenotypeVector>
-void
-update_responsibilities_helper(VBResponsibilityVector<K>& result,
-                               const std::array<T, K>& al,
-                               const ProbabilityVector_& genotype_probabilities,
-                               const VBLikelihoodGenotypeVector& read_likelihoods,
-                               std::true_type)
-{
-    const auto N = count_reads(read_likelihoods);
-    std::array<T, K> ln_rho;
-    for (std::size_t n {0}; n < N; ++n) {
-        for (unsigned k {0}; k < K; ++k) {
-            ln_rho[k] = al[k] + marginalise(genotype_probabilities, read_likelihoods, k, n);
-        }
-        const auto ln_rho_norm = maths::fast_log_sum_exp(ln_rho);
-        for (unsigned k {0}; k < K; ++k) {
-            result[k][n] = maths::fast_exp(ln_rho[k] - ln_rho_norm);
-        }
-    }
-}
-
-template <std::size_t K, typename T, typename ProbabilityVector_>
-void
-update_responsibilities_helper(VBResponsibilityVector<K>& result,
-                               const std::array<T, K>& al,
-                               const ProbabilityVector_& genotype_probabilities,
-                               const VBExpandedGenotypeVector<K>& read_likelihoods,
-                               std::false_type)
-{
-    using LikelihoodType = VBExpandedLikelihood::value_type;
-    const std::vector<LikelihoodType> demoted_genotype_probabilities {std::cbegin(genotype_probabilities), std::cend(genotype_probabilities)};
-    update_responsibilities_helper(result, al, demoted_genotype_probabilities, read_likelihoods, std::true_type {});
-}
-
-template <std::size_t K, typename T, typename ProbabilityVector_>
-void
-update_responsibilities_helper(VBResponsibilityVector<K>& result,
-                               const std::array<T, K>& al,
-                               const ProbabilityVector_& genotype_probabilities,
-                               const VBExpandedGenotypeVector<K>& read_likelihoods)
-{
-    // For the expanded likelihood array, the inner product between likelihoods and genotype
-    // posteriors - a key bottleneck in the responsibility update calculate - can be vectorised.
-    // To ensure optimal execution the floating point types of the genotype probabilities and likelihoods should match.
-    using ProbabilityType = typename ProbabilityVector_::value_type;
-    using LikelihoodType = VBExpandedLikelihood::value_type;
-    update_responsibilities_helper(result, al, genotype_probabilities, read_likelihoods,
-                                   std::is_same<ProbabilityType, LikelihoodType> {});
-}
-
-template <std::size_t K, typename T, typename VBLikelihoodGenotypeVector, typename ProbabilityVector_>
-void
-update_responsibilities_helper(VBResponsibilityVector<K>& result,
-                               const std::array<T, K>& al,
-                               const ProbabilityVector_& genotype_probabilities,
-                               const VBLikelihoodGenotypeVector& read_likelihoods)
-{
-    update_responsibilities_helper(result, al, genotype_probabilities, read_likelihoods, std::true_type {});
-}
-
-template <std::size_t K, typename VBLikelihoodGenotypeVector>
-void update_responsibilities(VBResponsibilityVector<K>& result,
-                             const VBAlpha<K>& posterior_alphas,
-                             const ProbabilityVector& genotype_probabilities,
-                             const VBLikelihoodGenotypeVector& read_likelihoods)
-{
-    const auto al = compute_digamma_diffs(posterior_alphas);
-    update_responsibilities_helper(result, al, genotype_probabilities, read_likelihoods);
-}
-
-template <std::size_t K, typename VBLikelihoodMatrix>
-void update_responsibilities(VBResponsibilityMatrix<K>& result,
-                             const VBAlphaVector<K>& posterior_alphas,
-                             const ProbabilityVector& genotype_probabilities,
-                             const VBLikelihoodMatrix& read_likelihoods)
-{
-    const auto S = read_likelihoods.size();
-    for (std::size_t s {0}; s < S; ++s) {
-        update_responsibilities(result[s], posterior_alphas[s], genotype_probabilities, read_likelihoods[s]);
-    }
-}
-
-template <std::size_t K, typename VBLikelihoodVector_>
-VBResponsibilityVector<K>
-init_responsibilities(const VBAlpha<K>& prior_alphas,
-                      const ProbabilityVector& genotype_probabilities,
-                      const VBLikelihoodVector_& read_likelihoods)
+struct VBLatents
 {
-    const auto N = count_reads(read_likelihoods);
-    VBResponsibilityVector<K> result {};
-    for (auto& tau : result) tau.resize(N);
-    update_responsibilities(result, prior_alphas, genotype_probabilities, read_likelihoods);
-    return result;
-}
+    ProbabilityVector genotype_posteriors;
+    LogProbabilityVector genotype_log_posteriors;
+    VBAlphaVector<K> alphas;
+    VBResponsibilityMatrix responsibilities;
+};
 
-template <std::size_t K, typename VBLikelihoodMatrix>
-VBResponsibilityMatrix<K>
-init_responsibilities(const VBAlphaVector<K>& prior_alphas,
-                      const ProbabilityVector& genotype_probabilities,
-                      const VBLikelihoodMatrix& read_likelihoods)
-{
-    const auto S = read_likelihoods.size(); // num samples
-    VBResponsibilityMatrix<K> result {};
-    result.reserve(S);
-    for (std::size_t s {0}; s < S; ++s) {
-        result.push_back(init_responsibilities(prior_alphas[s], genotype_probabilities, read_likelihoods[s]));
-    }
-    return result;
-}
+// Main VB method
 
-template <typename T>
-inline auto sum(const std::vector<T>& values) noexcept
-{
-    return std::accumulate(std::cbegin(values), std::cend(values), T {});
-}
+namespace detail {
 
-template <std::size_t K>
-void update_alpha(VBAlpha<K>& alpha, const VBAlpha<K>& prior_alpha,
-                  const VBResponsibilityVector<K>& taus) noexcept
+/*
+    The read likelihoods of one sample, converted to single precision. Genotypes share haplotypes,
+    so there is one row of read likelihoods per distinct likelihood array rather than one per
+    genotype component, and a table of the row used by each component of each genotype. This is
+    what makes the updates cheap: the expected log likelihood of every genotype can be assembled
+    from one inner product per row and component, and the responsibilities from one scaled row
+    addition per row and component, however many genotypes there are.
+*/
+class VBSampleLikelihoods
 {
-    for (unsigned k {0}; k < K; ++k) {
-        alpha[k] = prior_alpha[k] + sum(taus[k]);
-    }
-}
+public:
+    using LogProbability = VBReadLikelihoodArray::BaseType::value_type;
 
-template <std::size_t K>
-void update_alphas(VBAlphaVector<K>& alphas, const VBAlphaVector<K>& prior_alphas,
-                   const VBResponsibilityMatrix<K>& responsibilities) noexcept
-{
-    const auto S = alphas.size();
-    assert(S == prior_alphas.size() && S == responsibilities.size());
-    for (std::size_t s {0}; s < S; ++s) {
-        update_alpha(alphas[s], prior_alphas[s], responsibilities[s]);
-    }
-}
+    VBSampleLikelihoods() = default;
 
-inline auto marginalise(const VBTau& responsibilities, const VBReadLikelihoodArray& likelihoods) noexcept
-{
-    assert(responsibilities.size() == likelihoods.size()); // num reads
-    return inner_product(responsibilities, likelihoods);
-}
+    // likelihoods[g * num_components + k] are the likelihoods of component k of genotype g
+    VBSampleLikelihoods(const std::vector<const VBReadLikelihoodArray*>& likelihoods, std::size_t num_components);
 
-template <std::size_t K>
-auto marginalise(const VBResponsibilityVector<K>& responsibilities,
-                 const VBGenotype<K>& read_likelihoods) noexcept
-{
-    double result {0};
-    for (unsigned k {0}; k < K; ++k) {
-        result += marginalise(responsibilities[k], read_likelihoods[k]);
-    }
-    return result;
-}
+    VBSampleLikelihoods(const VBSampleLikelihoods&)            = default;
+    VBSampleLikelihoods& operator=(const VBSampleLikelihoods&) = default;
+    VBSampleLikelihoods(VBSampleLikelihoods&&)                 = default;
+    VBSampleLikelihoods& operator=(VBSampleLikelihoods&&)      = default;
 
-template <std::size_t K>
-auto marginalise(const VBResponsibilityMatrix<K>& responsibilities,
-                 const VBReadLikelihoodMatrix<K>& read_likelihoods,
-                 const std::size_t g) noexcept
-{
-    double result {0};
-    const auto S = read_likelihoods.size(); // num samples
-    assert(S == responsibilities.size());
-    for (std::size_t s {0}; s < S; ++s) {
-        result += marginalise(responsibilities[s], read_likelihoods[s][g]);
-    }
-    return result;
-}
+    ~VBSampleLikelihoods() = default;
 
-template <std::size_t K>
-void update_genotype_log_posteriors(LogProbabilityVector& result,
-                                    const LogProbabilityVector& genotype_log_priors,
-                                    const VBResponsibilityMatrix<K>& responsibilities,
-                                    const VBReadLikelihoodMatrix<K>& read_likelihoods)
-{
-    const auto G = result.size();
-    for (std::size_t g {0}; g < G; ++g) {
-        result[g] = genotype_log_priors[g] + marginalise(responsibilities, read_likelihoods, g);
-    }
-    maths::normalise_logs(result);
-}
+    std::size_t num_genotypes() const noexcept;
+    std::size_t num_components() const noexcept;
+    std::size_t num_reads() const noexcept;
+    std::size_t num_rows() const noexcept;
 
-inline auto entropy(const VBTau& tau) noexcept
-{
-    using T = VBTau::value_type;
-    return -std::accumulate(std::cbegin(tau), std::cend(tau), T {0},
-                            [] (const auto curr, const auto t) noexcept { return curr + (t * std::log(t)); });
-}
+    std::size_t row(std::size_t g, std::size_t k) const noexcept;
+    const float* likelihoods(std::size_t row) const noexcept;
+    // The rows used by component k of some genotype, in increasing order
+    const std::vector<std::size_t>& component_rows(std::size_t k) const noexcept;
 
-// E [ln q(Z_s)]
-template <std::size_t K>
-auto sum_entropies(const VBResponsibilityVector<K>& taus) noexcept
-{
-    using T = VBTau::value_type;
-    return std::accumulate(std::cbegin(taus), std::cend(taus), T {0},
-                           [] (const auto curr, const auto& tau) noexcept { return curr + entropy(tau); });
-}
+    MemoryFootprint footprint() const noexcept;
 
-template <std::size_t K>
-auto calculate_evidence_lower_bound(const VBAlphaVector<K>& prior_alphas,
-                                    const VBAlphaVector<K>& posterior_alphas,
-                                    const LogProbabilityVector& genotype_log_priors,
-                                    const ProbabilityVector& genotype_posteriors,
-                                    const LogProbabilityVector& genotype_log_posteriors,
-                                    const VBResponsibilityMatrix<K>& taus,
-                                    const VBReadLikelihoodMatrix<K>& log_likelihoods,
-                                    const boost::optional<double> max_posterior_skip = boost::none)
-{
-    const auto G = genotype_log_priors.size();
-    const auto S = log_likelihoods.size();
-    double result {0};
-    for (std::size_t g {0}; g < G; ++g) {
-        if (!max_posterior_skip || genotype_posteriors[g] >= *max_posterior_skip) {
-            auto w = genotype_log_priors[g] - genotype_log_posteriors[g];
-            for (std::size_t s {0}; s < S; ++s) {
-                w += marginalise(taus[s], log_likelihoods[s][g]);
-            }
-            result += genotype_posteriors[g] * w;
-        }
-    }
-    for (std::size_t s {0}; s < S; ++s) {
-        result += (maths::log_beta(posterior_alphas[s]) - maths::log_beta(prior_alphas[s]));
-        result += sum_entropies(taus[s]);
-    }
-    return result;
-}
+private:
+    std::size_t num_components_ = 0, num_reads_ = 0, num_rows_ = 0;
+    std::vector<float> likelihoods_;
+    std::vector<std::size_t> rows_;
+    std::vector<std::vector<std::size_t>> component_rows_;
+};
 
-// Main algorithm - single seed
+using VBLikelihoodMatrix = std::vector<VBSampleLikelihoods>; // One element per sample
 
-// Starting iteration with given genotype_log_posteriors
-template <std::size_t K, typename VBLikelihoodMatrix1, typename VBLikelihoodMatrix2>
-VBLatents<K>
-run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
-                      const LogProbabilityVector& genotype_log_priors,
-                      const VBLikelihoodMatrix1& log_likelihoods1,
-                      const VBLikelihoodMatrix2& log_likelihoods2,
-                      LogProbabilityVector genotype_log_posteriors,
-                      const VariationalBayesParameters& params)
+// The latents inferred from one seed, with the number of mixture components only known at runtime
+struct VBSeedLatents
 {
-    assert(!prior_alphas.empty());
-    assert(!genotype_log_priors.empty());
-    assert(!log_likelihoods1.empty());
-    assert(log_likelihoods1.size() == log_likelihoods2.size());
-    assert(prior_alphas.size() == log_likelihoods1.size()); // num samples
-    assert(log_likelihoods1.front().size() == genotype_log_priors.size()); // num genotypes
-    assert(params.max_iterations > 0);
-    auto genotype_posteriors = exp(genotype_log_posteriors);
-    auto posterior_alphas = prior_alphas;
-    auto responsibilities = init_responsibilities<K>(posterior_alphas, genotype_posteriors, log_likelihoods2);
-    assert(responsibilities.size() == log_likelihoods1.size()); // num samples
-    auto prev_evidence = std::numeric_limits<double>::lowest();
-    for (unsigned i {0}; i < params.max_iterations; ++i) {
-        update_genotype_log_posteriors(genotype_log_posteriors, genotype_log_priors, responsibilities, log_likelihoods1);
-        exp(genotype_log_posteriors, genotype_posteriors);
-        update_alphas(posterior_alphas, prior_alphas, responsibilities);
-        auto curr_evidence = calculate_evidence_lower_bound(prior_alphas, posterior_alphas, genotype_log_priors,
-                                                            genotype_posteriors, genotype_log_posteriors, responsibilities,
-                                                            log_likelihoods1, 1e-10);
-        if (curr_evidence <= prev_evidence || (curr_evidence - prev_evidence) < params.epsilon) break;
-        prev_evidence = curr_evidence;
-        update_responsibilities(responsibilities, posterior_alphas, genotype_posteriors, log_likelihoods2);
-    }
-    return VBLatents<K> {
-        std::move(genotype_posteriors), std::move(genotype_log_posteriors),
-        std::move(posterior_alphas), std::move(responsibilities)
-    };
-}
+    ProbabilityVector genotype_posteriors;
+    LogProbabilityVector genotype_log_posteriors;
+    std::vector<float> alphas; // num samples x num components
+    VBResponsibilityMatrix responsibilities;
+    double log_evidence;
+    bool is_converged, is_abandoned;
+};
 
-// Not using inverted log likelihoods
-template <std::size_t K>
-VBLatents<K>
-run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
+// alphas are num samples x num components
+std::vector<VBSeedLatents>
+run_variational_bayes(const std::vector<float>& prior_alphas,
                       const LogProbabilityVector& genotype_log_priors,
-                      const VBReadLikelihoodMatrix<K>& log_likelihoods,
-                      LogProbabilityVector genotype_log_posteriors,
-                      const VariationalBayesParameters& params)
-{
-    return run_variational_bayes(prior_alphas, genotype_log_posteriors, log_likelihoods,
-                                 log_likelihoods, genotype_log_posteriors, params);
-}
+                      const VBLikelihoodMatrix& log_likelihoods,
+                      const VariationalBayesParameters& params,
+                      std::vector<LogProbabilityVector> seeds);
 
-// Main algorithm - multiple seed
+ProbabilityVector compute_evidence_weighted_genotype_posteriors(const std::vector<VBSeedLatents>& latents);
 
-template <std::size_t K>
-bool run_vb_with_matrix_inversion(const VBReadLikelihoodMatrix<K>& log_likelihoods,
-                                  const VariationalBayesParameters& params,
-                                  const std::vector<LogProbabilityVector>& seeds) noexcept
-{
-    return !params.save_memory;
-}
+void check_normalisation(ProbabilityVector& probabilities) noexcept;
 
 template <std::size_t K>
-std::vector<VBLatents<K>>
-run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
-                      const LogProbabilityVector& genotype_log_priors,
-                      const VBReadLikelihoodMatrix<K>& log_likelihoods,
-                      const VariationalBayesParameters& params,
-                      std::vector<LogProbabilityVector>&& seeds)
+VBSampleLikelihoods flatten(const VBGenotypeVector<K>& likelihoods)
 {
-    std::vector<VBLatents<K>> result {};
-    result.reserve(seeds.size());
-    if (run_vb_with_matrix_inversion(log_likelihoods, params, seeds)) {
-        const auto inverted_log_likelihoods = invert(log_likelihoods);
-        const auto func = [&] (auto&& seed) { return detail::run_variational_bayes(prior_alphas, genotype_log_priors, log_likelihoods,
-                                                                                   inverted_log_likelihoods, std::move(seed), params); };
-        if (params.parallel_execution) {
-            parallel_transform(std::make_move_iterator(std::begin(seeds)), std::make_move_iterator(std::end(seeds)),
-                               std::back_inserter(result), func);
-        } else {
-            for (auto& seed : seeds) result.push_back(func(std::move(seed)));
-        }
-    } else {
-        const auto func = [&] (auto&& seed) { return detail::run_variational_bayes(prior_alphas, genotype_log_priors, log_likelihoods,
-                                                                                   std::move(seed), params); };
-        if (params.parallel_execution) {
-            parallel_transform(std::make_move_iterator(std::begin(seeds)), std::make_move_iterator(std::end(seeds)),
-                               std::back_inserter(result), func);
-        } else {
-            for (auto& seed : seeds) result.push_back(func(std::move(seed)));
+    std::vector<const VBReadLikelihoodArray*> result {};
+    result.reserve(likelihoods.size() * K);
+    for (const auto& genotype : likelihoods) {
+        for (const auto& haplotype_likelihoods : genotype) {
+            result.push_back(std::addressof(haplotype_likelihoods));
         }
     }
-    return result;
+    return VBSampleLikelihoods {result, K};
 }
 
-// lower-bound calculation
-
 template <std::size_t K>
-auto calculate_evidence_lower_bound(const VBAlphaVector<K>& prior_alphas,
-                                    const LogProbabilityVector& genotype_log_priors,
-                                    const VBReadLikelihoodMatrix<K>& log_likelihoods,
-                                    const VBLatents<K>& latents)
-{
-    return calculate_evidence_lower_bound(prior_alphas, latents.alphas, genotype_log_priors,
-                                          latents.genotype_posteriors, latents.genotype_log_posteriors,
-                                          latents.responsibilities, log_likelihoods);
-    
-}
-
-inline void check_normalisation(ProbabilityVector& probabilities) noexcept
+VBLikelihoodMatrix flatten(const VBReadLikelihoodMatrix<K>& likelihoods)
 {
-    const auto mass = std::accumulate(std::cbegin(probabilities), std::cend(probabilities), 0.0);
-    if (mass > 1.0) for (auto& p : probabilities) p /= mass;
-}
-
-template <std::size_t K>
-void check_normalisation(VBLatents<K>& latents) noexcept
-{
-    check_normalisation(latents.genotype_posteriors);
-}
-
-inline std::size_t max_element_index(const ProbabilityVector& probabilities) noexcept
-{
-    return std::distance(std::cbegin(probabilities), std::max_element(std::cbegin(probabilities), std::cend(probabilities)));
-}
-
-template <std::size_t K>
-auto
-find_map_modes(const std::vector<VBLatents<K>>& latents, 
-               const std::vector<double>& log_evidences)
-{
-    const auto num_genotypes = latents.front().genotype_posteriors.size(); 
-    std::vector<std::size_t> map_genotypes(num_genotypes, latents.size());
-    for (std::size_t i {0}; i < latents.size(); ++i) {
-        const auto map_genotype_idx = max_element_index(latents[i].genotype_posteriors);
-        if (map_genotypes[map_genotype_idx] == latents.size() || log_evidences[i] > log_evidences[map_genotypes[map_genotype_idx]]) {
-            map_genotypes[map_genotype_idx] = i;
-        }
-    }
-    std::vector<std::size_t> result {};
-    result.reserve(latents.size());
-    for (std::size_t g {0}; g < num_genotypes; ++g) {
-        if (map_genotypes[g] < latents.size()) {
-            result.push_back(map_genotypes[g]);
-        }
-    }
+    VBLikelihoodMatrix result {};
+    result.reserve(likelihoods.size());
+    std::transform(std::cbegin(likelihoods), std::cend(likelihoods), std::back_inserter(result),
+                   [] (const auto& sample_likelihoods) { return flatten(sample_likelihoods); });
     return result;
 }
 
 template <std::size_t K>
-ProbabilityVector
-compute_evidence_weighted_genotype_posteriors(const std::vector<VBLatents<K>>& latents, 
-                                              const std::vector<double>& log_evidences)
+std::vector<float> flatten(const VBAlphaVector<K>& alphas)
 {
-    assert(!latents.empty());
-    assert(latents.size() == log_evidences.size());
-    const auto modes = find_map_modes(latents, log_evidences);
-    std::vector<double> mode_weights(modes.size());
-    std::transform(std::cbegin(modes), std::cend(modes), std::begin(mode_weights), [&] (auto mode) { return log_evidences[mode]; });
-    maths::normalise_exp(mode_weights);
-    const auto num_genotypes = latents.front().genotype_posteriors.size();    
-    ProbabilityVector result(num_genotypes);
-    for (std::size_t i {0}; i < modes.size(); ++i) {
-        const auto mode_weight = mode_weights[i];
-        const auto& mode_genotype_posteriors = latents[modes[i]].genotype_posteriors;
-        std::transform(std::cbegin(mode_genotype_posteriors), std::cend(mode_genotype_posteriors),
-                       std::cbegin(result), std::begin(result), 
-                       [mode_weight] (auto seed_posterior, auto curr_posterior) {
-                           return curr_posterior + mode_weight * seed_posterior;
-                       });
+    std::vector<float> result {};
+    result.reserve(alphas.size() * K);
+    for (const auto& alpha : alphas) {
+        result.insert(std::cend(result), std::cbegin(alpha), std::cend(alpha));
     }
-    check_normalisation(result);
     return result;
 }
 
 template <std::size_t K>
-std::vector<double>
-calculate_log_evidences(const std::vector<VBLatents<K>>& latents,
-                        const VBAlphaVector<K>& prior_alphas,
-                        const LogProbabilityVector& genotype_log_priors,
-                        const VBReadLikelihoodMatrix<K>& log_likelihoods)
+VBAlphaVector<K> expand(const std::vector<float>& alphas)
 {
-    std::vector<double> result(latents.size());
-    std::transform(std::cbegin(latents), std::cend(latents), std::begin(result),
-                   [&] (const auto& seed_latents) {
-                       return calculate_evidence_lower_bound(prior_alphas, genotype_log_priors, log_likelihoods, seed_latents);
-                   });
+    assert(alphas.size() % K == 0);
+    VBAlphaVector<K> result(alphas.size() / K);
+    for (std::size_t s {0}; s < result.size(); ++s) {
+        std::copy_n(std::next(std::cbegin(alphas), s * K), K, std::begin(result[s]));
+    }
     return result;
 }
 
@@ -663,12 +254,16 @@ run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
                       std::vector<LogProbabilityVector> seeds)
 {
     assert(!seeds.empty());
-    auto latents = detail::run_variational_bayes(prior_alphas, genotype_log_priors, log_likelihoods, params, std::move(seeds));
-    const auto log_evidences = detail::calculate_log_evidences(latents, prior_alphas, genotype_log_priors, log_likelihoods);
-    auto weighted_genotype_posteriors = detail::compute_evidence_weighted_genotype_posteriors(latents, log_evidences);
-    auto max_evidence_idx = detail::max_element_index(log_evidences);
-    detail::check_normalisation(latents[max_evidence_idx]);
-    return {std::move(latents[max_evidence_idx]), log_evidences[max_evidence_idx], std::move(weighted_genotype_posteriors)};
+    assert(prior_alphas.size() == log_likelihoods.size()); // num samples
+    auto latents = detail::run_variational_bayes(detail::flatten(prior_alphas), genotype_log_priors,
+                                                 detail::flatten(log_likelihoods), params, std::move(seeds));
+    auto weighted_genotype_posteriors = detail::compute_evidence_weighted_genotype_posteriors(latents);
+    auto& map_latents = *std::max_element(std::begin(latents), std::end(latents),
+                                          [] (const auto& lhs, const auto& rhs) { return lhs.log_evidence < rhs.log_evidence; });
+    detail::check_normalisation(map_latents.genotype_posteriors);
+    return {VBLatents<K> {std::move(map_latents.genotype_posteriors), std::move(map_latents.genotype_log_posteriors),
+                          detail::expand<K>(map_latents.alphas), std::move(map_latents.responsibilities)},
+            map_latents.log_evidence, std::move(weighted_genotype_posteriors)};
 }
 
 inline VBReadLikelihoodArray::VBReadLikelihoodArray(const BaseType& underlying_likelihoods)
@@ -704,31 +299,36 @@ inline VBReadLikelihoodArray::BaseType::value_type VBReadLikelihoodArray::operat
     return likelihoods->operator[](n);
 }
 
-template <std::size_t K>
-MemoryFootprint
-estimate_memory_requirement(const std::vector<SampleName>& samples,
-                            const HaplotypeLikelihoodArray& likelihoods,
-                            const std::size_t num_genotypes,
-                            VariationalBayesParameters params)
+inline const VBReadLikelihoodArray::BaseType::value_type* VBReadLikelihoodArray::data() const noexcept
 {
-    std::size_t bytes {};
-    for (const auto& sample : samples) {
-        bytes += sizeof(VBReadLikelihoodMatrix<K>);
-        bytes += sizeof(VBGenotypeVector<K>) * num_genotypes;
-        bytes += sizeof(VBResponsibilityMatrix<K>);
-        const auto num_likelihoods = likelihoods.num_likelihoods(sample);
-        const auto tau_bytes = num_likelihoods * sizeof(VBTau::value_type);
-        bytes += tau_bytes * K + sizeof(VBResponsibilityVector<K>);
-        if (!params.save_memory) {
-            bytes += sizeof(detail::VBExpandedLikelihoodMatrix<K>);
-            auto inverse_bytes = sizeof(detail::VBExpandedLikelihood::value_type) * num_genotypes + sizeof(detail::VBExpandedLikelihood);
-            inverse_bytes *= num_likelihoods;
-            inverse_bytes += sizeof(detail::VBExpandedGenotype);
-            bytes += K * inverse_bytes + sizeof(detail::VBExpandedGenotypeVector<K>);
-        }
-    }
-    return MemoryFootprint {bytes};
-};
+    return likelihoods->data();
+}
+
+inline VBResponsibilityArray::VBResponsibilityArray(const std::size_t num_components, const std::size_t num_reads)
+: num_components_ {num_components}
+, num_reads_ {num_reads}
+, responsibilities_(num_components * num_reads)
+{}
+
+inline std::size_t VBResponsibilityArray::num_components() const noexcept
+{
+    return num_components_;
+}
+
+inline std::size_t VBResponsibilityArray::num_reads() const noexcept
+{
+    return num_reads_;
+}
+
+inline const float* VBResponsibilityArray::operator[](const std::size_t k) const noexcept
+{
+    return responsibilities_.data() + k * num_reads_;
+}
+
+inline float* VBResponsibilityArray::operator[](const std::size_t k) noexcept
+{
+    return responsibilities_.data() + k * num_reads_;
+}
 
 } // namespace model
 } // namespace octopus
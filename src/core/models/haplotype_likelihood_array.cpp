@@ -4,6 +4,8 @@
 #include "haplotype_likelihood_array.hpp"
 
 #include <utility>
+#include <iterator>
+#include <algorithm>
 #include <cassert>
 
 namespace octopus {
@@ -14,9 +16,7 @@ HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(const unsigned max_haplotypes
                                                    const std::vector<SampleName>& samples)
 : cache_ {max_haplotypes}
 , sample_indices_ {samples.size()}
-{
-    mapping_positions_.resize(maxMappingPositions);
-}
+{}
 
 HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(HaplotypeLikelihoodModel likelihood_model,
                                                    unsigned max_haplotypes,
@@ -24,9 +24,7 @@ HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(HaplotypeLikelihoodModel like
 : likelihood_model_ {std::move(likelihood_model)}
 , cache_ {max_haplotypes}
 , sample_indices_ {samples.size()}
-{
-    mapping_positions_.resize(maxMappingPositions);
-}
+{}
 
 HaplotypeLikelihoodArray::ReadPacket::ReadPacket(Iterator first, Iterator last)
 : first {first}
@@ -42,7 +40,8 @@ HaplotypeLikelihoodArray::TemplatePacket::TemplatePacket(Iterator first, Iterato
 
 void HaplotypeLikelihoodArray::populate(const ReadMap& reads,
                                         const MappableBlock<Haplotype>& haplotypes,
-                                        boost::optional<FlankState> flank_state)
+                                        boost::optional<FlankState> flank_state,
+                                        HaplotypeLikelihoodCache* persistent_cache)
 {
     // This code is not very pretty because it is a bottleneck for the entire application.
     // We want to try a minimise memory allocations for the mapping.
@@ -53,48 +52,101 @@ void HaplotypeLikelihoodArray::populate(const ReadMap& reads,
     set_read_iterators_and_sample_indices(reads);
     assert(reads.size() == read_iterators_.size());
     const auto num_samples = reads.size();
-    // Precompute all read hashes so we don't have to recompute for each haplotype
-    std::vector<std::vector<KmerPerfectHashes>> read_hashes {};
-    read_hashes.reserve(num_samples);
+    // Precompute all read seeds so we don't have to recompute for each haplotype
+    std::vector<std::vector<MinimizerVector>> read_seeds {};
+    read_seeds.reserve(num_samples);
+    for (const auto& t : read_iterators_) {
+        std::vector<MinimizerVector> sample_read_seeds {};
+        sample_read_seeds.reserve(t.num_reads);
+        std::transform(t.first, t.last, std::back_inserter(sample_read_seeds), [] (const AlignedRead& read) {
+            return compute_minimizers<mapperKmerSize, mapperWindowSize>(read.sequence());
+        });
+        read_seeds.emplace_back(std::move(sample_read_seeds));
+    }
+    std::vector<std::vector<HaplotypeLikelihoodModel::AlignedReadConstRef>> sample_reads {};
+    sample_reads.reserve(num_samples);
     for (const auto& t : read_iterators_) {
-        std::vector<KmerPerfectHashes> sample_read_hashes {};
-        sample_read_hashes.reserve(t.num_reads);
-        std::transform(t.first, t.last, std::back_inserter(sample_read_hashes),
-                       [] (const AlignedRead& read) { return compute_kmer_hashes<mapperKmerSize>(read.sequence()); });
-        read_hashes.emplace_back(std::move(sample_read_hashes));
+        sample_reads.emplace_back(t.first, t.last);
+    }
+    std::vector<std::vector<HaplotypeLikelihoodCache::ReadKey>> read_keys {};
+    if (persistent_cache) {
+        read_keys.reserve(num_samples);
+        for (const auto& t : read_iterators_) {
+            std::vector<HaplotypeLikelihoodCache::ReadKey> sample_read_keys {};
+            sample_read_keys.reserve(t.num_reads);
+            std::transform(t.first, t.last, std::back_inserter(sample_read_keys),
+                           [=] (const AlignedRead& read) { return persistent_cache->key(read); });
+            read_keys.emplace_back(std::move(sample_read_keys));
+        }
     }
-    auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
-    const auto first_mapping_position = std::begin(mapping_positions_);
+    thread_local std::vector<HaplotypeLikelihoodModel::MappingPositionVector> mapping_positions {};
+    thread_local std::vector<HaplotypeLikelihoodModel::AlignedReadConstRef> uncached_reads {};
+    thread_local std::vector<std::size_t> uncached_read_indices {};
+    thread_local LikelihoodVector uncached_likelihoods {};
     for (const auto& haplotype : haplotypes) {
-        populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
+        // Haplotypes in a block mostly share sequence, so only seeds around differences are recomputed
+        haplotype_seeds_.assign(haplotype.sequence());
         auto itr = std::begin(cache_.emplace(std::piecewise_construct,
                                              std::forward_as_tuple(haplotype),
                                              std::forward_as_tuple(num_samples)).first->second);
         likelihood_model_.reset(haplotype, flank_state);
-        auto read_hash_itr = std::cbegin(read_hashes);
+        auto* cache_entry = persistent_cache ? &persistent_cache->entry(haplotype, flank_state) : nullptr;
+        auto read_seeds_itr = std::cbegin(read_seeds);
+        auto sample_reads_itr = std::cbegin(sample_reads);
+        auto read_keys_itr = std::cbegin(read_keys);
         for (const auto& t : read_iterators_) { // for each sample
-            *itr = std::vector<LogProbability>(t.num_reads);
-            std::transform(t.first, t.last, std::cbegin(*read_hash_itr), std::begin(*itr),
-                           [&] (const AlignedRead& read, const auto& read_hashes) {
-                               const auto last_mapping_position = map_query_to_target(read_hashes, haplotype_hashes,
-                                                                                      haplotype_mapping_counts,
-                                                                                      first_mapping_position,
-                                                                                      maxMappingPositions);
-                               reset_mapping_counts(haplotype_mapping_counts);
-                               return likelihood_model_.evaluate(read, first_mapping_position, last_mapping_position);
-                           });
-            ++read_hash_itr;
+            if (cache_entry) {
+                itr->resize(t.num_reads);
+                uncached_reads.clear();
+                uncached_read_indices.clear();
+                for (std::size_t i {0}; i < t.num_reads; ++i) {
+                    const auto cached_likelihood = persistent_cache->find(*cache_entry, (*read_keys_itr)[i]);
+                    if (cached_likelihood) {
+                        (*itr)[i] = *cached_likelihood;
+                    } else {
+                        uncached_reads.push_back((*sample_reads_itr)[i]);
+                        uncached_read_indices.push_back(i);
+                    }
+                }
+            }
+            const auto num_reads_to_evaluate = cache_entry ? uncached_reads.size() : t.num_reads;
+            if (num_reads_to_evaluate > 0) {
+                // Map all reads first so the likelihood model can align them together
+                mapping_positions.resize(num_reads_to_evaluate);
+                for (std::size_t i {0}; i < num_reads_to_evaluate; ++i) {
+                    const auto read_idx = cache_entry ? uncached_read_indices[i] : i;
+                    mapping_positions[i].resize(maxMappingPositions);
+                    mapping_positions[i].erase(haplotype_seeds_.map((*read_seeds_itr)[read_idx],
+                                                                    (*sample_reads_itr)[read_idx].get().sequence(),
+                                                                    std::begin(mapping_positions[i]),
+                                                                    maxMappingPositions),
+                                               std::end(mapping_positions[i]));
+                }
+                if (cache_entry) {
+                    likelihood_model_.evaluate(uncached_reads, mapping_positions, uncached_likelihoods);
+                    for (std::size_t i {0}; i < num_reads_to_evaluate; ++i) {
+                        const auto read_idx = uncached_read_indices[i];
+                        (*itr)[read_idx] = uncached_likelihoods[i];
+                        persistent_cache->insert(*cache_entry, (*read_keys_itr)[read_idx], uncached_likelihoods[i]);
+                    }
+                } else {
+                    likelihood_model_.evaluate(*sample_reads_itr, mapping_positions, *itr);
+                }
+            }
+            ++read_seeds_itr;
+            ++sample_reads_itr;
+            if (cache_entry) ++read_keys_itr;
             ++itr;
         }
-        clear_kmer_hash_table(haplotype_hashes);
     }
+    haplotype_seeds_.clear();
     likelihood_model_.clear();
     read_iterators_.clear();
 }
 
 void HaplotypeLikelihoodArray::populate(const TemplateMap& reads, const MappableBlock<Haplotype>& haplotypes,
-                                        boost::optional<FlankState> flank_state)
+                                        boost::optional<FlankState> flank_state,
+                                        HaplotypeLikelihoodCache* persistent_cache)
 {
     cache_.clear();
     if (cache_.bucket_count() < haplotypes.size()) {
@@ -103,52 +155,75 @@ void HaplotypeLikelihoodArray::populate(const TemplateMap& reads, const Mappable
     set_template_iterators_and_sample_indices(reads);
     assert(reads.size() == template_iterators_.size());
     const auto num_samples = reads.size();
-    // Precompute all read hashes so we don't have to recompute for each haplotype
-    std::vector<std::vector<std::vector<KmerPerfectHashes>>> template_hashes {};
-    template_hashes.reserve(num_samples);
+    // Precompute all read seeds so we don't have to recompute for each haplotype
+    std::vector<std::vector<std::vector<MinimizerVector>>> template_seeds {};
+    template_seeds.reserve(num_samples);
     for (const auto& t : template_iterators_) {
-        std::vector<std::vector<KmerPerfectHashes>> sample_read_hashes {};
-        sample_read_hashes.reserve(t.num_templates);
-        std::transform(t.first, t.last, std::back_inserter(sample_read_hashes), [] (const AlignedTemplate& reads) {
-            std::vector<KmerPerfectHashes> result {};
+        std::vector<std::vector<MinimizerVector>> sample_template_seeds {};
+        sample_template_seeds.reserve(t.num_templates);
+        std::transform(t.first, t.last, std::back_inserter(sample_template_seeds), [] (const AlignedTemplate& reads) {
+            std::vector<MinimizerVector> result {};
             result.reserve(reads.size());
-            for (const auto& read : reads) result.push_back(compute_kmer_hashes<mapperKmerSize>(read.sequence()));
+            for (const auto& read : reads) {
+                result.push_back(compute_minimizers<mapperKmerSize, mapperWindowSize>(read.sequence()));
+            }
             return result;
         });
-        template_hashes.emplace_back(std::move(sample_read_hashes));
+        template_seeds.emplace_back(std::move(sample_template_seeds));
+    }
+    std::vector<std::vector<HaplotypeLikelihoodCache::ReadKey>> template_keys {};
+    if (persistent_cache) {
+        template_keys.reserve(num_samples);
+        for (const auto& t : template_iterators_) {
+            std::vector<HaplotypeLikelihoodCache::ReadKey> sample_template_keys {};
+            sample_template_keys.reserve(t.num_templates);
+            std::transform(t.first, t.last, std::back_inserter(sample_template_keys),
+                           [=] (const AlignedTemplate& reads) { return persistent_cache->key(reads); });
+            template_keys.emplace_back(std::move(sample_template_keys));
+        }
     }
-    auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
     thread_local std::vector<HaplotypeLikelihoodModel::MappingPositionVector> mapping_positions {};
     for (const auto& haplotype : haplotypes) {
-        populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
+        haplotype_seeds_.assign(haplotype.sequence());
         auto itr = std::begin(cache_.emplace(std::piecewise_construct,
                                              std::forward_as_tuple(haplotype),
                                              std::forward_as_tuple(num_samples)).first->second);
         likelihood_model_.reset(haplotype, flank_state);
-        auto template_hash_itr = std::cbegin(template_hashes);
+        auto* cache_entry = persistent_cache ? &persistent_cache->entry(haplotype, flank_state) : nullptr;
+        auto template_seeds_itr = std::cbegin(template_seeds);
+        auto template_keys_itr = std::cbegin(template_keys);
         for (const auto& t : template_iterators_) { // for each sample
             *itr = std::vector<LogProbability>(t.num_templates);
-            std::transform(t.first, t.last, std::cbegin(*template_hash_itr), std::begin(*itr),
-                           [&] (const AlignedTemplate& read_template, const auto& template_hashes) {
+            const HaplotypeLikelihoodCache::ReadKey* template_key {cache_entry ? template_keys_itr->data() : nullptr};
+            std::transform(t.first, t.last, std::cbegin(*template_seeds_itr), std::begin(*itr),
+                           [&] (const AlignedTemplate& read_template, const auto& read_seeds) {
+                               if (cache_entry) {
+                                   const auto cached_likelihood = persistent_cache->find(*cache_entry, *template_key);
+                                   if (cached_likelihood) {
+                                       ++template_key;
+                                       return *cached_likelihood;
+                                   }
+                               }
                                mapping_positions.resize(read_template.size());
-                               assert(read_template.size() == template_hashes.size());
-                               for (std::size_t i {0}; i < template_hashes.size(); ++i) {
+                               assert(read_template.size() == read_seeds.size());
+                               for (std::size_t i {0}; i < read_seeds.size(); ++i) {
                                    mapping_positions[i].resize(maxMappingPositions);
-                                   mapping_positions[i].erase(map_query_to_target(template_hashes[i], haplotype_hashes,
-                                                                                  haplotype_mapping_counts,
-                                                                                  std::begin(mapping_positions[i]),
-                                                                                  maxMappingPositions),
+                                   mapping_positions[i].erase(haplotype_seeds_.map(read_seeds[i],
+                                                                                   read_template[i].sequence(),
+                                                                                   std::begin(mapping_positions[i]),
+                                                                                   maxMappingPositions),
                                                               std::end(mapping_positions[i]));
-                                   reset_mapping_counts(haplotype_mapping_counts);
                                }
-                               return likelihood_model_.evaluate(read_template, mapping_positions);
+                               const auto likelihood = likelihood_model_.evaluate(read_template, mapping_positions);
+                               if (cache_entry) persistent_cache->insert(*cache_entry, *template_key++, likelihood);
+                               return likelihood;
                            });
-            ++template_hash_itr;
+            ++template_seeds_itr;
+            if (cache_entry) ++template_keys_itr;
             ++itr;
         }
-        clear_kmer_hash_table(haplotype_hashes);
     }
+    haplotype_seeds_.clear();
     likelihood_model_.clear();
     read_iterators_.clear();
 }
@@ -293,6 +368,52 @@ merge_samples(const HaplotypeLikelihoodArray& haplotype_likelihoods)
     return result;
 }
 
+SavedHaplotypeLikelihoods
+save_likelihoods(const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                 const std::vector<Haplotype>& haplotypes,
+                 const ReadMap& reads, const GenomicRegion& region)
+{
+    SavedHaplotypeLikelihoods result {region, {}};
+    result.samples.reserve(reads.size());
+    for (const auto& p : reads) {
+        auto& sample_likelihoods = result.samples[p.first];
+        const auto overlapped_reads = overlap_range(p.second, region);
+        sample_likelihoods.reads.assign(std::cbegin(overlapped_reads), std::cend(overlapped_reads));
+        sample_likelihoods.likelihoods.reserve(haplotypes.size());
+        for (const auto& haplotype : haplotypes) {
+            const auto& likelihoods = haplotype_likelihoods(p.first, haplotype);
+            assert(likelihoods.size() == sample_likelihoods.reads.size());
+            sample_likelihoods.likelihoods.emplace(haplotype, likelihoods);
+        }
+    }
+    return result;
+}
+
+boost::optional<HaplotypeLikelihoodArray::LikelihoodVector>
+find_likelihoods(const SavedHaplotypeLikelihoods& saved, const SampleName& sample,
+                 const Haplotype& haplotype, const std::vector<AlignedRead>& reads)
+{
+    const auto sample_itr = saved.samples.find(sample);
+    if (sample_itr == std::cend(saved.samples)) return boost::none;
+    const auto& saved_reads = sample_itr->second.reads;
+    const auto& saved_likelihoods = sample_itr->second.likelihoods;
+    const auto is_container = [&] (const auto& p) { return contains(p.first, haplotype); };
+    const auto haplotype_itr = std::find_if(std::cbegin(saved_likelihoods), std::cend(saved_likelihoods), is_container);
+    if (haplotype_itr == std::cend(saved_likelihoods)) return boost::none;
+    // The saved haplotypes may differ outside of haplotype, so there is no single choice if several contain it
+    if (std::any_of(std::next(haplotype_itr), std::cend(saved_likelihoods), is_container)) return boost::none;
+    HaplotypeLikelihoodArray::LikelihoodVector result {};
+    result.reserve(reads.size());
+    for (const auto& read : reads) {
+        // Saved reads are in ReadContainer order
+        const auto read_itr = std::lower_bound(std::cbegin(saved_reads), std::cend(saved_reads), read,
+                                               [] (const AlignedRead& lhs, const AlignedRead& rhs) { return lhs < rhs; });
+        if (read_itr == std::cend(saved_reads) || read_itr->get() != read) return boost::none;
+        result.push_back(haplotype_itr->second[std::distance(std::cbegin(saved_reads), read_itr)]);
+    }
+    return result;
+}
+
 namespace debug {
 
 std::vector<std::reference_wrapper<const Haplotype>>
@@ -20,8 +20,9 @@
 #include "basics/aligned_template.hpp"
 #include "containers/mappable_block.hpp"
 #include "core/types/haplotype.hpp"
-#include "utils/kmer_mapper.hpp"
+#include "utils/minimizer_mapper.hpp"
 #include "haplotype_likelihood_model.hpp"
+#include "haplotype_likelihood_cache.hpp"
 
 namespace octopus {
 
@@ -58,10 +59,14 @@ public:
     
     ~HaplotypeLikelihoodArray() = default;
     
+    // If a persistent cache is given, likelihoods found there are reused rather than recomputed,
+    // and newly computed likelihoods are added to it
     void populate(const ReadMap& reads, const MappableBlock<Haplotype>& haplotypes,
-                  boost::optional<FlankState> flank_state = boost::none);
+                  boost::optional<FlankState> flank_state = boost::none,
+                  HaplotypeLikelihoodCache* persistent_cache = nullptr);
     void populate(const TemplateMap& reads, const MappableBlock<Haplotype>& haplotypes,
-                  boost::optional<FlankState> flank_state = boost::none);
+                  boost::optional<FlankState> flank_state = boost::none,
+                  HaplotypeLikelihoodCache* persistent_cache = nullptr);
     
     std::size_t num_likelihoods(const SampleName& sample) const;
     
@@ -89,7 +94,7 @@ public:
     merge_samples(const HaplotypeLikelihoodArray& haplotype_likelihoods);
     
 private:
-    static constexpr unsigned char mapperKmerSize {6};
+    static constexpr unsigned char mapperKmerSize {6}, mapperWindowSize {4};
     static constexpr std::size_t maxMappingPositions {10};
     
     HaplotypeLikelihoodModel likelihood_model_;
@@ -117,7 +122,7 @@ private:
     // Just to optimise population
     std::vector<ReadPacket> read_iterators_;
     std::vector<TemplatePacket> template_iterators_;
-    std::vector<std::size_t> mapping_positions_;
+    MinimizerIndex<mapperKmerSize, mapperWindowSize> haplotype_seeds_;
     
     void set_read_iterators_and_sample_indices(const ReadMap& reads);
     void set_template_iterators_and_sample_indices(const TemplateMap& reads);
@@ -149,6 +154,37 @@ merge_samples(const std::vector<SampleName>& samples,
 HaplotypeLikelihoodArray
 merge_samples(const HaplotypeLikelihoodArray& haplotype_likelihoods);
 
+/*
+    The likelihoods of some haplotypes for the reads overlapping a region, kept after the HaplotypeLikelihoodArray
+    they were computed in is cleared. The reads are referred to rather than copied, so must outlive this.
+ */
+struct SavedHaplotypeLikelihoods
+{
+    using ReadReferenceVector = std::vector<std::reference_wrapper<const AlignedRead>>;
+    using LikelihoodMap = std::unordered_map<Haplotype, HaplotypeLikelihoodArray::LikelihoodVector>;
+    
+    struct SampleLikelihoods
+    {
+        ReadReferenceVector reads;
+        LikelihoodMap likelihoods;
+    };
+    
+    GenomicRegion region;
+    std::unordered_map<SampleName, SampleLikelihoods> samples;
+};
+
+// The likelihoods must have been computed from the reads in reads that overlap region
+SavedHaplotypeLikelihoods
+save_likelihoods(const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                 const std::vector<Haplotype>& haplotypes,
+                 const ReadMap& reads, const GenomicRegion& region);
+
+// Likelihoods of the given reads for the saved haplotype that contains haplotype. None if there is not
+// exactly one such haplotype or a read was not saved.
+boost::optional<HaplotypeLikelihoodArray::LikelihoodVector>
+find_likelihoods(const SavedHaplotypeLikelihoods& saved, const SampleName& sample,
+                 const Haplotype& haplotype, const std::vector<AlignedRead>& reads);
+
 namespace debug {
 
 std::vector<std::reference_wrapper<const Haplotype>>
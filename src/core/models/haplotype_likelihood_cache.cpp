@@ -0,0 +1,305 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "haplotype_likelihood_cache.hpp"
+
+#include <array>
+#include <functional>
+#include <iterator>
+#include <algorithm>
+#include <cassert>
+
+#include <boost/functional/hash.hpp>
+
+namespace octopus {
+
+namespace {
+
+// Rough heap cost of one entry in an unordered_map node
+template <typename Key, typename Value>
+constexpr std::size_t node_bytes() noexcept
+{
+    return sizeof(Key) + sizeof(Value) + 3 * sizeof(void*);
+}
+
+} // namespace
+
+HaplotypeLikelihoodCache::HaplotypeLikelihoodCache(MemoryFootprint max_footprint)
+: max_bytes_ {max_footprint.bytes()}
+, bytes_ {0}
+, num_likelihoods_ {0}
+, entries_ {}
+, index_ {}
+, next_read_key_ {0}
+, reads_ {}
+, read_index_ {}
+, unreferenced_reads_ {}
+, num_hits_ {0}
+, num_misses_ {0}
+, num_evictions_ {0}
+{}
+
+HaplotypeLikelihoodCache::ReadKey HaplotypeLikelihoodCache::key(const AlignedRead& read)
+{
+    return key(std::array<std::reference_wrapper<const AlignedRead>, 1> {read}, hash(read));
+}
+
+HaplotypeLikelihoodCache::ReadKey HaplotypeLikelihoodCache::key(const AlignedTemplate& reads)
+{
+    std::size_t content_hash {reads.size()};
+    for (const auto& read : reads) {
+        boost::hash_combine(content_hash, hash(read));
+    }
+    return key(reads, content_hash);
+}
+
+HaplotypeLikelihoodCache::HaplotypeEntry&
+HaplotypeLikelihoodCache::entry(const Haplotype& haplotype, const boost::optional<FlankState>& flank_state)
+{
+    HaplotypeKey key {haplotype, flank_state};
+    auto itr = index_.find(key);
+    if (itr != std::cend(index_)) {
+        entries_.splice(std::cend(entries_), entries_, itr->second);
+        return *itr->second;
+    }
+    entries_.emplace_back();
+    auto& result = entries_.back();
+    result.key_bytes_ = estimate_bytes(haplotype);
+    itr = index_.emplace(std::move(key), std::prev(std::end(entries_))).first;
+    result.key_ = &itr->first;
+    bytes_ += result.key_bytes_;
+    shrink_to_fit();
+    return result;
+}
+
+boost::optional<HaplotypeLikelihoodCache::LogProbability>
+HaplotypeLikelihoodCache::find(const HaplotypeEntry& entry, const ReadKey read)
+{
+    const auto itr = entry.likelihoods_.find(read);
+    if (itr != std::cend(entry.likelihoods_)) {
+        ++num_hits_;
+        return itr->second;
+    } else {
+        ++num_misses_;
+        return boost::none;
+    }
+}
+
+void HaplotypeLikelihoodCache::insert(HaplotypeEntry& entry, const ReadKey read, const LogProbability likelihood)
+{
+    assert(!entries_.empty() && &entries_.back() == &entry);
+    const auto read_itr = reads_.find(read);
+    if (read_itr == std::end(reads_)) return; // the read content has been released
+    if (entry.likelihoods_.emplace(read, likelihood).second) {
+        ++num_likelihoods_;
+        bytes_ += node_bytes<ReadKey, LogProbability>();
+        auto& record = read_itr->second;
+        if (record.num_likelihoods++ == 0) {
+            unreferenced_reads_.erase(record.unreferenced);
+            record.evicted = false;
+        }
+        shrink_to_fit();
+        if (bytes_ > max_bytes_) {
+            // Everything left is referenced by this entry, so this likelihood cannot be kept
+            entry.likelihoods_.erase(read);
+            --num_likelihoods_;
+            bytes_ -= node_bytes<ReadKey, LogProbability>();
+            assert(record.num_likelihoods == 1);
+            record.num_likelihoods = 0;
+            release(read);
+        }
+    }
+}
+
+std::size_t HaplotypeLikelihoodCache::size() const noexcept
+{
+    return num_likelihoods_;
+}
+
+MemoryFootprint HaplotypeLikelihoodCache::footprint() const noexcept
+{
+    return bytes_;
+}
+
+std::size_t HaplotypeLikelihoodCache::num_hits() const noexcept
+{
+    return num_hits_;
+}
+
+std::size_t HaplotypeLikelihoodCache::num_misses() const noexcept
+{
+    return num_misses_;
+}
+
+std::size_t HaplotypeLikelihoodCache::num_evictions() const noexcept
+{
+    return num_evictions_;
+}
+
+void HaplotypeLikelihoodCache::clear() noexcept
+{
+    index_.clear();
+    entries_.clear();
+    reads_.clear();
+    read_index_.clear();
+    unreferenced_reads_.clear();
+    next_read_key_ = 0;
+    bytes_ = 0;
+    num_likelihoods_ = 0;
+}
+
+// private methods
+
+HaplotypeLikelihoodCache::ReadContent HaplotypeLikelihoodCache::make_content(const AlignedRead& read)
+{
+    return {read.mapped_region(), read.cigar(), read.sequence(), read.base_qualities(),
+            read.mapping_quality(), read.is_marked_reverse_mapped()};
+}
+
+std::size_t HaplotypeLikelihoodCache::hash(const AlignedRead& read)
+{
+    // Everything the likelihood model uses from the read
+    auto result = ReadHash {}(read);
+    using boost::hash_combine;
+    hash_combine(result, std::hash<AlignedRead::NucleotideSequence> {}(read.sequence()));
+    hash_combine(result, read.is_marked_reverse_mapped());
+    return result;
+}
+
+bool HaplotypeLikelihoodCache::is_same_content(const ReadContent& content, const AlignedRead& read) noexcept
+{
+    return content.mapping_quality == read.mapping_quality()
+        && content.is_reverse_mapped == read.is_marked_reverse_mapped()
+        && content.region == read.mapped_region()
+        && content.sequence == read.sequence()
+        && content.base_qualities == read.base_qualities()
+        && content.cigar == read.cigar();
+}
+
+template <typename Range>
+HaplotypeLikelihoodCache::ReadKey HaplotypeLikelihoodCache::key(const Range& reads, const std::size_t hash)
+{
+    const auto candidates = read_index_.equal_range(hash);
+    for (auto itr = candidates.first; itr != candidates.second; ++itr) {
+        const auto& content = reads_.at(itr->second).content;
+        if (content.size() == static_cast<std::size_t>(std::distance(std::cbegin(reads), std::cend(reads)))
+            && std::equal(std::cbegin(content), std::cend(content), std::cbegin(reads),
+                          [] (const ReadContent& lhs, const AlignedRead& rhs) { return is_same_content(lhs, rhs); })) {
+            auto& record = reads_.at(itr->second);
+            if (record.evicted) {
+                // About to be used again
+                unreferenced_reads_.splice(std::end(unreferenced_reads_), unreferenced_reads_, record.unreferenced);
+                record.evicted = false;
+            }
+            return itr->second;
+        }
+    }
+    ReadContentList content {};
+    for (const AlignedRead& read : reads) {
+        content.push_back(make_content(read));
+    }
+    const auto result = next_read_key_++;
+    const auto bytes = estimate_bytes(content) + node_bytes<ReadKey, ReadRecord>() + node_bytes<std::size_t, ReadKey>();
+    // Not referenced until a likelihood is inserted for it
+    unreferenced_reads_.push_back(result);
+    reads_.emplace(result, ReadRecord {std::move(content), hash, bytes, 0, std::prev(std::end(unreferenced_reads_)), false});
+    read_index_.emplace(hash, result);
+    bytes_ += bytes;
+    return result;
+}
+
+std::size_t HaplotypeLikelihoodCache::HaplotypeKeyHash::operator()(const HaplotypeKey& key) const noexcept
+{
+    auto result = HaplotypeHash {}(key.haplotype);
+    if (key.flank_state) {
+        boost::hash_combine(result, key.flank_state->lhs_flank);
+        boost::hash_combine(result, key.flank_state->rhs_flank);
+    }
+    return result;
+}
+
+bool HaplotypeLikelihoodCache::HaplotypeKeyEqual::operator()(const HaplotypeKey& lhs, const HaplotypeKey& rhs) const noexcept
+{
+    if (static_cast<bool>(lhs.flank_state) != static_cast<bool>(rhs.flank_state)) return false;
+    if (lhs.flank_state && (lhs.flank_state->lhs_flank != rhs.flank_state->lhs_flank
+                            || lhs.flank_state->rhs_flank != rhs.flank_state->rhs_flank)) {
+        return false;
+    }
+    return lhs.haplotype == rhs.haplotype;
+}
+
+std::size_t HaplotypeLikelihoodCache::estimate_bytes(const Haplotype& haplotype) noexcept
+{
+    // The haplotype is stored once in the index, along with its sequence and explicit alleles
+    return sizeof(HaplotypeEntry) + node_bytes<HaplotypeKey, EntryList::iterator>() + 2 * sequence_size(haplotype);
+}
+
+std::size_t HaplotypeLikelihoodCache::estimate_bytes(const ReadContentList& reads) noexcept
+{
+    std::size_t result {sizeof(ReadContentList)};
+    for (const auto& read : reads) {
+        result += sizeof(ReadContent) + read.sequence.size() + read.base_qualities.size()
+                  + read.cigar.size() * sizeof(CigarOperation);
+    }
+    return result;
+}
+
+void HaplotypeLikelihoodCache::evict_least_recently_used()
+{
+    assert(!entries_.empty());
+    auto& lru = entries_.front();
+    bytes_ -= lru.key_bytes_ + lru.likelihoods_.size() * node_bytes<ReadKey, LogProbability>();
+    num_likelihoods_ -= lru.likelihoods_.size();
+    for (const auto& p : lru.likelihoods_) {
+        auto& record = reads_.at(p.first);
+        assert(record.num_likelihoods > 0);
+        if (--record.num_likelihoods == 0) {
+            // Released before reads that have been keyed but not yet used
+            unreferenced_reads_.push_front(p.first);
+            record.unreferenced = std::begin(unreferenced_reads_);
+            record.evicted = true;
+        }
+    }
+    index_.erase(index_.find(*lru.key_));
+    entries_.pop_front();
+    ++num_evictions_;
+}
+
+void HaplotypeLikelihoodCache::release(const ReadKey read)
+{
+    const auto itr = reads_.find(read);
+    assert(itr != std::end(reads_) && itr->second.num_likelihoods == 0);
+    const auto candidates = read_index_.equal_range(itr->second.hash);
+    read_index_.erase(std::find_if(candidates.first, candidates.second, [read] (const auto& p) { return p.second == read; }));
+    bytes_ -= itr->second.bytes;
+    reads_.erase(itr);
+}
+
+void HaplotypeLikelihoodCache::release_first_unreferenced()
+{
+    assert(!unreferenced_reads_.empty());
+    const auto read = unreferenced_reads_.front();
+    unreferenced_reads_.pop_front();
+    release(read);
+}
+
+void HaplotypeLikelihoodCache::shrink_to_fit()
+{
+    // Reads with evicted likelihoods go before any more haplotypes are evicted. The most recently
+    // used entry may still be being populated so is never evicted.
+    while (bytes_ > max_bytes_) {
+        if (!unreferenced_reads_.empty() && reads_.at(unreferenced_reads_.front()).evicted) {
+            release_first_unreferenced();
+        } else if (entries_.size() > 1) {
+            evict_least_recently_used();
+        } else {
+            break;
+        }
+    }
+    // Then reads that have been keyed but not used yet
+    while (bytes_ > max_bytes_ && !unreferenced_reads_.empty()) {
+        release_first_unreferenced();
+    }
+}
+
+} // namespace octopus
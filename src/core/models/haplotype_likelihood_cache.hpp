@@ -0,0 +1,150 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef haplotype_likelihood_cache_hpp
+#define haplotype_likelihood_cache_hpp
+
+#include <cstddef>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "basics/cigar_string.hpp"
+#include "basics/aligned_read.hpp"
+#include "basics/aligned_template.hpp"
+#include "core/types/haplotype.hpp"
+#include "utils/memory_footprint.hpp"
+#include "haplotype_likelihood_model.hpp"
+
+namespace octopus {
+
+/*
+    HaplotypeLikelihoodCache remembers read likelihoods between successive populations of a
+    HaplotypeLikelihoodArray, so that read-haplotype pairs that reappear in a later active region
+    (e.g. when the haplotype generator backtracks or holds out alleles) are not aligned again.
+
+    Likelihoods are keyed on the full haplotype (region and sequence) and flank state, since both
+    influence read mapping and alignment, and on the read content that the likelihood model uses.
+    Each distinct read content is stored once and given an integer key, so a hash collision
+    between different reads cannot return the wrong likelihood, and is counted in the footprint.
+    Once the footprint exceeds the limit, read content whose likelihoods have all been evicted is
+    released first, then least recently used haplotypes are evicted, and last reads that have been
+    keyed but not used yet are released.
+ */
+class HaplotypeLikelihoodCache
+{
+public:
+    using FlankState     = HaplotypeLikelihoodModel::FlankState;
+    using LogProbability = HaplotypeLikelihoodModel::LogProbability;
+    using ReadKey        = std::size_t;
+
+    class HaplotypeEntry;
+
+    HaplotypeLikelihoodCache() = delete;
+
+    HaplotypeLikelihoodCache(MemoryFootprint max_footprint);
+
+    HaplotypeLikelihoodCache(const HaplotypeLikelihoodCache&)            = delete;
+    HaplotypeLikelihoodCache& operator=(const HaplotypeLikelihoodCache&) = delete;
+    HaplotypeLikelihoodCache(HaplotypeLikelihoodCache&&)                 = default;
+    HaplotypeLikelihoodCache& operator=(HaplotypeLikelihoodCache&&)      = default;
+
+    ~HaplotypeLikelihoodCache() = default;
+
+    // Reads with the same content get the same key while the content is kept. Keys are never reused,
+    // so a key stays safe to use after its content is released, but its likelihoods are no longer cached.
+    ReadKey key(const AlignedRead& read);
+    ReadKey key(const AlignedTemplate& reads);
+
+    // The returned entry remains valid until the next call to entry or clear
+    HaplotypeEntry& entry(const Haplotype& haplotype, const boost::optional<FlankState>& flank_state);
+
+    boost::optional<LogProbability> find(const HaplotypeEntry& entry, ReadKey read);
+    void insert(HaplotypeEntry& entry, ReadKey read, LogProbability likelihood);
+
+    std::size_t size() const noexcept;
+    MemoryFootprint footprint() const noexcept;
+
+    std::size_t num_hits() const noexcept;
+    std::size_t num_misses() const noexcept;
+    std::size_t num_evictions() const noexcept;
+
+    void clear() noexcept;
+
+private:
+    struct HaplotypeKey
+    {
+        Haplotype haplotype;
+        boost::optional<FlankState> flank_state;
+    };
+    struct HaplotypeKeyHash
+    {
+        std::size_t operator()(const HaplotypeKey& key) const noexcept;
+    };
+    struct HaplotypeKeyEqual
+    {
+        bool operator()(const HaplotypeKey& lhs, const HaplotypeKey& rhs) const noexcept;
+    };
+
+    struct ReadContent
+    {
+        GenomicRegion region;
+        CigarString cigar;
+        AlignedRead::NucleotideSequence sequence;
+        AlignedRead::BaseQualityVector base_qualities;
+        AlignedRead::MappingQuality mapping_quality;
+        bool is_reverse_mapped;
+    };
+    using ReadContentList = std::vector<ReadContent>; // one for each read in a template
+    struct ReadRecord
+    {
+        ReadContentList content;
+        std::size_t hash, bytes;
+        std::size_t num_likelihoods; // cached likelihoods that refer to this read
+        std::list<ReadKey>::iterator unreferenced; // valid if num_likelihoods == 0
+        bool evicted; // all likelihoods that referred to this read have been evicted
+    };
+
+    using EntryList = std::list<HaplotypeEntry>;
+
+    std::size_t max_bytes_, bytes_;
+    std::size_t num_likelihoods_;
+    EntryList entries_; // least recently used first
+    std::unordered_map<HaplotypeKey, EntryList::iterator, HaplotypeKeyHash, HaplotypeKeyEqual> index_;
+    ReadKey next_read_key_;
+    std::unordered_map<ReadKey, ReadRecord> reads_;
+    std::unordered_multimap<std::size_t, ReadKey> read_index_; // by content hash
+    std::list<ReadKey> unreferenced_reads_; // evicted reads, then unused reads, oldest first
+    std::size_t num_hits_, num_misses_, num_evictions_;
+
+    static ReadContent make_content(const AlignedRead& read);
+    static std::size_t hash(const AlignedRead& read);
+    static bool is_same_content(const ReadContent& content, const AlignedRead& read) noexcept;
+    template <typename Range> ReadKey key(const Range& reads, std::size_t hash);
+    static std::size_t estimate_bytes(const Haplotype& haplotype) noexcept;
+    static std::size_t estimate_bytes(const ReadContentList& reads) noexcept;
+    void evict_least_recently_used();
+    void release(ReadKey read);
+    void release_first_unreferenced();
+    void shrink_to_fit();
+};
+
+class HaplotypeLikelihoodCache::HaplotypeEntry
+{
+public:
+    HaplotypeEntry() = default;
+
+private:
+    std::unordered_map<ReadKey, LogProbability> likelihoods_;
+    std::size_t key_bytes_;
+    const HaplotypeKey* key_;
+
+    friend HaplotypeLikelihoodCache;
+};
+
+} // namespace octopus
+
+#endif
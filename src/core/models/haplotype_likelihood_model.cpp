@@ -202,17 +202,16 @@ bool is_in_range(const std::size_t mapping_position, const AlignedRead& read, co
 
 } // namespace
 
-template <typename InputIt, typename pHMM>
-HaplotypeLikelihoodModel::LogProbability
-max_score(const AlignedRead& read, const Haplotype& haplotype,
-          InputIt first_mapping_position, InputIt last_mapping_position,
-          const pHMM& hmm)
+// Calls f with each position the read should be evaluated at
+template <typename InputIt, typename pHMM, typename UnaryFunction>
+void
+for_each_mapping_position(const AlignedRead& read, const Haplotype& haplotype,
+                          InputIt first_mapping_position, InputIt last_mapping_position,
+                          const pHMM& hmm, UnaryFunction f)
 {
     assert(contains(haplotype, read));
-    using LogProbability = HaplotypeLikelihoodModel::LogProbability;
     using PositionType = typename std::iterator_traits<InputIt>::value_type;
     const auto original_mapping_position = static_cast<PositionType>(begin_distance(haplotype, read));
-    auto max_log_probability = std::numeric_limits<LogProbability>::lowest();
     bool is_original_position_mapped {false}, has_in_range_mapping_position {false};
     std::for_each(first_mapping_position, last_mapping_position, [&] (const auto position) {
         if (position == original_mapping_position) {
@@ -220,14 +219,12 @@ max_score(const AlignedRead& read, const Haplotype& haplotype,
         }
         if (is_in_range(position, read, haplotype, hmm)) {
             has_in_range_mapping_position = true;
-            auto p = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), position);
-            max_log_probability = std::max(static_cast<LogProbability>(p), max_log_probability);
+            f(position);
         }
     });
     if (!is_original_position_mapped && is_in_range(original_mapping_position, read, haplotype, hmm)) {
         has_in_range_mapping_position = true;
-        auto p = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), original_mapping_position);
-        max_log_probability = std::max(static_cast<LogProbability>(p), max_log_probability);
+        f(original_mapping_position);
     }
     if (!has_in_range_mapping_position) {
         const auto min_shift = num_out_of_range_bases(original_mapping_position, read, haplotype, hmm);
@@ -246,8 +243,22 @@ max_score(const AlignedRead& read, const Haplotype& haplotype,
                 throw HaplotypeLikelihoodModel::ShortHaplotypeError {haplotype, required_extension};
             }
         }
-        max_log_probability = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), final_mapping_position);
+        f(final_mapping_position);
     }
+}
+
+template <typename InputIt, typename pHMM>
+HaplotypeLikelihoodModel::LogProbability
+max_score(const AlignedRead& read, const Haplotype& haplotype,
+          InputIt first_mapping_position, InputIt last_mapping_position,
+          const pHMM& hmm)
+{
+    using LogProbability = HaplotypeLikelihoodModel::LogProbability;
+    auto max_log_probability = std::numeric_limits<LogProbability>::lowest();
+    for_each_mapping_position(read, haplotype, first_mapping_position, last_mapping_position, hmm, [&] (const auto position) {
+        auto p = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), position);
+        max_log_probability = std::max(static_cast<LogProbability>(p), max_log_probability);
+    });
     assert(max_log_probability > std::numeric_limits<LogProbability>::lowest() && max_log_probability <= 0);
     return max_log_probability;
 }
@@ -260,41 +271,52 @@ HaplotypeLikelihoodModel::evaluate(const AlignedRead& read,
     if (haplotype_ == nullptr) {
         throw std::runtime_error {"HaplotypeLikelihoodModel: no buffered Haplotype"};
     }
-    const auto is_forward = !read.is_marked_reverse_mapped();
-    HMM::ParameterType model {
-        haplotype_gap_open_penalities_,
-        haplotype_gap_extend_penalities_,
-        is_forward ? haplotype_snv_forward_mask_ : haplotype_snv_reverse_mask_,
-        is_forward ? haplotype_snv_forward_priors_ : haplotype_snv_reverse_priors_
-    };
-    if (haplotype_flank_state_) {
-        model.lhs_flank_size = haplotype_flank_state_->lhs_flank;
-        model.rhs_flank_size = haplotype_flank_state_->rhs_flank;
-    } else {
-        model.lhs_flank_size = 0;
-        model.rhs_flank_size = 0;
-    }
+    const auto model = make_hmm_parameters(!read.is_marked_reverse_mapped());
     hmm_.set(model);
     const auto ln_prob_given_mapped = max_score(read, *haplotype_, first_mapping_position, last_mapping_position, hmm_);
-    if (config_.use_mapping_quality) {
-        // This calculation is approximately
-        // p(read | hap) = p(read missmapped) p(read | hap, missmapped)
-        //                  + p(read correctly mapped) p(read | hap, correctly mapped)
-        // = p(read correctly mapped) p(read | hap, correctly mapped)
-        //      + p(read missmapped)
-        // assuming p(read | hap, missmapped) = 1
-        auto mapping_quality = read.mapping_quality();
-        if (config_.mapping_quality_cap_trigger && mapping_quality >= *config_.mapping_quality_cap_trigger) {
-            mapping_quality = config_.mapping_quality_cap;
+    return apply_mapping_quality(read, ln_prob_given_mapped);
+}
+
+void
+HaplotypeLikelihoodModel::evaluate(const std::vector<AlignedReadConstRef>& reads,
+                                   const std::vector<MappingPositionVector>& mapping_positions,
+                                   std::vector<LogProbability>& result) const
+{
+    if (haplotype_ == nullptr) {
+        throw std::runtime_error {"HaplotypeLikelihoodModel: no buffered Haplotype"};
+    }
+    assert(reads.size() == mapping_positions.size());
+    using Target = hmm::Target<AlignedRead::NucleotideSequence>;
+    thread_local std::vector<Target> targets {};
+    thread_local std::vector<std::size_t> target_reads {};
+    thread_local std::vector<LogProbability> target_scores {};
+    result.assign(reads.size(), std::numeric_limits<LogProbability>::lowest());
+    // SNV priors are strand specific, so each strand is evaluated separately
+    for (const bool is_forward : {true, false}) {
+        targets.clear();
+        target_reads.clear();
+        const auto model = make_hmm_parameters(is_forward);
+        hmm_.set(model);
+        for (std::size_t i {0}; i < reads.size(); ++i) {
+            const AlignedRead& read {reads[i].get()};
+            if (read.is_marked_reverse_mapped() == is_forward) continue;
+            for_each_mapping_position(read, *haplotype_, std::cbegin(mapping_positions[i]), std::cend(mapping_positions[i]), hmm_,
+                                      [&] (const auto position) {
+                targets.push_back({read.sequence(), read.base_qualities(), position});
+                target_reads.push_back(i);
+            });
+        }
+        hmm_.evaluate(targets, haplotype_->sequence(), target_scores);
+        for (std::size_t i {0}; i < targets.size(); ++i) {
+            auto& read_score = result[target_reads[i]];
+            read_score = std::max(target_scores[i], read_score);
         }
-        using octopus::maths::constants::ln10Div10;
-        const auto ln_prob_missmapped = -ln10Div10<> * mapping_quality;
-        const auto ln_prob_mapped = std::log(1.0 - std::exp(ln_prob_missmapped));
-        const auto result = maths::log_sum_exp(ln_prob_mapped + ln_prob_given_mapped, ln_prob_missmapped);
-        return result > -1e-15 ? 0.0 : result;
-    } else {
-        return ln_prob_given_mapped  > -1e-15 ? 0.0 : ln_prob_given_mapped;
     }
+    std::transform(std::cbegin(reads), std::cend(reads), std::cbegin(result), std::begin(result),
+                   [this] (const AlignedRead& read, const LogProbability ln_prob_given_mapped) {
+                       assert(ln_prob_given_mapped > std::numeric_limits<LogProbability>::lowest() && ln_prob_given_mapped <= 0);
+                       return apply_mapping_quality(read, ln_prob_given_mapped);
+                   });
 }
 
 HaplotypeLikelihoodModel::LogProbability
@@ -394,21 +416,43 @@ HaplotypeLikelihoodModel::align(const AlignedRead& read, MappingPositionItr firs
     if (haplotype_ == nullptr) {
         throw std::runtime_error {"HaplotypeLikelihoodModel: no buffered Haplotype"};
     }
-    const auto is_forward = !read.is_marked_reverse_mapped();
-    HMM::ParameterType model {haplotype_gap_open_penalities_,
-                              haplotype_gap_extend_penalities_,
-                              is_forward ? haplotype_snv_forward_mask_ : haplotype_snv_reverse_mask_,
-                              is_forward ? haplotype_snv_forward_priors_ : haplotype_snv_reverse_priors_};
+    const auto model = make_hmm_parameters(!read.is_marked_reverse_mapped());
+    hmm_.set(model);
+    auto result = compute_optimal_alignment(read, *haplotype_, first_mapping_position, last_mapping_position, hmm_);
+    result.likelihood = apply_mapping_quality(read, result.likelihood);
+    return result;
+}
+
+// private methods
+
+HaplotypeLikelihoodModel::HMM::ParameterType HaplotypeLikelihoodModel::make_hmm_parameters(const bool is_forward) const noexcept
+{
+    HMM::ParameterType result {
+        haplotype_gap_open_penalities_,
+        haplotype_gap_extend_penalities_,
+        is_forward ? haplotype_snv_forward_mask_ : haplotype_snv_reverse_mask_,
+        is_forward ? haplotype_snv_forward_priors_ : haplotype_snv_reverse_priors_
+    };
     if (haplotype_flank_state_) {
-        model.lhs_flank_size = haplotype_flank_state_->lhs_flank;
-        model.rhs_flank_size = haplotype_flank_state_->rhs_flank;
+        result.lhs_flank_size = haplotype_flank_state_->lhs_flank;
+        result.rhs_flank_size = haplotype_flank_state_->rhs_flank;
     } else {
-        model.lhs_flank_size = 0;
-        model.rhs_flank_size = 0;
+        result.lhs_flank_size = 0;
+        result.rhs_flank_size = 0;
     }
-    hmm_.set(model);
-    auto result = compute_optimal_alignment(read, *haplotype_, first_mapping_position, last_mapping_position, hmm_);
+    return result;
+}
+
+HaplotypeLikelihoodModel::LogProbability
+HaplotypeLikelihoodModel::apply_mapping_quality(const AlignedRead& read, const LogProbability ln_prob_given_mapped) const noexcept
+{
     if (config_.use_mapping_quality) {
+        // This calculation is approximately
+        // p(read | hap) = p(read missmapped) p(read | hap, missmapped)
+        //                  + p(read correctly mapped) p(read | hap, correctly mapped)
+        // = p(read correctly mapped) p(read | hap, correctly mapped)
+        //      + p(read missmapped)
+        // assuming p(read | hap, missmapped) = 1
         auto mapping_quality = read.mapping_quality();
         if (config_.mapping_quality_cap_trigger && mapping_quality >= *config_.mapping_quality_cap_trigger) {
             mapping_quality = config_.mapping_quality_cap;
@@ -416,12 +460,11 @@ HaplotypeLikelihoodModel::align(const AlignedRead& read, MappingPositionItr firs
         using octopus::maths::constants::ln10Div10;
         const auto ln_prob_missmapped = -ln10Div10<> * mapping_quality;
         const auto ln_prob_mapped = std::log(1.0 - std::exp(ln_prob_missmapped));
-        result.likelihood = maths::log_sum_exp(ln_prob_mapped + result.likelihood, ln_prob_missmapped);
-        result.likelihood = result.likelihood > -1e-15 ? 0.0 : result.likelihood;
+        const auto result = maths::log_sum_exp(ln_prob_mapped + ln_prob_given_mapped, ln_prob_missmapped);
+        return result > -1e-15 ? 0.0 : result;
     } else {
-        result.likelihood = result.likelihood > -1e-15 ? 0.0 : result.likelihood;
+        return ln_prob_given_mapped > -1e-15 ? 0.0 : ln_prob_given_mapped;
     }
-    return result;
 }
 
 HaplotypeLikelihoodModel make_haplotype_likelihood_model(const std::string label, bool use_mapping_quality)
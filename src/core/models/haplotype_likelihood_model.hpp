@@ -52,6 +52,7 @@ public:
     using MappingPosition       = std::size_t;
     using MappingPositionVector = std::vector<MappingPosition>;
     using MappingPositionItr    = MappingPositionVector::const_iterator;
+    using AlignedReadConstRef   = std::reference_wrapper<const AlignedRead>;
     
     struct Alignment
     {
@@ -93,6 +94,12 @@ public:
     LogProbability evaluate(const AlignedRead& read, const MappingPositionVector& mapping_positions) const;
     LogProbability evaluate(const AlignedRead& read, MappingPositionItr first_mapping_position, MappingPositionItr last_mapping_position) const;
     
+    // ln p(read | haplotype, model) for each read. Equivalent to evaluating each read separately, but reads
+    // are aligned together where possible which is much faster.
+    void evaluate(const std::vector<AlignedReadConstRef>& reads,
+                  const std::vector<MappingPositionVector>& mapping_positions,
+                  std::vector<LogProbability>& result) const;
+    
     // ln p(read template | haplotype, model)
     LogProbability evaluate(const AlignedTemplate& reads) const;
     LogProbability evaluate(const AlignedTemplate& reads, const std::vector<MappingPositionVector>& mapping_positions) const;
@@ -117,6 +124,9 @@ private:
     std::vector<Penalty> haplotype_gap_open_penalities_, haplotype_gap_extend_penalities_;
     Config config_;
     mutable HMM hmm_;
+    
+    HMM::ParameterType make_hmm_parameters(bool is_forward) const noexcept;
+    LogProbability apply_mapping_quality(const AlignedRead& read, LogProbability ln_prob_given_mapped) const noexcept;
 };
 
 class HaplotypeLikelihoodModel::ShortHaplotypeError : public std::runtime_error
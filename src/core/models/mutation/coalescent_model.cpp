@@ -82,7 +82,7 @@ CoalescentModel::LogProbability CoalescentModel::evaluate(const Haplotype& haplo
     return evaluate(count_segregating_sites(haplotype));
 }
 
-CoalescentModel::LogProbability CoalescentModel::evaluate(const std::vector<unsigned>& haplotype_indices) const
+CoalescentModel::LogProbability CoalescentModel::evaluate(const GenotypeIndex& haplotype_indices) const
 {
     return evaluate(count_segregating_sites(haplotype_indices));
 }
@@ -233,7 +233,7 @@ void CoalescentModel::fill_site_buffer(const Haplotype& haplotype) const
     site_buffer2_.clear();
 }
 
-void CoalescentModel::fill_site_buffer(const std::vector<unsigned>& haplotype_indices) const
+void CoalescentModel::fill_site_buffer(const GenotypeIndex& haplotype_indices) const
 {
     site_buffer1_.clear();
     std::fill(std::begin(index_flag_buffer_), std::end(index_flag_buffer_), false);
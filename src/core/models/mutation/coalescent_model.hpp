@@ -19,6 +19,7 @@
 #include <boost/optional.hpp>
 
 #include "core/types/haplotype.hpp"
+#include "core/types/genotype_index.hpp"
 #include "core/types/variant.hpp"
 #include "containers/mappable_block.hpp"
 #include "indel_mutation_model.hpp"
@@ -61,7 +62,7 @@ public:
     // ln p(haplotype(s))
     LogProbability evaluate(const Haplotype& haplotype) const;
     template <typename Container> double evaluate(const Container& haplotypes) const;
-    LogProbability evaluate(const std::vector<unsigned>& haplotype_indices) const;
+    LogProbability evaluate(const GenotypeIndex& haplotype_indices) const;
     
 private:
     using VariantReference = std::reference_wrapper<const Variant>;
@@ -96,7 +97,7 @@ private:
     
     void fill_site_buffer(const Haplotype& haplotype) const;
     template <typename Container> void fill_site_buffer(const Container& haplotypes) const;
-    void fill_site_buffer(const std::vector<unsigned>& haplotype_indices) const;
+    void fill_site_buffer(const GenotypeIndex& haplotype_indices) const;
     void fill_site_buffer_uncached(const Haplotype& haplotype) const;
     void fill_site_buffer_from_value_cache(const Haplotype& haplotype) const;
     void fill_site_buffer_from_address_cache(const Haplotype& haplotype) const;
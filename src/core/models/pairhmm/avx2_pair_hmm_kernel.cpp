@@ -0,0 +1,30 @@
+// Copyright (c) 2015-2019 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+// This file must be compiled with AVX2 enabled (-mavx2), and nothing in it may run before checking
+// the CPU supports AVX2.
+
+#include "simd_pair_hmm_kernel.hpp"
+
+#include "simd_pair_hmm_kernel_impl.hpp"
+#include "avx2_pair_hmm_impl.hpp"
+
+namespace octopus { namespace hmm { namespace simd { namespace detail {
+
+const PairHMMKernel* get_avx2_kernel(const int band_size, const ScorePrecision score_precision) noexcept
+{
+#if defined(AVX2_PHMM)
+    if (score_precision == ScorePrecision::int16) {
+        return get_kernel<AVX2PairHMMInstructionSet, 32, short, InterReadPairHMM<AVX2PairHMMInstructionSet<16, short>>>(band_size);
+    } else {
+        return get_kernel<AVX2PairHMMInstructionSet, 32, int>(band_size);
+    }
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace detail
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
@@ -16,11 +16,10 @@
 #include <immintrin.h>
 
 #include "utils/array_tricks.hpp"
-#include "system.hpp"
 
 namespace octopus { namespace hmm { namespace simd {
 
-#if defined(__AVX512F__) && defined(__AVX512BW__) && AVX512_AVAILABLE
+#if defined(__AVX512F__) && defined(__AVX512BW__)
 
 #define AVX512_PHMM
 
@@ -435,7 +434,7 @@ protected:
     }
 };
 
-#endif // defined(__AVX512F__) && defined(__AVX512BW__) && AVX512_AVAILABLE
+#endif // defined(__AVX512F__) && defined(__AVX512BW__)
 
 } // namespace simd
 } // namespace hmm
@@ -0,0 +1,34 @@
+// Copyright (c) 2015-2019 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+// This file must be compiled with AVX512F and AVX512BW enabled (-mavx512f -mavx512bw), and nothing
+// in it may run before checking the CPU supports both.
+
+#if __GNUC__ >= 12
+    #pragma GCC diagnostic ignored "-Wuninitialized" // false positive in GCC's own AVX512 intrinsics
+#endif
+
+#include "simd_pair_hmm_kernel.hpp"
+
+#include "simd_pair_hmm_kernel_impl.hpp"
+#include "avx512_pair_hmm_impl.hpp"
+
+namespace octopus { namespace hmm { namespace simd { namespace detail {
+
+const PairHMMKernel* get_avx512_kernel(const int band_size, const ScorePrecision score_precision) noexcept
+{
+#if defined(AVX512_PHMM)
+    if (score_precision == ScorePrecision::int16) {
+        return get_kernel<AVX512PairHMMInstructionSet, 64, short, InterReadPairHMM<AVX512PairHMMInstructionSet<32, short>>>(band_size);
+    } else {
+        return get_kernel<AVX512PairHMMInstructionSet, 64, int>(band_size);
+    }
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace detail
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
@@ -0,0 +1,305 @@
+// Copyright (c) 2015-2019 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef inter_read_pair_hmm_hpp
+#define inter_read_pair_hmm_hpp
+
+#if __GNUC__ >= 6
+    #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <limits>
+#include <vector>
+#include <cassert>
+
+#include <emmintrin.h>
+
+#include <boost/align/aligned_allocator.hpp>
+
+namespace octopus { namespace hmm { namespace simd {
+
+/*
+    InterReadPairHMM computes exactly the same banded alignment scores as PairHMM, but vectorises
+    across alignments rather than along the band: each SIMD lane holds a different (truth, target)
+    pair and each band cell is held in a separate vector. This removes all the shifts, inserts and
+    extracts of the anti-diagonal formulation, and lets many reads be scored against the same haplotype
+    in one pass.
+
+    All targets in a batch must have the same length. The band size is a runtime parameter.
+*/
+template <typename InstructionSet>
+class InterReadPairHMM : private InstructionSet
+{
+public:
+    using ScoreType = typename InstructionSet::ScoreType;
+
+    constexpr static int num_lanes = InstructionSet::band_size;
+
+    InterReadPairHMM() = default;
+
+    InterReadPairHMM(const InterReadPairHMM&)            = default;
+    InterReadPairHMM& operator=(const InterReadPairHMM&) = default;
+    InterReadPairHMM(InterReadPairHMM&&)                 = default;
+    InterReadPairHMM& operator=(InterReadPairHMM&&)      = default;
+
+    ~InterReadPairHMM() = default;
+
+    constexpr static const char* name() noexcept { return InstructionSet::name; }
+
+    // Each truth must have length target_len + 2 * band_size - 1. All arrays are indexed as for
+    // PairHMM::align, i.e. the truth-indexed arrays must already be offset to the alignment start.
+    // Up to num_lanes alignments can be scored at once; the scores are written to result.
+    void
+    align(const char* const* truths,
+          const char* const* targets,
+          const std::int8_t* const* qualities,
+          const int target_len,
+          const char* const* snv_masks,
+          const std::int8_t* const* snv_priors,
+          const std::int8_t* const* gap_opens,
+          const std::int8_t* const* gap_extends,
+          const short nuc_prior,
+          const int band_size,
+          const int num_alignments,
+          int* result) const
+    {
+        assert(num_alignments > 0 && num_alignments <= num_lanes);
+        assert(target_len > 0 && band_size > 0);
+        thread_local Workspace workspace {};
+        workspace.resize(target_len, band_size);
+        // Spare lanes just repeat the first alignment
+        const auto fill_lanes = [num_alignments] (const auto* const* sources, auto& lanes) {
+            for (int lane {0}; lane < num_lanes; ++lane) {
+                lanes[lane] = sources[lane < num_alignments ? lane : 0];
+            }
+        };
+        fill_lanes(truths, workspace.truth_sources);
+        fill_lanes(snv_masks, workspace.snv_mask_sources);
+        fill_lanes(snv_priors, workspace.snv_prior_sources);
+        fill_lanes(gap_opens, workspace.gap_open_sources);
+        fill_lanes(gap_extends, workspace.gap_extend_sources);
+        fill_lanes(targets, workspace.target_sources);
+        fill_lanes(qualities, workspace.quality_sources);
+        load(workspace, target_len, band_size);
+        const auto scores = align(workspace, target_len, static_cast<std::int8_t>(nuc_prior), band_size);
+        std::array<ScoreType, num_lanes> lane_scores;
+        std::memcpy(lane_scores.data(), &scores, sizeof(scores));
+        for (int lane {0}; lane < num_alignments; ++lane) {
+            result[lane] = (lane_scores[lane] - null_score_) >> trace_bits_;
+        }
+    }
+
+private:
+    using VectorType  = typename InstructionSet::VectorType;
+    using SmallVector = std::vector<VectorType, boost::alignment::aligned_allocator<VectorType>>;
+
+    static_assert(std::is_same<ScoreType, short>::value, "InterReadPairHMM only supports short scores");
+    static_assert(num_lanes % 8 == 0, "InterReadPairHMM lanes must be a multiple of 8");
+    static_assert(sizeof(VectorType) == num_lanes * sizeof(ScoreType), "InterReadPairHMM vectors must be tightly packed");
+
+    using InstructionSet::vectorise;
+    using InstructionSet::_add;
+    using InstructionSet::_and;
+    using InstructionSet::_andnot;
+    using InstructionSet::_or;
+    using InstructionSet::_cmpeq;
+    using InstructionSet::_min;
+
+    // These must match PairHMM
+    constexpr static ScoreType infinity_tolerance_ {0x7FF};
+    constexpr static ScoreType infinity_ {std::numeric_limits<ScoreType>::max() - infinity_tolerance_};
+    constexpr static int trace_bits_ {2};
+    constexpr static ScoreType n_score_ {2 << trace_bits_};
+    constexpr static ScoreType max_quality_score_ {64};
+    constexpr static ScoreType null_score_ {std::numeric_limits<ScoreType>::min()};
+
+    struct Workspace
+    {
+        std::array<const char*, num_lanes> truth_sources, snv_mask_sources, target_sources;
+        std::array<const std::int8_t*, num_lanes> snv_prior_sources, gap_open_sources, gap_extend_sources, quality_sources;
+        // truth-indexed
+        SmallVector truth, truth_nqual, gap_open, gap_extend, snv_mask, snv_prior;
+        // target-indexed, offset by the band size
+        SmallVector target, qualities;
+        // band states
+        SmallVector m1, i1, d1, m2, i2, d2;
+
+        void resize(const int target_len, const int band_size)
+        {
+            const auto truth_buffer_size  = static_cast<std::size_t>(target_len + 3 * band_size - 1);
+            const auto target_buffer_size = static_cast<std::size_t>(target_len + 2 * band_size);
+            for (auto* buffer : {&truth, &truth_nqual, &gap_open, &gap_extend, &snv_mask, &snv_prior}) {
+                buffer->resize(truth_buffer_size);
+            }
+            for (auto* buffer : {&target, &qualities}) {
+                buffer->resize(target_buffer_size);
+            }
+            for (auto* state : {&m1, &i1, &d1, &m2, &i2, &d2}) {
+                state->resize(band_size);
+            }
+        }
+    };
+
+    static ScoreType left_shift_bits(const int value) noexcept
+    {
+        // Wraps in the same way as the word shifts and inserts used by PairHMM
+        return static_cast<ScoreType>(value << trace_bits_);
+    }
+
+    // A plain array, as std::array<__m128i, 8> would be instantiated in every kernel translation unit
+    static void transpose(__m128i (&rows)[8]) noexcept
+    {
+        const auto a0 = _mm_unpacklo_epi16(rows[0], rows[1]), a1 = _mm_unpackhi_epi16(rows[0], rows[1]);
+        const auto a2 = _mm_unpacklo_epi16(rows[2], rows[3]), a3 = _mm_unpackhi_epi16(rows[2], rows[3]);
+        const auto a4 = _mm_unpacklo_epi16(rows[4], rows[5]), a5 = _mm_unpackhi_epi16(rows[4], rows[5]);
+        const auto a6 = _mm_unpacklo_epi16(rows[6], rows[7]), a7 = _mm_unpackhi_epi16(rows[6], rows[7]);
+        const auto b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2);
+        const auto b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3);
+        const auto b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6);
+        const auto b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7);
+        rows[0] = _mm_unpacklo_epi64(b0, b4); rows[1] = _mm_unpackhi_epi64(b0, b4);
+        rows[2] = _mm_unpacklo_epi64(b1, b5); rows[3] = _mm_unpackhi_epi64(b1, b5);
+        rows[4] = _mm_unpacklo_epi64(b2, b6); rows[5] = _mm_unpackhi_epi64(b2, b6);
+        rows[6] = _mm_unpacklo_epi64(b3, b7); rows[7] = _mm_unpackhi_epi64(b3, b7);
+    }
+
+    // Interleaves n sign-extended (and shifted) bytes from each lane's source into consecutive vectors.
+    // Blocks of 8 bytes x 8 lanes are transposed at once, rather than inserting one word at a time.
+    template <int shift, typename T>
+    static void
+    load_lanes(const std::array<const T*, num_lanes>& sources, const int n,
+               SmallVector& buffer, const int buffer_offset) noexcept
+    {
+        static_assert(sizeof(T) == 1, "load_lanes only supports byte sources");
+        __m128i rows[8];
+        for (int pos {0}; pos < n; pos += 8) {
+            const auto block_size = n - pos < 8 ? n - pos : 8; // not std::min; see simd_pair_hmm_kernel_impl.hpp
+            for (int group {0}; group < num_lanes / 8; ++group) {
+                for (int row {0}; row < 8; ++row) {
+                    const auto* source = sources[8 * group + row] + pos;
+                    std::int64_t bytes {0};
+                    std::memcpy(&bytes, source, block_size);
+                    const auto packed = _mm_cvtsi64_si128(bytes);
+                    rows[row] = _mm_slli_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(packed, packed), 8), shift);
+                }
+                transpose(rows);
+                for (int col {0}; col < block_size; ++col) {
+                    _mm_store_si128(reinterpret_cast<__m128i*>(buffer.data() + buffer_offset + pos + col) + group, rows[col]);
+                }
+            }
+        }
+    }
+
+    void load(Workspace& w, const int target_len, const int band_size) const noexcept
+    {
+        const auto truth_len = target_len + 2 * band_size - 1;
+        const auto truth_end = std::next(std::begin(w.truth), truth_len);
+        load_lanes<0>(w.truth_sources, truth_len, w.truth, 0);
+        std::fill(truth_end, std::end(w.truth), vectorise('N'));
+        const auto _inf = vectorise(infinity_);
+        const auto _nscore = vectorise(static_cast<ScoreType>(n_score_ - infinity_));
+        const auto _n = vectorise('N');
+        std::transform(std::cbegin(w.truth), std::cend(w.truth), std::begin(w.truth_nqual),
+                       [&] (const auto& truth) noexcept { return _add(_and(_cmpeq(truth, _n), _nscore), _inf); });
+        load_lanes<0>(w.snv_mask_sources, truth_len, w.snv_mask, 0);
+        std::fill(std::next(std::begin(w.snv_mask), truth_len), std::end(w.snv_mask), _n);
+        load_lanes<trace_bits_>(w.snv_prior_sources, truth_len, w.snv_prior, 0);
+        std::fill(std::next(std::begin(w.snv_prior), truth_len), std::end(w.snv_prior), vectorise(left_shift_bits(infinity_)));
+        // Gap penalties past the end of the truth repeat the last penalty
+        load_lanes<trace_bits_>(w.gap_open_sources, truth_len, w.gap_open, 0);
+        std::fill(std::next(std::begin(w.gap_open), truth_len), std::end(w.gap_open), w.gap_open[truth_len - 1]);
+        load_lanes<trace_bits_>(w.gap_extend_sources, truth_len, w.gap_extend, 0);
+        std::fill(std::next(std::begin(w.gap_extend), truth_len), std::end(w.gap_extend), w.gap_extend[truth_len - 1]);
+        const auto target_begin = std::next(std::begin(w.target), band_size);
+        const auto target_end = std::next(target_begin, target_len);
+        std::fill(std::begin(w.target), target_begin, _inf);
+        load_lanes<0>(w.target_sources, target_len, w.target, band_size);
+        std::fill(target_end, std::end(w.target), vectorise('0'));
+        const auto _max_quality = vectorise(left_shift_bits(max_quality_score_));
+        std::fill(std::begin(w.qualities), std::next(std::begin(w.qualities), band_size), _max_quality);
+        load_lanes<trace_bits_>(w.quality_sources, target_len, w.qualities, band_size);
+        std::fill(std::next(std::begin(w.qualities), band_size + target_len), std::end(w.qualities), _max_quality);
+    }
+
+    VectorType
+    match_score(const VectorType& target, const VectorType& truth, const VectorType& quality,
+                const VectorType& truth_nqual, const VectorType& snv_mask, const VectorType& snv_prior) const noexcept
+    {
+        const auto _snvmask = _cmpeq(target, snv_mask);
+        return _min(_andnot(_cmpeq(target, truth), _min(quality, _or(_and(_snvmask, snv_prior), _andnot(_snvmask, quality)))), truth_nqual);
+    }
+
+    VectorType align(Workspace& w, const int target_len, const std::int8_t nuc_prior, const int band_size) const noexcept
+    {
+        const auto _inf = vectorise(infinity_);
+        const auto _null = vectorise(null_score_);
+        const auto _nuc_prior = vectorise(left_shift_bits(nuc_prior));
+        std::fill(std::begin(w.m1), std::end(w.m1), _inf);
+        std::fill(std::begin(w.i1), std::end(w.i1), _inf);
+        std::fill(std::begin(w.d1), std::end(w.d1), _inf);
+        std::fill(std::begin(w.m2), std::end(w.m2), _inf);
+        std::fill(std::begin(w.i2), std::end(w.i2), _inf);
+        std::fill(std::begin(w.d2), std::end(w.d2), _inf);
+        auto minscore = _inf;
+        const auto last_band = band_size - 1;
+        for (int k {0}; k < target_len + band_size; ++k) {
+            // Cell j of the band is aligning target[k - j] with truth[k + j] (even step) or truth[k + j + 1] (odd step)
+            const auto* target = w.target.data() + k + band_size;
+            const auto* quals  = w.qualities.data() + k + band_size;
+            // k even. truth is current; target needs updating
+            if (k < band_size) {
+                w.m1[k] = _null;
+                w.m2[k] = _null;
+            }
+            if (k >= target_len) {
+                const auto idx = k - target_len;
+                minscore = _min(minscore, _min(w.m1[idx], _min(w.i1[idx], w.d1[idx])));
+            }
+            // Only the odd states are read, so the band can be updated in a single pass.
+            // The deletion state is shifted up the band, and may come from an insertion.
+            auto prev_d2 = _inf, prev_mi2 = _inf, prev_ge = _inf;
+            for (int j {0}; j < band_size; ++j) {
+                const auto t = k + j;
+                const auto m1 = _min(w.m1[j], _min(w.i1[j], w.d1[j]));
+                w.m1[j] = _add(m1, match_score(*(target - j), w.truth[t], *(quals - j), w.truth_nqual[t], w.snv_mask[t], w.snv_prior[t]));
+                const auto m2 = w.m2[j], i2 = w.i2[j];
+                const auto& gap_open = w.gap_open[t];
+                const auto& gap_extend = w.gap_extend[t];
+                w.d1[j] = j > 0 ? _min(_add(prev_d2, prev_ge), _add(prev_mi2, gap_open)) : _inf;
+                w.i1[j] = _add(_min(_add(i2, gap_extend), _add(m2, gap_open)), _nuc_prior);
+                prev_d2 = w.d2[j];
+                prev_mi2 = _min(m2, i2);
+                prev_ge = gap_extend;
+            }
+            // k odd. Truth needs updating; target is current
+            if (k >= target_len) {
+                const auto idx = k - target_len;
+                minscore = _min(minscore, _min(w.m2[idx], _min(w.i2[idx], w.d2[idx])));
+            }
+            // The insertion state is shifted down the band
+            for (int j {0}; j < band_size; ++j) {
+                const auto t = k + j + 1;
+                const auto m2 = _min(w.m2[j], _min(w.i2[j], w.d2[j]));
+                w.m2[j] = _add(m2, match_score(*(target - j), w.truth[t], *(quals - j), w.truth_nqual[t], w.snv_mask[t], w.snv_prior[t]));
+                const auto& gap_open = w.gap_open[t];
+                const auto& gap_extend = w.gap_extend[t];
+                w.d2[j] = _min(_add(w.d1[j], gap_extend), _add(_min(w.m1[j], w.i1[j]), gap_open));
+                w.i2[j] = j < last_band ? _add(_min(_add(w.i1[j + 1], gap_extend), _add(w.m1[j + 1], gap_open)), _nuc_prior) : _inf;
+            }
+        }
+        return minscore;
+    }
+};
+
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
+
+#endif
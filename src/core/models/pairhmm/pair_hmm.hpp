@@ -44,6 +44,14 @@ struct Alignment
     double likelihood;
 };
 
+template <typename Sequence>
+struct Target
+{
+    std::reference_wrapper<const Sequence> sequence;
+    std::reference_wrapper<const std::vector<std::uint8_t>> base_qualities;
+    std::size_t offset;
+};
+
 class HMMOverflow : public ProgramError
 {
 public:
@@ -781,6 +789,136 @@ simd_evaluate(const Sequence1& truth,
                                 std::is_same<decltype(hmm_params.lhs_flank_size), NullType> {});
 }
 
+template <typename PairHMMParameters>
+using is_inter_read_evaluable = std::integral_constant<bool,
+                                    !std::is_same<decltype(std::declval<PairHMMParameters>().snv_mask), NullType>::value
+                                    && std::is_class<std::decay_t<decltype(std::declval<PairHMMParameters>().gap_open)>>::value
+                                    && std::is_class<std::decay_t<decltype(std::declval<PairHMMParameters>().gap_extend)>>::value>;
+
+template <typename Sequence1,
+          typename Sequence2,
+          typename PairHMM,
+          typename PairHMMParameters>
+bool
+requires_flank_adjustment(const Sequence1& truth,
+                          const Sequence2& target,
+                          const std::size_t target_offset,
+                          const PairHMM& hmm,
+                          const PairHMMParameters& hmm_params,
+                          std::true_type) noexcept
+{
+    return false;
+}
+template <typename Sequence1,
+          typename Sequence2,
+          typename PairHMM,
+          typename PairHMMParameters>
+bool
+requires_flank_adjustment(const Sequence1& truth,
+                          const Sequence2& target,
+                          const std::size_t target_offset,
+                          const PairHMM& hmm,
+                          const PairHMMParameters& hmm_params,
+                          std::false_type) noexcept
+{
+    return use_adjusted_alignment_score(truth, target, target_offset, hmm, hmm_params);
+}
+
+// true if the alignment score is exactly the band score, i.e. what the inter-read HMM computes
+template <typename Sequence1,
+          typename Sequence2,
+          typename PairHMM,
+          typename PairHMMParameters>
+bool
+is_inter_read_evaluable_target(const Sequence1& truth,
+                               const Sequence2& target,
+                               const std::size_t target_offset,
+                               const PairHMM& hmm,
+                               const PairHMMParameters& hmm_params) noexcept
+{
+    const auto pad = hmm.band_size();
+    const auto truth_alignment_size = static_cast<int>(target.size() + 2 * pad - 1);
+    const auto alignment_offset = std::max(0, static_cast<int>(target_offset) - pad);
+    return !target.empty() && alignment_offset + truth_alignment_size <= static_cast<int>(truth.size())
+           && !requires_flank_adjustment(truth, target, target_offset, hmm, hmm_params,
+                                         std::is_same<decltype(hmm_params.lhs_flank_size), NullType> {});
+}
+
+template <typename Sequence1,
+          typename Sequence2,
+          typename PairHMM,
+          typename PairHMMParameters>
+void
+simd_evaluate(const Sequence1& truth,
+              const std::vector<Target<Sequence2>>& targets,
+              const PairHMM& hmm,
+              const PairHMMParameters& hmm_params,
+              std::vector<double>& result,
+              std::false_type)
+{
+    for (std::size_t i {0}; i < targets.size(); ++i) {
+        const auto& target = targets[i];
+        result[i] = simd_evaluate(truth, target.sequence.get(), target.base_qualities.get(), target.offset, hmm, hmm_params);
+    }
+}
+template <typename Sequence1,
+          typename Sequence2,
+          typename PairHMM,
+          typename PairHMMParameters>
+void
+simd_evaluate(const Sequence1& truth,
+              const std::vector<Target<Sequence2>>& targets,
+              const PairHMM& hmm,
+              const PairHMMParameters& hmm_params,
+              std::vector<double>& result,
+              std::true_type)
+{
+    constexpr int max_lanes {simd::max_inter_read_lanes};
+    const auto num_lanes = hmm.num_inter_read_lanes();
+    assert(num_lanes > 0 && num_lanes <= max_lanes);
+    thread_local std::vector<std::size_t> batch {};
+    batch.clear();
+    for (std::size_t i {0}; i < targets.size(); ++i) {
+        const auto& target = targets[i];
+        if (is_inter_read_evaluable_target(truth, target.sequence.get(), target.offset, hmm, hmm_params)) {
+            batch.push_back(i);
+        } else {
+            result[i] = simd_evaluate(truth, target.sequence.get(), target.base_qualities.get(), target.offset, hmm, hmm_params);
+        }
+    }
+    // Targets in the same inter-read batch must have the same length
+    std::stable_sort(std::begin(batch), std::end(batch), [&] (auto lhs, auto rhs) {
+        return targets[lhs].sequence.get().size() < targets[rhs].sequence.get().size();
+    });
+    const auto pad = hmm.band_size();
+    std::array<const char*, max_lanes> truths, sequences, snv_masks;
+    std::array<const std::int8_t*, max_lanes> qualities, snv_priors, gap_opens, gap_extends;
+    std::array<int, max_lanes> scores;
+    for (auto batch_itr = std::cbegin(batch); batch_itr != std::cend(batch);) {
+        const auto target_size = static_cast<int>(targets[*batch_itr].sequence.get().size());
+        int num_alignments {0};
+        for (; batch_itr != std::cend(batch) && num_alignments < num_lanes; ++batch_itr, ++num_alignments) {
+            const auto& target = targets[*batch_itr];
+            if (static_cast<int>(target.sequence.get().size()) != target_size) break;
+            const auto alignment_offset = std::max(0, static_cast<int>(target.offset) - pad);
+            truths[num_alignments]      = truth.data() + alignment_offset;
+            sequences[num_alignments]   = target.sequence.get().data();
+            qualities[num_alignments]   = reinterpret_cast<const std::int8_t*>(target.base_qualities.get().data());
+            snv_masks[num_alignments]   = data(hmm_params.snv_mask, alignment_offset);
+            snv_priors[num_alignments]  = data(hmm_params.snv_priors, alignment_offset);
+            gap_opens[num_alignments]   = data(hmm_params.gap_open, alignment_offset);
+            gap_extends[num_alignments] = data(hmm_params.gap_extend, alignment_offset);
+        }
+        hmm.align(truths.data(), sequences.data(), qualities.data(), target_size,
+                  snv_masks.data(), snv_priors.data(), gap_opens.data(), gap_extends.data(),
+                  hmm_params.nuc_prior, num_alignments, scores.data());
+        const auto batch_begin_itr = std::prev(batch_itr, num_alignments);
+        for (int i {0}; i < num_alignments; ++i) {
+            result[batch_begin_itr[i]] = -ln10Div10<> * static_cast<double>(scores[i]);
+        }
+    }
+}
+
 template <typename Sequence1,
           typename Sequence2,
           typename PairHMM,
@@ -855,6 +993,48 @@ evaluate(const Sequence1& truth,
     return evaluate(truth, target, target_base_qualities, hmm.band_size(), hmm, model_params);
 }
 
+// Evaluates each target against the same truth. Targets that are not trivially scored
+// are aligned together with the inter-read kernel where the HMM has one.
+template <typename Sequence1,
+          typename Sequence2,
+          typename PairHMM,
+          typename PairHMMParameters>
+void
+evaluate(const Sequence1& truth,
+         const std::vector<Target<Sequence2>>& targets,
+         const PairHMM& hmm,
+         const PairHMMParameters& model_params,
+         std::vector<double>& result,
+         const bool use_inter_read_hmm = true)
+{
+    thread_local std::vector<Target<Sequence2>> hmm_targets {};
+    thread_local std::vector<std::size_t> hmm_target_indices {};
+    thread_local std::vector<double> hmm_results {};
+    hmm_targets.clear();
+    hmm_target_indices.clear();
+    result.resize(targets.size());
+    for (std::size_t i {0}; i < targets.size(); ++i) {
+        const auto& target = targets[i];
+        const auto p = detail::try_naive_evaluate(truth, target.sequence.get(), target.base_qualities.get(), target.offset, model_params);
+        if (p.second) {
+            result[i] = p.first;
+        } else {
+            hmm_targets.push_back(target);
+            hmm_target_indices.push_back(i);
+        }
+    }
+    if (hmm_targets.empty()) return;
+    hmm_results.resize(hmm_targets.size());
+    if (use_inter_read_hmm && hmm.num_inter_read_lanes() > 0) {
+        detail::simd_evaluate(truth, hmm_targets, hmm, model_params, hmm_results, detail::is_inter_read_evaluable<PairHMMParameters> {});
+    } else {
+        detail::simd_evaluate(truth, hmm_targets, hmm, model_params, hmm_results, std::false_type {});
+    }
+    for (std::size_t i {0}; i < hmm_targets.size(); ++i) {
+        result[hmm_target_indices[i]] = hmm_results[i];
+    }
+}
+
 template <typename Sequence1,
           typename Sequence2,
           typename PairHMM,
@@ -897,7 +1077,7 @@ class PairHMM
 public:
     using ParameterType = Parameters;
     
-    PairHMM() = default;
+    PairHMM() { reset(8); }
     PairHMM(unsigned min_band_size) { reset(min_band_size); }
     PairHMM(const Parameters& params, unsigned min_band_size = 8)
     {
@@ -938,6 +1118,17 @@ public:
         return octopus::hmm::evaluate(truth, target, hmm_, *params_);
     }
     
+    template <typename Sequence1,
+              typename Sequence2>
+    void
+    evaluate(const std::vector<Target<Sequence1>>& targets,
+             const Sequence2& truth,
+             std::vector<double>& result) const
+    {
+        assert(params_);
+        octopus::hmm::evaluate(truth, targets, hmm_, *params_, result);
+    }
+    
     template <typename Sequence1,
               typename Sequence2>
     void
@@ -985,16 +1176,11 @@ public:
     }
     
 private:
-    using SIMDHMM = std::conditional_t<(BandSize > 0), simd::SimdPairHMM<BandSize, ScoreType>, simd::PairHMMWrapper>;
-    
-    static constexpr bool is_static = BandSize > 0 && !std::is_same<ScoreType, NullType>::value;
-    
-    SIMDHMM hmm_;
+    // Kernels are dispatched at runtime, so a fixed BandSize just overrides the requested band size
+    simd::PairHMMWrapper hmm_;
     const Parameters* params_ = nullptr;
     
-    void reset(unsigned min_band_size) { reset(min_band_size, std::conditional_t<is_static, std::true_type, std::false_type> {}); }
-    void reset(unsigned min_band_size, std::true_type) const noexcept {}
-    void reset(unsigned min_band_size, std::false_type) { hmm_.reset(min_band_size, score_precision()); }
+    void reset(unsigned min_band_size) { hmm_.reset(BandSize > 0 ? BandSize : min_band_size, score_precision()); }
     simd::PairHMMWrapper::ScorePrecision score_precision(NullType) const noexcept
     {
         return simd::PairHMMWrapper::ScorePrecision::int16;
@@ -325,7 +325,8 @@ private:
                          const char* snv_mask,
                          const std::int8_t* caps) const noexcept
     {
-        return (snv_mask[x] == target[y]) ? std::min(quals[y], caps[x]) : quals[y];
+        // Not std::min, which would be instantiated identically in each instruction set's kernel translation unit
+        return (snv_mask[x] == target[y] && caps[x] < quals[y]) ? caps[x] : quals[y];
     }
     auto
     get_mismatch_quality(const char* target,
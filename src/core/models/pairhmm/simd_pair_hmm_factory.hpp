@@ -11,6 +11,7 @@
 #include "avx2_pair_hmm_impl.hpp"
 #include "avx512_pair_hmm_impl.hpp"
 #include "rolling_initializer.hpp"
+#include "inter_read_pair_hmm.hpp"
 
 namespace octopus { namespace hmm { namespace simd {
 
@@ -103,6 +104,15 @@ constexpr auto make_simd_pair_hmm() { return SimdPairHMM<BandSize, ScoreType, In
 
 constexpr auto make_fastest_simd_pair_hmm() { return make_simd_pair_hmm<8, short, InsertRollingInitializer>(); }
 
+// The inter-read HMM uses one lane per alignment, so wider vectors just mean larger batches
+#if defined(AVX512_PHMM)
+using InterReadSimdPairHMM = InterReadPairHMM<AVX512PairHMMInstructionSet<32, short>>;
+#elif defined(AVX2_PHMM)
+using InterReadSimdPairHMM = InterReadPairHMM<AVX2PairHMMInstructionSet<16, short>>;
+#else
+using InterReadSimdPairHMM = InterReadPairHMM<SSE2PairHMMInstructionSet<8, short>>;
+#endif
+
 } // namespace simd
 } // namespace hmm
 } // namespace octopus
@@ -0,0 +1,108 @@
+// Copyright (c) 2015-2019 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "simd_pair_hmm_kernel.hpp"
+
+#include <ostream>
+#include <atomic>
+#include <stdexcept>
+#include <cassert>
+
+namespace octopus { namespace hmm { namespace simd {
+
+std::ostream& operator<<(std::ostream& os, const InstructionSet isa)
+{
+    switch (isa) {
+        case InstructionSet::sse2: os << "SSE2"; break;
+        case InstructionSet::avx2: os << "AVX2"; break;
+        case InstructionSet::avx512: os << "AVX512"; break;
+    }
+    return os;
+}
+
+namespace {
+
+bool cpu_supports(const InstructionSet isa) noexcept
+{
+    __builtin_cpu_init();
+    switch (isa) {
+        case InstructionSet::sse2: return true;
+        case InstructionSet::avx2: return __builtin_cpu_supports("avx2");
+        case InstructionSet::avx512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        default: return false;
+    }
+}
+
+const PairHMMKernel* get_kernel(const InstructionSet isa, const int band_size, const ScorePrecision score_precision) noexcept
+{
+    switch (isa) {
+        case InstructionSet::sse2: return detail::get_sse2_kernel(band_size, score_precision);
+        case InstructionSet::avx2: return detail::get_avx2_kernel(band_size, score_precision);
+        case InstructionSet::avx512: return detail::get_avx512_kernel(band_size, score_precision);
+        default: return nullptr;
+    }
+}
+
+// Calling into an instruction set's translation unit is only safe if the CPU supports it
+bool is_compiled(const InstructionSet isa) noexcept
+{
+    return get_kernel(isa, max_kernel_band_size, ScorePrecision::int16) != nullptr;
+}
+
+// Function local so kernels can be requested during static initialisation
+std::atomic<InstructionSet>& instruction_set()
+{
+    static std::atomic<InstructionSet> result {fastest_supported_instruction_set()};
+    return result;
+}
+
+} // namespace
+
+bool is_supported(const InstructionSet isa) noexcept
+{
+    return cpu_supports(isa) && is_compiled(isa);
+}
+
+InstructionSet fastest_supported_instruction_set() noexcept
+{
+    if (is_supported(InstructionSet::avx512)) {
+        return InstructionSet::avx512;
+    } else if (is_supported(InstructionSet::avx2)) {
+        return InstructionSet::avx2;
+    } else {
+        return InstructionSet::sse2;
+    }
+}
+
+void set_instruction_set(const InstructionSet isa)
+{
+    if (!is_supported(isa)) {
+        throw std::invalid_argument {"set_instruction_set: unsupported instruction set"};
+    }
+    instruction_set() = isa;
+}
+
+InstructionSet get_instruction_set() noexcept
+{
+    return instruction_set();
+}
+
+const PairHMMKernel& get_kernel(const int band_size, const ScorePrecision score_precision)
+{
+    assert(min_kernel_band_size <= band_size && band_size <= max_kernel_band_size);
+    auto isa = get_instruction_set();
+    auto result = get_kernel(isa, band_size, score_precision);
+    // Small bands may not fill a wide vector
+    while (!result && isa != InstructionSet::sse2) {
+        isa = isa == InstructionSet::avx512 ? InstructionSet::avx2 : InstructionSet::sse2;
+        result = get_kernel(isa, band_size, score_precision);
+    }
+    if (!result) {
+        throw std::invalid_argument {"get_kernel: no kernel for requested band size"};
+    }
+    return *result;
+}
+
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
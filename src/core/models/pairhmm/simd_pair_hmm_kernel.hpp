@@ -0,0 +1,136 @@
+// Copyright (c) 2015-2019 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef simd_pair_hmm_kernel_hpp
+#define simd_pair_hmm_kernel_hpp
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace octopus { namespace hmm { namespace simd {
+
+/*
+    Every PairHMM kernel is compiled into the binary, each in its own translation unit built with the
+    flags for its instruction set, and the kernel used is chosen at runtime from what the CPU supports.
+    Nothing outside those translation units may use instructions beyond the baseline.
+*/
+enum class InstructionSet { sse2, avx2, avx512 };
+
+enum class ScorePrecision { int16, int32 };
+
+std::ostream& operator<<(std::ostream& os, InstructionSet isa);
+
+// true if the kernels for this instruction set are compiled in and the CPU can run them
+bool is_supported(InstructionSet isa) noexcept;
+
+InstructionSet fastest_supported_instruction_set() noexcept;
+
+// Sets the instruction set of kernels returned by subsequent calls to get_kernel.
+// Throws std::invalid_argument if the instruction set is not supported.
+void set_instruction_set(InstructionSet isa);
+
+InstructionSet get_instruction_set() noexcept;
+
+// The widest inter-read batch of any kernel
+constexpr int max_inter_read_lanes {32};
+
+class PairHMMKernel
+{
+public:
+    using Penalty = std::int8_t;
+
+    PairHMMKernel() = default;
+
+    PairHMMKernel(const PairHMMKernel&)            = delete;
+    PairHMMKernel& operator=(const PairHMMKernel&) = delete;
+    PairHMMKernel(PairHMMKernel&&)                 = delete;
+    PairHMMKernel& operator=(PairHMMKernel&&)      = delete;
+
+    virtual ~PairHMMKernel() = default;
+
+    virtual int band_size() const noexcept = 0;
+    virtual const char* name() const noexcept = 0;
+
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      const Penalty* gap_open, const Penalty* gap_extend,
+                      short nuc_prior) const noexcept = 0;
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      const Penalty* gap_open, Penalty gap_extend,
+                      short nuc_prior) const noexcept = 0;
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      Penalty gap_open, Penalty gap_extend,
+                      short nuc_prior) const noexcept = 0;
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      const char* snv_mask, const std::int8_t* snv_prior,
+                      const Penalty* gap_open, const Penalty* gap_extend,
+                      short nuc_prior) const noexcept = 0;
+
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      const Penalty* gap_open, const Penalty* gap_extend,
+                      short nuc_prior,
+                      int& first_pos, char* align1, char* align2) const noexcept = 0;
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      const Penalty* gap_open, Penalty gap_extend,
+                      short nuc_prior,
+                      int& first_pos, char* align1, char* align2) const noexcept = 0;
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      Penalty gap_open, Penalty gap_extend,
+                      short nuc_prior,
+                      int& first_pos, char* align1, char* align2) const noexcept = 0;
+    virtual int align(const char* truth, const char* target, const std::int8_t* qualities,
+                      int truth_len, int target_len,
+                      const char* snv_mask, const std::int8_t* snv_prior,
+                      const Penalty* gap_open, const Penalty* gap_extend,
+                      short nuc_prior,
+                      int& first_pos, char* align1, char* align2) const noexcept = 0;
+
+    virtual int calculate_flank_score(int truth_len, int lhs_flank_len, int rhs_flank_len,
+                                      const char* target, const std::int8_t* quals,
+                                      const char* snv_mask, const std::int8_t* snv_prior,
+                                      const Penalty* gap_open, const Penalty* gap_extend,
+                                      short nuc_prior,
+                                      int first_pos, const char* aln1, const char* aln2,
+                                      int& target_mask_size) const noexcept = 0;
+
+    // The number of alignments the inter-read kernel scores at once, or zero if there is no
+    // inter-read kernel for this score precision
+    virtual int num_inter_read_lanes() const noexcept = 0;
+
+    // See InterReadPairHMM::align
+    virtual void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+                       int target_len,
+                       const char* const* snv_masks, const std::int8_t* const* snv_priors,
+                       const Penalty* const* gap_opens, const Penalty* const* gap_extends,
+                       short nuc_prior,
+                       int num_alignments, int* result) const = 0;
+};
+
+constexpr int min_kernel_band_size {8};
+constexpr int max_kernel_band_size {256};
+
+// Returns the kernel with the given band size, which must be a power of two between
+// min_kernel_band_size and max_kernel_band_size, for the current instruction set. Falls back
+// to a narrower instruction set if the band is not a multiple of the vector width.
+const PairHMMKernel& get_kernel(int band_size, ScorePrecision score_precision);
+
+namespace detail {
+
+// Defined in each instruction set's translation unit; nullptr if the kernel is not available
+const PairHMMKernel* get_sse2_kernel(int band_size, ScorePrecision score_precision) noexcept;
+const PairHMMKernel* get_avx2_kernel(int band_size, ScorePrecision score_precision) noexcept;
+const PairHMMKernel* get_avx512_kernel(int band_size, ScorePrecision score_precision) noexcept;
+
+} // namespace detail
+
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
+
+#endif
@@ -0,0 +1,224 @@
+// Copyright (c) 2015-2019 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef simd_pair_hmm_kernel_impl_hpp
+#define simd_pair_hmm_kernel_impl_hpp
+
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+
+#include "simd_pair_hmm_kernel.hpp"
+#include "simd_pair_hmm.hpp"
+#include "rolling_initializer.hpp"
+#include "inter_read_pair_hmm.hpp"
+
+/*
+    Only include this header in the instruction set specific translation units, as it instantiates
+    the kernels with whatever instruction set flags the including file is compiled with.
+
+    Everything here has internal linkage, so the linker cannot merge one translation unit's kernels
+    (or the functions they instantiate) into another's and run them on a CPU without the instructions.
+*/
+
+namespace octopus { namespace hmm { namespace simd { namespace detail {
+
+namespace {
+
+struct NoInterReadPairHMM
+{
+    constexpr static int num_lanes {0};
+};
+
+template <typename HMM, typename InterReadHMM = NoInterReadPairHMM>
+class PairHMMKernelImpl : public PairHMMKernel
+{
+public:
+    PairHMMKernelImpl() = default;
+
+    virtual ~PairHMMKernelImpl() override = default;
+
+    int band_size() const noexcept override { return HMM::band_size(); }
+    const char* name() const noexcept override { return HMM::name(); }
+
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              const Penalty* gap_open, const Penalty* gap_extend,
+              short nuc_prior) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior);
+    }
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              const Penalty* gap_open, Penalty gap_extend,
+              short nuc_prior) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior);
+    }
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              Penalty gap_open, Penalty gap_extend,
+              short nuc_prior) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior);
+    }
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              const char* snv_mask, const std::int8_t* snv_prior,
+              const Penalty* gap_open, const Penalty* gap_extend,
+              short nuc_prior) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior);
+    }
+
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              const Penalty* gap_open, const Penalty* gap_extend,
+              short nuc_prior,
+              int& first_pos, char* align1, char* align2) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior, first_pos, align1, align2);
+    }
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              const Penalty* gap_open, Penalty gap_extend,
+              short nuc_prior,
+              int& first_pos, char* align1, char* align2) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior, first_pos, align1, align2);
+    }
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              Penalty gap_open, Penalty gap_extend,
+              short nuc_prior,
+              int& first_pos, char* align1, char* align2) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior, first_pos, align1, align2);
+    }
+    int align(const char* truth, const char* target, const std::int8_t* qualities,
+              int truth_len, int target_len,
+              const char* snv_mask, const std::int8_t* snv_prior,
+              const Penalty* gap_open, const Penalty* gap_extend,
+              short nuc_prior,
+              int& first_pos, char* align1, char* align2) const noexcept override
+    {
+        return hmm_.align(truth, target, qualities, truth_len, target_len, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior,
+                          first_pos, align1, align2);
+    }
+
+    int calculate_flank_score(int truth_len, int lhs_flank_len, int rhs_flank_len,
+                              const char* target, const std::int8_t* quals,
+                              const char* snv_mask, const std::int8_t* snv_prior,
+                              const Penalty* gap_open, const Penalty* gap_extend,
+                              short nuc_prior,
+                              int first_pos, const char* aln1, const char* aln2,
+                              int& target_mask_size) const noexcept override
+    {
+        return hmm_.calculate_flank_score(truth_len, lhs_flank_len, rhs_flank_len, target, quals, snv_mask, snv_prior,
+                                          gap_open, gap_extend, nuc_prior, first_pos, aln1, aln2, target_mask_size);
+    }
+
+    int num_inter_read_lanes() const noexcept override { return InterReadHMM::num_lanes; }
+
+    void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+               int target_len,
+               const char* const* snv_masks, const std::int8_t* const* snv_priors,
+               const Penalty* const* gap_opens, const Penalty* const* gap_extends,
+               short nuc_prior,
+               int num_alignments, int* result) const override
+    {
+        align(inter_read_hmm_, truths, targets, qualities, target_len, snv_masks, snv_priors, gap_opens, gap_extends,
+              nuc_prior, num_alignments, result);
+    }
+
+private:
+    static_assert(InterReadHMM::num_lanes <= max_inter_read_lanes, "max_inter_read_lanes too small");
+
+    HMM hmm_;
+    InterReadHMM inter_read_hmm_;
+
+    template <typename T>
+    void align(const T& inter_read_hmm,
+               const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+               int target_len,
+               const char* const* snv_masks, const std::int8_t* const* snv_priors,
+               const Penalty* const* gap_opens, const Penalty* const* gap_extends,
+               short nuc_prior,
+               int num_alignments, int* result) const
+    {
+        inter_read_hmm.align(truths, targets, qualities, target_len, snv_masks, snv_priors, gap_opens, gap_extends,
+                             nuc_prior, HMM::band_size(), num_alignments, result);
+    }
+    void align(NoInterReadPairHMM,
+               const char* const*, const char* const*, const std::int8_t* const*,
+               int,
+               const char* const*, const std::int8_t* const*,
+               const Penalty* const*, const Penalty* const*,
+               short,
+               int, int*) const
+    {
+        assert(false);
+    }
+};
+
+template <unsigned BandSize, typename ScoreType, unsigned VectorBytes>
+constexpr bool is_viable_kernel = BandSize % (VectorBytes / sizeof(ScoreType)) == 0;
+
+template <template <unsigned, typename> class InstructionSet,
+          unsigned BandSize,
+          typename ScoreType,
+          typename InterReadHMM>
+const PairHMMKernel* make_kernel(std::true_type) noexcept
+{
+    using HMM = PairHMM<InstructionSet<BandSize, ScoreType>, InsertRollingInitializer>;
+    static const PairHMMKernelImpl<HMM, InterReadHMM> result {};
+    return &result;
+}
+
+template <template <unsigned, typename> class InstructionSet,
+          unsigned BandSize,
+          typename ScoreType,
+          typename InterReadHMM>
+const PairHMMKernel* make_kernel(std::false_type) noexcept
+{
+    return nullptr;
+}
+
+template <template <unsigned, typename> class InstructionSet,
+          unsigned VectorBytes,
+          unsigned BandSize,
+          typename ScoreType,
+          typename InterReadHMM>
+const PairHMMKernel* make_kernel() noexcept
+{
+    using IsViable = std::integral_constant<bool, is_viable_kernel<BandSize, ScoreType, VectorBytes>>;
+    return make_kernel<InstructionSet, BandSize, ScoreType, InterReadHMM>(IsViable {});
+}
+
+// Returns nullptr for band sizes that are not a multiple of the instruction set's vector width,
+// so that no other instruction set's kernels are instantiated in this translation unit
+template <template <unsigned, typename> class InstructionSet,
+          unsigned VectorBytes,
+          typename ScoreType,
+          typename InterReadHMM = NoInterReadPairHMM>
+const PairHMMKernel* get_kernel(const int band_size) noexcept
+{
+    switch (band_size) {
+        case 8: return make_kernel<InstructionSet, VectorBytes, 8, ScoreType, InterReadHMM>();
+        case 16: return make_kernel<InstructionSet, VectorBytes, 16, ScoreType, InterReadHMM>();
+        case 32: return make_kernel<InstructionSet, VectorBytes, 32, ScoreType, InterReadHMM>();
+        case 64: return make_kernel<InstructionSet, VectorBytes, 64, ScoreType, InterReadHMM>();
+        case 128: return make_kernel<InstructionSet, VectorBytes, 128, ScoreType, InterReadHMM>();
+        case 256: return make_kernel<InstructionSet, VectorBytes, 256, ScoreType, InterReadHMM>();
+        default: return nullptr;
+    }
+}
+
+} // namespace
+
+} // namespace detail
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
+
+#endif
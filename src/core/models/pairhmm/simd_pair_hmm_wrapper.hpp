@@ -4,43 +4,19 @@
 #ifndef simd_pair_hmm_wrapper_hpp
 #define simd_pair_hmm_wrapper_hpp
 
-#include <tuple>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
 
-#include <boost/variant.hpp>
-
-#include "exceptions/user_error.hpp"
-#include "simd_pair_hmm_factory.hpp"
+#include "simd_pair_hmm_kernel.hpp"
 
 namespace octopus { namespace hmm { namespace simd {
 
-namespace detail {
-
-constexpr unsigned ipow(unsigned base, unsigned exponent) noexcept
-{
-    return exponent == 0 ? 1 : base * ipow(base, exponent - 1);
-}
-
-template <typename T, std::size_t... I>
-constexpr auto make_phmm_tuple(std::index_sequence<I...>) { return std::make_tuple(SimdPairHMM<ipow(2, I + 3), T>{}...); }
-
-template <typename Tuple>
-struct to_variant;
-
-template <typename... Ts>
-struct to_variant<std::tuple<Ts...>>
-{
-    using type = boost::variant<Ts...>;
-};
-
-template <typename Tuple>
-using to_variant_t = typename to_variant<Tuple>::type;
-
-} // namespace detail
-
+// Dispatches to the kernel for the runtime selected instruction set (see simd_pair_hmm_kernel.hpp)
 class PairHMMWrapper
 {
 public:
-    enum class ScorePrecision { int16, int32 };
+    using ScorePrecision = simd::ScorePrecision;
     
     class TooLargeBandSizeError : public std::runtime_error
     {
@@ -61,6 +37,7 @@ public:
     };
     
     PairHMMWrapper(int min_band_size = 8, ScorePrecision score_precision = ScorePrecision::int16)
+    : kernel_ {nullptr}
     {
         reset(min_band_size, score_precision);
     }
@@ -74,17 +51,22 @@ public:
     
     int band_size() const noexcept
     {
-        return boost::apply_visitor([] (const auto& hmm) noexcept { return hmm.band_size(); }, hmm_);
+        return kernel_->band_size();
     }
     
     const char* name() const noexcept
     {
-        return boost::apply_visitor([] (const auto& hmm) noexcept { return hmm.name(); }, hmm_);
+        return kernel_->name();
     }
     
     void reset(int min_band_size, ScorePrecision score_precision = ScorePrecision::int16)
     {
-        hmm_ = make_simd_pair_hmm(min_band_size, score_precision);
+        if (min_band_size > max_kernel_band_size) {
+            throw TooLargeBandSizeError {min_band_size, max_kernel_band_size};
+        }
+        int band_size {min_kernel_band_size};
+        while (band_size < min_band_size) band_size *= 2;
+        kernel_ = std::addressof(get_kernel(band_size, score_precision));
     }
     
     template <typename OpenPenaltyArrayOrConstant,
@@ -99,9 +81,7 @@ public:
           const ExtendPenaltyArrayOrConstant gap_extend,
           short nuc_prior) const noexcept
     {
-        return boost::apply_visitor([&] (const auto& hmm) noexcept {
-            return hmm.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior);
-        }, hmm_);
+        return kernel_->align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior);
     }
     template <typename OpenPenaltyArrayOrConstant,
               typename ExtendPenaltyArrayOrConstant>
@@ -117,9 +97,7 @@ public:
           const ExtendPenaltyArrayOrConstant gap_extend,
           short nuc_prior) const noexcept
     {
-        return boost::apply_visitor([&] (const auto& hmm) noexcept {
-            return hmm.align(truth, target, qualities, truth_len, target_len, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior);
-        }, hmm_);
+        return kernel_->align(truth, target, qualities, truth_len, target_len, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior);
     }
     template <typename OpenPenaltyArrayOrConstant,
               typename ExtendPenaltyArrayOrConstant>
@@ -136,9 +114,7 @@ public:
           char* align1,
           char* align2) const noexcept
     {
-        return boost::apply_visitor([&] (const auto& hmm) noexcept {
-            return hmm.align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior, first_pos, align1, align2);
-        }, hmm_);
+        return kernel_->align(truth, target, qualities, truth_len, target_len, gap_open, gap_extend, nuc_prior, first_pos, align1, align2);
     }
     template <typename OpenPenaltyArrayOrConstant,
               typename ExtendPenaltyArrayOrConstant>
@@ -157,28 +133,7 @@ public:
           char* align1,
           char* align2) const noexcept
     {
-        return boost::apply_visitor([&] (const auto& hmm) noexcept {
-            return hmm.align(truth, target, qualities, truth_len, target_len, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior, first_pos, align1, align2);
-        }, hmm_);
-    }
-    template <typename OpenPenaltyArrayOrConstant,
-              typename ExtendPenaltyArrayOrConstant>
-    int
-    calculate_flank_score(const int truth_len,
-                          const int lhs_flank_len,
-                          const int rhs_flank_len,
-                          const std::int8_t* quals,
-                          const OpenPenaltyArrayOrConstant gap_open,
-                          const ExtendPenaltyArrayOrConstant gap_extend,
-                          const short nuc_prior,
-                          const int first_pos,
-                          const char* aln1,
-                          const char* aln2,
-                          int& target_mask_size) const noexcept
-    {
-        return boost::apply_visitor([&] (const auto& hmm) noexcept {
-            return hmm.calculate_flank_score(truth_len, lhs_flank_len, rhs_flank_len, quals, gap_open, gap_extend, nuc_prior, first_pos, aln1, aln2, target_mask_size);
-        }, hmm_);
+        return kernel_->align(truth, target, qualities, truth_len, target_len, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior, first_pos, align1, align2);
     }
     template <typename OpenPenaltyArrayOrConstant,
               typename ExtendPenaltyArrayOrConstant>
@@ -198,57 +153,39 @@ public:
                           const char* aln2,
                           int& target_mask_size) const noexcept
     {
-        return boost::apply_visitor([&] (const auto& hmm) noexcept {
-            return hmm.calculate_flank_score(truth_len, lhs_flank_len, rhs_flank_len, target, quals, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior, first_pos, aln1, aln2, target_mask_size);
-        }, hmm_);
+        return kernel_->calculate_flank_score(truth_len, lhs_flank_len, rhs_flank_len, target, quals, snv_mask, snv_prior, gap_open, gap_extend, nuc_prior, first_pos, aln1, aln2, target_mask_size);
     }
 
-private:
-    using ShortPairHMMs = decltype(detail::make_phmm_tuple<short>(std::make_index_sequence<6>()));
-    using IntPairHMMs   = decltype(detail::make_phmm_tuple<int>(std::make_index_sequence<6>()));
-    using PairHMMs      = decltype(std::tuple_cat(ShortPairHMMs {}, IntPairHMMs {}));
-    
-    using PairHmmVariant = detail::to_variant_t<PairHMMs>;
-    
-    PairHmmVariant hmm_;
-    
-    template <typename Hmms>
-    constexpr static int max_band_size() { return std::tuple_element_t<std::tuple_size<Hmms>::value - 1, Hmms>::band_size(); }
-    
-    template <typename Hmms, std::size_t... Is>
-    PairHmmVariant make_simd_pair_hmm_helper(const int min_band_size, std::index_sequence<Is...>) const
+    int num_inter_read_lanes() const noexcept
     {
-        if (min_band_size <= max_band_size<Hmms>()) {
-            PairHmmVariant result {};
-            int unused[] = {((Is == 0 || std::tuple_element_t<(Is > 0 ? Is - 1 : 0), Hmms>::band_size() < min_band_size)
-                            && min_band_size <= std::tuple_element_t<Is, Hmms>::band_size()
-                            ? (result = std::tuple_element_t<Is, Hmms> {}, 0) : 0)...};
-            (void) unused;
-            return result;
-        } else {
-            throw TooLargeBandSizeError {min_band_size, max_band_size<Hmms>()};
-        }
+        return kernel_->num_inter_read_lanes();
     }
-    PairHmmVariant make_simd_pair_hmm(const int min_band_size, const ScorePrecision score_precision) const
+    
+    // Scores up to num_inter_read_lanes() alignments of the same target length at once
+    void
+    align(const char* const* truths,
+          const char* const* targets,
+          const std::int8_t* const* qualities,
+          const int target_len,
+          const char* const* snv_masks,
+          const std::int8_t* const* snv_priors,
+          const std::int8_t* const* gap_opens,
+          const std::int8_t* const* gap_extends,
+          const short nuc_prior,
+          const int num_alignments,
+          int* result) const
     {
-        if (score_precision == ScorePrecision::int16) {
-            using Hmms = ShortPairHMMs;
-            return make_simd_pair_hmm_helper<Hmms>(min_band_size, std::make_index_sequence<std::tuple_size<Hmms>::value>());
-        } else {
-            using Hmms = IntPairHMMs;
-            return make_simd_pair_hmm_helper<Hmms>(min_band_size, std::make_index_sequence<std::tuple_size<Hmms>::value>());
-        }
+        kernel_->align(truths, targets, qualities, target_len, snv_masks, snv_priors, gap_opens, gap_extends,
+                       nuc_prior, num_alignments, result);
     }
-
-public:
+    
     static int max_band_size(ScorePrecision score_precision) noexcept
     {
-        if (score_precision == ScorePrecision::int16) {
-            return max_band_size<ShortPairHMMs>();
-        } else {
-            return max_band_size<IntPairHMMs>();
-        }
+        return max_kernel_band_size;
     }
+    
+private:
+    const PairHMMKernel* kernel_;
 };
 
 } // namespace simd
@@ -0,0 +1,23 @@
+// Copyright (c) 2015-2019 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "simd_pair_hmm_kernel.hpp"
+
+#include "simd_pair_hmm_kernel_impl.hpp"
+#include "sse2_pair_hmm_impl.hpp"
+
+namespace octopus { namespace hmm { namespace simd { namespace detail {
+
+const PairHMMKernel* get_sse2_kernel(const int band_size, const ScorePrecision score_precision) noexcept
+{
+    if (score_precision == ScorePrecision::int16) {
+        return get_kernel<SSE2PairHMMInstructionSet, 16, short, InterReadPairHMM<SSE2PairHMMInstructionSet<8, short>>>(band_size);
+    } else {
+        return get_kernel<SSE2PairHMMInstructionSet, 16, int>(band_size);
+    }
+}
+
+} // namespace detail
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
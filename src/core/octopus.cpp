@@ -22,6 +22,8 @@
 #include <chrono>
 #include <sstream>
 #include <iostream>
+#include <iomanip>
+#include <exception>
 #include <cassert>
 
 #include <boost/optional.hpp>
@@ -49,6 +51,9 @@
 #include "core/tools/vcf_header_factory.hpp"
 #include "io/variant/vcf.hpp"
 #include "utils/timing.hpp"
+#include "utils/work_stealing_scheduler.hpp"
+#include "utils/thread_pool.hpp"
+#include "utils/prefetch.hpp"
 #include "exceptions/program_error.hpp"
 #include "exceptions/system_error.hpp"
 #include "csr/filters/variant_call_filter.hpp"
@@ -140,15 +145,32 @@ auto get_call_types(const GenomeCallingComponents& components, const std::vector
     return result;
 }
 
-void write_caller_output_header(GenomeCallingComponents& components, const UserCommandInfo& info)
+VcfHeader make_caller_output_header(const GenomeCallingComponents& components, const UserCommandInfo& info)
 {
     const auto call_types = get_call_types(components, components.contigs());
     if (components.sites_only() && !apply_csr(components)) {
-        components.output() << make_vcf_header({}, components.contigs(), components.reference(),
-                                               call_types, info);
+        return make_vcf_header({}, components.contigs(), components.reference(), call_types, info);
     } else {
-        components.output() << make_vcf_header(components.samples(), components.contigs(),
-                                               components.reference(), call_types, info);
+        return make_vcf_header(components.samples(), components.contigs(), components.reference(), call_types, info);
+    }
+}
+
+VcfWriter& get_calling_output(GenomeCallingComponents& components)
+{
+    // Fused call filtering writes filtered calls straight to the final output
+    if (components.fused_call_filter()) {
+        return *components.filtered_output();
+    } else {
+        return components.output();
+    }
+}
+
+void write_caller_output_header(GenomeCallingComponents& components, const UserCommandInfo& info)
+{
+    if (components.fused_call_filter()) {
+        get_calling_output(components) << components.fused_call_filter()->output_header;
+    } else {
+        components.output() << make_caller_output_header(components, info);
     }
 }
 
@@ -279,6 +301,60 @@ void write_calls(std::deque<VcfRecord>&& calls, VcfWriter& out)
     calls.shrink_to_fit();
 }
 
+// Read assignments can be made from the likelihoods computed by the caller if the filter uses the calling reads
+bool reuse_calling_likelihoods(const FusedCallFilter& call_filter) noexcept
+{
+    return !call_filter.read_pipe && call_filter.filter->uses_read_assignments();
+}
+
+std::deque<VcfRecord>
+filter_calls(const std::deque<VcfRecord>& calls, const ReadMap& calling_reads, const FusedCallFilter& call_filter,
+             const std::vector<SavedHaplotypeLikelihoods>* likelihoods)
+{
+    if (call_filter.read_pipe) {
+        if (calls.empty()) return {};
+        const auto reads = call_filter.read_pipe->fetch_reads(encompassing_region(calls));
+        return call_filter.filter->filter(calls, reads, call_filter.output_header);
+    } else {
+        return call_filter.filter->filter(calls, calling_reads, call_filter.output_header, likelihoods);
+    }
+}
+
+std::deque<VcfRecord> make_calls(const GenomicRegion& region, const ContigCallingComponents& components)
+{
+    if (components.call_filter) {
+        const auto& call_filter = *components.call_filter;
+        ReadMap reads {};
+        std::vector<SavedHaplotypeLikelihoods> likelihoods {};
+        auto saved_likelihoods = reuse_calling_likelihoods(call_filter) ? &likelihoods : nullptr;
+        const auto calls = components.caller->call(region, components.progress_meter, reads, saved_likelihoods);
+        return filter_calls(calls, reads, call_filter, saved_likelihoods);
+    } else {
+        return components.caller->call(region, components.progress_meter);
+    }
+}
+
+// The components and reads for calling a region, which can be made before the calls are
+struct PreparedCalling
+{
+    ContigCallingComponents components;
+    Caller::CallingReads reads;
+};
+
+std::deque<VcfRecord> make_calls(PreparedCalling& prepared)
+{
+    const auto& components = prepared.components;
+    if (components.call_filter) {
+        const auto& call_filter = *components.call_filter;
+        std::vector<SavedHaplotypeLikelihoods> likelihoods {};
+        auto saved_likelihoods = reuse_calling_likelihoods(call_filter) ? &likelihoods : nullptr;
+        const auto calls = components.caller->call(prepared.reads, components.progress_meter, saved_likelihoods);
+        return filter_calls(calls, prepared.reads.reads, call_filter, saved_likelihoods);
+    } else {
+        return components.caller->call(prepared.reads, components.progress_meter);
+    }
+}
+
 struct WindowConfig
 {
     boost::optional<GenomicRegion::Size> min_size = boost::none, max_size = boost::none;
@@ -395,7 +471,7 @@ void resolve_connecting_calls(std::vector<VcfRecord>& old_connecting_calls,
             const auto unresolved_region = encompassing_region(merged_calls);
             merged_calls.clear();
             merged_calls.shrink_to_fit();
-            auto new_calls = components.caller->call(unresolved_region, components.progress_meter);
+            auto new_calls = make_calls(unresolved_region, components);
             // TODO: we need to make sure the new calls don't contain any calls
             // outside the unresolved_region, and also possibly adjust phase regions
             // in calls past unresolved_region.
@@ -426,7 +502,7 @@ void run_octopus_on_contig(ContigCallingComponents&& components)
         if (debug_log) stream(*debug_log) << "Processing subregion " << subregion;
         
         try {
-            calls = components.caller->call(subregion, components.progress_meter);
+            calls = make_calls(subregion, components);
         } catch(...) {
             // TODO: which exceptions can we recover from?
             throw;
@@ -462,7 +538,7 @@ void run_octopus_single_threaded(GenomeCallingComponents& components)
     #endif
     components.progress_meter().start();
     for (const auto& contig : components.contigs()) {
-        run_octopus_on_contig(ContigCallingComponents {contig, components});
+        run_octopus_on_contig(ContigCallingComponents {contig, get_calling_output(components), components});
     }
     components.progress_meter().stop();
     #ifdef BENCHMARK
@@ -499,7 +575,11 @@ auto create_unique_temp_output_file_path(const GenomicRegion& region,
 VcfHeader make_temp_vcf_header(const GenomeCallingComponents& components, const GenomicRegion& region)
 {
     const auto call_types = get_call_types(components, {region.contig_name()});
-    return make_vcf_header(components.samples(), region.contig_name(), components.reference(), call_types, {"octopus-internal", ""});
+    auto result = make_vcf_header(components.samples(), region.contig_name(), components.reference(), call_types, {"octopus-internal", ""});
+    if (components.fused_call_filter()) {
+        result = components.fused_call_filter()->filter->make_header(result);
+    }
+    return result;
 }
 
 VcfWriter create_unique_temp_output_file(const GenomicRegion& region, const GenomeCallingComponents& components)
@@ -533,6 +613,7 @@ struct Task : public Mappable<Task>
 {
     GenomicRegion region;
     ExecutionPolicy policy;
+    std::shared_ptr<Prefetch<PreparedCalling>> prefetch = nullptr; // set while the task is pending
     
     Task() = delete;
     
@@ -591,6 +672,7 @@ struct TaskMakerSyncPacket
     std::atomic_uint num_tasks;
     std::unordered_map<ContigName, bool> finished;
     std::atomic_bool all_done;
+    std::function<void()> on_new_tasks = [] () {}; // Called without the lock held
 };
 
 void make_region_tasks(const GenomicRegion& region,
@@ -615,6 +697,7 @@ void make_region_tasks(const GenomicRegion& region,
         }
         lock.unlock();
         sync.cv.notify_one();
+        sync.on_new_tasks();
     } else {
         std::deque<GenomicRegion> batch {};
         batch.push_back(subregion);
@@ -644,11 +727,13 @@ void make_region_tasks(const GenomicRegion& region,
                 }
                 lock.unlock();
                 sync.cv.notify_one();
+                sync.on_new_tasks();
                 break;
             } else {
                 batch.clear();
                 lock.unlock();
                 sync.cv.notify_one();
+                sync.on_new_tasks();
             }
         }
     }
@@ -774,9 +859,11 @@ Task pop(TaskMap& tasks, TaskMakerSyncPacket& sync)
 
 struct CompletedTask : public Task
 {
-    CompletedTask(Task task) : Task {std::move(task)}, calls {}, runtime {} {}
+    CompletedTask(Task task) : Task {std::move(task)}, calls {}, runtime {}, read_wait {0}, num_prefetch_hits {0} {}
     std::deque<VcfRecord> calls;
     utils::TimeInterval runtime;
+    std::chrono::nanoseconds read_wait; // time spent fetching or waiting for prefetched reads
+    unsigned num_prefetch_hits; // prefetched reads that were ready when needed
 };
 
 std::string duration(const CompletedTask& task)
@@ -786,55 +873,151 @@ std::string duration(const CompletedTask& task)
     return ss.str();
 }
 
+std::string read_wait_duration(const CompletedTask& task)
+{
+    std::ostringstream ss {};
+    ss << std::chrono::duration_cast<std::chrono::milliseconds>(task.read_wait).count() << "ms";
+    return ss.str();
+}
+
 std::ostream& operator<<(std::ostream& os, const CompletedTask& task)
 {
     os << task.region;
     return os;
 }
 
-struct CallerSyncPacket
+struct CoordinatorSyncPacket
 {
-    CallerSyncPacket() : num_finished {0} {}
     std::condition_variable cv;
     std::mutex mutex;
-    std::atomic_uint num_finished;
+    std::deque<CompletedTask> completed_tasks = {};
+    std::exception_ptr error = nullptr;
 };
 
-template<typename R>
-bool is_ready(const std::future<R>& f)
+using ContigCallingComponentFactory    = std::function<ContigCallingComponents()>;
+using ContigCallingComponentFactoryMap = std::map<ContigName, ContigCallingComponentFactory>;
+
+void resolve_connecting_calls(CompletedTask& lhs, CompletedTask& rhs,
+                              const ContigCallingComponentFactory& calling_components);
+
+bool can_split(const Task& task, const WorkStealingScheduler& scheduler, const TaskMakerSyncPacket& task_maker_sync,
+               const WindowConfig& window_config) noexcept
+{
+    // Only split when there is spare capacity that pending tasks cannot use
+    return scheduler.n_idle() > 0 && scheduler.n_queued() == 0 && task_maker_sync.num_tasks == 0
+           && window_config.min_size && size(task.region) >= 2 * *window_config.min_size;
+}
+
+PreparedCalling prepare(const GenomicRegion& region, const ContigCallingComponentFactory& calling_components)
+{
+    auto components = calling_components();
+    auto reads = components.caller->fetch_reads(region);
+    return {std::move(components), std::move(reads)};
+}
+
+PreparedCalling prepare(CompletedTask& task, const ContigCallingComponentFactory& calling_components)
+{
+    if (task.prefetch) {
+        if (task.prefetch->status() == Prefetch<PreparedCalling>::Status::done) ++task.num_prefetch_hits;
+        auto result = task.prefetch->get(); // fetches here if no worker has started it
+        task.prefetch = nullptr;
+        return result;
+    } else {
+        return prepare(task.region, calling_components);
+    }
+}
+
+// Makes the next pending task's components, then starts fetching its reads on the scheduler, so they may be
+// ready when the task is run. The task claims the fetch itself if no worker has started it by then. Only the
+// fetch is run on the scheduler; the components are made here, on the coordinator.
+void prefetch_next(TaskMap& tasks, TaskMakerSyncPacket& sync, const ContigCallingComponentFactoryMap& calling_components,
+                   WorkStealingScheduler& scheduler)
+{
+    std::lock_guard<std::mutex> lock {sync.mutex};
+    if (sync.num_tasks == 0 || tasks.empty() || std::cbegin(tasks)->second.empty()) return;
+    auto& task = std::begin(tasks)->second.front();
+    if (task.prefetch) return;
+    auto components = std::make_shared<ContigCallingComponents>(calling_components.at(contig_name(task))());
+    task.prefetch = std::make_shared<Prefetch<PreparedCalling>>([region = task.region, components = std::move(components)] () {
+        auto reads = components->caller->fetch_reads(region);
+        return PreparedCalling {std::move(*components), std::move(reads)};
+    }, scheduler);
+}
+
+auto split(const Task& task)
 {
-    return f.valid() && f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    auto lhs = head_region(task.region, size(task.region) / 2);
+    auto rhs = right_overhang_region(task.region, lhs);
+    return std::make_pair(Task {std::move(lhs), task.policy}, Task {std::move(rhs), task.policy});
 }
 
-auto run(Task task, ContigCallingComponents components, CallerSyncPacket& sync)
+CompletedTask run(Task task, const ContigCallingComponentFactory& calling_components, WorkStealingScheduler& scheduler,
+                  const TaskMakerSyncPacket& task_maker_sync, const WindowConfig& window_config)
+{
+    static auto debug_log = get_debug_log();
+    // Don't split if the task's reads are already being fetched
+    if (can_split(task, scheduler, task_maker_sync, window_config) && (!task.prefetch || task.prefetch->cancel())) {
+        // Fork the rhs so an idle worker can steal it, and join the results into a single task
+        auto subtasks = split(task);
+        if (debug_log) stream(*debug_log) << "Splitting task " << task << " into " << subtasks.first << " & " << subtasks.second;
+        auto rhs_future = scheduler.push(run, std::move(subtasks.second), std::cref(calling_components), std::ref(scheduler),
+                                         std::cref(task_maker_sync), window_config);
+        auto lhs = run(std::move(subtasks.first), calling_components, scheduler, task_maker_sync, window_config);
+        auto rhs = scheduler.wait(rhs_future);
+        resolve_connecting_calls(lhs, rhs, calling_components);
+        CompletedTask result {std::move(task)};
+        result.calls = std::move(lhs.calls);
+        utils::append(std::move(rhs.calls), result.calls);
+        result.runtime.start = lhs.runtime.start;
+        result.runtime.end = std::max(lhs.runtime.end, rhs.runtime.end);
+        result.read_wait = lhs.read_wait + rhs.read_wait;
+        result.num_prefetch_hits = lhs.num_prefetch_hits + rhs.num_prefetch_hits;
+        return result;
+    }
+    if (debug_log) stream(*debug_log) << "Running task " << task;
+    CompletedTask result {std::move(task)};
+    result.runtime.start = std::chrono::system_clock::now();
+    const auto read_wait_start = std::chrono::steady_clock::now();
+    auto prepared = prepare(result, calling_components);
+    result.read_wait = std::chrono::steady_clock::now() - read_wait_start;
+    result.calls = make_calls(prepared);
+    result.runtime.end = std::chrono::system_clock::now();
+    return result;
+}
+
+void submit(Task task, const ContigCallingComponentFactory& calling_components, WorkStealingScheduler& scheduler,
+            const TaskMakerSyncPacket& task_maker_sync, const WindowConfig& window_config, CoordinatorSyncPacket& sync)
 {
     static auto debug_log = get_debug_log();
     if (debug_log) stream(*debug_log) << "Spawning task " << task;
-    return std::async(std::launch::async, [task = std::move(task), components = std::move(components), &sync] () {
+    scheduler.push([task = std::move(task), &calling_components, &scheduler, &task_maker_sync, window_config, &sync] () {
         try {
-            CompletedTask result {task};
-            result.runtime.start = std::chrono::system_clock::now();
-            result.calls = components.caller->call(task.region, components.progress_meter);
-            result.runtime.end = std::chrono::system_clock::now();
+            auto result = run(task, calling_components, scheduler, task_maker_sync, window_config);
             std::unique_lock<std::mutex> lock {sync.mutex};
-            ++sync.num_finished;
+            sync.completed_tasks.push_back(std::move(result));
             lock.unlock();
             sync.cv.notify_all();
-            return result;
         } catch (const std::exception& e) {
             logging::ErrorLogger error_log {};
             stream(error_log) << "Encountered a problem whilst calling " << task << "(" << e.what() << ")";
             using namespace std::chrono_literals;
             std::this_thread::sleep_for(2s); // Try to make sure the error is logged before raising
             std::unique_lock<std::mutex> lock {sync.mutex};
-            ++sync.num_finished;
+            if (!sync.error) sync.error = std::current_exception();
             lock.unlock();
             sync.cv.notify_all();
-            throw;
         }
     });
 }
 
+void notify(CoordinatorSyncPacket& sync)
+{
+    // Lock so the coordinator cannot miss the notification between checking and waiting
+    std::unique_lock<std::mutex> lock {sync.mutex};
+    lock.unlock();
+    sync.cv.notify_all();
+}
+
 using CompletedTaskMap = std::map<ContigName, std::map<ContigRegion, CompletedTask>>;
 using HoldbackTask = boost::optional<std::reference_wrapper<const CompletedTask>>;
 
@@ -862,9 +1045,6 @@ auto get_writable_completed_tasks(CompletedTask&& task, CompletedTaskMap::mapped
     return result;
 }
 
-using ContigCallingComponentFactory    = std::function<ContigCallingComponents()>;
-using ContigCallingComponentFactoryMap = std::map<ContigName, ContigCallingComponentFactory>;
-
 auto make_contig_calling_component_factory_map(GenomeCallingComponents& components)
 {
     ContigCallingComponentFactoryMap result {};
@@ -928,7 +1108,7 @@ void resolve_connecting_calls(CompletedTask& lhs, CompletedTask& rhs,
             logging::WarningLogger warn_log {};
             stream(warn_log) << "Recalling " << unresolved_region
                              << " due to call inconsistency between thread tasks. This may increase expected runtime";
-            auto resolved_calls = components.caller->call(unresolved_region, components.progress_meter);
+            auto resolved_calls = make_calls(unresolved_region, components);
             if (!resolved_calls.empty()) {
                 if (!contains(unresolved_region, encompassing_region(resolved_calls))) {
                     // TODO
@@ -970,7 +1150,8 @@ void write(std::deque<CompletedTask>& tasks, TempVcfWriterMap& writers)
     static auto debug_log = get_debug_log();
     for (auto&& task : tasks) {
         if (debug_log) {
-            stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task);
+            stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task)
+                               << " (" << read_wait_duration(task) << " waiting for reads)";
         }
         auto& writer = writers.at(contig_name(task));
         write_calls(std::move(task.calls), writer);
@@ -1020,7 +1201,10 @@ void write(std::deque<CompletedTask>&& tasks, VcfWriter& temp_vcf)
 {
     static auto debug_log = get_debug_log();
     for (auto&& task : tasks) {
-        if (debug_log) stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task);
+        if (debug_log) {
+            stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task)
+                               << " (" << read_wait_duration(task) << " waiting for reads)";
+        }
         write_calls(std::move(task.calls), temp_vcf);
     }
 }
@@ -1066,17 +1250,8 @@ void wait_until_finished(TaskWriterSyncPacket& sync)
     sync.cv.notify_one();
 }
 
-using FutureCompletedTasks = std::vector<std::future<CompletedTask>>;
 using RemainingTaskMap = std::map<ContigName, std::deque<CompletedTask>>;
 
-void extract_remaining_future_tasks(FutureCompletedTasks& futures, std::deque<CompletedTask>& result)
-{
-    const auto itr = std::remove_if(std::begin(futures), std::end(futures), [] (const auto& f) { return !f.valid(); });
-    std::transform(std::begin(futures), itr, std::back_inserter(result), [] (auto& fut) { return fut.get(); });
-    futures.clear();
-    futures.shrink_to_fit();
-}
-
 void extract_buffered_tasks(CompletedTaskMap& buffered_tasks, std::deque<CompletedTask>& result)
 {
     for (auto& p : buffered_tasks) {
@@ -1103,10 +1278,9 @@ RemainingTaskMap make_map(std::deque<CompletedTask>& tasks)
     return result;
 }
 
-RemainingTaskMap extract_remaining_tasks(FutureCompletedTasks& futures, CompletedTaskMap& buffered_tasks)
+RemainingTaskMap extract_remaining_tasks(CompletedTaskMap& buffered_tasks)
 {
     std::deque<CompletedTask> tasks {};
-    extract_remaining_future_tasks(futures, tasks);
     extract_buffered_tasks(buffered_tasks, tasks);
     return make_map(tasks);
 }
@@ -1126,12 +1300,10 @@ void write(RemainingTaskMap&& remaining_tasks, TempVcfWriterMap& temp_vcfs)
     }
 }
 
-void write_remaining_tasks(FutureCompletedTasks& futures, CompletedTaskMap& buffered_tasks, TempVcfWriterMap& temp_vcfs,
+void write_remaining_tasks(CompletedTaskMap& buffered_tasks, TempVcfWriterMap& temp_vcfs,
                            const ContigCallingComponentFactoryMap& calling_components)
 {
-    static auto debug_log = get_debug_log();
-    if (debug_log) stream(*debug_log) << "Waiting for " << futures.size() << " running tasks to finish";
-    auto remaining_tasks = extract_remaining_tasks(futures, buffered_tasks);
+    auto remaining_tasks = extract_remaining_tasks(buffered_tasks);
     resolve_connecting_calls(remaining_tasks, calling_components);
     write(std::move(remaining_tasks), temp_vcfs);
 }
@@ -1157,21 +1329,76 @@ void merge(TempVcfWriterMap&& temp_vcf_writers, GenomeCallingComponents& compone
     static auto debug_log = get_debug_log();
     if (debug_log) stream(*debug_log) << "Merging " << temp_vcf_writers.size() << " temporary VCF files";
     auto temp_readers = extract_as_readers(std::move(temp_vcf_writers));
-    merge(temp_readers, components.output(), components.contigs());
+    merge(temp_readers, get_calling_output(components), components.contigs());
+}
+
+std::string utilisation(const std::chrono::nanoseconds busy_time, const std::chrono::nanoseconds total_time)
+{
+    std::ostringstream ss {};
+    const auto percent = total_time.count() > 0 ? 100.0 * busy_time.count() / total_time.count() : 0.0;
+    ss << std::fixed << std::setprecision(1) << percent << '%';
+    return ss.str();
+}
+
+void log_scheduler_statistics(const WorkStealingScheduler& scheduler)
+{
+    const auto stats = scheduler.statistics();
+    if (stats.empty()) return;
+    static auto debug_log = get_debug_log();
+    std::chrono::nanoseconds total_busy_time {0}, total_time {0};
+    for (std::size_t worker {0}; worker < stats.size(); ++worker) {
+        const auto& worker_stats = stats[worker];
+        const auto worker_time = worker_stats.busy_time + worker_stats.idle_time;
+        total_busy_time += worker_stats.busy_time;
+        total_time += worker_time;
+        if (debug_log) {
+            stream(*debug_log) << "Worker " << worker << " ran " << worker_stats.num_tasks_run << " tasks ("
+                               << worker_stats.num_tasks_stolen << " stolen) with "
+                               << utilisation(worker_stats.busy_time, worker_time) << " utilisation";
+        }
+    }
+    logging::InfoLogger info_log {};
+    stream(info_log) << "Mean thread utilisation was " << utilisation(total_busy_time, total_time)
+                     << " over " << stats.size() << " threads";
+}
+
+struct ReadWaitStatistics
+{
+    std::chrono::nanoseconds read_wait {0}, runtime {0};
+    std::size_t num_tasks {0}, num_prefetch_hits {0};
+};
+
+void update(ReadWaitStatistics& stats, const CompletedTask& task)
+{
+    stats.read_wait += task.read_wait;
+    stats.runtime += std::chrono::duration_cast<std::chrono::nanoseconds>(task.runtime.end - task.runtime.start);
+    ++stats.num_tasks;
+    stats.num_prefetch_hits += task.num_prefetch_hits;
+}
+
+void log_read_wait_statistics(const ReadWaitStatistics& stats)
+{
+    if (stats.num_tasks == 0) return;
+    logging::InfoLogger info_log {};
+    stream(info_log) << "Tasks spent " << utilisation(stats.read_wait, stats.runtime) << " of their runtime waiting for reads ("
+                     << stats.num_prefetch_hits << " of " << stats.num_tasks << " tasks had prefetched reads ready)";
 }
 
 void run_octopus_multi_threaded(GenomeCallingComponents& components)
 {
-    using namespace std::chrono_literals;
     static auto debug_log = get_debug_log();
     
     const auto num_task_threads = calculate_num_task_threads(components);
+    const auto window_config = default_window_config;
     
+    CoordinatorSyncPacket coordinator_sync {};
     TaskMap pending_tasks {components.contigs()};
     TaskMakerSyncPacket task_maker_sync {};
     task_maker_sync.batch_size_hint = 2 * num_task_threads;
+    task_maker_sync.on_new_tasks = [&coordinator_sync] () { notify(coordinator_sync); };
     std::unique_lock<std::mutex> pending_task_lock {task_maker_sync.mutex, std::defer_lock};
-    auto task_maker_thread = make_task_maker_thread(pending_tasks, components, num_task_threads, task_maker_sync);
+    // The next pending task's reads are prefetched, so one more task than threads holds reads
+    auto task_maker_thread = make_task_maker_thread(pending_tasks, components, num_task_threads + 1, task_maker_sync);
     if (!task_maker_thread.joinable()) {
         logging::FatalLogger fatal_log {};
         fatal_log << "Unable to make task maker thread";
@@ -1179,7 +1406,6 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     }
     task_maker_thread.detach();
     
-    FutureCompletedTasks futures(num_task_threads);
     TaskMap running_tasks {ContigOrder {components.contigs()}};
     CompletedTaskMap buffered_tasks {};
     std::map<ContigName, HoldbackTask> holdbacks {};
@@ -1190,9 +1416,8 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
         holdbacks.emplace(contig, boost::none);
     }
     
-    CallerSyncPacket caller_sync {};
     const auto calling_components = make_contig_calling_component_factory_map(components);
-    unsigned num_idle_futures {0};
+    unsigned num_running_tasks {0};
     
     auto temp_writers = make_temp_vcf_writers(components);
     TaskWriterSyncPacket task_writer_sync {};
@@ -1213,58 +1438,46 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     }
     task_maker_sync.batch_size_hint = num_task_threads / 2;
     
+    WorkStealingScheduler scheduler {num_task_threads};
     components.progress_meter().start();
     
-    while (!task_maker_sync.all_done || task_maker_sync.num_tasks > 0) {
-        pending_task_lock.lock();
-        assert(count_tasks(pending_tasks) == task_maker_sync.num_tasks);
-        if (!task_maker_sync.all_done && task_maker_sync.num_tasks == 0) {
-            task_maker_sync.batch_size_hint = std::max(num_idle_futures, num_task_threads / 2);
-            if (num_idle_futures < futures.size()) {
-                // If there are running futures then it's good periodically check to see if
-                // any have finished and process them while we wait for the task maker.
-                while (task_maker_sync.num_tasks == 0 && caller_sync.num_finished == 0) {
-                    auto now = std::chrono::system_clock::now();
-                    task_maker_sync.cv.wait_until(pending_task_lock, now + 5s, tasks_available);
-                }
-            } else {
-                task_maker_sync.cv.wait(pending_task_lock, tasks_available);
-            }
-        }
-        pending_task_lock.unlock();
-        num_idle_futures = 0;
-        for (auto& future : futures) {
-            if (is_ready(future)) {
-                auto completed_task = future.get();
-                const auto& contig = contig_name(completed_task.region);
-                write_or_buffer(std::move(completed_task), buffered_tasks.at(contig),
-                                running_tasks.at(contig), holdbacks.at(contig),
-                                task_writer_sync, calling_components.at(contig));
-                --caller_sync.num_finished;
-            }
-            if (!future.valid()) {
-                pending_task_lock.lock();
-                if (task_maker_sync.num_tasks > 0) {
-                    pending_task_lock.unlock(); // As pop will need to lock the mutex too == deadlock
-                    auto task = pop(pending_tasks, task_maker_sync);
-                    future = run(task, calling_components.at(contig_name(task))(), caller_sync);
-                    running_tasks.at(contig_name(task)).push(std::move(task));
-                } else {
-                    pending_task_lock.unlock();
-                    ++num_idle_futures;
-                }
-            }
+    const auto can_submit = [&] () noexcept { return num_running_tasks < num_task_threads && task_maker_sync.num_tasks > 0; };
+    const auto all_tasks_finished = [&] () noexcept {
+        return task_maker_sync.all_done && task_maker_sync.num_tasks == 0 && num_running_tasks == 0;
+    };
+    std::deque<CompletedTask> completed_tasks {};
+    ReadWaitStatistics read_wait_stats {};
+    while (!all_tasks_finished()) {
+        while (can_submit()) {
+            auto task = pop(pending_tasks, task_maker_sync);
+            const auto& contig = contig_name(task);
+            running_tasks.at(contig).push(task);
+            submit(std::move(task), calling_components.at(contig), scheduler, task_maker_sync, window_config, coordinator_sync);
+            ++num_running_tasks;
         }
-        // If there are no idle futures then all threads are busy and we must wait for one to finish,
-        // otherwise we must have run out of tasks, so we should wait for new ones.
-        if (num_idle_futures == 0 && caller_sync.num_finished == 0) {
-            task_maker_sync.waiting = false;
-            std::unique_lock<std::mutex> lock {caller_sync.mutex};
-            caller_sync.cv.wait(lock, [&] () { return caller_sync.num_finished > 0; });
-            task_maker_sync.waiting = true;
-        } else {
-            if (debug_log) stream(*debug_log) << "There are " << num_idle_futures << " idle futures";
+        prefetch_next(pending_tasks, task_maker_sync, calling_components, scheduler);
+        const auto num_idle_slots = num_task_threads - num_running_tasks;
+        if (debug_log && num_idle_slots > 0) stream(*debug_log) << "There are " << num_idle_slots << " idle task slots";
+        task_maker_sync.batch_size_hint = std::max(num_idle_slots, num_task_threads / 2);
+        // If all slots are busy then the task maker has time to make larger batches
+        task_maker_sync.waiting = num_idle_slots > 0;
+        std::unique_lock<std::mutex> lock {coordinator_sync.mutex};
+        coordinator_sync.cv.wait(lock, [&] () {
+            return !coordinator_sync.completed_tasks.empty() || coordinator_sync.error || can_submit() || all_tasks_finished();
+        });
+        if (coordinator_sync.error) std::rethrow_exception(coordinator_sync.error);
+        assert(completed_tasks.empty());
+        std::swap(coordinator_sync.completed_tasks, completed_tasks);
+        lock.unlock();
+        for (auto& completed_task : completed_tasks) {
+            update(read_wait_stats, completed_task);
+            const auto& contig = contig_name(completed_task.region);
+            write_or_buffer(std::move(completed_task), buffered_tasks.at(contig),
+                            running_tasks.at(contig), holdbacks.at(contig),
+                            task_writer_sync, calling_components.at(contig));
+            --num_running_tasks;
         }
+        completed_tasks.clear();
     }
     assert(task_maker_sync.num_tasks == 0);
     assert(pending_tasks.empty());
@@ -1272,8 +1485,10 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     holdbacks.clear(); // holdbacks are just references to buffered tasks
     if (debug_log) *debug_log << "Finished making new tasks. Waiting for task writer to complete existing jobs";
     wait_until_finished(task_writer_sync);
-    write_remaining_tasks(futures, buffered_tasks, temp_writers, calling_components);
+    write_remaining_tasks(buffered_tasks, temp_writers, calling_components);
     components.progress_meter().stop();
+    log_scheduler_statistics(scheduler);
+    log_read_wait_statistics(read_wait_stats);
     merge(std::move(temp_writers), components);
 }
 
@@ -1370,9 +1585,42 @@ Pedigree get_pedigree(const GenomeCallingComponents& components)
     return *result;
 }
 
+// Single-pass filters classify each call independently, so can filter calls as they are made, rather than
+// re-reading the calls in a second pass. Filter reads are fetched for each calling region if the filter does
+// not use the calling reads. The unfiltered calls must not be required. As the filtering blocks, read windows,
+// and read assignment likelihoods may differ from the second pass, this must be requested.
+bool can_fuse_call_filtering(const GenomeCallingComponents& components)
+{
+    return apply_csr(components) && components.filter_during_calling() && !components.filter_request()
+           && !components.keep_unfiltered_calls();
+}
+
+void fuse_call_filtering(GenomeCallingComponents& components, const UserCommandInfo& info)
+{
+    if (can_fuse_call_filtering(components)) {
+        const auto calling_header = make_caller_output_header(components, info);
+        BufferedReadPipe read_pipe {components.filter_read_pipe(), BufferedReadPipe::Config {components.read_buffer_size()}};
+        auto filter = components.call_filter_factory().make(components.reference(), std::move(read_pipe), calling_header,
+                                                            components.ploidies(),
+                                                            make_filtering_haplotype_likelihood_model(components),
+                                                            get_pedigree(components));
+        assert(filter);
+        if (filter->can_filter_in_memory()) {
+            static auto debug_log = get_debug_log();
+            if (debug_log) *debug_log << "Applying Call Set Refinement (CSR) filters during calling";
+            auto output_header = filter->make_header(calling_header);
+            boost::optional<const ReadPipe&> filter_read_pipe {};
+            if (std::addressof(components.filter_read_pipe()) != std::addressof(components.read_pipe())) {
+                filter_read_pipe = components.filter_read_pipe();
+            }
+            components.set_fused_call_filter({std::move(filter), std::move(output_header), filter_read_pipe});
+        }
+    }
+}
+
 void run_csr(GenomeCallingComponents& components)
 {
-    if (apply_csr(components)) {
+    if (apply_csr(components) && !components.fused_call_filter()) {
         log_filtering_info(components);
         ProgressMeter progress {components.search_regions()};
         const auto& filter_factory = components.call_filter_factory();
@@ -1384,9 +1632,11 @@ void run_csr(GenomeCallingComponents& components)
             input_path = components.output().path();
         }
         assert(input_path); // cannot be stdout
+        ThreadPool read_prefetcher {1}; // must outlive buffered_rp
         BufferedReadPipe::Config buffer_config {components.read_buffer_size()};
         buffer_config.fetch_expansion = 100;
         buffer_config.max_hint_gap = 5'000;
+        buffer_config.prefetch_workers = read_prefetcher;
         BufferedReadPipe buffered_rp {filter_read_pipe, buffer_config};
         if (use_unfiltered_call_region_hints_for_filtering(components)) {
             buffered_rp.hint(extract_call_regions(*input_path));
@@ -1442,6 +1692,7 @@ void run_variant_calling(GenomeCallingComponents& components, UserCommandInfo in
 {
     static auto debug_log = get_debug_log();
     log_run_start(components, info);
+    fuse_call_filtering(components, info);
     write_caller_output_header(components, info);
     const auto start = std::chrono::system_clock::now();
     try {
@@ -1468,6 +1719,9 @@ void run_variant_calling(GenomeCallingComponents& components, UserCommandInfo in
         throw CallingBug {};
     }
     components.output().close();
+    if (components.fused_call_filter()) {
+        components.filtered_output()->close();
+    }
     try {
         run_csr(components);
     } catch (const Error& e) {
@@ -369,6 +369,34 @@ compute_haplotype_support(const Genotype<Haplotype>& genotype,
     return compute_haplotype_support(genotype, reads, std::move(model), ambiguous, config);
 }
 
+HaplotypeSupportMap
+compute_haplotype_support(const Genotype<Haplotype>& genotype,
+                          const std::vector<AlignedRead>& reads,
+                          const HaplotypeLikelihoodMap& likelihoods,
+                          AmbiguousReadList& ambiguous,
+                          AssignmentConfig config)
+{
+    if (!reads.empty()) {
+        if (!genotype.is_homozygous()) {
+            const auto unique_haplotypes = genotype.copy_unique();
+            assert(unique_haplotypes.size() > 1);
+            const std::vector<double> priors(unique_haplotypes.size());
+            HaplotypeLikelihoods haplotype_likelihoods {};
+            haplotype_likelihoods.reserve(unique_haplotypes.size());
+            for (const auto& haplotype : unique_haplotypes) {
+                haplotype_likelihoods.push_back(likelihoods.at(haplotype));
+                assert(haplotype_likelihoods.back().size() == reads.size());
+            }
+            return calculate_support(unique_haplotypes, reads, priors, haplotype_likelihoods, ambiguous, config);
+        } else if (config.ambiguous_action != AssignmentConfig::AmbiguousAction::drop) {
+            HaplotypeSupportMap result {};
+            result.emplace(genotype[0], reads);
+            return result;
+        }
+    }
+    return {};
+}
+
 HaplotypeTemplateSupportMap
 compute_haplotype_support(const Genotype<Haplotype>& genotype,
                           const std::vector<AlignedTemplate>& reads,
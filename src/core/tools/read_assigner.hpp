@@ -27,6 +27,7 @@ namespace octopus {
 class HaplotypeLikelihoodModel;
 
 using HaplotypeProbabilityMap = std::unordered_map<Haplotype, double>;
+using HaplotypeLikelihoodMap = std::unordered_map<Haplotype, std::vector<double>>;
 using ReadSupportSet = std::vector<AlignedRead>;
 using HaplotypeSupportMap = std::unordered_map<Haplotype, ReadSupportSet>;
 using TemplateSupportSet = std::vector<AlignedTemplate>;
@@ -112,6 +113,14 @@ compute_haplotype_support(const Genotype<Haplotype>& genotype,
                           HaplotypeLikelihoodModel model,
                           AssignmentConfig config = AssignmentConfig {});
 
+// Uses the given likelihoods of the reads, in order, for each haplotype in the genotype rather than computing them
+HaplotypeSupportMap
+compute_haplotype_support(const Genotype<Haplotype>& genotype,
+                          const std::vector<AlignedRead>& reads,
+                          const HaplotypeLikelihoodMap& likelihoods,
+                          AmbiguousReadList& ambiguous,
+                          AssignmentConfig config = AssignmentConfig {});
+
 // AlignedTemplate
 
 HaplotypeTemplateSupportMap
@@ -286,7 +286,8 @@ std::string CigarScanner::name() const
 double CigarScanner::add_snvs_in_match_range(const GenomicRegion& region, const AlignedRead& read,
                                              std::size_t read_index, const SampleName& origin)
 {
-    const NucleotideSequence ref_segment {reference_.get().fetch_sequence(region)};
+    thread_local NucleotideSequence ref_segment {};
+    reference_.get().fetch_sequence(region, ref_segment);
     double misalignment_penalty {0};
     for (std::size_t ref_index {0}; ref_index < ref_segment.size(); ++ref_index, ++read_index) {
         const char ref_base {ref_segment[ref_index]}, read_base {read.sequence()[read_index]};
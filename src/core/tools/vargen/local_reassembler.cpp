@@ -7,8 +7,9 @@
 #include <iterator>
 #include <deque>
 #include <stdexcept>
-#include <thread>
+#include <vector>
 #include <future>
+#include <utility>
 #include <cassert>
 
 #include "tandem/tandem.hpp"
@@ -22,6 +23,7 @@
 #include "utils/append.hpp"
 #include "utils/global_aligner.hpp"
 #include "utils/read_stats.hpp"
+#include "utils/work_stealing_scheduler.hpp"
 #include "io/reference/reference_genome.hpp"
 #include "logging/logging.hpp"
 
@@ -238,8 +240,9 @@ auto transform_low_quality_matches_to_reference(const AlignedRead& read,
                                                 const AlignedRead::BaseQuality min_quality,
                                                 const ReferenceGenome& reference)
 {
-    return transform_low_quality_matches_to_reference(read.sequence(), read.base_qualities(),
-                                                      reference.fetch_sequence(mapped_region(read)),
+    thread_local AlignedRead::NucleotideSequence reference_sequence {};
+    reference.fetch_sequence(mapped_region(read), reference_sequence);
+    return transform_low_quality_matches_to_reference(read.sequence(), read.base_qualities(), reference_sequence,
                                                       read.cigar(), min_quality);
 }
 
@@ -347,7 +350,11 @@ std::vector<Variant> LocalReassembler::do_generate(const RegionSet& regions) con
     finalise_bins(bins, regions);
     if (bins.empty()) return {};
     std::deque<Variant> candidates {};
-    if (execution_policy_ == ExecutionPolicy::seq || bins.size() < 2) {
+    // Bins are only assembled in parallel on the calling workers, so threads are never oversubscribed
+    auto scheduler = execution_policy_ == ExecutionPolicy::par && bins.size() > 1 ? WorkStealingScheduler::current() : nullptr;
+    if (scheduler) {
+        assemble_in_parallel(bins, *scheduler, candidates);
+    } else {
         for (auto& bin : bins) {
             if (debug_log_) {
                 stream(*debug_log_) << "Assembling " << bin.size() << " reads in bin " << mapped_region(bin);
@@ -358,29 +365,6 @@ std::vector<Variant> LocalReassembler::do_generate(const RegionSet& regions) con
             }
             bin.clear();
         }
-    } else {
-        const std::size_t num_threads {4};
-        std::vector<std::future<std::deque<Variant>>> bin_futures(std::min(bins.size(), num_threads));
-        for (auto first_bin = std::begin(bins), last_bin = std::end(bins); first_bin != last_bin; ) {
-            const auto batch_size = std::min(num_threads, static_cast<std::size_t>(std::distance(first_bin, last_bin)));
-            const auto next_bin = std::next(first_bin, batch_size);
-            auto last_future = std::transform(first_bin, next_bin, std::begin(bin_futures), [&] (Bin& bin) {
-                if (debug_log_) {
-                    stream(*debug_log_) << "Assembling " << bin.size() << " reads in bin " << mapped_region(bin);
-                }
-                return std::async([&] () {
-                    std::deque<Variant> result {};
-                    const auto num_default_failures = try_assemble_with_defaults(bin, result);
-                    if (num_default_failures == default_kmer_sizes_.size()) {
-                        try_assemble_with_fallbacks(bin, result);
-                    }
-                    bin.clear();
-                    return result;
-                });
-            });
-            std::for_each(std::begin(bin_futures), last_future, [&] (auto& f) { utils::append(f.get(), candidates); });
-            first_bin = next_bin;
-        }
     }
     remove_duplicates(candidates);
     remove_larger_than(candidates, max_variant_size_);
@@ -485,25 +469,100 @@ void log_failure(L& log, const char* type, const unsigned k)
     if (log) stream(*log, 8) << type << " assembler with kmer size " << k << " failed";
 }
 
+template <typename R>
+void join(WorkStealingScheduler& scheduler, std::future<R>& task) noexcept
+{
+    if (task.valid()) {
+        try {
+            scheduler.wait(task);
+        } catch (...) {}
+    }
+}
+
 } // namespace
 
+void LocalReassembler::assemble_in_parallel(BinList& bins, WorkStealingScheduler& scheduler, std::deque<Variant>& result) const
+{
+    // Every default kmer size of every bin is an independent task, and fallbacks are started as soon as
+    // all of a bin's defaults have failed. Results are merged in bin then kmer size order, as if sequential.
+    using AttemptResult = std::pair<AssemblerStatus, std::deque<Variant>>;
+    std::vector<std::vector<std::future<AttemptResult>>> default_attempts {};
+    default_attempts.reserve(bins.size());
+    for (const auto& bin : bins) {
+        if (debug_log_) {
+            stream(*debug_log_) << "Assembling " << bin.size() << " reads in bin " << mapped_region(bin);
+        }
+        std::vector<std::future<AttemptResult>> bin_attempts {};
+        bin_attempts.reserve(default_kmer_sizes_.size());
+        for (const auto k : default_kmer_sizes_) {
+            bin_attempts.push_back(scheduler.push([this, &bin, k] () {
+                AttemptResult attempt {};
+                attempt.first = assemble_bin(k, bin, attempt.second);
+                return attempt;
+            }));
+        }
+        default_attempts.push_back(std::move(bin_attempts));
+    }
+    std::vector<std::deque<Variant>> bin_results(bins.size());
+    std::vector<boost::optional<std::future<std::deque<Variant>>>> fallback_attempts(bins.size());
+    try {
+        for (std::size_t bin_idx {0}; bin_idx < bins.size(); ++bin_idx) {
+            unsigned num_failures {0};
+            for (std::size_t k_idx {0}; k_idx < default_kmer_sizes_.size(); ++k_idx) {
+                auto attempt = scheduler.wait(default_attempts[bin_idx][k_idx]);
+                if (log_default_attempt(default_kmer_sizes_[k_idx], attempt.first)) ++num_failures;
+                utils::append(std::move(attempt.second), bin_results[bin_idx]);
+            }
+            if (num_failures == default_kmer_sizes_.size()) {
+                const auto& bin = bins[bin_idx];
+                fallback_attempts[bin_idx] = scheduler.push([this, &bin] () {
+                    std::deque<Variant> variants {};
+                    try_assemble_with_fallbacks(bin, variants);
+                    return variants;
+                });
+            }
+        }
+        for (std::size_t bin_idx {0}; bin_idx < bins.size(); ++bin_idx) {
+            if (fallback_attempts[bin_idx]) {
+                utils::append(scheduler.wait(*fallback_attempts[bin_idx]), bin_results[bin_idx]);
+            }
+        }
+    } catch (...) {
+        // The attempts still running reference the bins, so must all be joined before the bins are released
+        for (auto& bin_attempts : default_attempts) {
+            for (auto& attempt : bin_attempts) join(scheduler, attempt);
+        }
+        for (auto& attempt : fallback_attempts) {
+            if (attempt) join(scheduler, *attempt);
+        }
+        throw;
+    }
+    for (std::size_t bin_idx {0}; bin_idx < bins.size(); ++bin_idx) {
+        bins[bin_idx].clear();
+        utils::append(std::move(bin_results[bin_idx]), result);
+    }
+}
+
+bool LocalReassembler::log_default_attempt(const unsigned kmer_size, const AssemblerStatus status) const
+{
+    switch (status) {
+        case AssemblerStatus::success:
+            log_success(debug_log_, "Default", kmer_size);
+            return false;
+        case AssemblerStatus::partial_success:
+            log_partial_success(debug_log_, "Default", kmer_size);
+            return true;
+        default:
+            log_failure(debug_log_, "Default", kmer_size);
+            return true;
+    }
+}
+
 unsigned LocalReassembler::try_assemble_with_defaults(const Bin& bin, std::deque<Variant>& result) const
 {
     unsigned num_failures {0};
     for (const auto k : default_kmer_sizes_) {
-        const auto status = assemble_bin(k, bin, result);
-        switch (status) {
-            case AssemblerStatus::success:
-                log_success(debug_log_, "Default", k);
-                break;
-            case AssemblerStatus::partial_success:
-                log_partial_success(debug_log_, "Default", k);
-                ++num_failures;
-                break;
-            default:
-                log_failure(debug_log_, "Default", k);
-                ++num_failures;
-        }
+        if (log_default_attempt(k, assemble_bin(k, bin, result))) ++num_failures;
     }
     return num_failures;
 }
@@ -25,6 +25,7 @@
 namespace octopus {
 
 class ReferenceGenome;
+class WorkStealingScheduler;
 
 namespace coretools {
 
@@ -127,6 +128,8 @@ private:
     void prepare_bins(const GenomicRegion& active_region, BinList& bins) const;
     bool should_assemble_bin(const Bin& bin) const;
     void finalise_bins(BinList& bins, const RegionSet& active_regions) const;
+    void assemble_in_parallel(BinList& bins, WorkStealingScheduler& scheduler, std::deque<Variant>& result) const;
+    bool log_default_attempt(unsigned kmer_size, AssemblerStatus status) const;
     unsigned try_assemble_with_defaults(const Bin& bin, std::deque<Variant>& result) const;
     void try_assemble_with_fallbacks(const Bin& bin, std::deque<Variant>& result) const;
     GenomicRegion propose_assembler_region(const GenomicRegion& input_region, unsigned kmer_size) const;
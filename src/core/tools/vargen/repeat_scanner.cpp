@@ -165,7 +165,8 @@ void RepeatScanner::add_read(const AlignedRead& read, const unsigned sample_inde
 
 void RepeatScanner::add_match_range(const GenomicRegion& region, const AlignedRead& read, std::size_t read_index, const unsigned sample_index) const
 {
-    const auto ref_segment = reference_.get().fetch_sequence(region);
+    thread_local ReferenceGenome::GeneticSequence ref_segment {};
+    reference_.get().fetch_sequence(region, ref_segment);
     for (std::size_t ref_index {0}; ref_index < ref_segment.size(); ++ref_index, ++read_index) {
         const char ref_base {ref_segment[ref_index]}, read_base {read.sequence()[read_index]};
         if (ref_base != read_base) {
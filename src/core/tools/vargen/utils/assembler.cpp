@@ -9,10 +9,10 @@
 #include <cmath>
 #include <numeric>
 #include <limits>
+#include <cstdint>
 #include <cassert>
 #include <iostream>
 
-#include <boost/functional/hash.hpp>
 #include <boost/property_map/property_map.hpp>
 #include <boost/graph/depth_first_search.hpp>
 #include <boost/graph/breadth_first_search.hpp>
@@ -31,8 +31,6 @@
 #include "utils/append.hpp"
 #include "utils/maths.hpp"
 
-#define _unused(x) ((void)(x))
-
 namespace octopus { namespace coretools {
 
 namespace {
@@ -49,6 +47,113 @@ std::size_t count_kmers(const T& sequence, const unsigned kmer_size) noexcept
     return sequence.size() >= kmer_size ? sequence.size() - kmer_size + 1 : 0;
 }
 
+constexpr unsigned basesPerKmerWord {32};
+
+unsigned num_kmer_words(const unsigned kmer_size) noexcept
+{
+    return (kmer_size + basesPerKmerWord - 1) / basesPerKmerWord;
+}
+
+std::uint64_t encode_base(const char base) noexcept
+{
+    switch (base) {
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return 0;
+    }
+}
+
+char decode_base(const std::uint64_t* kmer, const unsigned i) noexcept
+{
+    return "ACGT"[(kmer[i / basesPerKmerWord] >> (2 * (i % basesPerKmerWord))) & 3];
+}
+
+void set_base(std::uint64_t* kmer, const unsigned i, const std::uint64_t code) noexcept
+{
+    auto& word = kmer[i / basesPerKmerWord];
+    const auto shift = 2 * (i % basesPerKmerWord);
+    word = (word & ~(std::uint64_t {3} << shift)) | (code << shift);
+}
+
+// Drops the first base, leaving the last base clear
+void shift_kmer(std::uint64_t* kmer, const unsigned num_words) noexcept
+{
+    for (unsigned i {1}; i < num_words; ++i) {
+        kmer[i - 1] = (kmer[i - 1] >> 2) | (kmer[i] << 62);
+    }
+    kmer[num_words - 1] >>= 2;
+}
+
+std::uint64_t hash_kmer(const std::uint64_t* kmer, const unsigned num_words) noexcept
+{
+    std::uint64_t result {0};
+    for (unsigned i {0}; i < num_words; ++i) {
+        result = (result ^ kmer[i]) * 0x9E3779B97F4A7C15ull;
+        result ^= result >> 29;
+    }
+    return result;
+}
+
+// Packs each kmer of a sequence in turn, rolling rather than repacking the whole kmer
+class KmerPacker
+{
+public:
+    KmerPacker(const std::string& sequence, const unsigned kmer_size)
+    : sequence_ {sequence}
+    , kmer_size_ {kmer_size}
+    , num_words_ {num_kmer_words(kmer_size)}
+    , kmer_(num_words_, 0)
+    , position_ {0}
+    , bases_until_canonical_ {0}
+    {
+        for (unsigned i {0}; i < kmer_size_; ++i) {
+            set(i, sequence_[i]);
+        }
+    }
+    
+    // Moves to the kmer starting at position, which must not be behind the current kmer
+    void advance_to(const std::size_t position) noexcept
+    {
+        for (; position_ < position; ++position_) {
+            shift_kmer(kmer_.data(), num_words_);
+            set(kmer_size_ - 1, sequence_[position_ + kmer_size_]);
+        }
+    }
+    
+    // Kmers with non-ACGT bases can never be in the graph
+    bool is_canonical() const noexcept { return bases_until_canonical_ == 0; }
+    
+    const std::uint64_t* data() const noexcept { return kmer_.data(); }
+    
+private:
+    const std::string& sequence_;
+    unsigned kmer_size_, num_words_;
+    std::vector<std::uint64_t> kmer_;
+    std::size_t position_;
+    unsigned bases_until_canonical_;
+    
+    void set(const unsigned i, const char base) noexcept
+    {
+        set_base(kmer_.data(), i, encode_base(base));
+        if (!utils::is_dna_nucleotide(base)) {
+            bases_until_canonical_ = kmer_size_;
+        } else if (bases_until_canonical_ > 0) {
+            --bases_until_canonical_;
+        }
+    }
+};
+
+constexpr std::uint32_t emptyKmerSlot {std::numeric_limits<std::uint32_t>::max()}, erasedKmerSlot {emptyKmerSlot - 1};
+constexpr std::size_t minNumKmerSlots {64};
+
+std::size_t next_power_of_two(std::size_t n) noexcept
+{
+    std::size_t result {1};
+    while (result < n) result <<= 1;
+    return result;
+}
+
 } // namespace
 
 // public methods
@@ -65,15 +170,17 @@ const char* Assembler::NonCanonicalReferenceSequence::what() const noexcept
 
 Assembler::Assembler(const Parameters params)
 : params_ {params}
-, reference_kmers_ {}
 , reference_head_position_ {0}
+, graph_ {}
+, kmers_ {params.kmer_size}
 , reference_vertices_ {}
 {}
 
 Assembler::Assembler(const Parameters params, const NucleotideSequence& reference)
 : params_ {params}
-, reference_kmers_ {}
 , reference_head_position_ {0}
+, graph_ {}
+, kmers_ {params.kmer_size}
 , reference_vertices_ {}
 {
     insert_reference_into_empty_graph(reference);
@@ -94,7 +201,7 @@ void Assembler::insert_reference(const NucleotideSequence& sequence)
     if (sequence.size() >= kmer_size()) {
         if (is_empty()) {
             insert_reference_into_empty_graph(sequence);
-        } else if (reference_kmers_.empty()) {
+        } else if (reference_vertices_.empty()) {
             insert_reference_into_populated_graph(sequence);
         } else {
             throw std::runtime_error {"Assembler: only one reference sequence can be inserted into the graph"};
@@ -110,113 +217,118 @@ void Assembler::insert_read(const NucleotideSequence& sequence,
 {
     if (sequence.size() >= kmer_size()) {
         const bool is_forward_strand {strand == Direction::forward};
-        auto kmer_begin = std::cbegin(sequence);
-        auto kmer_end   = std::next(kmer_begin, kmer_size());
+        const auto num_kmers = count_kmers(sequence, kmer_size());
+        const auto num_words = num_kmer_words(kmer_size());
+        KmerPacker kmer {sequence, kmer_size()};
+        const auto find_kmer = [&] () -> boost::optional<Vertex> {
+            if (!kmer.is_canonical()) return boost::none;
+            return kmers_.find(kmer.data());
+        };
+        const auto is_kmer_of = [&] (const Vertex v) {
+            return kmer.is_canonical() && std::equal(kmer.data(), kmer.data() + num_words, packed_kmer_of(v));
+        };
+        std::size_t kmer_pos {0};
         auto base_quality_itr = std::next(std::cbegin(base_qualities), kmer_size());
-        Kmer prev_kmer {kmer_begin, kmer_end};
+        Vertex prev_vertex {null_vertex()};
         bool prev_kmer_good {true};
-        auto vertex_itr = vertex_cache_.find(prev_kmer);
-        auto ref_kmer_itr = std::cbegin(reference_kmers_);
-        if (vertex_itr == std::cend(vertex_cache_)) {
-            const auto u = add_vertex(prev_kmer);
-            if (!u) prev_kmer_good = false;
-        } else if (is_reference(vertex_itr->second)) {
-            ref_kmer_itr = std::find(std::cbegin(reference_kmers_), std::cend(reference_kmers_), prev_kmer);
-            assert(ref_kmer_itr != std::cend(reference_kmers_));
-            auto next_kmer_begin = std::next(kmer_begin);
-            auto next_kmer_end   = std::next(kmer_end);
-            const auto ref_offset = std::distance(std::cbegin(reference_kmers_), ref_kmer_itr);
-            auto ref_vertex_itr = std::next(std::cbegin(reference_vertices_), ref_offset);
+        const auto vertex = find_kmer();
+        auto ref_vertex_itr = std::cbegin(reference_vertices_);
+        if (!vertex) {
+            if (kmer.is_canonical()) {
+                prev_vertex = add_vertex(kmer.data());
+            } else {
+                prev_kmer_good = false;
+            }
+        } else if (is_reference(*vertex)) {
+            ref_vertex_itr = std::find(std::cbegin(reference_vertices_), std::cend(reference_vertices_), *vertex);
+            assert(ref_vertex_itr != std::cend(reference_vertices_));
+            auto next_kmer_pos = kmer_pos + 1;
+            const auto ref_offset = std::distance(std::cbegin(reference_vertices_), ref_vertex_itr);
+            auto prev_ref_vertex_itr = ref_vertex_itr;
             auto ref_edge_itr = std::next(std::cbegin(reference_edges_), ref_offset);
-            ++ref_kmer_itr;
-            for (; next_kmer_end <= std::cend(sequence) && ref_kmer_itr < std::cend(reference_kmers_);
-                   ++next_kmer_begin, ++next_kmer_end, ++ref_kmer_itr, ++ref_vertex_itr, ++ref_edge_itr, ++base_quality_itr) {
-                if (std::equal(next_kmer_begin, next_kmer_end, std::cbegin(*ref_kmer_itr))) {
+            ++ref_vertex_itr;
+            for (; next_kmer_pos < num_kmers && ref_vertex_itr < std::cend(reference_vertices_);
+                   ++next_kmer_pos, ++ref_vertex_itr, ++prev_ref_vertex_itr, ++ref_edge_itr, ++base_quality_itr) {
+                kmer.advance_to(next_kmer_pos);
+                if (is_kmer_of(*ref_vertex_itr)) {
                     assert(ref_edge_itr != std::cend(reference_edges_));
                     increment_weight(*ref_edge_itr, is_forward_strand, *base_quality_itr);
                 } else {
                     break;
                 }
             }
-            if (next_kmer_end > std::cend(sequence)) {
+            if (next_kmer_pos >= num_kmers) {
                 return;
             }
-            kmer_begin = std::prev(next_kmer_begin);
-            kmer_end   = std::prev(next_kmer_end);
-            assert(kmer_end <= std::cend(sequence));
-            prev_kmer = Kmer {kmer_begin, kmer_end};
+            kmer_pos = next_kmer_pos - 1;
+            prev_vertex = *prev_ref_vertex_itr;
+        } else {
+            prev_vertex = *vertex;
         }
-        ++kmer_begin;
-        ++kmer_end;
-        for (; kmer_end <= std::cend(sequence); ++kmer_begin, ++kmer_end, ++base_quality_itr) {
-            Kmer kmer {kmer_begin, kmer_end};
-            const auto kmer_itr = vertex_cache_.find(kmer);
-            if (kmer_itr == std::cend(vertex_cache_)) {
-                const auto v = add_vertex(kmer);
-                if (v) {
+        for (++kmer_pos; kmer_pos < num_kmers; ++kmer_pos, ++base_quality_itr) {
+            kmer.advance_to(kmer_pos);
+            const auto v = find_kmer();
+            if (!v) {
+                if (kmer.is_canonical()) {
+                    const auto u = add_vertex(kmer.data());
                     if (prev_kmer_good) {
-                        assert(vertex_cache_.count(prev_kmer) == 1);
-                        const auto u = vertex_cache_.at(prev_kmer);
-                        add_edge(u, *v, 1, is_forward_strand, *base_quality_itr);
+                        add_edge(prev_vertex, u, 1, is_forward_strand, *base_quality_itr);
                     }
+                    prev_vertex = u;
                     prev_kmer_good = true;
                 } else {
                     prev_kmer_good = false;
                 }
             } else {
                 if (prev_kmer_good) {
-                    const auto u = vertex_cache_.at(prev_kmer);
-                    const auto v = kmer_itr->second;
                     Edge e; bool e_in_graph;
-                    std::tie(e, e_in_graph) = boost::edge(u, v, graph_);
+                    std::tie(e, e_in_graph) = boost::edge(prev_vertex, *v, graph_);
                     if (e_in_graph) {
                         increment_weight(e, is_forward_strand, *base_quality_itr);
                     } else {
-                        add_edge(u, v, 1, is_forward_strand, *base_quality_itr);
+                        add_edge(prev_vertex, *v, 1, is_forward_strand, *base_quality_itr);
                     }
                 }
-                if (is_reference(kmer_itr->second)) {
-                    ref_kmer_itr = std::find(ref_kmer_itr, std::cend(reference_kmers_), kmer);
-                    if (ref_kmer_itr != std::cend(reference_kmers_)) {
-                        auto next_kmer_begin = std::next(kmer_begin);
-                        auto next_kmer_end   = std::next(kmer_end);
-                        const auto ref_offset = std::distance(std::cbegin(reference_kmers_), ref_kmer_itr);
-                        auto ref_vertex_itr = std::next(std::cbegin(reference_vertices_), ref_offset);
+                prev_vertex = *v;
+                if (is_reference(*v)) {
+                    ref_vertex_itr = std::find(ref_vertex_itr, std::cend(reference_vertices_), *v);
+                    if (ref_vertex_itr != std::cend(reference_vertices_)) {
+                        auto next_kmer_pos = kmer_pos + 1;
+                        const auto ref_offset = std::distance(std::cbegin(reference_vertices_), ref_vertex_itr);
+                        auto prev_ref_vertex_itr = ref_vertex_itr;
                         auto ref_edge_itr = std::next(std::cbegin(reference_edges_), ref_offset);
-                        ++ref_kmer_itr;
-                        for (; next_kmer_end <= std::cend(sequence) && ref_kmer_itr < std::cend(reference_kmers_);
-                               ++next_kmer_begin, ++next_kmer_end, ++ref_kmer_itr, ++ref_vertex_itr, ++ref_edge_itr) {
-                            if (std::equal(next_kmer_begin, next_kmer_end, std::cbegin(*ref_kmer_itr))) {
+                        ++ref_vertex_itr;
+                        for (; next_kmer_pos < num_kmers && ref_vertex_itr < std::cend(reference_vertices_);
+                               ++next_kmer_pos, ++ref_vertex_itr, ++prev_ref_vertex_itr, ++ref_edge_itr) {
+                            kmer.advance_to(next_kmer_pos);
+                            if (is_kmer_of(*ref_vertex_itr)) {
                                 assert(ref_edge_itr != std::cend(reference_edges_));
                                 increment_weight(*ref_edge_itr, is_forward_strand, *base_quality_itr);
                             } else {
                                 break;
                             }
                         }
-                        if (next_kmer_end > std::cend(sequence)) {
+                        if (next_kmer_pos >= num_kmers) {
                             return;
                         }
-                        kmer_begin = std::prev(next_kmer_begin);
-                        kmer_end   = std::prev(next_kmer_end);
-                        assert(kmer_end <= std::cend(sequence));
-                        kmer = Kmer {kmer_begin, kmer_end};
+                        kmer_pos = next_kmer_pos - 1;
+                        prev_vertex = *prev_ref_vertex_itr;
                     }
                 }
                 prev_kmer_good = true;
             }
-            prev_kmer = kmer;
         }
     }
 }
 
 std::size_t Assembler::num_kmers() const noexcept
 {
-    return vertex_cache_.size();
+    return kmers_.size();
 }
 
 bool Assembler::is_empty() const noexcept
 {
-    return vertex_cache_.empty();
+    return kmers_.empty();
 }
 
 bool Assembler::is_acyclic() const
@@ -316,9 +428,7 @@ void Assembler::cleanup()
 void Assembler::clear()
 {
     graph_.clear();
-    vertex_cache_.clear();
-    reference_kmers_.clear();
-    reference_kmers_.shrink_to_fit();
+    kmers_.clear();
     reference_vertices_.clear();
     reference_vertices_.shrink_to_fit();
     reference_edges_.clear();
@@ -373,97 +483,157 @@ void Assembler::write_dot(std::ostream& out) const
     boost::write_graphviz(out, graph_, vertex_writer, edge_writer, graph_writer);
 }
 
-// Kmer
-Assembler::Kmer::Kmer(SequenceIterator first, SequenceIterator last) noexcept
-: first_ {first}
-, last_ {last}
-, hash_ {boost::hash_range(first_, last_)}
+// KmerTable
+
+Assembler::KmerTable::KmerTable(const unsigned kmer_size)
+: num_words_ {num_kmer_words(kmer_size)}
+, slots_ {}
+, words_ {}
+, vertices_ {}
+, free_ids_ {}
+, size_ {0}
+, num_tombstones_ {0}
 {}
 
-char Assembler::Kmer::front() const noexcept
+std::size_t Assembler::KmerTable::size() const noexcept
 {
-    return *first_;
+    return size_;
 }
 
-char Assembler::Kmer::back() const noexcept
+bool Assembler::KmerTable::empty() const noexcept
 {
-    return *std::prev(last_);
+    return size_ == 0;
 }
 
-Assembler::Kmer::SequenceIterator Assembler::Kmer::begin() const noexcept
+void Assembler::KmerTable::reserve(const std::size_t n)
 {
-    return first_;
+    if (2 * n > slots_.size()) {
+        rehash(std::max(next_power_of_two(2 * n), minNumKmerSlots));
+    }
+    words_.reserve(n * num_words_);
+    vertices_.reserve(n);
 }
 
-Assembler::Kmer::SequenceIterator Assembler::Kmer::end() const noexcept
+void Assembler::KmerTable::clear() noexcept
 {
-    return last_;
+    slots_.clear();
+    words_.clear();
+    vertices_.clear();
+    free_ids_.clear();
+    size_ = 0;
+    num_tombstones_ = 0;
 }
 
-Assembler::Kmer::operator NucleotideSequence() const
+boost::optional<Assembler::Vertex> Assembler::KmerTable::find(const KmerWord* kmer) const noexcept
 {
-    return NucleotideSequence {first_, last_};
+    if (empty()) return boost::none;
+    const auto& slot = slots_[find_slot(kmer, hash_kmer(kmer, num_words_))];
+    if (slot.id == emptyKmerSlot) return boost::none;
+    return vertices_[slot.id];
 }
 
-std::size_t Assembler::Kmer::hash() const noexcept
+Assembler::KmerId Assembler::KmerTable::insert(const KmerWord* kmer, const Vertex v)
 {
-    return hash_;
+    assert(!find(kmer));
+    if (4 * (size_ + num_tombstones_ + 1) > 3 * slots_.size()) {
+        rehash(std::max(next_power_of_two(4 * (size_ + 1)), minNumKmerSlots));
+    }
+    KmerId result;
+    if (free_ids_.empty()) {
+        result = static_cast<KmerId>(vertices_.size());
+        words_.insert(std::cend(words_), kmer, kmer + num_words_);
+        vertices_.push_back(v);
+    } else {
+        result = free_ids_.back();
+        free_ids_.pop_back();
+        std::copy(kmer, kmer + num_words_, std::next(std::begin(words_), result * num_words_));
+        vertices_[result] = v;
+    }
+    const auto hash = hash_kmer(kmer, num_words_);
+    const auto mask = slots_.size() - 1;
+    auto slot_idx = hash & mask;
+    while (slots_[slot_idx].id != emptyKmerSlot && slots_[slot_idx].id != erasedKmerSlot) {
+        slot_idx = (slot_idx + 1) & mask;
+    }
+    if (slots_[slot_idx].id == erasedKmerSlot) --num_tombstones_;
+    slots_[slot_idx] = Slot {static_cast<std::uint32_t>(hash >> 32), result};
+    ++size_;
+    return result;
 }
 
-bool operator==(const Assembler::Kmer& lhs, const Assembler::Kmer& rhs) noexcept
+void Assembler::KmerTable::erase(const KmerId id) noexcept
 {
-    return std::equal(lhs.first_, lhs.last_, rhs.first_);
+    const auto kmer = this->kmer(id);
+    auto& slot = slots_[find_slot(kmer, hash_kmer(kmer, num_words_))];
+    assert(slot.id == id);
+    slot.id = erasedKmerSlot;
+    ++num_tombstones_;
+    --size_;
+    free_ids_.push_back(id);
 }
 
-bool operator<(const Assembler::Kmer& lhs, const Assembler::Kmer& rhs) noexcept
+const Assembler::KmerWord* Assembler::KmerTable::kmer(const KmerId id) const noexcept
 {
-    return std::lexicographical_compare(lhs.first_, lhs.last_, rhs.first_, rhs.last_);
+    return words_.data() + static_cast<std::size_t>(id) * num_words_;
 }
+
+std::size_t Assembler::KmerTable::find_slot(const KmerWord* kmer, const std::uint64_t hash) const noexcept
+{
+    const auto mask = slots_.size() - 1;
+    const auto tag = static_cast<std::uint32_t>(hash >> 32);
+    for (auto slot_idx = hash & mask;; slot_idx = (slot_idx + 1) & mask) {
+        const auto& slot = slots_[slot_idx];
+        if (slot.id == emptyKmerSlot
+            || (slot.id != erasedKmerSlot && slot.hash == tag && std::equal(kmer, kmer + num_words_, this->kmer(slot.id)))) {
+            return slot_idx;
+        }
+    }
+}
+
+void Assembler::KmerTable::rehash(const std::size_t num_slots)
+{
+    std::vector<Slot> slots(num_slots, Slot {0, emptyKmerSlot});
+    const auto mask = num_slots - 1;
+    for (const auto& slot : slots_) {
+        if (slot.id != emptyKmerSlot && slot.id != erasedKmerSlot) {
+            auto slot_idx = hash_kmer(kmer(slot.id), num_words_) & mask;
+            while (slots[slot_idx].id != emptyKmerSlot) {
+                slot_idx = (slot_idx + 1) & mask;
+            }
+            slots[slot_idx] = slot;
+        }
+    }
+    slots_ = std::move(slots);
+    num_tombstones_ = 0;
+}
+
 //
 // Assembler private methods
 //
 void Assembler::insert_reference_into_empty_graph(const NucleotideSequence& sequence)
 {
     assert(sequence.size() >= kmer_size());
-    vertex_cache_.reserve(sequence.size() + std::pow(4, 5));
-    auto kmer_begin = std::cbegin(sequence);
-    auto kmer_end   = std::next(kmer_begin, kmer_size());
-    reference_kmers_.emplace_back(kmer_begin, kmer_end);
-    if (!contains_kmer(reference_kmers_.back())) {
-        const auto u = add_vertex(reference_kmers_.back(), true);
-        if (!u) {
+    kmers_.reserve(sequence.size() + std::pow(4, 5));
+    const auto num_kmers = count_kmers(sequence, kmer_size());
+    KmerPacker kmer {sequence, kmer_size()};
+    if (!kmer.is_canonical()) {
+        throw NonCanonicalReferenceSequence {sequence};
+    }
+    reference_vertices_.push_back(add_vertex(kmer.data(), true));
+    for (std::size_t kmer_pos {1}; kmer_pos < num_kmers; ++kmer_pos) {
+        kmer.advance_to(kmer_pos);
+        if (!kmer.is_canonical()) {
             throw NonCanonicalReferenceSequence {sequence};
         }
-        reference_vertices_.push_back(*u);
-    } else {
-        reference_vertices_.push_back(vertex_cache_.at(reference_kmers_.back()));
-    }
-    ++kmer_begin;
-    ++kmer_end;
-    for (; kmer_end <= std::cend(sequence); ++kmer_begin, ++kmer_end) {
-        reference_kmers_.emplace_back(kmer_begin, kmer_end);
-        const auto& kmer = reference_kmers_.back();
-        if (!contains_kmer(kmer)) {
-            const auto v = add_vertex(kmer, true);
-            if (v) {
-                reference_vertices_.push_back(*v);
-                const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
-                const auto e = add_reference_edge(u, *v);
-                reference_edges_.push_back(e);
-            } else {
-                throw NonCanonicalReferenceSequence {sequence};
-            }
-        } else {
-            const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
-            const auto v = vertex_cache_.at(kmer);
-            reference_vertices_.push_back(v);
-            const auto e = add_reference_edge(u, v);
-            reference_edges_.push_back(e);
+        const auto u = reference_vertices_.back();
+        auto v = kmers_.find(kmer.data());
+        if (!v) {
+            v = add_vertex(kmer.data(), true);
         }
+        reference_vertices_.push_back(*v);
+        reference_edges_.push_back(add_reference_edge(u, *v));
     }
-    assert(reference_vertices_.size() == reference_kmers_.size());
     assert(reference_edges_.size() == reference_vertices_.size() - 1);
-    reference_kmers_.shrink_to_fit();
     reference_vertices_.shrink_to_fit();
     reference_edges_.shrink_to_fit();
 }
@@ -471,71 +641,53 @@ void Assembler::insert_reference_into_empty_graph(const NucleotideSequence& sequ
 void Assembler::insert_reference_into_populated_graph(const NucleotideSequence& sequence)
 {
     assert(sequence.size() >= kmer_size());
-    assert(reference_kmers_.empty());
-    vertex_cache_.reserve(vertex_cache_.size() + sequence.size() + std::pow(4, 5));
-    auto kmer_begin = std::cbegin(sequence);
-    auto kmer_end   = std::next(kmer_begin, kmer_size());
-    reference_kmers_.emplace_back(kmer_begin, kmer_end);
-    if (!contains_kmer(reference_kmers_.back())) {
-        const auto u = add_vertex(reference_kmers_.back(), true);
-        if (!u) {
+    assert(reference_vertices_.empty());
+    kmers_.reserve(kmers_.size() + sequence.size() + std::pow(4, 5));
+    const auto num_kmers = count_kmers(sequence, kmer_size());
+    KmerPacker kmer {sequence, kmer_size()};
+    if (!kmer.is_canonical()) {
+        throw NonCanonicalReferenceSequence {sequence};
+    }
+    const auto head = kmers_.find(kmer.data());
+    if (head) {
+        set_vertex_reference(*head);
+        reference_vertices_.push_back(*head);
+    } else {
+        reference_vertices_.push_back(add_vertex(kmer.data(), true));
+    }
+    for (std::size_t kmer_pos {1}; kmer_pos < num_kmers; ++kmer_pos) {
+        kmer.advance_to(kmer_pos);
+        if (!kmer.is_canonical()) {
             throw NonCanonicalReferenceSequence {sequence};
         }
-        reference_vertices_.push_back(*u);
-    } else {
-        set_vertex_reference(reference_kmers_.back());
-        reference_vertices_.push_back(vertex_cache_.at(reference_kmers_.back()));
-    }
-    ++kmer_begin;
-    ++kmer_end;
-    for (; kmer_end <= std::cend(sequence); ++kmer_begin, ++kmer_end) {
-        reference_kmers_.emplace_back(kmer_begin, kmer_end);
-        if (!contains_kmer(reference_kmers_.back())) {
-            const auto v = add_vertex(reference_kmers_.back(), true);
-            if (v) {
-                reference_vertices_.push_back(*v);
-                const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
-                const auto e = add_reference_edge(u, *v);
-                reference_edges_.push_back(e);
-            } else {
-                throw NonCanonicalReferenceSequence {sequence};
-            }
+        const auto u = reference_vertices_.back();
+        const auto v = kmers_.find(kmer.data());
+        if (!v) {
+            const auto w = add_vertex(kmer.data(), true);
+            reference_vertices_.push_back(w);
+            reference_edges_.push_back(add_reference_edge(u, w));
         } else {
-            const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
-            const auto v = vertex_cache_.at(reference_kmers_.back());
-            reference_vertices_.push_back(v);
-            set_vertex_reference(v);
+            reference_vertices_.push_back(*v);
+            set_vertex_reference(*v);
             Edge e; bool e_in_graph;
-            std::tie(e, e_in_graph) = boost::edge(u, v, graph_);
+            std::tie(e, e_in_graph) = boost::edge(u, *v, graph_);
             if (e_in_graph) {
                 set_edge_reference(e);
             } else {
-                e = add_reference_edge(u, v);
+                e = add_reference_edge(u, *v);
             }
             reference_edges_.push_back(e);
         }
     }
-    vertex_cache_.rehash(vertex_cache_.size());
-    reference_kmers_.shrink_to_fit();
     reference_vertices_.shrink_to_fit();
     reference_edges_.shrink_to_fit();
     regenerate_vertex_indices();
     reference_head_position_ = 0;
 }
 
-bool Assembler::contains_kmer(const Kmer& kmer) const noexcept
-{
-    return vertex_cache_.count(kmer) == 1;
-}
-
-std::size_t Assembler::count_kmer(const Kmer& kmer) const noexcept
-{
-    return vertex_cache_.count(kmer);
-}
-
 std::size_t Assembler::reference_size() const noexcept
 {
-    return sequence_length(reference_kmers_.size(), kmer_size());
+    return sequence_length(reference_vertices_.size(), kmer_size());
 }
 
 void Assembler::regenerate_vertex_indices()
@@ -572,27 +724,22 @@ Assembler::Vertex Assembler::null_vertex() const
     return boost::graph_traits<KmerGraph>::null_vertex();
 }
 
-boost::optional<Assembler::Vertex> Assembler::add_vertex(const Kmer& kmer, const bool is_reference)
+Assembler::Vertex Assembler::add_vertex(const KmerWord* kmer, const bool is_reference)
 {
-    if (!utils::is_canonical_dna(kmer)) return boost::none;
-    const auto u = boost::add_vertex({boost::num_vertices(graph_), kmer, is_reference}, graph_);
-    vertex_cache_.emplace(kmer, u);
+    const auto u = boost::add_vertex({boost::num_vertices(graph_), 0, is_reference}, graph_);
+    graph_[u].kmer = kmers_.insert(kmer, u);
     return u;
 }
 
 void Assembler::remove_vertex(const Vertex v)
 {
-    const auto c = vertex_cache_.erase(kmer_of(v));
-    assert(c == 1);
-    _unused(c); // make production build happy
+    kmers_.erase(graph_[v].kmer);
     boost::remove_vertex(v, graph_);
 }
 
 void Assembler::clear_and_remove_vertex(const Vertex v)
 {
-    const auto c = vertex_cache_.erase(kmer_of(v));
-    assert(c == 1);
-    _unused(c); // make production build happy
+    kmers_.erase(graph_[v].kmer);
     boost::clear_vertex(v, graph_);
     boost::remove_vertex(v, graph_);
 }
@@ -640,39 +787,34 @@ void Assembler::set_vertex_reference(const Vertex v)
     graph_[v].is_reference = true;
 }
 
-void Assembler::set_vertex_reference(const Kmer& kmer)
-{
-    set_vertex_reference(vertex_cache_.at(kmer));
-}
-
 void Assembler::set_edge_reference(const Edge e)
 {
     graph_[e].is_reference = true;
 }
 
-const Assembler::Kmer& Assembler::kmer_of(const Vertex v) const
+const Assembler::KmerWord* Assembler::packed_kmer_of(const Vertex v) const
 {
-    return graph_[v].kmer;
+    return kmers_.kmer(graph_[v].kmer);
 }
 
-char Assembler::front_base_of(const Vertex v) const
-{
-    return kmer_of(v).front();
-}
-
-char Assembler::back_base_of(const Vertex v) const
+Assembler::NucleotideSequence Assembler::kmer_of(const Vertex v) const
 {
-    return kmer_of(v).back();
+    const auto kmer = packed_kmer_of(v);
+    NucleotideSequence result(kmer_size(), 'N');
+    for (unsigned i {0}; i < kmer_size(); ++i) {
+        result[i] = decode_base(kmer, i);
+    }
+    return result;
 }
 
-const Assembler::Kmer& Assembler::source_kmer_of(const Edge e) const
+char Assembler::front_base_of(const Vertex v) const
 {
-    return kmer_of(boost::source(e, graph_));
+    return decode_base(packed_kmer_of(v), 0);
 }
 
-const Assembler::Kmer& Assembler::target_kmer_of(const Edge e) const
+char Assembler::back_base_of(const Vertex v) const
 {
-    return kmer_of(boost::target(e, graph_));
+    return decode_base(packed_kmer_of(v), kmer_size() - 1);
 }
 
 bool Assembler::is_reference(const Vertex v) const
@@ -744,16 +886,15 @@ bool Assembler::is_dangling_branch(const Vertex v) const
 
 boost::optional<Assembler::Vertex> Assembler::find_joining_kmer(const Vertex v) const
 {
-    const auto& kmer = kmer_of(v);
-    NucleotideSequence adjacent_kmer {std::next(std::cbegin(kmer)), std::cend(kmer)};
-    adjacent_kmer.resize(kmer_size());
+    const auto num_words = num_kmer_words(kmer_size());
+    std::vector<KmerWord> adjacent_kmer(packed_kmer_of(v), packed_kmer_of(v) + num_words);
+    shift_kmer(adjacent_kmer.data(), num_words);
     constexpr std::array<NucleotideSequence::value_type, 4> bases {'A', 'C', 'G', 'T'};
     for (const auto base : bases) {
-        adjacent_kmer.back() = base;
-        const Kmer k {std::cbegin(adjacent_kmer), std::cend(adjacent_kmer)};
-        const auto itr = vertex_cache_.find(k);
-        if (itr != std::cend(vertex_cache_)) {
-            return itr->second;
+        set_base(adjacent_kmer.data(), kmer_size() - 1, encode_base(base));
+        const auto joining_kmer = kmers_.find(adjacent_kmer.data());
+        if (joining_kmer) {
+            return joining_kmer;
         }
     }
     return boost::none;
@@ -763,7 +904,7 @@ Assembler::NucleotideSequence Assembler::make_sequence(const Path& path) const
 {
     assert(!path.empty());
     NucleotideSequence result(kmer_size() + path.size() - 1, 'N');
-    const auto& first_kmer = kmer_of(path.front());
+    const auto first_kmer = kmer_of(path.front());
     auto itr = std::copy(std::cbegin(first_kmer), std::cend(first_kmer), std::begin(result));
     std::transform(std::next(std::cbegin(path)), std::cend(path), itr,
                   [this] (const Vertex v) { return back_base_of(v); });
@@ -781,13 +922,12 @@ Assembler::NucleotideSequence Assembler::make_reference(Vertex from, const Verte
     auto last = to;
     if (last == null) {
         if (from == reference_tail()) {
-            return static_cast<NucleotideSequence>(kmer_of(from));
+            return kmer_of(from);
         }
         last = reference_tail();
     }
     result.reserve(2 * kmer_size());
-    const auto& first_kmer = kmer_of(from);
-    result.assign(std::cbegin(first_kmer), std::cend(first_kmer));
+    result = kmer_of(from);
     from = next_reference(from);
     while (from != last) {
         result.push_back(back_base_of(from));
@@ -1389,7 +1529,6 @@ bool Assembler::can_prune_reference_flanks() const
 
 void Assembler::pop_reference_head()
 {
-    reference_kmers_.pop_front();
     reference_vertices_.pop_front();
     if (!reference_edges_.empty()) {
         reference_edges_.pop_front();
@@ -1399,7 +1538,6 @@ void Assembler::pop_reference_head()
 
 void Assembler::pop_reference_tail()
 {
-    reference_kmers_.pop_back();
     reference_vertices_.pop_back();
     if (!reference_edges_.empty()) {
         reference_edges_.pop_back();
@@ -2051,12 +2189,6 @@ std::deque<Assembler::Variant> Assembler::extract_bubble_paths_with_ksp(const un
 
 // debug
 
-std::ostream& operator<<(std::ostream& os, const Assembler::Kmer& kmer)
-{
-    std::copy(std::cbegin(kmer), std::cend(kmer), std::ostreambuf_iterator<char> {os});
-    return os;
-}
-
 void Assembler::print_reference_head() const
 {
     std::cout << "reference head is " << kmer_of(reference_head()) << std::endl;
@@ -2080,7 +2212,7 @@ void Assembler::print(const Edge e) const
 void Assembler::print(const Path& path) const
 {
     assert(!path.empty());
-    std::transform(std::cbegin(path), std::prev(std::cend(path)), std::ostream_iterator<Kmer> {std::cout, "->"},
+    std::transform(std::cbegin(path), std::prev(std::cend(path)), std::ostream_iterator<std::string> {std::cout, "->"},
                    [this] (const Vertex v) { return kmer_of(v); });
     std::cout << kmer_of(path.back());
 }
@@ -2094,7 +2226,7 @@ void Assembler::print_verbose(const Path& path) const
                        Edge e; bool good;
                        std::tie(e, good) = boost::edge(u, v, graph_);
                        assert(good);
-                       auto result = static_cast<std::string>(this->kmer_of(v));
+                       auto result = this->kmer_of(v);
                        result += "(";
                        result += std::to_string(graph_[e].weight);
                        result += ", " + std::to_string(graph_[e].forward_strand_weight);
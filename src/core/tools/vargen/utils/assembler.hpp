@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <tuple>
 #include <stdexcept>
@@ -19,7 +20,6 @@
 #include <boost/optional.hpp>
 
 #include "concepts/equitable.hpp"
-#include "concepts/comparable.hpp"
 
 namespace octopus { namespace coretools { class Assembler; }}
 
@@ -99,46 +99,9 @@ public:
     void write_dot(std::ostream& out) const;
     
 private:
-    class Kmer : public Comparable<Kmer>
-    {
-    public:
-        using NucleotideSequence = Assembler::NucleotideSequence;
-        using SequenceIterator   = NucleotideSequence::const_iterator;
-        
-        Kmer() = delete;
-        Kmer(SequenceIterator first, SequenceIterator last) noexcept;
-        
-        Kmer(const Kmer&)            = default;
-        Kmer& operator=(const Kmer&) = default;
-        Kmer(Kmer&&)                 = default;
-        Kmer& operator=(Kmer&&)      = default;
-        
-        ~Kmer() = default;
-        
-        char front() const noexcept;
-        char back() const noexcept;
-        
-        SequenceIterator begin() const noexcept;
-        SequenceIterator end() const noexcept;
-        
-        explicit operator NucleotideSequence() const;
-        
-        std::size_t hash() const noexcept;
-        
-        friend bool operator==(const Kmer& lhs, const Kmer& rhs) noexcept;
-        friend bool operator<(const Kmer& lhs, const Kmer& rhs) noexcept;
-    private:
-        SequenceIterator first_, last_;
-        std::size_t hash_;
-    };
-    
-    friend bool operator==(const Kmer& lhs, const Kmer& rhs) noexcept;
-    friend bool operator<(const Kmer& lhs, const Kmer& rhs) noexcept;
-    
-    struct KmerHash
-    {
-        std::size_t operator()(const Kmer& k) const noexcept { return k.hash(); }
-    };
+    // Kmers are packed two bits per base, first base in the lowest bits of the first word
+    using KmerWord = std::uint64_t;
+    using KmerId   = std::uint32_t;
     
     struct GraphEdge
     {
@@ -152,11 +115,13 @@ private:
     struct GraphNode
     {
         std::size_t index;
-        Kmer kmer;
+        KmerId kmer;
         bool is_reference = false;
     };
     
-    using KmerGraph = boost::adjacency_list<boost::listS, boost::listS, boost::bidirectionalS, GraphNode, GraphEdge>;
+    // Vertices are kept in a list so descriptors survive vertex removal, but edges are in
+    // contiguous vectors as these are scanned far more than they are mutated.
+    using KmerGraph = boost::adjacency_list<boost::vecS, boost::listS, boost::bidirectionalS, GraphNode, GraphEdge>;
     
     using Vertex = boost::graph_traits<KmerGraph>::vertex_descriptor;
     using Edge   = boost::graph_traits<KmerGraph>::edge_descriptor;
@@ -166,6 +131,48 @@ private:
     
     using DominatorMap = std::unordered_map<Vertex, Vertex>;
     
+    // Open addressing hash table of the packed kmers in the graph, and their vertices
+    class KmerTable
+    {
+    public:
+        KmerTable() = default;
+        KmerTable(unsigned kmer_size);
+        
+        KmerTable(const KmerTable&)            = default;
+        KmerTable& operator=(const KmerTable&) = default;
+        KmerTable(KmerTable&&)                 = default;
+        KmerTable& operator=(KmerTable&&)      = default;
+        
+        ~KmerTable() = default;
+        
+        std::size_t size() const noexcept;
+        bool empty() const noexcept;
+        void reserve(std::size_t n);
+        void clear() noexcept;
+        
+        boost::optional<Vertex> find(const KmerWord* kmer) const noexcept;
+        KmerId insert(const KmerWord* kmer, Vertex v); // kmer must not already be present
+        void erase(KmerId id) noexcept;
+        const KmerWord* kmer(KmerId id) const noexcept;
+        
+    private:
+        struct Slot
+        {
+            std::uint32_t hash;
+            KmerId id;
+        };
+        
+        unsigned num_words_;
+        std::vector<Slot> slots_;
+        std::vector<KmerWord> words_;
+        std::vector<Vertex> vertices_;
+        std::vector<KmerId> free_ids_;
+        std::size_t size_, num_tombstones_;
+        
+        std::size_t find_slot(const KmerWord* kmer, std::uint64_t hash) const noexcept;
+        void rehash(std::size_t num_slots);
+    };
+    
     using Path = std::deque<Vertex>;
     using EdgePath = std::vector<Edge>;
     using PredecessorMap = std::unordered_map<Vertex, Vertex>;
@@ -187,12 +194,11 @@ private:
     
     Parameters params_;
     
-    std::deque<Kmer> reference_kmers_;
     std::size_t reference_head_position_;
     
     KmerGraph graph_;
     
-    std::unordered_map<Kmer, Vertex, KmerHash> vertex_cache_;
+    KmerTable kmers_;
     Path reference_vertices_;
     std::deque<Edge> reference_edges_;
     
@@ -200,13 +206,11 @@ private:
     
     void insert_reference_into_empty_graph(const NucleotideSequence& reference);
     void insert_reference_into_populated_graph(const NucleotideSequence& reference);
-    bool contains_kmer(const Kmer& kmer) const noexcept;
-    std::size_t count_kmer(const Kmer& kmer) const noexcept;
     std::size_t reference_size() const noexcept;
     void regenerate_vertex_indices();
     bool is_reference_unique_path() const;
     Vertex null_vertex() const;
-    boost::optional<Vertex> add_vertex(const Kmer& kmer, bool is_reference = false);
+    Vertex add_vertex(const KmerWord* kmer, bool is_reference = false);
     void remove_vertex(Vertex v);
     void clear_and_remove_vertex(Vertex v);
     void clear_and_remove_all(const std::unordered_set<Vertex>& vertices);
@@ -219,13 +223,11 @@ private:
     void remove_edge(Edge e);
     void increment_weight(Edge e, bool is_forward, int base_quality);
     void set_vertex_reference(Vertex v);
-    void set_vertex_reference(const Kmer& kmer);
     void set_edge_reference(Edge e);
-    const Kmer& kmer_of(Vertex v) const;
+    const KmerWord* packed_kmer_of(Vertex v) const;
+    NucleotideSequence kmer_of(Vertex v) const;
     char front_base_of(Vertex v) const;
     char back_base_of(Vertex v) const;
-    const Kmer& source_kmer_of(Edge e) const;
-    const Kmer& target_kmer_of(Edge e) const;
     bool is_reference(Vertex v) const;
     bool is_source_reference(Edge e) const;
     bool is_target_reference(Edge e) const;
@@ -312,7 +314,6 @@ private:
     
     // for debug
     
-    friend std::ostream& operator<<(std::ostream& os, const Kmer& kmer);
     void print_reference_head() const;
     void print_reference_tail() const;
     void print_reference_path() const;
@@ -334,7 +334,8 @@ bool AssemblerActiveRegionGenerator::is_interesting(const AlignedRead& read) con
             {
                 if (snvs_interesting_ || clustered_interesting_) {
                     const GenomicRegion region {contig_name(read), ref_index, ref_index + op_size};
-                    const auto ref_segment = reference_.get().fetch_sequence(region);
+                    thread_local ReferenceGenome::GeneticSequence ref_segment {};
+                    reference_.get().fetch_sequence(region, ref_segment);
 					for (std::size_t base_index {0}; base_index < op_size; ++base_index) {
 						const auto ref_base = ref_segment[base_index];
 						const auto read_base = read.sequence()[read_index + base_index];
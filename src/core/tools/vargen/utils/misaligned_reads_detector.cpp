@@ -112,7 +112,8 @@ bool MisalignedReadsDetector::is_likely_misaligned(const AlignedRead& read) cons
             case Flag::alignmentMatch:
             {
                 const GenomicRegion region {contig_name(read), ref_index, ref_index + op_size};
-                const auto ref_segment = reference_.get().fetch_sequence(region);
+                thread_local ReferenceGenome::GeneticSequence ref_segment {};
+                reference_.get().fetch_sequence(region, ref_segment);
                 auto num_snvs = count_snvs_in_match_range(std::cbegin(ref_segment), std::cend(ref_segment),
                                                           next(sequence_itr, read_index),
                                                           next(base_quality_itr, read_index),
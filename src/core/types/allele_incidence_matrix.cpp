@@ -0,0 +1,87 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "allele_incidence_matrix.hpp"
+
+#include <memory>
+#include <cassert>
+
+namespace octopus {
+
+std::size_t AlleleIncidenceMatrix::num_alleles() const noexcept
+{
+    return num_alleles_;
+}
+
+std::size_t AlleleIncidenceMatrix::num_genotypes() const noexcept
+{
+    return num_genotypes_;
+}
+
+// private methods
+
+std::size_t AlleleIncidenceMatrix::num_words(const std::size_t num_bits) noexcept
+{
+    return (num_bits + wordBits - 1) / wordBits;
+}
+
+void AlleleIncidenceMatrix::init(const std::vector<Allele>& alleles, const std::size_t num_genotypes)
+{
+    num_alleles_ = alleles.size();
+    num_genotypes_ = num_genotypes;
+    num_genotype_words_ = num_words(num_genotypes);
+    incidence_.assign(num_alleles_ * num_genotype_words_, 0);
+}
+
+void AlleleIncidenceMatrix::insert(const std::size_t genotype_index, const Genotype<Haplotype>& genotype, Builder& builder)
+{
+    builder.genotype_row.assign(builder.num_allele_words, 0);
+    for (const auto& haplotype : genotype) {
+        add_haplotype(haplotype, builder);
+    }
+    commit(genotype_index, builder);
+}
+
+void AlleleIncidenceMatrix::insert(const std::size_t genotype_index, const CancerGenotype<Haplotype>& genotype, Builder& builder)
+{
+    builder.genotype_row.assign(builder.num_allele_words, 0);
+    for (const auto& haplotype : genotype.germline()) {
+        add_haplotype(haplotype, builder);
+    }
+    for (const auto& haplotype : genotype.somatic()) {
+        add_haplotype(haplotype, builder);
+    }
+    commit(genotype_index, builder);
+}
+
+void AlleleIncidenceMatrix::add_haplotype(const Haplotype& haplotype, Builder& builder) const
+{
+    const auto num_rows = builder.haplotype_row_indices.size();
+    const auto row_itr = builder.haplotype_row_indices.emplace(std::addressof(haplotype), num_rows);
+    const auto row_offset = row_itr.first->second * builder.num_allele_words;
+    if (row_itr.second) {
+        builder.haplotype_rows.resize(builder.haplotype_rows.size() + builder.num_allele_words, 0);
+        for (std::size_t a {0}; a < num_alleles_; ++a) {
+            if (haplotype.contains(builder.alleles[a])) {
+                builder.haplotype_rows[row_offset + a / wordBits] |= Word {1} << (a % wordBits);
+            }
+        }
+    }
+    for (std::size_t w {0}; w < builder.num_allele_words; ++w) {
+        builder.genotype_row[w] |= builder.haplotype_rows[row_offset + w];
+    }
+}
+
+void AlleleIncidenceMatrix::commit(const std::size_t genotype_index, const Builder& builder)
+{
+    assert(genotype_index < num_genotypes_);
+    const auto genotype_word = genotype_index / wordBits;
+    const auto genotype_bit = Word {1} << (genotype_index % wordBits);
+    for (std::size_t w {0}; w < builder.num_allele_words; ++w) {
+        for_each_set_bit(builder.genotype_row[w], w * wordBits, [&] (const std::size_t allele) {
+            incidence_[allele * num_genotype_words_ + genotype_word] |= genotype_bit;
+        });
+    }
+}
+
+} // namespace octopus
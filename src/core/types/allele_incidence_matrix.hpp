@@ -0,0 +1,132 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef allele_incidence_matrix_hpp
+#define allele_incidence_matrix_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "allele.hpp"
+#include "haplotype.hpp"
+#include "genotype.hpp"
+#include "cancer_genotype.hpp"
+
+namespace octopus {
+
+/*
+ AlleleIncidenceMatrix records which of a set of alleles each genotype in a set of genotypes
+ contains, i.e. contains(genotype, allele), so callers can marginalise allele posteriors over
+ genotypes without repeated Haplotype::contains calls.
+
+ Each distinct haplotype is tested against each allele once, giving a haplotype x allele bit
+ matrix. Genotype incidence is the bitwise OR of its haplotypes' rows, which is stored transposed
+ (allele x genotype) so all the genotypes that do not contain an allele can be visited by scanning
+ a single bitset.
+
+ Haplotypes are identified by address while the matrix is built, so the genotypes must not be
+ modified during construction.
+ */
+class AlleleIncidenceMatrix
+{
+public:
+    AlleleIncidenceMatrix() = default;
+
+    template <typename Container>
+    AlleleIncidenceMatrix(const std::vector<Allele>& alleles, const Container& genotypes);
+    template <typename Container, typename UnaryFunction>
+    AlleleIncidenceMatrix(const std::vector<Allele>& alleles, const Container& genotypes, UnaryFunction&& get_genotype);
+
+    AlleleIncidenceMatrix(const AlleleIncidenceMatrix&)            = default;
+    AlleleIncidenceMatrix& operator=(const AlleleIncidenceMatrix&) = default;
+    AlleleIncidenceMatrix(AlleleIncidenceMatrix&&)                 = default;
+    AlleleIncidenceMatrix& operator=(AlleleIncidenceMatrix&&)      = default;
+
+    ~AlleleIncidenceMatrix() = default;
+
+    std::size_t num_alleles() const noexcept;
+    std::size_t num_genotypes() const noexcept;
+
+    bool contains(std::size_t genotype, std::size_t allele) const noexcept;
+
+    // Calls f with the index of each genotype that does not contain the allele, in index order
+    template <typename UnaryFunction>
+    void for_each_excluding(std::size_t allele, UnaryFunction&& f) const;
+
+private:
+    using Word = std::uint64_t;
+    static constexpr std::size_t wordBits {64};
+
+    struct Builder
+    {
+        const std::vector<Allele>& alleles;
+        std::size_t num_allele_words;
+        std::vector<Word> haplotype_rows, genotype_row;
+        std::unordered_map<const Haplotype*, std::size_t> haplotype_row_indices;
+    };
+
+    std::size_t num_alleles_ = 0, num_genotypes_ = 0, num_genotype_words_ = 0;
+    std::vector<Word> incidence_; // allele major
+
+    static std::size_t num_words(std::size_t num_bits) noexcept;
+
+    void init(const std::vector<Allele>& alleles, std::size_t num_genotypes);
+    void insert(std::size_t genotype_index, const Genotype<Haplotype>& genotype, Builder& builder);
+    void insert(std::size_t genotype_index, const CancerGenotype<Haplotype>& genotype, Builder& builder);
+    void add_haplotype(const Haplotype& haplotype, Builder& builder) const;
+    void commit(std::size_t genotype_index, const Builder& builder);
+
+    template <typename UnaryFunction>
+    static void for_each_set_bit(Word word, std::size_t offset, UnaryFunction&& f);
+};
+
+template <typename Container>
+AlleleIncidenceMatrix::AlleleIncidenceMatrix(const std::vector<Allele>& alleles, const Container& genotypes)
+: AlleleIncidenceMatrix {alleles, genotypes, [] (const auto& genotype) -> const auto& { return genotype; }}
+{}
+
+template <typename Container, typename UnaryFunction>
+AlleleIncidenceMatrix::AlleleIncidenceMatrix(const std::vector<Allele>& alleles, const Container& genotypes,
+                                             UnaryFunction&& get_genotype)
+{
+    init(alleles, std::distance(std::cbegin(genotypes), std::cend(genotypes)));
+    Builder builder {alleles, num_words(alleles.size()), {}, {}, {}};
+    std::size_t genotype_index {0};
+    for (const auto& element : genotypes) {
+        insert(genotype_index++, get_genotype(element), builder);
+    }
+}
+
+inline bool AlleleIncidenceMatrix::contains(const std::size_t genotype, const std::size_t allele) const noexcept
+{
+    return (incidence_[allele * num_genotype_words_ + genotype / wordBits] >> (genotype % wordBits)) & 1;
+}
+
+template <typename UnaryFunction>
+void AlleleIncidenceMatrix::for_each_set_bit(Word word, const std::size_t offset, UnaryFunction&& f)
+{
+    while (word != 0) {
+        f(offset + static_cast<std::size_t>(__builtin_ctzll(word)));
+        word &= word - 1;
+    }
+}
+
+template <typename UnaryFunction>
+void AlleleIncidenceMatrix::for_each_excluding(const std::size_t allele, UnaryFunction&& f) const
+{
+    const auto row = std::next(std::cbegin(incidence_), allele * num_genotype_words_);
+    for (std::size_t w {0}; w < num_genotype_words_; ++w) {
+        auto word = ~row[w];
+        if (w == num_genotype_words_ - 1 && num_genotypes_ % wordBits != 0) {
+            word &= (Word {1} << (num_genotypes_ % wordBits)) - 1;
+        }
+        for_each_set_bit(word, w * wordBits, f);
+    }
+}
+
+} // namespace octopus
+
+#endif
@@ -12,6 +12,8 @@
 
 namespace octopus {
 
+constexpr GenotypeIndex::size_type GenotypeIndex::inlineCapacity;
+
 Genotype<Haplotype>::Genotype(const unsigned ploidy)
 : haplotypes_ {}
 {
@@ -267,6 +269,31 @@ std::size_t element_cardinality_in_genotypes(const unsigned num_elements, const
     return ploidy * (num_genotypes(num_elements, ploidy) / num_elements);
 }
 
+void generate_all_genotype_indices(const unsigned num_elements, const unsigned ploidy, std::vector<GenotypeIndex>& result)
+{
+    if (ploidy == 0 || num_elements == 0) return;
+    result.reserve(result.size() + num_genotypes(num_elements, ploidy));
+    GenotypeIndex element_indicies(ploidy, 0);
+    while (true) {
+        if (element_indicies[0] == num_elements) {
+            unsigned i {0};
+            while (++i < ploidy && element_indicies[i] == num_elements - 1);
+            if (i == ploidy) break;
+            ++element_indicies[i];
+            std::fill_n(std::begin(element_indicies), i + 1, element_indicies[i]);
+        }
+        result.push_back(element_indicies);
+        ++element_indicies[0];
+    }
+}
+
+std::vector<GenotypeIndex> generate_all_genotype_indices(const unsigned num_elements, const unsigned ploidy)
+{
+    std::vector<GenotypeIndex> result {};
+    generate_all_genotype_indices(num_elements, ploidy, result);
+    return result;
+}
+
 std::vector<Genotype<Haplotype>>
 generate_all_genotypes(const std::vector<std::shared_ptr<Haplotype>>& haplotypes, const unsigned ploidy)
 {
@@ -27,6 +27,7 @@
 #include "utils/reorder.hpp"
 #include "allele.hpp"
 #include "haplotype.hpp"
+#include "genotype_index.hpp"
 
 namespace octopus {
 
@@ -597,6 +598,11 @@ boost::optional<std::size_t> num_genotypes_noexcept(unsigned num_elements, unsig
 std::size_t max_num_elements(std::size_t num_genotypes, unsigned ploidy);
 std::size_t element_cardinality_in_genotypes(unsigned num_elements, unsigned ploidy);
 
+// Appends every genotype of the given ploidy over num_elements elements to result, in the same
+// order as generate_all_genotypes, without materialising any genotypes
+void generate_all_genotype_indices(unsigned num_elements, unsigned ploidy, std::vector<GenotypeIndex>& result);
+std::vector<GenotypeIndex> generate_all_genotype_indices(unsigned num_elements, unsigned ploidy);
+
 template <typename MappableType>
 unsigned count_shared(const Genotype<MappableType>& lhs, const Genotype<MappableType>& rhs)
 {
@@ -624,8 +630,6 @@ bool have_shared(const Genotype<MappableType>& lhs, const Genotype<MappableType>
     }
 }
 
-using GenotypeIndex = std::vector<unsigned>;
-
 namespace detail {
 
 namespace {
@@ -747,6 +751,14 @@ auto generate_genotype(const Range& elements, const GenotypeIndex& element_indic
     return result;
 }
 
+template <typename Range, typename InputIt, typename Container>
+void append_genotypes(const Range& elements, InputIt first_index, InputIt last_index, Container& result)
+{
+    result.reserve(result.size() + std::distance(first_index, last_index));
+    std::transform(first_index, last_index, std::back_inserter(result),
+                   [&] (const GenotypeIndex& element_indicies) { return generate_genotype(elements, element_indicies); });
+}
+
 template <typename Range>
 auto do_generate_all_genotypes(const Range& elements, const unsigned ploidy)
 {
@@ -781,7 +793,7 @@ auto do_generate_all_genotypes(const Range& elements, const unsigned ploidy)
     // Otherwise resort to general algorithm
     auto result = construct_empty_genotype_container(elements);
     result.reserve(num_genotypes(num_elements, ploidy));
-    std::vector<unsigned> element_indicies(ploidy, 0);
+    GenotypeIndex element_indicies(ploidy, 0);
     
     while (true) {
         if (element_indicies[0] == num_elements) {
@@ -806,23 +818,9 @@ auto do_generate_all_genotypes(const Range& elements, const unsigned ploidy,
     if (ploidy == 0 || elements.empty()) {
         return result;
     }
-    const auto num_elements = static_cast<unsigned>(elements.size());
-    const auto result_size = num_genotypes(num_elements, ploidy);
-    result.reserve(result_size);
-    indices.reserve(result_size);
-    GenotypeIndex element_indicies(ploidy, 0);
-    while (true) {
-        if (element_indicies[0] == num_elements) {
-            unsigned i {0};
-            while (++i < ploidy && element_indicies[i] == num_elements - 1);
-            if (i == ploidy) break;
-            ++element_indicies[i];
-            std::fill_n(std::begin(element_indicies), i + 1, element_indicies[i]);
-        }
-        result.push_back(detail::generate_genotype(elements, element_indicies));
-        indices.push_back(element_indicies);
-        ++element_indicies[0];
-    }
+    const auto first_new_index = indices.size();
+    generate_all_genotype_indices(static_cast<unsigned>(elements.size()), ploidy, indices);
+    append_genotypes(elements, std::next(std::cbegin(indices), first_new_index), std::cend(indices), result);
     return result;
 }
 
@@ -832,7 +830,7 @@ auto do_generate_all_genotypes(const Range& elements, const unsigned ploidy,
 {
     if (ploidy == 0 || elements.empty()) return result_itr;
     const auto num_elements = static_cast<unsigned>(elements.size());
-    std::vector<unsigned> element_indicies(ploidy, 0);
+    GenotypeIndex element_indicies(ploidy, 0);
     while (true) {
         if (element_indicies[0] == num_elements) {
             unsigned i {0};
@@ -855,7 +853,7 @@ auto do_generate_all_genotypes(const Range& elements, const unsigned ploidy,
 {
     if (ploidy == 0 || elements.empty()) return result_itr;
     const auto num_elements = static_cast<unsigned>(elements.size());
-    std::vector<unsigned> element_indicies(ploidy, 0);
+    GenotypeIndex element_indicies(ploidy, 0);
     while (true) {
         if (element_indicies[0] == num_elements) {
             unsigned i {0};
@@ -877,6 +875,26 @@ auto do_generate_all_genotypes(const Range& elements, const unsigned ploidy,
 template <typename MappableType>
 struct RequiresSharedMemory : public std::is_same<MappableType, Haplotype> {};
 
+template <typename Range>
+auto make_genotypes(const Range& elements, const std::vector<GenotypeIndex>& indices, std::true_type)
+{
+    using MappableType = value_type_t<typename Range::value_type>;
+    std::vector<std::shared_ptr<MappableType>> temp_pointers(elements.size());
+    std::transform(std::cbegin(elements), std::cend(elements), std::begin(temp_pointers),
+                   [] (const MappableType& element) { return std::make_shared<MappableType>(element); });
+    auto result = construct_empty_genotype_container(temp_pointers);
+    append_genotypes(temp_pointers, std::cbegin(indices), std::cend(indices), result);
+    return result;
+}
+
+template <typename Range>
+auto make_genotypes(const Range& elements, const std::vector<GenotypeIndex>& indices, std::false_type)
+{
+    auto result = construct_empty_genotype_container(elements);
+    append_genotypes(elements, std::cbegin(indices), std::cend(indices), result);
+    return result;
+}
+
 template <typename Range>
 auto 
 generate_all_genotypes(const Range& elements, const unsigned ploidy,
@@ -1001,6 +1019,21 @@ generate_all_genotypes(const Range& elements, const unsigned ploidy,
 std::vector<Genotype<Haplotype>>
 generate_all_genotypes(const std::vector<std::shared_ptr<Haplotype>>& haplotypes, unsigned ploidy);
 
+// Materialises a genotype from its indices into elements, e.g. for genotypes called from generate_all_genotype_indices
+template <typename Range>
+auto make_genotype(const Range& elements, const GenotypeIndex& element_indices)
+{
+    return detail::generate_genotype(elements, element_indices);
+}
+
+// As make_genotype, but elements are shared between the genotypes rather than copied into each
+template <typename Range>
+auto make_genotypes(const Range& elements, const std::vector<GenotypeIndex>& indices)
+{
+    using MappableType = detail::value_type_t<typename Range::value_type>;
+    return detail::make_genotypes(elements, indices, detail::RequiresSharedMemory<MappableType> {});
+}
+
 template <typename MappableType>
 bool is_max_zygosity(const Genotype<MappableType>& genotype)
 {
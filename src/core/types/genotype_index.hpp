@@ -0,0 +1,245 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef genotype_index_hpp
+#define genotype_index_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <algorithm>
+#include <memory>
+#include <functional>
+
+#include <boost/functional/hash.hpp>
+
+namespace octopus {
+
+/*
+ GenotypeIndex is a genotype expressed as indices into a set of haplotypes, e.g. {0, 0, 2}.
+
+ It has the interface of std::vector<unsigned> but stores up to inlineCapacity indices inline, so
+ enumerating millions of small ploidy genotypes does not make a heap allocation per genotype. Larger
+ ploidies spill to the heap.
+ */
+class GenotypeIndex
+{
+public:
+    using value_type      = unsigned;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using pointer         = value_type*;
+    using const_pointer   = const value_type*;
+    using iterator        = pointer;
+    using const_iterator  = const_pointer;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type inlineCapacity {6};
+
+    GenotypeIndex() noexcept : size_ {0}, capacity_ {inlineCapacity} {}
+    explicit GenotypeIndex(size_type n, value_type value = 0);
+    GenotypeIndex(std::initializer_list<value_type> indices);
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    GenotypeIndex(InputIt first, InputIt last);
+
+    GenotypeIndex(const GenotypeIndex& other);
+    GenotypeIndex& operator=(const GenotypeIndex& other);
+    GenotypeIndex(GenotypeIndex&& other) noexcept;
+    GenotypeIndex& operator=(GenotypeIndex&& other) noexcept;
+
+    ~GenotypeIndex();
+
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    pointer data() noexcept { return is_inline() ? inline_ : heap_; }
+    const_pointer data() const noexcept { return is_inline() ? inline_ : heap_; }
+
+    iterator begin() noexcept { return data(); }
+    iterator end() noexcept { return data() + size_; }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + size_; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator {end()}; }
+    reverse_iterator rend() noexcept { return reverse_iterator {begin()}; }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator {end()}; }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator {begin()}; }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    reference operator[](size_type n) noexcept { return data()[n]; }
+    const_reference operator[](size_type n) const noexcept { return data()[n]; }
+    reference front() noexcept { return data()[0]; }
+    const_reference front() const noexcept { return data()[0]; }
+    reference back() noexcept { return data()[size_ - 1]; }
+    const_reference back() const noexcept { return data()[size_ - 1]; }
+
+    void reserve(size_type n);
+    void resize(size_type n, value_type value = 0);
+    void clear() noexcept { size_ = 0; }
+    void push_back(value_type index);
+    void emplace_back(value_type index) { push_back(index); }
+    void pop_back() noexcept { --size_; }
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);
+    void assign(size_type n, value_type value);
+
+private:
+    union
+    {
+        value_type inline_[inlineCapacity];
+        pointer heap_;
+    };
+    std::uint32_t size_, capacity_;
+
+    bool is_inline() const noexcept { return capacity_ == inlineCapacity; }
+    void grow(size_type min_capacity);
+};
+
+inline GenotypeIndex::GenotypeIndex(const size_type n, const value_type value) : GenotypeIndex {}
+{
+    assign(n, value);
+}
+
+inline GenotypeIndex::GenotypeIndex(std::initializer_list<value_type> indices) : GenotypeIndex {}
+{
+    assign(std::cbegin(indices), std::cend(indices));
+}
+
+template <typename InputIt, typename>
+GenotypeIndex::GenotypeIndex(InputIt first, InputIt last) : GenotypeIndex {}
+{
+    assign(first, last);
+}
+
+inline GenotypeIndex::GenotypeIndex(const GenotypeIndex& other) : GenotypeIndex {}
+{
+    assign(std::cbegin(other), std::cend(other));
+}
+
+inline GenotypeIndex& GenotypeIndex::operator=(const GenotypeIndex& other)
+{
+    if (this != &other) assign(std::cbegin(other), std::cend(other));
+    return *this;
+}
+
+inline GenotypeIndex::GenotypeIndex(GenotypeIndex&& other) noexcept : GenotypeIndex {}
+{
+    *this = std::move(other);
+}
+
+inline GenotypeIndex& GenotypeIndex::operator=(GenotypeIndex&& other) noexcept
+{
+    if (this == &other) return *this;
+    if (!is_inline()) delete[] heap_;
+    if (other.is_inline()) {
+        std::copy_n(other.inline_, other.size_, inline_);
+        capacity_ = inlineCapacity;
+    } else {
+        heap_ = other.heap_;
+        capacity_ = other.capacity_;
+        other.capacity_ = inlineCapacity;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+}
+
+inline GenotypeIndex::~GenotypeIndex()
+{
+    if (!is_inline()) delete[] heap_;
+}
+
+inline void GenotypeIndex::reserve(const size_type n)
+{
+    if (n > capacity_) grow(n);
+}
+
+inline void GenotypeIndex::resize(const size_type n, const value_type value)
+{
+    reserve(n);
+    if (n > size_) std::fill(end(), begin() + n, value);
+    size_ = static_cast<std::uint32_t>(n);
+}
+
+inline void GenotypeIndex::push_back(const value_type index)
+{
+    if (size_ == capacity_) grow(2 * capacity_);
+    data()[size_++] = index;
+}
+
+template <typename InputIt>
+void GenotypeIndex::assign(InputIt first, InputIt last)
+{
+    clear();
+    reserve(std::distance(first, last));
+    size_ = static_cast<std::uint32_t>(std::distance(begin(), std::copy(first, last, begin())));
+}
+
+inline void GenotypeIndex::assign(const size_type n, const value_type value)
+{
+    clear();
+    resize(n, value);
+}
+
+inline void GenotypeIndex::grow(const size_type min_capacity)
+{
+    auto new_data = std::make_unique<value_type[]>(min_capacity);
+    std::copy(cbegin(), cend(), new_data.get());
+    if (!is_inline()) delete[] heap_;
+    heap_ = new_data.release();
+    capacity_ = static_cast<std::uint32_t>(min_capacity);
+}
+
+inline bool operator==(const GenotypeIndex& lhs, const GenotypeIndex& rhs) noexcept
+{
+    return lhs.size() == rhs.size() && std::equal(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs));
+}
+
+inline bool operator!=(const GenotypeIndex& lhs, const GenotypeIndex& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+inline bool operator<(const GenotypeIndex& lhs, const GenotypeIndex& rhs) noexcept
+{
+    return std::lexicographical_compare(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs), std::cend(rhs));
+}
+
+inline bool operator>(const GenotypeIndex& lhs, const GenotypeIndex& rhs) noexcept { return rhs < lhs; }
+inline bool operator<=(const GenotypeIndex& lhs, const GenotypeIndex& rhs) noexcept { return !(rhs < lhs); }
+inline bool operator>=(const GenotypeIndex& lhs, const GenotypeIndex& rhs) noexcept { return !(lhs < rhs); }
+
+inline GenotypeIndex concat(const GenotypeIndex& lhs, const GenotypeIndex& rhs)
+{
+    GenotypeIndex result {};
+    result.reserve(lhs.size() + rhs.size());
+    result.assign(std::cbegin(lhs), std::cend(lhs));
+    std::for_each(std::cbegin(rhs), std::cend(rhs), [&] (auto index) { result.push_back(index); });
+    return result;
+}
+
+inline std::size_t hash_value(const GenotypeIndex& index)
+{
+    return boost::hash_range(std::cbegin(index), std::cend(index));
+}
+
+} // namespace octopus
+
+namespace std {
+    template <> struct hash<octopus::GenotypeIndex>
+    {
+        size_t operator()(const octopus::GenotypeIndex& index) const
+        {
+            return hash_value(index);
+        }
+    };
+} // namespace std
+
+#endif
@@ -236,7 +236,8 @@ CigarString Haplotype::cigar() const
     using Flag = CigarOperation::Flag;
     CigarString result {};
     if (!explicit_alleles_.empty()) {
-        const auto reference = reference_.get().fetch_sequence(GenomicRegion {region_.contig_name(), explicit_allele_region_});
+        thread_local NucleotideSequence reference {};
+        reference_.get().fetch_sequence(GenomicRegion {region_.contig_name(), explicit_allele_region_}, reference);
         result.reserve(2 * explicit_alleles_.size() + 2);
         auto curr_op_size = begin_distance(region_.contig_region(), explicit_allele_region_);
         auto curr_op_flag = Flag::sequenceMatch;
@@ -157,7 +157,9 @@ namespace detail {
                 const GenomicRegion::ContigName& contig,
                 const ContigRegion& region)
     {
-        result.append(reference.fetch_sequence(GenomicRegion {contig, region}));
+        thread_local ReferenceGenome::GeneticSequence buffer {};
+        reference.fetch_sequence(GenomicRegion {contig, region}, buffer);
+        result.append(buffer);
     }
 }
 
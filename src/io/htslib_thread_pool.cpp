@@ -0,0 +1,55 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "htslib_thread_pool.hpp"
+
+#include <stdexcept>
+
+#include "htslib/thread_pool.h"
+
+namespace octopus { namespace io {
+
+namespace {
+
+// CRAM handles keep a pointer to the htsThreadPool they are given, so it needs static storage
+htsThreadPool shared_pool {nullptr, 0};
+unsigned shared_pool_size {0};
+
+} // namespace
+
+void init_htslib_thread_pool(const unsigned num_threads)
+{
+    destroy_htslib_thread_pool();
+    if (num_threads == 0) return;
+    shared_pool.pool = hts_tpool_init(static_cast<int>(num_threads));
+    if (shared_pool.pool == nullptr) {
+        throw std::runtime_error {"init_htslib_thread_pool: could not create htslib thread pool"};
+    }
+    shared_pool.qsize = 0; // htslib default
+    shared_pool_size = num_threads;
+}
+
+void destroy_htslib_thread_pool() noexcept
+{
+    if (shared_pool.pool != nullptr) {
+        hts_tpool_destroy(shared_pool.pool);
+        shared_pool.pool = nullptr;
+        shared_pool_size = 0;
+    }
+}
+
+unsigned htslib_thread_pool_size() noexcept
+{
+    return shared_pool_size;
+}
+
+void attach_htslib_thread_pool(htsFile* file) noexcept
+{
+    if (file != nullptr && shared_pool.pool != nullptr) {
+        // Failure just leaves the file single threaded
+        hts_set_thread_pool(file, &shared_pool);
+    }
+}
+
+} // namespace io
+} // namespace octopus
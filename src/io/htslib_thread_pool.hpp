@@ -0,0 +1,28 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef htslib_thread_pool_hpp
+#define htslib_thread_pool_hpp
+
+#include "htslib/hts.h"
+
+namespace octopus { namespace io {
+
+/*
+ A single htslib thread pool shared by all htslib file handles for BGZF (de)compression and CRAM
+ slice (de)coding. The pool must be created before the files that use it are opened, and must
+ outlive them.
+ */
+
+void init_htslib_thread_pool(unsigned num_threads);
+void destroy_htslib_thread_pool() noexcept;
+
+unsigned htslib_thread_pool_size() noexcept;
+
+// Attaches the shared thread pool to the file, if there is one
+void attach_htslib_thread_pool(htsFile* file) noexcept;
+
+} // namespace io
+} // namespace octopus
+
+#endif
@@ -10,7 +10,9 @@
 #include <stdexcept>
 #include <sstream>
 #include <limits>
+#include <numeric>
 #include <cassert>
+#include <chrono>
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/lexical_cast.hpp>
@@ -25,6 +27,9 @@
 #include "exceptions/malformed_file_error.hpp"
 #include "exceptions/unwritable_file_error.hpp"
 #include "utils/string_utils.hpp"
+#include "config/common.hpp"
+#include "logging/logging.hpp"
+#include "io/htslib_thread_pool.hpp"
 #include "annotated_aligned_read.hpp"
 
 #include <iostream>
@@ -167,7 +172,9 @@ namespace {
 auto open_hts_file(const boost::filesystem::path& file)
 {
     hts_verbose = 0; // disable hts error reporting
-    return sam_open(file.c_str(), "r");
+    auto result = sam_open(file.c_str(), "r");
+    attach_htslib_thread_pool(result);
+    return result;
 }
 
 bool is_cram(const boost::filesystem::path& file)
@@ -182,6 +189,8 @@ HtslibSamFacade::HtslibSamFacade(Path file_path)
 , hts_file_ {open_hts_file(file_path_), HtsFileDeleter {}}
 , hts_header_ {(hts_file_) ? sam_hdr_read(hts_file_.get()) : nullptr, HtsHeaderDeleter {}}
 , hts_index_ {(hts_file_) ? sam_index_load(hts_file_.get(), file_path_.c_str()) : nullptr, HtsIndexDeleter {}}
+, time_decoding_ {DEBUG_MODE}
+, decode_time_ {DecodeDuration::zero()}
 , hts_targets_ {}
 , contig_names_ {}
 , sample_names_ {}
@@ -225,6 +234,28 @@ HtslibSamFacade::HtslibSamFacade(Path file_path)
     std::sort(std::begin(samples_), std::end(samples_));
 }
 
+HtslibSamFacade::HtslibSamFacade(const HtslibSamFacade& other, DuplicateTag)
+: file_path_ {other.file_path_}
+, hts_file_ {open_hts_file(file_path_), HtsFileDeleter {}}
+, hts_header_ {(hts_file_) ? sam_hdr_read(hts_file_.get()) : nullptr, HtsHeaderDeleter {}}
+, hts_index_ {}
+, time_decoding_ {other.time_decoding_}
+, decode_time_ {DecodeDuration::zero()}
+, hts_targets_ {other.hts_targets_}
+, contig_names_ {other.contig_names_}
+, sample_names_ {other.sample_names_}
+, samples_ {other.samples_}
+{
+    if (hts_file_) {
+        if (hts_file_->is_cram) {
+            // CRAM indices are bound to the file handle they were loaded with
+            hts_index_.reset(sam_index_load(hts_file_.get(), file_path_.c_str()), HtsIndexDeleter {});
+        } else {
+            hts_index_ = other.hts_index_;
+        }
+    }
+}
+
 auto open_hts_writable_file(const boost::filesystem::path& path)
 {
     std::string mode {"[w]"};
@@ -245,6 +276,7 @@ HtslibSamFacade::HtslibSamFacade(Path sam_out, Path sam_template)
     if (!hts_file_) {
         throw UnwritableBAM {std::move(file_path_)};
     }
+    attach_htslib_thread_pool(hts_file_.get());
     hts_index_ = nullptr;
     if (sam_hdr_write(hts_file_.get(), hts_header_.get()) < 0) {
         throw UnwritableBAM {std::move(file_path_)};
@@ -253,6 +285,12 @@ HtslibSamFacade::HtslibSamFacade(Path sam_out, Path sam_template)
 
 HtslibSamFacade::~HtslibSamFacade()
 {
+    if (time_decoding_ && hts_file_ && decode_time_ > DecodeDuration::zero()) {
+        using namespace std::chrono;
+        logging::DebugLogger debug_log {};
+        stream(debug_log) << "Spent " << duration_cast<milliseconds>(decode_time()).count()
+                          << "ms reading and decoding records from " << file_path_;
+    }
     if (!hts_index_) {
         hts_header_.reset(nullptr);
         hts_file_.reset(nullptr);
@@ -269,10 +307,10 @@ bool HtslibSamFacade::is_open() const noexcept
 
 void HtslibSamFacade::open()
 {
-    hts_file_.reset(sam_open(file_path_.string().c_str(), "r"));
+    hts_file_.reset(open_hts_file(file_path_));
     if (hts_file_) {
         hts_header_.reset(sam_hdr_read(hts_file_.get()));
-        hts_index_.reset(sam_index_load(hts_file_.get(), file_path_.c_str()));
+        hts_index_.reset(sam_index_load(hts_file_.get(), file_path_.c_str()), HtsIndexDeleter {});
     }
 }
 
@@ -280,7 +318,19 @@ void HtslibSamFacade::close()
 {
     hts_file_.reset(nullptr);
     hts_header_.reset(nullptr);
-    hts_index_.reset(nullptr);
+    hts_index_.reset();
+}
+
+std::unique_ptr<IReadReaderImpl> HtslibSamFacade::duplicate() const
+{
+    std::unique_ptr<HtslibSamFacade> result {new HtslibSamFacade {*this, DuplicateTag {}}};
+    if (!result->is_open()) result.reset();
+    return result;
+}
+
+HtslibSamFacade::DecodeDuration HtslibSamFacade::decode_time() const noexcept
+{
+    return decode_time_;
 }
 
 GenomicRegion::Size HtslibSamFacade::reference_size(const GenomicRegion::ContigName& contig) const
@@ -908,6 +958,13 @@ std::string extract_read_name(const bam1_t* b)
 
 bool HtslibSamFacade::HtslibIterator::operator++()
 {
+    if (hts_facade_.time_decoding_) {
+        using std::chrono::steady_clock;
+        const auto start = steady_clock::now();
+        const auto result = sam_itr_next(hts_facade_.hts_file_.get(), hts_iterator_.get(), hts_bam1_.get());
+        hts_facade_.decode_time_ += DecodeDuration {steady_clock::now() - start};
+        return result >= 0;
+    }
     return sam_itr_next(hts_facade_.hts_file_.get(), hts_iterator_.get(), hts_bam1_.get()) >= 0;
 }
 
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <chrono>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
@@ -44,6 +45,7 @@ public:
     using NucleotideSequence = AlignedRead::NucleotideSequence;
     
     using ReadGroupIdType = std::string;
+    using DecodeDuration  = std::chrono::nanoseconds;
     
     HtslibSamFacade() = delete;
     
@@ -61,6 +63,11 @@ public:
     void open() override;
     void close() override;
     
+    std::unique_ptr<IReadReaderImpl> duplicate() const override;
+    
+    // Time spent reading and decoding records from the file by this handle. Only recorded in debug mode.
+    DecodeDuration decode_time() const noexcept;
+    
     std::vector<SampleName> extract_samples() const override;
     std::vector<ReadGroupIdType> extract_read_groups(const SampleName& sample) const override;
     
@@ -138,6 +145,10 @@ private:
         void operator()(bam1_t* b) const { bam_destroy1(b); }
     };
     
+    struct DuplicateTag {};
+    
+    HtslibSamFacade(const HtslibSamFacade& other, DuplicateTag);
+    
     class HtslibIterator
     {
     public:
@@ -180,7 +191,9 @@ private:
     
     std::unique_ptr<htsFile, HtsFileDeleter> hts_file_;
     std::unique_ptr<bam_hdr_t, HtsHeaderDeleter> hts_header_;
-    std::unique_ptr<hts_idx_t, HtsIndexDeleter> hts_index_;
+    std::shared_ptr<hts_idx_t> hts_index_; // shared between duplicated BAM handles
+    bool time_decoding_;
+    mutable DecodeDuration decode_time_;
     
     std::unordered_map<GenomicRegion::ContigName, HtsTid> hts_targets_;
     std::unordered_map<HtsTid, GenomicRegion::ContigName> contig_names_;
@@ -29,9 +29,11 @@ ReadManager::ReadManager(std::vector<Path> read_file_paths, unsigned max_open_fi
 , reader_paths_containing_sample_ {}
 , possible_regions_in_readers_ {}
 , samples_ {}
+, reader_pools_ {}
 {
     setup_reader_samples_and_regions();
     open_initial_files();
+    make_reader_pools();
     samples_.reserve(reader_paths_containing_sample_.size());
     std::unordered_set<Path, PathHash> found {};
     for (const auto& pair : reader_paths_containing_sample_) {
@@ -66,6 +68,8 @@ ReadManager::ReadManager(ReadManager&& other)
     reader_paths_containing_sample_ = move(other.reader_paths_containing_sample_);
     possible_regions_in_readers_    = move(other.possible_regions_in_readers_);
     samples_                        = move(other.samples_);
+    reader_pools_                   = move(other.reader_pools_);
+    num_duplicate_readers_          = other.num_duplicate_readers_.exchange(0);
 }
 
 ReadManager& ReadManager::operator=(ReadManager&& other)
@@ -82,6 +86,8 @@ ReadManager& ReadManager::operator=(ReadManager&& other)
         reader_paths_containing_sample_ = move(other.reader_paths_containing_sample_);
         possible_regions_in_readers_    = move(other.possible_regions_in_readers_);
         samples_                        = move(other.samples_);
+        reader_pools_                   = move(other.reader_pools_);
+        num_duplicate_readers_          = other.num_duplicate_readers_.exchange(0);
     }
     return *this;
 }
@@ -100,11 +106,14 @@ void swap(ReadManager& lhs, ReadManager& rhs) noexcept
     swap(lhs.reader_paths_containing_sample_, rhs.reader_paths_containing_sample_);
     swap(lhs.possible_regions_in_readers_,    rhs.possible_regions_in_readers_);
     swap(lhs.samples_,                        rhs.samples_);
+    swap(lhs.reader_pools_,                   rhs.reader_pools_);
+    lhs.num_duplicate_readers_ = rhs.num_duplicate_readers_.exchange(lhs.num_duplicate_readers_);
 }
 
 void ReadManager::close() const noexcept
 {
     std::lock_guard<std::mutex> lock {mutex_};
+    clear_reader_pools();
     close_readers(num_files_);
 }
 
@@ -152,6 +161,7 @@ const std::vector<ReadManager::SampleName>& ReadManager::samples() const
 unsigned ReadManager::drop_samples(std::vector<SampleName> samples)
 {
     std::sort(std::begin(samples), std::end(samples));
+    clear_reader_pools();
     std::vector<SampleName> remaining_samples {};
     remaining_samples.reserve(samples_.size());
     std::set_difference(std::cbegin(samples_), std::cend(samples_),
@@ -194,6 +204,7 @@ unsigned ReadManager::drop_samples(std::vector<SampleName> samples)
         open_readers(num_new_spaces);
     }
     num_files_ -= dropped_reader_paths.size();
+    make_reader_pools();
     return dropped_reader_paths.size();
 }
 
@@ -246,7 +257,7 @@ bool ReadManager::has_reads(const std::vector<SampleName>& samples, const Genomi
 {
     if (all_readers_are_open()) {
         return std::any_of(std::cbegin(open_readers_), std::cend(open_readers_),
-                           [&] (const auto& p) { return p.second.has_reads(samples, region); });
+                           [&] (const auto& p) { return checkout_reader(p)->has_reads(samples, region); });
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
         auto reader_paths = get_reader_paths_containing_samples(samples);
@@ -269,7 +280,7 @@ bool ReadManager::has_reads(const GenomicRegion& region) const
 {
     if (all_readers_are_open()) {
         return std::any_of(std::cbegin(open_readers_), std::cend(open_readers_),
-                           [&] (const auto& p) { return p.second.has_reads(region); });
+                           [&] (const auto& p) { return checkout_reader(p)->has_reads(region); });
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
         auto reader_paths = get_reader_paths_containing_samples(samples());
@@ -293,7 +304,7 @@ std::size_t ReadManager::count_reads(const SampleName& sample, const GenomicRegi
     if (all_readers_are_open()) {
         return std::accumulate(std::cbegin(open_readers_), std::cend(open_readers_), std::size_t {0},
                                [&] (std::size_t curr, const auto& p) {
-                                   return curr + p.second.count_reads(sample, region);
+                                   return curr + checkout_reader(p)->count_reads(sample, region);
                                });
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
@@ -317,7 +328,7 @@ std::size_t ReadManager::count_reads(const std::vector<SampleName>& samples, con
     if (all_readers_are_open()) {
         return std::accumulate(std::cbegin(open_readers_), std::cend(open_readers_), std::size_t {0},
                                [&] (std::size_t curr, const auto& p) {
-                                   return curr + p.second.count_reads(samples, region);
+                                   return curr + checkout_reader(p)->count_reads(samples, region);
                                });
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
@@ -393,7 +404,7 @@ GenomicRegion ReadManager::find_covered_subregion(const std::vector<SampleName>&
     if (all_readers_are_open()) {
         for (const auto& p : open_readers_) {
             // Request one more than the max so we can determine if the entire request region can be included
-            const auto positions = p.second.extract_read_positions(samples, region, max_reads + 1);
+            const auto positions = checkout_reader(p)->extract_read_positions(samples, region, max_reads + 1);
             for (auto position : positions) {
                 add(position, position_tracker);
             }
@@ -438,7 +449,7 @@ ReadManager::ReadContainer ReadManager::fetch_reads(const SampleName& sample, co
     ReadContainer result {};
     if (all_readers_are_open()) {
         for (const auto& p : open_readers_) {
-            merge_insert(p.second.fetch_reads(sample, region), result);
+            merge_insert(checkout_reader(p)->fetch_reads(sample, region), result);
         }
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
@@ -465,7 +476,7 @@ ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName
     }
     if (all_readers_are_open()) {
         for (const auto& p : open_readers_) {
-            auto reads = p.second.fetch_reads(samples, region);
+            auto reads = checkout_reader(p)->fetch_reads(samples, region);
             for (auto&& r : reads) {
                 merge_insert(std::move(r.second), result.at(r.first));
                 r.second.clear();
@@ -637,6 +648,91 @@ void ReadManager::close_readers(unsigned n) const
     }
 }
 
+void ReadManager::make_reader_pools()
+{
+    if (max_duplicate_readers() == 0) return;
+    reader_pools_.reserve(open_readers_.size());
+    for (const auto& p : open_readers_) {
+        reader_pools_.emplace(p.first, std::make_unique<ReaderPool>());
+    }
+}
+
+void ReadManager::clear_reader_pools() const noexcept
+{
+    // Must not be called while any PooledReader is alive
+    reader_pools_.clear();
+    num_duplicate_readers_ = 0;
+}
+
+unsigned ReadManager::max_duplicate_readers() const noexcept
+{
+    return all_readers_are_open() ? max_open_files_ - num_files_ : 0;
+}
+
+ReadManager::PooledReader ReadManager::checkout_reader(const OpenReaderMap::value_type& reader) const
+{
+    const auto pool_itr = reader_pools_.find(reader.first);
+    if (pool_itr == std::cend(reader_pools_)) return PooledReader {reader.second};
+    auto& pool = *pool_itr->second;
+    {
+        std::lock_guard<std::mutex> lock {pool.mutex};
+        if (!pool.primary_in_use) {
+            pool.primary_in_use = true;
+            return PooledReader {reader.second, &pool};
+        }
+        if (!pool.idle.empty()) {
+            auto result = std::move(pool.idle.back());
+            pool.idle.pop_back();
+            return PooledReader {std::move(result), pool};
+        }
+    }
+    auto num_duplicates = num_duplicate_readers_.load();
+    do {
+        if (num_duplicates >= max_duplicate_readers()) {
+            // No room for another open file, so wait on the primary reader
+            return PooledReader {reader.second};
+        }
+    } while (!num_duplicate_readers_.compare_exchange_weak(num_duplicates, num_duplicates + 1));
+    auto duplicate = reader.second.duplicate();
+    if (!duplicate) {
+        --num_duplicate_readers_;
+        return PooledReader {reader.second};
+    }
+    return PooledReader {std::move(duplicate), pool};
+}
+
+ReadManager::PooledReader::PooledReader(const ReadReader& reader, ReaderPool* pool) noexcept
+: reader_ {std::addressof(reader)}
+, duplicate_ {}
+, pool_ {pool}
+{}
+
+ReadManager::PooledReader::PooledReader(std::unique_ptr<ReadReader> reader, ReaderPool& pool) noexcept
+: reader_ {reader.get()}
+, duplicate_ {std::move(reader)}
+, pool_ {std::addressof(pool)}
+{}
+
+ReadManager::PooledReader::PooledReader(PooledReader&& other) noexcept
+: reader_ {other.reader_}
+, duplicate_ {std::move(other.duplicate_)}
+, pool_ {other.pool_}
+{
+    other.pool_ = nullptr;
+}
+
+ReadManager::PooledReader::~PooledReader()
+{
+    if (pool_) {
+        std::lock_guard<std::mutex> lock {pool_->mutex};
+        if (duplicate_) {
+            pool_->idle.push_back(std::move(duplicate_));
+        } else {
+            pool_->primary_in_use = false;
+        }
+    }
+}
+
 void ReadManager::add_possible_regions_to_reader_map(const Path& reader_path, const std::vector<GenomicRegion>& regions)
 {
     for (const auto& region : regions) {
@@ -10,7 +10,9 @@
 #include <unordered_set>
 #include <initializer_list>
 #include <cstddef>
+#include <memory>
 #include <mutex>
+#include <atomic>
 
 #include <boost/filesystem.hpp>
 
@@ -111,6 +113,20 @@ private:
     using ContigMap               = MappableMap<GenomicRegion::ContigName, ContigRegion>;
     using ReaderRegionsMap        = std::unordered_map<Path, ContigMap, PathHash>;
     
+    // When all readers are open, each ReadReader is a serialisation point for its file. So threads
+    // that need a reader that is in use instead take a duplicate handle from the file's pool,
+    // opening a new one if doing so keeps the total number of open files within max_open_files_.
+    struct ReaderPool
+    {
+        std::mutex mutex;
+        bool primary_in_use = false;
+        std::vector<std::unique_ptr<ReadReader>> idle;
+    };
+    
+    class PooledReader;
+    
+    using ReaderPoolMap = std::unordered_map<Path, std::unique_ptr<ReaderPool>, PathHash>;
+    
     unsigned max_open_files_ = 200;
     unsigned num_files_;
     bool all_readers_single_sample_;
@@ -122,6 +138,9 @@ private:
     ReaderRegionsMap possible_regions_in_readers_;
     std::vector<SampleName> samples_;
     
+    mutable ReaderPoolMap reader_pools_;
+    mutable std::atomic<unsigned> num_duplicate_readers_ {0};
+    
     mutable std::mutex mutex_;
     
     void setup_reader_samples_and_regions();
@@ -141,6 +160,11 @@ private:
     Path choose_reader_to_close() const;
     void close_readers(unsigned n) const;
     
+    void make_reader_pools();
+    void clear_reader_pools() const noexcept;
+    unsigned max_duplicate_readers() const noexcept;
+    PooledReader checkout_reader(const OpenReaderMap::value_type& reader) const;
+    
     template <typename Visitor>
     void iterate_helper(const std::vector<SampleName>& samples,
                         const GenomicRegion& region,
@@ -156,6 +180,30 @@ private:
                                                 const GenomicRegion& region) const;
 };
 
+class ReadManager::PooledReader
+{
+public:
+    PooledReader() = delete;
+    
+    PooledReader(const ReadReader& reader, ReaderPool* pool = nullptr) noexcept; // primary reader
+    PooledReader(std::unique_ptr<ReadReader> reader, ReaderPool& pool) noexcept; // duplicate reader
+    
+    PooledReader(const PooledReader&)            = delete;
+    PooledReader& operator=(const PooledReader&) = delete;
+    PooledReader(PooledReader&& other) noexcept;
+    PooledReader& operator=(PooledReader&&)      = delete;
+    
+    ~PooledReader();
+    
+    const ReadReader& operator*() const noexcept { return *reader_; }
+    const ReadReader* operator->() const noexcept { return reader_; }
+    
+private:
+    const ReadReader* reader_;
+    std::unique_ptr<ReadReader> duplicate_;
+    ReaderPool* pool_; // the pool to return to, if any
+};
+
 template <typename Visitor>
 void ReadManager::iterate_helper(const std::vector<SampleName>& samples,
                                  const GenomicRegion& region,
@@ -163,7 +211,7 @@ void ReadManager::iterate_helper(const std::vector<SampleName>& samples,
 {
     if (all_readers_are_open()) {
         for (const auto& p : open_readers_) {
-            if (!p.second.iterate(samples, region, visitor)) return;
+            if (!checkout_reader(p)->iterate(samples, region, visitor)) return;
         }
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
@@ -82,6 +82,11 @@ ReadReader::ReadReader(const boost::filesystem::path& file_path)
 , impl_ {make_reader(file_path_)}
 {}
 
+ReadReader::ReadReader(Path file_path, std::unique_ptr<IReadReaderImpl> impl)
+: file_path_ {std::move(file_path)}
+, impl_ {std::move(impl)}
+{}
+
 ReadReader::ReadReader(ReadReader&& other)
 {
     std::lock_guard<std::mutex> lock {other.mutex_};
@@ -117,6 +122,17 @@ void ReadReader::close()
     impl_->close();
 }
 
+std::unique_ptr<ReadReader> ReadReader::duplicate() const
+{
+    std::unique_ptr<IReadReaderImpl> impl {};
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        impl = impl_->duplicate();
+    }
+    if (!impl) return nullptr;
+    return std::unique_ptr<ReadReader> {new ReadReader {file_path_, std::move(impl)}};
+}
+
 const ReadReader::Path& ReadReader::path() const noexcept
 {
     return file_path_;
@@ -56,6 +56,10 @@ public:
     void open();
     void close();
     
+    // Returns a new reader for the same file that can be used concurrently with this one,
+    // or nullptr if the file could not be reopened.
+    std::unique_ptr<ReadReader> duplicate() const;
+    
     const Path& path() const noexcept;
     
     std::vector<SampleName> extract_samples() const;
@@ -116,6 +120,8 @@ private:
     Path file_path_;
     std::unique_ptr<IReadReaderImpl> impl_;
     
+    ReadReader(Path file_path, std::unique_ptr<IReadReaderImpl> impl);
+    
     mutable std::mutex mutex_;
 };
 
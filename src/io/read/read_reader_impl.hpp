@@ -8,6 +8,7 @@
 #include <vector>
 #include <cstddef>
 #include <unordered_map>
+#include <memory>
 #include <utility>
 #include <functional>
 
@@ -34,6 +35,10 @@ public:
     virtual void open() = 0;
     virtual void close() = 0;
     
+    // Opens another handle to the same file. The new handle has its own file position, so can be
+    // used concurrently with this one, but may share immutable state such as the index.
+    virtual std::unique_ptr<IReadReaderImpl> duplicate() const = 0;
+    
     virtual std::vector<SampleName> extract_samples() const = 0;
     virtual std::vector<std::string> extract_read_groups(const SampleName& sample) const = 0;
     
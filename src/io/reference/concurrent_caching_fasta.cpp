@@ -0,0 +1,234 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "concurrent_caching_fasta.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <tuple>
+#include <mutex>
+#include <cassert>
+
+#include "basics/genomic_region.hpp"
+#include "config/common.hpp"
+#include "logging/logging.hpp"
+
+namespace octopus { namespace io {
+
+namespace {
+
+constexpr ReferenceReader::GenomicSize defaultChunkSize {1 << 16};
+constexpr unsigned defaultNumShards {64};
+
+} // namespace
+
+ConcurrentCachingFasta::ConcurrentCachingFasta(std::unique_ptr<ReferenceReader> fasta, const GenomicSize max_cache_size)
+: ConcurrentCachingFasta {std::move(fasta), max_cache_size, defaultChunkSize, defaultNumShards}
+{}
+
+ConcurrentCachingFasta::ConcurrentCachingFasta(std::unique_ptr<ReferenceReader> fasta,
+                                               const GenomicSize max_cache_size,
+                                               const GenomicSize chunk_size,
+                                               const unsigned num_shards)
+: fasta_ {std::move(fasta)}
+, contig_ids_ {}
+, contig_sizes_ {}
+, max_cache_size_ {max_cache_size}
+, chunk_size_ {std::max(std::min(chunk_size, max_cache_size / std::max(num_shards, 1u)), GenomicSize {1})}
+, max_shard_size_ {std::max(max_cache_size / std::max(num_shards, 1u), chunk_size_)}
+, num_shards_ {std::max(num_shards, 1u)}
+, shards_ {std::make_unique<Shard[]>(num_shards_)}
+{
+    setup_contigs();
+}
+
+ConcurrentCachingFasta::ConcurrentCachingFasta(const ConcurrentCachingFasta& other)
+: fasta_ {other.fasta_->clone()}
+, contig_ids_ {other.contig_ids_}
+, contig_sizes_ {other.contig_sizes_}
+, max_cache_size_ {other.max_cache_size_}
+, chunk_size_ {other.chunk_size_}
+, max_shard_size_ {other.max_shard_size_}
+, num_shards_ {other.num_shards_}
+, shards_ {std::make_unique<Shard[]>(num_shards_)}
+{}
+
+ConcurrentCachingFasta::~ConcurrentCachingFasta()
+{
+    if (DEBUG_MODE && shards_) {
+        const auto cache_stats = stats();
+        const auto num_lookups = cache_stats.num_hits + cache_stats.num_misses;
+        if (num_lookups > 0) {
+            using namespace std::chrono;
+            logging::DebugLogger debug_log {};
+            stream(debug_log) << "Reference cache hit rate was "
+                              << static_cast<double>(cache_stats.num_hits) / num_lookups
+                              << " from " << num_lookups << " chunk lookups, with "
+                              << cache_stats.num_contended_locks << " contended locks waiting "
+                              << duration_cast<milliseconds>(cache_stats.lock_wait_time).count() << "ms";
+        }
+    }
+}
+
+ConcurrentCachingFasta::Stats ConcurrentCachingFasta::stats() const noexcept
+{
+    Stats result {0, 0, 0, std::chrono::nanoseconds::zero()};
+    std::for_each(shards_.get(), shards_.get() + num_shards_, [&result] (const Shard& shard) {
+        result.num_hits += shard.num_hits;
+        result.num_misses += shard.num_misses;
+        result.num_contended_locks += shard.num_contended_locks;
+        result.lock_wait_time += std::chrono::nanoseconds {shard.lock_wait_time};
+    });
+    return result;
+}
+
+// virtual private methods
+
+std::unique_ptr<ReferenceReader> ConcurrentCachingFasta::do_clone() const
+{
+    return std::make_unique<ConcurrentCachingFasta>(*this);
+}
+
+bool ConcurrentCachingFasta::do_is_open() const noexcept
+{
+    return fasta_->is_open();
+}
+
+std::string ConcurrentCachingFasta::do_fetch_reference_name() const
+{
+    return fasta_->fetch_reference_name();
+}
+
+std::vector<ConcurrentCachingFasta::ContigName> ConcurrentCachingFasta::do_fetch_contig_names() const
+{
+    return fasta_->fetch_contig_names();
+}
+
+ConcurrentCachingFasta::GenomicSize ConcurrentCachingFasta::do_fetch_contig_size(const ContigName& contig) const
+{
+    return contig_sizes_[contig_ids_.at(contig)];
+}
+
+ConcurrentCachingFasta::GeneticSequence ConcurrentCachingFasta::do_fetch_sequence(const GenomicRegion& region) const
+{
+    if (is_empty(region)) {
+        return "";
+    }
+    const auto contig_itr = contig_ids_.find(region.contig_name());
+    if (size(region) > max_cache_size_ || contig_itr == std::cend(contig_ids_)
+        || region.end() > contig_sizes_[contig_itr->second]) {
+        return fasta_->fetch_sequence(region);
+    }
+    const auto contig = contig_itr->second;
+    const auto contig_size = contig_sizes_[contig];
+    GeneticSequence result {};
+    result.reserve(size(region));
+    const std::size_t first_chunk {region.begin() / chunk_size_}, last_chunk {(region.end() - 1) / chunk_size_};
+    for (auto chunk = first_chunk; chunk <= last_chunk; ++chunk) {
+        const GenomicSize chunk_begin = chunk * chunk_size_;
+        const auto chunk_end = std::min(chunk_begin + chunk_size_, contig_size);
+        const auto offset = std::max(region.begin(), chunk_begin) - chunk_begin;
+        const auto length = std::min(region.end(), chunk_end) - chunk_begin - offset;
+        const auto key = make_key(contig, chunk);
+        if (!append_cached(key, offset, length, result)) {
+            auto chunk_sequence = fasta_->fetch_sequence(GenomicRegion {region.contig_name(), chunk_begin, chunk_end});
+            if (chunk_sequence.size() != chunk_end - chunk_begin) {
+                return fasta_->fetch_sequence(region);
+            }
+            result.append(chunk_sequence, offset, length);
+            add_to_cache(key, std::move(chunk_sequence));
+        }
+    }
+    assert(result.size() == size(region));
+    return result;
+}
+
+// non-virtual private methods
+
+void ConcurrentCachingFasta::setup_contigs()
+{
+    auto contig_names = fasta_->fetch_contig_names();
+    contig_ids_.reserve(contig_names.size());
+    contig_sizes_.reserve(contig_names.size());
+    for (auto&& contig_name : contig_names) {
+        contig_sizes_.push_back(fasta_->fetch_contig_size(contig_name));
+        contig_ids_.emplace(std::move(contig_name), static_cast<ContigId>(contig_ids_.size()));
+    }
+}
+
+ConcurrentCachingFasta::ChunkKey ConcurrentCachingFasta::make_key(const ContigId contig, const std::size_t chunk) const noexcept
+{
+    return static_cast<ChunkKey>(contig) << 32 | static_cast<std::uint32_t>(chunk);
+}
+
+ConcurrentCachingFasta::Shard& ConcurrentCachingFasta::shard(const ChunkKey key) const noexcept
+{
+    // Neighbouring chunks should go to different shards
+    return shards_[((key * 0x9E3779B97F4A7C15ull) >> 32) % num_shards_];
+}
+
+namespace {
+
+template <typename Lock, typename Shard>
+void lock_timed(Lock& lock, const Shard& shard)
+{
+    if (!lock.try_lock()) {
+        const auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        ++shard.num_contended_locks;
+        shard.lock_wait_time += std::chrono::nanoseconds {std::chrono::steady_clock::now() - start}.count();
+    }
+}
+
+} // namespace
+
+bool ConcurrentCachingFasta::append_cached(const ChunkKey key, const GenomicSize offset, const GenomicSize length,
+                                           GeneticSequence& result) const
+{
+    const auto& chunk_shard = shard(key);
+    std::shared_lock<std::shared_timed_mutex> lock {chunk_shard.mutex, std::defer_lock};
+    lock_timed(lock, chunk_shard);
+    const auto chunk_itr = chunk_shard.chunks.find(key);
+    if (chunk_itr == std::cend(chunk_shard.chunks)) {
+        ++chunk_shard.num_misses;
+        return false;
+    }
+    chunk_itr->second.last_used.store(++chunk_shard.clock, std::memory_order_relaxed);
+    result.append(chunk_itr->second.sequence, offset, length);
+    ++chunk_shard.num_hits;
+    return true;
+}
+
+void ConcurrentCachingFasta::add_to_cache(const ChunkKey key, GeneticSequence sequence) const
+{
+    auto& chunk_shard = shard(key);
+    const auto chunk_size = static_cast<GenomicSize>(sequence.size());
+    std::unique_lock<std::shared_timed_mutex> lock {chunk_shard.mutex, std::defer_lock};
+    lock_timed(lock, chunk_shard);
+    const auto inserted = chunk_shard.chunks.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                                                     std::forward_as_tuple(std::move(sequence), ++chunk_shard.clock));
+    if (inserted.second) { // another thread may have got here first
+        chunk_shard.size += chunk_size;
+        evict(chunk_shard, key);
+    }
+}
+
+void ConcurrentCachingFasta::evict(Shard& shard, const ChunkKey keep) const
+{
+    while (shard.size > max_shard_size_ && shard.chunks.size() > 1) {
+        auto lru_itr = std::end(shard.chunks);
+        for (auto itr = std::begin(shard.chunks); itr != std::end(shard.chunks); ++itr) {
+            if (itr->first != keep && (lru_itr == std::end(shard.chunks)
+                || itr->second.last_used.load(std::memory_order_relaxed) < lru_itr->second.last_used.load(std::memory_order_relaxed))) {
+                lru_itr = itr;
+            }
+        }
+        assert(lru_itr != std::end(shard.chunks));
+        shard.size -= lru_itr->second.sequence.size();
+        shard.chunks.erase(lru_itr);
+    }
+}
+
+} // namespace io
+} // namespace octopus
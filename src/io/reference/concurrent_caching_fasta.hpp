@@ -0,0 +1,113 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef concurrent_caching_fasta_hpp
+#define concurrent_caching_fasta_hpp
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
+
+#include "reference_reader.hpp"
+
+namespace octopus {
+
+class GenomicRegion;
+
+namespace io {
+
+/*
+ ConcurrentCachingFasta is a sequence cache designed for many threads requesting sequence at once.
+
+ Contigs are split into fixed size chunks, which are cached and evicted as a unit. Chunks are
+ distributed over a number of independently locked shards, each with a reader-writer lock and
+ an approximate LRU eviction policy. Cache hits only take a shared lock on the shards of the
+ requested chunks, so never wait on each other, or on file reads; a hit can only wait for a
+ concurrent insertion into the same shard.
+
+ The underlying reader is only used on cache misses, and must be threadsafe.
+ */
+
+class ConcurrentCachingFasta : public ReferenceReader
+{
+public:
+    using ContigName      = ReferenceReader::ContigName;
+    using GenomicSize     = ReferenceReader::GenomicSize;
+    using GeneticSequence = ReferenceReader::GeneticSequence;
+
+    struct Stats
+    {
+        std::size_t num_hits, num_misses, num_contended_locks;
+        std::chrono::nanoseconds lock_wait_time;
+    };
+
+    ConcurrentCachingFasta() = delete;
+
+    ConcurrentCachingFasta(std::unique_ptr<ReferenceReader> fasta, GenomicSize max_cache_size);
+    ConcurrentCachingFasta(std::unique_ptr<ReferenceReader> fasta, GenomicSize max_cache_size,
+                           GenomicSize chunk_size, unsigned num_shards);
+
+    ConcurrentCachingFasta(const ConcurrentCachingFasta&); // does not copy the cache
+    ConcurrentCachingFasta& operator=(const ConcurrentCachingFasta&) = delete;
+    ConcurrentCachingFasta(ConcurrentCachingFasta&&)                 = default;
+    ConcurrentCachingFasta& operator=(ConcurrentCachingFasta&&)      = default;
+
+    ~ConcurrentCachingFasta() override;
+
+    // Chunk lookups, and waits for shard locks
+    Stats stats() const noexcept;
+
+private:
+    using ContigId = std::uint32_t;
+    using ChunkKey = std::uint64_t; // contig id << 32 | chunk index
+    using Tick     = std::uint64_t;
+
+    struct Chunk
+    {
+        Chunk(GeneticSequence sequence, Tick last_used) : sequence {std::move(sequence)}, last_used {last_used} {}
+        const GeneticSequence sequence;
+        mutable std::atomic<Tick> last_used;
+    };
+
+    struct Shard
+    {
+        mutable std::shared_timed_mutex mutex;
+        std::unordered_map<ChunkKey, Chunk> chunks;
+        GenomicSize size = 0;
+        mutable std::atomic<Tick> clock {0};
+        mutable std::atomic<std::size_t> num_hits {0}, num_misses {0}, num_contended_locks {0};
+        mutable std::atomic<std::chrono::nanoseconds::rep> lock_wait_time {0};
+    };
+
+    std::unique_ptr<ReferenceReader> fasta_;
+    std::unordered_map<ContigName, ContigId> contig_ids_;
+    std::vector<GenomicSize> contig_sizes_;
+    GenomicSize max_cache_size_, chunk_size_, max_shard_size_;
+    unsigned num_shards_;
+    std::unique_ptr<Shard[]> shards_;
+
+    std::unique_ptr<ReferenceReader> do_clone() const override;
+    bool do_is_open() const noexcept override;
+    std::string do_fetch_reference_name() const override;
+    std::vector<ContigName> do_fetch_contig_names() const override;
+    GenomicSize do_fetch_contig_size(const ContigName& contig) const override;
+    GeneticSequence do_fetch_sequence(const GenomicRegion& region) const override;
+
+    void setup_contigs();
+    ChunkKey make_key(ContigId contig, std::size_t chunk) const noexcept;
+    Shard& shard(ChunkKey key) const noexcept;
+    bool append_cached(ChunkKey key, GenomicSize offset, GenomicSize length, GeneticSequence& result) const;
+    void add_to_cache(ChunkKey key, GeneticSequence sequence) const;
+    void evict(Shard& shard, ChunkKey keep) const;
+};
+
+} // namespace io
+} // namespace octopus
+
+#endif
@@ -11,6 +11,8 @@
 #include "fasta.hpp"
 #include "threadsafe_fasta.hpp"
 #include "caching_fasta.hpp"
+#include "concurrent_caching_fasta.hpp"
+#include "two_bit_reference.hpp"
 
 namespace octopus {
 
@@ -92,6 +94,11 @@ ReferenceGenome::GeneticSequence ReferenceGenome::fetch_sequence(const GenomicRe
     return impl_->fetch_sequence(region);
 }
 
+void ReferenceGenome::fetch_sequence(const GenomicRegion& region, GeneticSequence& result) const
+{
+    impl_->fetch_sequence(region, result);
+}
+
 // non-member functions
 
 ReferenceGenome make_reference(boost::filesystem::path reference_path,
@@ -110,14 +117,20 @@ ReferenceGenome make_reference(boost::filesystem::path reference_path,
         options.iupac_ambiguity_symbol_policy = Fasta::Options::IUPACAmbiguitySymbolPolicy::disambiguate;
     }
     options.base_fill_policy = Fasta::Options::BaseFillPolicy::fill_with_ns;
+    if (is_two_bit_reference(reference_path)) {
+        // Already in memory and threadsafe, so caching would only copy sequence
+        return ReferenceGenome {std::make_unique<TwoBitReference>(std::move(reference_path), options)};
+    }
     if (is_threaded) {
         impl_ = std::make_unique<ThreadsafeFasta>(std::make_unique<Fasta>(reference_path, options));
     } else {
         impl_ = std::make_unique<Fasta>(std::move(reference_path), options);
     }
     if (max_cache_size.bytes() > 0) {
-        double locality_bias {0.99}, forward_bias {0.99};
-        if (is_threaded) locality_bias = 0.25;
+        if (is_threaded) {
+            return ReferenceGenome {std::make_unique<ConcurrentCachingFasta>(std::move(impl_), max_cache_size.bytes())};
+        }
+        const double locality_bias {0.99}, forward_bias {0.99};
         return ReferenceGenome {std::make_unique<CachingFasta>(std::move(impl_), max_cache_size.bytes(),
                                                                locality_bias, forward_bias)};
     } else {
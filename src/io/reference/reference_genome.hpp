@@ -45,6 +45,7 @@ public:
     bool contains(const GenomicRegion& region) const noexcept;
     
     GeneticSequence fetch_sequence(const GenomicRegion& region) const;
+    void fetch_sequence(const GenomicRegion& region, GeneticSequence& result) const;
     
 private:
     std::unique_ptr<io::ReferenceReader> impl_;
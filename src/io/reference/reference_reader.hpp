@@ -52,6 +52,12 @@ public:
         return do_fetch_sequence(region);
     }
     
+    // Reuses the capacity of result where the reader can
+    void fetch_sequence(const GenomicRegion& region, GeneticSequence& result) const
+    {
+        do_fetch_sequence_to(region, result);
+    }
+    
 private:
     virtual std::unique_ptr<ReferenceReader> do_clone() const = 0;
     virtual bool do_is_open() const noexcept = 0;
@@ -59,6 +65,10 @@ private:
     virtual std::vector<ContigName> do_fetch_contig_names() const = 0;
     virtual GenomicSize do_fetch_contig_size(const ContigName& contig) const = 0;
     virtual GeneticSequence do_fetch_sequence(const GenomicRegion& region) const = 0;
+    virtual void do_fetch_sequence_to(const GenomicRegion& region, GeneticSequence& result) const
+    {
+        result = do_fetch_sequence(region);
+    }
 };
 
 } // namespace io
@@ -0,0 +1,452 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "two_bit_reference.hpp"
+
+#include <fstream>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <limits>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "utils/sequence_utils.hpp"
+#include "exceptions/missing_file_error.hpp"
+#include "exceptions/malformed_file_error.hpp"
+#include "exceptions/unwritable_file_error.hpp"
+
+namespace octopus { namespace io {
+
+class MissingTwoBitReference : public MissingFileError
+{
+    std::string do_where() const override
+    {
+        return "TwoBitReference";
+    }
+public:
+    MissingTwoBitReference(TwoBitReference::Path file) : MissingFileError {std::move(file), "2-bit reference"} {}
+};
+
+class MalformedTwoBitReference : public MalformedFileError
+{
+    std::string do_where() const override
+    {
+        return "TwoBitReference";
+    }
+public:
+    MalformedTwoBitReference(TwoBitReference::Path file) : MalformedFileError {std::move(file), "2-bit reference"} {}
+};
+
+class UnwritableTwoBitReference : public UnwritableFileError
+{
+    std::string do_where() const override
+    {
+        return "build_two_bit_reference";
+    }
+public:
+    UnwritableTwoBitReference(TwoBitReference::Path file) : UnwritableFileError {std::move(file), "2-bit reference"} {}
+};
+
+namespace {
+
+/*
+ File layout (native byte order, checked with the byte order mark):
+
+    magic[8] byte_order_mark:u32 version:u32 num_contigs:u32 name_length:u32 name[name_length]
+    index entry for each contig:
+        name_length:u32 name[name_length] size:u64
+        bases_offset:u64 exceptions_offset:u64 num_exceptions:u64 soft_masks_offset:u64 num_soft_masks:u64
+    contig data, each section aligned to 8 bytes
+ */
+
+constexpr std::array<char, 8> twoBitMagic {{'O', 'C', 'T', 'O', '2', 'B', 'I', 'T'}};
+constexpr std::uint32_t byteOrderMark {0x01020304}, twoBitVersion {1};
+
+struct IndexEntry
+{
+    std::uint64_t size, bases_offset, exceptions_offset, num_exceptions, soft_masks_offset, num_soft_masks;
+};
+
+class IndexCursor
+{
+public:
+    IndexCursor(const std::uint8_t* data, std::size_t size) noexcept : data_ {data}, size_ {size}, position_ {0} {}
+
+    template <typename T>
+    bool read(T& value) noexcept
+    {
+        if (position_ + sizeof(T) > size_) return false;
+        std::memcpy(&value, data_ + position_, sizeof(T));
+        position_ += sizeof(T);
+        return true;
+    }
+    bool read(std::string& value) noexcept
+    {
+        std::uint32_t length;
+        if (!read(length) || position_ + length > size_) return false;
+        value.assign(reinterpret_cast<const char*>(data_ + position_), length);
+        position_ += length;
+        return true;
+    }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_, position_;
+};
+
+auto make_decode_table() noexcept
+{
+    std::array<std::array<char, 4>, 256> result {};
+    for (unsigned byte {0}; byte < 256; ++byte) {
+        for (unsigned i {0}; i < 4; ++i) {
+            result[byte][i] = "ACGT"[(byte >> (2 * i)) & 3];
+        }
+    }
+    return result;
+}
+
+const auto decodeTable = make_decode_table();
+
+void decode(const std::uint8_t* bases, std::size_t begin, const std::size_t end, char* result) noexcept
+{
+    for (; begin < end && begin % 4 != 0; ++begin) {
+        *result++ = decodeTable[bases[begin / 4]][begin % 4];
+    }
+    for (; begin + 4 <= end; begin += 4) {
+        result = std::copy(std::cbegin(decodeTable[bases[begin / 4]]), std::cend(decodeTable[bases[begin / 4]]), result);
+    }
+    for (; begin < end; ++begin) {
+        *result++ = decodeTable[bases[begin / 4]][begin % 4];
+    }
+}
+
+// Applies f(run_begin, run_end, run) to the runs overlapping [begin, end), clipped to that interval
+template <typename Run, typename F>
+void for_each_overlapped(const Run* first, const Run* last, const std::size_t begin, const std::size_t end, F f)
+{
+    first = std::partition_point(first, last, [begin] (const Run& run) { return run.begin + run.length <= begin; });
+    for (; first != last && first->begin < end; ++first) {
+        f(std::max<std::size_t>(first->begin, begin), std::min<std::size_t>(first->begin + first->length, end), *first);
+    }
+}
+
+} // namespace
+
+class TwoBitReference::MappedFile
+{
+public:
+    MappedFile(const Path& path)
+    {
+        const auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw MissingTwoBitReference {path};
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            throw MalformedTwoBitReference {path};
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        auto data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) throw MalformedTwoBitReference {path};
+        data_ = static_cast<const std::uint8_t*>(data);
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { ::munmap(const_cast<std::uint8_t*>(data_), size_); }
+
+    const std::uint8_t* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_;
+};
+
+TwoBitReference::TwoBitReference(Path path)
+: TwoBitReference {std::move(path), Options {}}
+{}
+
+TwoBitReference::TwoBitReference(Path path, Options options)
+: path_ {std::move(path)}
+, file_ {}
+, options_ {options}
+, name_ {}
+, contig_names_ {}
+, contigs_ {}
+{
+    if (!boost::filesystem::exists(path_)) {
+        throw MissingTwoBitReference {path_};
+    }
+    file_ = std::make_shared<MappedFile>(path_);
+    read_index();
+}
+
+// virtual private methods
+
+std::unique_ptr<ReferenceReader> TwoBitReference::do_clone() const
+{
+    return std::make_unique<TwoBitReference>(*this); // shares the mapping
+}
+
+bool TwoBitReference::do_is_open() const noexcept
+{
+    return file_ != nullptr;
+}
+
+std::string TwoBitReference::do_fetch_reference_name() const
+{
+    return name_;
+}
+
+std::vector<TwoBitReference::ContigName> TwoBitReference::do_fetch_contig_names() const
+{
+    return contig_names_;
+}
+
+TwoBitReference::GenomicSize TwoBitReference::do_fetch_contig_size(const ContigName& contig) const
+{
+    const auto itr = contigs_.find(contig);
+    if (itr == std::cend(contigs_)) {
+        throw std::runtime_error {"contig \"" + contig + "\" not found in 2-bit reference \"" + path_.string() + "\""};
+    }
+    return itr->second.size;
+}
+
+TwoBitReference::GeneticSequence TwoBitReference::do_fetch_sequence(const GenomicRegion& region) const
+{
+    GeneticSequence result {};
+    do_fetch_sequence_to(region, result);
+    return result;
+}
+
+void TwoBitReference::do_fetch_sequence_to(const GenomicRegion& region, GeneticSequence& result) const
+{
+    const auto contig_itr = contigs_.find(region.contig_name());
+    if (contig_itr == std::cend(contigs_)) {
+        throw std::runtime_error {"contig \"" + region.contig_name() + "\" not found in 2-bit reference \"" + path_.string() + "\""};
+    }
+    const auto& contig = contig_itr->second;
+    const std::size_t begin {std::min(region.begin(), contig.size)}, end {std::min(region.end(), contig.size)};
+    result.resize(end - begin);
+    if (begin == end) return;
+    char* const first = &result[0] - begin; // so first[position] is the base at position
+    decode(contig.bases, begin, end, first + begin);
+    for_each_overlapped(contig.exceptions, contig.exceptions + contig.num_exceptions, begin, end,
+                        [first] (std::size_t run_begin, std::size_t run_end, const SymbolRun& run) {
+                            std::fill(first + run_begin, first + run_end, run.symbol);
+                        });
+    if (options_.iupac_ambiguity_symbol_policy == Options::IUPACAmbiguitySymbolPolicy::disambiguate) {
+        // Only exception runs can contain ambiguous symbols
+        for_each_overlapped(contig.exceptions, contig.exceptions + contig.num_exceptions, begin, end,
+                            [first] (std::size_t run_begin, std::size_t run_end, const SymbolRun& run) {
+                                if (run.symbol != 'N') {
+                                    std::transform(first + run_begin, first + run_end, first + run_begin,
+                                                   [] (char base) { return utils::disambiguate_iupac_base(base); });
+                                }
+                            });
+    }
+    if (options_.base_transform_policy == Options::CapitalisationPolicy::maintain) {
+        for_each_overlapped(contig.soft_masks, contig.soft_masks + contig.num_soft_masks, begin, end,
+                            [first] (std::size_t run_begin, std::size_t run_end, const Run&) {
+                                std::transform(first + run_begin, first + run_end, first + run_begin,
+                                               [] (char base) { return static_cast<char>(std::tolower(base)); });
+                            });
+    }
+    if (result.size() < size(region) && options_.base_fill_policy != Options::BaseFillPolicy::ignore) {
+        if (options_.base_fill_policy == Options::BaseFillPolicy::throw_exception) {
+            throw std::runtime_error {"requested region " + to_string(region) + " is outside the reference contig"};
+        }
+        result.resize(size(region), 'N');
+    }
+}
+
+// non-virtual private methods
+
+void TwoBitReference::read_index()
+{
+    IndexCursor cursor {file_->data(), file_->size()};
+    std::array<char, 8> magic;
+    std::uint32_t byte_order_mark, version, num_contigs;
+    if (!cursor.read(magic) || magic != twoBitMagic || !cursor.read(byte_order_mark) || byte_order_mark != byteOrderMark
+        || !cursor.read(version) || version != twoBitVersion || !cursor.read(num_contigs) || !cursor.read(name_)) {
+        throw MalformedTwoBitReference {path_};
+    }
+    contig_names_.reserve(num_contigs);
+    contigs_.reserve(num_contigs);
+    const auto in_file = [this] (std::uint64_t offset, std::uint64_t num_bytes) {
+        return offset <= file_->size() && num_bytes <= file_->size() - offset;
+    };
+    for (std::uint32_t i {0}; i < num_contigs; ++i) {
+        ContigName name {};
+        IndexEntry entry;
+        if (!cursor.read(name) || !cursor.read(entry)
+            || !in_file(entry.bases_offset, (entry.size + 3) / 4)
+            || !in_file(entry.exceptions_offset, entry.num_exceptions * sizeof(SymbolRun))
+            || !in_file(entry.soft_masks_offset, entry.num_soft_masks * sizeof(Run))) {
+            throw MalformedTwoBitReference {path_};
+        }
+        const auto data = file_->data();
+        Contig contig {
+            static_cast<GenomicSize>(entry.size),
+            data + entry.bases_offset,
+            reinterpret_cast<const SymbolRun*>(data + entry.exceptions_offset),
+            static_cast<std::size_t>(entry.num_exceptions),
+            reinterpret_cast<const Run*>(data + entry.soft_masks_offset),
+            static_cast<std::size_t>(entry.num_soft_masks)
+        };
+        contig_names_.push_back(name);
+        contigs_.emplace(std::move(name), contig);
+    }
+}
+
+// non-member methods
+
+bool is_two_bit_reference(const boost::filesystem::path& path)
+{
+    return path.extension() == ".o2b";
+}
+
+boost::filesystem::path get_two_bit_reference_path(const boost::filesystem::path& fasta_path)
+{
+    return fasta_path.string() + ".o2b";
+}
+
+namespace {
+
+template <typename T>
+void write(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write(std::ofstream& file, const std::string& value)
+{
+    write(file, static_cast<std::uint32_t>(value.size()));
+    file.write(value.data(), value.size());
+}
+
+template <typename T>
+void write(std::ofstream& file, const std::vector<T>& values)
+{
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+std::uint64_t align(std::ofstream& file)
+{
+    const auto position = static_cast<std::uint64_t>(file.tellp());
+    const auto padding = (8 - position % 8) % 8;
+    for (unsigned i {0}; i < padding; ++i) file.put('\0');
+    return position + padding;
+}
+
+template <typename Run, typename Predicate>
+void extend_runs(std::vector<Run>& runs, const std::uint32_t position, Predicate same_run)
+{
+    if (!runs.empty() && runs.back().begin + runs.back().length == position && same_run(runs.back())) {
+        ++runs.back().length;
+    } else {
+        runs.push_back(Run {});
+        runs.back().begin = position;
+        runs.back().length = 1;
+    }
+}
+
+} // namespace
+
+void build_two_bit_reference(const boost::filesystem::path& fasta_path, const boost::filesystem::path& output_path)
+{
+    using Run = TwoBitReference::Run;
+    using SymbolRun = TwoBitReference::SymbolRun;
+    namespace fs = boost::filesystem;
+    static constexpr GenomicRegion::Size blockSize {1 << 20}; // must be a multiple of 4
+    const Fasta fasta {fasta_path};
+    const auto contig_names = fasta.fetch_contig_names();
+    const auto temp_path = output_path.parent_path() / fs::unique_path(output_path.filename().string() + ".%%%%-%%%%.tmp");
+    {
+        std::ofstream file {temp_path.string(), std::ios::binary};
+        if (!file) throw UnwritableTwoBitReference {output_path};
+        write(file, twoBitMagic);
+        write(file, byteOrderMark);
+        write(file, twoBitVersion);
+        write(file, static_cast<std::uint32_t>(contig_names.size()));
+        write(file, fasta.fetch_reference_name());
+        // The index is written last, once the data offsets are known
+        const auto index_position = file.tellp();
+        std::vector<IndexEntry> index(contig_names.size());
+        const auto write_index = [&] () {
+            for (std::size_t i {0}; i < contig_names.size(); ++i) {
+                write(file, contig_names[i]);
+                write(file, index[i]);
+            }
+        };
+        write_index();
+        std::string block {};
+        std::vector<std::uint8_t> packed_block {};
+        std::vector<SymbolRun> exceptions {};
+        std::vector<Run> soft_masks {};
+        for (std::size_t i {0}; i < contig_names.size(); ++i) {
+            const auto& contig = contig_names[i];
+            auto& entry = index[i];
+            entry.size = fasta.fetch_contig_size(contig);
+            if (entry.size > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::runtime_error {"build_two_bit_reference: contig " + contig + " is too long"};
+            }
+            exceptions.clear();
+            soft_masks.clear();
+            entry.bases_offset = align(file);
+            for (GenomicRegion::Position block_begin {0}; block_begin < entry.size; block_begin += blockSize) {
+                const auto block_end = std::min(block_begin + blockSize, static_cast<GenomicRegion::Position>(entry.size));
+                block = fasta.fetch_sequence(GenomicRegion {contig, block_begin, block_end});
+                if (block.size() != block_end - block_begin) {
+                    throw std::runtime_error {"build_two_bit_reference: could not read " + contig + " from " + fasta_path.string()};
+                }
+                packed_block.assign((block.size() + 3) / 4, 0);
+                for (std::size_t j {0}; j < block.size(); ++j) {
+                    const auto position = static_cast<std::uint32_t>(block_begin + j);
+                    const auto base = static_cast<char>(std::toupper(block[j]));
+                    if (base != block[j]) {
+                        extend_runs(soft_masks, position, [] (const Run&) { return true; });
+                    }
+                    std::uint8_t code {0};
+                    switch (base) {
+                        case 'A': code = 0; break;
+                        case 'C': code = 1; break;
+                        case 'G': code = 2; break;
+                        case 'T': code = 3; break;
+                        default:
+                            extend_runs(exceptions, position, [base] (const SymbolRun& run) { return run.symbol == base; });
+                            exceptions.back().symbol = base;
+                    }
+                    packed_block[j / 4] |= code << (2 * (j % 4));
+                }
+                write(file, packed_block);
+            }
+            entry.exceptions_offset = align(file);
+            entry.num_exceptions = exceptions.size();
+            write(file, exceptions);
+            entry.soft_masks_offset = align(file);
+            entry.num_soft_masks = soft_masks.size();
+            write(file, soft_masks);
+        }
+        file.seekp(index_position);
+        write_index();
+        if (!file) throw UnwritableTwoBitReference {output_path};
+    }
+    fs::rename(temp_path, output_path);
+}
+
+} // namespace io
+} // namespace octopus
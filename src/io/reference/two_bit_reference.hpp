@@ -0,0 +1,114 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef two_bit_reference_hpp
+#define two_bit_reference_hpp
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <boost/filesystem/path.hpp>
+
+#include "reference_reader.hpp"
+#include "fasta.hpp"
+
+namespace octopus {
+
+class GenomicRegion;
+
+namespace io {
+
+/*
+ TwoBitReference reads a memory mapped, indexed, 2-bit encoded copy of a FASTA file, which can be
+ made once with build_two_bit_reference.
+
+ Bases are packed four to a byte. Any symbol other than A, C, G, or T (e.g. N or IUPAC codes) is
+ recorded as a run in a sorted exception list, as are lower case (soft masked) runs, so the
+ original FASTA sequence can be recovered exactly.
+
+ Fetching sequence makes no system calls and is threadsafe, and the mapped pages are shared by
+ every process using the same file.
+ */
+
+class TwoBitReference : public ReferenceReader
+{
+public:
+    using Path    = boost::filesystem::path;
+    using Options = Fasta::Options;
+
+    using ContigName      = ReferenceReader::ContigName;
+    using GenomicSize     = ReferenceReader::GenomicSize;
+    using GeneticSequence = ReferenceReader::GeneticSequence;
+
+    TwoBitReference() = delete;
+
+    TwoBitReference(Path path);
+    TwoBitReference(Path path, Options options);
+
+    TwoBitReference(const TwoBitReference&)            = default;
+    TwoBitReference& operator=(const TwoBitReference&) = default;
+    TwoBitReference(TwoBitReference&&)                 = default;
+    TwoBitReference& operator=(TwoBitReference&&)      = default;
+
+    ~TwoBitReference() override = default;
+
+private:
+    class MappedFile;
+
+    struct Run
+    {
+        std::uint32_t begin, length;
+    };
+    struct SymbolRun
+    {
+        std::uint32_t begin, length;
+        char symbol;
+        char padding[3];
+    };
+    struct Contig
+    {
+        GenomicSize size;
+        const std::uint8_t* bases;
+        const SymbolRun* exceptions;
+        std::size_t num_exceptions;
+        const Run* soft_masks;
+        std::size_t num_soft_masks;
+    };
+
+    Path path_;
+    std::shared_ptr<const MappedFile> file_;
+    Options options_;
+    std::string name_;
+    std::vector<ContigName> contig_names_;
+    std::unordered_map<ContigName, Contig> contigs_;
+
+    std::unique_ptr<ReferenceReader> do_clone() const override;
+    bool do_is_open() const noexcept override;
+    std::string do_fetch_reference_name() const override;
+    std::vector<ContigName> do_fetch_contig_names() const override;
+    GenomicSize do_fetch_contig_size(const ContigName& contig) const override;
+    GeneticSequence do_fetch_sequence(const GenomicRegion& region) const override;
+    void do_fetch_sequence_to(const GenomicRegion& region, GeneticSequence& result) const override;
+
+    void read_index();
+
+    friend void build_two_bit_reference(const Path&, const Path&);
+};
+
+bool is_two_bit_reference(const boost::filesystem::path& path);
+
+// The path build_two_bit_reference writes to by default
+boost::filesystem::path get_two_bit_reference_path(const boost::filesystem::path& fasta_path);
+
+// Writes a TwoBitReference file for the FASTA file. The output is written to a temporary file
+// and then renamed, so concurrent builds of the same file are safe.
+void build_two_bit_reference(const boost::filesystem::path& fasta_path, const boost::filesystem::path& output_path);
+
+} // namespace io
+} // namespace octopus
+
+#endif
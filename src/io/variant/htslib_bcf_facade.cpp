@@ -21,6 +21,7 @@
 #include "basics/genomic_region.hpp"
 #include "utils/string_utils.hpp"
 #include "exceptions/file_open_error.hpp"
+#include "io/htslib_thread_pool.hpp"
 #include "vcf_spec.hpp"
 #include "vcf_header.hpp"
 #include "vcf_record.hpp"
@@ -110,6 +111,7 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
             if (!file_) {
                 throw FileOpenError {file_path_};
             }
+            attach_htslib_thread_pool(file_.get());
             header_.reset(bcf_hdr_read(file_.get()));
             if (!header_) {
                 throw std::runtime_error {"HtslibBcfFacade: could not make header for file " + file_path_.string()};
@@ -123,6 +125,7 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
         if (!file_) {
             throw FileOpenError {file_path_};
         }
+        attach_htslib_thread_pool(file_.get());
         header_.reset(bcf_hdr_init(hts_mode.c_str()));
     } else {
         const auto hts_read_mode = get_hts_mode(file_path_, Mode::read);
@@ -136,6 +139,7 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
         if (!file_) {
             throw FileOpenError {file_path_};
         }
+        attach_htslib_thread_pool(file_.get());
         if (header_) {
             samples_ = extract_samples(header_.get());
         } else {
@@ -182,6 +186,7 @@ std::size_t HtslibBcfFacade::count_records() const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return count_records(sr);
 }
 
@@ -196,6 +201,7 @@ std::size_t HtslibBcfFacade::count_records(const std::string& contig) const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return count_records(sr);
 }
 
@@ -210,6 +216,7 @@ std::size_t HtslibBcfFacade::count_records(const GenomicRegion& region) const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return count_records(sr);
 }
 
@@ -225,6 +232,7 @@ HtslibBcfFacade::RecordIteratorPtrPair HtslibBcfFacade::iterate(const UnpackPoli
             throw std::runtime_error {"failed to open file " + file_path_.string()};
         }
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return std::make_pair(std::make_unique<RecordIterator>(*this, std::move(sr), level),
                           std::make_unique<RecordIterator>(*this));
 }
@@ -245,6 +253,7 @@ HtslibBcfFacade::iterate(const std::string& contig, const UnpackPolicy level) co
             throw std::runtime_error {"failed to open file " + file_path_.string()};
         }
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return std::make_pair(std::make_unique<RecordIterator>(*this, std::move(sr), level),
                           std::make_unique<RecordIterator>(*this));
 }
@@ -266,6 +275,7 @@ HtslibBcfFacade::iterate(const GenomicRegion& region, const UnpackPolicy level)
             throw std::runtime_error {"failed to open file " + file_path_.string()};
         }
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return std::make_pair(std::make_unique<RecordIterator>(*this, std::move(sr), level),
                           std::make_unique<RecordIterator>(*this));
 }
@@ -280,6 +290,7 @@ HtslibBcfFacade::fetch_records(const UnpackPolicy level) const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return fetch_records(sr.get(), level, n_records);
 }
 
@@ -296,6 +307,7 @@ HtslibBcfFacade::fetch_records(const std::string& contig, const UnpackPolicy lev
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return fetch_records(sr.get(), level, n_records);
 }
 
@@ -313,6 +325,7 @@ HtslibBcfFacade::fetch_records(const GenomicRegion& region, const UnpackPolicy l
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr->readers[0].file);
     return fetch_records(sr.get(), level, n_records);
 }
 
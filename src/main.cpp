@@ -13,6 +13,8 @@
 #include "config/option_parser.hpp"
 #include "config/option_collation.hpp"
 #include "core/octopus.hpp"
+#include "core/models/pairhmm/simd_pair_hmm_kernel.hpp"
+#include "io/htslib_thread_pool.hpp"
 #include "utils/timing.hpp"
 #include "utils/system_utils.hpp"
 #include "utils/string_utils.hpp"
@@ -66,6 +68,30 @@ void sanity_check(const OptionMap& options)
     }
 }
 
+void init_pair_hmm(const OptionMap& options)
+{
+    const auto isa = options::get_pair_hmm_instruction_set(options);
+    hmm::simd::set_instruction_set(isa);
+    logging::InfoLogger info_log {};
+    stream(info_log) << "Using " << isa << " pair HMM kernels";
+}
+
+// The htslib thread pool must outlive every file handle that uses it
+struct HtslibThreadPoolGuard
+{
+    ~HtslibThreadPoolGuard() { io::destroy_htslib_thread_pool(); }
+};
+
+void init_htslib_thread_pool(const OptionMap& options)
+{
+    const auto num_threads = options::get_num_decompression_threads(options);
+    if (num_threads > 0) {
+        io::init_htslib_thread_pool(num_threads);
+        logging::InfoLogger info_log {};
+        stream(info_log) << "Using " << num_threads << " threads for file decompression";
+    }
+}
+
 } // namespace
 
 int main(const int argc, const char** argv)
@@ -90,6 +116,9 @@ int main(const int argc, const char** argv)
             const auto start = std::chrono::system_clock::now();
             sanity_check(options);
             log_command_line_options(options);
+            init_pair_hmm(options);
+            const HtslibThreadPoolGuard htslib_thread_pool_guard {};
+            init_htslib_thread_pool(options);
             auto components = collate_genome_calling_components(options);
             auto end = std::chrono::system_clock::now();
             using utils::TimeInterval;
@@ -7,6 +7,7 @@
 #include <limits>
 #include <algorithm>
 #include <iterator>
+#include <chrono>
 
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
@@ -23,7 +24,9 @@ BufferedReadPipe::BufferedReadPipe(const ReadPipe& source, Config config, std::v
 , buffer_ {}
 , buffered_region_ {}
 , hints_ {}
+, debug_log_ {}
 {
+    if (DEBUG_MODE) debug_log_ = logging::DebugLogger {};
     hint(std::move(hints));
 }
 
@@ -34,6 +37,7 @@ const ReadPipe& BufferedReadPipe::source() const noexcept
 
 void BufferedReadPipe::clear() noexcept
 {
+    cancel_prefetch();
     buffer_.clear();
     buffered_region_ = boost::none;
     hints_.clear();
@@ -48,6 +52,7 @@ ReadMap BufferedReadPipe::fetch_reads(const GenomicRegion& region) const
 
 void BufferedReadPipe::hint(std::vector<GenomicRegion> hints) const
 {
+    cancel_prefetch();
     hints_.clear();
     for (auto& region : hints) {
         hints_[region.contig_name()].insert(std::move(region));
@@ -71,38 +76,126 @@ bool BufferedReadPipe::is_cached(const GenomicRegion& region) const noexcept
 void BufferedReadPipe::setup_buffer(const GenomicRegion& request) const
 {
     if (!is_cached(request)) {
-        auto max_region = get_max_fetch_region(request);
-        bool unchecked_fetch {false};
-        if (can_make_unchecked_fetch()) {
-            buffered_region_ = std::move(max_region);
-            unchecked_fetch = true;
-        } else {
-            buffered_region_ = source_.get().read_manager().find_covered_subregion(max_region, config_.max_buffer_size);
+        using namespace std::chrono;
+        boost::optional<steady_clock::time_point> stall_start {};
+        if (debug_log_) stall_start = steady_clock::now();
+        const auto prefetched = try_use_prefetched_buffer(request);
+        if (!prefetched) {
+            const auto plan = plan_fetch(request);
+            commit(plan, fetch(source_.get(), plan, buffer_capacity(), config_.fetch_expansion));
         }
-        buffer_ = source_.get().fetch_reads(expand(*buffered_region_, config_.fetch_expansion));
-        if (unchecked_fetch) {
-            const auto fetch_size = count_reads(buffer_);
-            if (fetch_size > config_.max_buffer_size) {
-                if (default_unchecked_fetch_overflowed_) {
-                    adjusted_unchecked_fetch_overflowed_ = true;
-                } else {
-                    default_unchecked_fetch_overflowed_ = true;
-                }
-                // Clear buffer of reads to rhs of request
-                for (auto& p : buffer_) {
-                    const auto last_overlapped = find_first_after(p.second, request);
-                    p.second.erase(last_overlapped, std::cend(p.second));
-                }
-                buffered_region_ = request;
-            }
-        } else {
-            if (min_checked_fetch_size_) {
-                min_checked_fetch_size_ = std::min(size(*buffered_region_), *min_checked_fetch_size_);
+        if (debug_log_) {
+            const auto stall_time = duration_cast<milliseconds>(steady_clock::now() - *stall_start);
+            stream(*debug_log_) << "Waited " << stall_time.count() << "ms for "
+                                << (prefetched ? "prefetched " : "") << "reads in " << *buffered_region_
+                                << " requested by " << request;
+        }
+        if (config_.prefetch_workers) prefetch_next_buffer();
+    }
+}
+
+BufferedReadPipe::FetchPlan BufferedReadPipe::plan_fetch(const GenomicRegion& request) const
+{
+    auto max_region = get_max_fetch_region(request);
+    return {request, std::move(max_region), can_make_unchecked_fetch()};
+}
+
+BufferedReadPipe::Buffer
+BufferedReadPipe::fetch(const ReadPipe& source, const FetchPlan& plan, const std::size_t max_reads,
+                        const GenomicRegion::Size expansion)
+{
+    Buffer result {};
+    if (plan.unchecked) {
+        result.region = plan.max_region;
+    } else {
+        result.region = source.read_manager().find_covered_subregion(plan.max_region, max_reads);
+    }
+    result.reads = source.fetch_reads(expand(result.region, expansion));
+    result.overflowed = false;
+    if (plan.unchecked && count_reads(result.reads) > max_reads) {
+        // Clear buffer of reads to rhs of request
+        for (auto& p : result.reads) {
+            const auto last_overlapped = find_first_after(p.second, plan.request);
+            p.second.erase(last_overlapped, std::cend(p.second));
+        }
+        result.region = plan.request;
+        result.overflowed = true;
+    }
+    return result;
+}
+
+void BufferedReadPipe::commit(const FetchPlan& plan, Buffer buffer) const
+{
+    buffer_ = std::move(buffer.reads);
+    buffered_region_ = std::move(buffer.region);
+    if (plan.unchecked) {
+        if (buffer.overflowed) {
+            if (default_unchecked_fetch_overflowed_) {
+                adjusted_unchecked_fetch_overflowed_ = true;
             } else {
-                min_checked_fetch_size_ = size(*buffered_region_);
+                default_unchecked_fetch_overflowed_ = true;
             }
         }
+    } else {
+        if (min_checked_fetch_size_) {
+            min_checked_fetch_size_ = std::min(size(*buffered_region_), *min_checked_fetch_size_);
+        } else {
+            min_checked_fetch_size_ = size(*buffered_region_);
+        }
+    }
+}
+
+bool BufferedReadPipe::try_use_prefetched_buffer(const GenomicRegion& request) const
+{
+    if (!prefetch_plan_) return false;
+    auto plan = std::move(*prefetch_plan_);
+    prefetch_plan_ = boost::none;
+    Buffer buffer;
+    try {
+        // Runs the fetch here if the workers have not started it yet
+        buffer = prefetched_buffer_->get();
+        prefetched_buffer_ = boost::none;
+    } catch (...) {
+        // Let the synchronous fetch report any problem
+        prefetched_buffer_ = boost::none;
+        return false;
     }
+    if (is_same_contig(buffer.region, request) && contains(buffer.region, request)) {
+        commit(plan, std::move(buffer));
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void BufferedReadPipe::cancel_prefetch() const noexcept
+{
+    prefetch_plan_ = boost::none;
+    prefetched_buffer_ = boost::none; // cancels the fetch if it has not started
+}
+
+void BufferedReadPipe::prefetch_next_buffer() const
+{
+    if (!buffered_region_) return;
+    const auto contig_hints_itr = hints_.find(buffered_region_->contig_name());
+    if (contig_hints_itr == std::cend(hints_)) return;
+    const auto next_request = predict_next_request(*buffered_region_, contig_hints_itr->second);
+    if (next_request) {
+        prefetch_plan_ = plan_fetch(*next_request);
+        // Only copies are captured as this object may be moved while the fetch is running
+        const auto& source = source_.get();
+        auto plan = *prefetch_plan_;
+        const auto max_reads = buffer_capacity();
+        const auto expansion = config_.fetch_expansion;
+        prefetched_buffer_.emplace([&source, plan, max_reads, expansion] () {
+                                       return fetch(source, plan, max_reads, expansion);
+                                   }, *config_.prefetch_workers);
+    }
+}
+
+std::size_t BufferedReadPipe::buffer_capacity() const noexcept
+{
+    return config_.prefetch_workers ? config_.max_buffer_size / 2 : config_.max_buffer_size;
 }
 
 GenomicRegion BufferedReadPipe::get_max_fetch_region(const GenomicRegion& request) const
@@ -164,4 +257,15 @@ bool BufferedReadPipe::can_make_unchecked_fetch() const noexcept
            && (config_.max_fetch_size || min_checked_fetch_size_);
 }
 
+boost::optional<GenomicRegion>
+predict_next_request(const GenomicRegion& buffered_region, const MappableFlatSet<GenomicRegion>& hints)
+{
+    // Hints are covered regions, so are sorted by both begin and end
+    const auto next_hint_itr = std::find_if(std::cbegin(hints), std::cend(hints),
+                                            [&] (const auto& hint) { return ends_before(buffered_region, hint); });
+    if (next_hint_itr == std::cend(hints)) return boost::none;
+    const auto next_begin = std::max(next_hint_itr->begin(), buffered_region.end());
+    return GenomicRegion {buffered_region.contig_name(), next_begin, next_begin};
+}
+
 } // namespace octopus
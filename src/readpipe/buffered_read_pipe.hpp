@@ -11,7 +11,11 @@
 
 #include "read_pipe.hpp"
 #include "basics/genomic_region.hpp"
+#include "containers/mappable_flat_set.hpp"
 #include "containers/mappable_map.hpp"
+#include "utils/thread_pool.hpp"
+#include "utils/prefetch.hpp"
+#include "logging/logging.hpp"
 
 namespace octopus {
 
@@ -25,6 +29,9 @@ public:
         boost::optional<GenomicRegion::Size> max_fetch_size = boost::none;
         boost::optional<GenomicRegion::Size> max_hint_gap = boost::none;
         bool allow_unchecked_fetches = true;
+        // Fetch the next hinted region on these workers while the current buffer is in use.
+        // The current and prefetched buffers then share max_buffer_size.
+        boost::optional<ThreadPool&> prefetch_workers = boost::none;
     };
     
     BufferedReadPipe() = delete;
@@ -55,6 +62,18 @@ public:
 private:
     using RegionMap = MappableSetMap<GenomicRegion::ContigName, GenomicRegion>;
     
+    struct FetchPlan
+    {
+        GenomicRegion request, max_region;
+        bool unchecked;
+    };
+    struct Buffer
+    {
+        ReadMap reads;
+        GenomicRegion region;
+        bool overflowed;
+    };
+    
     std::reference_wrapper<const ReadPipe> source_;
     Config config_;
     mutable ReadMap buffer_;
@@ -63,13 +82,29 @@ private:
     mutable bool default_unchecked_fetch_overflowed_ = false;
     mutable bool adjusted_unchecked_fetch_overflowed_ = false;
     mutable boost::optional<GenomicRegion::Size> min_checked_fetch_size_ = boost::none;
+    mutable boost::optional<FetchPlan> prefetch_plan_ = boost::none;
+    mutable boost::optional<Prefetch<Buffer>> prefetched_buffer_;
+    mutable boost::optional<logging::DebugLogger> debug_log_;
     
     void setup_buffer(const GenomicRegion& request) const;
+    FetchPlan plan_fetch(const GenomicRegion& request) const;
+    static Buffer fetch(const ReadPipe& source, const FetchPlan& plan, std::size_t max_reads,
+                        GenomicRegion::Size expansion);
+    void commit(const FetchPlan& plan, Buffer buffer) const;
+    bool try_use_prefetched_buffer(const GenomicRegion& request) const;
+    void cancel_prefetch() const noexcept;
+    void prefetch_next_buffer() const;
+    std::size_t buffer_capacity() const noexcept;
     GenomicRegion get_max_fetch_region(const GenomicRegion& request) const;
     GenomicRegion get_default_max_fetch_region(const GenomicRegion& request) const;
     bool can_make_unchecked_fetch() const noexcept;
 };
 
+// The request expected after the buffered region, which is the start of the first hint that ends after it.
+// The hints must be covered regions on the same contig as the buffered region.
+boost::optional<GenomicRegion>
+predict_next_request(const GenomicRegion& buffered_region, const MappableFlatSet<GenomicRegion>& hints);
+
 } // namespace octopus
 
 #endif
@@ -0,0 +1,115 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+// This file must be compiled with AVX2 enabled (-mavx2), and nothing in it may run before checking
+// the CPU supports AVX2.
+
+#include "batch_maths_kernels.hpp"
+
+#if defined(__AVX2__)
+
+#if __GNUC__ >= 6
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+#include <cstdint>
+#include <immintrin.h>
+
+#include "batch_maths_impl.hpp"
+
+namespace octopus { namespace maths { namespace detail {
+
+namespace {
+
+struct AVX2MathsInstructionSet
+{
+    using Vector = __m256d;
+    static constexpr std::size_t lanes {4};
+    static constexpr const char* name {"AVX2"};
+
+    static Vector load(const double* p) noexcept { return _mm256_loadu_pd(p); }
+    static void store(double* p, const Vector x) noexcept { _mm256_storeu_pd(p, x); }
+    static Vector load(const float* p) noexcept { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+    static void store(float* p, const Vector x) noexcept { _mm_storeu_ps(p, _mm256_cvtpd_ps(x)); }
+    static Vector broadcast(const double x) noexcept { return _mm256_set1_pd(x); }
+    static Vector zero() noexcept { return _mm256_setzero_pd(); }
+
+    static Vector add(const Vector a, const Vector b) noexcept { return _mm256_add_pd(a, b); }
+    static Vector sub(const Vector a, const Vector b) noexcept { return _mm256_sub_pd(a, b); }
+    static Vector mul(const Vector a, const Vector b) noexcept { return _mm256_mul_pd(a, b); }
+    static Vector div(const Vector a, const Vector b) noexcept { return _mm256_div_pd(a, b); }
+    static Vector max(const Vector a, const Vector b) noexcept { return _mm256_max_pd(a, b); }
+    static Vector min(const Vector a, const Vector b) noexcept { return _mm256_min_pd(a, b); }
+    static Vector abs(const Vector x) noexcept { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x); }
+    static Vector round(const Vector x) noexcept { return _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    // Comparisons return lane masks for select
+    static Vector less(const Vector a, const Vector b) noexcept { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static Vector greater(const Vector a, const Vector b) noexcept { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static Vector equal(const Vector a, const Vector b) noexcept { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static Vector is_nan(const Vector x) noexcept { return _mm256_cmp_pd(x, x, _CMP_UNORD_Q); }
+    static Vector select(const Vector mask, const Vector a, const Vector b) noexcept { return _mm256_blendv_pd(b, a, mask); }
+
+    // 2^n for integral n in [-1022, 1023]
+    static Vector pow2(const Vector n) noexcept
+    {
+        // Adding 2^52 puts n + 1023 in the low mantissa bits, which are then shifted into the exponent
+        const auto biased = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(4503599627370496.0 + 1023)));
+        return _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+    }
+
+    // The m in x = m 2^e, m in [0.5, 1), for positive normal x
+    static Vector mantissa(const Vector x) noexcept
+    {
+        const auto bits = _mm256_castpd_si256(x);
+        const auto m = _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFF));
+        return _mm256_castsi256_pd(_mm256_or_si256(m, _mm256_set1_epi64x(0x3FE0000000000000)));
+    }
+
+    // The e in x = m 2^e, m in [0.5, 1), for positive normal x
+    static Vector exponent(const Vector x) noexcept
+    {
+        const auto biased = _mm256_srli_epi64(_mm256_castpd_si256(x), 52);
+        const auto magic = _mm256_set1_pd(4503599627370496.0);
+        const auto e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(biased, _mm256_castpd_si256(magic))), magic);
+        return _mm256_sub_pd(e, _mm256_set1_pd(1022));
+    }
+
+    static double horizontal_max(const Vector x) noexcept
+    {
+        const auto m = _mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(m, _mm_unpackhi_pd(m, m)));
+    }
+
+    static double horizontal_add(const Vector x) noexcept
+    {
+        const auto s = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+};
+
+} // namespace
+
+const BatchMathsKernels* get_avx2_batch_maths_kernels() noexcept
+{
+    return &BatchMaths<AVX2MathsInstructionSet>::kernels();
+}
+
+} // namespace detail
+} // namespace maths
+} // namespace octopus
+
+#else
+
+namespace octopus { namespace maths { namespace detail {
+
+const BatchMathsKernels* get_avx2_batch_maths_kernels() noexcept
+{
+    return nullptr;
+}
+
+} // namespace detail
+} // namespace maths
+} // namespace octopus
+
+#endif
@@ -0,0 +1,107 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+// This file must be compiled with AVX-512 enabled (-mavx512f), and nothing in it may run before checking
+// the CPU supports AVX-512.
+
+#include "batch_maths_kernels.hpp"
+
+#if defined(__AVX512F__)
+
+#if __GNUC__ >= 6
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+#if __GNUC__ >= 12
+    #pragma GCC diagnostic ignored "-Wuninitialized" // false positives in GCC's own AVX512 intrinsics
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <cstdint>
+#include <immintrin.h>
+
+#include "batch_maths_impl.hpp"
+
+namespace octopus { namespace maths { namespace detail {
+
+namespace {
+
+struct AVX512MathsInstructionSet
+{
+    using Vector = __m512d;
+    using Mask   = __mmask8;
+    static constexpr std::size_t lanes {8};
+    static constexpr const char* name {"AVX-512"};
+
+    static Vector load(const double* p) noexcept { return _mm512_loadu_pd(p); }
+    static void store(double* p, const Vector x) noexcept { _mm512_storeu_pd(p, x); }
+    static Vector load(const float* p) noexcept { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+    static void store(float* p, const Vector x) noexcept { _mm256_storeu_ps(p, _mm512_cvtpd_ps(x)); }
+    static Vector broadcast(const double x) noexcept { return _mm512_set1_pd(x); }
+    static Vector zero() noexcept { return _mm512_setzero_pd(); }
+
+    static Vector add(const Vector a, const Vector b) noexcept { return _mm512_add_pd(a, b); }
+    static Vector sub(const Vector a, const Vector b) noexcept { return _mm512_sub_pd(a, b); }
+    static Vector mul(const Vector a, const Vector b) noexcept { return _mm512_mul_pd(a, b); }
+    static Vector div(const Vector a, const Vector b) noexcept { return _mm512_div_pd(a, b); }
+    static Vector max(const Vector a, const Vector b) noexcept { return _mm512_max_pd(a, b); }
+    static Vector min(const Vector a, const Vector b) noexcept { return _mm512_min_pd(a, b); }
+    static Vector abs(const Vector x) noexcept
+    {
+        return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(x), _mm512_set1_epi64(0x7FFFFFFFFFFFFFFF)));
+    }
+    static Vector round(const Vector x) noexcept { return _mm512_roundscale_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    static Mask less(const Vector a, const Vector b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static Mask greater(const Vector a, const Vector b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static Mask equal(const Vector a, const Vector b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+    static Mask is_nan(const Vector x) noexcept { return _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q); }
+    static Vector select(const Mask mask, const Vector a, const Vector b) noexcept { return _mm512_mask_blend_pd(mask, b, a); }
+
+    // 2^n for integral n in [-1022, 1023]
+    static Vector pow2(const Vector n) noexcept
+    {
+        const auto biased = _mm512_castpd_si512(_mm512_add_pd(n, _mm512_set1_pd(4503599627370496.0 + 1023)));
+        return _mm512_castsi512_pd(_mm512_slli_epi64(biased, 52));
+    }
+
+    // The m in x = m 2^e, m in [0.5, 1), for positive normal x
+    static Vector mantissa(const Vector x) noexcept
+    {
+        return _mm512_getmant_pd(x, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_src);
+    }
+
+    // The e in x = m 2^e, m in [0.5, 1), for positive normal x
+    static Vector exponent(const Vector x) noexcept
+    {
+        return _mm512_add_pd(_mm512_getexp_pd(x), _mm512_set1_pd(1.0));
+    }
+
+    static double horizontal_max(const Vector x) noexcept { return _mm512_reduce_max_pd(x); }
+    static double horizontal_add(const Vector x) noexcept { return _mm512_reduce_add_pd(x); }
+};
+
+} // namespace
+
+const BatchMathsKernels* get_avx512_batch_maths_kernels() noexcept
+{
+    return &BatchMaths<AVX512MathsInstructionSet>::kernels();
+}
+
+} // namespace detail
+} // namespace maths
+} // namespace octopus
+
+#else
+
+namespace octopus { namespace maths { namespace detail {
+
+const BatchMathsKernels* get_avx512_batch_maths_kernels() noexcept
+{
+    return nullptr;
+}
+
+} // namespace detail
+} // namespace maths
+} // namespace octopus
+
+#endif
@@ -0,0 +1,430 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef batch_maths_impl_hpp
+#define batch_maths_impl_hpp
+
+#include <cstddef>
+#include <limits>
+
+#include "batch_maths_kernels.hpp"
+
+namespace octopus { namespace maths { namespace detail {
+
+/*
+    Vectorised exp and log, written once against an instruction set wrapper providing the vector
+    operations (see avx2_batch_maths.cpp). exp uses the rational approximation of the Cephes library
+    and log the argument reduction of fdlibm; both are accurate to a few ulps over the whole double
+    range. Unlike std::exp and std::log, neither sets errno.
+
+    This header must only be included from translation units compiled for the instruction set.
+    Everything here has internal linkage, and library algorithms are avoided, so no function compiled
+    with the instruction set can be merged by the linker with a copy used by the scalar code.
+*/
+
+namespace {
+
+template <typename ISA>
+struct BatchMaths
+{
+    using Vector = typename ISA::Vector;
+    static constexpr std::size_t lanes {ISA::lanes};
+
+    static Vector exp(const Vector x) noexcept
+    {
+        const auto max_log = ISA::broadcast(709.782712893383996732);
+        const auto min_log = ISA::broadcast(-745.133219101941108420);
+        const auto xc = ISA::min(ISA::max(x, min_log), max_log);
+        // x = n ln 2 + r, |r| <= ln 2 / 2
+        const auto n = ISA::round(ISA::mul(xc, ISA::broadcast(1.44269504088896340736)));
+        auto r = ISA::sub(xc, ISA::mul(n, ISA::broadcast(6.93145751953125e-1)));
+        r = ISA::sub(r, ISA::mul(n, ISA::broadcast(1.42860682030941723212e-6)));
+        // exp(r) = 1 + 2r P(r^2) / (Q(r^2) - r P(r^2))
+        const auto rr = ISA::mul(r, r);
+        auto p = ISA::broadcast(1.26177193074810590878e-4);
+        p = ISA::add(ISA::mul(p, rr), ISA::broadcast(3.02994407707441961300e-2));
+        p = ISA::add(ISA::mul(p, rr), ISA::broadcast(9.99999999999999999910e-1));
+        p = ISA::mul(p, r);
+        auto q = ISA::broadcast(3.00198505138664455042e-6);
+        q = ISA::add(ISA::mul(q, rr), ISA::broadcast(2.52448340349684104192e-3));
+        q = ISA::add(ISA::mul(q, rr), ISA::broadcast(2.27265548208155028766e-1));
+        q = ISA::add(ISA::mul(q, rr), ISA::broadcast(2.00000000000000000009e0));
+        const auto one = ISA::broadcast(1.0);
+        auto result = ISA::add(one, ISA::mul(ISA::broadcast(2.0), ISA::div(p, ISA::sub(q, p))));
+        // n is in [-1075, 1024], which does not fit the exponent of one double, so scale in two steps
+        const auto n1 = ISA::round(ISA::mul(n, ISA::broadcast(0.5)));
+        result = ISA::mul(ISA::mul(result, ISA::pow2(n1)), ISA::pow2(ISA::sub(n, n1)));
+        result = ISA::select(ISA::less(x, min_log), ISA::zero(), result);
+        result = ISA::select(ISA::greater(x, max_log), ISA::broadcast(std::numeric_limits<double>::infinity()), result);
+        return ISA::select(ISA::is_nan(x), x, result);
+    }
+
+    static Vector log(const Vector x) noexcept
+    {
+        const auto one = ISA::broadcast(1.0);
+        const auto min_normal = ISA::broadcast(std::numeric_limits<double>::min());
+        // Scale subnormals into the normal range so the exponent can be read from the bits
+        const auto is_subnormal = ISA::less(x, min_normal);
+        const auto xs = ISA::select(is_subnormal, ISA::mul(x, ISA::broadcast(4503599627370496.0)), x);
+        // xs = m 2^e, m in [0.5, 1)
+        auto m = ISA::mantissa(xs);
+        auto e = ISA::exponent(xs);
+        e = ISA::select(is_subnormal, ISA::sub(e, ISA::broadcast(52.0)), e);
+        const auto is_small = ISA::less(m, ISA::broadcast(0.707106781186547524401));
+        e = ISA::select(is_small, ISA::sub(e, one), e);
+        // ln(1 + f) = f - f^2 / 2 + s (f^2 / 2 + R(s^2)), where s = f / (2 + f) and R is the tail of the
+        // series for 2 atanh(s). |s| < 0.172, so the truncated series is exact to double precision.
+        const auto f = ISA::sub(ISA::select(is_small, ISA::add(m, m), m), one);
+        const auto s = ISA::div(f, ISA::add(ISA::broadcast(2.0), f));
+        const auto z = ISA::mul(s, s);
+        const double coefficients[] {2.0 / 21, 2.0 / 19, 2.0 / 17, 2.0 / 15, 2.0 / 13, 2.0 / 11, 2.0 / 9, 2.0 / 7, 2.0 / 5, 2.0 / 3};
+        auto r = ISA::broadcast(2.0 / 23);
+        for (const double c : coefficients) {
+            r = ISA::add(ISA::mul(r, z), ISA::broadcast(c));
+        }
+        r = ISA::mul(r, z);
+        const auto hfsq = ISA::mul(ISA::broadcast(0.5), ISA::mul(f, f));
+        // ln 2 is split in two so e ln 2 is exact
+        auto y = ISA::add(ISA::mul(s, ISA::add(hfsq, r)), ISA::mul(e, ISA::broadcast(-2.121944400546905827679e-4)));
+        y = ISA::sub(f, ISA::sub(hfsq, y));
+        auto result = ISA::add(y, ISA::mul(e, ISA::broadcast(0.693359375)));
+        const auto inf = ISA::broadcast(std::numeric_limits<double>::infinity());
+        result = ISA::select(ISA::equal(x, ISA::zero()), ISA::sub(ISA::zero(), inf), result);
+        result = ISA::select(ISA::equal(x, inf), inf, result);
+        return ISA::select(ISA::less(x, ISA::zero()), ISA::broadcast(std::numeric_limits<double>::quiet_NaN()),
+                           ISA::select(ISA::is_nan(x), x, result));
+    }
+
+    // Guards a log-sum-exp with maximum max: if max is infinite the result is max, not NaN
+    static Vector log_sum_exp_guard(const Vector max, const Vector result) noexcept
+    {
+        const auto inf = ISA::broadcast(std::numeric_limits<double>::infinity());
+        return ISA::select(ISA::equal(ISA::abs(max), inf), max, result);
+    }
+
+    static Vector log_sum_exp(const Vector a, const Vector b) noexcept
+    {
+        const auto max = ISA::max(a, b), min = ISA::min(a, b);
+        const auto result = ISA::add(max, log(ISA::add(ISA::broadcast(1.0), exp(ISA::sub(min, max)))));
+        return ISA::select(ISA::is_nan(a), a, ISA::select(ISA::is_nan(b), b, log_sum_exp_guard(max, result)));
+    }
+
+    static Vector log_sum_exp(const Vector a, const Vector b, const Vector c) noexcept
+    {
+        const auto max = ISA::max(ISA::max(a, b), c);
+        auto sum = ISA::add(exp(ISA::sub(a, max)), exp(ISA::sub(b, max)));
+        sum = ISA::add(sum, exp(ISA::sub(c, max)));
+        const auto result = ISA::add(max, log(sum));
+        return ISA::select(ISA::is_nan(a), a, ISA::select(ISA::is_nan(b), b, ISA::select(ISA::is_nan(c), c,
+                                                                                         log_sum_exp_guard(max, result))));
+    }
+
+    // Loads the last n < lanes values, padding the rest with pad
+    template <typename T>
+    static Vector load_partial(const T* values, const std::size_t n, const double pad) noexcept
+    {
+        alignas(64) T buffer[lanes];
+        std::size_t i {0};
+        for (; i < n; ++i) buffer[i] = values[i];
+        for (; i < lanes; ++i) buffer[i] = static_cast<T>(pad);
+        return ISA::load(buffer);
+    }
+
+    template <typename T>
+    static void store_partial(T* result, const Vector x, const std::size_t n) noexcept
+    {
+        alignas(64) T buffer[lanes];
+        ISA::store(buffer, x);
+        for (std::size_t i {0}; i < n; ++i) result[i] = buffer[i];
+    }
+
+    static void log_sum_exp(const double* a, const double* b, double* result, const std::size_t n)
+    {
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            ISA::store(result + i, log_sum_exp(ISA::load(a + i), ISA::load(b + i)));
+        }
+        if (i < n) {
+            const auto tail = n - i;
+            store_partial(result + i, log_sum_exp(load_partial(a + i, tail, 0), load_partial(b + i, tail, 0)), tail);
+        }
+    }
+
+    static void log_sum_exp(const double* a, const double* b, const double* c, double* result, const std::size_t n)
+    {
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            ISA::store(result + i, log_sum_exp(ISA::load(a + i), ISA::load(b + i), ISA::load(c + i)));
+        }
+        if (i < n) {
+            const auto tail = n - i;
+            store_partial(result + i, log_sum_exp(load_partial(a + i, tail, 0), load_partial(b + i, tail, 0),
+                                                  load_partial(c + i, tail, 0)), tail);
+        }
+    }
+
+    static void exp(const double* values, const double shift, double* result, const std::size_t n)
+    {
+        const auto shift_v = ISA::broadcast(shift);
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            ISA::store(result + i, exp(ISA::sub(ISA::load(values + i), shift_v)));
+        }
+        if (i < n) {
+            const auto tail = n - i;
+            store_partial(result + i, exp(ISA::sub(load_partial(values + i, tail, 0), shift_v)), tail);
+        }
+    }
+
+    static void log(const double* values, double* result, const std::size_t n)
+    {
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            ISA::store(result + i, log(ISA::load(values + i)));
+        }
+        if (i < n) {
+            const auto tail = n - i;
+            store_partial(result + i, log(load_partial(values + i, tail, 1)), tail);
+        }
+    }
+
+    static double max(const double* values, const std::size_t n)
+    {
+        constexpr auto lowest = -std::numeric_limits<double>::infinity();
+        auto result = ISA::broadcast(lowest);
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            result = ISA::max(result, ISA::load(values + i));
+        }
+        if (i < n) {
+            result = ISA::max(result, load_partial(values + i, n - i, lowest));
+        }
+        return ISA::horizontal_max(result);
+    }
+
+    static double sum_exp(const double* values, const double shift, const std::size_t n)
+    {
+        constexpr auto lowest = -std::numeric_limits<double>::infinity();
+        const auto shift_v = ISA::broadcast(shift);
+        auto result = ISA::zero();
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            result = ISA::add(result, exp(ISA::sub(ISA::load(values + i), shift_v)));
+        }
+        if (i < n) {
+            result = ISA::add(result, exp(ISA::sub(load_partial(values + i, n - i, lowest), shift_v)));
+        }
+        return ISA::horizontal_add(result);
+    }
+
+    // ln sum {j < k} exp(x[j])
+    static Vector log_sum_exp(const Vector* x, const std::size_t k) noexcept
+    {
+        auto max = x[0];
+        for (std::size_t j {1}; j < k; ++j) max = ISA::max(max, x[j]);
+        auto sum = exp(ISA::sub(x[0], max));
+        for (std::size_t j {1}; j < k; ++j) sum = ISA::add(sum, exp(ISA::sub(x[j], max)));
+        return log_sum_exp_guard(max, ISA::add(max, log(sum)));
+    }
+
+    template <typename T>
+    static Vector load(const T* values, const std::size_t n) noexcept
+    {
+        return n == lanes ? ISA::load(values) : load_partial(values, n, 0);
+    }
+
+    template <typename T>
+    static void store(T* result, const Vector x, const std::size_t n) noexcept
+    {
+        if (n == lanes) {
+            ISA::store(result, x);
+        } else {
+            store_partial(result, x, n);
+        }
+    }
+
+    // Sums the first n lanes of x
+    static double sum(const Vector x, const std::size_t n) noexcept
+    {
+        if (n == lanes) return ISA::horizontal_add(x);
+        alignas(64) double buffer[lanes];
+        ISA::store(buffer, x);
+        double result {0};
+        for (std::size_t i {0}; i < n; ++i) result += buffer[i];
+        return result;
+    }
+
+    // The mixture log-sum-exp of the next n <= lanes values, for K components known at compile time
+    template <std::size_t K>
+    static Vector mixture_log_sum_exp(const double* const* values, const double* log_weights,
+                                      const std::size_t i, const std::size_t n) noexcept
+    {
+        Vector x[K];
+        for (std::size_t j {0}; j < K; ++j) x[j] = ISA::add(load(values[j] + i, n), ISA::broadcast(log_weights[j]));
+        if (K == 2) return log_sum_exp(x[0], x[1]);
+        return log_sum_exp(x, K);
+    }
+
+    // The same for any number of components, which are reloaded rather than kept in registers
+    static Vector mixture_log_sum_exp(const double* const* values, const double* log_weights, const std::size_t k,
+                                      const std::size_t i, const std::size_t n) noexcept
+    {
+        auto max = ISA::broadcast(-std::numeric_limits<double>::infinity());
+        for (std::size_t j {0}; j < k; ++j) {
+            max = ISA::max(max, ISA::add(load(values[j] + i, n), ISA::broadcast(log_weights[j])));
+        }
+        auto sum = ISA::zero();
+        for (std::size_t j {0}; j < k; ++j) {
+            sum = ISA::add(sum, exp(ISA::sub(ISA::add(load(values[j] + i, n), ISA::broadcast(log_weights[j])), max)));
+        }
+        return log_sum_exp_guard(max, ISA::add(max, log(sum)));
+    }
+
+    template <std::size_t K>
+    static double sum_log_sum_exp(const double* const* values, const double* log_weights, const std::size_t n) noexcept
+    {
+        auto result = ISA::zero();
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            result = ISA::add(result, mixture_log_sum_exp<K>(values, log_weights, i, lanes));
+        }
+        double tail {0};
+        if (i < n) tail = sum(mixture_log_sum_exp<K>(values, log_weights, i, n - i), n - i);
+        return ISA::horizontal_add(result) + tail;
+    }
+
+    static double sum_log_sum_exp(const double* const* values, const double* log_weights, const std::size_t k, const std::size_t n)
+    {
+        if (k == 0) return 0;
+        if (k == 1) {
+            // No mixing, so no need to leave log space
+            double result {0};
+            for (std::size_t i {0}; i < n; ++i) result += values[0][i];
+            return result + n * log_weights[0];
+        }
+        switch (k) {
+            case 2: return sum_log_sum_exp<2>(values, log_weights, n);
+            case 3: return sum_log_sum_exp<3>(values, log_weights, n);
+            case 4: return sum_log_sum_exp<4>(values, log_weights, n);
+            default: {
+                auto result = ISA::zero();
+                std::size_t i {0};
+                for (; i + lanes <= n; i += lanes) {
+                    result = ISA::add(result, mixture_log_sum_exp(values, log_weights, k, i, lanes));
+                }
+                double tail {0};
+                if (i < n) tail = sum(mixture_log_sum_exp(values, log_weights, k, i, n - i), n - i);
+                return ISA::horizontal_add(result) + tail;
+            }
+        }
+    }
+
+    // Single precision arrays are widened to double on load and narrowed on store
+
+    static double inner_product(const float* a, const float* b, const std::size_t n) noexcept
+    {
+        auto result = ISA::zero();
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            result = ISA::add(result, ISA::mul(ISA::load(a + i), ISA::load(b + i)));
+        }
+        if (i < n) {
+            result = ISA::add(result, ISA::mul(load(a + i, n - i), load(b + i, n - i)));
+        }
+        return ISA::horizontal_add(result);
+    }
+
+    static void add_scaled(const double a, const float* x, double* y, const std::size_t n) noexcept
+    {
+        const auto a_v = ISA::broadcast(a);
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            ISA::store(y + i, ISA::add(ISA::load(y + i), ISA::mul(a_v, ISA::load(x + i))));
+        }
+        if (i < n) {
+            store(y + i, ISA::add(load(y + i, n - i), ISA::mul(a_v, load(x + i, n - i))), n - i);
+        }
+    }
+
+    static double sum(const float* values, const std::size_t n) noexcept
+    {
+        auto result = ISA::zero();
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            result = ISA::add(result, ISA::load(values + i));
+        }
+        if (i < n) result = ISA::add(result, load(values + i, n - i));
+        return ISA::horizontal_add(result);
+    }
+
+    static Vector entropy(const Vector p) noexcept
+    {
+        return ISA::select(ISA::equal(p, ISA::zero()), ISA::zero(), ISA::mul(p, log(p)));
+    }
+
+    static double entropy(const float* values, const std::size_t n) noexcept
+    {
+        auto result = ISA::zero();
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) {
+            result = ISA::sub(result, entropy(ISA::load(values + i)));
+        }
+        if (i < n) result = ISA::sub(result, entropy(load(values + i, n - i)));
+        return ISA::horizontal_add(result);
+    }
+
+    // The next n <= lanes columns of normalise_exp. The unnormalised exps are written to result
+    // and then scaled, so each value is only exponentiated once.
+    static void normalise_exp(const double* const* logs, float* const* result, const std::size_t k,
+                              const std::size_t i, const std::size_t n) noexcept
+    {
+        auto max = load(logs[0] + i, n);
+        for (std::size_t j {1}; j < k; ++j) max = ISA::max(max, load(logs[j] + i, n));
+        auto sum = ISA::zero();
+        for (std::size_t j {0}; j < k; ++j) {
+            const auto e = exp(ISA::sub(load(logs[j] + i, n), max));
+            sum = ISA::add(sum, e);
+            store(result[j] + i, e, n);
+        }
+        const auto norm = ISA::div(ISA::broadcast(1.0), sum);
+        for (std::size_t j {0}; j < k; ++j) {
+            store(result[j] + i, ISA::mul(load(result[j] + i, n), norm), n);
+        }
+    }
+
+    static void normalise_exp(const double* const* logs, float* const* result, const std::size_t k, const std::size_t n) noexcept
+    {
+        if (k == 0) return;
+        std::size_t i {0};
+        for (; i + lanes <= n; i += lanes) normalise_exp(logs, result, k, i, lanes);
+        if (i < n) normalise_exp(logs, result, k, i, n - i);
+    }
+
+    static const BatchMathsKernels& kernels() noexcept
+    {
+        static const BatchMathsKernels result {
+            [] (const double* a, const double* b, double* r, std::size_t n) { log_sum_exp(a, b, r, n); },
+            [] (const double* a, const double* b, const double* c, double* r, std::size_t n) { log_sum_exp(a, b, c, r, n); },
+            [] (const double* x, double s, double* r, std::size_t n) { exp(x, s, r, n); },
+            [] (const double* x, double* r, std::size_t n) { log(x, r, n); },
+            [] (const double* x, std::size_t n) { return max(x, n); },
+            [] (const double* x, double s, std::size_t n) { return sum_exp(x, s, n); },
+            [] (const double* const* x, const double* w, std::size_t k, std::size_t n) { return sum_log_sum_exp(x, w, k, n); },
+            [] (const float* a, const float* b, std::size_t n) { return inner_product(a, b, n); },
+            [] (double a, const float* x, double* y, std::size_t n) { add_scaled(a, x, y, n); },
+            [] (const float* x, std::size_t n) { return sum(x, n); },
+            [] (const float* x, std::size_t n) { return entropy(x, n); },
+            [] (const double* const* x, float* const* r, std::size_t k, std::size_t n) { normalise_exp(x, r, k, n); },
+            ISA::name
+        };
+        return result;
+    }
+};
+
+} // namespace
+
+} // namespace detail
+} // namespace maths
+} // namespace octopus
+
+#endif
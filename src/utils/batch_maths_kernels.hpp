@@ -0,0 +1,57 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef batch_maths_kernels_hpp
+#define batch_maths_kernels_hpp
+
+#include <cstddef>
+
+namespace octopus { namespace maths { namespace detail {
+
+/*
+    The kernels behind the batch functions in maths.hpp. As for the PairHMM kernels, each
+    instruction set has its own translation unit built with the flags for that instruction set,
+    and the kernels used are chosen at runtime from what the CPU supports.
+*/
+struct BatchMathsKernels
+{
+    // result[i] = ln(exp(a[i]) + exp(b[i]))
+    void (*log_sum_exp2)(const double* a, const double* b, double* result, std::size_t n);
+    // result[i] = ln(exp(a[i]) + exp(b[i]) + exp(c[i]))
+    void (*log_sum_exp3)(const double* a, const double* b, const double* c, double* result, std::size_t n);
+    // result[i] = exp(values[i] - shift)
+    void (*exp)(const double* values, double shift, double* result, std::size_t n);
+    // result[i] = ln(values[i])
+    void (*log)(const double* values, double* result, std::size_t n);
+    // max {values[i]}, or -infinity if n == 0
+    double (*max)(const double* values, std::size_t n);
+    // sum {exp(values[i] - shift)}
+    double (*sum_exp)(const double* values, double shift, std::size_t n);
+    // sum {i} ln sum {j < k} exp(values[j][i] + log_weights[j])
+    double (*sum_log_sum_exp)(const double* const* values, const double* log_weights, std::size_t k, std::size_t n);
+    // sum {i} a[i] * b[i]
+    double (*inner_product)(const float* a, const float* b, std::size_t n);
+    // y[i] += a * x[i]
+    void (*add_scaled)(double a, const float* x, double* y, std::size_t n);
+    // sum {i} values[i]
+    double (*sum)(const float* values, std::size_t n);
+    // -sum {i} values[i] ln values[i]
+    double (*entropy)(const float* values, std::size_t n);
+    // result[j][i] = exp(logs[j][i]) / sum {j' < k} exp(logs[j'][i])
+    void (*normalise_exp)(const double* const* logs, float* const* result, std::size_t k, std::size_t n);
+    const char* name;
+};
+
+const BatchMathsKernels& get_scalar_batch_maths_kernels() noexcept;
+// These return nullptr if the kernels are not compiled in
+const BatchMathsKernels* get_avx2_batch_maths_kernels() noexcept;
+const BatchMathsKernels* get_avx512_batch_maths_kernels() noexcept;
+
+// The fastest kernels the CPU supports
+const BatchMathsKernels& get_batch_maths_kernels() noexcept;
+
+} // namespace detail
+} // namespace maths
+} // namespace octopus
+
+#endif
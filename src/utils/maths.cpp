@@ -0,0 +1,238 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "maths.hpp"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+#include "batch_maths_kernels.hpp"
+
+namespace octopus { namespace maths {
+
+namespace detail {
+
+namespace {
+
+double scalar_log_sum_exp(const double a, const double b) noexcept
+{
+    if (std::isnan(a) || std::isnan(b)) return a + b;
+    const auto r = std::minmax(a, b);
+    if (std::isinf(r.second)) return r.second;
+    return r.second + std::log(1.0 + std::exp(r.first - r.second));
+}
+
+double scalar_log_sum_exp(const double a, const double b, const double c) noexcept
+{
+    if (std::isnan(a) || std::isnan(b) || std::isnan(c)) return a + b + c;
+    const auto max = std::max({a, b, c});
+    if (std::isinf(max)) return max;
+    return max + std::log(std::exp(a - max) + std::exp(b - max) + std::exp(c - max));
+}
+
+void scalar_log_sum_exp2(const double* a, const double* b, double* result, const std::size_t n)
+{
+    for (std::size_t i {0}; i < n; ++i) result[i] = scalar_log_sum_exp(a[i], b[i]);
+}
+
+void scalar_log_sum_exp3(const double* a, const double* b, const double* c, double* result, const std::size_t n)
+{
+    for (std::size_t i {0}; i < n; ++i) result[i] = scalar_log_sum_exp(a[i], b[i], c[i]);
+}
+
+void scalar_exp(const double* values, const double shift, double* result, const std::size_t n)
+{
+    for (std::size_t i {0}; i < n; ++i) result[i] = std::exp(values[i] - shift);
+}
+
+void scalar_log(const double* values, double* result, const std::size_t n)
+{
+    for (std::size_t i {0}; i < n; ++i) result[i] = std::log(values[i]);
+}
+
+double scalar_max(const double* values, const std::size_t n)
+{
+    return std::accumulate(values, values + n, -std::numeric_limits<double>::infinity(),
+                           [] (double lhs, double rhs) { return std::max(lhs, rhs); });
+}
+
+double scalar_sum_exp(const double* values, const double shift, const std::size_t n)
+{
+    return std::accumulate(values, values + n, 0.0, [shift] (double curr, double x) { return curr + std::exp(x - shift); });
+}
+
+double scalar_sum_log_sum_exp(const double* const* values, const double* log_weights, const std::size_t k, const std::size_t n)
+{
+    double result {0};
+    if (k == 0) return result;
+    for (std::size_t i {0}; i < n; ++i) {
+        auto max = -std::numeric_limits<double>::infinity();
+        for (std::size_t j {0}; j < k; ++j) max = std::max(max, values[j][i] + log_weights[j]);
+        if (std::isinf(max)) {
+            result += max;
+            continue;
+        }
+        double sum {0};
+        for (std::size_t j {0}; j < k; ++j) sum += std::exp(values[j][i] + log_weights[j] - max);
+        result += max + std::log(sum);
+    }
+    return result;
+}
+
+double scalar_inner_product(const float* a, const float* b, const std::size_t n)
+{
+    double result {0};
+    for (std::size_t i {0}; i < n; ++i) result += static_cast<double>(a[i]) * b[i];
+    return result;
+}
+
+void scalar_add_scaled(const double a, const float* x, double* y, const std::size_t n)
+{
+    for (std::size_t i {0}; i < n; ++i) y[i] += a * x[i];
+}
+
+double scalar_sum(const float* values, const std::size_t n)
+{
+    return std::accumulate(values, values + n, 0.0);
+}
+
+double scalar_entropy(const float* values, const std::size_t n)
+{
+    double result {0};
+    for (std::size_t i {0}; i < n; ++i) {
+        if (values[i] > 0) result -= values[i] * std::log(static_cast<double>(values[i]));
+    }
+    return result;
+}
+
+void scalar_normalise_exp(const double* const* logs, float* const* result, const std::size_t k, const std::size_t n)
+{
+    if (k == 0) return;
+    for (std::size_t i {0}; i < n; ++i) {
+        auto max = logs[0][i];
+        for (std::size_t j {1}; j < k; ++j) max = std::max(max, logs[j][i]);
+        double sum {0};
+        for (std::size_t j {0}; j < k; ++j) sum += std::exp(logs[j][i] - max);
+        for (std::size_t j {0}; j < k; ++j) result[j][i] = std::exp(logs[j][i] - max) / sum;
+    }
+}
+
+bool cpu_supports_avx2() noexcept
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+bool cpu_supports_avx512() noexcept
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+const BatchMathsKernels& select_batch_maths_kernels() noexcept
+{
+    if (cpu_supports_avx512() && get_avx512_batch_maths_kernels()) {
+        return *get_avx512_batch_maths_kernels();
+    } else if (cpu_supports_avx2() && get_avx2_batch_maths_kernels()) {
+        return *get_avx2_batch_maths_kernels();
+    } else {
+        return get_scalar_batch_maths_kernels();
+    }
+}
+
+} // namespace
+
+const BatchMathsKernels& get_scalar_batch_maths_kernels() noexcept
+{
+    static const BatchMathsKernels result {
+        scalar_log_sum_exp2, scalar_log_sum_exp3, scalar_exp, scalar_log, scalar_max, scalar_sum_exp,
+        scalar_sum_log_sum_exp, scalar_inner_product, scalar_add_scaled, scalar_sum, scalar_entropy,
+        scalar_normalise_exp, "scalar"
+    };
+    return result;
+}
+
+const BatchMathsKernels& get_batch_maths_kernels() noexcept
+{
+    static const BatchMathsKernels& result {select_batch_maths_kernels()};
+    return result;
+}
+
+} // namespace detail
+
+void log_sum_exp(const double* a, const double* b, double* result, const std::size_t n)
+{
+    detail::get_batch_maths_kernels().log_sum_exp2(a, b, result, n);
+}
+
+void log_sum_exp(const double* a, const double* b, const double* c, double* result, const std::size_t n)
+{
+    detail::get_batch_maths_kernels().log_sum_exp3(a, b, c, result, n);
+}
+
+double log_sum_exp(const double* values, const std::size_t n)
+{
+    const auto& kernels = detail::get_batch_maths_kernels();
+    const auto max = kernels.max(values, n);
+    if (std::isinf(max)) return max;
+    return max + std::log(kernels.sum_exp(values, max, n));
+}
+
+double sum_log_sum_exp(const double* const* values, const double* log_weights, const std::size_t k, const std::size_t n)
+{
+    return detail::get_batch_maths_kernels().sum_log_sum_exp(values, log_weights, k, n);
+}
+
+void exp_each(const double* values, double* result, const std::size_t n)
+{
+    detail::get_batch_maths_kernels().exp(values, 0, result, n);
+}
+
+void log_each(const double* values, double* result, const std::size_t n)
+{
+    detail::get_batch_maths_kernels().log(values, result, n);
+}
+
+double normalise_logs(double* logs, const std::size_t n)
+{
+    const auto norm = log_sum_exp(logs, n);
+    std::for_each(logs, logs + n, [norm] (double& p) { p -= norm; });
+    return norm;
+}
+
+double normalise_exp(double* logs, const std::size_t n)
+{
+    const auto norm = log_sum_exp(logs, n);
+    detail::get_batch_maths_kernels().exp(logs, norm, logs, n);
+    return norm;
+}
+
+double inner_product(const float* lhs, const float* rhs, const std::size_t n)
+{
+    return detail::get_batch_maths_kernels().inner_product(lhs, rhs, n);
+}
+
+void add_scaled(const double a, const float* x, double* y, const std::size_t n)
+{
+    detail::get_batch_maths_kernels().add_scaled(a, x, y, n);
+}
+
+double sum(const float* values, const std::size_t n)
+{
+    return detail::get_batch_maths_kernels().sum(values, n);
+}
+
+double entropy(const float* probabilities, const std::size_t n)
+{
+    return detail::get_batch_maths_kernels().entropy(probabilities, n);
+}
+
+void normalise_exp(const double* const* logs, float* const* result, const std::size_t k, const std::size_t n)
+{
+    detail::get_batch_maths_kernels().normalise_exp(logs, result, k, n);
+}
+
+} // namespace maths
+} // namespace octopus
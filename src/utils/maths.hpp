@@ -405,6 +405,52 @@ inline auto fast_log_sum_exp(const Container& values) noexcept
     return fast_log_sum_exp(std::cbegin(values), std::cend(values));
 }
 
+/*
+    Batch versions of the above over contiguous arrays of n values. These are vectorised with the
+    widest instruction set the CPU supports (see utils/batch_maths_kernels.hpp) and agree with the
+    scalar functions to within a few ulps. Outputs may alias inputs. Unlike the scalar versions, the
+    log-sum-exp of -infinities is -infinity, not NaN.
+*/
+
+// result[i] = ln(exp(a[i]) + exp(b[i]))
+void log_sum_exp(const double* a, const double* b, double* result, std::size_t n);
+// result[i] = ln(exp(a[i]) + exp(b[i]) + exp(c[i]))
+void log_sum_exp(const double* a, const double* b, const double* c, double* result, std::size_t n);
+// ln sum {exp(values[i])}, or -infinity if n == 0
+double log_sum_exp(const double* values, std::size_t n);
+// sum {i < n} ln sum {j < k} exp(values[j][i] + log_weights[j]), e.g. the log likelihood of n
+// independent observations under a k component mixture. Faster than the elementwise functions as
+// nothing is stored, and specialised for small k.
+double sum_log_sum_exp(const double* const* values, const double* log_weights, std::size_t k, std::size_t n);
+// result[i] = exp(values[i])
+void exp_each(const double* values, double* result, std::size_t n);
+// result[i] = ln(values[i])
+void log_each(const double* values, double* result, std::size_t n);
+// logs[i] -= ln sum {exp(logs[i])}, returning the normaliser
+double normalise_logs(double* logs, std::size_t n);
+// logs[i] = exp(logs[i] - ln sum {exp(logs[i])}), returning the normaliser
+double normalise_exp(double* logs, std::size_t n);
+
+// Single precision arrays, e.g. of probabilities or likelihoods stored as floats to halve memory
+// traffic. Values are widened to double for arithmetic, and sums are accumulated in double.
+
+// sum {i} lhs[i] * rhs[i]
+double inner_product(const float* lhs, const float* rhs, std::size_t n);
+// y[i] += a * x[i]
+void add_scaled(double a, const float* x, double* y, std::size_t n);
+// sum {i} values[i]
+double sum(const float* values, std::size_t n);
+// -sum {i} probabilities[i] ln probabilities[i], taking 0 ln 0 = 0
+double entropy(const float* probabilities, std::size_t n);
+// result[j][i] = exp(logs[j][i] - ln sum {j' < k} exp(logs[j'][i])), i.e. normalises each column of the
+// k x n matrix logs into result. Each column must have a finite maximum.
+void normalise_exp(const double* const* logs, float* const* result, std::size_t k, std::size_t n);
+
+inline double log_sum_exp(const std::vector<double>& values)
+{
+    return log_sum_exp(values.data(), values.size());
+}
+
 template <typename T, typename IntegerType,
           typename = std::enable_if_t<std::is_integral<IntegerType>::value>>
 T factorial(const IntegerType x)
@@ -1078,6 +1124,16 @@ void exp_each(Container& values)
     for (auto& v : values) v = std::exp(v);
 }
 
+inline void log_each(std::vector<double>& values)
+{
+    log_each(values.data(), values.data(), values.size());
+}
+
+inline void exp_each(std::vector<double>& values)
+{
+    exp_each(values.data(), values.data(), values.size());
+}
+
 template <typename Container>
 auto normalise_logs(Container& logs)
 {
@@ -1086,6 +1142,11 @@ auto normalise_logs(Container& logs)
     return norm;
 }
 
+inline double normalise_logs(std::vector<double>& logs)
+{
+    return normalise_logs(logs.data(), logs.size());
+}
+
 template <typename Container>
 auto normalise_exp(Container& logs)
 {
@@ -1094,6 +1155,11 @@ auto normalise_exp(Container& logs)
     return norm;
 }
 
+inline double normalise_exp(std::vector<double>& logs)
+{
+    return normalise_exp(logs.data(), logs.size());
+}
+
 } // namespace maths
 } // namespace octopus
 
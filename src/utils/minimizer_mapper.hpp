@@ -0,0 +1,338 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef minimizer_mapper_hpp
+#define minimizer_mapper_hpp
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+
+#include "kmer_mapper.hpp"
+
+namespace octopus {
+
+/*
+ Sparse seeding for mapping reads to haplotypes.
+
+ A (K, W) minimizer of a sequence is the smallest kmer, by an invertible hash, in a window of W
+ consecutive kmers; every window contributes its minimizer and consecutive duplicates are dropped.
+ Two sequences sharing a window always share its minimizer, so matching minimizers alone usually
+ finds the same best diagonals as matching every kmer, but touches roughly (W + 1) / 2 times fewer kmers.
+ */
+
+struct Minimizer
+{
+    std::uint32_t hash, position;
+};
+
+using MinimizerVector = std::vector<Minimizer>;
+
+namespace detail {
+
+template <unsigned char K>
+constexpr KmerHashType minimizer_mask() noexcept
+{
+    return (KmerHashType {1} << (2 * K)) - 1;
+}
+
+// Multiplying by an odd number is invertible modulo 2^2K, so distinct kmers keep distinct hashes,
+// but the order no longer favours low complexity kmers such as AAAAAA
+template <unsigned char K>
+constexpr KmerHashType minimizer_order(const KmerHashType kmer) noexcept
+{
+    return (kmer * KmerHashType {0x9E3779B1}) & minimizer_mask<K>();
+}
+
+template <unsigned char K, typename Sequence>
+void compute_minimizer_kmers(const Sequence& sequence, const std::size_t first, const std::size_t last,
+                             std::vector<KmerHashType>& result)
+{
+    result.resize(last - first);
+    if (first == last) return;
+    auto base_itr = std::next(std::cbegin(sequence), first);
+    KmerHashType kmer {0};
+    for (unsigned i {0}; i < K - 1; ++i, ++base_itr) {
+        kmer = (kmer << 2) | perfect_hash<KmerHashType>(*base_itr);
+    }
+    for (auto& hash : result) {
+        kmer = ((kmer << 2) | perfect_hash<KmerHashType>(*base_itr++)) & minimizer_mask<K>();
+        hash = minimizer_order<K>(kmer);
+    }
+}
+
+// The position of the leftmost smallest kmer in each window in [first_window, last_window), given
+// the hashes of kmers [first_window, last_window + W - 1)
+template <unsigned char W>
+void append_window_minimizers(const std::vector<KmerHashType>& kmers, const std::size_t first_window,
+                              const std::size_t last_window, MinimizerVector& result)
+{
+    std::size_t min_idx {0};
+    for (std::size_t window {0}; window < last_window - first_window; ++window) {
+        if (window == 0 || min_idx < window) {
+            min_idx = window;
+            for (auto idx = window + 1; idx < window + W; ++idx) {
+                if (kmers[idx] < kmers[min_idx]) min_idx = idx;
+            }
+        } else if (kmers[window + W - 1] < kmers[min_idx]) {
+            min_idx = window + W - 1;
+        }
+        const auto position = static_cast<std::uint32_t>(first_window + min_idx);
+        if (result.empty() || result.back().position < position) {
+            result.push_back({static_cast<std::uint32_t>(kmers[min_idx]), position});
+        }
+    }
+}
+
+} // namespace detail
+
+template <unsigned char K>
+constexpr std::size_t num_minimizer_windows(const std::size_t sequence_size, const unsigned char window_size) noexcept
+{
+    const std::size_t window_length {K + window_size - 1u};
+    return sequence_size >= window_length ? sequence_size - window_length + 1 : 0;
+}
+
+// Sequence can be any random access range of bases, e.g. std::string
+template <unsigned char K, unsigned char W, typename Sequence>
+void compute_minimizers(const Sequence& sequence, MinimizerVector& result)
+{
+    static_assert(K > 0 && K <= 16 && W > 0, "invalid minimizer parameters");
+    result.clear();
+    const auto num_windows = num_minimizer_windows<K>(sequence.size(), W);
+    if (num_windows == 0) return;
+    thread_local std::vector<KmerHashType> kmers {};
+    detail::compute_minimizer_kmers<K>(sequence, 0, num_windows + W - 1, kmers);
+    detail::append_window_minimizers<W>(kmers, 0, num_windows, result);
+}
+
+template <unsigned char K, unsigned char W, typename Sequence>
+MinimizerVector compute_minimizers(const Sequence& sequence)
+{
+    MinimizerVector result {};
+    compute_minimizers<K, W>(sequence, result);
+    return result;
+}
+
+/*
+ MinimizerIndex holds the minimizers of one target sequence (e.g. a haplotype) and maps query
+ minimizers to it.
+
+ Assigning a new target only recomputes minimizers for windows that overlap the part of the
+ sequence that differs from the previous target, which is usually a few alleles when iterating
+ over the haplotypes of an active region.
+ */
+template <unsigned char K, unsigned char W>
+class MinimizerIndex
+{
+public:
+    MinimizerIndex() = default;
+
+    MinimizerIndex(const MinimizerIndex&)            = default;
+    MinimizerIndex& operator=(const MinimizerIndex&) = default;
+    MinimizerIndex(MinimizerIndex&&)                 = default;
+    MinimizerIndex& operator=(MinimizerIndex&&)      = default;
+
+    ~MinimizerIndex() = default;
+
+    void assign(const std::string& target);
+    void clear() noexcept;
+
+    const MinimizerVector& minimizers() const noexcept { return minimizers_; }
+
+    // Writes the start positions in the target with the most query minimizer hits, in ascending
+    // order, like map_query_to_target does for all kmers.
+    template <typename OutputIt>
+    OutputIt map(const MinimizerVector& query, OutputIt result,
+                 std::size_t max_mapping_positions = std::numeric_limits<std::size_t>::max()) const;
+    
+    // As above, but maps every kmer of query_sequence with map_query_to_target instead if the
+    // minimizers do not pick out a single start position with at least minDecisiveHits hits.
+    // Sparse or tied minimizer hits are where the two mappers are most likely to disagree.
+    template <typename OutputIt>
+    OutputIt map(const MinimizerVector& query, const std::string& query_sequence, OutputIt result,
+                 std::size_t max_mapping_positions = std::numeric_limits<std::size_t>::max()) const;
+    
+    static constexpr std::size_t minDecisiveHits {3};
+
+private:
+    struct HitCounts
+    {
+        std::size_t max_hit_count, num_max_hit_positions;
+    };
+    
+    std::string target_;
+    MinimizerVector minimizers_, buffer_, sorted_minimizers_;
+    std::vector<KmerHashType> kmers_;
+    mutable std::vector<std::size_t> mapping_begins_;
+    // Only built for targets that need the dense mapper
+    mutable KmerHashTable target_kmers_;
+    mutable bool has_target_kmers_ = false;
+    mutable MappedIndexCounts mapping_counts_;
+
+    std::uint32_t window_minimizer(const std::string& sequence, std::size_t window);
+    HitCounts count_hits(const MinimizerVector& query) const;
+    template <typename OutputIt>
+    OutputIt write_mapping_positions(std::size_t max_hit_count, OutputIt result, std::size_t max_mapping_positions) const;
+};
+
+template <unsigned char K, unsigned char W>
+constexpr std::size_t MinimizerIndex<K, W>::minDecisiveHits;
+
+template <unsigned char K, unsigned char W>
+void MinimizerIndex<K, W>::assign(const std::string& target)
+{
+    const auto num_windows = num_minimizer_windows<K>(target.size(), W);
+    buffer_.clear();
+    if (num_windows > 0) {
+        const auto max_shared = std::min(target.size(), target_.size());
+        const auto prefix_size = static_cast<std::size_t>(std::distance(std::cbegin(target),
+                                 std::mismatch(std::cbegin(target), std::next(std::cbegin(target), max_shared),
+                                               std::cbegin(target_)).first));
+        const auto suffix_size = static_cast<std::size_t>(std::distance(std::crbegin(target),
+                                 std::mismatch(std::crbegin(target), std::next(std::crbegin(target), max_shared - prefix_size),
+                                               std::crbegin(target_)).first));
+        static constexpr std::size_t window_length {K + W - 1};
+        // Windows [0, first_changed) lie in the shared prefix, and [last_changed, num_windows) in the shared suffix
+        const auto first_changed = prefix_size >= window_length ? prefix_size - window_length + 1 : 0;
+        const auto last_changed = std::max(target.size() - suffix_size, first_changed);
+        // Window minimizers are non-decreasing in window index, so the minimizers of the unchanged
+        // windows are a prefix and a suffix of the old minimizers
+        if (first_changed > 0) {
+            const auto last_prefix_minimizer = window_minimizer(target, first_changed - 1);
+            for (const auto& minimizer : minimizers_) {
+                if (minimizer.position > last_prefix_minimizer) break;
+                buffer_.push_back(minimizer);
+            }
+        }
+        if (first_changed < std::min(last_changed, num_windows)) {
+            const auto last_window = std::min(last_changed, num_windows);
+            detail::compute_minimizer_kmers<K>(target, first_changed, last_window + W - 1, kmers_);
+            detail::append_window_minimizers<W>(kmers_, first_changed, last_window, buffer_);
+        }
+        if (last_changed < num_windows) {
+            const auto first_suffix_minimizer = window_minimizer(target, last_changed);
+            const auto shift = static_cast<std::int64_t>(target.size()) - static_cast<std::int64_t>(target_.size());
+            for (const auto& minimizer : minimizers_) {
+                const auto position = static_cast<std::uint32_t>(minimizer.position + shift);
+                if (minimizer.position + shift >= first_suffix_minimizer
+                    && (buffer_.empty() || buffer_.back().position < position)) {
+                    buffer_.push_back({minimizer.hash, position});
+                }
+            }
+        }
+    }
+    std::swap(minimizers_, buffer_);
+    target_ = target;
+    has_target_kmers_ = false;
+    sorted_minimizers_ = minimizers_;
+    std::sort(std::begin(sorted_minimizers_), std::end(sorted_minimizers_),
+              [] (const Minimizer& lhs, const Minimizer& rhs) {
+                  return lhs.hash < rhs.hash || (lhs.hash == rhs.hash && lhs.position < rhs.position);
+              });
+}
+
+template <unsigned char K, unsigned char W>
+void MinimizerIndex<K, W>::clear() noexcept
+{
+    target_.clear();
+    minimizers_.clear();
+    sorted_minimizers_.clear();
+    target_kmers_ = KmerHashTable {};
+    has_target_kmers_ = false;
+}
+
+template <unsigned char K, unsigned char W>
+template <typename OutputIt>
+OutputIt MinimizerIndex<K, W>::map(const MinimizerVector& query, OutputIt result,
+                                   const std::size_t max_mapping_positions) const
+{
+    const auto hits = count_hits(query);
+    return write_mapping_positions(hits.max_hit_count, result, max_mapping_positions);
+}
+
+template <unsigned char K, unsigned char W>
+template <typename OutputIt>
+OutputIt MinimizerIndex<K, W>::map(const MinimizerVector& query, const std::string& query_sequence, OutputIt result,
+                                   const std::size_t max_mapping_positions) const
+{
+    const auto hits = count_hits(query);
+    if (hits.max_hit_count >= minDecisiveHits && hits.num_max_hit_positions == 1) {
+        return write_mapping_positions(hits.max_hit_count, result, max_mapping_positions);
+    }
+    if (max_mapping_positions == 0) return result;
+    if (!has_target_kmers_) {
+        if (target_kmers_.first.empty()) {
+            target_kmers_ = init_kmer_hash_table<K>();
+        } else {
+            clear_kmer_hash_table(target_kmers_);
+        }
+        populate_kmer_hash_table<K>(target_, target_kmers_);
+        mapping_counts_ = init_mapping_counts(target_kmers_);
+        has_target_kmers_ = true;
+    } else {
+        reset_mapping_counts(mapping_counts_);
+    }
+    return map_query_to_target(compute_kmer_hashes<K>(query_sequence), target_kmers_, mapping_counts_,
+                               result, max_mapping_positions);
+}
+
+template <unsigned char K, unsigned char W>
+typename MinimizerIndex<K, W>::HitCounts MinimizerIndex<K, W>::count_hits(const MinimizerVector& query) const
+{
+    mapping_begins_.clear();
+    const auto hash_less = [] (const Minimizer& lhs, const Minimizer& rhs) { return lhs.hash < rhs.hash; };
+    for (const auto& seed : query) {
+        const auto hits = std::equal_range(std::cbegin(sorted_minimizers_), std::cend(sorted_minimizers_), seed, hash_less);
+        std::for_each(hits.first, hits.second, [&] (const Minimizer& hit) {
+            if (hit.position >= seed.position) {
+                mapping_begins_.push_back(hit.position - seed.position);
+            }
+        });
+    }
+    std::sort(std::begin(mapping_begins_), std::end(mapping_begins_));
+    HitCounts result {0, 0};
+    for (auto itr = std::cbegin(mapping_begins_); itr != std::cend(mapping_begins_);) {
+        const auto run_end = std::upper_bound(itr, std::cend(mapping_begins_), *itr);
+        const auto hit_count = static_cast<std::size_t>(std::distance(itr, run_end));
+        if (hit_count > result.max_hit_count) {
+            result = {hit_count, 1};
+        } else if (hit_count == result.max_hit_count) {
+            ++result.num_max_hit_positions;
+        }
+        itr = run_end;
+    }
+    return result;
+}
+
+template <unsigned char K, unsigned char W>
+template <typename OutputIt>
+OutputIt MinimizerIndex<K, W>::write_mapping_positions(const std::size_t max_hit_count, OutputIt result,
+                                                       std::size_t max_mapping_positions) const
+{
+    if (max_hit_count == 0) return result;
+    for (auto itr = std::cbegin(mapping_begins_); itr != std::cend(mapping_begins_) && max_mapping_positions > 0;) {
+        const auto run_end = std::upper_bound(itr, std::cend(mapping_begins_), *itr);
+        if (static_cast<std::size_t>(std::distance(itr, run_end)) == max_hit_count) {
+            *result++ = *itr;
+            --max_mapping_positions;
+        }
+        itr = run_end;
+    }
+    return result;
+}
+
+template <unsigned char K, unsigned char W>
+std::uint32_t MinimizerIndex<K, W>::window_minimizer(const std::string& sequence, const std::size_t window)
+{
+    detail::compute_minimizer_kmers<K>(sequence, window, window + W, kmers_);
+    return static_cast<std::uint32_t>(window + std::distance(std::cbegin(kmers_), std::min_element(std::cbegin(kmers_), std::cend(kmers_))));
+}
+
+} // namespace octopus
+
+#endif
@@ -0,0 +1,172 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef prefetch_hpp
+#define prefetch_hpp
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+namespace octopus {
+
+/*
+    A fetch queued on an existing executor (e.g. ThreadPool or WorkStealingScheduler) ahead of the
+    value being needed. Whichever of the executor or the consumer starts the fetch first runs it, so a
+    consumer never waits for a fetch that is still queued behind other work: it claims and runs the fetch
+    itself. The consumer only waits if the fetch is already running elsewhere.
+*/
+template <typename T>
+class Prefetch
+{
+public:
+    using Fetcher = std::function<T()>;
+
+    enum class Status { queued, running, done, cancelled };
+
+    Prefetch() = delete;
+
+    template <typename Executor>
+    Prefetch(Fetcher fetch, Executor& executor);
+
+    Prefetch(const Prefetch&)            = delete;
+    Prefetch& operator=(const Prefetch&) = delete;
+    Prefetch(Prefetch&&)                 = default;
+    Prefetch& operator=(Prefetch&& other) noexcept;
+
+    // Cancels the fetch if it is still queued, otherwise waits for it to finish
+    ~Prefetch() noexcept;
+
+    Status status() const noexcept;
+
+    // Returns false if the fetch has already started
+    bool cancel() noexcept;
+
+    // Runs the fetch on the calling thread if it is still queued. Rethrows anything thrown by the fetch.
+    // Must be called at most once, and not after cancel.
+    T get();
+
+private:
+    struct State
+    {
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        Status status;
+        Fetcher fetch;
+        boost::optional<T> value;
+        std::exception_ptr error;
+    };
+
+    std::shared_ptr<State> state_;
+
+    void abandon() noexcept;
+    static bool claim(State& state);
+    static void run(State& state);
+};
+
+template <typename T>
+template <typename Executor>
+Prefetch<T>::Prefetch(Fetcher fetch, Executor& executor)
+: state_ {std::make_shared<State>()}
+{
+    state_->status = Status::queued;
+    state_->fetch = std::move(fetch);
+    auto state = state_;
+    executor.push([state] () { if (claim(*state)) run(*state); });
+}
+
+template <typename T>
+Prefetch<T>& Prefetch<T>::operator=(Prefetch&& other) noexcept
+{
+    if (this != &other) {
+        abandon();
+        state_ = std::move(other.state_);
+    }
+    return *this;
+}
+
+template <typename T>
+Prefetch<T>::~Prefetch() noexcept
+{
+    abandon();
+}
+
+template <typename T>
+typename Prefetch<T>::Status Prefetch<T>::status() const noexcept
+{
+    std::lock_guard<std::mutex> lock {state_->mutex};
+    return state_->status;
+}
+
+template <typename T>
+bool Prefetch<T>::cancel() noexcept
+{
+    std::lock_guard<std::mutex> lock {state_->mutex};
+    if (state_->status == Status::queued) {
+        state_->status = Status::cancelled;
+        state_->fetch = nullptr;
+    }
+    return state_->status == Status::cancelled;
+}
+
+template <typename T>
+T Prefetch<T>::get()
+{
+    if (claim(*state_)) run(*state_);
+    std::unique_lock<std::mutex> lock {state_->mutex};
+    state_->cv.wait(lock, [this] () { return state_->status != Status::running; });
+    if (state_->error) std::rethrow_exception(state_->error);
+    T result {std::move(*state_->value)};
+    state_->value = boost::none;
+    return result;
+}
+
+// private methods
+
+template <typename T>
+void Prefetch<T>::abandon() noexcept
+{
+    // The fetch may refer to objects that are destroyed along with this one
+    if (state_ && !cancel()) {
+        std::unique_lock<std::mutex> lock {state_->mutex};
+        state_->cv.wait(lock, [this] () { return state_->status != Status::running; });
+    }
+}
+
+template <typename T>
+bool Prefetch<T>::claim(State& state)
+{
+    std::lock_guard<std::mutex> lock {state.mutex};
+    if (state.status != Status::queued) return false;
+    state.status = Status::running;
+    return true;
+}
+
+template <typename T>
+void Prefetch<T>::run(State& state)
+{
+    boost::optional<T> value {};
+    std::exception_ptr error {};
+    try {
+        value = state.fetch();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock {state.mutex};
+        state.value = std::move(value);
+        state.error = std::move(error);
+        state.fetch = nullptr;
+        state.status = Status::done;
+    }
+    state.cv.notify_all();
+}
+
+} // namespace octopus
+
+#endif
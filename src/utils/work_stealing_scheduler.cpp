@@ -0,0 +1,235 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "work_stealing_scheduler.hpp"
+
+#include <limits>
+#include <algorithm>
+#include <iterator>
+
+namespace octopus {
+
+namespace {
+
+thread_local WorkStealingScheduler* this_thread_scheduler {nullptr};
+thread_local std::size_t this_thread_worker {std::numeric_limits<std::size_t>::max()};
+thread_local std::uint64_t this_thread_task {0};
+thread_local std::chrono::nanoseconds this_thread_blocked_time {0};
+
+} // namespace
+
+WorkStealingScheduler::Worker::Worker()
+: mutex {}
+, tasks {}
+, thread {}
+, num_tasks_run {0}
+, num_tasks_stolen {0}
+, busy_time {0}
+, idle_time {0}
+{}
+
+WorkStealingScheduler::WorkStealingScheduler() : WorkStealingScheduler {0} {}
+
+WorkStealingScheduler::WorkStealingScheduler(const std::size_t num_workers)
+: workers_ {}
+, mutex_ {}
+, cv_ {}
+, stop_ {false}
+, n_idle_ {0}
+, n_queued_ {0}
+, next_worker_ {0}
+, next_task_id_ {1}
+{
+    workers_.reserve(num_workers);
+    for (std::size_t i {0}; i < num_workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    // All deques must exist before any worker can try to steal from them
+    for (std::size_t i {0}; i < num_workers; ++i) {
+        workers_[i]->thread = std::thread {[this, i] () { run(i); }};
+    }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lk {mutex_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+std::size_t WorkStealingScheduler::size() const noexcept
+{
+    return workers_.size();
+}
+
+bool WorkStealingScheduler::empty() const noexcept
+{
+    return workers_.empty();
+}
+
+std::size_t WorkStealingScheduler::n_idle() const noexcept
+{
+    return n_idle_;
+}
+
+std::size_t WorkStealingScheduler::n_queued() const noexcept
+{
+    return n_queued_;
+}
+
+bool WorkStealingScheduler::is_worker_thread() const noexcept
+{
+    return this_thread_scheduler == this;
+}
+
+WorkStealingScheduler* WorkStealingScheduler::current() noexcept
+{
+    return this_thread_scheduler;
+}
+
+std::vector<WorkStealingScheduler::WorkerStatistics> WorkStealingScheduler::statistics() const
+{
+    std::vector<WorkerStatistics> result {};
+    result.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        result.push_back({worker->num_tasks_run, worker->num_tasks_stolen,
+                          std::chrono::nanoseconds {worker->busy_time.load()},
+                          std::chrono::nanoseconds {worker->idle_time.load()}});
+    }
+    return result;
+}
+
+// private methods
+
+std::size_t WorkStealingScheduler::current_worker() const noexcept
+{
+    return this_thread_worker;
+}
+
+void WorkStealingScheduler::schedule(std::function<void()> function)
+{
+    if (workers_.empty()) {
+        function();
+        return;
+    }
+    const auto worker = is_worker_thread() ? current_worker() : next_worker_++ % workers_.size();
+    // Tasks pushed from outside a task have no parent
+    Task task {std::move(function), next_task_id_++, is_worker_thread() ? this_thread_task : 0};
+    {
+        // Must increment under the lock, otherwise an idle worker may miss the notification
+        std::lock_guard<std::mutex> lk {mutex_};
+        ++n_queued_;
+    }
+    {
+        std::lock_guard<std::mutex> lk {workers_[worker]->mutex};
+        workers_[worker]->tasks.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+bool WorkStealingScheduler::try_pop(const std::size_t worker, Task& task)
+{
+    std::lock_guard<std::mutex> lk {workers_[worker]->mutex};
+    auto& tasks = workers_[worker]->tasks;
+    if (tasks.empty()) return false;
+    task = std::move(tasks.back());
+    tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingScheduler::try_pop_child(const std::size_t worker, Task& task)
+{
+    std::lock_guard<std::mutex> lk {workers_[worker]->mutex};
+    auto& tasks = workers_[worker]->tasks;
+    // Subtasks are pushed after anything else still queued by the parent's ancestors, so search from the back
+    const auto itr = std::find_if(std::rbegin(tasks), std::rend(tasks),
+                                  [] (const Task& queued) { return queued.parent == this_thread_task; });
+    if (itr == std::rend(tasks)) return false;
+    task = std::move(*itr);
+    tasks.erase(std::next(itr).base());
+    return true;
+}
+
+bool WorkStealingScheduler::try_steal(const std::size_t thief, Task& task)
+{
+    for (std::size_t i {1}; i < workers_.size(); ++i) {
+        auto& victim = *workers_[(thief + i) % workers_.size()];
+        std::lock_guard<std::mutex> lk {victim.mutex};
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            ++workers_[thief]->num_tasks_stolen;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingScheduler::execute(const std::size_t worker, Task& task)
+{
+    --n_queued_;
+    // Counted before running so the count is exact once all task futures are ready
+    ++workers_[worker]->num_tasks_run;
+    const auto caller = this_thread_task;
+    this_thread_task = task.id;
+    task.function();
+    this_thread_task = caller;
+}
+
+bool WorkStealingScheduler::try_run_one(const std::size_t worker)
+{
+    Task task {};
+    if (try_pop(worker, task) || try_steal(worker, task)) {
+        execute(worker, task);
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingScheduler::try_run_child(const std::size_t worker)
+{
+    Task task {};
+    if (try_pop_child(worker, task)) {
+        execute(worker, task);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingScheduler::count_blocked_time(const std::size_t worker, const Clock::duration duration) noexcept
+{
+    const auto blocked_time = std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+    workers_[worker]->idle_time += blocked_time.count();
+    this_thread_blocked_time += blocked_time;
+}
+
+void WorkStealingScheduler::run(const std::size_t worker)
+{
+    this_thread_scheduler = this;
+    this_thread_worker = worker;
+    auto& stats = *workers_[worker];
+    while (true) {
+        const auto busy_start = Clock::now();
+        this_thread_blocked_time = std::chrono::nanoseconds {0};
+        while (try_run_one(worker));
+        const auto idle_start = Clock::now();
+        // Time blocked on subtasks running elsewhere has already been counted as idle
+        const auto busy_time = std::chrono::duration_cast<std::chrono::nanoseconds>(idle_start - busy_start) - this_thread_blocked_time;
+        stats.busy_time += busy_time.count();
+        std::unique_lock<std::mutex> lk {mutex_};
+        ++n_idle_;
+        cv_.wait(lk, [this] () { return stop_ || n_queued_ > 0; });
+        --n_idle_;
+        const bool done {stop_ && n_queued_ == 0};
+        lk.unlock();
+        stats.idle_time += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - idle_start).count();
+        if (done) return;
+    }
+}
+
+} // namespace octopus
@@ -0,0 +1,148 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef work_stealing_scheduler_hpp
+#define work_stealing_scheduler_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+
+namespace octopus {
+
+/*
+    Each worker owns a deque of tasks. Workers push and pop tasks from the back of their own deque,
+    and idle workers steal from the front of other workers' deques. Tasks pushed from a worker thread
+    are placed on that worker's deque, so a task that forks itself into subtasks keeps the subtasks local
+    unless another worker is idle and steals them.
+
+    A task waiting on its subtasks only helps run its own subtasks, so tasks nested on a worker's stack
+    are bounded by the fork depth, and otherwise blocks until the subtask completes.
+*/
+class WorkStealingScheduler
+{
+public:
+    // Time a worker spends blocked waiting on a subtask another worker is running is counted as idle
+    struct WorkerStatistics
+    {
+        std::size_t num_tasks_run, num_tasks_stolen;
+        std::chrono::nanoseconds busy_time, idle_time;
+    };
+
+    WorkStealingScheduler();
+    explicit WorkStealingScheduler(std::size_t num_workers);
+
+    WorkStealingScheduler(const WorkStealingScheduler&)             = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&)  = delete;
+    WorkStealingScheduler(WorkStealingScheduler&& other) noexcept   = delete;
+    WorkStealingScheduler& operator=(WorkStealingScheduler&& other) = delete;
+
+    ~WorkStealingScheduler() noexcept;
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t n_idle() const noexcept;
+    std::size_t n_queued() const noexcept;
+
+    // true if the calling thread is one of this scheduler's workers
+    bool is_worker_thread() const noexcept;
+
+    // The scheduler the calling thread is a worker of, or nullptr if it is not a worker thread.
+    // Lets code running inside a task fork work onto the same workers without being given the scheduler.
+    static WorkStealingScheduler* current() noexcept;
+
+    template <typename F, typename... Args>
+    auto push(F&& f, Args&&... args) -> std::future<std::result_of_t<F(Args...)>>;
+
+    // Waits for the future to become ready. If called from a task then the future must be of a subtask
+    // pushed by that task; the worker runs the task's queued subtasks while it waits, so forked subtasks
+    // cannot deadlock.
+    template <typename R>
+    R wait(std::future<R>& result);
+
+    std::vector<WorkerStatistics> statistics() const;
+
+private:
+    using TaskId = std::uint64_t;
+    using Clock  = std::chrono::steady_clock;
+
+    struct Task
+    {
+        std::function<void()> function;
+        TaskId id, parent;
+    };
+
+    struct Worker
+    {
+        mutable std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+        std::atomic<std::size_t> num_tasks_run, num_tasks_stolen;
+        std::atomic<std::chrono::nanoseconds::rep> busy_time, idle_time;
+
+        Worker();
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> stop_;
+    std::atomic<std::size_t> n_idle_, n_queued_, next_worker_;
+    std::atomic<TaskId> next_task_id_;
+
+    void schedule(std::function<void()> function);
+    bool try_pop(std::size_t worker, Task& task);
+    bool try_pop_child(std::size_t worker, Task& task);
+    bool try_steal(std::size_t thief, Task& task);
+    void execute(std::size_t worker, Task& task);
+    bool try_run_one(std::size_t worker);
+    bool try_run_child(std::size_t worker);
+    void count_blocked_time(std::size_t worker, Clock::duration duration) noexcept;
+    void run(std::size_t worker);
+    std::size_t current_worker() const noexcept;
+};
+
+template <typename F, typename... Args>
+auto WorkStealingScheduler::push(F&& f, Args&&... args) -> std::future<std::result_of_t<F(Args...)>>
+{
+    using f_result_type = std::result_of_t<F(Args...)>;
+    if (stop_) throw std::runtime_error {"WorkStealingScheduler: calling push on stopped scheduler"};
+    auto task = std::make_shared<std::packaged_task<f_result_type()>>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    auto result = task->get_future();
+    schedule([task] () { (*task)(); });
+    return result;
+}
+
+template <typename R>
+R WorkStealingScheduler::wait(std::future<R>& result)
+{
+    using namespace std::chrono_literals;
+    if (is_worker_thread()) {
+        const auto worker = current_worker();
+        while (result.wait_for(0s) != std::future_status::ready) {
+            if (!try_run_child(worker)) {
+                // Subtasks are only queued on the pushing worker's deque, so any remaining are running elsewhere
+                const auto block_start = Clock::now();
+                result.wait();
+                count_blocked_time(worker, Clock::now() - block_start);
+            }
+        }
+    }
+    return result.get();
+}
+
+} // namespace octopus
+
+#endif
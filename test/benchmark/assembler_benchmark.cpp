@@ -0,0 +1,111 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include "core/tools/vargen/utils/assembler.hpp"
+#include "benchmark_utils.hpp"
+
+using octopus::coretools::Assembler;
+
+namespace {
+
+struct Bin
+{
+    std::string reference;
+    std::vector<std::string> reads;
+    std::vector<Assembler::BaseQualityVector> base_qualities;
+};
+
+// A random reference with some tandem repeats, and reads from two haplotypes carrying SNVs and indels
+Bin simulate_bin(std::mt19937& generator, const unsigned reference_length, const unsigned depth, const unsigned read_length)
+{
+    const std::string bases {"ACGT"};
+    Bin result {};
+    while (result.reference.size() < reference_length) {
+        if (generator() % 20 == 0) {
+            const auto unit = result.reference.substr(result.reference.size() - std::min<std::size_t>(result.reference.size(), 1 + generator() % 4));
+            for (unsigned i {0}, n = 2 + generator() % 6; i < n; ++i) result.reference += unit;
+        } else {
+            result.reference += bases[generator() % 4];
+        }
+    }
+    result.reference.resize(reference_length);
+    auto alt = result.reference;
+    for (unsigned i {0}; i < reference_length / 100; ++i) {
+        const auto pos = 20 + generator() % (alt.size() - 40);
+        switch (generator() % 3) {
+            case 0: alt[pos] = bases[(bases.find(alt[pos]) + 1 + generator() % 3) % 4]; break;
+            case 1: alt.erase(pos, 1 + generator() % 10); break;
+            default: alt.insert(pos, std::string(1 + generator() % 10, bases[generator() % 4]));
+        }
+    }
+    const auto num_reads = depth * reference_length / read_length;
+    for (unsigned i {0}; i < num_reads; ++i) {
+        const auto& haplotype = i % 2 == 0 ? result.reference : alt;
+        auto read = haplotype.substr(generator() % (haplotype.size() - read_length), read_length);
+        Assembler::BaseQualityVector qualities(read.size(), 30);
+        for (unsigned j {0}; j < read.size(); ++j) {
+            if (generator() % 200 == 0) read[j] = bases[generator() % 4];
+            if (generator() % 2000 == 0) read[j] = 'N';
+            if (generator() % 50 == 0) qualities[j] = 5;
+        }
+        result.reads.push_back(std::move(read));
+        result.base_qualities.push_back(std::move(qualities));
+    }
+    return result;
+}
+
+// Mirrors LocalReassembler::try_assemble_region
+std::deque<Assembler::Variant> assemble(const Bin& bin, const unsigned kmer_size)
+{
+    Assembler assembler {{kmer_size, 0.01}, bin.reference};
+    for (std::size_t i {0}; i < bin.reads.size(); ++i) {
+        assembler.insert_read(bin.reads[i], bin.base_qualities[i], i % 3 == 0 ? Assembler::Direction::reverse : Assembler::Direction::forward);
+    }
+    if (!assembler.is_unique_reference()) return {};
+    assembler.try_recover_dangling_branches();
+    assembler.prune(2);
+    if (!assembler.is_acyclic()) {
+        assembler.remove_nonreference_cycles();
+    }
+    assembler.cleanup();
+    if (assembler.is_empty() || assembler.is_all_reference()) return {};
+    return assembler.extract_variants(50, 2.0);
+}
+
+} // namespace
+
+// Times assembling simulated bins at the default and fallback kmer sizes
+int main()
+{
+    constexpr unsigned num_bins {20}, reference_length {600}, depth {60}, read_length {150};
+    std::mt19937 generator {42};
+    std::vector<Bin> bins {};
+    for (unsigned i {0}; i < num_bins; ++i) {
+        bins.push_back(simulate_bin(generator, reference_length, depth, read_length));
+    }
+    std::cout << "Assembling " << num_bins << " bins of " << reference_length << "bp at " << depth << "x" << '\n';
+    for (const unsigned kmer_size : {10u, 25u, 35u, 45u, 65u}) {
+        std::size_t num_variants {0}, checksum {0};
+        const auto time = benchmark<std::chrono::microseconds>([&] () {
+            num_variants = 0; checksum = 0;
+            for (const auto& bin : bins) {
+                for (const auto& variant : assemble(bin, kmer_size)) {
+                    ++num_variants;
+                    checksum = checksum * 31 + std::hash<std::string> {}(variant.ref + '>' + variant.alt) + variant.begin_pos;
+                }
+            }
+        }, 5);
+        std::cout << "k=" << kmer_size << ": " << time.count() << "us, "
+                  << num_variants << " variants (checksum " << checksum << ")" << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/constant_mixture_genotype_likelihood_model.hpp"
+#include "utils/maths.hpp"
+#include "mock/mock_reference.hpp"
+#include "benchmark_utils.hpp"
+
+using namespace octopus;
+
+// Compares evaluating every genotype one read at a time, one genotype at a time, and all genotypes together
+int main()
+{
+    constexpr unsigned num_haplotypes {12};
+    constexpr std::size_t num_reads {1000};
+    const auto reference = test::mock::make_reference();
+    const GenomicRegion region {"1", 0, 20};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> haplotypes {};
+    for (unsigned h {0}; h < num_haplotypes; ++h) {
+        Haplotype::Builder builder {region, reference};
+        for (GenomicRegion::Position i {0}; i < 20; ++i) {
+            if ((h >> i) & 1u) builder.push_back(Allele {GenomicRegion {"1", i, i + 1}, reference_sequence[i] == 'A' ? "C" : "A"});
+        }
+        haplotypes.push_back(builder.build());
+    }
+    const std::string sample {"sample"};
+    HaplotypeLikelihoodArray likelihoods {num_haplotypes, {sample}};
+    std::mt19937 generator {42};
+    std::uniform_real_distribution<> dist {-30.0, -0.01};
+    for (const auto& haplotype : haplotypes) {
+        std::vector<HaplotypeLikelihoodArray::LogProbability> read_likelihoods(num_reads);
+        for (auto& likelihood : read_likelihoods) likelihood = dist(generator);
+        likelihoods.insert(sample, haplotype, std::move(read_likelihoods));
+    }
+    likelihoods.prime(sample);
+    const model::ConstantMixtureGenotypeLikelihoodModel likelihood_model {likelihoods, haplotypes};
+    std::cout << "Evaluated " << num_reads << " reads and " << num_haplotypes << " haplotypes" << '\n';
+    for (const unsigned ploidy : {2u, 3u, 4u}) {
+        const auto genotypes = generate_all_genotype_indices(num_haplotypes, ploidy);
+        double read_by_read_total {0}, genotype_total {0}, batch_total {0};
+        std::vector<double> buffer(ploidy);
+        const auto read_by_read_time = benchmark<std::chrono::microseconds>([&] () {
+            std::vector<const HaplotypeLikelihoodArray::LikelihoodVector*> genotype_likelihoods(ploidy);
+            for (const auto& genotype : genotypes) {
+                for (unsigned k {0}; k < ploidy; ++k) genotype_likelihoods[k] = &likelihoods[haplotypes[genotype[k]]];
+                for (std::size_t read {0}; read < num_reads; ++read) {
+                    for (unsigned k {0}; k < ploidy; ++k) buffer[k] = (*genotype_likelihoods[k])[read];
+                    read_by_read_total += maths::log_sum_exp(std::cbegin(buffer), std::cend(buffer)) - std::log(ploidy);
+                }
+            }
+        }, 5);
+        const auto genotype_time = benchmark<std::chrono::microseconds>([&] () {
+            for (const auto& genotype : genotypes) genotype_total += likelihood_model.evaluate(genotype);
+        }, 5);
+        const auto batch_time = benchmark<std::chrono::microseconds>([&] () {
+            for (const auto likelihood : likelihood_model.evaluate(genotypes)) batch_total += likelihood;
+        }, 5);
+        const auto per_genotype = [&] (auto time) { return 1000.0 * time.count() / genotypes.size(); };
+        std::cout << "Ploidy " << ploidy << " (" << genotypes.size() << " genotypes): "
+                  << "read by read " << per_genotype(read_by_read_time) << "ns/genotype, "
+                  << "by genotype " << per_genotype(genotype_time) << "ns/genotype, "
+                  << "batched " << per_genotype(batch_time) << "ns/genotype" << '\n';
+        if (std::abs(genotype_total - batch_total) > 1e-6 * std::abs(batch_total)
+            || std::abs(read_by_read_total - batch_total) > 1e-6 * std::abs(batch_total)) {
+            std::cout << "Likelihoods differ!" << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <random>
+#include <chrono>
+#include <cstdint>
+
+#include "core/models/pairhmm/simd_pair_hmm_factory.hpp"
+#include "benchmark_utils.hpp"
+
+using namespace octopus::hmm::simd;
+
+// Compares scoring many reads against one haplotype one read at a time and with the inter-read HMM
+int main()
+{
+    constexpr int band_size {8}, read_length {150}, num_reads {4096};
+    constexpr int truth_size {read_length + 2 * band_size - 1};
+    std::mt19937 generator {42};
+    const std::string bases {"ACGT"};
+    std::string truth {};
+    for (int i {0}; i < truth_size; ++i) truth += bases[generator() % 4];
+    std::vector<std::string> reads(num_reads, truth.substr(band_size, read_length));
+    for (auto& read : reads) {
+        read[generator() % read_length] = bases[generator() % 4];
+        read[generator() % read_length] = bases[generator() % 4];
+    }
+    const std::vector<std::int8_t> qualities(read_length, 30), snv_priors(truth_size, 40), gap_open(truth_size, 40), gap_extend(truth_size, 3);
+    const std::vector<char> snv_mask(std::cbegin(truth), std::cend(truth));
+    const auto hmm = make_simd_pair_hmm<band_size>();
+    const InterReadSimdPairHMM inter_read_hmm {};
+    constexpr int num_lanes {InterReadSimdPairHMM::num_lanes};
+
+    int intra_read_score {0}, inter_read_score {0};
+    const auto intra_read_time = benchmark<std::chrono::microseconds>([&] () {
+        for (const auto& read : reads) {
+            intra_read_score += hmm.align(truth.data(), read.data(), qualities.data(), truth_size, read_length,
+                                          snv_mask.data(), snv_priors.data(), gap_open.data(), gap_extend.data(), 2);
+        }
+    }, 20);
+    const auto inter_read_time = benchmark<std::chrono::microseconds>([&] () {
+        std::array<const char*, num_lanes> truths, targets, snv_masks;
+        std::array<const std::int8_t*, num_lanes> target_qualities, priors, gap_opens, gap_extends;
+        truths.fill(truth.data()); snv_masks.fill(snv_mask.data());
+        target_qualities.fill(qualities.data()); priors.fill(snv_priors.data());
+        gap_opens.fill(gap_open.data()); gap_extends.fill(gap_extend.data());
+        std::array<int, num_lanes> scores;
+        for (int i {0}; i < num_reads; i += num_lanes) {
+            for (int j {0}; j < num_lanes; ++j) targets[j] = reads[i + j].data();
+            inter_read_hmm.align(truths.data(), targets.data(), target_qualities.data(), read_length,
+                                 snv_masks.data(), priors.data(), gap_opens.data(), gap_extends.data(),
+                                 2, band_size, num_lanes, scores.data());
+            for (auto score : scores) inter_read_score += score;
+        }
+    }, 20);
+    std::cout << "Scored " << num_reads << " reads of length " << read_length << " with band size " << band_size << '\n';
+    std::cout << "Intra-read " << hmm.name() << ": " << intra_read_time.count() << "us" << '\n';
+    std::cout << "Inter-read " << InterReadSimdPairHMM::name() << " (" << num_lanes << " lanes): " << inter_read_time.count() << "us" << '\n';
+    if (intra_read_score != inter_read_score) {
+        std::cout << "Scores differ!" << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstddef>
+
+#include "ranger/ForestProbability.h"
+#include "core/csr/filters/compiled_random_forest.hpp"
+#include "benchmark_utils.hpp"
+
+using namespace octopus::csr;
+
+namespace {
+
+constexpr std::size_t num_features {20};
+
+std::vector<double> make_features(const std::size_t num_records, std::mt19937& generator)
+{
+    std::normal_distribution<> feature_distribution {};
+    std::vector<double> result(num_records * num_features);
+    for (auto& value : result) value = feature_distribution(generator);
+    return result;
+}
+
+bool is_true(const double* features)
+{
+    return features[0] + features[1] * features[2] - features[3] > 0;
+}
+
+// Prediction data needs the dependent column too, so it is filled with 0
+void write_data(const std::string& path, const std::vector<double>& features, const bool label)
+{
+    std::ofstream file {path};
+    for (std::size_t f {0}; f < num_features; ++f) file << "f" << f << ' ';
+    file << "TP\n";
+    file.precision(17);
+    for (std::size_t record {0}; record < features.size() / num_features; ++record) {
+        const auto record_features = features.data() + record * num_features;
+        for (std::size_t f {0}; f < num_features; ++f) file << record_features[f] << ' ';
+        file << (label && is_true(record_features)) << '\n';
+    }
+}
+
+void init(ranger::ForestProbability& forest, const std::string& data_path, const std::string& prefix,
+          const std::string& forest_path = "")
+{
+    std::vector<std::string> always_split_variables {}, unordered_variables {};
+    forest.initCpp(forest_path.empty() ? "TP" : "", ranger::MemoryMode::MEM_DOUBLE, data_path, 0, prefix, 200, nullptr, 42, 1,
+                   forest_path, ranger::ImportanceMode::IMP_NONE, 1, "", always_split_variables, "", true, unordered_variables,
+                   false, ranger::SplitRule::LOGRANK, "", false, 1.0, ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
+                   ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS, ranger::DEFAULT_MAXDEPTH);
+}
+
+} // namespace
+
+// Compares predicting a block of records with ranger's node trees and with the compiled forest
+int main()
+{
+    constexpr std::size_t num_training_records {5'000}, num_records {10'000};
+    std::mt19937 generator {42};
+    write_data("octopus_random_forest_benchmark.train.dat", make_features(num_training_records, generator), true);
+    {
+        ranger::ForestProbability forest {};
+        init(forest, "octopus_random_forest_benchmark.train.dat", "octopus_random_forest_benchmark");
+        forest.run(false, false);
+        forest.saveToFile();
+    }
+    const auto features = make_features(num_records, generator);
+    write_data("octopus_random_forest_benchmark.predict.dat", features, false);
+    ranger::ForestProbability ranger_forest {};
+    init(ranger_forest, "octopus_random_forest_benchmark.predict.dat", "octopus_random_forest_benchmark",
+         "octopus_random_forest_benchmark.forest");
+    ranger::ForestProbability forest {};
+    forest.loadForPrediction("octopus_random_forest_benchmark.forest");
+    const std::size_t false_class_idx {forest.getClassValues().front() == 1 ? 1u : 0u};
+    const CompiledRandomForest compiled_forest {forest, false_class_idx};
+
+    std::vector<double> ranger_predictions {}, compiled_predictions {};
+    // Only ranger's prediction is timed, not reading its input file
+    const auto ranger_time = benchmark<std::chrono::microseconds>([&] () {
+        ranger_forest.run(false, false);
+        ranger_predictions.clear();
+        for (const auto& record_predictions : ranger_forest.getPredictions().front()) {
+            ranger_predictions.push_back(record_predictions[false_class_idx]);
+        }
+    }, 10);
+    const auto compiled_time = benchmark<std::chrono::microseconds>([&] () {
+        compiled_predictions = compiled_forest.predict(features);
+    }, 10);
+    std::cout << "Predicted " << num_records << " records with " << compiled_forest.num_trees() << " trees" << '\n';
+    std::cout << "ranger: " << ranger_time.count() << "us" << '\n';
+    std::cout << "compiled: " << compiled_time.count() << "us" << '\n';
+    if (ranger_predictions != compiled_predictions) {
+        std::cout << "Predictions differ!" << '\n';
+        return 1;
+    }
+    return 0;
+}
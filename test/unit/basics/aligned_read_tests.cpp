@@ -4,6 +4,9 @@
 #include <boost/test/unit_test.hpp>
 
 #include <utility>
+#include <vector>
+#include <string>
+#include <thread>
 
 #include "basics/genomic_region.hpp"
 #include "basics/cigar_string.hpp"
@@ -53,6 +56,77 @@ BOOST_AUTO_TEST_CASE(can_be_moved)
     BOOST_REQUIRE_NO_THROW(read2 = std::move(read1));
 }
 
+BOOST_AUTO_TEST_CASE(flags_are_preserved)
+{
+    std::vector<AlignedRead::Flags> flags(10, AlignedRead::Flags {});
+    flags[0].multiple_segment_template = true;
+    flags[1].all_segments_in_read_aligned = true;
+    flags[2].unmapped = true;
+    flags[3].reverse_mapped = true;
+    flags[4].secondary_alignment = true;
+    flags[5].qc_fail = true;
+    flags[6].duplicate = true;
+    flags[7].supplementary_alignment = true;
+    flags[8].first_template_segment = true;
+    flags[9].last_template_segment = true;
+    flags.push_back({true, true, true, true, true, true, true, true, true, true});
+    flags.push_back({true, false, true, false, true, false, true, false, true, false});
+    flags.push_back({false, true, false, true, false, true, false, true, false, true});
+    for (std::size_t i {0}; i < flags.size(); ++i) {
+        const AlignedRead read {
+            "test", GenomicRegion {"1", 0, 4}, "ACGT", AlignedRead::BaseQualityVector {1, 2, 3, 4},
+            parse_cigar("4M"), 10, flags[i], "", ""
+        };
+        BOOST_CHECK_MESSAGE(read.flags() == flags[i], "flags " << i << " not preserved");
+        BOOST_CHECK_MESSAGE(copy(read, GenomicRegion {"1", 1, 3}).flags() == flags[i], "flags " << i << " not copied");
+        BOOST_CHECK_EQUAL(read.is_marked_multiple_segment_template(), flags[i].multiple_segment_template);
+        BOOST_CHECK_EQUAL(read.is_marked_all_segments_in_read_aligned(), flags[i].all_segments_in_read_aligned);
+        BOOST_CHECK_EQUAL(read.is_marked_unmapped(), flags[i].unmapped);
+        BOOST_CHECK_EQUAL(read.is_marked_reverse_mapped(), flags[i].reverse_mapped);
+        BOOST_CHECK_EQUAL(read.is_marked_secondary_alignment(), flags[i].secondary_alignment);
+        BOOST_CHECK_EQUAL(read.is_marked_qc_fail(), flags[i].qc_fail);
+        BOOST_CHECK_EQUAL(read.is_marked_duplicate(), flags[i].duplicate);
+        BOOST_CHECK_EQUAL(read.is_marked_supplementary_alignment(), flags[i].supplementary_alignment);
+        BOOST_CHECK_EQUAL(read.is_marked_first_template_segment(), flags[i].first_template_segment);
+        BOOST_CHECK_EQUAL(read.is_marked_last_template_segment(), flags[i].last_template_segment);
+    }
+}
+
+AlignedRead make_mock_read(std::string read_group)
+{
+    return AlignedRead {
+        "test", GenomicRegion {"1", 0, 4}, "ACGT", AlignedRead::BaseQualityVector {1, 2, 3, 4},
+        parse_cigar("4M"), 10, AlignedRead::Flags {}, std::move(read_group), ""
+    };
+}
+
+BOOST_AUTO_TEST_CASE(read_groups_are_preserved)
+{
+    BOOST_CHECK(AlignedRead {}.read_group().empty());
+    BOOST_CHECK(make_mock_read().read_group().empty());
+    const std::string read_group1 {"a.read.group.with.a.long.name"}, read_group2 {"a.read.group.with.another.long.name"};
+    std::vector<AlignedRead> reads {};
+    for (int i {0}; i < 10; ++i) {
+        reads.push_back(make_mock_read(i % 3 == 0 ? read_group2 : read_group1));
+    }
+    std::vector<AlignedRead> other_thread_reads {};
+    std::thread other_thread {[&] () {
+        for (int i {0}; i < 10; ++i) {
+            other_thread_reads.push_back(make_mock_read(i % 2 == 0 ? read_group2 : read_group1));
+        }
+    }};
+    other_thread.join();
+    for (int i {0}; i < 10; ++i) {
+        BOOST_CHECK_EQUAL(reads[i].read_group(), i % 3 == 0 ? read_group2 : read_group1);
+        BOOST_CHECK_EQUAL(other_thread_reads[i].read_group(), i % 2 == 0 ? read_group2 : read_group1);
+        BOOST_CHECK_EQUAL(copy(reads[i], GenomicRegion {"1", 1, 3}).read_group(), reads[i].read_group());
+    }
+    BOOST_CHECK_EQUAL(reads[0], other_thread_reads[0]);
+    BOOST_CHECK(!(reads[0] == reads[1]));
+    // Reads with the same read group share its storage
+    BOOST_CHECK_EQUAL(&reads[1].read_group(), &other_thread_reads[1].read_group());
+}
+
 BOOST_AUTO_TEST_CASE(can_copy_read_subregions)
 {
     const AlignedRead read {
@@ -0,0 +1,111 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <random>
+#include <cstddef>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "ranger/ForestProbability.h"
+#include "core/csr/filters/compiled_random_forest.hpp"
+
+namespace octopus { namespace test {
+
+using csr::CompiledRandomForest;
+
+namespace {
+
+constexpr std::size_t num_features {5};
+
+std::vector<double> make_features(const std::size_t num_records, std::mt19937& generator)
+{
+    std::normal_distribution<> feature_distribution {};
+    std::vector<double> result(num_records * num_features);
+    for (auto& value : result) value = feature_distribution(generator);
+    return result;
+}
+
+bool is_true(const double* features)
+{
+    return features[0] + features[1] * features[2] - features[3] > 0;
+}
+
+// Writes records in ranger's input format. Prediction data needs the dependent column too, so it is filled with 0
+void write_data(const std::string& path, const std::vector<double>& features, const bool label)
+{
+    std::ofstream file {path};
+    for (std::size_t f {0}; f < num_features; ++f) file << "f" << f << ' ';
+    file << "TP\n";
+    file.precision(17);
+    for (std::size_t record {0}; record < features.size() / num_features; ++record) {
+        const auto record_features = features.data() + record * num_features;
+        for (std::size_t f {0}; f < num_features; ++f) file << record_features[f] << ' ';
+        file << (label && is_true(record_features)) << '\n';
+    }
+}
+
+// Grows a forest from the data, or predicts the data with a saved forest, whose dependent variable name is loaded
+void init(ranger::ForestProbability& forest, const std::string& data_path, const std::string& prefix,
+          const std::string& forest_path = "")
+{
+    std::vector<std::string> always_split_variables {}, unordered_variables {};
+    forest.initCpp(forest_path.empty() ? "TP" : "", ranger::MemoryMode::MEM_DOUBLE, data_path, 0, prefix, 50, nullptr, 42, 1, forest_path,
+                   ranger::ImportanceMode::IMP_NONE, 1, "", always_split_variables, "", true, unordered_variables, false,
+                   ranger::SplitRule::LOGRANK, "", false, 1.0, ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
+                   ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS, ranger::DEFAULT_MAXDEPTH);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(compiled_random_forest)
+
+BOOST_AUTO_TEST_CASE(predictions_match_ranger)
+{
+    const auto prefix = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    const auto training_path = prefix.string() + ".train.dat", prediction_path = prefix.string() + ".predict.dat";
+    const auto forest_path = prefix.string() + ".forest";
+    std::mt19937 generator {42};
+    write_data(training_path, make_features(500, generator), true);
+    {
+        ranger::ForestProbability forest {};
+        init(forest, training_path, prefix.string());
+        forest.run(false, false);
+        forest.saveToFile();
+    }
+    const auto features = make_features(1000, generator);
+    write_data(prediction_path, features, false);
+    ranger::ForestProbability ranger_forest {};
+    init(ranger_forest, prediction_path, prefix.string(), forest_path);
+    ranger_forest.run(false, false);
+    const auto& ranger_predictions = ranger_forest.getPredictions().front();
+    ranger::ForestProbability saved_forest {};
+    saved_forest.loadForPrediction(forest_path);
+    BOOST_REQUIRE_EQUAL(saved_forest.getClassValues().size(), 2);
+    for (std::size_t class_idx {0}; class_idx < 2; ++class_idx) {
+        const CompiledRandomForest compiled_forest {saved_forest, class_idx};
+        BOOST_REQUIRE_EQUAL(compiled_forest.num_features(), num_features);
+        BOOST_REQUIRE_EQUAL(compiled_forest.num_trees(), 50);
+        const auto compiled_predictions = compiled_forest.predict(features);
+        BOOST_REQUIRE_EQUAL(compiled_predictions.size(), ranger_predictions.size());
+        for (std::size_t record {0}; record < compiled_predictions.size(); ++record) {
+            BOOST_CHECK_EQUAL(compiled_predictions[record], ranger_predictions[record][class_idx]);
+        }
+    }
+    for (const auto& path : {training_path, prediction_path, forest_path}) {
+        boost::filesystem::remove(path);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,149 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+#include <boost/variant.hpp>
+#include <boost/optional.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "basics/cigar_string.hpp"
+#include "io/variant/vcf_record.hpp"
+#include "core/csr/measures/measure.hpp"
+#include "core/csr/measures/depth.hpp"
+#include "core/csr/measures/quality.hpp"
+#include "core/csr/measures/quality_by_depth.hpp"
+#include "core/csr/measures/posterior_probability_by_depth.hpp"
+#include "core/csr/facets/samples.hpp"
+#include "core/csr/facets/overlapping_reads.hpp"
+
+namespace octopus { namespace test {
+
+using csr::Measure;
+using csr::MeasureWrapper;
+using csr::make_wrapped_measure;
+using csr::Depth;
+using csr::Quality;
+using csr::QualityByDepth;
+using csr::PosteriorProbabilityByDepth;
+
+namespace {
+
+const std::vector<SampleName> samples {"A", "B"};
+
+// Calls at positions 0, 10, 20, ... with varied depths, including zero depths, and a missing PP in every third
+std::vector<VcfRecord> make_calls(const std::size_t num_calls)
+{
+    std::vector<VcfRecord> result {};
+    result.reserve(num_calls);
+    for (std::size_t i {0}; i < num_calls; ++i) {
+        VcfRecord::Builder call {};
+        call.set_chrom("1").set_pos(10 * i).set_ref("A").set_alt("C").set_qual(static_cast<double>(10 + 7 * i));
+        call.set_info("DP", (i % 4) * (i + 1));
+        if (i % 3 == 0) {
+            call.set_info_missing("PP");
+        } else {
+            call.set_info("PP", std::to_string(0.5 * i));
+        }
+        call.set_format({"DP"});
+        call.set_format(samples[0], "DP", (i % 4) * i);
+        call.set_format(samples[1], "DP", i % 4);
+        result.push_back(call.build_once());
+    }
+    return result;
+}
+
+AlignedRead make_read(const GenomicRegion::Position begin)
+{
+    return AlignedRead {
+        "read", GenomicRegion {"1", begin, begin + 4}, "ACGT", AlignedRead::BaseQualityVector {30, 30, 30, 30},
+        parse_cigar("4M"), 60, AlignedRead::Flags {}, "", "",
+        "1", 100, 30, AlignedRead::Segment::Flags {}
+    };
+}
+
+Measure::FacetMap make_facets(const std::size_t num_calls)
+{
+    ReadMap reads {};
+    for (const auto& sample : samples) {
+        std::vector<AlignedRead> sample_reads {};
+        for (std::size_t i {0}; i < num_calls; ++i) {
+            for (std::size_t j {0}; j < i % 3; ++j) {
+                sample_reads.push_back(make_read(10 * i));
+            }
+        }
+        reads[sample] = ReadContainer {std::begin(sample_reads), std::end(sample_reads)};
+    }
+    Measure::FacetMap result {};
+    result.emplace("Samples", csr::FacetWrapper {std::make_unique<csr::Samples>(samples)});
+    result.emplace("OverlappingReads", csr::FacetWrapper {std::make_unique<csr::OverlappingReads>(std::move(reads))});
+    return result;
+}
+
+// The column evaluated over the block must be the same as evaluating each call alone
+template <typename T>
+void check_column_matches_calls(const MeasureWrapper& measure, const std::vector<VcfRecord>& calls,
+                                const Measure::FacetMap& facets)
+{
+    std::vector<std::vector<Measure::ResultType>> rows(calls.size());
+    csr::append_to_rows(measure(calls, facets), rows);
+    for (std::size_t i {0}; i < calls.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(rows[i].size(), 1);
+        BOOST_CHECK_MESSAGE(boost::get<T>(rows[i].front()) == boost::get<T>(measure(calls[i], facets)),
+                            measure.name() << " column differs for call " << i);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(measure_columns)
+
+BOOST_AUTO_TEST_CASE(depth_column_matches_per_call_evaluation)
+{
+    const auto calls = make_calls(50);
+    const auto facets = make_facets(calls.size());
+    check_column_matches_calls<std::size_t>(make_wrapped_measure<Depth>(false, true), calls, facets);
+    check_column_matches_calls<std::size_t>(make_wrapped_measure<Depth>(true, true), calls, facets);
+    check_column_matches_calls<std::vector<std::size_t>>(make_wrapped_measure<Depth>(false, false), calls, facets);
+    check_column_matches_calls<std::vector<std::size_t>>(make_wrapped_measure<Depth>(true, false), calls, facets);
+}
+
+BOOST_AUTO_TEST_CASE(quality_by_depth_column_matches_per_call_evaluation)
+{
+    const auto calls = make_calls(50);
+    const auto facets = make_facets(calls.size());
+    check_column_matches_calls<boost::optional<double>>(make_wrapped_measure<QualityByDepth>(false), calls, facets);
+    check_column_matches_calls<boost::optional<double>>(make_wrapped_measure<QualityByDepth>(true), calls, facets);
+}
+
+BOOST_AUTO_TEST_CASE(posterior_probability_by_depth_column_matches_per_call_evaluation)
+{
+    const auto calls = make_calls(50);
+    const auto facets = make_facets(calls.size());
+    check_column_matches_calls<boost::optional<double>>(make_wrapped_measure<PosteriorProbabilityByDepth>(false), calls, facets);
+    check_column_matches_calls<boost::optional<double>>(make_wrapped_measure<PosteriorProbabilityByDepth>(true), calls, facets);
+}
+
+BOOST_AUTO_TEST_CASE(quality_column_matches_per_call_evaluation)
+{
+    auto calls = make_calls(10);
+    calls.push_back(VcfRecord::Builder().set_chrom("1").set_pos(100).set_ref("A").set_alt("C").build_once());
+    const auto facets = make_facets(calls.size());
+    check_column_matches_calls<boost::optional<double>>(make_wrapped_measure<Quality>(), calls, facets);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,115 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+
+#include <boost/optional.hpp>
+#include <boost/variant.hpp>
+#include <boost/any.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include "core/csr/filters/measure_store.hpp"
+
+namespace octopus { namespace test {
+
+using csr::MeasureStore;
+
+namespace {
+
+MeasureStore::ValueVector make_measures(const std::size_t record_idx)
+{
+    const auto x = static_cast<double>(record_idx);
+    MeasureStore::ValueVector result {};
+    result.emplace_back(x / 3);
+    result.emplace_back(record_idx % 3 == 0 ? boost::optional<double> {} : boost::optional<double> {x});
+    result.emplace_back(std::vector<boost::optional<int>> {static_cast<int>(record_idx), boost::none});
+    result.emplace_back(std::vector<std::size_t>(record_idx % 5, record_idx));
+    result.emplace_back(record_idx % 2 == 0);
+    result.emplace_back(std::vector<bool> {true, record_idx % 2 == 0});
+    result.emplace_back(record_idx % 4 == 0 ? boost::optional<std::vector<int>> {} : std::vector<int> {1, 2, 3});
+    return result;
+}
+
+struct MeasureEqualVisitor : public boost::static_visitor<bool>
+{
+    template <typename T, typename U> bool operator()(const T&, const U&) const noexcept { return false; }
+    template <typename T> bool operator()(const T& lhs, const T& rhs) const { return lhs == rhs; }
+    bool operator()(const boost::any&, const boost::any&) const noexcept { return false; }
+};
+
+bool are_equal(const MeasureStore::ValueType& lhs, const MeasureStore::ValueType& rhs)
+{
+    return boost::apply_visitor(MeasureEqualVisitor {}, lhs, rhs);
+}
+
+bool are_equal(const MeasureStore::ValueVector& lhs, const MeasureStore::ValueVector& rhs)
+{
+    return lhs.size() == rhs.size()
+           && std::equal(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs),
+                         [] (const auto& a, const auto& b) { return are_equal(a, b); });
+}
+
+void check_round_trip(const MeasureStore& store, const std::size_t num_records)
+{
+    BOOST_REQUIRE_EQUAL(store.size(), num_records);
+    auto reader = store.reader();
+    for (std::size_t record_idx {0}; record_idx < num_records; ++record_idx) {
+        const auto expected = make_measures(record_idx);
+        BOOST_REQUIRE(are_equal(reader.read(), expected));
+        for (std::size_t measure_idx {0}; measure_idx < expected.size(); ++measure_idx) {
+            BOOST_REQUIRE(are_equal(store.get(record_idx, measure_idx), expected[measure_idx]));
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(measure_store)
+
+BOOST_AUTO_TEST_CASE(measures_are_read_back_as_stored)
+{
+    const std::size_t num_records {1'000};
+    MeasureStore store {make_measures(0).size()};
+    for (std::size_t record_idx {0}; record_idx < num_records; ++record_idx) {
+        store.push_back(make_measures(record_idx));
+    }
+    store.finalise();
+    check_round_trip(store, num_records);
+}
+
+BOOST_AUTO_TEST_CASE(file_backed_measures_are_read_back_as_stored)
+{
+    const std::size_t num_records {100'000};
+    const auto prefix = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    std::vector<boost::filesystem::path> files {};
+    {
+        MeasureStore store {make_measures(0).size(), prefix};
+        for (std::size_t record_idx {0}; record_idx < num_records; ++record_idx) {
+            store.push_back(make_measures(record_idx));
+        }
+        store.finalise();
+        check_round_trip(store, num_records);
+        for (std::size_t measure_idx {0}; measure_idx < store.num_measures(); ++measure_idx) {
+            files.emplace_back(prefix.string() + "." + std::to_string(measure_idx) + ".bin");
+            BOOST_CHECK(boost::filesystem::exists(files.back()));
+        }
+    }
+    for (const auto& file : files) {
+        BOOST_CHECK(!boost::filesystem::exists(file));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
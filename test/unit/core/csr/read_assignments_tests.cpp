@@ -0,0 +1,166 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <functional>
+
+#include <boost/variant.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "basics/cigar_string.hpp"
+#include "containers/mappable_flat_set.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/csr/facets/facet.hpp"
+#include "core/csr/facets/read_assignments.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+using csr::Facet;
+using csr::ReadAssignments;
+
+namespace {
+
+const SampleName sample {"A"};
+const GenomicRegion::Position snv_position {120};
+
+auto alt_base(const ReferenceGenome& reference, const GenomicRegion::Position position)
+{
+    return reference.fetch_sequence(GenomicRegion {"1", position, position + 1}) == "A" ? "C" : "A";
+}
+
+AlignedRead make_read(const ReferenceGenome& reference, const GenomicRegion::Position begin, const bool has_snv)
+{
+    const GenomicRegion region {"1", begin, begin + 10};
+    auto sequence = reference.fetch_sequence(region);
+    if (has_snv) sequence.replace(snv_position - begin, 1, alt_base(reference, snv_position));
+    return AlignedRead {
+        "read" + std::to_string(begin), region, std::move(sequence), AlignedRead::BaseQualityVector(10, 30),
+        parse_cigar("10M"), 60, AlignedRead::Flags {}, "", "",
+        "1", 100, 30, AlignedRead::Segment::Flags {}
+    };
+}
+
+Haplotype make_haplotype(const ReferenceGenome& reference, const GenomicRegion& region, const std::vector<GenomicRegion::Position>& snvs)
+{
+    Haplotype::Builder builder {region, reference};
+    for (const auto position : snvs) {
+        builder.push_back(Allele {GenomicRegion {"1", position, position + 1}, alt_base(reference, position)});
+    }
+    return builder.build();
+}
+
+// A heterozygous SNV call, with reads of each allele, and saved likelihoods that disagree with the reads
+struct HeterozygousCallFixture
+{
+    HeterozygousCallFixture()
+    : reference {mock::make_reference()}
+    , call_region {"1", 115, 125}
+    , saved_region {"1", 100, 140}
+    , reference_haplotype {call_region, reference}
+    , alt_haplotype {make_haplotype(reference, call_region, {snv_position})}
+    , genotypes {}
+    , reads {}
+    {
+        Genotype<Haplotype> genotype {2};
+        genotype.emplace(reference_haplotype);
+        genotype.emplace(alt_haplotype);
+        genotypes[sample] = MappableFlatSet<Genotype<Haplotype>> {genotype};
+        std::vector<AlignedRead> sample_reads {};
+        for (GenomicRegion::Position begin {112}; begin < 118; ++begin) {
+            sample_reads.push_back(make_read(reference, begin, begin % 2 == 1));
+        }
+        reads[sample] = ReadContainer {std::begin(sample_reads), std::end(sample_reads)};
+    }
+
+    // All reads are saved as supporting the reference
+    SavedHaplotypeLikelihoods save_reference_support(const std::vector<std::vector<GenomicRegion::Position>>& alt_snvs) const
+    {
+        SavedHaplotypeLikelihoods result {saved_region, {}};
+        auto& sample_likelihoods = result.samples[sample];
+        const auto& sample_reads = reads.at(sample);
+        sample_likelihoods.reads.assign(std::cbegin(sample_reads), std::cend(sample_reads));
+        sample_likelihoods.likelihoods.emplace(Haplotype {saved_region, reference}, HaplotypeLikelihoodArray::LikelihoodVector(sample_reads.size(), 0.0));
+        for (const auto& snvs : alt_snvs) {
+            sample_likelihoods.likelihoods.emplace(make_haplotype(reference, saved_region, snvs),
+                                                   HaplotypeLikelihoodArray::LikelihoodVector(sample_reads.size(), -10.0));
+        }
+        return result;
+    }
+
+    ReferenceGenome reference;
+    GenomicRegion call_region, saved_region;
+    Haplotype reference_haplotype, alt_haplotype;
+    Facet::GenotypeMap genotypes;
+    ReadMap reads;
+};
+
+const Facet::SupportMaps& get_assignments(const ReadAssignments& facet)
+{
+    return boost::get<std::reference_wrapper<const Facet::SupportMaps>>(facet.get());
+}
+
+std::size_t count_support(const ReadAssignments& facet, const Haplotype& haplotype)
+{
+    return get_assignments(facet).support.at(sample).at(haplotype).size();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(read_assignments)
+
+BOOST_AUTO_TEST_CASE(reads_are_assigned_with_saved_likelihoods_when_a_single_saved_haplotype_contains_each_genotype_haplotype)
+{
+    HeterozygousCallFixture fixture {};
+    const ReadAssignments computed {fixture.reference, fixture.genotypes, fixture.reads, HaplotypeLikelihoodModel {}};
+    BOOST_REQUIRE_GT(count_support(computed, fixture.alt_haplotype), 0);
+    const std::vector<SavedHaplotypeLikelihoods> saved {fixture.save_reference_support({{snv_position}})};
+    const ReadAssignments reused {fixture.reference, fixture.genotypes, fixture.reads, saved, HaplotypeLikelihoodModel {}};
+    BOOST_CHECK_EQUAL(count_support(reused, fixture.alt_haplotype), 0);
+    BOOST_CHECK_EQUAL(count_support(reused, fixture.reference_haplotype), fixture.reads.at(sample).size());
+}
+
+BOOST_AUTO_TEST_CASE(reads_are_assigned_with_the_model_when_several_saved_haplotypes_contain_a_genotype_haplotype)
+{
+    HeterozygousCallFixture fixture {};
+    const ReadAssignments computed {fixture.reference, fixture.genotypes, fixture.reads, HaplotypeLikelihoodModel {}};
+    // Both saved alt haplotypes contain the called alt haplotype as they differ only outside the call region
+    const std::vector<SavedHaplotypeLikelihoods> saved {fixture.save_reference_support({{snv_position}, {104, snv_position}})};
+    const ReadAssignments reused {fixture.reference, fixture.genotypes, fixture.reads, saved, HaplotypeLikelihoodModel {}};
+    for (const auto& haplotype : {fixture.reference_haplotype, fixture.alt_haplotype}) {
+        const auto& expected = get_assignments(computed).support.at(sample).at(haplotype);
+        const auto& actual = get_assignments(reused).support.at(sample).at(haplotype);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(actual), std::cend(actual), std::cbegin(expected), std::cend(expected));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reads_are_assigned_with_the_model_when_saved_likelihoods_do_not_cover_the_reads)
+{
+    HeterozygousCallFixture fixture {};
+    const ReadAssignments computed {fixture.reference, fixture.genotypes, fixture.reads, HaplotypeLikelihoodModel {}};
+    auto unsaved_reads = fixture.reads;
+    unsaved_reads[sample].emplace(make_read(fixture.reference, 119, true));
+    const std::vector<SavedHaplotypeLikelihoods> saved {fixture.save_reference_support({{snv_position}})};
+    const ReadAssignments reused {fixture.reference, fixture.genotypes, unsaved_reads, saved, HaplotypeLikelihoodModel {}};
+    BOOST_CHECK_GT(count_support(reused, fixture.alt_haplotype), count_support(computed, fixture.alt_haplotype));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
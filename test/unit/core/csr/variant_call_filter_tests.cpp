@@ -0,0 +1,131 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstddef>
+#include <memory>
+
+#include <boost/optional.hpp>
+#include <boost/filesystem.hpp>
+
+#include "config/common.hpp"
+#include "config/octopus_vcf.hpp"
+#include "io/variant/vcf_header.hpp"
+#include "io/variant/vcf_record.hpp"
+#include "io/variant/vcf_reader.hpp"
+#include "io/variant/vcf_writer.hpp"
+#include "core/csr/facets/facet_factory.hpp"
+#include "core/csr/measures/measure.hpp"
+#include "core/csr/measures/quality.hpp"
+#include "core/csr/measures/genotype_quality.hpp"
+#include "core/csr/filters/variant_call_filter.hpp"
+#include "core/csr/filters/threshold_filter.hpp"
+
+namespace octopus { namespace test {
+
+using csr::make_wrapped_measure;
+using csr::make_wrapped_threshold;
+using csr::ThresholdVariantCallFilter;
+
+namespace {
+
+namespace fs = boost::filesystem;
+
+const std::vector<SampleName> samples {"A", "B"};
+
+VcfHeader make_calling_header()
+{
+    auto result = vcf::make_header_template();
+    result.add_contig("1").set_samples(samples);
+    return result.build_once();
+}
+
+// Calls with increasing QUAL and varied GQs, some of which are close enough to be filtered in the same block
+std::deque<VcfRecord> make_calls(const std::size_t num_calls)
+{
+    std::deque<VcfRecord> result {};
+    for (std::size_t i {0}; i < num_calls; ++i) {
+        VcfRecord::Builder call {};
+        call.set_chrom("1").set_pos(100 * (i / 3) + 10 * (i % 3)).set_ref("A").set_alt("C");
+        call.set_qual(static_cast<double>(5 + 7 * i));
+        call.set_format({"GT", "GQ"});
+        for (std::size_t s {0}; s < samples.size(); ++s) {
+            call.set_genotype(samples[s], std::vector<boost::optional<unsigned>> {0u, 1u}, VcfRecord::Builder::Phasing::unphased);
+            call.set_format(samples[s], "GQ", (i * (s + 3)) % 40);
+        }
+        result.push_back(call.build_once());
+    }
+    return result;
+}
+
+std::unique_ptr<const csr::VariantCallFilter> make_filter(const VcfHeader& header)
+{
+    ThresholdVariantCallFilter::ConditionVectorPair conditions {};
+    conditions.hard.push_back({make_wrapped_measure<csr::Quality>(), make_wrapped_threshold<csr::LessThreshold<>>(10.0)});
+    conditions.soft.push_back({make_wrapped_measure<csr::Quality>(), make_wrapped_threshold<csr::LessThreshold<>>(50.0), "q50"});
+    conditions.soft.push_back({make_wrapped_measure<csr::GenotypeQuality>(), make_wrapped_threshold<csr::LessThreshold<>>(20.0), "GQ20"});
+    return std::make_unique<ThresholdVariantCallFilter>(csr::FacetFactory {header}, std::move(conditions),
+                                                        csr::VariantCallFilter::OutputOptions {},
+                                                        csr::VariantCallFilter::ConcurrencyPolicy {1});
+}
+
+template <typename Container>
+void write(const VcfHeader& header, const Container& calls, const fs::path& path)
+{
+    VcfWriter writer {path};
+    writer << header;
+    for (const auto& call : calls) writer << call;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(variant_call_filter)
+
+BOOST_AUTO_TEST_CASE(in_memory_filtering_gives_the_same_records_as_two_pass_filtering)
+{
+    const auto calling_header = make_calling_header();
+    const auto calls = make_calls(30);
+    const auto directory = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directory(directory);
+    const auto unfiltered_path = directory / "unfiltered.vcf";
+    const auto two_pass_path = directory / "two_pass.vcf";
+    const auto in_memory_path = directory / "in_memory.vcf";
+    write(calling_header, calls, unfiltered_path);
+    {
+        const auto filter = make_filter(calling_header);
+        VcfReader source {unfiltered_path};
+        VcfWriter dest {two_pass_path};
+        filter->filter(source, dest);
+    }
+    {
+        const auto filter = make_filter(calling_header);
+        BOOST_REQUIRE(filter->can_filter_in_memory());
+        const auto output_header = filter->make_header(calling_header);
+        write(output_header, filter->filter(calls, ReadMap {}, output_header), in_memory_path);
+    }
+    const VcfReader two_pass {two_pass_path}, in_memory {in_memory_path};
+    BOOST_CHECK_EQUAL(two_pass.fetch_header(), in_memory.fetch_header());
+    const auto two_pass_calls = two_pass.fetch_records();
+    const auto in_memory_calls = in_memory.fetch_records();
+    BOOST_CHECK(!two_pass_calls.empty());
+    BOOST_CHECK_LT(two_pass_calls.size(), calls.size());
+    BOOST_REQUIRE_EQUAL(in_memory_calls.size(), two_pass_calls.size());
+    for (std::size_t i {0}; i < two_pass_calls.size(); ++i) {
+        BOOST_CHECK_MESSAGE(in_memory_calls[i] == two_pass_calls[i],
+                            "call " << i << " differs: " << in_memory_calls[i] << " vs " << two_pass_calls[i]);
+    }
+    fs::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,118 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/constant_mixture_genotype_likelihood_model.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+using model::ConstantMixtureGenotypeLikelihoodModel;
+
+namespace {
+
+std::vector<Haplotype> make_haplotypes(const ReferenceGenome& reference, const unsigned num_haplotypes)
+{
+    const GenomicRegion region {"1", 0, 20};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> result {};
+    for (unsigned h {0}; h < num_haplotypes; ++h) {
+        Haplotype::Builder builder {region, reference};
+        for (GenomicRegion::Position i {0}; i < 20; ++i) {
+            if ((h >> i) & 1u) {
+                builder.push_back(Allele {GenomicRegion {"1", i, i + 1}, reference_sequence[i] == 'A' ? "C" : "A"});
+            }
+        }
+        result.push_back(builder.build());
+    }
+    return result;
+}
+
+HaplotypeLikelihoodArray
+make_likelihoods(const std::vector<Haplotype>& haplotypes, const std::string& sample, const std::size_t num_reads)
+{
+    HaplotypeLikelihoodArray result {static_cast<unsigned>(haplotypes.size()), {sample}};
+    std::mt19937 generator {13};
+    std::uniform_real_distribution<> dist {-30.0, -0.01};
+    for (const auto& haplotype : haplotypes) {
+        std::vector<HaplotypeLikelihoodArray::LogProbability> likelihoods(num_reads);
+        for (auto& likelihood : likelihoods) likelihood = dist(generator);
+        result.insert(sample, haplotype, std::move(likelihoods));
+    }
+    result.prime(sample);
+    return result;
+}
+
+// ln p(reads | genotype) computed read by read
+double evaluate_naive(const GenotypeIndex& genotype, const std::vector<Haplotype>& haplotypes,
+                      const HaplotypeLikelihoodArray& likelihoods)
+{
+    double result {0};
+    const auto num_reads = likelihoods[haplotypes.front()].size();
+    for (std::size_t read {0}; read < num_reads; ++read) {
+        double sum {0};
+        for (const auto h : genotype) sum += std::exp(likelihoods[haplotypes[h]][read]);
+        result += std::log(sum / genotype.size());
+    }
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+BOOST_AUTO_TEST_SUITE(constant_mixture_genotype_likelihood_model)
+
+BOOST_AUTO_TEST_CASE(all_evaluation_methods_agree_with_naive_evaluation)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference, 5);
+    // More reads than one batch block, and not a multiple of any SIMD width
+    const auto likelihoods = make_likelihoods(haplotypes, "sample", 601);
+    const ConstantMixtureGenotypeLikelihoodModel model {likelihoods, haplotypes};
+    for (const unsigned ploidy : {1u, 2u, 3u, 4u, 5u, 6u}) {
+        const auto genotypes = generate_all_genotype_indices(static_cast<unsigned>(haplotypes.size()), ploidy);
+        const auto batch_likelihoods = model.evaluate(genotypes);
+        BOOST_REQUIRE_EQUAL(batch_likelihoods.size(), genotypes.size());
+        for (std::size_t g {0}; g < genotypes.size(); ++g) {
+            const auto expected = evaluate_naive(genotypes[g], haplotypes, likelihoods);
+            BOOST_CHECK_CLOSE(model.evaluate(genotypes[g]), expected, 1e-9);
+            BOOST_CHECK_CLOSE(batch_likelihoods[g], expected, 1e-9);
+            Genotype<Haplotype> genotype {ploidy};
+            for (const auto h : genotypes[g]) genotype.emplace(haplotypes[h]);
+            BOOST_CHECK_CLOSE(model.evaluate(genotype), expected, 1e-9);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unsorted_genotype_indices_are_evaluated_as_mixtures)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference, 3);
+    const auto likelihoods = make_likelihoods(haplotypes, "sample", 50);
+    const ConstantMixtureGenotypeLikelihoodModel model {likelihoods, haplotypes};
+    const GenotypeIndex sorted {0, 0, 1, 2}, unsorted {0, 2, 1, 0};
+    BOOST_CHECK_CLOSE(model.evaluate(unsorted), model.evaluate(sorted), 1e-12);
+    BOOST_CHECK_EQUAL(model.evaluate(GenotypeIndex {}), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
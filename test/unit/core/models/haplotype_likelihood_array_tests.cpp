@@ -0,0 +1,275 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "basics/cigar_string.hpp"
+#include "containers/mappable_block.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "utils/kmer_mapper.hpp"
+#include "utils/minimizer_mapper.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+const SampleName sample {"A"};
+
+AlignedRead make_read(const ReferenceGenome& reference, const GenomicRegion::Position begin, const std::string& name)
+{
+    const GenomicRegion region {"1", begin, begin + 10};
+    return AlignedRead {
+        name, region, reference.fetch_sequence(region), AlignedRead::BaseQualityVector(10, 30),
+        parse_cigar("10M"), 60, AlignedRead::Flags {}, "", "",
+        "1", 100, 30, AlignedRead::Segment::Flags {}
+    };
+}
+
+Haplotype make_haplotype(const ReferenceGenome& reference, const GenomicRegion& region, const std::vector<GenomicRegion::Position>& snvs)
+{
+    Haplotype::Builder builder {region, reference};
+    for (const auto position : snvs) {
+        const GenomicRegion snv_region {"1", position, position + 1};
+        builder.push_back(Allele {snv_region, reference.fetch_sequence(snv_region) == "A" ? "C" : "A"});
+    }
+    return builder.build();
+}
+
+// Reads at 100, 105, ..., 130 with likelihoods that differ for each haplotype and read
+struct SavedLikelihoodsFixture
+{
+    SavedLikelihoodsFixture()
+    : reference {mock::make_reference()}
+    , region {"1", 100, 140}
+    , reference_haplotype {region, reference}
+    , alt_haplotype {make_haplotype(reference, region, {120})}
+    , other_alt_haplotype {make_haplotype(reference, region, {104, 120})}
+    , reads {}
+    , likelihoods {3, {sample}}
+    {
+        std::vector<AlignedRead> sample_reads {};
+        for (GenomicRegion::Position begin {100}; begin <= 130; begin += 5) {
+            sample_reads.push_back(make_read(reference, begin, "read" + std::to_string(begin)));
+        }
+        reads[sample] = ReadContainer {std::begin(sample_reads), std::end(sample_reads)};
+        const auto num_reads = reads[sample].size();
+        std::vector<double> reference_likelihoods(num_reads), alt_likelihoods(num_reads), other_alt_likelihoods(num_reads);
+        for (std::size_t i {0}; i < num_reads; ++i) {
+            reference_likelihoods[i] = -1.0 * i;
+            alt_likelihoods[i] = -2.0 * i;
+            other_alt_likelihoods[i] = -3.0 * i;
+        }
+        likelihoods.insert(sample, reference_haplotype, reference_likelihoods);
+        likelihoods.insert(sample, alt_haplotype, alt_likelihoods);
+        likelihoods.insert(sample, other_alt_haplotype, other_alt_likelihoods);
+    }
+
+    std::vector<AlignedRead> overlapping_reads(const GenomicRegion& query) const
+    {
+        const auto overlapped = overlap_range(reads.at(sample), query);
+        return {std::cbegin(overlapped), std::cend(overlapped)};
+    }
+
+    ReferenceGenome reference;
+    GenomicRegion region;
+    Haplotype reference_haplotype, alt_haplotype, other_alt_haplotype;
+    ReadMap reads;
+    HaplotypeLikelihoodArray likelihoods;
+};
+
+// Haplotypes with an SNV, a deletion, and an insertion near the middle of the region, and the reference
+std::vector<Haplotype> make_simulation_haplotypes(const ReferenceGenome& reference, const GenomicRegion& region)
+{
+    const auto middle = region.begin() + region_size(region) / 2;
+    std::vector<Haplotype> result {Haplotype {region, reference}};
+    const GenomicRegion snv_region {region.contig_name(), middle, middle + 1};
+    const auto snv_base = reference.fetch_sequence(snv_region) == "A" ? "C" : "A";
+    const std::vector<Allele> alleles {
+        Allele {snv_region, snv_base},
+        Allele {GenomicRegion {region.contig_name(), middle - 20, middle - 14}, ""},
+        Allele {GenomicRegion {region.contig_name(), middle + 15, middle + 15}, "TTGCA"}
+    };
+    for (const auto& allele : alleles) {
+        Haplotype::Builder builder {region, reference};
+        builder.push_back(allele);
+        result.push_back(builder.build());
+    }
+    return result;
+}
+
+// Reads sampled from the haplotypes, some with substitution errors and some with a small indel error
+std::vector<AlignedRead> simulate_reads(const GenomicRegion& region, const std::vector<Haplotype>& haplotypes,
+                                        const std::size_t num_reads, std::mt19937& generator)
+{
+    std::vector<AlignedRead> result {};
+    result.reserve(num_reads);
+    for (std::size_t i {0}; i < num_reads; ++i) {
+        const auto& haplotype = haplotypes[generator() % haplotypes.size()].sequence();
+        const auto read_length = 100 + generator() % 50;
+        const auto offset = generator() % (haplotype.size() - read_length);
+        auto sequence = haplotype.substr(offset, read_length);
+        switch (generator() % 3) {
+            case 0: break;
+            case 1:
+            {
+                for (auto& base : sequence) if (generator() % 50 == 0) base = "ACGT"[generator() % 4];
+                break;
+            }
+            default:
+            {
+                const auto position = 10 + generator() % (sequence.size() - 20);
+                if (generator() % 2 == 0) {
+                    sequence.erase(position, 1 + generator() % 4);
+                } else {
+                    sequence.insert(position, std::string(1 + generator() % 4, "ACGT"[generator() % 4]));
+                }
+            }
+        }
+        // Reads must be contained by the haplotypes, which are different lengths
+        const auto size = static_cast<GenomicRegion::Position>(sequence.size());
+        const auto begin = region.begin() + std::min(static_cast<GenomicRegion::Position>(offset), region_size(region) - size);
+        result.emplace_back("read" + std::to_string(i), GenomicRegion {region.contig_name(), begin, begin + size},
+                            sequence, AlignedRead::BaseQualityVector(sequence.size(), 30),
+                            parse_cigar(std::to_string(size) + "M"), 60, AlignedRead::Flags {}, "", "");
+    }
+    std::sort(std::begin(result), std::end(result));
+    return result;
+}
+
+std::vector<std::size_t> dense_mapping_positions(const AlignedRead& read, const Haplotype& haplotype)
+{
+    static constexpr std::size_t maxMappingPositions {10};
+    auto result = map_query_to_target<6>(read.sequence(), haplotype.sequence());
+    if (result.size() > maxMappingPositions) result.resize(maxMappingPositions);
+    return result;
+}
+
+std::vector<std::size_t> minimizer_mapping_positions(const AlignedRead& read, const MinimizerIndex<6, 4>& index)
+{
+    std::vector<std::size_t> result {};
+    index.map(compute_minimizers<6, 4>(read.sequence()), read.sequence(), std::back_inserter(result), 10);
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+BOOST_AUTO_TEST_SUITE(haplotype_likelihood_array)
+
+BOOST_AUTO_TEST_CASE(saved_likelihoods_are_found_for_haplotypes_contained_in_a_saved_haplotype)
+{
+    SavedLikelihoodsFixture fixture {};
+    const auto saved = save_likelihoods(fixture.likelihoods, {fixture.reference_haplotype, fixture.alt_haplotype},
+                                        fixture.reads, fixture.region);
+    const GenomicRegion query_region {"1", 115, 125};
+    const auto query_reads = fixture.overlapping_reads(query_region);
+    BOOST_REQUIRE(!query_reads.empty());
+    const auto alt = make_haplotype(fixture.reference, query_region, {120});
+    const auto alt_likelihoods = find_likelihoods(saved, sample, alt, query_reads);
+    BOOST_REQUIRE(alt_likelihoods);
+    BOOST_REQUIRE_EQUAL(alt_likelihoods->size(), query_reads.size());
+    const auto& all_alt_likelihoods = fixture.likelihoods(sample, fixture.alt_haplotype);
+    const auto& all_reads = fixture.reads.at(sample);
+    for (std::size_t i {0}; i < query_reads.size(); ++i) {
+        const auto read_idx = std::distance(std::cbegin(all_reads), std::lower_bound(std::cbegin(all_reads), std::cend(all_reads), query_reads[i]));
+        BOOST_CHECK_EQUAL((*alt_likelihoods)[i], all_alt_likelihoods[read_idx]);
+    }
+    const Haplotype reference {query_region, fixture.reference};
+    BOOST_CHECK(find_likelihoods(saved, sample, reference, query_reads));
+}
+
+BOOST_AUTO_TEST_CASE(saved_likelihoods_are_not_found_if_several_saved_haplotypes_contain_the_haplotype)
+{
+    SavedLikelihoodsFixture fixture {};
+    const auto saved = save_likelihoods(fixture.likelihoods,
+                                        {fixture.reference_haplotype, fixture.alt_haplotype, fixture.other_alt_haplotype},
+                                        fixture.reads, fixture.region);
+    const GenomicRegion query_region {"1", 115, 125};
+    const auto query_reads = fixture.overlapping_reads(query_region);
+    // Both alt haplotypes have the SNV at 120, and differ only outside of the query region
+    const auto alt = make_haplotype(fixture.reference, query_region, {120});
+    BOOST_REQUIRE(contains(fixture.alt_haplotype, alt));
+    BOOST_REQUIRE(contains(fixture.other_alt_haplotype, alt));
+    BOOST_CHECK(!find_likelihoods(saved, sample, alt, query_reads));
+    // Haplotypes that include the distinguishing SNV are not ambiguous
+    const auto other_alt = make_haplotype(fixture.reference, GenomicRegion {"1", 100, 125}, {104, 120});
+    BOOST_CHECK(find_likelihoods(saved, sample, other_alt, fixture.overlapping_reads(mapped_region(other_alt))));
+}
+
+BOOST_AUTO_TEST_CASE(saved_likelihoods_are_not_found_for_unsaved_reads_or_samples)
+{
+    SavedLikelihoodsFixture fixture {};
+    const auto saved = save_likelihoods(fixture.likelihoods, {fixture.reference_haplotype, fixture.alt_haplotype},
+                                        fixture.reads, fixture.region);
+    const GenomicRegion query_region {"1", 115, 125};
+    const auto alt = make_haplotype(fixture.reference, query_region, {120});
+    auto query_reads = fixture.overlapping_reads(query_region);
+    BOOST_CHECK(!find_likelihoods(saved, "B", alt, query_reads));
+    query_reads.push_back(make_read(fixture.reference, 118, "unsaved"));
+    BOOST_CHECK(!find_likelihoods(saved, sample, alt, query_reads));
+}
+
+// Minimizer seeding maps most reads to the same candidate positions as mapping every kmer. The exceptions
+// are mainly reads spanning an indel, where the minimizers can favour the diagonal on the other side of
+// the indel, and these reads should get near enough the same likelihoods.
+BOOST_AUTO_TEST_CASE(likelihoods_match_dense_mapping_on_simulated_reads)
+{
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {31};
+    // Contig 4 has a long CAG repeat in this region
+    for (const GenomicRegion region : {GenomicRegion {"1", 50, 450}, GenomicRegion {"3", 300, 700}, GenomicRegion {"4", 500, 900}}) {
+        const auto haplotypes = make_simulation_haplotypes(reference, region);
+        const auto sample_reads = simulate_reads(region, haplotypes, 300, generator);
+        ReadMap reads {};
+        reads[sample] = ReadContainer {std::cbegin(sample_reads), std::cend(sample_reads)};
+        HaplotypeLikelihoodArray likelihoods {HaplotypeLikelihoodModel {}, static_cast<unsigned>(haplotypes.size()), {sample}};
+        likelihoods.populate(reads, MappableBlock<Haplotype> {haplotypes});
+        HaplotypeLikelihoodModel model {};
+        MinimizerIndex<6, 4> index {};
+        std::size_t num_different_positions {0};
+        for (const auto& haplotype : haplotypes) {
+            model.reset(haplotype);
+            index.assign(haplotype.sequence());
+            const auto& haplotype_likelihoods = likelihoods(sample, haplotype);
+            BOOST_REQUIRE_EQUAL(haplotype_likelihoods.size(), sample_reads.size());
+            for (std::size_t i {0}; i < sample_reads.size(); ++i) {
+                const auto dense_positions = dense_mapping_positions(sample_reads[i], haplotype);
+                const auto minimizer_positions = minimizer_mapping_positions(sample_reads[i], index);
+                const auto dense_likelihood = model.evaluate(sample_reads[i], dense_positions);
+                if (minimizer_positions == dense_positions) {
+                    BOOST_CHECK_CLOSE(haplotype_likelihoods[i], dense_likelihood, 1e-6);
+                } else {
+                    ++num_different_positions;
+                    BOOST_CHECK(!minimizer_positions.empty());
+                    BOOST_CHECK_SMALL(haplotype_likelihoods[i] - dense_likelihood, 0.01);
+                }
+            }
+        }
+        BOOST_CHECK_LT(num_different_positions, haplotypes.size() * sample_reads.size() / 20);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
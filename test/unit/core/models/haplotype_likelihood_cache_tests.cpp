@@ -1,4 +1,187 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "basics/cigar_string.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/models/haplotype_likelihood_cache.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+BOOST_AUTO_TEST_SUITE(haplotype_likelihood_cache)
+
+namespace {
+
+AlignedRead make_read(std::string name, std::string sequence, GenomicRegion::Position begin = 10)
+{
+    const auto length = static_cast<GenomicRegion::Position>(sequence.size());
+    return AlignedRead {
+        std::move(name), GenomicRegion {"1", begin, begin + length}, std::move(sequence),
+        AlignedRead::BaseQualityVector(length, 30), parse_cigar(std::to_string(length) + "M"),
+        60, AlignedRead::Flags {}, "", ""
+    };
+}
+
+// Distinct reads, since each begins at a different position
+std::vector<AlignedRead> make_reads(std::size_t num_reads, std::size_t length, GenomicRegion::Position first_begin)
+{
+    std::vector<AlignedRead> result {};
+    result.reserve(num_reads);
+    for (std::size_t i {0}; i < num_reads; ++i) {
+        const auto begin = first_begin + static_cast<GenomicRegion::Position>(i);
+        result.push_back(make_read("read" + std::to_string(begin), std::string(length, "ACGT"[i % 4]), begin));
+    }
+    return result;
+}
+
+std::vector<HaplotypeLikelihoodCache::ReadKey> make_keys(HaplotypeLikelihoodCache& cache, const std::vector<AlignedRead>& reads)
+{
+    std::vector<HaplotypeLikelihoodCache::ReadKey> result {};
+    result.reserve(reads.size());
+    for (const auto& read : reads) result.push_back(cache.key(read));
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(cached_likelihoods_are_found_for_the_same_read_and_haplotype)
+{
+    const auto reference = mock::make_reference();
+    const Haplotype haplotype {GenomicRegion {"1", 0, 50}, reference};
+    HaplotypeLikelihoodCache cache {MemoryFootprint {1'000'000}};
+    const auto read = cache.key(make_read("read", "ACGTACGT"));
+    auto& entry = cache.entry(haplotype, boost::none);
+    BOOST_CHECK(!cache.find(entry, read));
+    cache.insert(entry, read, -1.5);
+    auto& same_entry = cache.entry(haplotype, boost::none);
+    const auto likelihood = cache.find(same_entry, read);
+    BOOST_REQUIRE(likelihood);
+    BOOST_CHECK_EQUAL(*likelihood, -1.5);
+    BOOST_CHECK_EQUAL(cache.num_hits(), 1);
+    BOOST_CHECK_EQUAL(cache.num_misses(), 1);
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(read_keys_depend_on_read_content_but_not_name)
+{
+    HaplotypeLikelihoodCache cache {MemoryFootprint {1'000'000}};
+    const auto read = make_read("read1", "ACGTACGT");
+    BOOST_CHECK_EQUAL(cache.key(read), cache.key(make_read("read2", "ACGTACGT")));
+    BOOST_CHECK_NE(cache.key(read), cache.key(make_read("read1", "ACGTACGA")));
+    BOOST_CHECK_NE(cache.key(read), cache.key(make_read("read1", "ACGTACGT", 11)));
+    BOOST_CHECK_EQUAL(cache.key(read), cache.key(read));
+}
+
+BOOST_AUTO_TEST_CASE(likelihoods_are_not_shared_between_flank_states_or_haplotypes)
+{
+    const auto reference = mock::make_reference();
+    const Haplotype haplotype1 {GenomicRegion {"1", 0, 50}, reference};
+    const Haplotype haplotype2 {GenomicRegion {"1", 0, 51}, reference};
+    HaplotypeLikelihoodCache cache {MemoryFootprint {1'000'000}};
+    const auto read = cache.key(make_read("read", "ACGTACGT"));
+    cache.insert(cache.entry(haplotype1, boost::none), read, -1.0);
+    using FlankState = HaplotypeLikelihoodCache::FlankState;
+    BOOST_CHECK(!cache.find(cache.entry(haplotype1, FlankState {0, 5}), read));
+    BOOST_CHECK(!cache.find(cache.entry(haplotype2, boost::none), read));
+    BOOST_CHECK(cache.find(cache.entry(haplotype1, boost::none), read));
+}
+
+BOOST_AUTO_TEST_CASE(least_recently_used_haplotypes_are_evicted_when_the_footprint_is_exceeded)
+{
+    const auto reference = mock::make_reference();
+    const Haplotype haplotype1 {GenomicRegion {"1", 0, 50}, reference};
+    const Haplotype haplotype2 {GenomicRegion {"1", 0, 51}, reference};
+    const Haplotype haplotype3 {GenomicRegion {"1", 0, 52}, reference};
+    HaplotypeLikelihoodCache cache {MemoryFootprint {12'000}};
+    const auto reads = make_keys(cache, make_reads(25, 8, 10));
+    const auto insert_reads = [&] (const Haplotype& haplotype) {
+        auto& entry = cache.entry(haplotype, boost::none);
+        for (const auto read : reads) cache.insert(entry, read, -1.0);
+    };
+    insert_reads(haplotype1);
+    insert_reads(haplotype2);
+    cache.entry(haplotype1, boost::none); // haplotype2 is now least recently used
+    insert_reads(haplotype3);
+    BOOST_CHECK(cache.footprint() <= MemoryFootprint {12'000});
+    BOOST_CHECK_GT(cache.num_evictions(), 0);
+    BOOST_CHECK(!cache.find(cache.entry(haplotype2, boost::none), reads.front()));
+    BOOST_CHECK(cache.find(cache.entry(haplotype3, boost::none), reads.front()));
+}
+
+BOOST_AUTO_TEST_CASE(read_content_is_released_with_the_likelihoods_that_refer_to_it)
+{
+    const auto reference = mock::make_reference();
+    const MemoryFootprint max_footprint {20'000};
+    HaplotypeLikelihoodCache cache {max_footprint};
+    // Each region has new reads, and the reads of all regions together are several times the footprint limit
+    const std::size_t num_regions {20}, num_reads {10}, read_length {100};
+    for (std::size_t region {0}; region < num_regions; ++region) {
+        const auto begin = static_cast<GenomicRegion::Position>(10 * region);
+        const Haplotype haplotype1 {GenomicRegion {"1", begin, begin + 50}, reference};
+        const Haplotype haplotype2 {GenomicRegion {"1", begin, begin + 51}, reference};
+        const auto reads = make_reads(num_reads, read_length, 1000 * begin);
+        const auto keys = make_keys(cache, reads);
+        for (const auto& haplotype : {haplotype1, haplotype2}) {
+            auto& entry = cache.entry(haplotype, boost::none);
+            for (const auto read : keys) cache.insert(entry, read, -1.0);
+            BOOST_CHECK(cache.footprint() <= max_footprint);
+        }
+        // The latest region is always cached in full
+        BOOST_CHECK(make_keys(cache, reads) == keys);
+        for (const auto& haplotype : {haplotype1, haplotype2}) {
+            const auto& entry = cache.entry(haplotype, boost::none);
+            for (const auto read : keys) {
+                BOOST_CHECK(cache.find(entry, read));
+            }
+        }
+    }
+    BOOST_CHECK_GT(cache.num_evictions(), 0);
+    BOOST_CHECK(cache.footprint() <= max_footprint);
+}
+
+BOOST_AUTO_TEST_CASE(read_content_that_alone_exceeds_the_footprint_limit_is_not_kept)
+{
+    const auto reference = mock::make_reference();
+    const Haplotype haplotype1 {GenomicRegion {"1", 0, 50}, reference};
+    const Haplotype haplotype2 {GenomicRegion {"1", 0, 51}, reference};
+    const MemoryFootprint max_footprint {4'000};
+    HaplotypeLikelihoodCache cache {max_footprint};
+    const auto reads = make_reads(50, 100, 10);
+    const auto keys = make_keys(cache, reads);
+    BOOST_CHECK(cache.footprint() > max_footprint);
+    auto& entry = cache.entry(haplotype1, boost::none);
+    for (const auto read : keys) {
+        BOOST_CHECK(!cache.find(entry, read));
+        cache.insert(entry, read, -1.0);
+    }
+    BOOST_CHECK(cache.footprint() <= max_footprint);
+    // The cache still works for the reads of the next region, which do fit
+    const auto small_reads = make_reads(5, 10, 1000);
+    const auto small_keys = make_keys(cache, small_reads);
+    auto& small_entry = cache.entry(haplotype2, boost::none);
+    for (const auto read : small_keys) cache.insert(small_entry, read, -2.0);
+    for (const auto read : small_keys) {
+        const auto likelihood = cache.find(cache.entry(haplotype2, boost::none), read);
+        BOOST_REQUIRE(likelihood);
+        BOOST_CHECK_EQUAL(*likelihood, -2.0);
+    }
+    BOOST_CHECK(cache.footprint() <= max_footprint);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
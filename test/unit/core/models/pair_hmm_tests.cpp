@@ -9,8 +9,10 @@
 #include <algorithm>
 #include <utility>
 #include <iostream>
+#include <random>
 
 #include "core/models/pairhmm/simd_pair_hmm_factory.hpp"
+#include "core/models/pairhmm/simd_pair_hmm_wrapper.hpp"
 
 namespace octopus { namespace test {
 
@@ -757,6 +759,110 @@ BOOST_AUTO_TEST_CASE(sse2_int_band_size_16_speed)
 };
 
 
+template <unsigned BandSize>
+void check_inter_read_pair_hmm_matches_pair_hmm(const unsigned num_batches)
+{
+    SSE2PairHMM<BandSize, short> hmm {};
+    const InterReadSimdPairHMM inter_read_hmm {};
+    constexpr int num_lanes {InterReadSimdPairHMM::num_lanes};
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<int> base_dist {0, 3}, quality_dist {0, 60}, penalty_dist {1, 50};
+    const std::string bases {"ACGT"};
+    for (unsigned batch {0}; batch < num_batches; ++batch) {
+        const int target_size = 1 + generator() % 150;
+        const int truth_size = target_size + 2 * BandSize - 1;
+        const int num_alignments = 1 + generator() % num_lanes;
+        std::vector<std::string> truths(num_alignments), targets(num_alignments), snv_masks(num_alignments);
+        std::vector<std::vector<std::int8_t>> qualities(num_alignments), snv_priors(num_alignments), gap_opens(num_alignments), gap_extends(num_alignments);
+        std::vector<const char*> truth_ptrs {}, target_ptrs {}, snv_mask_ptrs {};
+        std::vector<const std::int8_t*> quality_ptrs {}, snv_prior_ptrs {}, gap_open_ptrs {}, gap_extend_ptrs {};
+        for (int i {0}; i < num_alignments; ++i) {
+            auto& truth = truths[i];
+            for (int j {0}; j < truth_size; ++j) truth += generator() % 20 == 0 ? 'N' : bases[base_dist(generator)];
+            auto& target = targets[i];
+            target = truth.substr(BandSize - 1, target_size);
+            // Add some mismatches and indels
+            for (int j {0}; j < 3; ++j) target[generator() % target_size] = bases[base_dist(generator)];
+            if (generator() % 2 == 0) target.insert(generator() % target_size, std::string(1 + generator() % 4, 'G'));
+            if (generator() % 2 == 0) target.erase(generator() % target_size, 1 + generator() % 4);
+            target.resize(target_size, 'C');
+            for (int j {0}; j < truth_size; ++j) snv_masks[i] += bases[base_dist(generator)];
+            std::generate_n(std::back_inserter(qualities[i]), target_size, [&] () { return quality_dist(generator); });
+            std::generate_n(std::back_inserter(snv_priors[i]), truth_size, [&] () { return quality_dist(generator); });
+            std::generate_n(std::back_inserter(gap_opens[i]), truth_size, [&] () { return penalty_dist(generator); });
+            std::generate_n(std::back_inserter(gap_extends[i]), truth_size, [&] () { return 1 + penalty_dist(generator) / 10; });
+            truth_ptrs.push_back(truth.data());
+            target_ptrs.push_back(target.data());
+            snv_mask_ptrs.push_back(snv_masks[i].data());
+            quality_ptrs.push_back(qualities[i].data());
+            snv_prior_ptrs.push_back(snv_priors[i].data());
+            gap_open_ptrs.push_back(gap_opens[i].data());
+            gap_extend_ptrs.push_back(gap_extends[i].data());
+        }
+        std::vector<int> scores(num_alignments);
+        inter_read_hmm.align(truth_ptrs.data(), target_ptrs.data(), quality_ptrs.data(), target_size,
+                             snv_mask_ptrs.data(), snv_prior_ptrs.data(), gap_open_ptrs.data(), gap_extend_ptrs.data(),
+                             2, BandSize, num_alignments, scores.data());
+        for (int i {0}; i < num_alignments; ++i) {
+            const auto expected_score = hmm.align(truth_ptrs[i], target_ptrs[i], quality_ptrs[i], truth_size, target_size,
+                                                  snv_mask_ptrs[i], snv_prior_ptrs[i], gap_open_ptrs[i], gap_extend_ptrs[i], 2);
+            BOOST_CHECK_EQUAL(scores[i], expected_score);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(inter_read_pair_hmm_band_size_8_scores_match_pair_hmm)
+{
+    check_inter_read_pair_hmm_matches_pair_hmm<8>(500);
+}
+
+BOOST_AUTO_TEST_CASE(inter_read_pair_hmm_band_size_16_scores_match_pair_hmm)
+{
+    check_inter_read_pair_hmm_matches_pair_hmm<16>(500);
+}
+
+BOOST_AUTO_TEST_CASE(inter_read_pair_hmm_handles_partial_batches)
+{
+    const InterReadSimdPairHMM inter_read_hmm {};
+    const auto& test = band8_speed_test;
+    const auto target_size = static_cast<int>(test.query.size());
+    const std::vector<char> snv_mask(test.target.size(), 'N');
+    const std::vector<std::int8_t> snv_priors(test.target.size(), 40), gap_extends(test.target.size(), test.gap_extend);
+    const char* truth {test.target.data()};
+    const char* target {test.query.data()};
+    const char* snv_mask_ptr {snv_mask.data()};
+    const std::int8_t* qualities {test.base_qualities.data()};
+    const std::int8_t* snv_priors_ptr {snv_priors.data()};
+    const std::int8_t* gap_open {test.gap_open.data()};
+    const std::int8_t* gap_extend {gap_extends.data()};
+    int score {-1};
+    inter_read_hmm.align(&truth, &target, &qualities, target_size, &snv_mask_ptr, &snv_priors_ptr, &gap_open, &gap_extend,
+                         test.nuc_prior, 8, 1, &score);
+    BOOST_CHECK_EQUAL(score, band8_speed_expected_alignment.score);
+}
+
+BOOST_AUTO_TEST_CASE(pair_hmm_kernels_agree_for_all_supported_instruction_sets)
+{
+    const auto& test = band8_speed_test;
+    const auto truth_size = static_cast<int>(test.target.size()), target_size = static_cast<int>(test.query.size());
+    const auto default_isa = get_instruction_set();
+    for (const auto isa : {InstructionSet::sse2, InstructionSet::avx2, InstructionSet::avx512}) {
+        if (!is_supported(isa)) continue;
+        set_instruction_set(isa);
+        BOOST_CHECK_EQUAL(get_instruction_set(), isa);
+        for (const auto precision : {ScorePrecision::int16, ScorePrecision::int32}) {
+            const PairHMMWrapper hmm {8, precision};
+            BOOST_CHECK_EQUAL(hmm.band_size(), 8);
+            const auto score = hmm.align(test.target.data(), test.query.data(), test.base_qualities.data(), truth_size, target_size,
+                                         test.gap_open.data(), static_cast<std::int8_t>(test.gap_extend), test.nuc_prior);
+            BOOST_CHECK_EQUAL(score, band8_speed_expected_alignment.score);
+        }
+    }
+    set_instruction_set(default_isa);
+    BOOST_CHECK(is_supported(InstructionSet::sse2));
+    BOOST_CHECK_EQUAL(default_isa, fastest_supported_instruction_set());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
 
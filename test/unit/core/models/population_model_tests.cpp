@@ -0,0 +1,138 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <random>
+#include <array>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "containers/mappable_block.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/uniform_genotype_prior_model.hpp"
+#include "core/models/genotype/uniform_population_prior_model.hpp"
+#include "core/models/genotype/individual_model.hpp"
+#include "core/models/genotype/population_model.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+using model::IndividualModel;
+using model::PopulationModel;
+
+namespace {
+
+MappableBlock<Haplotype> make_haplotypes(const ReferenceGenome& reference, const unsigned num_haplotypes)
+{
+    const GenomicRegion region {"1", 0, 20};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> result {};
+    for (unsigned h {0}; h < num_haplotypes; ++h) {
+        Haplotype::Builder builder {region, reference};
+        for (GenomicRegion::Position i {0}; i < 20; ++i) {
+            if ((h >> i) & 1u) {
+                builder.push_back(Allele {GenomicRegion {"1", i, i + 1}, reference_sequence[i] == 'A' ? "C" : "A"});
+            }
+        }
+        result.push_back(builder.build());
+    }
+    return {std::move(result), region};
+}
+
+// Reads from each sample support one of its two haplotypes, with noisy likelihoods for the others
+void insert_likelihoods(HaplotypeLikelihoodArray& likelihoods, const MappableBlock<Haplotype>& haplotypes,
+                        const std::string& sample, const std::array<std::size_t, 2> sample_haplotypes,
+                        const std::size_t num_reads, std::mt19937& generator)
+{
+    std::vector<std::vector<double>> sample_likelihoods(haplotypes.size(), std::vector<double>(num_reads));
+    std::uniform_real_distribution<> noise {-8.0, -1.0};
+    for (std::size_t read {0}; read < num_reads; ++read) {
+        const auto source = sample_haplotypes[read % 2];
+        for (std::size_t h {0}; h < haplotypes.size(); ++h) {
+            sample_likelihoods[h][read] = h == source ? -0.1 : noise(generator);
+        }
+    }
+    for (std::size_t h {0}; h < haplotypes.size(); ++h) {
+        likelihoods.insert(sample, haplotypes[h], std::move(sample_likelihoods[h]));
+    }
+}
+
+struct PopulationFixture
+{
+    PopulationFixture(const std::size_t num_reads, const unsigned seed)
+    : reference {mock::make_reference()}
+    , haplotypes {make_haplotypes(reference, 4)}
+    , samples {"sample1", "sample2", "sample3"}
+    , likelihoods {static_cast<unsigned>(haplotypes.size()), samples}
+    {
+        std::mt19937 generator {seed};
+        insert_likelihoods(likelihoods, haplotypes, "sample1", {0, 1}, num_reads, generator);
+        insert_likelihoods(likelihoods, haplotypes, "sample2", {0, 2}, num_reads, generator);
+        insert_likelihoods(likelihoods, haplotypes, "sample3", {2, 3}, num_reads, generator);
+    }
+
+    ReferenceGenome reference;
+    MappableBlock<Haplotype> haplotypes;
+    std::vector<SampleName> samples;
+    HaplotypeLikelihoodArray likelihoods;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+BOOST_AUTO_TEST_SUITE(population_model)
+
+BOOST_AUTO_TEST_CASE(individual_model_gives_the_same_posteriors_for_genotype_indices_and_genotypes)
+{
+    PopulationFixture fixture {6, 7};
+    const auto indices = generate_all_genotype_indices(static_cast<unsigned>(fixture.haplotypes.size()), 2);
+    const MappableBlock<Genotype<Haplotype>> genotypes {make_genotypes(fixture.haplotypes, indices), mapped_region(fixture.haplotypes)};
+    UniformGenotypePriorModel prior_model {};
+    IndividualModel model {prior_model};
+    fixture.likelihoods.prime("sample1");
+    const auto genotype_latents = model.evaluate(genotypes, fixture.likelihoods);
+    model.prime(fixture.haplotypes);
+    const auto index_latents = model.evaluate(indices, fixture.likelihoods);
+    BOOST_REQUIRE_EQUAL(index_latents.posteriors.genotype_log_probabilities.size(), genotypes.size());
+    BOOST_CHECK_CLOSE(index_latents.log_evidence, genotype_latents.log_evidence, 1e-6);
+    for (std::size_t i {0}; i < genotypes.size(); ++i) {
+        BOOST_CHECK_CLOSE(index_latents.posteriors.genotype_probabilities[i],
+                          genotype_latents.posteriors.genotype_probabilities[i], 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(population_model_gives_the_same_marginal_posteriors_for_genotype_indices_and_genotypes)
+{
+    PopulationFixture fixture {6, 7};
+    const auto indices = generate_all_genotype_indices(static_cast<unsigned>(fixture.haplotypes.size()), 2);
+    const MappableBlock<Genotype<Haplotype>> genotypes {make_genotypes(fixture.haplotypes, indices), mapped_region(fixture.haplotypes)};
+    UniformPopulationPriorModel prior_model {};
+    const PopulationModel model {prior_model};
+    const auto genotype_latents = model.evaluate(fixture.samples, genotypes, fixture.likelihoods);
+    prior_model.prime(fixture.haplotypes);
+    const auto index_latents = model.evaluate(fixture.samples, indices, fixture.haplotypes, fixture.likelihoods);
+    BOOST_CHECK_CLOSE(index_latents.log_evidence, genotype_latents.log_evidence, 1e-6);
+    const auto& index_posteriors = index_latents.posteriors.marginal_genotype_probabilities;
+    const auto& genotype_posteriors = genotype_latents.posteriors.marginal_genotype_probabilities;
+    BOOST_REQUIRE_EQUAL(index_posteriors.size(), fixture.samples.size());
+    for (std::size_t s {0}; s < fixture.samples.size(); ++s) {
+        BOOST_REQUIRE_EQUAL(index_posteriors[s].size(), genotypes.size());
+        for (std::size_t i {0}; i < genotypes.size(); ++i) {
+            BOOST_CHECK_SMALL(index_posteriors[s][i] - genotype_posteriors[s][i], 1e-9);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,160 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <random>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+#include "basics/genomic_region.hpp"
+#include "containers/mappable_block.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/constant_mixture_genotype_likelihood_model.hpp"
+#include "core/models/genotype/top_genotype_enumeration.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+using model::ConstantMixtureGenotypeLikelihoodModel;
+using model::TopGenotypeEnumerationParameters;
+using model::enumerate_top_genotypes;
+
+namespace {
+
+std::vector<Haplotype> make_haplotypes(const ReferenceGenome& reference, const unsigned num_haplotypes)
+{
+    const GenomicRegion region {"1", 0, 20};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> result {};
+    for (unsigned h {0}; h < num_haplotypes; ++h) {
+        Haplotype::Builder builder {region, reference};
+        for (GenomicRegion::Position i {0}; i < 20; ++i) {
+            if ((h >> i) & 1u) {
+                builder.push_back(Allele {GenomicRegion {"1", i, i + 1}, reference_sequence[i] == 'A' ? "C" : "A"});
+            }
+        }
+        result.push_back(builder.build());
+    }
+    return result;
+}
+
+// Reads mostly support one of the first few haplotypes, with noisy likelihoods for the others
+HaplotypeLikelihoodArray
+make_likelihoods(const std::vector<Haplotype>& haplotypes, const std::string& sample, const std::size_t num_reads,
+                 std::mt19937& generator)
+{
+    HaplotypeLikelihoodArray result {static_cast<unsigned>(haplotypes.size()), {sample}};
+    std::vector<std::vector<double>> likelihoods(haplotypes.size(), std::vector<double>(num_reads));
+    std::uniform_real_distribution<> noise {-8.0, -1.0};
+    for (std::size_t read {0}; read < num_reads; ++read) {
+        const auto source = generator() % std::min(haplotypes.size(), std::size_t {3});
+        for (std::size_t h {0}; h < haplotypes.size(); ++h) {
+            likelihoods[h][read] = h == source ? -0.1 : noise(generator);
+        }
+    }
+    for (std::size_t h {0}; h < haplotypes.size(); ++h) {
+        result.insert(sample, haplotypes[h], std::move(likelihoods[h]));
+    }
+    result.prime(sample);
+    return result;
+}
+
+double max_mixture_likelihood(const GenotypeIndex& genotype, const std::vector<Haplotype>& haplotypes,
+                              const HaplotypeLikelihoodArray& likelihoods)
+{
+    double result {0};
+    for (std::size_t read {0}; read < likelihoods[haplotypes.front()].size(); ++read) {
+        double best {-1e300};
+        for (const auto h : genotype) best = std::max(best, likelihoods[haplotypes[h]][read]);
+        result += best;
+    }
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+BOOST_AUTO_TEST_SUITE(top_genotype_enumeration)
+
+BOOST_AUTO_TEST_CASE(top_genotypes_are_the_most_likely_in_decreasing_order)
+{
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {31};
+    for (const unsigned ploidy : {1u, 2u, 4u}) {
+        const auto haplotypes = make_haplotypes(reference, 8);
+        const auto likelihoods = make_likelihoods(haplotypes, "sample", 40, generator);
+        const ConstantMixtureGenotypeLikelihoodModel likelihood_model {likelihoods, haplotypes};
+        std::vector<double> all_likelihoods {};
+        for (const auto& genotype : generate_all_genotype_indices(8, ploidy)) {
+            all_likelihoods.push_back(likelihood_model.evaluate(genotype));
+        }
+        std::sort(std::begin(all_likelihoods), std::end(all_likelihoods), std::greater<> {});
+        TopGenotypeEnumerationParameters params {20};
+        params.max_excluded_likelihood_fraction = 0;
+        const auto top = enumerate_top_genotypes(MappableBlock<Haplotype> {haplotypes}, ploidy, likelihoods, params);
+        BOOST_REQUIRE_EQUAL(top.size(), std::min(all_likelihoods.size(), std::size_t {20}));
+        for (std::size_t i {0}; i < top.size(); ++i) {
+            BOOST_CHECK_EQUAL(top[i].size(), ploidy);
+            BOOST_CHECK(std::is_sorted(std::cbegin(top[i]), std::cend(top[i])));
+            BOOST_CHECK_CLOSE(likelihood_model.evaluate(top[i]), all_likelihoods[i], 1e-6);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(enumeration_stops_when_the_remaining_likelihood_is_negligible)
+{
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {5};
+    const auto haplotypes = make_haplotypes(reference, 12);
+    const auto likelihoods = make_likelihoods(haplotypes, "sample", 200, generator);
+    TopGenotypeEnumerationParameters params {1000};
+    params.max_excluded_likelihood_fraction = 1e-6;
+    const auto top = enumerate_top_genotypes(MappableBlock<Haplotype> {haplotypes}, 6, likelihoods, params);
+    BOOST_CHECK(!top.empty());
+    BOOST_CHECK_LT(top.size(), params.max_genotypes);
+    const ConstantMixtureGenotypeLikelihoodModel likelihood_model {likelihoods, haplotypes};
+    const auto top_likelihood = likelihood_model.evaluate(top.front());
+    for (const auto& genotype : generate_all_genotype_indices(12, 6)) {
+        BOOST_CHECK_LE(likelihood_model.evaluate(genotype), top_likelihood + 1e-9);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(max_zygosity_genotypes_are_ranked_by_best_mixture_likelihood)
+{
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {17};
+    const auto haplotypes = make_haplotypes(reference, 9);
+    const auto likelihoods = make_likelihoods(haplotypes, "sample", 30, generator);
+    std::vector<double> all_scores {};
+    for (const auto& genotype : generate_all_genotype_indices(9, 3)) {
+        if (std::adjacent_find(std::cbegin(genotype), std::cend(genotype)) == std::cend(genotype)) {
+            all_scores.push_back(max_mixture_likelihood(genotype, haplotypes, likelihoods));
+        }
+    }
+    std::sort(std::begin(all_scores), std::end(all_scores), std::greater<> {});
+    TopGenotypeEnumerationParameters params {10};
+    params.max_excluded_likelihood_fraction = 0;
+    params.max_zygosity = true;
+    const auto top = enumerate_top_genotypes(MappableBlock<Haplotype> {haplotypes}, 3, likelihoods, params);
+    BOOST_REQUIRE_EQUAL(top.size(), 10);
+    for (std::size_t i {0}; i < top.size(); ++i) {
+        BOOST_CHECK(std::adjacent_find(std::cbegin(top[i]), std::cend(top[i])) == std::cend(top[i]));
+        BOOST_CHECK_CLOSE(max_mixture_likelihood(top[i], haplotypes, likelihoods), all_scores[i], 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,181 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <random>
+#include <array>
+#include <set>
+#include <tuple>
+#include <numeric>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+
+#include "basics/genomic_region.hpp"
+#include "basics/trio.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/uniform_population_prior_model.hpp"
+#include "core/models/mutation/denovo_model.hpp"
+#include "core/models/genotype/trio_model.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+using model::TrioModel;
+
+namespace {
+
+std::vector<Haplotype> make_haplotypes(const ReferenceGenome& reference, const unsigned num_haplotypes)
+{
+    const GenomicRegion region {"1", 0, 20};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> result {};
+    for (unsigned h {0}; h < num_haplotypes; ++h) {
+        Haplotype::Builder builder {region, reference};
+        for (GenomicRegion::Position i {0}; i < 20; ++i) {
+            if ((h >> i) & 1u) {
+                builder.push_back(Allele {GenomicRegion {"1", i, i + 1}, reference_sequence[i] == 'A' ? "C" : "A"});
+            }
+        }
+        result.push_back(builder.build());
+    }
+    return result;
+}
+
+// Reads from each sample support one of its two haplotypes, with noisy likelihoods for the others
+void insert_likelihoods(HaplotypeLikelihoodArray& likelihoods, const std::vector<Haplotype>& haplotypes,
+                        const std::string& sample, const std::array<std::size_t, 2> sample_haplotypes,
+                        const std::size_t num_reads, std::mt19937& generator)
+{
+    std::vector<std::vector<double>> sample_likelihoods(haplotypes.size(), std::vector<double>(num_reads));
+    std::uniform_real_distribution<> noise {-8.0, -1.0};
+    for (std::size_t read {0}; read < num_reads; ++read) {
+        const auto source = sample_haplotypes[read % 2];
+        for (std::size_t h {0}; h < haplotypes.size(); ++h) {
+            sample_likelihoods[h][read] = h == source ? -0.1 : noise(generator);
+        }
+    }
+    for (std::size_t h {0}; h < haplotypes.size(); ++h) {
+        likelihoods.insert(sample, haplotypes[h], std::move(sample_likelihoods[h]));
+    }
+}
+
+struct TrioFixture
+{
+    TrioFixture(const std::size_t num_reads, const unsigned seed)
+    : reference {mock::make_reference()}
+    , haplotypes {make_haplotypes(reference, 4)}
+    , genotypes {generate_all_genotypes(haplotypes, 2)}
+    , trio {Trio::Mother {"mother"}, Trio::Father {"father"}, Trio::Child {"child"}}
+    , likelihoods {static_cast<unsigned>(haplotypes.size()), {"mother", "father", "child"}}
+    , prior_model {}
+    , mutation_model {DeNovoModel::Parameters {1e-8, 1e-9}}
+    {
+        std::mt19937 generator {seed};
+        insert_likelihoods(likelihoods, haplotypes, "mother", {0, 1}, num_reads, generator);
+        insert_likelihoods(likelihoods, haplotypes, "father", {0, 2}, num_reads, generator);
+        insert_likelihoods(likelihoods, haplotypes, "child", {1, 2}, num_reads, generator);
+    }
+
+    ReferenceGenome reference;
+    std::vector<Haplotype> haplotypes;
+    std::vector<Genotype<Haplotype>> genotypes;
+    Trio trio;
+    HaplotypeLikelihoodArray likelihoods;
+    UniformPopulationPriorModel prior_model;
+    DeNovoModel mutation_model;
+};
+
+auto to_tuple(const TrioModel::Latents::JointProbability& p)
+{
+    return std::make_tuple(&p.maternal.get(), &p.paternal.get(), &p.child.get());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+BOOST_AUTO_TEST_SUITE(trio_model)
+
+BOOST_AUTO_TEST_CASE(joint_genotypes_are_enumerated_in_decreasing_order_of_probability)
+{
+    TrioFixture fixture {6, 3};
+    TrioModel::Options options {};
+    options.max_excluded_posterior_fraction = 0;
+    const TrioModel model {fixture.trio, fixture.prior_model, fixture.mutation_model, options};
+    const auto latents = model.evaluate(fixture.genotypes, fixture.likelihoods);
+    const auto& joint = latents.posteriors.joint_genotype_probabilities;
+    const auto num_genotypes = fixture.genotypes.size();
+    BOOST_REQUIRE_EQUAL(joint.size(), num_genotypes * num_genotypes * num_genotypes);
+    std::set<decltype(to_tuple(joint.front()))> trios {};
+    for (const auto& p : joint) trios.insert(to_tuple(p));
+    BOOST_CHECK_EQUAL(trios.size(), joint.size());
+    BOOST_CHECK(std::is_sorted(std::cbegin(joint), std::cend(joint),
+                               [] (const auto& lhs, const auto& rhs) { return lhs.log_probability > rhs.log_probability; }));
+    const auto total = std::accumulate(std::cbegin(joint), std::cend(joint), 0.0,
+                                       [] (double curr, const auto& p) { return curr + p.probability; });
+    BOOST_CHECK_CLOSE(total, 1.0, 1e-6);
+    BOOST_CHECK(!latents.estimated_lost_log_posterior_mass);
+}
+
+BOOST_AUTO_TEST_CASE(enumeration_stops_when_the_remaining_posterior_mass_is_negligible)
+{
+    TrioFixture fixture {60, 7};
+    TrioModel::Options options {};
+    options.max_excluded_posterior_fraction = 0;
+    const TrioModel exhaustive_model {fixture.trio, fixture.prior_model, fixture.mutation_model, options};
+    const auto exhaustive = exhaustive_model.evaluate(fixture.genotypes, fixture.likelihoods);
+    options.max_excluded_posterior_fraction = 1e-10;
+    const TrioModel model {fixture.trio, fixture.prior_model, fixture.mutation_model, options};
+    const auto latents = model.evaluate(fixture.genotypes, fixture.likelihoods);
+    const auto& joint = latents.posteriors.joint_genotype_probabilities;
+    BOOST_REQUIRE(!joint.empty());
+    BOOST_CHECK_LT(joint.size(), exhaustive.posteriors.joint_genotype_probabilities.size());
+    BOOST_CHECK(!latents.estimated_lost_log_posterior_mass);
+    BOOST_CHECK_CLOSE(latents.log_evidence, exhaustive.log_evidence, 1e-6);
+    for (std::size_t i {0}; i < joint.size(); ++i) {
+        const auto& expected = exhaustive.posteriors.joint_genotype_probabilities[i];
+        BOOST_CHECK_CLOSE(joint[i].log_probability - 1, expected.log_probability - 1, 1e-6);
+    }
+    const auto& best = joint.front();
+    BOOST_CHECK(best.maternal.get().contains(fixture.haplotypes[0]) && best.maternal.get().contains(fixture.haplotypes[1]));
+    BOOST_CHECK(best.paternal.get().contains(fixture.haplotypes[0]) && best.paternal.get().contains(fixture.haplotypes[2]));
+    BOOST_CHECK(best.child.get().contains(fixture.haplotypes[1]) && best.child.get().contains(fixture.haplotypes[2]));
+}
+
+BOOST_AUTO_TEST_CASE(max_joint_genotypes_keeps_the_most_probable_and_bounds_the_lost_mass)
+{
+    TrioFixture fixture {4, 11};
+    TrioModel::Options options {};
+    options.max_excluded_posterior_fraction = 0;
+    const TrioModel exhaustive_model {fixture.trio, fixture.prior_model, fixture.mutation_model, options};
+    const auto exhaustive = exhaustive_model.evaluate(fixture.genotypes, fixture.likelihoods);
+    options.max_joint_genotypes = 20;
+    const TrioModel model {fixture.trio, fixture.prior_model, fixture.mutation_model, options};
+    const auto latents = model.evaluate(fixture.genotypes, fixture.likelihoods);
+    const auto& joint = latents.posteriors.joint_genotype_probabilities;
+    BOOST_REQUIRE_EQUAL(joint.size(), 20);
+    for (std::size_t i {0}; i < joint.size(); ++i) {
+        BOOST_CHECK(to_tuple(joint[i]) == to_tuple(exhaustive.posteriors.joint_genotype_probabilities[i]));
+    }
+    BOOST_REQUIRE(latents.estimated_lost_log_posterior_mass);
+    const auto& all = exhaustive.posteriors.joint_genotype_probabilities;
+    const auto lost_mass = std::accumulate(std::next(std::cbegin(all), 20), std::cend(all), 0.0,
+                                           [] (double curr, const auto& p) { return curr + p.probability; });
+    BOOST_CHECK_LE(std::log(lost_mass), *latents.estimated_lost_log_posterior_mass + 1e-9);
+    BOOST_CHECK_LE(*latents.estimated_lost_log_posterior_mass, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
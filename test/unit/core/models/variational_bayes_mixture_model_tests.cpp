@@ -0,0 +1,152 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cmath>
+
+#include "core/models/genotype/variational_bayes_mixture_model.hpp"
+#include "utils/work_stealing_scheduler.hpp"
+
+namespace octopus { namespace test {
+
+using namespace model;
+
+namespace {
+
+using LikelihoodVector = VBReadLikelihoodArray::BaseType;
+
+// Reads 0..num_a-1 come from haplotype a and the rest from haplotype b
+std::vector<LikelihoodVector> make_two_haplotype_likelihoods(const std::size_t num_a, const std::size_t num_b)
+{
+    LikelihoodVector a(num_a + num_b, -10.0), b(num_a + num_b, -1.0);
+    std::fill_n(std::begin(a), num_a, -1.0);
+    std::fill_n(std::begin(b), num_a, -10.0);
+    return {a, b};
+}
+
+// The genotypes {a, a}, {a, b} and {b, b}
+VBReadLikelihoodMatrix<2> make_diploid_likelihoods(const std::vector<LikelihoodVector>& haplotype_likelihoods)
+{
+    VBGenotypeVector<2> genotypes(3);
+    for (unsigned g {0}; g < 3; ++g) {
+        genotypes[g][0] = haplotype_likelihoods[g < 2 ? 0 : 1];
+        genotypes[g][1] = haplotype_likelihoods[g < 1 ? 0 : 1];
+    }
+    return {genotypes};
+}
+
+std::vector<LogProbabilityVector> make_seeds()
+{
+    std::vector<LogProbabilityVector> result(4, LogProbabilityVector(3, -100.0));
+    for (unsigned g {0}; g < 3; ++g) result[g][g] = 0;
+    std::fill(std::begin(result[3]), std::end(result[3]), std::log(1.0 / 3));
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+BOOST_AUTO_TEST_SUITE(variational_bayes_mixture_model)
+
+BOOST_AUTO_TEST_CASE(genotypes_share_likelihood_rows)
+{
+    const auto haplotype_likelihoods = make_two_haplotype_likelihoods(2, 3);
+    const auto likelihoods = octopus::model::detail::flatten(make_diploid_likelihoods(haplotype_likelihoods));
+    BOOST_REQUIRE_EQUAL(likelihoods.size(), 1);
+    const auto& sample_likelihoods = likelihoods.front();
+    BOOST_CHECK_EQUAL(sample_likelihoods.num_genotypes(), 3);
+    BOOST_CHECK_EQUAL(sample_likelihoods.num_components(), 2);
+    BOOST_CHECK_EQUAL(sample_likelihoods.num_reads(), 5);
+    BOOST_REQUIRE_EQUAL(sample_likelihoods.num_rows(), 2);
+    BOOST_CHECK_EQUAL(sample_likelihoods.row(0, 0), sample_likelihoods.row(0, 1));
+    BOOST_CHECK_EQUAL(sample_likelihoods.row(1, 0), sample_likelihoods.row(0, 0));
+    BOOST_CHECK_EQUAL(sample_likelihoods.row(1, 1), sample_likelihoods.row(2, 0));
+    BOOST_CHECK_NE(sample_likelihoods.row(0, 0), sample_likelihoods.row(2, 1));
+    BOOST_CHECK_EQUAL(sample_likelihoods.component_rows(0).size(), 2);
+    BOOST_CHECK_EQUAL(sample_likelihoods.component_rows(1).size(), 2);
+    for (unsigned h {0}; h < 2; ++h) {
+        const auto row = sample_likelihoods.likelihoods(sample_likelihoods.row(2 * h, 0));
+        BOOST_CHECK(std::equal(row, row + 5, std::cbegin(haplotype_likelihoods[h])));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mixture_of_two_haplotypes_is_inferred)
+{
+    const auto haplotype_likelihoods = make_two_haplotype_likelihoods(70, 30);
+    const auto likelihoods = make_diploid_likelihoods(haplotype_likelihoods);
+    const VBAlphaVector<2> prior_alphas {{1.0f, 1.0f}};
+    const LogProbabilityVector genotype_log_priors(3, std::log(1.0 / 3));
+    const auto result = run_variational_bayes(prior_alphas, genotype_log_priors, likelihoods, VariationalBayesParameters {}, make_seeds());
+    const auto& latents = result.map_latents;
+    BOOST_CHECK_CLOSE(latents.genotype_posteriors[1], 1.0, 1e-3);
+    BOOST_CHECK_CLOSE(result.evidence_weighted_genotype_posteriors[1], 1.0, 1e-3);
+    BOOST_CHECK_LE(std::accumulate(std::cbegin(result.evidence_weighted_genotype_posteriors),
+                                   std::cend(result.evidence_weighted_genotype_posteriors), 0.0), 1.0 + 1e-12);
+    BOOST_REQUIRE_EQUAL(latents.alphas.size(), 1);
+    BOOST_CHECK_CLOSE(latents.alphas[0][0], 71.0, 0.1);
+    BOOST_CHECK_CLOSE(latents.alphas[0][1], 31.0, 0.1);
+    BOOST_REQUIRE_EQUAL(latents.responsibilities.size(), 1);
+    const auto& responsibilities = latents.responsibilities.front();
+    BOOST_REQUIRE_EQUAL(responsibilities.num_components(), 2);
+    BOOST_REQUIRE_EQUAL(responsibilities.num_reads(), 100);
+    for (std::size_t n {0}; n < 100; ++n) {
+        BOOST_CHECK_CLOSE(responsibilities[0][n] + responsibilities[1][n], 1.0, 1e-4);
+        BOOST_CHECK_GT(responsibilities[n < 70 ? 0 : 1][n], 0.99);
+    }
+    BOOST_CHECK_LT(result.max_log_evidence, 0);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_seeds_give_the_same_result_as_sequential_seeds)
+{
+    const auto haplotype_likelihoods = make_two_haplotype_likelihoods(60, 640);
+    const auto likelihoods = make_diploid_likelihoods(haplotype_likelihoods);
+    const VBAlphaVector<2> prior_alphas {{1.0f, 1.0f}};
+    const LogProbabilityVector genotype_log_priors {std::log(0.2), std::log(0.3), std::log(0.5)};
+    VariationalBayesParameters params {};
+    const auto sequential = run_variational_bayes(prior_alphas, genotype_log_priors, likelihoods, params, make_seeds());
+    params.parallel_execution = true;
+    WorkStealingScheduler scheduler {4};
+    auto concurrent_future = scheduler.push([&] () {
+        return run_variational_bayes(prior_alphas, genotype_log_priors, likelihoods, params, make_seeds());
+    });
+    const auto concurrent = concurrent_future.get();
+    // Seeds are only abandoned against the first seed, so the results do not depend on the order seeds finish
+    BOOST_CHECK_EQUAL(concurrent.max_log_evidence, sequential.max_log_evidence);
+    for (unsigned g {0}; g < 3; ++g) {
+        BOOST_CHECK_EQUAL(concurrent.map_latents.genotype_posteriors[g], sequential.map_latents.genotype_posteriors[g]);
+        BOOST_CHECK_EQUAL(concurrent.evidence_weighted_genotype_posteriors[g], sequential.evidence_weighted_genotype_posteriors[g]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(abandoned_seeds_are_not_evidence_weighted_modes)
+{
+    std::vector<octopus::model::detail::VBSeedLatents> latents(2);
+    latents[0].genotype_posteriors = {0.9, 0.1};
+    latents[0].log_evidence = -10;
+    latents[0].is_converged = true;
+    latents[0].is_abandoned = false;
+    latents[1].genotype_posteriors = {0.2, 0.8};
+    latents[1].log_evidence = -11;
+    latents[1].is_converged = false;
+    latents[1].is_abandoned = false;
+    const auto with_seed = octopus::model::detail::compute_evidence_weighted_genotype_posteriors(latents);
+    BOOST_CHECK_GT(with_seed[1], 0.2);
+    latents[1].is_abandoned = true;
+    const auto without_seed = octopus::model::detail::compute_evidence_weighted_genotype_posteriors(latents);
+    BOOST_CHECK_CLOSE(without_seed[0], 0.9, 1e-9);
+    BOOST_CHECK_CLOSE(without_seed[1], 0.1, 1e-9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
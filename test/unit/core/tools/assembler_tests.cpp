@@ -72,6 +72,35 @@ BOOST_AUTO_TEST_CASE(assembler_throws_if_reference_sequence_is_inserted_twice)
     BOOST_CHECK_THROW(assembler.insert_reference(reference), std::exception);
 }
 
+BOOST_AUTO_TEST_CASE(assembler_finds_snv_with_kmers_longer_than_a_word)
+{
+    const Assembler::NucleotideSequence reference {"GATCCTAGGACTTACGGATGCATCAGTTGACCATGAGCTTAACGGTCAGTCCAATGCGTATCGAGGTCAAGCTTGCAACGTTAGCCTAGGCATTCGAAGTC"};
+    auto alt = reference;
+    alt[50] = alt[50] == 'A' ? 'C' : 'A';
+    auto alt_with_n = alt;
+    alt_with_n[5] = 'N';
+    
+    constexpr unsigned kmerSize {35};
+    
+    Assembler assembler {{kmerSize}, reference};
+    const Assembler::BaseQualityVector base_qualities(alt.size(), 40);
+    for (int i {0}; i < 5; ++i) {
+        assembler.insert_read(alt, base_qualities, Assembler::Direction::forward);
+        assembler.insert_read(alt_with_n, base_qualities, Assembler::Direction::reverse);
+    }
+    
+    BOOST_REQUIRE(assembler.is_unique_reference());
+    BOOST_CHECK(!assembler.is_all_reference());
+    assembler.cleanup();
+    const auto variants = assembler.extract_variants(10, 0);
+    BOOST_REQUIRE_EQUAL(variants.size(), 1);
+    // Bubbles are not trimmed
+    const auto& bubble = variants.front();
+    BOOST_REQUIRE(bubble.begin_pos <= 50 && bubble.begin_pos + bubble.ref.size() > 50);
+    BOOST_CHECK_EQUAL(bubble.ref, reference.substr(bubble.begin_pos, bubble.ref.size()));
+    BOOST_CHECK_EQUAL(bubble.alt, alt.substr(bubble.begin_pos, bubble.ref.size()));
+}
+
 
 
 BOOST_AUTO_TEST_SUITE_END()
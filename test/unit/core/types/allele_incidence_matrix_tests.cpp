@@ -0,0 +1,111 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <memory>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/types/cancer_genotype.hpp"
+#include "core/types/allele_incidence_matrix.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+// Haplotypes over [0, 20) with an alt allele at every position i where bit i of variant_mask is set
+std::vector<std::shared_ptr<Haplotype>>
+make_haplotypes(const ReferenceGenome& reference, const std::vector<unsigned>& variant_masks)
+{
+    const GenomicRegion region {"1", 0, 20};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<std::shared_ptr<Haplotype>> result {};
+    for (const auto mask : variant_masks) {
+        Haplotype::Builder builder {region, reference};
+        for (GenomicRegion::Position i {0}; i < 20; ++i) {
+            if ((mask >> i) & 1u) {
+                builder.push_back(Allele {GenomicRegion {"1", i, i + 1}, reference_sequence[i] == 'A' ? "C" : "A"});
+            }
+        }
+        result.push_back(std::make_shared<Haplotype>(builder.build()));
+    }
+    return result;
+}
+
+std::vector<Allele> make_alleles(const ReferenceGenome& reference)
+{
+    const auto reference_sequence = reference.fetch_sequence(GenomicRegion {"1", 0, 20});
+    std::vector<Allele> result {};
+    for (GenomicRegion::Position i {0}; i < 20; ++i) {
+        result.emplace_back(GenomicRegion {"1", i, i + 1}, reference_sequence[i] == 'A' ? "C" : "A");
+        result.emplace_back(GenomicRegion {"1", i, i + 1}, reference_sequence.substr(i, 1));
+    }
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(allele_incidence_matrix)
+
+BOOST_AUTO_TEST_CASE(incidence_matches_genotype_contains)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference, {0u, 1u, 6u, 0x10u, 0x80001u, 0xF0F0u, 0xFFFFFu});
+    std::vector<Genotype<Haplotype>> genotypes {};
+    for (std::size_t i {0}; i < haplotypes.size(); ++i) {
+        for (std::size_t j {i}; j < haplotypes.size(); ++j) {
+            for (std::size_t k {j}; k < haplotypes.size(); ++k) {
+                genotypes.emplace_back(Genotype<Haplotype> {3, haplotypes[i]});
+                genotypes.back().emplace(haplotypes[j]);
+                genotypes.back().emplace(haplotypes[k]);
+            }
+        }
+    }
+    BOOST_REQUIRE_GT(genotypes.size(), 64);
+    const auto alleles = make_alleles(reference);
+    const AlleleIncidenceMatrix incidence {alleles, genotypes};
+    BOOST_REQUIRE_EQUAL(incidence.num_alleles(), alleles.size());
+    BOOST_REQUIRE_EQUAL(incidence.num_genotypes(), genotypes.size());
+    for (std::size_t a {0}; a < alleles.size(); ++a) {
+        std::vector<std::size_t> expected_excluded {}, excluded {};
+        for (std::size_t g {0}; g < genotypes.size(); ++g) {
+            BOOST_CHECK_EQUAL(incidence.contains(g, a), contains(genotypes[g], alleles[a]));
+            if (!contains(genotypes[g], alleles[a])) expected_excluded.push_back(g);
+        }
+        incidence.for_each_excluding(a, [&] (std::size_t g) { excluded.push_back(g); });
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(excluded), std::cend(excluded),
+                                      std::cbegin(expected_excluded), std::cend(expected_excluded));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cancer_genotypes_contain_germline_and_somatic_alleles)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference, {0u, 1u, 2u, 4u});
+    std::vector<CancerGenotype<Haplotype>> genotypes {};
+    for (std::size_t i {0}; i < haplotypes.size(); ++i) {
+        for (std::size_t j {0}; j < haplotypes.size(); ++j) {
+            genotypes.emplace_back(Genotype<Haplotype> {1, haplotypes[i]}, Genotype<Haplotype> {1, haplotypes[j]});
+        }
+    }
+    const auto alleles = make_alleles(reference);
+    const AlleleIncidenceMatrix incidence {alleles, genotypes};
+    for (std::size_t a {0}; a < alleles.size(); ++a) {
+        for (std::size_t g {0}; g < genotypes.size(); ++g) {
+            BOOST_CHECK_EQUAL(incidence.contains(g, a), contains(genotypes[g], alleles[a]));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
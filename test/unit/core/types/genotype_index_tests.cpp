@@ -0,0 +1,72 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/allele.hpp"
+#include "core/types/genotype_index.hpp"
+#include "core/types/genotype.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(genotype_index)
+
+BOOST_AUTO_TEST_CASE(genotype_index_behaves_like_a_vector_inline_and_on_the_heap)
+{
+    for (const unsigned ploidy : {1u, 2u, 6u, 7u, 20u}) {
+        GenotypeIndex index {};
+        std::vector<unsigned> expected {};
+        for (unsigned i {0}; i < ploidy; ++i) {
+            index.push_back(i * 3);
+            expected.push_back(i * 3);
+        }
+        BOOST_REQUIRE_EQUAL(index.size(), ploidy);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(index), std::cend(index), std::cbegin(expected), std::cend(expected));
+        auto copy = index;
+        BOOST_CHECK(copy == index);
+        ++copy.back();
+        BOOST_CHECK(index < copy);
+        auto moved = std::move(copy);
+        BOOST_CHECK_EQUAL(moved.back(), expected.back() + 1);
+        BOOST_CHECK(copy.empty());
+        copy = moved;
+        BOOST_CHECK(copy == moved);
+        moved.resize(ploidy + 3, 1);
+        BOOST_CHECK_EQUAL(moved.size(), ploidy + 3);
+        BOOST_CHECK_EQUAL(moved.back(), 1);
+        BOOST_CHECK_EQUAL(moved[ploidy - 1], expected.back() + 1);
+    }
+    const GenotypeIndex filled(4, 2);
+    BOOST_CHECK((filled == GenotypeIndex {2, 2, 2, 2}));
+    BOOST_CHECK_EQUAL(filled.capacity(), GenotypeIndex::inlineCapacity);
+}
+
+BOOST_AUTO_TEST_CASE(genotype_indices_match_generated_genotypes)
+{
+    const GenomicRegion region {"1", 0, 1};
+    const std::vector<Allele> elements {{region, "A"}, {region, "C"}, {region, "G"}, {region, "T"}, {region, "N"}};
+    for (unsigned ploidy {1}; ploidy <= 8; ++ploidy) {
+        std::vector<GenotypeIndex> indices {};
+        const auto genotypes = generate_all_genotypes(elements, ploidy, indices);
+        const auto index_only = generate_all_genotype_indices(static_cast<unsigned>(elements.size()), ploidy);
+        BOOST_REQUIRE_EQUAL(genotypes.size(), num_genotypes(elements.size(), ploidy));
+        BOOST_REQUIRE_EQUAL(indices.size(), genotypes.size());
+        BOOST_CHECK(indices == index_only);
+        for (std::size_t g {0}; g < genotypes.size(); ++g) {
+            BOOST_CHECK(make_genotype(elements, indices[g]) == genotypes[g]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,120 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <atomic>
+
+#include "basics/genomic_region.hpp"
+#include "io/reference/reference_reader.hpp"
+#include "io/reference/concurrent_caching_fasta.hpp"
+
+namespace octopus { namespace test {
+
+using io::ConcurrentCachingFasta;
+
+namespace {
+
+// Contig sequence is a fixed function of position
+class MockReference : public io::ReferenceReader
+{
+public:
+    MockReference(std::shared_ptr<std::atomic<unsigned>> num_fetches = std::make_shared<std::atomic<unsigned>>(0))
+    : num_fetches_ {std::move(num_fetches)}
+    {}
+
+    static char base(const GenomicRegion::ContigName& contig, GenomicRegion::Position position)
+    {
+        return "ACGT"[(position * 7 + position / 13 + contig.size()) % 4];
+    }
+
+    unsigned num_fetches() const noexcept { return *num_fetches_; }
+
+private:
+    std::shared_ptr<std::atomic<unsigned>> num_fetches_;
+
+    std::unique_ptr<ReferenceReader> do_clone() const override { return std::make_unique<MockReference>(num_fetches_); }
+    bool do_is_open() const noexcept override { return true; }
+    std::string do_fetch_reference_name() const override { return "mock"; }
+    std::vector<ContigName> do_fetch_contig_names() const override { return {"1", "22"}; }
+    GenomicSize do_fetch_contig_size(const ContigName& contig) const override { return contig == "1" ? 10'000 : 2'500; }
+    GeneticSequence do_fetch_sequence(const GenomicRegion& region) const override
+    {
+        ++*num_fetches_;
+        GeneticSequence result {};
+        for (auto position = region.begin(); position < region.end(); ++position) {
+            result += base(region.contig_name(), position);
+        }
+        return result;
+    }
+};
+
+auto expected_sequence(const GenomicRegion& region)
+{
+    return MockReference {}.fetch_sequence(region);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(io)
+BOOST_AUTO_TEST_SUITE(concurrent_caching_fasta)
+
+BOOST_AUTO_TEST_CASE(cached_sequence_is_identical_to_source_sequence)
+{
+    ConcurrentCachingFasta reference {std::make_unique<MockReference>(), 4'000, 100, 4};
+    const std::vector<GenomicRegion> regions {
+        GenomicRegion {"1", 0, 1}, GenomicRegion {"1", 99, 101}, GenomicRegion {"1", 50, 450},
+        GenomicRegion {"1", 9'950, 10'000}, GenomicRegion {"22", 2'400, 2'500}, GenomicRegion {"1", 120, 130},
+        GenomicRegion {"22", 0, 2'500}, GenomicRegion {"1", 5'000, 5'000}, GenomicRegion {"1", 0, 10'000}
+    };
+    for (int i {0}; i < 2; ++i) {
+        for (const auto& region : regions) {
+            BOOST_CHECK_EQUAL(reference.fetch_sequence(region), expected_sequence(region));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(repeated_requests_are_cache_hits)
+{
+    auto num_fetches = std::make_shared<std::atomic<unsigned>>(0);
+    ConcurrentCachingFasta reference {std::make_unique<MockReference>(num_fetches), 4'000, 100, 4};
+    const GenomicRegion region {"1", 150, 350};
+    reference.fetch_sequence(region);
+    const auto num_initial_fetches = num_fetches->load();
+    BOOST_CHECK_EQUAL(num_initial_fetches, 3);
+    reference.fetch_sequence(region);
+    reference.fetch_sequence(GenomicRegion {"1", 210, 290});
+    BOOST_CHECK_EQUAL(num_fetches->load(), num_initial_fetches);
+    const auto stats = reference.stats();
+    BOOST_CHECK_EQUAL(stats.num_misses, 3);
+    BOOST_CHECK_EQUAL(stats.num_hits, 4);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_requests_return_correct_sequence)
+{
+    ConcurrentCachingFasta reference {std::make_unique<MockReference>(), 2'000, 64, 8};
+    std::vector<std::future<bool>> results {};
+    for (unsigned t {0}; t < 8; ++t) {
+        results.push_back(std::async(std::launch::async, [&reference, t] () {
+            bool good {true};
+            for (GenomicRegion::Position begin {t}; begin + 300 < 10'000; begin += 97) {
+                const GenomicRegion region {"1", begin, begin + 50 + (begin % 250)};
+                good &= reference.fetch_sequence(region) == expected_sequence(region);
+            }
+            return good;
+        }));
+    }
+    for (auto& result : results) {
+        BOOST_CHECK(result.get());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -7,6 +7,7 @@
 #include <string>
 #include <iterator>
 #include <vector>
+#include <future>
 
 #include <boost/filesystem.hpp>
 
@@ -150,6 +151,32 @@ BOOST_AUTO_TEST_CASE(read_manager_multiple_files_above_max_file_limit_test)
     BOOST_CHECK(small_reads3.size() == 7);
 }
 
+BOOST_AUTO_TEST_CASE(read_manager_can_fetch_reads_from_one_file_concurrently)
+{
+    BOOST_REQUIRE(test_file_exists(NA12878_low_coverage));
+    
+    constexpr unsigned maxOpenFiles {3};
+    
+    ReadManager read_manager({NA12878_low_coverage}, maxOpenFiles);
+    
+    const auto sample = read_manager.samples().front();
+    
+    const std::vector<GenomicRegion> regions {
+        {"1", 9'990, 10'000}, {"10", 1'000'000, 1'000'100}, {"3", 100'000, 100'100}, {"1", 2'000'000, 3'000'000}
+    };
+    const std::vector<std::size_t> expected_counts {1, 7, 21, 61225};
+    
+    for (int i {0}; i < 5; ++i) {
+        std::vector<std::future<std::size_t>> counts {};
+        for (const auto& region : regions) {
+            counts.push_back(std::async(std::launch::async, [&] () { return read_manager.fetch_reads(sample, region).size(); }));
+        }
+        for (std::size_t j {0}; j < regions.size(); ++j) {
+            BOOST_CHECK_EQUAL(counts[j].get(), expected_counts[j]);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,123 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "io/reference/fasta.hpp"
+#include "io/reference/two_bit_reference.hpp"
+
+namespace octopus { namespace test {
+
+using io::Fasta;
+using io::TwoBitReference;
+using io::get_two_bit_reference_path;
+using io::build_two_bit_reference;
+using io::is_two_bit_reference;
+
+namespace {
+
+namespace fs = boost::filesystem;
+
+struct TestFasta
+{
+    TestFasta() : directory {fs::temp_directory_path() / fs::unique_path()}
+    {
+        fs::create_directory(directory);
+        path = directory / "test.fa";
+        const std::vector<std::pair<std::string, std::string>> contigs {
+            {"1", "ACGTNNNNacgtnnRYACGTACGTAC"},
+            {"2", "TTTT"},
+            {"X", "GATTACAgattacaNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNSWKMBDHVNACGT"}
+        };
+        std::ofstream fasta {path.string()}, index {path.string() + ".fai"};
+        static constexpr std::size_t line_length {10};
+        for (const auto& contig : contigs) {
+            fasta << '>' << contig.first << '\n';
+            index << contig.first << '\t' << contig.second.size() << '\t' << fasta.tellp() << '\t'
+                  << line_length << '\t' << line_length + 1 << '\n';
+            for (std::size_t pos {0}; pos < contig.second.size(); pos += line_length) {
+                fasta << contig.second.substr(pos, line_length) << '\n';
+            }
+        }
+    }
+    ~TestFasta() { fs::remove_all(directory); }
+
+    fs::path directory, path;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(io)
+BOOST_AUTO_TEST_SUITE(two_bit_reference)
+
+BOOST_AUTO_TEST_CASE(two_bit_reference_sequence_is_identical_to_fasta_sequence)
+{
+    const TestFasta test_fasta {};
+    const auto two_bit_path = get_two_bit_reference_path(test_fasta.path);
+    build_two_bit_reference(test_fasta.path, two_bit_path);
+    BOOST_REQUIRE(is_two_bit_reference(two_bit_path));
+
+    const Fasta fasta {test_fasta.path};
+    const TwoBitReference two_bit {two_bit_path};
+    BOOST_CHECK_EQUAL(two_bit.fetch_reference_name(), fasta.fetch_reference_name());
+    BOOST_REQUIRE(two_bit.fetch_contig_names() == fasta.fetch_contig_names());
+    for (const auto& contig : fasta.fetch_contig_names()) {
+        const auto contig_size = fasta.fetch_contig_size(contig);
+        BOOST_REQUIRE_EQUAL(two_bit.fetch_contig_size(contig), contig_size);
+        for (GenomicRegion::Position begin {0}; begin <= contig_size; ++begin) {
+            for (auto end = begin; end <= contig_size; ++end) {
+                const GenomicRegion region {contig, begin, end};
+                BOOST_CHECK_EQUAL(two_bit.fetch_sequence(region), fasta.fetch_sequence(region));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(two_bit_reference_respects_fasta_options)
+{
+    const TestFasta test_fasta {};
+    const auto two_bit_path = get_two_bit_reference_path(test_fasta.path);
+    build_two_bit_reference(test_fasta.path, two_bit_path);
+
+    Fasta::Options options {};
+    options.base_transform_policy = Fasta::Options::CapitalisationPolicy::capitalise;
+    options.base_fill_policy = Fasta::Options::BaseFillPolicy::fill_with_ns;
+    const TwoBitReference two_bit {two_bit_path, options};
+    BOOST_CHECK_EQUAL(two_bit.fetch_sequence(GenomicRegion {"1", 6, 16}), "NNACGTNNRY");
+    BOOST_CHECK_EQUAL(two_bit.fetch_sequence(GenomicRegion {"2", 2, 6}), "TTNN");
+
+    options.iupac_ambiguity_symbol_policy = Fasta::Options::IUPACAmbiguitySymbolPolicy::disambiguate;
+    const TwoBitReference disambiguated_two_bit {two_bit_path, options};
+    const Fasta disambiguated_fasta {test_fasta.path, options};
+    const GenomicRegion region {"X", 0, disambiguated_fasta.fetch_contig_size("X")};
+    BOOST_CHECK_EQUAL(disambiguated_two_bit.fetch_sequence(region), disambiguated_fasta.fetch_sequence(region));
+}
+
+BOOST_AUTO_TEST_CASE(fetching_into_a_buffer_gives_the_same_sequence)
+{
+    const TestFasta test_fasta {};
+    const auto two_bit_path = get_two_bit_reference_path(test_fasta.path);
+    build_two_bit_reference(test_fasta.path, two_bit_path);
+
+    const TwoBitReference two_bit {two_bit_path};
+    std::string buffer {"some previous sequence"};
+    const GenomicRegion region {"X", 3, 20};
+    two_bit.fetch_sequence(region, buffer);
+    BOOST_CHECK_EQUAL(buffer, two_bit.fetch_sequence(region));
+    const auto clone = two_bit.clone();
+    BOOST_CHECK_EQUAL(clone->fetch_sequence(region), buffer);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "containers/mappable_flat_set.hpp"
+#include "readpipe/buffered_read_pipe.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(readpipe)
+BOOST_AUTO_TEST_SUITE(buffered_read_pipe)
+
+BOOST_AUTO_TEST_CASE(next_request_is_predicted_at_the_first_hint_after_the_buffered_region)
+{
+    const MappableFlatSet<GenomicRegion> hints {
+        GenomicRegion {"1", 0, 50}, GenomicRegion {"1", 300, 400}, GenomicRegion {"1", 500, 600}
+    };
+    const auto prediction = predict_next_request(GenomicRegion {"1", 100, 200}, hints);
+    BOOST_REQUIRE(prediction);
+    BOOST_CHECK_EQUAL(*prediction, GenomicRegion("1", 300, 300));
+}
+
+BOOST_AUTO_TEST_CASE(next_request_is_predicted_at_the_buffer_end_if_a_hint_overlaps_it)
+{
+    const MappableFlatSet<GenomicRegion> hints {GenomicRegion {"1", 50, 150}, GenomicRegion {"1", 180, 250}};
+    const auto prediction = predict_next_request(GenomicRegion {"1", 100, 200}, hints);
+    BOOST_REQUIRE(prediction);
+    BOOST_CHECK_EQUAL(*prediction, GenomicRegion("1", 200, 200));
+}
+
+BOOST_AUTO_TEST_CASE(no_request_is_predicted_past_the_last_hint)
+{
+    const MappableFlatSet<GenomicRegion> hints {GenomicRegion {"1", 0, 50}, GenomicRegion {"1", 150, 200}};
+    BOOST_CHECK(!predict_next_request(GenomicRegion {"1", 100, 200}, hints));
+    BOOST_CHECK(!predict_next_request(GenomicRegion {"1", 100, 200}, MappableFlatSet<GenomicRegion> {}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -5,11 +5,54 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
  
+#include <vector>
+#include <deque>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "utils/maths.hpp"
+#include "utils/batch_maths_kernels.hpp"
  
 namespace octopus { namespace test {
  
 static constexpr double tolerance {1e-10};
+
+namespace {
+
+using octopus::maths::detail::BatchMathsKernels;
+
+// Every set of batch kernels this CPU can run
+std::vector<const BatchMathsKernels*> get_runnable_batch_kernels()
+{
+    __builtin_cpu_init();
+    std::vector<const BatchMathsKernels*> result {&octopus::maths::detail::get_scalar_batch_maths_kernels()};
+    const auto avx2 = octopus::maths::detail::get_avx2_batch_maths_kernels();
+    if (avx2 && __builtin_cpu_supports("avx2")) result.push_back(avx2);
+    const auto avx512 = octopus::maths::detail::get_avx512_batch_maths_kernels();
+    if (avx512 && __builtin_cpu_supports("avx512f")) result.push_back(avx512);
+    return result;
+}
+
+std::vector<double> make_uniform(const std::size_t n, const double min, const double max, std::mt19937& generator)
+{
+    std::uniform_real_distribution<> dist {min, max};
+    std::vector<double> result(n);
+    for (auto& x : result) x = dist(generator);
+    return result;
+}
+
+// Relative error, in units of epsilon, with exact agreement of non-finite values
+double ulp_error(const double actual, const double expected)
+{
+    if (std::isnan(expected)) return std::isnan(actual) ? 0 : std::numeric_limits<double>::infinity();
+    if (!std::isfinite(expected) || expected == 0) return actual == expected ? 0 : std::numeric_limits<double>::infinity();
+    return std::abs(actual - expected) / std::abs(expected) / std::numeric_limits<double>::epsilon();
+}
+
+} // namespace
  
 BOOST_AUTO_TEST_SUITE(utils)
 BOOST_AUTO_TEST_SUITE(maths)
@@ -23,6 +66,181 @@ BOOST_AUTO_TEST_CASE(log_sum_exp_handles_edge_cases)
     BOOST_CHECK_CLOSE(log_sum_exp(zero, zero), -lnHalf, tolerance);
 }
  
+BOOST_AUTO_TEST_CASE(batch_exp_and_log_agree_with_scalar_versions)
+{
+    std::mt19937 generator {42};
+    auto exp_values = make_uniform(1003, -700, 700, generator);
+    const auto small_exp_values = make_uniform(101, -1, 1, generator);
+    exp_values.insert(std::cend(exp_values), std::cbegin(small_exp_values), std::cend(small_exp_values));
+    const auto inf = std::numeric_limits<double>::infinity();
+    exp_values.insert(std::cend(exp_values), {0.0, -inf, inf, -800.0, 800.0, -740.0, 709.7, std::nan("")});
+    std::vector<double> log_values {};
+    for (const auto x : make_uniform(1001, -740, 709, generator)) log_values.push_back(std::exp(x));
+    log_values.insert(std::cend(log_values), {1.0, 0.0, -0.0, inf, -1.0, std::numeric_limits<double>::denorm_min(),
+                                              std::numeric_limits<double>::min(), std::numeric_limits<double>::max(), std::nan("")});
+    for (const auto kernels : get_runnable_batch_kernels()) {
+        BOOST_TEST_CONTEXT("kernels " << kernels->name) {
+            for (const std::size_t n : {std::size_t {0}, std::size_t {1}, std::size_t {7}, exp_values.size()}) {
+                std::vector<double> result(n);
+                kernels->exp(exp_values.data(), 0, result.data(), n);
+                for (std::size_t i {0}; i < n; ++i) {
+                    BOOST_CHECK_LE(ulp_error(result[i], std::exp(exp_values[i])), 4);
+                }
+            }
+            std::vector<double> result(log_values.size());
+            kernels->log(log_values.data(), result.data(), log_values.size());
+            for (std::size_t i {0}; i < log_values.size(); ++i) {
+                BOOST_CHECK_LE(ulp_error(result[i], std::log(log_values[i])), 4);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_log_sum_exp_agrees_with_scalar_version)
+{
+    using octopus::maths::log_sum_exp;
+    std::mt19937 generator {7};
+    const std::size_t n {517};
+    auto a = make_uniform(n, -1000, 10, generator);
+    auto b = make_uniform(n, -1000, 10, generator);
+    const auto c = make_uniform(n, -50, 10, generator);
+    std::copy_n(std::cbegin(a), 50, std::begin(b)); // equal arguments
+    for (const auto kernels : get_runnable_batch_kernels()) {
+        BOOST_TEST_CONTEXT("kernels " << kernels->name) {
+            std::vector<double> result(n);
+            kernels->log_sum_exp2(a.data(), b.data(), result.data(), n);
+            for (std::size_t i {0}; i < n; ++i) {
+                BOOST_CHECK_LE(ulp_error(result[i], log_sum_exp(a[i], b[i])), 4);
+            }
+            kernels->log_sum_exp3(a.data(), b.data(), c.data(), result.data(), n);
+            for (std::size_t i {0}; i < n; ++i) {
+                BOOST_CHECK_LE(ulp_error(result[i], log_sum_exp(a[i], b[i], c[i])), 4);
+            }
+            const auto max = kernels->max(c.data(), n);
+            BOOST_CHECK_EQUAL(max, *std::max_element(std::cbegin(c), std::cend(c)));
+            BOOST_CHECK_LE(ulp_error(max + std::log(kernels->sum_exp(c.data(), max, n)), log_sum_exp(c)), 16);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_log_sum_exp_handles_infinities)
+{
+    const auto inf = std::numeric_limits<double>::infinity();
+    const std::vector<double> a {-inf, -inf, inf, 0.0, -inf}, b {-inf, 0.0, -inf, inf, std::nan("")};
+    for (const auto kernels : get_runnable_batch_kernels()) {
+        BOOST_TEST_CONTEXT("kernels " << kernels->name) {
+            std::vector<double> result(a.size());
+            kernels->log_sum_exp2(a.data(), b.data(), result.data(), a.size());
+            BOOST_CHECK_EQUAL(result[0], -inf);
+            BOOST_CHECK_EQUAL(result[1], 0.0);
+            BOOST_CHECK_EQUAL(result[2], inf);
+            BOOST_CHECK_EQUAL(result[3], inf);
+            BOOST_CHECK(std::isnan(result[4]));
+            kernels->log_sum_exp3(a.data(), a.data(), b.data(), result.data(), a.size());
+            BOOST_CHECK_EQUAL(result[0], -inf);
+            BOOST_CHECK_EQUAL(result[1], 0.0);
+            BOOST_CHECK_EQUAL(result[2], inf);
+            BOOST_CHECK_EQUAL(result[3], inf);
+            BOOST_CHECK(std::isnan(result[4]));
+        }
+    }
+    BOOST_CHECK_EQUAL(octopus::maths::log_sum_exp(a.data(), 1), -inf);
+    BOOST_CHECK_EQUAL(octopus::maths::log_sum_exp(a.data(), 0), -inf);
+}
+
+BOOST_AUTO_TEST_CASE(batch_mixture_log_likelihoods_agree_with_scalar_version)
+{
+    std::mt19937 generator {11};
+    const std::size_t n {203};
+    std::vector<std::vector<double>> values {};
+    for (int j {0}; j < 7; ++j) values.push_back(make_uniform(n, -50, 0, generator));
+    values[1][5] = values[2][5] = -std::numeric_limits<double>::infinity();
+    std::vector<const double*> pointers {};
+    for (const auto& v : values) pointers.push_back(v.data());
+    const auto log_weights = make_uniform(values.size(), -3, 0, generator);
+    for (const auto kernels : get_runnable_batch_kernels()) {
+        BOOST_TEST_CONTEXT("kernels " << kernels->name) {
+            for (std::size_t k {0}; k <= values.size(); ++k) {
+                for (const std::size_t m : {std::size_t {1}, std::size_t {9}, n}) {
+                    double expected {0};
+                    for (std::size_t i {0}; i < m; ++i) {
+                        std::vector<double> mixture {};
+                        for (std::size_t j {0}; j < k; ++j) mixture.push_back(values[j][i] + log_weights[j]);
+                        if (!mixture.empty()) expected += octopus::maths::log_sum_exp(mixture);
+                    }
+                    BOOST_CHECK_CLOSE(kernels->sum_log_sum_exp(pointers.data(), log_weights.data(), k, m), expected, tolerance);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(single_precision_batch_functions_agree_with_scalar_versions)
+{
+    std::mt19937 generator {5};
+    const std::size_t n {101};
+    const auto as_floats = [] (const std::vector<double>& values) { return std::vector<float>(std::cbegin(values), std::cend(values)); };
+    const auto x = as_floats(make_uniform(n, -20, 0, generator));
+    auto p = as_floats(make_uniform(n, 0, 1, generator));
+    p[0] = p[n - 1] = 0;
+    const auto y = make_uniform(n, -5, 5, generator);
+    std::vector<std::vector<double>> logs {};
+    for (int j {0}; j < 5; ++j) logs.push_back(make_uniform(n, -30, 0, generator));
+    std::vector<const double*> log_pointers {};
+    for (const auto& v : logs) log_pointers.push_back(v.data());
+    for (const auto kernels : get_runnable_batch_kernels()) {
+        BOOST_TEST_CONTEXT("kernels " << kernels->name) {
+            for (const std::size_t m : {std::size_t {0}, std::size_t {1}, std::size_t {7}, n}) {
+                double expected_inner_product {0}, expected_sum {0}, expected_entropy {0};
+                for (std::size_t i {0}; i < m; ++i) {
+                    expected_inner_product += static_cast<double>(p[i]) * x[i];
+                    expected_sum += p[i];
+                    if (p[i] > 0) expected_entropy -= p[i] * std::log(static_cast<double>(p[i]));
+                }
+                BOOST_CHECK_CLOSE(kernels->inner_product(p.data(), x.data(), m), expected_inner_product, tolerance);
+                BOOST_CHECK_CLOSE(kernels->sum(p.data(), m), expected_sum, tolerance);
+                BOOST_CHECK_CLOSE(kernels->entropy(p.data(), m), expected_entropy, tolerance);
+                auto scaled = y;
+                kernels->add_scaled(0.5, x.data(), scaled.data(), m);
+                for (std::size_t i {0}; i < n; ++i) {
+                    BOOST_CHECK_CLOSE(scaled[i], i < m ? y[i] + 0.5 * x[i] : y[i], tolerance);
+                }
+            }
+            for (std::size_t k {1}; k <= logs.size(); ++k) {
+                std::vector<std::vector<float>> normalised(k, std::vector<float>(n));
+                std::vector<float*> normalised_pointers {};
+                for (auto& v : normalised) normalised_pointers.push_back(v.data());
+                kernels->normalise_exp(log_pointers.data(), normalised_pointers.data(), k, n);
+                for (std::size_t i {0}; i < n; ++i) {
+                    std::vector<double> column {};
+                    for (std::size_t j {0}; j < k; ++j) column.push_back(logs[j][i]);
+                    const auto norm = octopus::maths::log_sum_exp(column);
+                    for (std::size_t j {0}; j < k; ++j) {
+                        BOOST_CHECK_CLOSE(normalised[j][i], std::exp(logs[j][i] - norm), 1e-4);
+                    }
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_normalisation_agrees_with_scalar_version)
+{
+    std::mt19937 generator {3};
+    for (const std::size_t n : {1, 3, 8, 100}) {
+        const auto logs = make_uniform(n, -100, 0, generator);
+        auto normalised_logs = logs, normalised = logs;
+        std::deque<double> expected_logs {std::cbegin(logs), std::cend(logs)}, expected {std::cbegin(logs), std::cend(logs)};
+        BOOST_CHECK_CLOSE(octopus::maths::normalise_logs(normalised_logs), octopus::maths::normalise_logs(expected_logs), tolerance);
+        BOOST_CHECK_CLOSE(octopus::maths::normalise_exp(normalised), octopus::maths::normalise_exp(expected), tolerance);
+        for (std::size_t i {0}; i < n; ++i) {
+            BOOST_CHECK_CLOSE(normalised_logs[i], expected_logs[i], tolerance);
+            BOOST_CHECK_CLOSE(normalised[i], expected[i], tolerance);
+        }
+        BOOST_CHECK_CLOSE(std::accumulate(std::cbegin(normalised), std::cend(normalised), 0.0), 1.0, tolerance);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
  
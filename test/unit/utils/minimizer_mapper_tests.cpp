@@ -0,0 +1,154 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <iterator>
+#include <algorithm>
+
+#include "utils/minimizer_mapper.hpp"
+
+namespace octopus { namespace test {
+
+namespace {
+
+std::string random_sequence(std::mt19937& generator, const std::size_t length)
+{
+    std::string result(length, 'A');
+    std::generate(std::begin(result), std::end(result), [&] () { return "ACGT"[generator() % 4]; });
+    return result;
+}
+
+bool are_equal(const MinimizerVector& lhs, const MinimizerVector& rhs)
+{
+    return lhs.size() == rhs.size()
+           && std::equal(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs), [] (const auto& a, const auto& b) {
+               return a.hash == b.hash && a.position == b.position;
+           });
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(minimizer_mapper)
+
+BOOST_AUTO_TEST_CASE(every_window_contains_a_minimizer)
+{
+    std::mt19937 generator {42};
+    const auto sequence = random_sequence(generator, 200);
+    const auto minimizers = compute_minimizers<6, 4>(sequence);
+    BOOST_REQUIRE(!minimizers.empty());
+    BOOST_CHECK(std::is_sorted(std::cbegin(minimizers), std::cend(minimizers),
+                               [] (const auto& lhs, const auto& rhs) { return lhs.position < rhs.position; }));
+    for (std::size_t window {0}; window < num_minimizer_windows<6>(sequence.size(), 4); ++window) {
+        BOOST_CHECK(std::any_of(std::cbegin(minimizers), std::cend(minimizers),
+                                [=] (const auto& minimizer) { return minimizer.position >= window && minimizer.position < window + 4; }));
+    }
+    BOOST_CHECK((compute_minimizers<6, 4>(std::string(8, 'A')).empty()));
+    BOOST_CHECK_EQUAL((compute_minimizers<6, 4>(std::string(9, 'A')).size()), 1);
+}
+
+BOOST_AUTO_TEST_CASE(incremental_minimizers_are_identical_to_recomputed_minimizers)
+{
+    std::mt19937 generator {7};
+    MinimizerIndex<6, 4> index {};
+    auto target = random_sequence(generator, 300);
+    for (int i {0}; i < 500; ++i) {
+        index.assign(target);
+        BOOST_REQUIRE(are_equal(index.minimizers(), compute_minimizers<6, 4>(target)));
+        // Mimic the next haplotype in a block: a few substitutions, insertions, and deletions
+        const auto position = generator() % target.size();
+        switch (generator() % 4) {
+            case 0: target[position] = "ACGT"[generator() % 4]; break;
+            case 1: target.insert(position, random_sequence(generator, 1 + generator() % 12)); break;
+            case 2: target.erase(position, 1 + generator() % 12); break;
+            default: target = random_sequence(generator, generator() % 20);
+        }
+        if (target.size() < 50) target += random_sequence(generator, 250);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reads_map_to_their_true_position)
+{
+    std::mt19937 generator {13};
+    const auto haplotype = random_sequence(generator, 500);
+    MinimizerIndex<6, 4> index {};
+    index.assign(haplotype);
+    for (std::size_t position {0}; position + 100 <= haplotype.size(); position += 17) {
+        auto read = haplotype.substr(position, 100);
+        read[50] = read[50] == 'A' ? 'C' : 'A';
+        std::vector<std::size_t> mapping_positions {};
+        index.map(compute_minimizers<6, 4>(read), std::back_inserter(mapping_positions), 10);
+        BOOST_REQUIRE_EQUAL(mapping_positions.size(), 1);
+        BOOST_CHECK_EQUAL(mapping_positions.front(), position);
+    }
+    std::vector<std::size_t> mapping_positions {};
+    index.map(compute_minimizers<6, 4>(std::string(100, 'N')), std::back_inserter(mapping_positions), 10);
+    BOOST_CHECK(std::all_of(std::cbegin(mapping_positions), std::cend(mapping_positions),
+                            [&] (auto position) { return position < haplotype.size(); }));
+}
+
+BOOST_AUTO_TEST_CASE(tandem_repeats_give_all_equally_good_positions)
+{
+    const std::string unit {"ACGTTGCA"}, flank {"GATTACAGGCCTTAAGCTGACTGATCCGATGCA"};
+    std::string haplotype {flank};
+    for (int i {0}; i < 10; ++i) haplotype += unit;
+    haplotype += flank;
+    MinimizerIndex<6, 4> index {};
+    index.assign(haplotype);
+    std::vector<std::size_t> mapping_positions {};
+    index.map(compute_minimizers<6, 4>(unit + unit + unit), std::back_inserter(mapping_positions), 3);
+    BOOST_REQUIRE_EQUAL(mapping_positions.size(), 3);
+    BOOST_CHECK(std::is_sorted(std::cbegin(mapping_positions), std::cend(mapping_positions)));
+    for (const auto position : mapping_positions) {
+        BOOST_CHECK_EQUAL((position - flank.size()) % unit.size(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tied_or_sparse_minimizer_hits_fall_back_to_mapping_every_kmer)
+{
+    const std::string unit {"ACGTTGCA"}, flank {"GATTACAGGCCTTAAGCTGACTGATCCGATGCA"};
+    std::string repeat_haplotype {flank};
+    for (int i {0}; i < 10; ++i) repeat_haplotype += unit;
+    repeat_haplotype += flank;
+    MinimizerIndex<6, 4> index {};
+    index.assign(repeat_haplotype);
+    const auto repeat_read = flank.substr(20) + unit + unit;
+    std::vector<std::size_t> mapping_positions {};
+    index.map(compute_minimizers<6, 4>(repeat_read), repeat_read, std::back_inserter(mapping_positions));
+    BOOST_CHECK(mapping_positions == map_query_to_target<6>(repeat_read, repeat_haplotype));
+    std::mt19937 generator {17};
+    const auto haplotype = random_sequence(generator, 400);
+    index.assign(haplotype);
+    const auto dense_target = make_kmer_hash_table<6>(haplotype);
+    int num_fallbacks {0};
+    for (int i {0}; i < 200; ++i) {
+        auto read = haplotype.substr(generator() % 300, 100);
+        // Enough errors that few minimizers survive
+        for (auto& base : read) if (generator() % 3 == 0) base = "ACGT"[generator() % 4];
+        const auto minimizers = compute_minimizers<6, 4>(read);
+        std::vector<std::size_t> minimizer_positions {}, positions {};
+        index.map(minimizers, std::back_inserter(minimizer_positions));
+        index.map(minimizers, read, std::back_inserter(positions));
+        if (positions != minimizer_positions) ++num_fallbacks;
+        if (minimizer_positions.size() == 1) {
+            BOOST_CHECK(positions == minimizer_positions || positions == map_query_to_target(compute_kmer_hashes<6>(read), dense_target));
+        } else {
+            BOOST_CHECK(positions == map_query_to_target(compute_kmer_hashes<6>(read), dense_target));
+        }
+    }
+    BOOST_CHECK_GT(num_fallbacks, 0);
+    index.clear();
+    mapping_positions.clear();
+    index.map(compute_minimizers<6, 4>(repeat_read), repeat_read, std::back_inserter(mapping_positions));
+    BOOST_CHECK(mapping_positions.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
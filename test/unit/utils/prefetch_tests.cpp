@@ -0,0 +1,111 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <future>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include "utils/thread_pool.hpp"
+#include "utils/work_stealing_scheduler.hpp"
+#include "utils/prefetch.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(prefetch)
+
+namespace {
+
+template <typename T>
+void wait_until_not(const Prefetch<T>& prefetch, const typename Prefetch<T>::Status status)
+{
+    using namespace std::chrono_literals;
+    while (prefetch.status() == status) std::this_thread::sleep_for(1ms);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(prefetched_values_are_fetched_by_the_executor)
+{
+    ThreadPool workers {1};
+    const auto consumer = std::this_thread::get_id();
+    Prefetch<std::thread::id> prefetch {[] () { return std::this_thread::get_id(); }, workers};
+    wait_until_not(prefetch, Prefetch<std::thread::id>::Status::queued);
+    wait_until_not(prefetch, Prefetch<std::thread::id>::Status::running);
+    BOOST_CHECK(prefetch.status() == Prefetch<std::thread::id>::Status::done);
+    BOOST_CHECK(prefetch.get() != consumer);
+}
+
+BOOST_AUTO_TEST_CASE(queued_fetches_are_run_by_the_consumer)
+{
+    ThreadPool workers {1};
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    workers.push([released] () { released.wait(); }); // keeps the fetch queued
+    std::atomic<int> num_fetches {0};
+    Prefetch<std::thread::id> prefetch {[&] () { ++num_fetches; return std::this_thread::get_id(); }, workers};
+    BOOST_CHECK(prefetch.status() == Prefetch<std::thread::id>::Status::queued);
+    BOOST_CHECK(prefetch.get() == std::this_thread::get_id());
+    release.set_value();
+    workers.push([] () {}).wait(); // the queued job has now run
+    BOOST_CHECK_EQUAL(num_fetches, 1);
+}
+
+BOOST_AUTO_TEST_CASE(consumers_wait_for_running_fetches)
+{
+    ThreadPool workers {1};
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    Prefetch<int> prefetch {[released] () { released.wait(); return 1; }, workers};
+    wait_until_not(prefetch, Prefetch<int>::Status::queued);
+    BOOST_CHECK(prefetch.status() == Prefetch<int>::Status::running);
+    BOOST_CHECK(!prefetch.cancel());
+    auto result = std::async(std::launch::async, [&] () { return prefetch.get(); });
+    release.set_value();
+    BOOST_CHECK_EQUAL(result.get(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(queued_fetches_can_be_cancelled)
+{
+    ThreadPool workers {1};
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    workers.push([released] () { released.wait(); });
+    std::atomic<int> num_fetches {0};
+    {
+        Prefetch<int> prefetch {[&] () { return ++num_fetches; }, workers};
+        BOOST_CHECK(prefetch.cancel());
+        BOOST_CHECK(prefetch.status() == Prefetch<int>::Status::cancelled);
+        Prefetch<int> abandoned {[&] () { return ++num_fetches; }, workers};
+    }
+    release.set_value();
+    workers.push([] () {}).wait();
+    BOOST_CHECK_EQUAL(num_fetches, 0);
+}
+
+BOOST_AUTO_TEST_CASE(fetch_errors_are_rethrown_by_the_consumer)
+{
+    WorkStealingScheduler scheduler {2};
+    Prefetch<int> prefetch {[] () -> int { throw std::runtime_error {"fetch failed"}; }, scheduler};
+    BOOST_CHECK_THROW(prefetch.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fetches_can_be_prefetched_from_scheduler_tasks)
+{
+    WorkStealingScheduler scheduler {2};
+    auto result = scheduler.push([&scheduler] () {
+        Prefetch<int> prefetch {[] () { return 1; }, scheduler};
+        return prefetch.get();
+    });
+    BOOST_CHECK_EQUAL(scheduler.wait(result), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
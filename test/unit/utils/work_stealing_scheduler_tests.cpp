@@ -0,0 +1,129 @@
+// Copyright (c) 2015-2019 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <future>
+#include <numeric>
+#include <atomic>
+#include <cstddef>
+#include <chrono>
+#include <thread>
+
+#include "utils/work_stealing_scheduler.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(work_stealing_scheduler)
+
+BOOST_AUTO_TEST_CASE(work_stealing_scheduler_runs_all_pushed_tasks)
+{
+    WorkStealingScheduler scheduler {4};
+    std::vector<std::future<int>> results {};
+    for (int i {0}; i < 1000; ++i) {
+        results.push_back(scheduler.push([] (int x) { return 2 * x; }, i));
+    }
+    int sum {0};
+    for (auto& result : results) sum += result.get();
+    BOOST_CHECK_EQUAL(sum, 999 * 1000);
+}
+
+unsigned fib(const unsigned n, WorkStealingScheduler& scheduler)
+{
+    if (n < 2) return n;
+    auto lhs = scheduler.push(fib, n - 1, std::ref(scheduler));
+    const auto rhs = fib(n - 2, scheduler);
+    return scheduler.wait(lhs) + rhs;
+}
+
+BOOST_AUTO_TEST_CASE(work_stealing_scheduler_does_not_deadlock_on_nested_tasks)
+{
+    WorkStealingScheduler scheduler {2};
+    auto result = scheduler.push(fib, 16u, std::ref(scheduler));
+    BOOST_CHECK_EQUAL(scheduler.wait(result), 987u);
+}
+
+BOOST_AUTO_TEST_CASE(waiting_tasks_only_run_their_own_subtasks)
+{
+    WorkStealingScheduler scheduler {1};
+    std::promise<void> child_pushed, other_pushed;
+    auto other_pushed_future = other_pushed.get_future();
+    std::atomic<bool> other_ran {false};
+    auto parent = scheduler.push([&] () {
+        auto child = scheduler.push([] () { return 1; });
+        child_pushed.set_value();
+        other_pushed_future.wait();
+        // The other task is now queued behind the child on this worker's deque
+        scheduler.wait(child);
+        return other_ran.load();
+    });
+    child_pushed.get_future().wait();
+    auto other = scheduler.push([&] () { other_ran = true; });
+    other_pushed.set_value();
+    BOOST_CHECK(!parent.get());
+    other.get();
+    BOOST_CHECK(other_ran);
+}
+
+BOOST_AUTO_TEST_CASE(work_stealing_scheduler_counts_tasks_run_by_each_worker)
+{
+    WorkStealingScheduler scheduler {3};
+    std::atomic<unsigned> counter {0};
+    std::vector<std::future<void>> results {};
+    for (int i {0}; i < 100; ++i) {
+        results.push_back(scheduler.push([&counter] () { ++counter; }));
+    }
+    for (auto& result : results) result.get();
+    BOOST_CHECK_EQUAL(counter, 100);
+    const auto stats = scheduler.statistics();
+    BOOST_REQUIRE_EQUAL(stats.size(), 3);
+    std::size_t num_tasks_run {0};
+    for (const auto& worker_stats : stats) {
+        num_tasks_run += worker_stats.num_tasks_run;
+    }
+    BOOST_CHECK_EQUAL(num_tasks_run, 100);
+}
+
+BOOST_AUTO_TEST_CASE(time_blocked_on_a_stolen_subtask_is_not_counted_as_busy)
+{
+    using namespace std::chrono_literals;
+    WorkStealingScheduler scheduler {2};
+    std::atomic<bool> stolen {false};
+    auto result = scheduler.push([&] () {
+        auto subtask = scheduler.push([&] () { stolen = true; std::this_thread::sleep_for(200ms); });
+        while (!stolen) std::this_thread::yield();
+        scheduler.wait(subtask);
+    });
+    result.get();
+    // Busy time is recorded before a worker goes idle
+    while (scheduler.n_idle() < scheduler.size()) std::this_thread::yield();
+    std::chrono::nanoseconds busy_time {0};
+    for (const auto& worker_stats : scheduler.statistics()) {
+        busy_time += worker_stats.busy_time;
+    }
+    BOOST_CHECK_GE(busy_time.count(), std::chrono::nanoseconds {200ms}.count());
+    BOOST_CHECK_LT(busy_time.count(), std::chrono::nanoseconds {300ms}.count());
+}
+
+BOOST_AUTO_TEST_CASE(work_stealing_scheduler_with_no_workers_runs_tasks_immediately)
+{
+    WorkStealingScheduler scheduler {};
+    auto result = scheduler.push([] () { return 1; });
+    BOOST_CHECK_EQUAL(result.get(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(current_scheduler_is_only_set_on_worker_threads)
+{
+    WorkStealingScheduler scheduler {2};
+    BOOST_CHECK(WorkStealingScheduler::current() == nullptr);
+    auto result = scheduler.push([] () { return WorkStealingScheduler::current(); });
+    BOOST_CHECK(result.get() == &scheduler);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus